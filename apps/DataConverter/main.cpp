@@ -37,6 +37,8 @@
 
 #include <apps/DataConverter/milkywayconversiontask.h>
 #include <apps/DataConverter/milkywaypointsconversiontask.h>
+#include <apps/DataConverter/tspcacheconversiontask.h>
+#include <apps/DataConverter/tspcompressionconversiontask.h>
 
 int main(int argc, char** argv) {
     using namespace openspace;
@@ -56,6 +58,27 @@ int main(int argc, char** argv) {
         pb.print(progress * 100);
     };
 
+ 
+    // DataConverter --tsp-cache <file.tsp> [<cachefile>]
+    if (argc >= 3 && std::string(argv[1]) == "--tsp-cache") {
+        TspCacheConversionTask tspCacheTask(argv[2], argc >= 4 ? argv[3] : "");
+        tspCacheTask.perform(onProgress);
+        std::cout << "Done." << std::endl;
+        return 0;
+    }
+
+    // DataConverter --tsp-compress <file.tsp> <file.ctsp> [lossless|quantized16]
+    if (argc >= 4 && std::string(argv[1]) == "--tsp-compress") {
+        brickcodec::Codec codec = brickcodec::Codec::Lossless;
+        if (argc >= 5 && std::string(argv[4]) == "quantized16") {
+            codec = brickcodec::Codec::Quantized16;
+        }
+        TspCompressionConversionTask tspCompressionTask(argv[2], argv[3], codec);
+        tspCompressionTask.perform(onProgress);
+        std::cout << "Done." << std::endl;
+        return 0;
+    }
+
     // TODO: Make the converter configurable using either
     // config files (json, lua dictionaries),
     // lua scripts,
@@ -0,0 +1,53 @@
+#include <apps/DataConverter/tspcacheconversiontask.h>
+#include <modules/multiresvolume/rendering/tsp.h>
+#include <chrono>
+#include <iostream>
+
+namespace openspace {
+namespace dataconverter {
+
+TspCacheConversionTask::TspCacheConversionTask(
+    const std::string& inFilename,
+    const std::string& outFilename)
+    : _inFilename(inFilename)
+    , _outFilename(outFilename) {}
+
+void TspCacheConversionTask::perform(const std::function<void(float)>& onProgress) {
+    using Clock = std::chrono::high_resolution_clock;
+    auto seconds = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    };
+
+    TSP tsp(_inFilename);
+    if (!tsp.readHeader()) {
+        std::cout << "Failed to read TSP header of " << _inFilename << std::endl;
+        return;
+    }
+    tsp.construct();
+    onProgress(0.1f);
+
+    Clock::time_point start = Clock::now();
+    if (!tsp.calculateErrors()) {
+        std::cout << "Failed to calculate errors of " << _inFilename << std::endl;
+        return;
+    }
+    Clock::time_point calculated = Clock::now();
+    onProgress(0.9f);
+
+    bool success = _outFilename.empty() ?
+        tsp.writeCache() :
+        tsp.writeCache(_outFilename);
+    if (!success) {
+        std::cout << "Failed to write cache for " << _inFilename << std::endl;
+        return;
+    }
+    onProgress(1.f);
+
+    std::cout << std::endl << tsp.numTotalNodes() << " bricks of " <<
+        tsp.paddedBrickDim() << "^3 voxels: errors calculated in " <<
+        seconds(start, calculated) << " s, cache written in " <<
+        seconds(calculated, Clock::now()) << " s" << std::endl;
+}
+
+}
+}
@@ -0,0 +1,35 @@
+#ifndef __TSPCACHECONVERSIONTASK_H__
+#define __TSPCACHECONVERSIONTASK_H__
+
+#include <apps/DataConverter/conversiontask.h>
+#include <string>
+#include <functional>
+
+namespace openspace {
+namespace dataconverter {
+
+/**
+ * Precomputes the spatial and temporal errors of a TSP file and writes them to the cache
+ * file that RenderableMultiresVolume reads, so that the first rendering of a dataset does
+ * not have to compute them.
+ */
+class TspCacheConversionTask : public ConversionTask {
+public:
+    /**
+     * \param inFilename The TSP file
+     * \param outFilename The cache file to write; if empty, the file in the OpenSpace
+     * cache directory is written
+     */
+    TspCacheConversionTask(const std::string& inFilename,
+                           const std::string& outFilename);
+    
+    void perform(const std::function<void(float)>& onProgress) override;
+private:
+    std::string _inFilename;    
+    std::string _outFilename;
+};
+
+}
+}
+
+#endif
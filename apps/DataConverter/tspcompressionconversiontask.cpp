@@ -0,0 +1,64 @@
+#include <apps/DataConverter/tspcompressionconversiontask.h>
+#include <modules/multiresvolume/rendering/compressedtsp.h>
+#include <openspace/util/mappedfile.h>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+
+namespace openspace {
+namespace dataconverter {
+
+TspCompressionConversionTask::TspCompressionConversionTask(
+    const std::string& inFilename,
+    const std::string& outFilename,
+    brickcodec::Codec codec)
+    : _inFilename(inFilename)
+    , _outFilename(outFilename)
+    , _codec(codec) {}
+
+void TspCompressionConversionTask::perform(const std::function<void(float)>& onProgress) {
+    using Clock = std::chrono::high_resolution_clock;
+    auto seconds = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    };
+
+    Clock::time_point start = Clock::now();
+    if (!compressedtsp::compress(_inFilename, _outFilename, _codec, onProgress)) {
+        std::cout << "Failed to compress " << _inFilename << std::endl;
+        return;
+    }
+    Clock::time_point compressed = Clock::now();
+
+    // Decode every brick once on a single thread to measure the decoding rate
+    std::ifstream file(_outFilename, std::ios::in | std::ios::binary);
+    compressedtsp::Header header;
+    std::vector<uint64_t> offsets;
+    MappedFile mapped(_outFilename);
+    if (!compressedtsp::readIndex(file, header, offsets) || !mapped.isValid()) {
+        std::cout << "Failed to read " << _outFilename << std::endl;
+        return;
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(mapped.data());
+    std::vector<float> values(header.nBrickValues);
+
+    Clock::time_point decodeStart = Clock::now();
+    for (uint64_t b = 0; b < header.nBricks; ++b) {
+        if (!brickcodec::decode(data + offsets[b], offsets[b + 1] - offsets[b],
+                                values.data(), values.size()))
+        {
+            std::cout << "Failed to decode brick " << b << std::endl;
+            return;
+        }
+    }
+    double decodeTime = seconds(decodeStart, Clock::now());
+
+    const double rawSize = static_cast<double>(header.nBricks) * header.nBrickValues *
+        sizeof(float);
+    std::cout << std::endl << header.nBricks << " bricks compressed in " <<
+        seconds(start, compressed) << " s, ratio " << rawSize / mapped.size() <<
+        ", decoding: " << header.nBricks / decodeTime << " bricks/s (" <<
+        rawSize / decodeTime / (1024 * 1024) << " MB/s) per thread" << std::endl;
+}
+
+}
+}
@@ -0,0 +1,33 @@
+#ifndef __TSPCOMPRESSIONCONVERSIONTASK_H__
+#define __TSPCOMPRESSIONCONVERSIONTASK_H__
+
+#include <apps/DataConverter/conversiontask.h>
+#include <modules/multiresvolume/rendering/brickcodec.h>
+#include <string>
+#include <functional>
+
+namespace openspace {
+namespace dataconverter {
+
+/**
+ * Converts a TSP file into a compressed TSP file, which RenderableMultiresVolume can
+ * use in place of the original, and reports the compression ratio and the rate at which
+ * the bricks of the new file can be decoded.
+ */
+class TspCompressionConversionTask : public ConversionTask {
+public:
+    TspCompressionConversionTask(const std::string& inFilename,
+                                 const std::string& outFilename,
+                                 brickcodec::Codec codec);
+    
+    void perform(const std::function<void(float)>& onProgress) override;
+private:
+    std::string _inFilename;    
+    std::string _outFilename;
+    brickcodec::Codec _codec;
+};
+
+}
+}
+
+#endif
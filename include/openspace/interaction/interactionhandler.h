@@ -216,6 +216,9 @@ private:
     std::map<std::string, std::shared_ptr<InteractionMode>> _interactionModes;
     std::shared_ptr<OrbitalInteractionMode::MouseStates> _mouseStates;
 
+    /// Drives the camera instead of the current mode while host keyframes are available
+    std::unique_ptr<KeyframeInteractionMode> _keyframeInteractionMode;
+
     // Properties
     properties::StringProperty _origin;
     properties::StringProperty _coordinateSystem;
@@ -226,6 +229,7 @@ private:
 
     properties::FloatProperty _sensitivity;
     properties::FloatProperty _rapidness;
+    properties::FloatProperty _keyframePlayoutDelay;
 };
 
 #endif // USE_OLD_INTERACTIONHANDLER
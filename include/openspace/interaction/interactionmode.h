@@ -26,6 +26,7 @@
 #define __INTERACTION_MODE_H__
 
 #include <openspace/interaction/keyboardcontroller.h>
+#include <openspace/interaction/keyframebuffer.h>
 #include <openspace/interaction/mousecontroller.h>
 #include <openspace/network/parallelconnection.h>
 #include <openspace/util/mouse.h>
@@ -64,7 +65,7 @@ namespace interaction {
         const std::list<MouseButton>& getPressedMouseButtons() const;
         glm::dvec2 getMousePosition() const;
         double getMouseScrollDelta() const;
-        std::vector<network::datamessagestructures::PositionKeyframe>& getKeyFrames() const;
+        KeyframeBuffer& keyframeBuffer();
 
         bool isKeyPressed(std::pair<Key, KeyModifier> keyModPair) const;
         bool isMouseButtonPressed(MouseButton mouseButton) const;
@@ -76,8 +77,7 @@ namespace interaction {
         double _mouseScrollDelta;
 
         // Remote input via keyframes
-        std::vector<network::datamessagestructures::PositionKeyframe> _keyframes;
-        std::mutex _keyframeMutex;
+        KeyframeBuffer _keyframeBuffer;
     };
 
 
@@ -158,17 +158,21 @@ protected:
     glm::dquat _previousFocusNodeRotation;
 };
 
+/**
+ * Moves the camera along the path that is described by the keyframes received from a
+ * parallel connection host; see KeyframeBuffer for the interpolation.
+ */
 class KeyframeInteractionMode : public InteractionMode
 {
 public:
-    KeyframeInteractionMode();
+    KeyframeInteractionMode(KeyframeBuffer& keyframeBuffer);
     ~KeyframeInteractionMode();
 
     virtual void updateMouseStatesFromInput(const InputState& inputState, double deltaTime);
     virtual void updateCameraStateFromMouseStates(Camera& camera);
 
 private:
-    double _currentKeyframeTime;
+    KeyframeBuffer& _keyframeBuffer;
 };
 
 class GlobeBrowsingInteractionMode;
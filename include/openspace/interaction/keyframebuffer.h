@@ -0,0 +1,139 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __KEYFRAMEBUFFER_H__
+#define __KEYFRAMEBUFFER_H__
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace openspace {
+namespace interaction {
+
+/**
+ * The KeyframeBuffer receives camera keyframes from a remote host and turns them into a
+ * smooth camera path for the local renderer. Keyframes are pushed by the network thread
+ * into a single-producer, single-consumer lock-free ring and moved into a time-sorted
+ * list by the render thread, so keyframes that arrive out of order are still played in
+ * the order they were taken.
+ *
+ * The offset between the host's and the local clock is estimated from the arrival
+ * times of the keyframes. The minimum of <code>receiveTime - hostTime</code> over the
+ * recent keyframes is the offset plus the smallest transmission delay; the buffer then
+ * plays the keyframes back with an additional, configurable playout delay that absorbs
+ * the jitter of the network delivery. For the smoothest result the delay should cover the
+ * jitter plus two keyframe intervals, as the spline through a segment also uses the
+ * keyframe after the next one. Positions are interpolated with a non-uniform
+ * Catmull-Rom spline, orientations with spherical quadrangle (squad) interpolation.
+ */
+class KeyframeBuffer {
+public:
+    /// A camera keyframe, the timestamp is in the clock of the host
+    struct Keyframe {
+        glm::dvec3 position;
+        glm::dquat rotation;
+        double timestamp;
+    };
+
+    /// The number of keyframes that can be in flight between the two threads
+    static const size_t RingCapacity = 64;
+
+    /// The number of recent keyframes used to estimate the clock offset
+    static const size_t OffsetWindow = 32;
+
+    KeyframeBuffer();
+
+    /**
+     * Adds a keyframe that was received at <code>receiveTime</code> (in the local clock).
+     * This method must only be called from a single thread.
+     * \return <code>false</code> if the ring was full and the keyframe was dropped
+     */
+    bool push(const Keyframe& keyframe, double receiveTime);
+
+    /**
+     * Requests that all keyframes and the clock offset estimate are discarded. Can be
+     * called from any thread, the request is executed in the next KeyframeBuffer::update.
+     */
+    void clear();
+
+    /**
+     * Moves all keyframes that have been pushed since the last call into the sorted
+     * list and updates the clock offset estimate. Must only be called from the
+     * consumer thread, like all following methods.
+     */
+    void update();
+
+    /// Returns <code>true</code> if there is at least one keyframe to play back
+    bool hasKeyframes() const;
+
+    /**
+     * Computes the interpolated camera state that should be shown at the local time
+     * <code>localTime</code>. The <code>timestamp</code> of the result is the host time
+     * that is shown. Keyframes that are no longer needed are discarded.
+     * \return <code>false</code> if there are no keyframes
+     */
+    bool sample(double localTime, Keyframe& result);
+
+    void setPlayoutDelay(double delay);
+    double playoutDelay() const;
+
+    /// The estimated <code>localTime - hostTime</code> including the minimal delay
+    double clockOffset() const;
+
+    /// The number of keyframes that have been dropped as the ring was full
+    unsigned long long nDroppedKeyframes() const;
+
+private:
+    struct Entry {
+        Keyframe keyframe;
+        double receiveTime;
+    };
+
+    void insertSorted(const Keyframe& keyframe);
+    void addOffsetSample(double offset);
+
+    // Lock-free ring between the network and the render thread
+    std::array<Entry, RingCapacity> _ring;
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+    std::atomic<bool> _clearRequested;
+    std::atomic<unsigned long long> _nDropped;
+
+    // Render thread state
+    std::vector<Keyframe> _keyframes;
+    std::array<double, OffsetWindow> _offsetSamples;
+    size_t _nOffsetSamples;
+    double _clockOffset;
+    double _playoutDelay;
+    double _lastPlayedTime;
+};
+
+} // namespace interaction
+} // namespace openspace
+
+#endif // __KEYFRAMEBUFFER_H__
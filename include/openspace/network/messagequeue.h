@@ -0,0 +1,132 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __MESSAGEQUEUE_H__
+#define __MESSAGEQUEUE_H__
+
+//std includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#ifdef WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#include <ws2tcpip.h>
+#endif
+
+#if defined(WIN32) || defined(__MING32__) || defined(__MING64__)
+typedef size_t _SOCKET;
+#else
+typedef int _SOCKET;
+#include <netdb.h>
+#include <sys/uio.h>
+#endif
+
+namespace openspace{
+    
+    namespace network{
+
+        /**
+         * The MessageQueue is the outgoing side of a ParallelConnection. Messages are
+         * framed directly into buffers that are handed out by the queue
+         * (MessageQueue::acquireBuffer) and returned to it after they have been sent,
+         * so that a steady stream of messages does not allocate. All messages that
+         * have been queued since the last flush are written to the socket with a
+         * single gathered write (<code>writev</code> or <code>WSASend</code>). The
+         * pool keeps at most 64 buffers of up to 1 MiB each.
+         */
+        class MessageQueue{
+        public:
+            using Buffer = std::vector<char>;
+
+            MessageQueue();
+
+            /**
+             * Returns an empty buffer that keeps the capacity it had when it was last
+             * returned to the pool.
+             */
+            Buffer acquireBuffer();
+
+            /**
+             * Queues a framed message for sending and wakes up a waiting flush.
+             */
+            void push(Buffer message);
+
+            /**
+             * Waits at most <code>timeout</code> for messages to be queued and writes all
+             * queued messages to <code>socket</code> in as few system calls as possible.
+             * \return The number of bytes written or <code>SOCKET_ERROR</code> if the
+             * write failed
+             */
+            int flush(_SOCKET socket, std::chrono::milliseconds timeout);
+
+            /**
+             * Wakes up a thread that is waiting in MessageQueue::flush.
+             */
+            void wakeUp();
+
+            /**
+             * Drops all queued messages, their buffers are returned to the pool.
+             */
+            void clear();
+
+            /// The number of messages that have been sent since the construction
+            unsigned long long nSentMessages() const;
+
+            /// The number of gathered writes that have been performed
+            unsigned long long nWrites() const;
+
+        private:
+            int writeAll(_SOCKET socket, std::vector<Buffer>& messages);
+            void recycle(std::vector<Buffer>& messages);
+
+            std::mutex _mutex;
+            std::condition_variable _condition;
+            bool _wakeUp;
+
+            std::vector<Buffer> _queue;
+            std::vector<Buffer> _sending;
+            std::vector<Buffer> _pool;
+
+#ifdef WIN32
+            std::vector<WSABUF> _ioVectors;
+#else
+            std::vector<iovec> _ioVectors;
+#endif
+
+            std::atomic<unsigned long long> _nSentMessages;
+            std::atomic<unsigned long long> _nWrites;
+        };
+
+    } // namespace network
+    
+} // namespace openspace
+
+#endif // __MESSAGEQUEUE_H__
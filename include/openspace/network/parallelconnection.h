@@ -29,6 +29,7 @@
 #include <openspace/scripting/scriptengine.h>
 #include <openspace/util/powerscaledcoordinate.h>
 #include <openspace/network/messagestructures.h>
+#include <openspace/network/messagequeue.h>
 
 //glm includes
 #include <glm/gtx/quaternion.hpp>
@@ -43,22 +44,6 @@
 #include <map>
 #include <condition_variable>
 
-#ifdef WIN32
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-#include <winsock2.h>
-#include <windows.h>
-#include <ws2tcpip.h>
-#endif
-
-#if defined(WIN32) || defined(__MING32__) || defined(__MING64__)
-typedef size_t _SOCKET;
-#else
-typedef int _SOCKET;
-#include <netdb.h>
-#endif
-
 namespace openspace{
     
     namespace network{
@@ -89,6 +74,22 @@ namespace openspace{
             void preSynchronization();
             
             void scriptMessage(const std::string propIdentifier, const std::string propValue);
+
+            /**
+             * Sets the range of intervals (in seconds) between two camera keyframes that
+             * are broadcast by the host. A keyframe is sent at least every
+             * <code>maximum</code> seconds and, while the camera is moving, as often
+             * as every <code>minimum</code> seconds.
+             */
+            void setKeyframeInterval(double minimum, double maximum);
+
+            /**
+             * Sets the amount of camera motion since the last broadcast keyframe that
+             * triggers a new keyframe before the maximum interval has passed. The motion
+             * is the rotation in radians plus the translation relative to the distance
+             * to the focus node.
+             */
+            void setKeyframeTolerance(double tolerance);
             
             enum MessageTypes{
                 Authentication=0,
@@ -132,6 +133,9 @@ namespace openspace{
             };
             
             void queueMessage(std::vector<char> message);
+
+            template <typename T>
+            void queueDataMessage(datamessagestructures::type type, T& message);
             
             void disconnect();
             
@@ -191,9 +195,12 @@ namespace openspace{
             std::condition_variable _disconnectCondition;
             std::mutex _disconnectMutex;
             
-            std::vector<std::vector<char>> _sendBuffer;
-            std::mutex _sendBufferMutex;
-            std::condition_variable _sendCondition;
+            MessageQueue _messageQueue;
+            std::vector<char> _receiveBuffer;
+
+            std::atomic<double> _minimumKeyframeInterval;
+            std::atomic<double> _maximumKeyframeInterval;
+            std::atomic<double> _keyframeTolerance;
             
             network::datamessagestructures::TimeKeyframe _latestTimeKeyframe;
             std::mutex _timeKeyframeMutex;
@@ -26,11 +26,15 @@
 #define __PERFORMANCEMANAGER_H__
 
 #include <openspace/performance/performancelayout.h>
+#include <openspace/performance/telemetrylayout.h>
 
 #include <ghoul/misc/sharedmemory.h>
 
-#include <map>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 namespace ghoul {
@@ -47,6 +51,16 @@ class PerformanceManager {
 public:
     static void createGlobalSharedMemory();
     static void destroyGlobalSharedMemory();
+
+    /**
+     * Returns the process-wide identifier for the scope called \p name, creating it if
+     * it did not exist before. The identifiers stay valid for the lifetime of the
+     * process, so they can be cached at the call site (see the PerfMeasure macro).
+     */
+    static uint32_t internScope(const std::string& name);
+
+    /// Returns the nanoseconds of the steady clock, the time base for all telemetry
+    static uint64_t now();
     
     PerformanceManager();
     ~PerformanceManager();
@@ -56,16 +70,46 @@ public:
     bool isMeasuringPerformance() const;
 
     void storeIndividualPerformanceMeasurement(std::string identifier, long long nanoseconds);
+
+    /**
+     * Records the execution of the scope \p scope between \p begin and \p end, both
+     * obtained from now(). The event is written into the telemetry ring buffer of the
+     * calling thread without locking and is added to the averaged function entries in
+     * the performanceData.
+     */
+    void storeScopeMeasurement(uint32_t scope, uint64_t begin, uint64_t end);
+
     void storeScenePerformanceMeasurements(const std::vector<SceneGraphNode*>& sceneNodes);
+
+    /// Advances the frame number that is stored with all subsequent telemetry events
+    void nextFrame();
     
     PerformanceLayout* performanceData();
 
+    /// Returns the name of the shared memory block that contains the TelemetryLayout
+    std::string telemetryMemoryName() const;
+
 private:
+    TelemetryLayout* telemetryData();
+
+    /// Copies the names of all scopes that were interned since the last call
+    void publishScopes();
+
+    /// Returns the ring of the calling thread or nullptr if all rings are taken
+    TelemetryLayout::ThreadRing* threadRing();
+
     bool _doPerformanceMeasurements;
     
-    std::map<std::string, size_t> individualPerformanceLocations;
+    /// Maps scope identifiers to the function entries of the PerformanceLayout
+    std::vector<int16_t> _functionEntryLocations;
     
     std::unique_ptr<ghoul::SharedMemory> _performanceMemory;
+    std::unique_ptr<ghoul::SharedMemory> _telemetryMemory;
+
+    /// Identifies this instance for the cached thread rings
+    uint64_t _id;
+    std::atomic<uint32_t> _nPublishedScopes;
+    std::mutex _publishMutex;
 };
 
 } // namespace performance
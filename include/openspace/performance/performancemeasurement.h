@@ -26,9 +26,10 @@
 #define __PERFORMANCEMEASUREMENT_H__
 
 #include <openspace/engine/openspaceengine.h>
+#include <openspace/performance/performancemanager.h>
 #include <openspace/rendering/renderengine.h>
 
-#include <chrono>
+#include <cstdint>
 #include <string>
 
 namespace openspace {
@@ -39,23 +40,28 @@ class PerformanceManager;
 class PerformanceMeasurement {
 public:
     PerformanceMeasurement(std::string identifier, performance::PerformanceManager* manager);
+    PerformanceMeasurement(uint32_t scope, performance::PerformanceManager* manager);
     ~PerformanceMeasurement();
 
 private:
-    std::string _identifier;
+    uint32_t _scope;
     performance::PerformanceManager* _manager;
 
-    std::chrono::high_resolution_clock::time_point _startTime;
+    uint64_t _startTime;
 };
     
 #define __MERGE(a,b)  a##b
 #define __LABEL(a) __MERGE(unique_name_, a)
+#define __SCOPE_LABEL(a) __MERGE(unique_scope_, a)
 
-/// Declare a new variable for measuring the performance of the current block
+/// Declare a new variable for measuring the performance of the current block. The name
+/// is interned only once per call site
 #define PerfMeasure(name) \
+    static const uint32_t __SCOPE_LABEL(__LINE__) = \
+        openspace::performance::PerformanceManager::internScope(name); \
     auto __LABEL(__LINE__) = \
         openspace::performance::PerformanceMeasurement(\
-            (name), \
+            __SCOPE_LABEL(__LINE__), \
             OsEng.renderEngine().performanceManager() \
         )
     
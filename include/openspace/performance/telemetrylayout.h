@@ -0,0 +1,102 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TELEMETRYLAYOUT_H__
+#define __TELEMETRYLAYOUT_H__
+
+#include <atomic>
+#include <cstdint>
+
+namespace openspace {
+namespace performance {
+
+/**
+ * The layout of the shared memory block that carries the performance telemetry of one
+ * OpenSpace instance to external readers. Every measured scope is recorded as a pair of
+ * nanosecond timestamps into a per-thread ring buffer. Each ring has a single writer (the
+ * thread that owns it) and is read without any locks: the writer stores the event and
+ * then publishes the new head, while a reader copies events and afterwards discards all
+ * events that the writer could have overwritten in the meantime. Scope names are interned
+ * once and referenced by their index into the <code>scopes</code> table.
+ *
+ * All members are plain data or lock-free atomics, so that the layout can be placed in
+ * shared memory and accessed by several processes.
+ */
+struct TelemetryLayout {
+    static const uint32_t Magic = 0x54454c4d; // 'TELM'
+    static const uint32_t Version = 1;
+    static const int LengthName = 64;
+    static const int NumberScopes = 1024;
+    static const int NumberThreads = 16;
+    /// The number of events per thread; has to be a power of two
+    static const int NumberEvents = 4096;
+
+    /// A single measured scope; timestamps are in nanoseconds of the steady clock
+    struct Event {
+        uint32_t scope;
+        uint32_t frame;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    struct Scope {
+        char name[LengthName];
+    };
+
+    struct ThreadRing {
+        /// The total number of events that have ever been written into this ring
+        std::atomic<uint64_t> head;
+        /// Keeps the frequently written head off the cache line of the first events
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+        Event events[NumberEvents];
+
+        /**
+         * Stores the \p event in the ring, overwriting the oldest event if the ring is
+         * full. Must only be called by the thread owning this ring.
+         */
+        void push(const Event& event);
+    };
+
+    TelemetryLayout();
+
+    uint32_t magic;
+    uint32_t version;
+
+    /// The number of valid entries in <code>scopes</code>
+    std::atomic<uint32_t> nScopes;
+    /// The number of rings in <code>threads</code> that have been claimed by a thread
+    std::atomic<uint32_t> nThreads;
+    /// The current frame number that is stored with each event
+    std::atomic<uint32_t> frame;
+    /// The number of events that were discarded as no ring was left for their thread
+    std::atomic<uint32_t> nDroppedEvents;
+
+    Scope scopes[NumberScopes];
+    ThreadRing threads[NumberThreads];
+};
+
+} // namespace performance
+} // namespace openspace
+
+#endif // __TELEMETRYLAYOUT_H__
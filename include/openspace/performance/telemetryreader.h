@@ -0,0 +1,95 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TELEMETRYREADER_H__
+#define __TELEMETRYREADER_H__
+
+#include <openspace/performance/telemetrylayout.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ghoul {
+    class SharedMemory;
+}
+
+namespace openspace {
+namespace performance {
+
+/**
+ * Streams the events of a TelemetryLayout, usually from the shared memory block of a
+ * running OpenSpace instance (see PerformanceManager::telemetryMemoryName). Reading never
+ * blocks the writing threads; events that have been overwritten before they could be
+ * read are skipped and counted in nMissedEvents. To keep up, a reader has to poll at
+ * least once every <code>TelemetryLayout::NumberEvents - 1</code> events per thread.
+ */
+class TelemetryReader {
+public:
+    struct Event {
+        uint32_t thread;
+        uint32_t scope;
+        uint32_t frame;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /**
+     * Opens the telemetry in the shared memory block \p sharedMemoryName.
+     * \throws ghoul::RuntimeError If the block does not exist or contains an
+     * incompatible layout
+     */
+    TelemetryReader(const std::string& sharedMemoryName);
+
+    /// Reads the telemetry from a \p layout that is accessible in this process
+    TelemetryReader(const TelemetryLayout* layout);
+
+    ~TelemetryReader();
+
+    /**
+     * Appends all events that have been written since the last call to \p events. The
+     * events of each thread are in the order in which their scopes ended.
+     * \returns The number of events that were appended
+     */
+    size_t read(std::vector<Event>& events);
+
+    /// Returns the name of the \p scope or an empty string if it is not known yet
+    std::string scopeName(uint32_t scope) const;
+
+    /// Returns the number of events that were overwritten before they could be read
+    uint64_t nMissedEvents() const;
+
+private:
+    std::unique_ptr<ghoul::SharedMemory> _memory;
+    const TelemetryLayout* _layout;
+
+    std::array<uint64_t, TelemetryLayout::NumberThreads> _cursors;
+    uint64_t _nMissedEvents;
+};
+
+} // namespace performance
+} // namespace openspace
+
+#endif // __TELEMETRYREADER_H__
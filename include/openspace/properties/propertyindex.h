@@ -0,0 +1,170 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __PROPERTYINDEX_H__
+#define __PROPERTYINDEX_H__
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace openspace {
+namespace properties {
+
+class Property;
+class PropertyOwner;
+
+/**
+ * The PropertyIndex is a prefix trie over the fully qualified identifiers of all
+ * Propertys that are reachable from a list of root PropertyOwners. Each level of the
+ * trie corresponds to one PropertyOwner::URISeparator separated segment of the URI, so
+ * that exact lookups are a single descent, prefix queries only have to visit the
+ * matching subtree, and wildcard and regular expression queries can be restricted to
+ * the subtree of their literal prefix.
+ *
+ * Any change to the structure of a PropertyOwner hierarchy (adding or removing
+ * Propertys or sub-owners, renaming an owner) calls PropertyIndex::markDirty, which
+ * increments a global generation counter. An index whose generation is older than the
+ * global generation has to be rebuilt before it is used again (see
+ * PropertyIndex::isUpToDate).
+ */
+class PropertyIndex {
+public:
+    /// A visited Property together with its fully qualified identifier
+    using Visitor = std::function<void(const std::string& uri, Property* prop)>;
+
+    PropertyIndex();
+
+    /**
+     * Signals that the structure of at least one PropertyOwner hierarchy has changed and
+     * that all existing PropertyIndex objects are out of date.
+     */
+    static void markDirty();
+
+    /**
+     * Returns the current global generation of the PropertyOwner hierarchies.
+     * \return The current global generation of the PropertyOwner hierarchies
+     */
+    static unsigned long long generation();
+
+    /**
+     * Returns <code>true</code> if this index has been built after the last call to
+     * PropertyIndex::markDirty.
+     * \return <code>true</code> if the index reflects the current PropertyOwners
+     */
+    bool isUpToDate() const;
+
+    /**
+     * Rebuilds the index from the passed <code>roots</code>. The roots are added in
+     * order and if two Propertys share the same fully qualified identifier, the one that
+     * was added first is kept.
+     * \param roots The root PropertyOwners whose Propertys should be indexed
+     */
+    void rebuild(const std::vector<const PropertyOwner*>& roots);
+
+    /**
+     * Removes all entries from this index.
+     */
+    void clear();
+
+    /**
+     * Returns the number of Propertys that are stored in this index.
+     * \return The number of Propertys that are stored in this index
+     */
+    size_t size() const;
+
+    /**
+     * Returns the Property with the fully qualified identifier <code>uri</code>.
+     * \param uri The fully qualified identifier of the Property
+     * \return The Property or <code>nullptr</code> if it is not part of the index
+     */
+    Property* property(const std::string& uri) const;
+
+    /**
+     * Calls <code>visitor</code> for every Property whose fully qualified identifier
+     * starts with <code>prefix</code>. The prefix may end in the middle of a segment.
+     * \param prefix The prefix that all visited URIs share
+     * \param visitor The function that is called for every matching Property
+     */
+    void visitPrefix(const std::string& prefix, const Visitor& visitor) const;
+
+    /**
+     * Returns all Propertys whose fully qualified identifier matches the
+     * <code>pattern</code>. Each <code>*</code> in the pattern matches an arbitrary
+     * (possibly empty) sequence of characters, including separators, all other
+     * characters have to match exactly.
+     * \param pattern The pattern that is matched against the URIs
+     * \return All Propertys whose identifier matches the <code>pattern</code>
+     */
+    std::vector<Property*> propertiesMatchingWildcard(const std::string& pattern) const;
+
+    /**
+     * Returns all Propertys whose fully qualified identifier matches the ECMAScript
+     * regular expression <code>regex</code>. Only the subtree that is selected by the
+     * literal prefix of the expression is tested against the regular expression.
+     * \param regex The regular expression that is matched against the URIs
+     * \return All Propertys whose identifier matches the <code>regex</code>
+     * \throw std::regex_error If the <code>regex</code> is malformed
+     */
+    std::vector<Property*> propertiesMatchingRegex(const std::string& regex) const;
+
+    /**
+     * Returns the longest prefix of the <code>regex</code> that consists only of literal
+     * characters. Escaped separators are unescaped and an expression that contains a
+     * top-level alternative results in an empty prefix.
+     * \param regex The ECMAScript regular expression
+     * \return The literal prefix that every match of <code>regex</code> starts with
+     */
+    static std::string literalPrefix(const std::string& regex);
+
+    /**
+     * Returns whether the <code>uri</code> matches the wildcard <code>pattern</code>
+     * \see PropertyIndex::propertiesMatchingWildcard
+     */
+    static bool matchesWildcard(const std::string& uri, const std::string& pattern);
+
+private:
+    struct Node {
+        Property* property = nullptr;
+        std::map<std::string, std::unique_ptr<Node>> children;
+    };
+
+    void insert(const PropertyOwner& owner, const std::string& prefix);
+    void insert(const std::string& uri, Property* prop);
+    static void visit(const Node& node, std::string& uri, const Visitor& visitor);
+
+    static std::atomic<unsigned long long> _globalGeneration;
+
+    Node _root;
+    size_t _size;
+    unsigned long long _generation;
+};
+
+} // namespace properties
+} // namespace openspace
+
+#endif // __PROPERTYINDEX_H__
@@ -32,6 +32,7 @@ namespace openspace {
 
 namespace properties {
     class Property;
+    class PropertyIndex;
 }
 
 class Renderable;
@@ -46,6 +47,13 @@ Renderable* renderable(const std::string& name);
 properties::Property* property(const std::string& uri);
 std::vector<properties::Property*> allProperties();
 
+/**
+ * Returns the index over the fully qualified identifiers of all Propertys that are
+ * returned by allProperties. The index is rebuilt lazily whenever a PropertyOwner
+ * hierarchy or the scene graph has changed since the last call.
+ */
+const properties::PropertyIndex& propertyIndex();
+
 } // namespace
 
 #endif // __QUERY_H__
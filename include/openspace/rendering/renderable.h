@@ -66,6 +66,15 @@ public:
     Renderable(const ghoul::Dictionary& dictionary);
     virtual ~Renderable();
 
+    /**
+     * Reads, parses and prepares all data that does not require an OpenGL context, such
+     * as vertex data. This is called on a worker thread before initialize, concurrently
+     * with the other renderables of the scene, so it must neither use OpenGL, SPICE, nor
+     * change global state like the current directory or the cache manager. Renderables
+     * that do not override this load everything in initialize.
+     */
+    virtual bool loadResources();
+
     virtual bool initialize() = 0;
     virtual bool deinitialize() = 0;
 
@@ -147,6 +147,18 @@ public:
         const ghoul::Dictionary& dictionary = ghoul::Dictionary(),
         RenderEngine::RenderProgramType type = RenderEngine::RenderProgramType::Default);
 
+    /**
+    * Creates a program object for rendering with the used renderer in the same way as
+    * <code>buildRenderProgram</code>, but without compiling or linking it. The shader
+    * objects are attached with their preprocessed sources, so that the caller can
+    * compile and link the program when it chooses to, for example asynchronously.
+    */
+    std::unique_ptr<ghoul::opengl::ProgramObject> createRenderProgram(
+        std::string name,
+        std::string vsPath,
+        std::string fsPath,
+        const ghoul::Dictionary& dictionary = ghoul::Dictionary());
+
     std::string progressToStr(int size, double t);
 
     void removeRenderProgram(const std::unique_ptr<ghoul::opengl::ProgramObject>& program);
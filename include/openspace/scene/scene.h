@@ -121,9 +121,29 @@ public:
 
     static documentation::Documentation Documentation();
 
+    /// The time it took to load and initialize a SceneGraphNode
+    struct NodeLoadTiming {
+        std::string name;
+        /// Seconds spent in SceneGraphNode::loadResources on a worker thread
+        double loadTime;
+        /// Seconds spent in SceneGraphNode::initialize on the main thread
+        double initializeTime;
+    };
+
+    /// Returns the load timings of all nodes of the last loaded scene
+    const std::vector<NodeLoadTiming>& loadTimings() const;
+
 private:
     bool loadSceneInternal(const std::string& sceneDescriptionFilePath);
 
+    /**
+     * Loads the resources of all nodes in parallel, honoring the dependencies between the
+     * nodes, and afterwards initializes them on the calling thread, which owns the OpenGL
+     * context.
+     */
+    void initializeNodes();
+    void logLoadTimings() const;
+
     void writePropertyDocumentation(const std::string& filename, const std::string& type);
 
     std::string _focus;
@@ -135,6 +155,7 @@ private:
     //std::map<std::string, SceneGraphNode*> _allNodes;
 
     std::string _sceneGraphToLoad;
+    std::vector<NodeLoadTiming> _loadTimings;
 
     std::mutex _programUpdateLock;
     std::set<ghoul::opengl::ProgramObject*> _programsToUpdate;
@@ -27,6 +27,8 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+
 namespace openspace {
 
 class SceneGraphNode;
@@ -45,6 +47,12 @@ public:
 
     const std::vector<SceneGraphNode*>& nodes() const;
 
+    /**
+     * Returns the nodes that \p node depends on, which includes its parent. Each of them
+     * precedes \p node in nodes().
+     */
+    std::vector<SceneGraphNode*> dependencies(SceneGraphNode* node) const;
+
     SceneGraphNode* rootNode() const;
     SceneGraphNode* sceneGraphNode(const std::string& name) const;
 
@@ -62,10 +70,16 @@ private:
     bool nodeIsDependentOnRoot(SceneGraphNodeInternal* node);
     bool sortTopologically();
 
-    SceneGraphNodeInternal* nodeByName(const std::string& name);
+    SceneGraphNodeInternal* nodeByName(const std::string& name) const;
+
+    void addToIndex(SceneGraphNodeInternal* node);
+    void removeFromIndex(SceneGraphNodeInternal* node);
 
     SceneGraphNode* _rootNode;
     std::vector<SceneGraphNodeInternal*> _nodes;
+    // Name-based index into _nodes; if names collide, the earliest added node is kept.
+    // Entries of renamed nodes are repaired by nodeByName, hence mutable
+    mutable std::unordered_map<std::string, SceneGraphNodeInternal*> _nodesByName;
     std::vector<SceneGraphNode*> _topologicalSortedNodes;
 };
 
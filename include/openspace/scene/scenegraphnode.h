@@ -64,6 +64,8 @@ public:
 
     static SceneGraphNode* createFromDictionary(const ghoul::Dictionary& dictionary);
 
+    /// Prepares the data of the Renderable that does not require an OpenGL context
+    bool loadResources();
     bool initialize();
     bool deinitialize();
 
@@ -30,6 +30,7 @@
 #include <openspace/scripting/lualibrary.h>
 
 #include <queue>
+#include <string>
 #include <vector>
 
 namespace openspace {
@@ -56,7 +57,9 @@ struct ScheduledScript {
 
 /**
  * Maintains an ordered list of <code>ScheduledScript</code>s and provides a simple 
- * interface for retrieveing scheduled scripts
+ * interface for retrieveing scheduled scripts. The time stamps of the scripts are kept
+ * in a separate sorted index, so that moving to an arbitrary time, forward or backward,
+ * is a binary search followed by a walk over only the scripts that are triggered.
  */
 class ScriptScheduler {
 public:
@@ -75,6 +78,13 @@ public:
     */
     void loadScripts(const ghoul::Dictionary& dict);
 
+    /**
+    * Adds the provided scripts to the schedule. The current time of the scheduler is
+    * kept and no scripts are triggered by this call.
+    * \param scripts The scripts that are added to the schedule
+    */
+    void addScripts(std::vector<ScheduledScript> scripts);
+
 
     /**
     * Rewinds the script scheduler to the first scheduled script.
@@ -106,6 +116,29 @@ public:
     */
     std::queue<std::string> progressTo(const std::string& timeStr);
 
+    /**
+    * Progresses the script scheduler to \p newTime like
+    * <code>progressTo(double newTime)</code> but combines all triggered scripts, in the
+    * order in which they have to be executed, into a single Lua chunk. This allows all
+    * scripts triggered in a frame to be queued, synchronized, and run at once instead of
+    * one per frame. Every script is compiled and run as its own chunk inside the batch
+    * (see isolatedChunk), so an error in one script does not affect the others.
+    *
+    * \param newTime A j2000 time value specifying the new time stamp that
+    * the script scheduler should progress to.
+    *
+    * \returns the combined script, or an empty string if no script was triggered
+    */
+    std::string progressToBatched(double newTime);
+
+    /**
+    * Wraps \p script into a Lua statement that compiles and runs it as a separate
+    * chunk and reports its errors through <code>openspace.printError</code>. Syntax
+    * errors, runtime errors, top-level <code>return</code>s, and <code>local</code>
+    * variables are thereby contained to the script.
+    */
+    static std::string isolatedChunk(const std::string& script);
+
 
 
     /**
@@ -122,11 +155,23 @@ public:
     static LuaLibrary luaLibrary();
 
 private:
+    /**
+    * Moves the scheduler to \p newTime and calls \p callback with each triggered
+    * script in execution order; forward scripts in ascending time order when moving
+    * forward and backward scripts in descending time order when moving backward.
+    */
+    template <typename Func>
+    void progress(double newTime, Func callback);
+
+    /// Returns the number of scripts that are scheduled at or before \p time
+    size_t indexForTime(double time) const;
 
     std::vector<ScheduledScript> _scheduledScripts;
+    /// The sorted time stamps of <code>_scheduledScripts</code> used for seeking
+    std::vector<double> _timeIndex;
 
     size_t _currentIndex = 0;
-    double _currentTime;
+    double _currentTime = -DBL_MAX;
 
 };
 
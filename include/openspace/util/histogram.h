@@ -25,6 +25,8 @@
 #ifndef __HISTOGRAM_H__
 #define __HISTOGRAM_H__
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <iostream>
 
@@ -56,6 +58,29 @@ public:
      * @return Returns true if succesful insertion, otherwise return false
      */
     bool add(float value, float repeat = 1.0f);
+
+    /**
+     * Enters all values into the histogram, which is considerably faster than adding
+     * them one at a time. The bins are computed for blocks of values, four at a time
+     * with SSE2 intrinsics where available, and are counted with integers, so large
+     * counts are exact. The values are split among \p nThreads threads that count into
+     * private histograms, which are merged at the end. If \p nThreads is 0, one thread
+     * per core is used.
+     *
+     * @param values The values to insert into the histogram
+     * @param nValues The number of values
+     * @param nThreads The number of threads used for counting
+     *
+     * @return Returns the number of values that were inside the range of the histogram,
+     * which is 0 if the range is empty
+     */
+    size_t add(const float* values, size_t nValues, unsigned int nThreads = 1);
+    size_t add(const std::vector<float>& values, unsigned int nThreads = 1);
+
+    /**
+     * Adds the bins of another histogram with the same range and number of bins, which
+     * can be used to merge histograms that were built separately.
+     */
     bool add(const Histogram& histogram);
     bool addRectangle(float lowBin, float highBin, float value);
 
@@ -77,6 +102,13 @@ public:
     void changeRange(float minValue, float maxValue);
 
 private:
+    /**
+     * Returns the cumulative sums of the bins. They are cached until the bins are
+     * modified, so the equalizer and the entropy do not have to sum over all bins again.
+     */
+    const std::vector<double>& prefixSums();
+    void invalidateCaches();
+
     int _numBins;
     float _minValue;
     float _maxValue;
@@ -84,7 +116,11 @@ private:
 
     float* _data;
     std::vector<float> _equalizer;
-    int _numValues;
+    int64_t _numValues;
+
+    std::vector<double> _prefixSums;
+    bool _hasEntropy;
+    float _entropy;
 
 }; // class Histogram
 }  // namespace openspace
@@ -0,0 +1,72 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <cstddef>
+#include <string>
+
+namespace openspace {
+
+/**
+ * A read-only memory mapping of an entire file. The operating system pages the contents
+ * in on demand, so large files can be accessed randomly and from several threads without
+ * seeking or copying into intermediate buffers.
+ */
+class MappedFile {
+public:
+    /**
+     * Maps the file \p filename. If the file could not be opened or mapped, isValid will
+     * return <code>false</code>.
+     */
+    MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isValid() const;
+
+    /// Returns the first byte of the file or nullptr if the mapping is not valid
+    const char* data() const;
+
+    /// Returns the size of the file in bytes
+    size_t size() const;
+
+private:
+    const char* _data;
+    size_t _size;
+
+#ifdef WIN32
+    void* _fileHandle;
+    void* _mappingHandle;
+#else
+    int _fileDescriptor;
+#endif
+};
+
+} // namespace openspace
+
+#endif // __MAPPEDFILE_H__
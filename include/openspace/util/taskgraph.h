@@ -0,0 +1,74 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TASKGRAPH_H__
+#define __TASKGRAPH_H__
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * A set of tasks with dependencies between them that are executed on a pool of threads.
+ * A task is started as soon as all the tasks it depends on have finished, so independent
+ * tasks run concurrently while the order within each dependency chain is preserved.
+ * Tasks can only depend on tasks that were added before them, which rules out cycles.
+ */
+class TaskGraph {
+public:
+    using TaskId = size_t;
+
+    /**
+     * Adds the \p task, which will only be started after all tasks in
+     * \p dependencies have finished.
+     * \returns The identifier of the task, which can be used as a dependency of later
+     * tasks
+     */
+    TaskId addTask(std::function<void()> task, std::vector<TaskId> dependencies = {});
+
+    /**
+     * Executes all tasks on \p nThreads threads, including the calling thread, and
+     * returns when all of them have finished. If \p nThreads is 0, one thread per core
+     * is used. If tasks throw, the remaining tasks are executed regardless and the first
+     * exception is rethrown afterwards.
+     */
+    void run(unsigned int nThreads = 0);
+
+    size_t size() const;
+
+private:
+    struct Task {
+        std::function<void()> function;
+        size_t nDependencies;
+        std::vector<TaskId> dependents;
+    };
+
+    std::vector<Task> _tasks;
+};
+
+} // namespace openspace
+
+#endif // __TASKGRAPH_H__
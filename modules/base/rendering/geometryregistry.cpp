@@ -0,0 +1,306 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/base/rendering/geometryregistry.h>
+
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+    const std::string _loggerCat = "GeometryRegistry";
+
+    // Version 4 introduced the padded header that keeps the vertex data aligned so that
+    // the file can be mapped and handed to OpenGL as is
+    const int8_t CurrentCacheVersion = 4;
+
+    struct CacheHeader {
+        int8_t version;
+        int8_t padding[7];
+        int64_t nVertices;
+        int64_t nIndices;
+    };
+    static_assert(sizeof(CacheHeader) == 24, "Cache header must not contain padding");
+} // namespace
+
+namespace openspace {
+namespace modelgeometry {
+
+SharedGeometry::SharedGeometry()
+    : _isLoaded(false)
+    , _vertices(nullptr)
+    , _nVertices(0)
+    , _indices(nullptr)
+    , _nIndices(0)
+    , _boundingRadius(0.0)
+    , _nUploads(0)
+    , _vaoID(0)
+    , _vbo(0)
+    , _ibo(0)
+{}
+
+SharedGeometry::~SharedGeometry() {
+    if (_nUploads > 0) {
+        LWARNING("Geometry destroyed while " << _nUploads << " uploads are active");
+    }
+}
+
+bool SharedGeometry::isValid() const {
+    return _nVertices > 0 && _nIndices > 0;
+}
+
+const SharedGeometry::Vertex* SharedGeometry::vertices() const {
+    return _vertices;
+}
+
+size_t SharedGeometry::nVertices() const {
+    return _nVertices;
+}
+
+const int* SharedGeometry::indices() const {
+    return _indices;
+}
+
+size_t SharedGeometry::nIndices() const {
+    return _nIndices;
+}
+
+double SharedGeometry::boundingRadius() const {
+    return _boundingRadius;
+}
+
+size_t SharedGeometry::memoryFootprint() const {
+    return _nVertices * sizeof(Vertex) + _nIndices * sizeof(int);
+}
+
+bool SharedGeometry::isMapped() const {
+    return _mapping != nullptr;
+}
+
+void SharedGeometry::upload() {
+    ++_nUploads;
+    if (_nUploads > 1 || !isValid()) {
+        return;
+    }
+
+    glGenVertexArrays(1, &_vaoID);
+    glGenBuffers(1, &_vbo);
+    glGenBuffers(1, &_ibo);
+
+    glBindVertexArray(_vaoID);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, _nVertices * sizeof(Vertex), _vertices, GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+        reinterpret_cast<const GLvoid*>(offsetof(Vertex, location)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+        reinterpret_cast<const GLvoid*>(offsetof(Vertex, tex)));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+        reinterpret_cast<const GLvoid*>(offsetof(Vertex, normal)));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _nIndices * sizeof(int), _indices, GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+}
+
+void SharedGeometry::release() {
+    if (_nUploads == 0) {
+        return;
+    }
+    --_nUploads;
+    if (_nUploads > 0 || _vaoID == 0) {
+        return;
+    }
+
+    glDeleteBuffers(1, &_vbo);
+    glDeleteVertexArrays(1, &_vaoID);
+    glDeleteBuffers(1, &_ibo);
+    _vbo = 0;
+    _vaoID = 0;
+    _ibo = 0;
+}
+
+GLuint SharedGeometry::vertexArray() const {
+    return _vaoID;
+}
+
+GLuint SharedGeometry::indexBuffer() const {
+    return _ibo;
+}
+
+bool SharedGeometry::map(const std::string& cacheFile) {
+    std::unique_ptr<MappedFile> mapping = std::make_unique<MappedFile>(cacheFile);
+    if (!mapping->isValid() || mapping->size() < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::copy(mapping->data(), mapping->data() + sizeof(CacheHeader),
+        reinterpret_cast<char*>(&header));
+    if (header.version != CurrentCacheVersion) {
+        return false;
+    }
+
+    size_t expectedSize = sizeof(CacheHeader) + header.nVertices * sizeof(Vertex) +
+        header.nIndices * sizeof(int);
+    if (header.nVertices <= 0 || header.nIndices <= 0 || mapping->size() != expectedSize)
+    {
+        return false;
+    }
+
+    const char* data = mapping->data() + sizeof(CacheHeader);
+    _vertices = reinterpret_cast<const Vertex*>(data);
+    _nVertices = static_cast<size_t>(header.nVertices);
+    _indices = reinterpret_cast<const int*>(data + _nVertices * sizeof(Vertex));
+    _nIndices = static_cast<size_t>(header.nIndices);
+    _mapping = std::move(mapping);
+    _ownedVertices.clear();
+    _ownedIndices.clear();
+    computeBoundingRadius();
+    return true;
+}
+
+void SharedGeometry::setData(std::vector<Vertex> vertices, std::vector<int> indices) {
+    _mapping = nullptr;
+    _ownedVertices = std::move(vertices);
+    _ownedIndices = std::move(indices);
+    _vertices = _ownedVertices.data();
+    _nVertices = _ownedVertices.size();
+    _indices = _ownedIndices.data();
+    _nIndices = _ownedIndices.size();
+    computeBoundingRadius();
+}
+
+void SharedGeometry::computeBoundingRadius() {
+    float maxDistSquared = 0.f;
+    for (size_t i = 0; i < _nVertices; ++i) {
+        const GLfloat* p = _vertices[i].location;
+        maxDistSquared = std::max(maxDistSquared, p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    }
+    _boundingRadius = std::sqrt(maxDistSquared);
+}
+
+GeometryRegistry& GeometryRegistry::ref() {
+    static GeometryRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<SharedGeometry> GeometryRegistry::acquire(const std::string& cacheFile,
+                                                          const Loader& loader)
+{
+    std::shared_ptr<SharedGeometry> geometry;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::weak_ptr<SharedGeometry>& entry = _geometries[cacheFile];
+        geometry = entry.lock();
+        if (!geometry) {
+            geometry = std::make_shared<SharedGeometry>();
+            entry = geometry;
+        }
+    }
+
+    // The registry lock is not held while loading, so different models can be loaded
+    // concurrently while requests for the same model wait here
+    std::lock_guard<std::mutex> lock(geometry->_loadMutex);
+    if (!geometry->_isLoaded) {
+        load(*geometry, cacheFile, loader);
+        geometry->_isLoaded = true;
+    }
+    return geometry;
+}
+
+size_t GeometryRegistry::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::count_if(
+        _geometries.begin(),
+        _geometries.end(),
+        [](const std::pair<const std::string, std::weak_ptr<SharedGeometry>>& p) {
+            return !p.second.expired();
+        }
+    );
+}
+
+void GeometryRegistry::load(SharedGeometry& geometry, const std::string& cacheFile,
+                            const Loader& loader)
+{
+    if (FileSys.fileExists(cacheFile)) {
+        if (geometry.map(cacheFile)) {
+            LINFO("Cached file '" << cacheFile << "' mapped");
+            return;
+        }
+        // Intentional fall-through to regenerate the cache file, which overwrites the
+        // outdated one
+        LINFO("The format of the cached file '" << cacheFile << "' has changed");
+    }
+    else {
+        LINFO("Cached file '" << cacheFile << "' not found");
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<int> indices;
+    if (!loader(vertices, indices)) {
+        return;
+    }
+
+    LINFO("Saving cache");
+    if (saveCacheFile(cacheFile, vertices, indices) && geometry.map(cacheFile)) {
+        // Mapping the file we just wrote lets the freshly parsed model live in the page
+        // cache instead of on the heap
+        return;
+    }
+    geometry.setData(std::move(vertices), std::move(indices));
+}
+
+bool GeometryRegistry::saveCacheFile(const std::string& cacheFile,
+                                     const std::vector<Vertex>& vertices,
+                                     const std::vector<int>& indices)
+{
+    std::ofstream fileStream(cacheFile, std::ofstream::binary);
+    if (!fileStream.good()) {
+        LERROR("Error opening file '" << cacheFile << "' for save cache file");
+        return false;
+    }
+
+    CacheHeader header = {};
+    header.version = CurrentCacheVersion;
+    header.nVertices = static_cast<int64_t>(vertices.size());
+    header.nIndices = static_cast<int64_t>(indices.size());
+
+    fileStream.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+    fileStream.write(reinterpret_cast<const char*>(vertices.data()),
+        sizeof(Vertex) * vertices.size());
+    fileStream.write(reinterpret_cast<const char*>(indices.data()),
+        sizeof(int) * indices.size());
+    return fileStream.good();
+}
+
+} // namespace modelgeometry
+} // namespace openspace
@@ -0,0 +1,151 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GEOMETRYREGISTRY_H__
+#define __GEOMETRYREGISTRY_H__
+
+#include <modules/base/rendering/modelgeometry.h>
+
+#include <openspace/util/mappedfile.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace openspace {
+namespace modelgeometry {
+
+/**
+ * The vertices and indices of one model file together with the OpenGL buffers they are
+ * uploaded to. All ModelGeometry objects that load the same file share one instance, so
+ * the file is parsed, held in memory, and uploaded only once. Whenever possible, the data
+ * is memory-mapped from the cache file and passed to OpenGL without being copied.
+ */
+class SharedGeometry {
+public:
+    using Vertex = ModelGeometry::Vertex;
+
+    SharedGeometry();
+    ~SharedGeometry();
+
+    bool isValid() const;
+
+    const Vertex* vertices() const;
+    size_t nVertices() const;
+    const int* indices() const;
+    size_t nIndices() const;
+
+    /// Returns the largest distance of a vertex from the origin of the model
+    double boundingRadius() const;
+
+    /// Returns the number of bytes of vertex and index data held in memory
+    size_t memoryFootprint() const;
+    bool isMapped() const;
+
+    /**
+     * Creates the OpenGL buffers if this is the first call that is not matched by a call
+     * to release. Has to be called on the thread that owns the OpenGL context.
+     */
+    void upload();
+
+    /// Deletes the OpenGL buffers when the last upload has been released
+    void release();
+
+    GLuint vertexArray() const;
+    GLuint indexBuffer() const;
+
+private:
+    friend class GeometryRegistry;
+
+    bool map(const std::string& cacheFile);
+    void setData(std::vector<Vertex> vertices, std::vector<int> indices);
+    void computeBoundingRadius();
+
+    std::mutex _loadMutex;
+    bool _isLoaded;
+
+    std::unique_ptr<MappedFile> _mapping;
+    std::vector<Vertex> _ownedVertices;
+    std::vector<int> _ownedIndices;
+
+    const Vertex* _vertices;
+    size_t _nVertices;
+    const int* _indices;
+    size_t _nIndices;
+    double _boundingRadius;
+
+    int _nUploads;
+    GLuint _vaoID;
+    GLuint _vbo;
+    GLuint _ibo;
+};
+
+/**
+ * The process-wide registry of SharedGeometry objects, keyed by the cache file of the
+ * model. It only holds weak references, so a geometry is freed as soon as the last
+ * ModelGeometry using it is destroyed. All methods are thread-safe.
+ */
+class GeometryRegistry {
+public:
+    using Vertex = ModelGeometry::Vertex;
+    /// Parses a model file into \p vertices and \p indices
+    using Loader = std::function<bool(std::vector<Vertex>& vertices,
+        std::vector<int>& indices)>;
+
+    static GeometryRegistry& ref();
+
+    /**
+     * Returns the geometry that is stored in \p cacheFile. If no other object currently
+     * uses it, the cache file is mapped; if the cache file is missing or outdated, the
+     * model is parsed with \p loader and a new cache file is written. Concurrent
+     * requests for the same file wait for the first one to finish loading.
+     */
+    std::shared_ptr<SharedGeometry> acquire(const std::string& cacheFile,
+        const Loader& loader);
+
+    /// Returns the number of distinct geometries that are currently in use
+    size_t size() const;
+
+    /**
+     * Writes \p vertices and \p indices into \p cacheFile in a format that can be mapped
+     * and uploaded directly.
+     */
+    static bool saveCacheFile(const std::string& cacheFile,
+        const std::vector<Vertex>& vertices, const std::vector<int>& indices);
+
+private:
+    void load(SharedGeometry& geometry, const std::string& cacheFile,
+        const Loader& loader);
+
+    mutable std::mutex _mutex;
+    std::map<std::string, std::weak_ptr<SharedGeometry>> _geometries;
+};
+
+} // namespace modelgeometry
+} // namespace openspace
+
+#endif // __GEOMETRYREGISTRY_H__
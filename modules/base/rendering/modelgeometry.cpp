@@ -23,16 +23,15 @@
  ****************************************************************************************/
 
 #include <modules/base/rendering/modelgeometry.h>
+
+#include <modules/base/rendering/geometryregistry.h>
 #include <openspace/util/factorymanager.h>
 #include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 
-#include <fstream>
-
 namespace {
     const std::string _loggerCat = "ModelGeometry";
     const std::string keyGeomModelFile = "GeometryFile";
-    const int8_t CurrentCacheVersion = 3;
     const std::string keyType = "Type";
     const std::string keyName = "Name";
     const std::string keySize = "Magnification";
@@ -66,6 +65,7 @@ ModelGeometry::ModelGeometry(const ghoul::Dictionary& dictionary)
     : _parent(nullptr)
     , _magnification("magnification", "Magnification", 1.f, 0.f, 10.f)
     , _mode(GL_TRIANGLES)
+    , _isUploaded(false)
 {
     setName("ModelGeometry");
 
@@ -85,23 +85,19 @@ ModelGeometry::ModelGeometry(const ghoul::Dictionary& dictionary)
 
     if (!FileSys.fileExists(_file, ghoul::filesystem::FileSystem::RawPath::Yes))
         LERROR("Could not load the geometric model file '" << _file << "': File not found");
-    
+
+    // The cache manager is not thread-safe, so the cached filename has to be requested
+    // here rather than in loadResources
+    _cachedFile = FileSys.cacheManager()->cachedFilename(
+        _file,
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
 
     addProperty(_magnification);
 }
 
 double ModelGeometry::boundingRadius() const {
-    double maxDistSquared = 0;
-    double distSquared;
-    for (const Vertex& v : _vertices) {
-        distSquared = // x*x + y*y + z*z
-            v.location[0] * v.location[0] +
-            v.location[1] * v.location[1] +
-            v.location[2] * v.location[2];
-        maxDistSquared = glm::max(maxDistSquared, distSquared);
-    }
-    double maxDist = std::sqrt(maxDistSquared);
-    return maxDist;
+    return _geometry ? _geometry->boundingRadius() : 0.0;
 }
 
 
@@ -109,9 +105,16 @@ ModelGeometry::~ModelGeometry() {
 }
 
 void ModelGeometry::render() {
-    glBindVertexArray(_vaoID);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
-    glDrawElements(_mode, static_cast<GLsizei>(_indices.size()), GL_UNSIGNED_INT, 0);
+    if (!_isUploaded)
+        return;
+    glBindVertexArray(_geometry->vertexArray());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _geometry->indexBuffer());
+    glDrawElements(
+        _mode,
+        static_cast<GLsizei>(_geometry->nIndices()),
+        GL_UNSIGNED_INT,
+        0
+    );
     glBindVertexArray(0);
 }
 
@@ -119,155 +122,66 @@ void ModelGeometry::changeRenderMode(const GLenum mode) {
     _mode = mode;
 }
 
-bool ModelGeometry::initialize(Renderable* parent) {
-    _parent = parent;
-    float maximumDistanceSquared = 0;
-    for (auto v: _vertices)
-    {
-        maximumDistanceSquared = glm::max(
-            glm::pow(v.location[0], 2.f) +
-            glm::pow(v.location[1], 2.f) +
-            glm::pow(v.location[2], 2.f), maximumDistanceSquared);
-    }
-    _parent->setBoundingSphere(PowerScaledScalar(glm::sqrt(maximumDistanceSquared), 0.0));
-
-    if (_vertices.empty())
-        return false;
-    glGenVertexArrays(1, &_vaoID);
-    glGenBuffers(1, &_vbo);
-    glGenBuffers(1, &_ibo);
-
-    glBindVertexArray(_vaoID);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(Vertex), _vertices.data(), GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-        reinterpret_cast<const GLvoid*>(offsetof(Vertex, location)));
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-        reinterpret_cast<const GLvoid*>(offsetof(Vertex, tex)));
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-        reinterpret_cast<const GLvoid*>(offsetof(Vertex, normal)));
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(int), _indices.data(), GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-
-    return true;
-}
-
-void ModelGeometry::deinitialize() {
-    glDeleteBuffers(1, &_vbo);
-    glDeleteVertexArrays(1, &_vaoID);
-    glDeleteBuffers(1, &_ibo);
-}
-
-bool ModelGeometry::loadObj(const std::string& filename) {
-    std::string cachedFile = FileSys.cacheManager()->cachedFilename(
-        filename,
-        ghoul::filesystem::CacheManager::Persistent::Yes
+bool ModelGeometry::loadResources() {
+    if (!_geometry) {
+        // Models that are used by several renderables are only loaded and uploaded once
+        _geometry = GeometryRegistry::ref().acquire(
+            _cachedFile,
+            [this](std::vector<Vertex>& vertices, std::vector<int>& indices) {
+                LINFO("Loading Model file '" << _file << "'");
+                bool success = loadModel(_file);
+                vertices.swap(_vertices);
+                indices.swap(_indices);
+                _vertices.clear();
+                _indices.clear();
+                return success;
+            }
         );
-
-    bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO("Cached file '" << cachedFile << "' used for Model file '" << filename << "'");
-
-        bool success = loadCachedFile(cachedFile);
-        if (success)
-            return true;
-        else
-            FileSys.cacheManager()->removeCacheFile(filename);
-        // Intentional fall-through to the 'else' computation to generate the cache
-        // file for the next run
     }
-    else {
-        LINFO("Cached file '" << cachedFile << "' used for Model file '" << filename << "' not found");
-    }
-
-    LINFO("Loading Model file '" << filename << "'");
-    bool success = loadModel(filename);
-
-    if (!success)
-        return false;
-
-    LINFO("Saving cache");
-    success = saveCachedFile(cachedFile);
-
-    return success;
+    return _geometry->isValid();
 }
 
-bool ModelGeometry::saveCachedFile(const std::string& filename) {
-    std::ofstream fileStream(filename, std::ofstream::binary);
-    if (fileStream.good()) {
-        fileStream.write(reinterpret_cast<const char*>(&CurrentCacheVersion),
-            sizeof(int8_t));
-
-        int64_t vSize = _vertices.size();
-        fileStream.write(reinterpret_cast<const char*>(&vSize), sizeof(int64_t));
-        int64_t iSize = _indices.size();
-        fileStream.write(reinterpret_cast<const char*>(&iSize), sizeof(int64_t));
-
-        fileStream.write(reinterpret_cast<const char*>(_vertices.data()), sizeof(Vertex) * vSize);
-        fileStream.write(reinterpret_cast<const char*>(_indices.data()), sizeof(int) * iSize);
-
-        return fileStream.good();
-    }
-    else {
-        LERROR("Error opening file '" << filename << "' for save cache file");
+bool ModelGeometry::initialize(Renderable* parent) {
+    _parent = parent;
+    if (!loadResources()) {
+        _parent->setBoundingSphere(PowerScaledScalar(0.f, 0.0));
         return false;
     }
-}
-
-bool ModelGeometry::loadCachedFile(const std::string& filename) {
-    std::ifstream fileStream(filename, std::ifstream::binary);
-    if (fileStream.good()) {
-        int8_t version = 0;
-        fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-        if (version != CurrentCacheVersion) {
-            LINFO("The format of the cached file has changed, deleting old cache");
-            fileStream.close();
-            FileSys.deleteFile(filename);
-            return false;
-        }
-
-        int64_t vSize, iSize;
-        fileStream.read(reinterpret_cast<char*>(&vSize), sizeof(int64_t));
-        fileStream.read(reinterpret_cast<char*>(&iSize), sizeof(int64_t));
 
-        if (vSize == 0 || iSize == 0) {
-            LERROR("Error opening file '" << filename << "' for loading cache file");
-            return false;
-        }
+    _parent->setBoundingSphere(
+        PowerScaledScalar(static_cast<float>(_geometry->boundingRadius()), 0.0)
+    );
 
-        _vertices.resize(vSize);
-        _indices.resize(iSize);
-
-        fileStream.read(reinterpret_cast<char*>(_vertices.data()), sizeof(Vertex) * vSize);
-        fileStream.read(reinterpret_cast<char*>(_indices.data()), sizeof(int) * iSize);
-
-        return fileStream.good();
+    if (!_isUploaded) {
+        _geometry->upload();
+        _isUploaded = true;
     }
-    else {
-        LERROR("Error opening file '" << filename << "' for loading cache file");
-        return false;
+    return true;
+}
+
+void ModelGeometry::deinitialize() {
+    if (_isUploaded) {
+        _geometry->release();
+        _isUploaded = false;
     }
 }
 
 bool ModelGeometry::getVertices(std::vector<Vertex>* vertexList) {
     vertexList->clear();
-    for (auto v : _vertices)
-        vertexList->push_back(v);
+    if (_geometry) {
+        const Vertex* v = _geometry->vertices();
+        vertexList->assign(v, v + _geometry->nVertices());
+    }
 
     return !(vertexList->empty());
 }
 
 bool ModelGeometry::getIndices(std::vector<int>* indexList) {
     indexList->clear();
-    for (auto i : _indices)
-        indexList->push_back(i);
+    if (_geometry) {
+        const int* i = _geometry->indices();
+        indexList->assign(i, i + _geometry->nIndices());
+    }
 
     return !(indexList->empty());
 }
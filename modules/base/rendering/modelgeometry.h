@@ -31,10 +31,14 @@
 #include <modules/base/rendering/renderablemodel.h>
 #include <ghoul/misc/dictionary.h>
 
+#include <memory>
+
 namespace openspace {
 
 namespace modelgeometry {
 
+class SharedGeometry;
+
 class ModelGeometry : public properties::PropertyOwner {
 public:
     static ModelGeometry* createFromDictionary(const ghoul::Dictionary& dictionary);
@@ -47,6 +51,15 @@ public:
 
     ModelGeometry(const ghoul::Dictionary& dictionary);
     virtual ~ModelGeometry();
+
+    /**
+     * Acquires the geometry of the model file from the GeometryRegistry, which maps the
+     * cache file or parses the model file if no other ModelGeometry uses it yet. This
+     * does not touch any OpenGL state, so it can be called from a worker thread. If it
+     * has not been called beforehand, #initialize will call it.
+     * \return <code>true</code> if the vertices and indices are available
+     */
+    virtual bool loadResources();
     virtual bool initialize(Renderable* parent);
     virtual void deinitialize();
     void render();
@@ -62,19 +75,18 @@ public:
 protected:
     Renderable* _parent;
 
-    bool loadObj(const std::string& filename);
-    bool loadCachedFile(const std::string& filename);
-    bool saveCachedFile(const std::string& filename);
     properties::FloatProperty _magnification;
 
-    GLuint _vaoID;
-    GLuint _vbo;
-    GLuint _ibo;
     GLenum _mode;
 
+    /// The output of loadModel, which is moved into the SharedGeometry afterwards
     std::vector<Vertex> _vertices;
     std::vector<int> _indices;
     std::string _file;
+    std::string _cachedFile;
+
+    std::shared_ptr<SharedGeometry> _geometry;
+    bool _isUploaded;
 };
 
 }  // namespace modelgeometry
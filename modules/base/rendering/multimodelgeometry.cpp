@@ -39,9 +39,7 @@ namespace openspace {
 
         MultiModelGeometry::MultiModelGeometry(const ghoul::Dictionary& dictionary)
             : ModelGeometry(dictionary)
-        {
-            loadObj(_file);
-        }
+        {}
 
         bool MultiModelGeometry::initialize(Renderable* parent)
         {
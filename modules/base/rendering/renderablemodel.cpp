@@ -130,6 +130,10 @@ bool RenderableModel::isReady() const {
     return ready;
 }
 
+bool RenderableModel::loadResources() {
+    return _geometry && _geometry->loadResources();
+}
+
 bool RenderableModel::initialize() {
     bool completeSuccess = true;
     if (_programObject == nullptr) {
@@ -43,6 +43,7 @@ class RenderableModel : public Renderable {
 public:
     RenderableModel(const ghoul::Dictionary& dictionary);
 
+    bool loadResources() override;
     bool initialize() override;
     bool deinitialize() override;
 
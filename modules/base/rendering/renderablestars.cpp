@@ -118,6 +118,12 @@ RenderableStars::RenderableStars(const ghoul::Dictionary& dictionary)
         return;
     }
     _speckFile = absPath(_speckFile);
+    // The cache manager is not thread-safe, so the cached filename has to be requested
+    // here rather than in loadResources
+    _cachedFile = FileSys.cacheManager()->cachedFilename(
+        _speckFile,
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
 
     _colorOption.addOption(ColorOption::Color, "Color");
     _colorOption.addOption(ColorOption::Velocity, "Velocity");
@@ -147,6 +153,10 @@ bool RenderableStars::isReady() const {
     return (_program != nullptr) && (!_fullData.empty());
 }
 
+bool RenderableStars::loadResources() {
+    return loadData();
+}
+
 bool RenderableStars::initialize() {
     bool completeSuccess = true;
 
@@ -158,7 +168,8 @@ bool RenderableStars::initialize() {
 
     if (!_program)
         return false;
-    completeSuccess &= loadData();
+    if (_fullData.empty())
+        completeSuccess &= loadData();
     completeSuccess &= (_pointSpreadFunctionTexture != nullptr);
 
     return completeSuccess;
@@ -350,10 +361,7 @@ void RenderableStars::update(const UpdateData& data) {
 
 bool RenderableStars::loadData() {
     std::string _file = _speckFile;
-    std::string cachedFile = FileSys.cacheManager()->cachedFilename(
-        _file,
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
+    const std::string& cachedFile = _cachedFile;
 
     bool hasCachedFile = FileSys.fileExists(cachedFile);
     if (hasCachedFile) {
@@ -362,10 +370,9 @@ bool RenderableStars::loadData() {
         bool success = loadCachedFile(cachedFile);
         if (success)
             return true;
-        else
-            FileSys.cacheManager()->removeCacheFile(_file);
-            // Intentional fall-through to the 'else' computation to generate the cache
-            // file for the next run
+        // Intentional fall-through to the 'else' computation to regenerate the cache
+        // file, which overwrites the broken one
+        _fullData.clear();
     }
     else {
         LINFO("Cache for Speck file '" << _file << "' not found");
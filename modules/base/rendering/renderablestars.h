@@ -40,6 +40,7 @@ public:
     explicit RenderableStars(const ghoul::Dictionary& dictionary);
     ~RenderableStars();
 
+    bool loadResources() override;
     bool initialize() override;
     bool deinitialize() override;
 
@@ -80,6 +81,7 @@ private:
     std::unique_ptr<ghoul::opengl::ProgramObject> _program;
 
     std::string _speckFile;
+    std::string _cachedFile;
 
     std::vector<float> _slicedData;
     std::vector<float> _fullData;
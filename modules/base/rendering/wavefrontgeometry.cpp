@@ -36,9 +36,7 @@ namespace modelgeometry {
 
 WavefrontGeometry::WavefrontGeometry(const ghoul::Dictionary& dictionary)
     : ModelGeometry(dictionary) 
-{
-    loadObj(_file);
-}
+{}
 
 bool WavefrontGeometry::initialize(Renderable* parent) {
     bool success = ModelGeometry::initialize(parent);
@@ -70,10 +70,45 @@ namespace openspace {
     void Chunk::setIndex(const ChunkIndex& index) {
         _index = index;
         _surfacePatch = GeodeticPatch(index);
+        invalidateBoundingVolumes();
     }
 
     void Chunk::setOwner(ChunkedLodGlobe* newOwner) {
         _owner = newOwner;
+        invalidateBoundingVolumes();
+    }
+
+    void Chunk::invalidateBoundingVolumes() {
+        _boundingVolumes.isDirty = true;
+    }
+
+    const Chunk::BoundingVolumes& Chunk::boundingVolumes() const {
+        if (_boundingVolumes.isDirty) {
+            _boundingVolumes.heights = calculateBoundingHeights();
+            _boundingVolumes.corners =
+                calculateBoundingPolyhedronCorners(_boundingVolumes.heights);
+
+            _boundingVolumes.box = AABB3();
+            for (const glm::dvec4& corner : _boundingVolumes.corners) {
+                _boundingVolumes.box.expand(glm::vec3(corner));
+            }
+
+            _boundingVolumes.isDirty = false;
+            _owner->boundingVolumeRecomputations++;
+        }
+        return _boundingVolumes;
+    }
+
+    Chunk::BoundingHeights Chunk::getBoundingHeights() const {
+        return boundingVolumes().heights;
+    }
+
+    const std::vector<glm::dvec4>& Chunk::getBoundingPolyhedronCorners() const {
+        return boundingVolumes().corners;
+    }
+
+    const AABB3& Chunk::getBoundingBox() const {
+        return boundingVolumes().box;
     }
 
     Chunk::Status Chunk::update(const RenderData& data) {
@@ -95,7 +130,7 @@ namespace openspace {
         else return Status::DO_NOTHING;
     }
 
-    Chunk::BoundingHeights Chunk::getBoundingHeights() const {
+    Chunk::BoundingHeights Chunk::calculateBoundingHeights() const {
         BoundingHeights boundingHeights;
         boundingHeights.max = 0;
         boundingHeights.min = 0;
@@ -147,12 +182,12 @@ namespace openspace {
         return boundingHeights;
     }
 
-    std::vector<glm::dvec4> Chunk::getBoundingPolyhedronCorners() const {
+    std::vector<glm::dvec4> Chunk::calculateBoundingPolyhedronCorners(
+        const BoundingHeights& boundingHeight) const
+    {
         const Ellipsoid& ellipsoid = owner()->ellipsoid();
         const GeodeticPatch& patch = surfacePatch();
 
-        BoundingHeights boundingHeight = getBoundingHeights();
-
         // assume worst case
         double patchCenterRadius = ellipsoid.maximumRadius();
 
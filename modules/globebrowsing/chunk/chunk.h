@@ -37,6 +37,7 @@
 
 #include <modules/globebrowsing/geometry/geodetic2.h>
 #include <modules/globebrowsing/geometry/angle.h>
+#include <modules/globebrowsing/geometry/aabb.h>
 
 
 namespace openspace {
@@ -64,25 +65,62 @@ namespace openspace {
         /// Updates chunk internally and returns a desired level
         Status update(const RenderData& data);
 
-        std::vector<glm::dvec4> getBoundingPolyhedronCorners() const;
+        /**
+        * Returns the eight model space corners of a polyhedron enclosing the chunk,
+        * including its height data. The first four corners are at the minimum height.
+        * The corners are cached until <code>invalidateBoundingVolumes</code> is called.
+        */
+        const std::vector<glm::dvec4>& getBoundingPolyhedronCorners() const;
+
+        /**
+        * Returns the model space axis aligned bounding box of the bounding polyhedron
+        */
+        const AABB3& getBoundingBox() const;
 
         const GeodeticPatch& surfacePatch() const;
         ChunkedLodGlobe* const owner() const;
         const ChunkIndex index() const;
         bool isVisible() const;
+
+        /**
+        * Returns the minimum and maximum heights of the chunk as given by the highest
+        * resolution height tiles available. The heights are cached until
+        * <code>invalidateBoundingVolumes</code> is called.
+        */
         BoundingHeights getBoundingHeights() const;
 
+        /**
+        * Marks the cached bounding heights, corners and bounding box as outdated. They
+        * are recomputed the next time any of them is requested. This should be called
+        * when a height tile for this chunk or any of its ancestors becomes available.
+        */
+        void invalidateBoundingVolumes();
+
         void setIndex(const ChunkIndex& index);
         void setOwner(ChunkedLodGlobe* newOwner);
 
 
     private:
 
+        struct BoundingVolumes {
+            BoundingHeights heights;
+            std::vector<glm::dvec4> corners;
+            AABB3 box;
+            bool isDirty = true;
+        };
+
+        BoundingHeights calculateBoundingHeights() const;
+        std::vector<glm::dvec4> calculateBoundingPolyhedronCorners(
+            const BoundingHeights& heights) const;
+        const BoundingVolumes& boundingVolumes() const;
+
         ChunkedLodGlobe* _owner;
         ChunkIndex _index;
         bool _isVisible;
         GeodeticPatch _surfacePatch;
 
+        mutable BoundingVolumes _boundingVolumes;
+
     };
 
 
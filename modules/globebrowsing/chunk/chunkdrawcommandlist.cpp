@@ -0,0 +1,145 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/chunk/chunkdrawcommandlist.h>
+
+#include <algorithm>
+
+namespace {
+    using Command = openspace::ChunkDrawCommandList::Command;
+
+    // Tiles in different layers of the same array texture are sampled through the same
+    // binding, the layer is part of the draw data of the chunk
+    GLuint arrayTexture(const Command& command, size_t slot) {
+        return command.tiles[slot].tile.textureSlot->arrayTexture();
+    }
+
+    bool samplesSameTextures(const Command& a, const Command& b) {
+        if (a.tiles.size() != b.tiles.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.tiles.size(); ++i) {
+            if (arrayTexture(a, i) != arrayTexture(b, i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool drawsBefore(const Command& a, const Command& b) {
+        if (a.permutation != b.permutation) {
+            return a.permutation < b.permutation;
+        }
+        size_t nTiles = std::min(a.tiles.size(), b.tiles.size());
+        for (size_t i = 0; i < nTiles; ++i) {
+            GLuint ta = arrayTexture(a, i);
+            GLuint tb = arrayTexture(b, i);
+            if (ta != tb) {
+                return ta < tb;
+            }
+        }
+        return a.tiles.size() < b.tiles.size();
+    }
+}
+
+namespace openspace {
+
+    void ChunkDrawCommandList::add(Command command) {
+        _commands.push_back(std::move(command));
+    }
+
+    void ChunkDrawCommandList::clear() {
+        _commands.clear();
+        _batches.clear();
+    }
+
+    void ChunkDrawCommandList::sort() {
+        std::stable_sort(_commands.begin(), _commands.end(), drawsBefore);
+
+        _batches.clear();
+        for (size_t i = 0; i < _commands.size(); ++i) {
+            int permutation = _commands[i].permutation;
+            if (_batches.empty() || _batches.back().permutation != permutation) {
+                _batches.push_back({ permutation, i, i + 1, { { i, i + 1 } } });
+                continue;
+            }
+
+            Batch& batch = _batches.back();
+            batch.end = i + 1;
+            if (samplesSameTextures(_commands[i - 1], _commands[i])) {
+                batch.multiDraws.back().end = i + 1;
+            }
+            else {
+                batch.multiDraws.push_back({ i, i + 1 });
+            }
+        }
+    }
+
+    const std::vector<ChunkDrawCommandList::Command>&
+        ChunkDrawCommandList::commands() const
+    {
+        return _commands;
+    }
+
+    const std::vector<ChunkDrawCommandList::Batch>& ChunkDrawCommandList::batches() const
+    {
+        return _batches;
+    }
+
+    size_t ChunkDrawCommandList::size() const {
+        return _commands.size();
+    }
+
+    bool ChunkDrawCommandList::empty() const {
+        return _commands.empty();
+    }
+
+    size_t ChunkDrawCommandList::numTextureBinds() const {
+        size_t nBinds = 0;
+        for (size_t i = 0; i < _commands.size(); ++i) {
+            const Command& command = _commands[i];
+            const Command* previous = nullptr;
+            if (i > 0 && _commands[i - 1].permutation == command.permutation) {
+                previous = &_commands[i - 1];
+            }
+            for (size_t slot = 0; slot < command.tiles.size(); ++slot) {
+                bool sameAsPrevious = previous && slot < previous->tiles.size() &&
+                    arrayTexture(*previous, slot) == arrayTexture(command, slot);
+                if (!sameAsPrevious) {
+                    ++nBinds;
+                }
+            }
+        }
+        return nBinds;
+    }
+
+    size_t ChunkDrawCommandList::numDrawCalls() const {
+        size_t nDrawCalls = 0;
+        for (const Batch& batch : _batches) {
+            nDrawCalls += batch.multiDraws.size();
+        }
+        return nDrawCalls;
+    }
+
+} // namespace openspace
@@ -0,0 +1,120 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __CHUNK_DRAW_COMMAND_LIST_H__
+#define __CHUNK_DRAW_COMMAND_LIST_H__
+
+#include <modules/globebrowsing/tile/tileselector.h>
+
+#include <vector>
+
+namespace openspace {
+
+    class Chunk;
+
+    /**
+    * A CPU-side list of the chunks to draw in a frame, together with the tiles each of
+    * them samples. Sorting the list orders the chunks so that those rendered with the
+    * same shader permutation are drawn together, and so that consecutive chunks share
+    * as many textures as possible. Tiles are compared by the array texture of their
+    * texture slot, as tiles in different layers of it are sampled through the same
+    * binding. The list does not touch any OpenGL state and can be built and inspected
+    * without a GPU.
+    */
+    class ChunkDrawCommandList {
+    public:
+        struct Command {
+            const Chunk* chunk;
+
+            /// Identifies the shader program the chunk is rendered with
+            int permutation;
+
+            /// The tile for every texture slot of the permutation, in slot order
+            std::vector<TileAndTransform> tiles;
+        };
+
+        /**
+        * A range <code>[begin, end)</code> of commands within a batch that sample the
+        * same array textures in every slot. All commands of the range are drawn with
+        * one multi-draw call.
+        */
+        struct MultiDraw {
+            size_t begin;
+            size_t end;
+        };
+
+        /**
+        * A range <code>[begin, end)</code> of commands sharing the same permutation.
+        * All commands of a batch are drawn with one activation of the shader program.
+        */
+        struct Batch {
+            int permutation;
+            size_t begin;
+            size_t end;
+
+            /// The multi-draw calls of the batch, covering it in order
+            std::vector<MultiDraw> multiDraws;
+        };
+
+        void add(Command command);
+        void clear();
+
+        /**
+        * Orders the commands by permutation and then by the array textures they
+        * sample, and groups them into batches and multi-draw calls. Commands that
+        * compare equal keep the order they were added in.
+        */
+        void sort();
+
+        const std::vector<Command>& commands() const;
+
+        /**
+        * Returns the batches of the list. Only valid after <code>sort</code>.
+        */
+        const std::vector<Batch>& batches() const;
+
+        size_t size() const;
+        bool empty() const;
+
+        /**
+        * Returns the number of texture binds needed to execute the list in its current
+        * order, when a texture is only bound if it differs from the one the previous
+        * command in the same batch used in that slot.
+        */
+        size_t numTextureBinds() const;
+
+        /**
+        * Returns the number of multi-draw calls needed to execute the list. Only valid
+        * after <code>sort</code>.
+        */
+        size_t numDrawCalls() const;
+
+    private:
+        std::vector<Command> _commands;
+        std::vector<Batch> _batches;
+    };
+
+} // namespace openspace
+
+#endif // __CHUNK_DRAW_COMMAND_LIST_H__
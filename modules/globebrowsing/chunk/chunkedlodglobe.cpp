@@ -27,6 +27,9 @@
 #include <modules/globebrowsing/meshes/skirtedgrid.h>
 #include <modules/globebrowsing/chunk/culling.h>
 #include <modules/globebrowsing/chunk/chunklevelevaluator.h>
+#include <modules/globebrowsing/tile/tiletexturepool.h>
+#include <modules/globebrowsing/tile/tiletextureresidency.h>
+#include <modules/globebrowsing/tile/tileprocessor.h>
 
 #include <modules/debugging/rendering/debugrenderer.h>
 
@@ -68,9 +71,10 @@ namespace openspace {
         , _rightRoot(std::make_unique<ChunkNode>(Chunk(this, RIGHT_HEMISPHERE_INDEX)))
         , minSplitDepth(2)
         , maxSplitDepth(22)
+        , boundingVolumeRecomputations(0)
         , _savedCamera(nullptr)
         , _tileProviderManager(tileProviderManager)
-        , stats(StatsCollector(absPath("test_stats"), 1, StatsCollector::Enabled::No))
+        , stats(absPath("test_stats"), 1, StatsCollector::Enabled::No)
     {
 
         auto geometry = std::make_shared<SkirtedGrid>(
@@ -90,10 +94,41 @@ namespace openspace {
 
         _renderer = std::make_unique<ChunkRenderer>(geometry, tileProviderManager);
 
+        _statsKeys.time = stats.i.addKey("time");
+        _statsKeys.chunks = stats.i.addKey("chunks");
+        _statsKeys.chunkLeafs = stats.i.addKey("chunks leafs");
+        _statsKeys.renderedChunks = stats.i.addKey("rendered chunks");
+        _statsKeys.boundingVolumeRecomputations =
+            stats.i.addKey("bounding volume recomputations");
+        _statsKeys.tileTextureBytes = stats.i.addKey("tile texture bytes");
+        _statsKeys.tileTextureEvictions = stats.i.addKey("tile texture evictions");
+        _statsKeys.tileTexturePoolBytes = stats.i.addKey("tile texture pool bytes");
+        _statsKeys.tileTexturePoolFreeLayers =
+            stats.i.addKey("tile texture pool free layers");
+        _statsKeys.tileReadTime = stats.i.addKey("tile read us");
+        _statsKeys.tileConvertTime = stats.i.addKey("tile convert us");
+        _statsKeys.tileMipMapTime = stats.i.addKey("tile mipmap us");
+        _statsKeys.tileUploadTime = stats.i.addKey("tile upload us");
+
+        // Chunks derive their bounding volumes from the height maps, so they need to
+        // know when better height tiles become available
+        auto& heightMaps = _tileProviderManager->getTileProviderGroup(
+            LayeredTextures::HeightMaps);
+        for (auto& namedTileProvider : heightMaps.tileProviders) {
+            namedTileProvider.tileProvider->setTileArrivalCallback(
+                [this](const ChunkIndex& chunkIndex) {
+                    _arrivedHeightTiles.push_back(chunkIndex);
+                }
+            );
+        }
     }
 
     ChunkedLodGlobe::~ChunkedLodGlobe() {
-
+        auto& heightMaps = _tileProviderManager->getTileProviderGroup(
+            LayeredTextures::HeightMaps);
+        for (auto& namedTileProvider : heightMaps.tileProviders) {
+            namedTileProvider.tileProvider->setTileArrivalCallback(nullptr);
+        }
     }
 
     bool ChunkedLodGlobe::initialize() {
@@ -160,9 +195,12 @@ namespace openspace {
 
         auto duration = std::chrono::system_clock::now().time_since_epoch();
         auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-        stats.i["time"] = millis;
+        stats.i[_statsKeys.time] = millis;
 
         minDistToCamera = INFINITY;
+        boundingVolumeRecomputations = 0;
+
+        invalidateOutdatedBoundingVolumes();
 
         _leftRoot->updateChunkTree(data);
         _rightRoot->updateChunkTree(data);
@@ -172,17 +210,19 @@ namespace openspace {
         dmat4 vp = dmat4(data.camera.projectionMatrix()) * viewTransform;
         dmat4 mvp = vp * _modelTransform;
 
-        // Render function
-        std::function<void(const ChunkNode&)> renderJob = [this, &data, &mvp](const ChunkNode& chunkNode) {
-            stats.i["chunks"]++;
+        // Render function. The chunks are only queued here and drawn together once the
+        // whole tree has been traversed
+        std::vector<const Chunk*> renderedChunks;
+        std::function<void(const ChunkNode&)> renderJob =
+            [this, &renderedChunks](const ChunkNode& chunkNode) {
+            stats.i[_statsKeys.chunks]++;
             const Chunk& chunk = chunkNode.getChunk();
             if (chunkNode.isLeaf()){
-                stats.i["chunks leafs"]++;
+                stats.i[_statsKeys.chunkLeafs]++;
                 if (chunk.isVisible()) {
-                    stats.i["rendered chunks"]++;
-                    double t0 = Time::now().j2000Seconds();
-                    _renderer->renderChunk(chunkNode.getChunk(), data);
-                    debugRenderChunk(chunk, mvp);
+                    stats.i[_statsKeys.renderedChunks]++;
+                    _renderer->queueChunk(chunk);
+                    renderedChunks.push_back(&chunk);
                 }
             }
         };
@@ -190,10 +230,55 @@ namespace openspace {
         _leftRoot->reverseBreadthFirst(renderJob);
         _rightRoot->reverseBreadthFirst(renderJob);
 
+        _renderer->renderQueuedChunks(data);
+
+        for (const Chunk* chunk : renderedChunks) {
+            debugRenderChunk(*chunk, mvp);
+        }
+
         if (_savedCamera != nullptr) {
             DebugRenderer::ref().renderCameraFrustum(data, *_savedCamera);
         }
 
+        stats.i[_statsKeys.boundingVolumeRecomputations] = boundingVolumeRecomputations;
+        stats.i[_statsKeys.tileTextureBytes] =
+            TileTextureResidency::ref().residentBytes();
+        stats.i[_statsKeys.tileTextureEvictions] =
+            TileTextureResidency::ref().numEvictions();
+
+        // The pools allocate whole pages, the free layers in them are fragmentation.
+        // Collecting them builds a map, so it is skipped when nothing is recorded
+        if (stats.isEnabled()) {
+            size_t poolBytes = 0;
+            size_t poolFreeLayers = 0;
+            for (const auto& pool : TileTexturePool::allStatistics()) {
+                poolBytes += pool.second.numBytes;
+                poolFreeLayers += pool.second.numLayers - pool.second.numUsedLayers;
+            }
+            stats.i[_statsKeys.tileTexturePoolBytes] = poolBytes;
+            stats.i[_statsKeys.tileTexturePoolFreeLayers] = poolFreeLayers;
+        }
+
+        // Time spent in each stage of the tile pipeline of this globe's tile providers
+        // since the previous frame
+        TileStageTimes stageTimes;
+        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES;
+            ++category)
+        {
+            auto& tileProviders =
+                _tileProviderManager->getTileProviderGroup(category).tileProviders;
+            for (auto& namedTileProvider : tileProviders) {
+                namedTileProvider.tileProvider->takeStageTimes(stageTimes);
+            }
+        }
+        stats.i[_statsKeys.tileReadTime] = stageTimes.take(TileStageTimes::Stage::Read);
+        stats.i[_statsKeys.tileConvertTime] =
+            stageTimes.take(TileStageTimes::Stage::Convert);
+        stats.i[_statsKeys.tileMipMapTime] =
+            stageTimes.take(TileStageTimes::Stage::MipMap);
+        stats.i[_statsKeys.tileUploadTime] =
+            stageTimes.take(TileStageTimes::Stage::Upload);
+
         //LDEBUG("min distnace to camera: " << minDistToCamera);
 
         Vec3 cameraPos = data.camera.position().dvec3();
@@ -205,9 +290,26 @@ namespace openspace {
     }
 
 
+    void ChunkedLodGlobe::invalidateOutdatedBoundingVolumes() {
+        auto activeHeightProviders = _tileProviderManager->getTileProviderGroup(
+            LayeredTextures::HeightMaps).getActiveTileProviders();
+        if (activeHeightProviders != _activeHeightProviders) {
+            // Toggling a height map changes the heights of every chunk
+            _activeHeightProviders = activeHeightProviders;
+            _arrivedHeightTiles.clear();
+            _arrivedHeightTiles.push_back(ChunkIndex(0, 0, 0));
+        }
+
+        for (const ChunkIndex& chunkIndex : _arrivedHeightTiles) {
+            _leftRoot->invalidateBoundingVolumes(chunkIndex);
+            _rightRoot->invalidateBoundingVolumes(chunkIndex);
+        }
+        _arrivedHeightTiles.clear();
+    }
+
     void ChunkedLodGlobe::debugRenderChunk(const Chunk& chunk, const glm::dmat4& mvp) const {
         if (debugOptions.showChunkBounds || debugOptions.showChunkAABB) {
-            const std::vector<glm::dvec4> modelSpaceCorners = chunk.getBoundingPolyhedronCorners();
+            const std::vector<glm::dvec4>& modelSpaceCorners = chunk.getBoundingPolyhedronCorners();
             std::vector<glm::vec4> clippingSpaceCorners(8);
             AABB3 screenSpaceBounds;
             for (size_t i = 0; i < 8; i++) {
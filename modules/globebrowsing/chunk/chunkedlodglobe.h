@@ -81,6 +81,12 @@ namespace openspace {
 
         double minDistToCamera;
 
+        /**
+        * Number of chunks whose cached bounding volumes were recomputed during the 
+        * current frame. Reset at the beginning of every call to <code>render</code>.
+        */
+        int boundingVolumeRecomputations;
+
         const Ellipsoid& ellipsoid() const;
         const glm::dmat4& modelTransform();
         const glm::dmat4& inverseModelTransform();
@@ -120,6 +126,13 @@ namespace openspace {
 
         void debugRenderChunk(const Chunk& chunk, const glm::dmat4& data) const;
 
+        /**
+        * Invalidates the cached bounding volumes of all chunks affected by height tiles
+        * that arrived since the last frame, or of all chunks if the set of active height
+        * maps has changed.
+        */
+        void invalidateOutdatedBoundingVolumes();
+
         static const GeodeticPatch COVERAGE;
 
         // Covers all negative longitudes
@@ -147,6 +160,27 @@ namespace openspace {
         std::shared_ptr<Camera> _savedCamera;
         
         std::shared_ptr<TileProviderManager> _tileProviderManager;
+
+        // Height tiles that arrived since the last frame
+        std::vector<ChunkIndex> _arrivedHeightTiles;
+        std::vector<std::shared_ptr<TileProvider>> _activeHeightProviders;
+
+        // Slots of the stats recorded every frame
+        struct StatsKeys {
+            StatsCollector::Key time;
+            StatsCollector::Key chunks;
+            StatsCollector::Key chunkLeafs;
+            StatsCollector::Key renderedChunks;
+            StatsCollector::Key boundingVolumeRecomputations;
+            StatsCollector::Key tileTextureBytes;
+            StatsCollector::Key tileTextureEvictions;
+            StatsCollector::Key tileTexturePoolBytes;
+            StatsCollector::Key tileTexturePoolFreeLayers;
+            StatsCollector::Key tileReadTime;
+            StatsCollector::Key tileConvertTime;
+            StatsCollector::Key tileMipMapTime;
+            StatsCollector::Key tileUploadTime;
+        } _statsKeys;
     };
 
 }  // namespace openspace
@@ -97,6 +97,37 @@ bool ChunkNode::updateChunkTree(const RenderData& data) {
     }
 }
 
+void ChunkNode::invalidateBoundingVolumes(const ChunkIndex& index) {
+    const ChunkIndex& ownIndex = _chunk.index();
+    int levelDifference = index.level - ownIndex.level;
+
+    if (levelDifference <= 0) {
+        // The index refers to this chunk or one of its ancestors
+        bool isAncestor = (ownIndex.x >> -levelDifference) == index.x &&
+            (ownIndex.y >> -levelDifference) == index.y;
+        if (isAncestor) {
+            _chunk.invalidateBoundingVolumes();
+            if (!isLeaf()) {
+                for (int i = 0; i < 4; ++i) {
+                    _children[i]->invalidateBoundingVolumes(index);
+                }
+            }
+        }
+        return;
+    }
+
+    bool isDescendant = (index.x >> levelDifference) == ownIndex.x &&
+        (index.y >> levelDifference) == ownIndex.y;
+    if (!isDescendant || isLeaf()) {
+        return;
+    }
+
+    // Descend to the child covering the index, see ChunkIndex::child
+    int shift = levelDifference - 1;
+    int quad = ((index.x >> shift) & 1) + 2 * ((index.y >> shift) & 1);
+    _children[quad]->invalidateBoundingVolumes(index);
+}
+
 void ChunkNode::depthFirst(const std::function<void(const ChunkNode&)>& f) const {
     f(*this);
     if (!isLeaf()) {
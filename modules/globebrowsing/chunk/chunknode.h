@@ -76,6 +76,14 @@ public:
 
     bool updateChunkTree(const RenderData& data);
 
+    /**
+    * Invalidates the cached bounding volumes of the chunk with the provided index and of
+    * all its descendants, as these chunks derive their bounding heights from the tile
+    * at that index. If the provided index is an ancestor of this node, the whole tree is
+    * invalidated. Chunks in other parts of the tree are left untouched.
+    */
+    void invalidateBoundingVolumes(const ChunkIndex& index);
+
     static int chunkNodeCount;
 
 
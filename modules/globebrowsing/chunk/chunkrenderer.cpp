@@ -27,6 +27,7 @@
 #include <modules/globebrowsing/chunk/chunkedlodglobe.h>
 #include <modules/globebrowsing/tile/layeredtextures.h>
 #include <modules/globebrowsing/tile/tileprovidermanager.h>
+#include <modules/globebrowsing/tile/tiletexturepool.h>
 
 // open space includes
 #include <openspace/engine/wrapper/windowwrapper.h>
@@ -37,8 +38,11 @@
 #include <ghoul/misc/assert.h>
 #include <ghoul/opengl/texture.h>
 #include <ghoul/opengl/textureunit.h>
+#include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
 
 // STL includes
+#include <algorithm>
+#include <numeric>
 #include <sstream> 
 
 #define _USE_MATH_DEFINES
@@ -52,6 +56,20 @@ namespace {
     const std::string keyShading = "PerformShading";
 
     const std::string keyBody = "Body";
+
+    // Vertex attribute location of the index of a chunk within a multi-draw call
+    const GLuint DrawIndexAttributeLocation = 3;
+
+    /**
+    * Shader storage buffers need OpenGL 4.3 and indirect draws with a base instance need
+    * OpenGL 4.2. Below that, every chunk is drawn on its own with its parameters set as
+    * uniforms.
+    */
+    bool supportsMultiDraw() {
+        using Version = ghoul::systemcapabilities::OpenGLCapabilitiesComponent::Version;
+        static const bool isSupported = !(OpenGLCap.openGLVersion() < Version{ 4, 3, 0 });
+        return isSupported;
+    }
 }
 
 namespace openspace {
@@ -62,6 +80,12 @@ namespace openspace {
         std::shared_ptr<TileProviderManager> tileProviderManager)
         : _tileProviderManager(tileProviderManager)
         , _grid(grid)
+        , _queuedLikelyPermutations(false)
+        , _chunkDrawDataBuffer(0)
+        , _tileDrawDataBuffer(0)
+        , _drawIndirectBuffer(0)
+        , _drawIndexBuffer(0)
+        , _numDrawIndices(0)
     {
         _globalRenderingShaderProvider = std::make_shared<LayeredTextureShaderProvider>(
                 "GlobalChunkedLodPatch",
@@ -78,17 +102,66 @@ namespace openspace {
 
     }
 
-    void ChunkRenderer::renderChunk(const Chunk& chunk, const RenderData& data) {
-        if (chunk.index().level < 10) {
-            renderChunkGlobally(chunk, data);
-        }
-        else {
-            renderChunkLocally(chunk, data);
+    ChunkRenderer::~ChunkRenderer() {
+        glDeleteBuffers(1, &_chunkDrawDataBuffer);
+        glDeleteBuffers(1, &_tileDrawDataBuffer);
+        glDeleteBuffers(1, &_drawIndirectBuffer);
+        glDeleteBuffers(1, &_drawIndexBuffer);
+    }
+
+    void ChunkRenderer::initializeDrawBuffers() {
+        if (!supportsMultiDraw() || _drawIndirectBuffer != 0) {
+            return;
         }
+        glGenBuffers(1, &_chunkDrawDataBuffer);
+        glGenBuffers(1, &_tileDrawDataBuffer);
+        glGenBuffers(1, &_drawIndirectBuffer);
+        glGenBuffers(1, &_drawIndexBuffer);
+        _chunkDrawDataBinding = std::make_unique<ShaderStorageBinding>();
+        _tileDrawDataBinding = std::make_unique<ShaderStorageBinding>();
+
+        // gl_DrawID needs OpenGL 4.6, so the index of each draw is instead read from
+        // an instanced attribute at the base instance of its indirect command
+        _grid->geometry().setInstanceIndexAttribute(
+            DrawIndexAttributeLocation, _drawIndexBuffer);
     }
 
     void ChunkRenderer::update() {
-        // unued atm. Could be used for caching or precalculating
+        _globalRenderingShaderProvider->updatePrecompilation();
+        _localRenderingShaderProvider->updatePrecompilation();
+    }
+
+    void ChunkRenderer::queueLikelyPermutations(
+        const LayeredTexturePreprocessingData& preprocessingData)
+    {
+        // Permutations queued for an earlier layer setup are less likely to be needed
+        _globalRenderingShaderProvider->clearPrecompilationQueue();
+        _localRenderingShaderProvider->clearPrecompilationQueue();
+
+        // Chunks close to the camera are rendered locally, so that program will be
+        // needed as soon as the camera approaches the globe
+        _globalRenderingShaderProvider->queuePrecompilation(preprocessingData);
+        _localRenderingShaderProvider->queuePrecompilation(preprocessingData);
+
+        // Toggling a layer adds or removes one layer of a category
+        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES;
+            category++)
+        {
+            int numTileProviders = static_cast<int>(std::min(
+                _tileProviderManager->getTileProviderGroup(category).tileProviders.size(),
+                static_cast<size_t>(LayeredTextures::MAX_NUM_TEXTURES_PER_CATEGORY)));
+            int lastLayerIdx =
+                preprocessingData.layeredTextureInfo[category].lastLayerIdx;
+            for (int toggledLastLayerIdx : { lastLayerIdx - 1, lastLayerIdx + 1 }) {
+                if (toggledLastLayerIdx < -1 || toggledLastLayerIdx >= numTileProviders) {
+                    continue;
+                }
+                LayeredTexturePreprocessingData toggled = preprocessingData;
+                toggled.layeredTextureInfo[category].lastLayerIdx = toggledLastLayerIdx;
+                _globalRenderingShaderProvider->queuePrecompilation(toggled);
+                _localRenderingShaderProvider->queuePrecompilation(toggled);
+            }
+        }
     }
 
 
@@ -117,93 +190,171 @@ namespace openspace {
 
     }
 
-    void ChunkRenderer::activateTileAndSetTileUniforms(
+    template <typename T>
+    void ChunkRenderer::setTileUniform(
         std::shared_ptr<LayeredTextureShaderUniformIdHandler> uniformIdHandler,
-        LayeredTextures::TextureCategory textureCategory,
-        LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes blendLayerSuffix,
-        size_t layerIndex,
-        ghoul::opengl::TextureUnit& texUnit,
-        const TileAndTransform& tileAndTransform)
+        const TileSlot& slot,
+        LayeredTextureShaderUniformIdHandler::GlslTileDataId tileDataId,
+        const T& value)
     {
-
-        // Blend tile with two parents
-        // The texture needs a unit to sample from
-        texUnit.activate();
-        tileAndTransform.tile.texture->bind();
-
-        uniformIdHandler->programObject().setUniform(
-            uniformIdHandler->getId(
-                textureCategory,
-                blendLayerSuffix,
-                layerIndex,
-                LayeredTextureShaderUniformIdHandler::GlslTileDataId::textureSampler),
-            texUnit);
-        uniformIdHandler->programObject().setUniform(
-            uniformIdHandler->getId(
-                textureCategory,
-                blendLayerSuffix,
-                layerIndex,
-                LayeredTextureShaderUniformIdHandler::GlslTileDataId::uvTransform_uvScale),
-            tileAndTransform.uvTransform.uvScale);
         uniformIdHandler->programObject().setUniform(
             uniformIdHandler->getId(
-                textureCategory,
-                blendLayerSuffix,
-                layerIndex,
-                LayeredTextureShaderUniformIdHandler::GlslTileDataId::uvTransform_uvOffset),
-            tileAndTransform.uvTransform.uvOffset);
+                slot.category,
+                slot.blendLayer,
+                slot.layerIndex,
+                tileDataId),
+            value);
+    }
+
+    void ChunkRenderer::updateTileSlots() {
+        _tileSlots.clear();
+        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES;
+            category++)
+        {
+            const TileProviderGroup& tileProviderGroup =
+                _tileProviderManager->getTileProviderGroup(category);
+            _activeTileProviders[category] = tileProviderGroup.getActiveTileProviders();
+
+            size_t numBlendLayers = tileProviderGroup.levelBlendingEnabled ?
+                LayeredTextureShaderUniformIdHandler::NUM_BLEND_TEXTURES : 1;
+            for (size_t i = 0; i < _activeTileProviders[category].size(); i++) {
+                for (size_t blendLayer = 0; blendLayer < numBlendLayers; blendLayer++) {
+                    _tileSlots.push_back({
+                        LayeredTextures::TextureCategory(category),
+                        LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes(
+                            blendLayer),
+                        i
+                    });
+                }
+            }
+        }
+    }
+
+    void ChunkRenderer::queueChunk(const Chunk& chunk) {
+        // The active tile providers can only change between frames
+        if (_commandList.empty()) {
+            updateTileSlots();
+        }
+
+        const ChunkIndex& chunkIndex = chunk.index();
+
+        ChunkDrawCommandList::Command command;
+        command.chunk = &chunk;
+        command.permutation = chunkIndex.level < 10 ? GlobalRendering : LocalRendering;
+        command.tiles.reserve(_tileSlots.size());
+
+        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES;
+            category++)
+        {
+            bool blend = _tileProviderManager->getTileProviderGroup(
+                category).levelBlendingEnabled;
+            for (auto& tileProvider : _activeTileProviders[category]) {
+                // Get the texture that should be used for rendering
+                TileAndTransform tileAndTransform =
+                    TileSelector::getHighestResolutionTile(
+                        tileProvider.get(), chunkIndex);
+                if (tileAndTransform.tile.status == Tile::Status::Unavailable) {
+                    tileAndTransform.tile = tileProvider->getDefaultTile();
+                    tileAndTransform.uvTransform.uvOffset = { 0, 0 };
+                    tileAndTransform.uvTransform.uvScale = { 1, 1 };
+                }
+                command.tiles.push_back(tileAndTransform);
+
+                // If blending is enabled, two more textures are needed
+                if (blend) {
+                    TileAndTransform tileAndTransformParent1 =
+                        TileSelector::getHighestResolutionTile(
+                            tileProvider.get(), chunkIndex, 1);
+                    Tile::Status status1 = tileAndTransformParent1.tile.status;
+                    if (status1 == Tile::Status::Unavailable) {
+                        tileAndTransformParent1 = tileAndTransform;
+                    }
+                    command.tiles.push_back(tileAndTransformParent1);
+
+                    TileAndTransform tileAndTransformParent2 =
+                        TileSelector::getHighestResolutionTile(
+                            tileProvider.get(), chunkIndex, 2);
+                    Tile::Status status2 = tileAndTransformParent2.tile.status;
+                    if (status2 == Tile::Status::Unavailable) {
+                        tileAndTransformParent2 = tileAndTransformParent1;
+                    }
+                    command.tiles.push_back(tileAndTransformParent2);
+                }
+            }
+        }
+
+        _commandList.add(std::move(command));
     }
 
+    void ChunkRenderer::renderQueuedChunks(const RenderData& data) {
+        initializeDrawBuffers();
+        _commandList.sort();
 
-    ProgramObject* ChunkRenderer::getActivatedProgramWithTileData(
+        // OpenGL rendering settings
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_BACK);
+
+        for (const ChunkDrawCommandList::Batch& batch : _commandList.batches()) {
+            renderBatch(batch, data);
+        }
+
+        _commandList.clear();
+    }
+
+    ProgramObject* ChunkRenderer::getActivatedProgram(
         LayeredTextureShaderProvider* layeredTextureShaderProvider,
         std::shared_ptr<LayeredTextureShaderUniformIdHandler> programUniformHandler,
-        const Chunk& chunk)
+        const ChunkedLodGlobe& owner)
     {
-        const ChunkIndex& chunkIndex = chunk.index();
-
-        std::array<std::vector<std::shared_ptr<TileProvider> >,
-            LayeredTextures::NUM_TEXTURE_CATEGORIES> tileProviders;
         LayeredTexturePreprocessingData layeredTexturePreprocessingData;
 
-        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES; category++) {
-            tileProviders[category] = _tileProviderManager->getTileProviderGroup(category).getActiveTileProviders();
-
+        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES;
+            category++)
+        {
             LayeredTextureInfo layeredTextureInfo;
-            layeredTextureInfo.lastLayerIdx = tileProviders[category].size() - 1;
-            layeredTextureInfo.layerBlendingEnabled = _tileProviderManager->getTileProviderGroup(category).levelBlendingEnabled;
+            layeredTextureInfo.lastLayerIdx = _activeTileProviders[category].size() - 1;
+            layeredTextureInfo.layerBlendingEnabled =
+                _tileProviderManager->getTileProviderGroup(category).levelBlendingEnabled;
 
-            layeredTexturePreprocessingData.layeredTextureInfo[category] = layeredTextureInfo;
+            layeredTexturePreprocessingData.layeredTextureInfo[category] =
+                layeredTextureInfo;
         }
 
         layeredTexturePreprocessingData.keyValuePairs.push_back(
             std::pair<std::string, std::string>(
                 "useAtmosphere",
-                std::to_string(chunk.owner()->atmosphereEnabled)));
+                std::to_string(owner.atmosphereEnabled)));
 
         layeredTexturePreprocessingData.keyValuePairs.push_back(
             std::pair<std::string, std::string>(
                 "showChunkEdges",
-                std::to_string(chunk.owner()->debugOptions.showChunkEdges)));
-
+                std::to_string(owner.debugOptions.showChunkEdges)));
 
         layeredTexturePreprocessingData.keyValuePairs.push_back(
             std::pair<std::string, std::string>(
                 "showHeightResolution",
-                std::to_string(chunk.owner()->debugOptions.showHeightResolution)));
+                std::to_string(owner.debugOptions.showHeightResolution)));
 
         layeredTexturePreprocessingData.keyValuePairs.push_back(
             std::pair<std::string, std::string>(
                 "showHeightIntensities",
-                std::to_string(chunk.owner()->debugOptions.showHeightIntensities)));
+                std::to_string(owner.debugOptions.showHeightIntensities)));
 
         layeredTexturePreprocessingData.keyValuePairs.push_back(
             std::pair<std::string, std::string>(
                 "defaultHeight",
                 std::to_string(Chunk::DEFAULT_HEIGHT)));
-        
 
+        layeredTexturePreprocessingData.keyValuePairs.push_back(
+            std::pair<std::string, std::string>(
+                "useMultiDraw",
+                std::to_string(supportsMultiDraw())));
 
+        layeredTexturePreprocessingData.keyValuePairs.push_back(
+            std::pair<std::string, std::string>(
+                "useTextureArrays",
+                std::to_string(TileTexturePool::usesArrayTextures())));
 
         // Now the shader program can be accessed
         ProgramObject* programObject =
@@ -212,260 +363,394 @@ namespace openspace {
 
         programUniformHandler->updateIdsIfNecessary(layeredTextureShaderProvider);
 
-        // Activate the shader program
-        programObject->activate();
-
-        // Initialize all texture units
-        struct BlendTexUnits {
-            ghoul::opengl::TextureUnit blendTexture0;
-            ghoul::opengl::TextureUnit blendTexture1;
-            ghoul::opengl::TextureUnit blendTexture2;
-        };
-        std::array<std::vector<BlendTexUnits>, LayeredTextures::NUM_TEXTURE_CATEGORIES> texUnits;
-        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES; category++) {
-            texUnits[category].resize(tileProviders[category].size());
+        // Queue the permutations that are one layer toggle away from the current one,
+        // again after every change of the layers
+        if (!_queuedLikelyPermutations ||
+            !(layeredTexturePreprocessingData == _likelyPermutationsOrigin))
+        {
+            queueLikelyPermutations(layeredTexturePreprocessingData);
+            _likelyPermutationsOrigin = layeredTexturePreprocessingData;
+            _queuedLikelyPermutations = true;
         }
 
-        // Go through all the categories
-        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES; category++) {
-            // Go through all the providers in this category
-            int i = 0;
-            for (auto it = tileProviders[category].begin(); it != tileProviders[category].end(); it++) {
-                auto tileProvider = it->get();
-
-                // Get the texture that should be used for rendering
-                TileAndTransform tileAndTransform = TileSelector::getHighestResolutionTile(tileProvider, chunkIndex);
-                if (tileAndTransform.tile.status == Tile::Status::Unavailable) {
-                    tileAndTransform.tile = tileProvider->getDefaultTile();
-                    tileAndTransform.uvTransform.uvOffset = { 0, 0 };
-                    tileAndTransform.uvTransform.uvScale = { 1, 1 };
-                }
+        // Activate the shader program
+        programObject->activate();
 
-                activateTileAndSetTileUniforms(
-                    programUniformHandler,
-                    LayeredTextures::TextureCategory(category),
-                    LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes::none,
-                    i,
-                    texUnits[category][i].blendTexture0,
-                    tileAndTransform);
+        return programObject;
+    }
 
-                // If blending is enabled, two more textures are needed
-                if (layeredTexturePreprocessingData.layeredTextureInfo[category].layerBlendingEnabled) {
-                    TileAndTransform tileAndTransformParent1 = TileSelector::getHighestResolutionTile(tileProvider, chunkIndex, 1);
-                    if (tileAndTransformParent1.tile.status == Tile::Status::Unavailable) {
-                        tileAndTransformParent1 = tileAndTransform;
-                    }
-                    activateTileAndSetTileUniforms(
-                        programUniformHandler,
-                        LayeredTextures::TextureCategory(category),
-                        LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes::Parent1,
-                        i,
-                        texUnits[category][i].blendTexture1,
-                        tileAndTransformParent1);
+    void ChunkRenderer::renderBatch(const ChunkDrawCommandList::Batch& batch,
+        const RenderData& data)
+    {
+        using namespace glm;
 
-                    TileAndTransform tileAndTransformParent2 = TileSelector::getHighestResolutionTile(tileProvider, chunkIndex, 2);
-                    if (tileAndTransformParent2.tile.status == Tile::Status::Unavailable) {
-                        tileAndTransformParent2 = tileAndTransformParent1;
-                    }
-                    activateTileAndSetTileUniforms(
-                        programUniformHandler,
-                        LayeredTextures::TextureCategory(category),
-                        LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes::Parent2,
-                        i,
-                        texUnits[category][i].blendTexture2,
-                        tileAndTransformParent2);
-                }
+        const std::vector<ChunkDrawCommandList::Command>& commands =
+            _commandList.commands();
+        ChunkedLodGlobe& owner = *commands[batch.begin].chunk->owner();
+        const Ellipsoid& ellipsoid = owner.ellipsoid();
+
+        bool renderGlobally = batch.permutation == GlobalRendering;
+        std::shared_ptr<LayeredTextureShaderUniformIdHandler> programUniformHandler =
+            renderGlobally ? _globalProgramUniformHandler : _localProgramUniformHandler;
+
+        ProgramObject* programObject = getActivatedProgram(
+            renderGlobally ?
+                _globalRenderingShaderProvider.get() :
+                _localRenderingShaderProvider.get(),
+            programUniformHandler,
+            owner);
+        if (programObject == nullptr) {
+            return;
+        }
 
-                /*
-                if (category == LayeredTextures::HeightMaps && tileAndTransform.tile.preprocessData) {
-                    //auto preprocessingData = tileAndTransform.tile.preprocessData;
-                    //float noDataValue = preprocessingData->noDataValues[0];
-                    programObject->setUniform(
-                        "minimumValidHeight[" + std::to_string(i) + "]",
-                        -100000);
-                }
-                */
-                i++;
-            }
+        // Every slot keeps its texture unit for the whole batch, so the samplers and
+        // the indices of the per-chunk tile draw data only need to be set once
+        std::vector<ghoul::opengl::TextureUnit> texUnits(_tileSlots.size());
+        for (size_t slot = 0; slot < _tileSlots.size(); slot++) {
+            texUnits[slot].activate();
+            programObject->setUniform(
+                programUniformHandler->getId(
+                    _tileSlots[slot].category,
+                    _tileSlots[slot].blendLayer,
+                    _tileSlots[slot].layerIndex,
+                    LayeredTextureShaderUniformIdHandler::GlslTileDataId::textureSampler),
+                texUnits[slot]);
+            setTileUniform(
+                programUniformHandler,
+                _tileSlots[slot],
+                LayeredTextureShaderUniformIdHandler::GlslTileDataId::drawDataIndex,
+                static_cast<int>(slot));
+        }
+        if (supportsMultiDraw() && !_tileSlots.empty()) {
+            programObject->setUniform(
+                "numTileSlots", static_cast<int>(_tileSlots.size()));
         }
 
         // Go through all the height maps and set depth tranforms
-        int i = 0;
-        auto it = tileProviders[LayeredTextures::HeightMaps].begin();
-        auto end = tileProviders[LayeredTextures::HeightMaps].end();
-        for (; it != end; it++) {
-            auto tileProvider = *it;
-
-            TileDepthTransform depthTransform = tileProvider->depthTransform();
+        auto& heightProviders = _activeTileProviders[LayeredTextures::HeightMaps];
+        for (size_t i = 0; i < heightProviders.size(); i++) {
             setDepthTransformUniforms(
                 programUniformHandler,
                 LayeredTextures::TextureCategory::HeightMaps,
                 LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes::none,
                 i,
-                depthTransform);
-            i++;
+                heightProviders[i]->depthTransform());
         }
 
-        // The length of the skirts is proportional to its size
-        programObject->setUniform("skirtLength", min(static_cast<float>(chunk.surfacePatch().halfSize().lat * 1000000), 8700.0f));
         programObject->setUniform("xSegments", _grid->xSegments());
-
-        if (chunk.owner()->debugOptions.showHeightResolution) {
-            programObject->setUniform("vertexResolution", glm::vec2(_grid->xSegments(), _grid->ySegments()));
-        }       
-        
-        return programObject;
-    }
-
-    void ChunkRenderer::renderChunkGlobally(const Chunk& chunk, const RenderData& data){
-
-        ProgramObject* programObject = getActivatedProgramWithTileData(
-            _globalRenderingShaderProvider.get(),
-            _globalProgramUniformHandler,
-            chunk);
-        if (programObject == nullptr) {
-            return;
+        if (owner.debugOptions.showHeightResolution) {
+            programObject->setUniform(
+                "vertexResolution",
+                glm::vec2(_grid->xSegments(), _grid->ySegments()));
         }
 
-        const Ellipsoid& ellipsoid = chunk.owner()->ellipsoid();
-
         bool performAnyBlending = false;
-        
-        for (int i = 0; i < LayeredTextures::NUM_TEXTURE_CATEGORIES; ++i) {
-            LayeredTextures::TextureCategory category = (LayeredTextures::TextureCategory)i;
-            if(_tileProviderManager->getTileProviderGroup(i).levelBlendingEnabled && _tileProviderManager->getTileProviderGroup(category).getActiveTileProviders().size() > 0){
-                performAnyBlending = true; 
+        for (size_t category = 0; category < LayeredTextures::NUM_TEXTURE_CATEGORIES;
+            category++)
+        {
+            bool blend =
+                _tileProviderManager->getTileProviderGroup(category).levelBlendingEnabled;
+            if (blend && _activeTileProviders[category].size() > 0) {
+                performAnyBlending = true;
                 break;
             }
         }
         if (performAnyBlending) {
-            // Calculations are done in the reference frame of the globe. Hence, the camera
-            // position needs to be transformed with the inverse model matrix
-            glm::dmat4 inverseModelTransform = chunk.owner()->inverseModelTransform();
-            glm::dvec3 cameraPosition =
-                glm::dvec3(inverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1));
-            float distanceScaleFactor = chunk.owner()->lodScaleFactor * ellipsoid.minimumRadius();
-            programObject->setUniform("cameraPosition", vec3(cameraPosition));
+            float distanceScaleFactor = owner.lodScaleFactor * ellipsoid.minimumRadius();
             programObject->setUniform("distanceScaleFactor", distanceScaleFactor);
-            programObject->setUniform("chunkLevel", chunk.index().level);
         }
-        
-        // Calculate other uniform variables needed for rendering
-        Geodetic2 swCorner = chunk.surfacePatch().getCorner(Quad::SOUTH_WEST);
-        auto patchSize = chunk.surfacePatch().size();
-        
-        dmat4 modelTransform = chunk.owner()->modelTransform();
+
+        dmat4 modelTransform = owner.modelTransform();
         dmat4 viewTransform = data.camera.combinedViewMatrix();
-        mat4 modelViewTransform = mat4(viewTransform * modelTransform);
-        mat4 modelViewProjectionTransform = data.camera.projectionMatrix() * modelViewTransform;
-
-        // Upload the uniform variables
-        programObject->setUniform("modelViewProjectionTransform", modelViewProjectionTransform);
-        programObject->setUniform("minLatLon", vec2(swCorner.toLonLatVec2()));
-        programObject->setUniform("lonLatScalingFactor", vec2(patchSize.toLonLatVec2()));
-        programObject->setUniform("radiiSquared", vec3(ellipsoid.radiiSquared()));
-
-        if (_tileProviderManager->getTileProviderGroup(
-                LayeredTextures::NightTextures).getActiveTileProviders().size() > 0 ||
-            _tileProviderManager->getTileProviderGroup(
-                LayeredTextures::WaterMasks).getActiveTileProviders().size() > 0) {
+        dmat4 modelViewTransform = viewTransform * modelTransform;
+
+        if (_activeTileProviders[LayeredTextures::NightTextures].size() > 0 ||
+            _activeTileProviders[LayeredTextures::WaterMasks].size() > 0)
+        {
             glm::vec3 directionToSunWorldSpace =
                 glm::normalize(-data.modelTransform.translation);
             glm::vec3 directionToSunCameraSpace =
                 (viewTransform * glm::dvec4(directionToSunWorldSpace, 0));
-            data.modelTransform.translation;
-            programObject->setUniform("modelViewTransform", modelViewTransform);
-            programObject->setUniform("lightDirectionCameraSpace", -directionToSunCameraSpace);
+            if (renderGlobally) {
+                programObject->setUniform("modelViewTransform", mat4(modelViewTransform));
+            }
+            programObject->setUniform(
+                "lightDirectionCameraSpace", -directionToSunCameraSpace);
         }
 
-        // OpenGL rendering settings
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-
-        // render
-        _grid->geometry().drawUsingActiveProgram();
+        if (renderGlobally) {
+            // Calculations are done in the reference frame of the globe. Hence, the
+            // camera position needs to be transformed with the inverse model matrix
+            if (performAnyBlending) {
+                glm::dmat4 inverseModelTransform = owner.inverseModelTransform();
+                glm::dvec3 cameraPosition = glm::dvec3(
+                    inverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1));
+                programObject->setUniform("cameraPosition", vec3(cameraPosition));
+            }
 
-        // disable shader
-        programObject->deactivate();
-    }
+            mat4 modelViewProjectionTransform =
+                data.camera.projectionMatrix() * mat4(modelViewTransform);
+            programObject->setUniform(
+                "modelViewProjectionTransform", modelViewProjectionTransform);
+            programObject->setUniform("radiiSquared", vec3(ellipsoid.radiiSquared()));
+        }
+        else {
+            programObject->setUniform(
+                "projectionTransform", data.camera.projectionMatrix());
+        }
 
+        if (!supportsMultiDraw()) {
+            renderChunks(batch, data, *programObject, programUniformHandler, texUnits,
+                performAnyBlending);
+            programObject->deactivate();
+            return;
+        }
 
+        uploadDrawData(batch, data, *programObject);
+
+        for (const ChunkDrawCommandList::MultiDraw& multiDraw : batch.multiDraws) {
+            // All chunks of a multi-draw sample the same array textures. Consecutive
+            // multi-draws often share some of them, so only bind textures that changed
+            const ChunkDrawCommandList::Command& command = commands[multiDraw.begin];
+            const ChunkDrawCommandList::Command* previous =
+                multiDraw.begin > batch.begin ? &commands[multiDraw.begin - 1] : nullptr;
+            for (size_t slot = 0; slot < _tileSlots.size(); slot++) {
+                const TileTextureSlot& textureSlot = *command.tiles[slot].tile.textureSlot;
+                if (!previous || previous->tiles[slot].tile.textureSlot->arrayTexture() !=
+                    textureSlot.arrayTexture())
+                {
+                    texUnits[slot].activate();
+                    textureSlot.bind();
+                }
+            }
 
-    void ChunkRenderer::renderChunkLocally(const Chunk& chunk, const RenderData& data) {
-        
-        ProgramObject* programObject = getActivatedProgramWithTileData(
-            _localRenderingShaderProvider.get(),
-            _localProgramUniformHandler,
-            chunk);
-        if (programObject == nullptr) {
-            return;
+            _grid->geometry().drawIndirectUsingActiveProgram(
+                (multiDraw.begin - batch.begin) * sizeof(DrawElementsIndirectCommand),
+                static_cast<GLsizei>(multiDraw.end - multiDraw.begin));
         }
 
-        using namespace glm;
+        // disable shader
+        programObject->deactivate();
+    }
 
+    ChunkRenderer::ChunkDrawData ChunkRenderer::computeChunkDrawData(
+        const Chunk& chunk, bool renderGlobally,
+        const glm::dmat4& modelViewTransform) const
+    {
+        using namespace glm;
         const Ellipsoid& ellipsoid = chunk.owner()->ellipsoid();
 
+        ChunkDrawData chunkDrawData = {};
 
-        bool performAnyBlending = false;
-        for (int i = 0; i < LayeredTextures::NUM_TEXTURE_CATEGORIES; ++i) {
-            LayeredTextures::TextureCategory category = (LayeredTextures::TextureCategory)i;
-            if (_tileProviderManager->getTileProviderGroup(i).levelBlendingEnabled && _tileProviderManager->getTileProviderGroup(category).getActiveTileProviders().size() > 0) {
-                performAnyBlending = true;
-                break;
-            }
+        if (renderGlobally) {
+            Geodetic2 swCorner = chunk.surfacePatch().getCorner(Quad::SOUTH_WEST);
+            auto patchSize = chunk.surfacePatch().size();
+            chunkDrawData.corners[0] = vec4(
+                vec2(swCorner.toLonLatVec2()), vec2(patchSize.toLonLatVec2()));
+            chunkDrawData.patchNormalCameraSpace = vec3(0);
         }
-        if (performAnyBlending) {
-            float distanceScaleFactor = chunk.owner()->lodScaleFactor * chunk.owner()->ellipsoid().minimumRadius();
-            programObject->setUniform("distanceScaleFactor", distanceScaleFactor);
-            programObject->setUniform("chunkLevel", chunk.index().level);
+        else {
+            std::vector<Vec3> cornersCameraSpace(4);
+            for (int c = 0; c < 4; ++c) {
+                Quad q = (Quad)c;
+                Geodetic2 corner = chunk.surfacePatch().getCorner(q);
+                Vec3 cornerModelSpace = ellipsoid.cartesianSurfacePosition(corner);
+                cornersCameraSpace[c] =
+                    Vec3(modelViewTransform * glm::dvec4(cornerModelSpace, 1));
+            }
+            // The shaders expect the corners in the order p00, p10, p01, p11
+            chunkDrawData.corners[0] =
+                vec4(vec3(cornersCameraSpace[Quad::SOUTH_WEST]), 1);
+            chunkDrawData.corners[1] =
+                vec4(vec3(cornersCameraSpace[Quad::SOUTH_EAST]), 1);
+            chunkDrawData.corners[2] =
+                vec4(vec3(cornersCameraSpace[Quad::NORTH_WEST]), 1);
+            chunkDrawData.corners[3] =
+                vec4(vec3(cornersCameraSpace[Quad::NORTH_EAST]), 1);
+            chunkDrawData.patchNormalCameraSpace = normalize(cross(
+                cornersCameraSpace[Quad::SOUTH_EAST] -
+                    cornersCameraSpace[Quad::SOUTH_WEST],
+                cornersCameraSpace[Quad::NORTH_EAST] -
+                    cornersCameraSpace[Quad::SOUTH_WEST]));
         }
 
-        // Calculate other uniform variables needed for rendering
-        dmat4 modelTransform = chunk.owner()->modelTransform();
-        dmat4 viewTransform = data.camera.combinedViewMatrix();
-        dmat4 modelViewTransform = viewTransform * modelTransform;
-
-        std::vector<std::string> cornerNames = { "p01", "p11", "p00", "p10" };
-        std::vector<Vec3> cornersCameraSpace(4);
-        for (int i = 0; i < 4; ++i) {
-            Quad q = (Quad)i;
-            Geodetic2 corner = chunk.surfacePatch().getCorner(q);
-            Vec3 cornerModelSpace = ellipsoid.cartesianSurfacePosition(corner);
-            Vec3 cornerCameraSpace = Vec3(dmat4(modelViewTransform) * glm::dvec4(cornerModelSpace, 1));
-            cornersCameraSpace[i] = cornerCameraSpace;
-            programObject->setUniform(cornerNames[i], vec3(cornerCameraSpace));
-        }
+        // The length of the skirts is proportional to its size
+        chunkDrawData.skirtLength = min(static_cast<float>(
+            chunk.surfacePatch().halfSize().lat * 1000000), 8700.0f);
+        chunkDrawData.chunkLevel = chunk.index().level;
+        return chunkDrawData;
+    }
 
-        vec3 patchNormalCameraSpace = normalize(
-            cross(cornersCameraSpace[Quad::SOUTH_EAST] - cornersCameraSpace[Quad::SOUTH_WEST],
-                cornersCameraSpace[Quad::NORTH_EAST] - cornersCameraSpace[Quad::SOUTH_WEST]));
+    void ChunkRenderer::renderChunks(const ChunkDrawCommandList::Batch& batch,
+        const RenderData& data, ProgramObject& programObject,
+        std::shared_ptr<LayeredTextureShaderUniformIdHandler> programUniformHandler,
+        std::vector<ghoul::opengl::TextureUnit>& texUnits, bool setChunkLevel)
+    {
+        using Id = LayeredTextureShaderUniformIdHandler::GlslTileDataId;
+
+        const std::vector<ChunkDrawCommandList::Command>& commands =
+            _commandList.commands();
+        ChunkedLodGlobe& owner = *commands[batch.begin].chunk->owner();
+        glm::dmat4 modelViewTransform =
+            data.camera.combinedViewMatrix() * owner.modelTransform();
+        bool renderGlobally = batch.permutation == GlobalRendering;
+
+        const std::vector<std::string> cornerNames = {
+            "chunkDrawData.corners[0]",
+            "chunkDrawData.corners[1]",
+            "chunkDrawData.corners[2]",
+            "chunkDrawData.corners[3]"
+        };
+        for (size_t c = batch.begin; c < batch.end; c++) {
+            const ChunkDrawCommandList::Command& command = commands[c];
+            const ChunkDrawCommandList::Command* previous =
+                c > batch.begin ? &commands[c - 1] : nullptr;
+
+            for (size_t slot = 0; slot < _tileSlots.size(); slot++) {
+                const TileAndTransform& tile = command.tiles[slot];
+                const TileTextureSlot& textureSlot = *tile.tile.textureSlot;
+                // Consecutive chunks often sample the same textures, so only bind
+                // textures that changed since the previous chunk
+                if (!previous || previous->tiles[slot].tile.textureSlot->arrayTexture() !=
+                    textureSlot.arrayTexture())
+                {
+                    texUnits[slot].activate();
+                    textureSlot.bind();
+                }
+                setTileUniform(programUniformHandler, _tileSlots[slot],
+                    Id::drawData_uvOffset, tile.uvTransform.uvOffset);
+                setTileUniform(programUniformHandler, _tileSlots[slot],
+                    Id::drawData_uvScale, tile.uvTransform.uvScale);
+                setTileUniform(programUniformHandler, _tileSlots[slot],
+                    Id::drawData_textureLayer,
+                    static_cast<float>(textureSlot.layer()));
+            }
 
-        programObject->setUniform("patchNormalCameraSpace", patchNormalCameraSpace);
-        programObject->setUniform("projectionTransform", data.camera.projectionMatrix());
+            ChunkDrawData chunkDrawData = computeChunkDrawData(
+                *command.chunk, renderGlobally, modelViewTransform);
+            if (renderGlobally) {
+                programObject.setUniform(cornerNames[0], chunkDrawData.corners[0]);
+            }
+            else {
+                for (size_t i = 0; i < cornerNames.size(); ++i) {
+                    programObject.setUniform(cornerNames[i], chunkDrawData.corners[i]);
+                }
+                programObject.setUniform(
+                    "chunkDrawData.patchNormalCameraSpace",
+                    chunkDrawData.patchNormalCameraSpace);
+            }
+            programObject.setUniform(
+                "chunkDrawData.skirtLength", chunkDrawData.skirtLength);
+            // The level is only read when blending between levels
+            if (setChunkLevel) {
+                programObject.setUniform(
+                    "chunkDrawData.chunkLevel", chunkDrawData.chunkLevel);
+            }
 
-        if (_tileProviderManager->getTileProviderGroup(
-                LayeredTextures::NightTextures).getActiveTileProviders().size() > 0 ||
-            _tileProviderManager->getTileProviderGroup(
-                LayeredTextures::WaterMasks).getActiveTileProviders().size() > 0) {
-            glm::vec3 directionToSunWorldSpace =
-                glm::normalize(-data.modelTransform.translation);
-            glm::vec3 directionToSunCameraSpace =
-                (viewTransform * glm::dvec4(directionToSunWorldSpace, 0));
-            data.modelTransform.translation;
-            programObject->setUniform("lightDirectionCameraSpace", -directionToSunCameraSpace);
+            _grid->geometry().drawUsingActiveProgram();
         }
+    }
 
+    void ChunkRenderer::uploadDrawData(const ChunkDrawCommandList::Batch& batch,
+        const RenderData& data, ProgramObject& programObject)
+    {
+        using namespace glm;
+        static_assert(sizeof(ChunkDrawData) == 96,
+            "ChunkDrawData must match the std430 layout in chunkdrawdata.hglsl");
+        static_assert(sizeof(TileDrawData) == 24,
+            "TileDrawData must match the std430 layout in chunkdrawdata.hglsl");
+
+        const std::vector<ChunkDrawCommandList::Command>& commands =
+            _commandList.commands();
+        ChunkedLodGlobe& owner = *commands[batch.begin].chunk->owner();
+        dmat4 modelViewTransform =
+            data.camera.combinedViewMatrix() * owner.modelTransform();
+        bool renderGlobally = batch.permutation == GlobalRendering;
+
+        size_t nCommands = batch.end - batch.begin;
+        size_t nSlots = _tileSlots.size();
+        _chunkDrawData.resize(nCommands);
+        _tileDrawData.resize(nCommands * nSlots);
+        _drawCommands.resize(nCommands);
+
+        for (size_t i = 0; i < nCommands; i++) {
+            const ChunkDrawCommandList::Command& command = commands[batch.begin + i];
+            _chunkDrawData[i] = computeChunkDrawData(
+                *command.chunk, renderGlobally, modelViewTransform);
+
+            for (size_t slot = 0; slot < nSlots; slot++) {
+                const TileAndTransform& tile = command.tiles[slot];
+                _tileDrawData[i * nSlots + slot] = {
+                    tile.uvTransform.uvOffset,
+                    tile.uvTransform.uvScale,
+                    static_cast<GLfloat>(tile.tile.textureSlot->layer()),
+                    0.f
+                };
+            }
 
-        // OpenGL rendering settings
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
+            // The base instance is the index of the chunk's draw data, see
+            // initializeDrawBuffers
+            _drawCommands[i] = {
+                static_cast<GLuint>(_grid->geometry().numElements()),
+                1,
+                0,
+                0,
+                static_cast<GLuint>(i)
+            };
+        }
 
-        // render
-        _grid->geometry().drawUsingActiveProgram();
+        if (nCommands > _numDrawIndices) {
+            _numDrawIndices = std::max(nCommands, 2 * _numDrawIndices);
+            std::vector<GLint> drawIndices(_numDrawIndices);
+            std::iota(drawIndices.begin(), drawIndices.end(), 0);
+            glBindBuffer(GL_ARRAY_BUFFER, _drawIndexBuffer);
+            glBufferData(
+                GL_ARRAY_BUFFER,
+                drawIndices.size() * sizeof(GLint),
+                drawIndices.data(),
+                GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
 
-        // disable shader
-        programObject->deactivate();
+        // Respecifying the whole buffers lets the driver hand out new storage instead
+        // of waiting for the draws of the previous batch
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _chunkDrawDataBuffer);
+        glBufferData(
+            GL_SHADER_STORAGE_BUFFER,
+            _chunkDrawData.size() * sizeof(ChunkDrawData),
+            _chunkDrawData.data(),
+            GL_STREAM_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glBindBufferBase(
+            GL_SHADER_STORAGE_BUFFER,
+            _chunkDrawDataBinding->bindingNumber(),
+            _chunkDrawDataBuffer);
+        programObject.setSsboBinding(
+            "ChunkDrawDataBlock", _chunkDrawDataBinding->bindingNumber());
+
+        // Without any tiles the shaders do not read the tile draw data block
+        if (nSlots > 0) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, _tileDrawDataBuffer);
+            glBufferData(
+                GL_SHADER_STORAGE_BUFFER,
+                _tileDrawData.size() * sizeof(TileDrawData),
+                _tileDrawData.data(),
+                GL_STREAM_DRAW);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            glBindBufferBase(
+                GL_SHADER_STORAGE_BUFFER,
+                _tileDrawDataBinding->bindingNumber(),
+                _tileDrawDataBuffer);
+            programObject.setSsboBinding(
+                "TileDrawDataBlock", _tileDrawDataBinding->bindingNumber());
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _drawIndirectBuffer);
+        glBufferData(
+            GL_DRAW_INDIRECT_BUFFER,
+            _drawCommands.size() * sizeof(DrawElementsIndirectCommand),
+            _drawCommands.data(),
+            GL_STREAM_DRAW);
     }
+
 }  // namespace openspace
@@ -40,7 +40,9 @@
 #include <modules/globebrowsing/tile/tileselector.h>
 
 #include <modules/globebrowsing/chunk/chunknode.h>
+#include <modules/globebrowsing/chunk/chunkdrawcommandlist.h>
 
+#include <ghoul/opengl/bufferbinding.h>
 #include <ghoul/opengl/textureunit.h>
 
 
@@ -51,19 +53,140 @@ namespace opengl {
 }
 
 namespace openspace {
+
+    class ChunkedLodGlobe;
     
     class ChunkRenderer {
     public:
         ChunkRenderer(std::shared_ptr<Grid> grid,
             std::shared_ptr<TileProviderManager> tileProviderManager);
-
-        void renderChunk(const Chunk& chunk, const RenderData& data);
+        ~ChunkRenderer();
+
+        /**
+        * Selects the tiles the chunk should be rendered with and queues it for drawing.
+        * Nothing is drawn until <code>renderQueuedChunks</code> is called.
+        */
+        void queueChunk(const Chunk& chunk);
+
+        /**
+        * Draws all queued chunks and empties the queue. Chunks that are rendered with
+        * the same shader program are drawn together so that the program is activated,
+        * and the uniforms that are constant for the frame are set, once per program
+        * rather than once per chunk. With OpenGL 4.3, the parameters that differ
+        * between chunks are uploaded to shader storage buffers, and all chunks that
+        * sample the same textures are drawn with one
+        * <code>glMultiDrawElementsIndirect</code> call. Below OpenGL 4.3, the
+        * parameters are set as uniforms and every chunk is drawn on its own.
+        */
+        void renderQueuedChunks(const RenderData& data);
+
+        /**
+        * Continues compiling the shader permutations that are likely to be needed soon.
+        */
         void update();
 
     private:
+        enum Permutation {
+            GlobalRendering,
+            LocalRendering,
+        };
+
+        /**
+        * A texture slot of the shader program. The tiles of a
+        * <code>ChunkDrawCommandList::Command</code> are stored in the order of the slots.
+        */
+        struct TileSlot {
+            LayeredTextures::TextureCategory category;
+            LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes blendLayer;
+            size_t layerIndex;
+        };
+
+        /**
+        * The parameters of one chunk that are read by the shaders through the
+        * <code>ChunkDrawDataBlock</code> shader storage buffer, or through the
+        * <code>chunkDrawData</code> uniform without multi-draw calls. The layout
+        * matches the <code>std430</code> layout of <code>ChunkDrawData</code> in
+        * chunkdrawdata.hglsl.
+        */
+        struct ChunkDrawData {
+            /// Global rendering: minimum lon/lat and lon/lat size of the patch in
+            /// <code>corners[0]</code>. Local rendering: the corners p00, p10, p01 and
+            /// p11 in camera space
+            glm::vec4 corners[4];
+            glm::vec3 patchNormalCameraSpace;
+            GLfloat skirtLength;
+            GLint chunkLevel;
+            GLint padding[3];
+        };
+
+        /**
+        * The parameters of one tile of a chunk that are read by the shaders through the
+        * <code>TileDrawDataBlock</code> shader storage buffer. The layout matches the
+        * <code>std430</code> layout of <code>TileDrawData</code> in chunkdrawdata.hglsl.
+        */
+        struct TileDrawData {
+            glm::vec2 uvOffset;
+            glm::vec2 uvScale;
+            /// The layer of the tile's texture slot in the bound array texture
+            GLfloat textureLayer;
+            GLfloat padding;
+        };
+
+        /// The command layout read by <code>glMultiDrawElementsIndirect</code>
+        struct DrawElementsIndirectCommand {
+            GLuint count;
+            GLuint instanceCount;
+            GLuint firstIndex;
+            GLint baseVertex;
+            GLuint baseInstance;
+        };
+
+        using ShaderStorageBinding = ghoul::opengl::BufferBinding<
+            ghoul::opengl::bufferbinding::Buffer::ShaderStorage>;
+
+        void updateTileSlots();
+
+        /**
+        * Creates the buffers used for multi-draw calls the first time it is called, if
+        * multi-draw calls are supported.
+        */
+        void initializeDrawBuffers();
+
+        ChunkDrawData computeChunkDrawData(const Chunk& chunk, bool renderGlobally,
+            const glm::dmat4& modelViewTransform) const;
+
+        /**
+        * Fills the draw buffers with the parameters of the commands in
+        * <code>batch</code> and binds them to <code>programObject</code>.
+        */
+        void uploadDrawData(const ChunkDrawCommandList::Batch& batch,
+            const RenderData& data, ProgramObject& programObject);
+
+        /**
+        * Queues the shader permutations that differ from
+        * <code>preprocessingData</code> by one layer in a single category, which is
+        * what toggling a layer leads to, for precompilation. Permutations queued by an
+        * earlier call and not yet started are dropped.
+        */
+        void queueLikelyPermutations(
+            const LayeredTexturePreprocessingData& preprocessingData);
+
+        ProgramObject* getActivatedProgram(
+            LayeredTextureShaderProvider* layeredTextureShaderProvider,
+            std::shared_ptr<LayeredTextureShaderUniformIdHandler> programUniformHandler,
+            const ChunkedLodGlobe& owner);
 
-        void renderChunkGlobally(const Chunk& chunk, const RenderData& data);
-        void renderChunkLocally(const Chunk& chunk, const RenderData& data);
+        void renderBatch(const ChunkDrawCommandList::Batch& batch,
+            const RenderData& data);
+
+        /**
+        * Draws the chunks of <code>batch</code> one at a time, setting the parameters
+        * of each chunk as uniforms. Used when multi-draw calls are not supported.
+        */
+        void renderChunks(const ChunkDrawCommandList::Batch& batch,
+            const RenderData& data, ProgramObject& programObject,
+            std::shared_ptr<LayeredTextureShaderUniformIdHandler> programUniformHandler,
+            std::vector<ghoul::opengl::TextureUnit>& texUnits, bool setChunkLevel);
 
         void setDepthTransformUniforms(
             std::shared_ptr<LayeredTextureShaderUniformIdHandler> uniformIdHandler,
@@ -72,18 +195,12 @@ namespace openspace {
             size_t layerIndex,
             const TileDepthTransform& tileDepthTransform);
 
-        void activateTileAndSetTileUniforms(
+        template <typename T>
+        void setTileUniform(
             std::shared_ptr<LayeredTextureShaderUniformIdHandler> uniformIdHandler,
-            LayeredTextures::TextureCategory textureCategory,
-            LayeredTextureShaderUniformIdHandler::BlendLayerSuffixes blendLayerSuffix,
-            size_t layerIndex,
-            ghoul::opengl::TextureUnit& texUnit,
-            const TileAndTransform& tileAndTransform);
-
-        ProgramObject* getActivatedProgramWithTileData(
-            LayeredTextureShaderProvider* layeredTextureShaderProvider,
-            std::shared_ptr<LayeredTextureShaderUniformIdHandler> programUniformHandler,
-            const Chunk& chunk);
+            const TileSlot& slot,
+            LayeredTextureShaderUniformIdHandler::GlslTileDataId tileDataId,
+            const T& value);
 
         //////////////////////////////////////////////////////////////////////////////////
         //                              Member variables                                //
@@ -98,6 +215,29 @@ namespace openspace {
         std::shared_ptr<LayeredTextureShaderUniformIdHandler> _globalProgramUniformHandler;
         std::shared_ptr<LayeredTextureShaderUniformIdHandler> _localProgramUniformHandler;
 
+        std::array<std::vector<std::shared_ptr<TileProvider>>,
+            LayeredTextures::NUM_TEXTURE_CATEGORIES> _activeTileProviders;
+        std::vector<TileSlot> _tileSlots;
+        ChunkDrawCommandList _commandList;
+
+        bool _queuedLikelyPermutations;
+        /// The preprocessing data that the queued likely permutations differ from
+        LayeredTexturePreprocessingData _likelyPermutationsOrigin;
+
+        // Buffers for the multi-draw calls, refilled for every batch. They stay 0 when
+        // multi-draw calls are not supported
+        GLuint _chunkDrawDataBuffer;
+        GLuint _tileDrawDataBuffer;
+        GLuint _drawIndirectBuffer;
+        GLuint _drawIndexBuffer;
+        size_t _numDrawIndices;
+        std::unique_ptr<ShaderStorageBinding> _chunkDrawDataBinding;
+        std::unique_ptr<ShaderStorageBinding> _tileDrawDataBinding;
+
+        std::vector<ChunkDrawData> _chunkDrawData;
+        std::vector<TileDrawData> _tileDrawData;
+        std::vector<DrawElementsIndirectCommand> _drawCommands;
+
     };
 
 }  // namespace openspace
@@ -28,6 +28,11 @@
 #include <math.h>
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENSPACE_ELLIPSOID_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace {
     const std::string _loggerCat = "Ellipsoid";
 }
@@ -188,4 +193,129 @@ namespace openspace {
         return rSurface + geodetic3.height * normal;
     }
 
+    void Ellipsoid::geodeticSurfaceProjection(const Scalar* x, const Scalar* y,
+        const Scalar* z, size_t n, Scalar* projectedX, Scalar* projectedY,
+        Scalar* projectedZ) const
+    {
+        size_t i = 0;
+#ifdef OPENSPACE_ELLIPSOID_SSE2
+        // Same iteration as the single point version, two points at a time. Points
+        // that have converged keep their alpha while the other point iterates
+        const __m128d zero = _mm_setzero_pd();
+        const __m128d one = _mm_set1_pd(1.0);
+        const __m128d minusTwo = _mm_set1_pd(-2.0);
+        const __m128d epsilon = _mm_set1_pd(1e-10);
+        const __m128d signMask = _mm_set1_pd(-0.0);
+        const __m128d oneOverRadiiSquaredX = _mm_set1_pd(_cached._oneOverRadiiSquared.x);
+        const __m128d oneOverRadiiSquaredY = _mm_set1_pd(_cached._oneOverRadiiSquared.y);
+        const __m128d oneOverRadiiSquaredZ = _mm_set1_pd(_cached._oneOverRadiiSquared.z);
+        const __m128d radiiSquaredX = _mm_set1_pd(_cached._radiiSquared.x);
+        const __m128d radiiSquaredY = _mm_set1_pd(_cached._radiiSquared.y);
+        const __m128d radiiSquaredZ = _mm_set1_pd(_cached._radiiSquared.z);
+        const __m128d radiiToTheFourthX = _mm_set1_pd(_cached._radiiToTheFourth.x);
+        const __m128d radiiToTheFourthY = _mm_set1_pd(_cached._radiiToTheFourth.y);
+        const __m128d radiiToTheFourthZ = _mm_set1_pd(_cached._radiiToTheFourth.z);
+
+        for (; i + 2 <= n; i += 2) {
+            const __m128d px = _mm_loadu_pd(x + i);
+            const __m128d py = _mm_loadu_pd(y + i);
+            const __m128d pz = _mm_loadu_pd(z + i);
+            const __m128d p2x = _mm_mul_pd(px, px);
+            const __m128d p2y = _mm_mul_pd(py, py);
+            const __m128d p2z = _mm_mul_pd(pz, pz);
+
+            __m128d beta = _mm_div_pd(one, _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(
+                _mm_mul_pd(p2x, oneOverRadiiSquaredX),
+                _mm_mul_pd(p2y, oneOverRadiiSquaredY)),
+                _mm_mul_pd(p2z, oneOverRadiiSquaredZ))));
+            __m128d nx = _mm_mul_pd(_mm_mul_pd(beta, px), oneOverRadiiSquaredX);
+            __m128d ny = _mm_mul_pd(_mm_mul_pd(beta, py), oneOverRadiiSquaredY);
+            __m128d nz = _mm_mul_pd(_mm_mul_pd(beta, pz), oneOverRadiiSquaredZ);
+            __m128d nLength = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(
+                _mm_mul_pd(nx, nx), _mm_mul_pd(ny, ny)), _mm_mul_pd(nz, nz)));
+            __m128d pLength = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(p2x, p2y), p2z));
+            __m128d alpha = _mm_mul_pd(_mm_sub_pd(one, beta),
+                _mm_div_pd(pLength, nLength));
+
+            __m128d s = zero;
+            __m128d dSdA = one;
+            __m128d active = _mm_cmpeq_pd(one, one);
+            __m128d dx, dy, dz;
+            do {
+                alpha = _mm_sub_pd(alpha, _mm_and_pd(active, _mm_div_pd(s, dSdA)));
+
+                dx = _mm_add_pd(one, _mm_mul_pd(alpha, oneOverRadiiSquaredX));
+                dy = _mm_add_pd(one, _mm_mul_pd(alpha, oneOverRadiiSquaredY));
+                dz = _mm_add_pd(one, _mm_mul_pd(alpha, oneOverRadiiSquaredZ));
+                __m128d d2x = _mm_mul_pd(dx, dx);
+                __m128d d2y = _mm_mul_pd(dy, dy);
+                __m128d d2z = _mm_mul_pd(dz, dz);
+                __m128d d3x = _mm_mul_pd(dx, d2x);
+                __m128d d3y = _mm_mul_pd(dy, d2y);
+                __m128d d3z = _mm_mul_pd(dz, d2z);
+
+                s = _mm_sub_pd(_mm_add_pd(_mm_add_pd(
+                    _mm_div_pd(p2x, _mm_mul_pd(radiiSquaredX, d2x)),
+                    _mm_div_pd(p2y, _mm_mul_pd(radiiSquaredY, d2y))),
+                    _mm_div_pd(p2z, _mm_mul_pd(radiiSquaredZ, d2z))), one);
+                dSdA = _mm_mul_pd(minusTwo, _mm_add_pd(_mm_add_pd(
+                    _mm_div_pd(p2x, _mm_mul_pd(radiiToTheFourthX, d3x)),
+                    _mm_div_pd(p2y, _mm_mul_pd(radiiToTheFourthY, d3y))),
+                    _mm_div_pd(p2z, _mm_mul_pd(radiiToTheFourthZ, d3z))));
+
+                active = _mm_cmpgt_pd(_mm_andnot_pd(signMask, s), epsilon);
+            } while (_mm_movemask_pd(active) != 0);
+
+            _mm_storeu_pd(projectedX + i, _mm_div_pd(px, dx));
+            _mm_storeu_pd(projectedY + i, _mm_div_pd(py, dy));
+            _mm_storeu_pd(projectedZ + i, _mm_div_pd(pz, dz));
+        }
+#endif
+        for (; i < n; ++i) {
+            Vec3 projected = geodeticSurfaceProjection(Vec3(x[i], y[i], z[i]));
+            projectedX[i] = projected.x;
+            projectedY[i] = projected.y;
+            projectedZ[i] = projected.z;
+        }
+    }
+
+    void Ellipsoid::cartesianToGeodetic2(const Scalar* x, const Scalar* y,
+        const Scalar* z, size_t n, Scalar* lat, Scalar* lon) const
+    {
+        const Vec3& oneOverRadiiSquared = _cached._oneOverRadiiSquared;
+        for (size_t i = 0; i < n; ++i) {
+            // The normal does not have to be normalized, atan2 is independent of its
+            // length and the latitude divides by it
+            Scalar normalX = x[i] * oneOverRadiiSquared.x;
+            Scalar normalY = y[i] * oneOverRadiiSquared.y;
+            Scalar normalZ = z[i] * oneOverRadiiSquared.z;
+            Scalar normalLength = sqrt(
+                normalX * normalX + normalY * normalY + normalZ * normalZ);
+            Scalar latitude = asin(normalZ / normalLength);
+            Scalar longitude = atan2(normalY, normalX);
+            lat[i] = latitude;
+            lon[i] = longitude;
+        }
+    }
+
+    void Ellipsoid::cartesianSurfacePosition(const Scalar* lat, const Scalar* lon,
+        size_t n, Scalar* x, Scalar* y, Scalar* z) const
+    {
+        const Vec3& radiiSquared = _cached._radiiSquared;
+        for (size_t i = 0; i < n; ++i) {
+            Scalar cosLat = cos(lat[i]);
+            Scalar normalX = cosLat * cos(lon[i]);
+            Scalar normalY = cosLat * sin(lon[i]);
+            Scalar normalZ = sin(lat[i]);
+
+            Scalar kX = radiiSquared.x * normalX;
+            Scalar kY = radiiSquared.y * normalY;
+            Scalar kZ = radiiSquared.z * normalZ;
+            Scalar gamma = sqrt(kX * normalX + kY * normalY + kZ * normalZ);
+            x[i] = kX / gamma;
+            y[i] = kY / gamma;
+            z[i] = kZ / gamma;
+        }
+    }
+
 } // namespace openspace
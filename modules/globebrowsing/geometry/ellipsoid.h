@@ -93,6 +93,20 @@ public:
     Vec3 cartesianSurfacePosition(const Geodetic2& geodetic2) const;
     Vec3 cartesianPosition(const Geodetic3& geodetic3) const;
 
+    /**
+    Batched versions of the functions above for <code>n</code> points stored as separate
+    coordinate arrays. The results are the same as calling the single point versions
+    for each point, but the loops are cheaper when many points are processed together.
+    The output arrays may be the same as the input arrays. The geodetic surface
+    projection iterates two points at a time when SSE2 is available.
+    */
+    void geodeticSurfaceProjection(const Scalar* x, const Scalar* y, const Scalar* z,
+        size_t n, Scalar* projectedX, Scalar* projectedY, Scalar* projectedZ) const;
+    void cartesianToGeodetic2(const Scalar* x, const Scalar* y, const Scalar* z,
+        size_t n, Scalar* lat, Scalar* lon) const;
+    void cartesianSurfacePosition(const Scalar* lat, const Scalar* lon, size_t n,
+        Scalar* x, Scalar* y, Scalar* z) const;
+
 private:
     struct EllipsoidCache {
         Vec3 _radiiSquared;
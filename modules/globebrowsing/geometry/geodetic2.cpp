@@ -32,6 +32,17 @@
 
 namespace {
     const std::string _loggerCat = "Geodetic2";
+
+    // Same as Angle::normalizeAround, without constructing Angle objects
+    inline Scalar normalizedAround(Scalar radians, Scalar center) {
+        using Ang = openspace::Angle<Scalar>;
+        radians -= center + Ang::PI;
+        radians = fmod(radians, 2 * Ang::PI);
+        if (radians < 0.0) {
+            radians += 2 * Ang::PI;
+        }
+        return radians + (center - Ang::PI);
+    }
 }
 
 namespace openspace {
@@ -311,4 +322,41 @@ namespace openspace {
         return Geodetic2(clampedLat, clampedLon);
     }
 
+    void GeodeticPatch::closestCorner(const Scalar* lat, const Scalar* lon, size_t n,
+        Scalar* cornerLat, Scalar* cornerLon) const
+    {
+        for (size_t i = 0; i < n; ++i) {
+            Scalar latDiff = normalizedAround(lat[i] - _center.lat, 0.0);
+            Scalar lonDiff = normalizedAround(lon[i] - _center.lon, 0.0);
+            cornerLat[i] = _center.lat + _halfSize.lat * (latDiff > 0.0 ? 1 : -1);
+            cornerLon[i] = _center.lon + _halfSize.lon * (lonDiff > 0.0 ? 1 : -1);
+        }
+    }
+
+    void GeodeticPatch::closestPoint(const Scalar* lat, const Scalar* lon, size_t n,
+        Scalar* closestLat, Scalar* closestLon) const
+    {
+        // See the single point version for an explanation of the clamping
+        using Ang = Angle<Scalar>;
+        const Scalar minimumLat = minLat();
+        const Scalar maximumLat = maxLat();
+        const Scalar minimumLon = minLon();
+        const Scalar maximumLon = maxLon();
+
+        for (size_t i = 0; i < n; ++i) {
+            Scalar pointLat = normalizedAround(lat[i], _center.lat);
+            Scalar pointLon = normalizedAround(lon[i], _center.lon);
+
+            Scalar centerToPointLon = normalizedAround(_center.lon - pointLon, 0.0);
+            Scalar longitudeDistanceToClosestPatchEdge =
+                std::abs(centerToPointLon) - _halfSize.lon;
+
+            if (longitudeDistanceToClosestPatchEdge > Ang::PI / 2) {
+                pointLat = normalizedAround(Ang::PI - pointLat, _center.lat);
+            }
+            closestLat[i] = glm::clamp(pointLat, minimumLat, maximumLat);
+            closestLon[i] = glm::clamp(pointLon, minimumLon, maximumLon);
+        }
+    }
+
 } // namespace openspace
@@ -149,6 +149,16 @@ public:
      */
     Geodetic2 closestPoint(const Geodetic2& p) const;
 
+    /**
+     * Batched versions of <code>closestCorner</code> and <code>closestPoint</code> for
+     * <code>n</code> points stored as separate latitude and longitude arrays. The
+     * output arrays may be the same as the input arrays.
+     */
+    void closestCorner(const Scalar* lat, const Scalar* lon, size_t n,
+        Scalar* cornerLat, Scalar* cornerLon) const;
+    void closestPoint(const Scalar* lat, const Scalar* lon, size_t n,
+        Scalar* closestLat, Scalar* closestLon) const;
+
     /**
      * Returns the minimum tile level of the patch (based on largest side)
      */
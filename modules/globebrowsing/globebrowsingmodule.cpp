@@ -38,6 +38,8 @@
 #include <modules/globebrowsing/tile/tileprovider/singleimageprovider.h>
 #include <modules/globebrowsing/tile/tileprovider/temporaltileprovider.h>
 #include <modules/globebrowsing/tile/tileprovider/texttileprovider.h>
+#include <modules/globebrowsing/tile/tiletexturepool.h>
+#include <modules/globebrowsing/tile/tiletextureresidency.h>
 
 
 namespace openspace {
@@ -64,7 +66,17 @@ void GlobeBrowsingModule::internalInitialize() {
     fTileProvider->registerClass<TemporalTileProvider>("Temporal");
     fTileProvider->registerClass<ChunkIndexTileProvider>("ChunkIndex");
     fTileProvider->registerClass<SizeReferenceTileProvider>("SizeReference");
-    
+
+    TileTextureResidency::initialize();
+    TileTexturePool::initialize();
+}
+
+void GlobeBrowsingModule::internalDeinitialize() {
+    // Modules are deinitialized before the scene is destroyed, but while the OpenGL
+    // context is still current. Tiles that are destroyed later only release their
+    // pixel data
+    TileTexturePool::deinitialize();
+    TileTextureResidency::deinitialize();
 }
 
 } // namespace openspace
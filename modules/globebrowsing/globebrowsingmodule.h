@@ -35,6 +35,7 @@ public:
     
 protected:
     void internalInitialize() override;
+    void internalDeinitialize() override;
 };
 
 } // namespace openspace
@@ -28,6 +28,7 @@
 #include <modules/globebrowsing/tile/tileselector.h>
 
 #include <modules/globebrowsing/chunk/chunkedlodglobe.h>
+#include <modules/globebrowsing/tile/heightsampler.h>
 #include <modules/globebrowsing/tile/tileprovidermanager.h>
 
 // open space includes
@@ -98,6 +99,7 @@ namespace openspace {
 
         _tileProviderManager = std::make_shared<TileProviderManager>(
             texturesDictionary, textureInitDataDictionary);
+        _heightSampler = std::make_unique<HeightSampler>(_tileProviderManager);
 
         _chunkedLodGlobe = std::make_shared<ChunkedLodGlobe>(
             _ellipsoid, patchSegments, _tileProviderManager);
@@ -210,59 +212,22 @@ namespace openspace {
     }
 
     float RenderableGlobe::getHeight(glm::dvec3 position) {
-        // Get the tile provider for the height map
-        const auto& heightMapProviders = _tileProviderManager->getTileProviderGroup(LayeredTextures::HeightMaps).getActiveTileProviders();
-        if (heightMapProviders.size() == 0)
-            return 0;
-        const auto& tileProvider = heightMapProviders[0];
-
-        // Get the uv coordinates to sample from
         Geodetic2 geodeticPosition = _ellipsoid.cartesianToGeodetic2(position);
-        int chunkLevel = _chunkedLodGlobe->findChunkNode(geodeticPosition).getChunk().index().level;
-        
-        ChunkIndex chunkIdx = ChunkIndex(geodeticPosition, chunkLevel);
-        GeodeticPatch patch = GeodeticPatch(chunkIdx);
-        Geodetic2 geoDiffPatch = patch.getCorner(Quad::NORTH_EAST) - patch.getCorner(Quad::SOUTH_WEST);
-        Geodetic2 geoDiffPoint = geodeticPosition - patch.getCorner(Quad::SOUTH_WEST);
-        glm::vec2 patchUV = glm::vec2(geoDiffPoint.lon / geoDiffPatch.lon, geoDiffPoint.lat / geoDiffPatch.lat);
-
-        // Transform the uv coordinates to the current tile texture
-        TileAndTransform tileAndTransform = TileSelector::getHighestResolutionTile(tileProvider.get(), chunkIdx);
-        const auto& tile = tileAndTransform.tile;
-        const auto& uvTransform = tileAndTransform.uvTransform;
-        const auto& depthTransform = tileProvider->depthTransform();
-        if (tile.status != Tile::Status::OK) {
-            return 0;
-        }
-        glm::vec2 transformedUv = uvTransform.uvOffset + uvTransform.uvScale * patchUV;
-
-        // Sample and do linear interpolation (could possibly be moved as a function in ghoul texture)
-        glm::uvec3 dimensions = tile.texture->dimensions();
-        
-        glm::vec2 samplePos = transformedUv * glm::vec2(dimensions);
-        glm::uvec2 samplePos00 = samplePos;
-        samplePos00 = glm::clamp(samplePos00, glm::uvec2(0, 0), glm::uvec2(dimensions) - glm::uvec2(1));
-        glm::vec2 samplePosFract = samplePos - glm::vec2(samplePos00);
-
-        glm::uvec2 samplePos10 = glm::min(samplePos00 + glm::uvec2(1, 0), glm::uvec2(dimensions) - glm::uvec2(1));
-        glm::uvec2 samplePos01 = glm::min(samplePos00 + glm::uvec2(0, 1), glm::uvec2(dimensions) - glm::uvec2(1));
-        glm::uvec2 samplePos11 = glm::min(samplePos00 + glm::uvec2(1, 1), glm::uvec2(dimensions) - glm::uvec2(1));
-
-        float sample00 = tile.texture->texelAsFloat(samplePos00).x;
-        float sample10 = tile.texture->texelAsFloat(samplePos10).x;
-        float sample01 = tile.texture->texelAsFloat(samplePos01).x;
-        float sample11 = tile.texture->texelAsFloat(samplePos11).x;
-
-        float sample0 = sample00 * (1.0 - samplePosFract.x) + sample10 * samplePosFract.x;
-        float sample1 = sample01 * (1.0 - samplePosFract.x) + sample11 * samplePosFract.x;
+        return getHeights({ geodeticPosition })[0];
+    }
 
-        float sample = sample0 * (1.0 - samplePosFract.y) + sample1 * samplePosFract.y;
+    std::vector<float> RenderableGlobe::getHeights(
+        const std::vector<Geodetic2>& positions, int minimumLevel)
+    {
+        std::vector<int> levels(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            const Chunk& chunk = _chunkedLodGlobe->findChunkNode(positions[i]).getChunk();
+            levels[i] = std::max(chunk.index().level, minimumLevel);
+        }
 
-        // Perform depth transform to get the value in meters
-        float height = depthTransform.depthOffset + depthTransform.depthScale * sample;
-        
-        // Return the result
-        return height;
+        std::vector<float> heights;
+        _heightSampler->getHeights(positions, levels, heights);
+        return heights;
     }
 
     double RenderableGlobe::interactionDepthBelowEllipsoid() {
@@ -57,6 +57,7 @@ namespace openspace {
 
 class ChunkedLodGlobe;
 class TileProviderManager;
+class HeightSampler;
 
 struct ReferencedBoolSelection : public properties::SelectionProperty {
     ReferencedBoolSelection(const std::string& identifier, const std::string& guiName)
@@ -115,6 +116,15 @@ public:
     glm::dvec3 projectOnEllipsoid(glm::dvec3 position);
     const Ellipsoid& ellipsoid();
     float getHeight(glm::dvec3 position);
+
+    /**
+    * Batched version of <code>getHeight</code> for geodetic positions. Each position
+    * is sampled at the level of the chunk currently covering it, or at
+    * <code>minimumLevel</code> if that is higher. Prefer this over repeated calls to
+    * <code>getHeight</code> when querying many positions.
+    */
+    std::vector<float> getHeights(const std::vector<Geodetic2>& positions,
+        int minimumLevel = 0);
     float cameraMinHeight();
     double interactionDepthBelowEllipsoid();
     std::shared_ptr<ChunkedLodGlobe> chunkedLodGlobe();
@@ -139,6 +149,7 @@ private:
 
     std::shared_ptr<TileProviderManager> _tileProviderManager;
     std::shared_ptr<ChunkedLodGlobe> _chunkedLodGlobe;
+    std::unique_ptr<HeightSampler> _heightSampler;
     
     DistanceSwitch _distanceSwitch;
 
@@ -36,6 +36,8 @@ TriangleSoup::TriangleSoup(std::vector<unsigned int> elements,
     : _vaoID(0)
     ,_vertexBufferID(0)
     ,_elementBufferID(0)
+    ,_instanceIndexBufferID(0)
+    ,_instanceIndexLocation(0)
     ,_useVertexPositions(usePositions)
     ,_useTextureCoordinates(useTextures)
     ,_useVertexNormals(useNormals)
@@ -145,6 +147,14 @@ bool TriangleSoup::updateDataOnGPU() {
             reinterpret_cast<const GLvoid*>(offsetof(Vertex, normal)));
     }
 
+    // Instance indices at the requested location
+    if (_instanceIndexBufferID != 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, _instanceIndexBufferID);
+        glEnableVertexAttribArray(_instanceIndexLocation);
+        glVertexAttribIPointer(_instanceIndexLocation, 1, GL_INT, sizeof(GLint), 0);
+        glVertexAttribDivisor(_instanceIndexLocation, 1);
+    }
+
     // Element buffer
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _elementBufferID);
     glBufferData(
@@ -170,4 +180,31 @@ void TriangleSoup::drawUsingActiveProgram() {
     glBindVertexArray(0);
 }
 
+void TriangleSoup::drawIndirectUsingActiveProgram(size_t indirectOffset,
+                                                  GLsizei drawCount)
+{
+    if (_gpuDataNeedUpdate) {
+        updateDataOnGPU();
+    }
+    glBindVertexArray(_vaoID);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _elementBufferID);
+    glMultiDrawElementsIndirect(
+        GL_TRIANGLES,
+        GL_UNSIGNED_INT,
+        reinterpret_cast<const GLvoid*>(indirectOffset),
+        drawCount,
+        0);
+    glBindVertexArray(0);
+}
+
+void TriangleSoup::setInstanceIndexAttribute(GLuint location, GLuint bufferId) {
+    _instanceIndexLocation = location;
+    _instanceIndexBufferID = bufferId;
+    _gpuDataNeedUpdate = true;
+}
+
+GLsizei TriangleSoup::numElements() const {
+    return static_cast<GLsizei>(_elementData.size());
+}
+
 } // namespace openspace
@@ -74,6 +74,25 @@ public:
     */
     void drawUsingActiveProgram();
 
+    /**
+    * Draws the triangles once for each of the <code>drawCount</code> indirect draw
+    * commands starting at byte offset <code>indirectOffset</code> of the currently
+    * bound <code>GL_DRAW_INDIRECT_BUFFER</code>, using the current bound program
+    * object.
+    */
+    void drawIndirectUsingActiveProgram(size_t indirectOffset, GLsizei drawCount);
+
+    /**
+    * Adds an integer vertex attribute at <code>location</code> that is read from the
+    * buffer <code>bufferId</code> and advances once per instance instead of once per
+    * vertex. Together with the <code>baseInstance</code> of indirect draw commands this
+    * gives the shader the index of each draw within a multi-draw call.
+    */
+    void setInstanceIndexAttribute(GLuint location, GLuint bufferId);
+
+    /// Returns the number of elements drawn for each draw
+    GLsizei numElements() const;
+
 protected:
     // Determines what attribute data is in use
     bool _useVertexPositions;
@@ -100,6 +119,8 @@ private:
     GLuint _vaoID;
     GLuint _vertexBufferID;
     GLuint _elementBufferID;
+    GLuint _instanceIndexBufferID;
+    GLuint _instanceIndexLocation;
 
     bool _gpuDataNeedUpdate;
 };
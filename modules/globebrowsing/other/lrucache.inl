@@ -68,6 +68,17 @@ namespace openspace {
     }
 
 
+    template<typename KeyType, typename ValueType>
+    void LRUCache<KeyType, ValueType>::remove(const KeyType& key)
+    {
+        auto it = _itemMap.find(key);
+        if (it != _itemMap.end()) {
+            _itemList.erase(it->second);
+            _itemMap.erase(it);
+        }
+    }
+
+
     template<typename KeyType, typename ValueType>
     bool LRUCache<KeyType, ValueType>::exist(const KeyType& key) const
     {
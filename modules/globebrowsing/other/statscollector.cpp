@@ -22,13 +22,185 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
+#include <modules/globebrowsing/other/statscollector.h>
 
+#include <ghoul/logging/logmanager.h>
 
-#include <modules/globebrowsing/other/statscollector.h>
+#include <cstdint>
+
+namespace {
+    const std::string _loggerCat = "StatsCollector";
 
+    void writeUInt32(std::ostream& os, size_t value) {
+        uint32_t v = static_cast<uint32_t>(value);
+        os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
 
+    void writeKeys(std::ostream& os, const std::vector<std::string>& keys,
+        size_t numKeys)
+    {
+        for (size_t i = 0; i < numKeys; ++i) {
+            writeUInt32(os, keys[i].size());
+            os.write(keys[i].data(), keys[i].size());
+        }
+    }
+}
 
 namespace openspace {
 
+    StatsCollector::StatsCollector(const std::string& filename, int dumpEveryXRecord,
+        Enabled enabled, size_t capacity)
+        : _filename(filename)
+        , _dumpEveryXRecord(std::max(dumpEveryXRecord, 0))
+        , _capacity(std::max(capacity, size_t(1)))
+        , _enabled(enabled)
+        , _hasCurrentRecord(false)
+        , _hasAllocated(false)
+        , _numDroppedRecords(0)
+        , _numStored(0)
+        , _numWritten(0)
+        , _dumpRequested(false)
+        , _stop(false)
+    {
+
+    }
+
+    StatsCollector::~StatsCollector() {
+        // The current record is complete once its owner is destroyed
+        storeCurrentRecord();
+        if (_writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _storedCondition.notify_one();
+            _writer.join();
+        }
+    }
+
+    void StatsCollector::startNewRecord() {
+        storeCurrentRecord();
+        i.clearCurrent();
+        d.clearCurrent();
+        _hasCurrentRecord = true;
+    }
+
+    void StatsCollector::disable() {
+        _enabled = false;
+    }
+
+    void StatsCollector::enable() {
+        _enabled = true;
+    }
+
+    bool StatsCollector::isEnabled() const {
+        return _enabled;
+    }
+
+    void StatsCollector::dumpToDisk() {
+        if (!_hasAllocated) {
+            return;
+        }
+        size_t numStored = _numStored.load(std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _dumpRequested = true;
+        _storedCondition.notify_one();
+        _writtenCondition.wait(lock, [this, numStored]() {
+            return _numWritten.load(std::memory_order_relaxed) >= numStored;
+        });
+    }
+
+    size_t StatsCollector::numDroppedRecords() const {
+        return _numDroppedRecords;
+    }
+
+    void StatsCollector::storeCurrentRecord() {
+        if (!_enabled || !_hasCurrentRecord) {
+            return;
+        }
+
+        if (!_hasAllocated) {
+            // Fix the keys, the ring buffer and the file header with the first record
+            i.allocate(_capacity);
+            d.allocate(_capacity);
+            writeHeader();
+            _hasAllocated = true;
+            _writer = std::thread([this]() { writeRecords(); });
+        }
+
+        size_t numStored = _numStored.load(std::memory_order_relaxed);
+        size_t numPending = numStored - _numWritten.load(std::memory_order_acquire);
+        if (numPending >= _capacity) {
+            if (_numDroppedRecords == 0) {
+                LWARNING("Stats writer for '" << _filename << "' fell behind. " <<
+                    "Dropping records");
+            }
+            ++_numDroppedRecords;
+            return;
+        }
+
+        size_t slot = numStored % _capacity;
+        i.store(slot);
+        d.store(slot);
+        _numStored.store(numStored + 1, std::memory_order_release);
+
+        if (_dumpEveryXRecord > 0 && numPending + 1 >= _dumpEveryXRecord) {
+            // Locking makes sure the writer is either waiting or sees the new record
+            std::lock_guard<std::mutex> lock(_mutex);
+            _storedCondition.notify_one();
+        }
+    }
+
+    void StatsCollector::writeHeader() {
+        _file.open(_filename, std::ofstream::out | std::ofstream::binary);
+        if (!_file.good()) {
+            LERROR("Could not open '" << _filename << "' for writing stats");
+            return;
+        }
+        _file.write("OSSTATS1", 8);
+        writeUInt32(_file, i._numRecordedKeys);
+        writeUInt32(_file, d._numRecordedKeys);
+        writeKeys(_file, i.keys(), i._numRecordedKeys);
+        writeKeys(_file, d.keys(), d._numRecordedKeys);
+    }
+
+    void StatsCollector::writeRecords() {
+        const size_t intBytes = i._numRecordedKeys * sizeof(long long);
+        const size_t doubleBytes = d._numRecordedKeys * sizeof(double);
+
+        while (true) {
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _storedCondition.wait(lock, [this]() {
+                    size_t numPending = _numStored.load(std::memory_order_relaxed) -
+                        _numWritten.load(std::memory_order_relaxed);
+                    return _stop || _dumpRequested ||
+                        (_dumpEveryXRecord > 0 && numPending >= _dumpEveryXRecord);
+                });
+                stop = _stop;
+                _dumpRequested = false;
+            }
+
+            size_t numStored = _numStored.load(std::memory_order_acquire);
+            size_t numWritten = _numWritten.load(std::memory_order_relaxed);
+            for (; numWritten < numStored; ++numWritten) {
+                size_t slot = numWritten % _capacity;
+                _file.write(reinterpret_cast<const char*>(i.stored(slot)), intBytes);
+                _file.write(reinterpret_cast<const char*>(d.stored(slot)), doubleBytes);
+            }
+            _file.flush();
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _numWritten.store(numWritten, std::memory_order_release);
+            }
+            _writtenCondition.notify_all();
+
+            if (stop) {
+                return;
+            }
+        }
+    }
 
-} // namespace openspace
\ No newline at end of file
+} // namespace openspace
@@ -25,266 +25,171 @@
 #define __STATS_TRACKER_H__
 
 #include <ghoul/misc/boolean.h>
-#include <ghoul/logging/logmanager.h>
-#include <ghoul/filesystem/filesystem>
-
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
-#include <iomanip>
-#include <unordered_map>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
-#include <set>
-#include <memory>
-
-
 
 namespace openspace {
-    
 
-    template <typename T> 
-    struct StatsRecord : public std::unordered_map<std::string, T> {
-
-    };
+    class StatsCollector;
 
+    /**
+    * Stats of one value type. Every key is registered once and gets a slot, which is
+    * what the values are accessed through. The values of the current record live in a
+    * flat array that is copied into the ring buffer of the owning StatsCollector when
+    * the next record is started.
+    */
     template <typename T>
-    struct StatsCollection : public std::vector<StatsRecord<T>> {
-        std::set<std::string> keys;
-    };
-
-
-    template <typename T> class TemplatedStatsCollector{
+    class TemplatedStatsCollector {
     public:
-
-        TemplatedStatsCollector(bool& enabled, const std::string& delimiter) 
-            : _enabled(enabled) 
-            , _delimiter(delimiter)
-            , _writePos(0) { };
-
-        ~TemplatedStatsCollector() { };
-
-        void startNewRecord() {
-            if(_enabled)
-                _data.push_back(StatsRecord<T>());
-        }
-
-        T& operator[](const std::string& name) {
-            if (_enabled) {
-                _data.keys.insert(name);
-                return _data.back()[name];
+        using Key = size_t;
+
+        TemplatedStatsCollector()
+            : _numRecordedKeys(0) { };
+
+        /**
+        * Registers a key and returns its slot. Registering a name twice returns the
+        * same slot. Keys have to be registered before the first record is stored, as
+        * keys registered later can be accessed but are not recorded.
+        */
+        Key addKey(const std::string& name) {
+            for (Key key = 0; key < _keys.size(); ++key) {
+                if (_keys[key] == name) {
+                    return key;
+                }
             }
-            else return _dummy;
+            _keys.push_back(name);
+            _current.push_back(T());
+            return _keys.size() - 1;
         }
 
-        T previous(const std::string& name) {
-            if (_data.size() > 1) {
-                return _data[_data.size() - 2][name];   
-            }
-            return T();
+        T& operator[](Key key) {
+            return _current[key];
         }
 
-        bool hasHeaders() {
-            return _data.keys.size() > 0;
+        const std::vector<std::string>& keys() const {
+            return _keys;
         }
 
-        bool hasRecordsToWrite() {
-            return _writePos < _data.size() - 1;
-        }
+    private:
+        friend class StatsCollector;
 
-        void reset() {
-            // copy last, i.e. current record
-            StatsRecord<T> lastRecord = _data.back();
-            _data.clear();
-            // add it again after cleared the vector
-            _data.push_back(lastRecord);
-            _writePos = 0;
-            
+        void allocate(size_t capacity) {
+            _numRecordedKeys = _keys.size();
+            _ring.resize(capacity * _numRecordedKeys);
         }
 
-        void writeHeader(std::ostream& os) {
-            auto keyIt = _data.keys.begin();
-            os << *keyIt;
-            while (++keyIt != _data.keys.end()) {
-                os << _delimiter << *keyIt;
-            }
+        void clearCurrent() {
+            std::fill(_current.begin(), _current.end(), T());
         }
 
-        void writeNextRecord(std::ostream& os) {
-            if (hasRecordsToWrite()) {
-                // output line by line
-                StatsRecord<T>& record = _data[_writePos];
-
-                // Access every key. Records with no entry will get a default value
-                auto keyIt = _data.keys.begin();
-                if (keyIt != _data.keys.end()) {
-                    os << record[(*keyIt)];
-                    while (++keyIt != _data.keys.end()) {
-                        os << _delimiter << record[(*keyIt)];
-                    }
-                }
-
-                _writePos++;
-            }
+        void store(size_t slot) {
+            std::copy(_current.begin(), _current.begin() + _numRecordedKeys,
+                _ring.begin() + slot * _numRecordedKeys);
         }
 
+        const T* stored(size_t slot) const {
+            return _ring.data() + slot * _numRecordedKeys;
+        }
 
-    private:
-        
-        StatsCollection<T> _data;
-        T _dummy; // used when disabled
-        bool& _enabled;
-
-        size_t _writePos;
-        std::string _delimiter;
-
+        std::vector<std::string> _keys;
+        std::vector<T> _current;
+        std::vector<T> _ring;
+        size_t _numRecordedKeys;
     };
 
+    /**
+    * Collects integer and floating point stats once per record, typically once per
+    * frame, with a fixed set of keys. Records are stored in a preallocated ring buffer
+    * and written to disk on a background thread, so collecting stats does not allocate
+    * and does not block on file I/O. When the writer falls behind and the ring buffer
+    * is full, new records are dropped rather than stalling the caller.
+    *
+    * The file is binary and starts with the magic string <code>OSSTATS1</code>,
+    * followed by the number of integer keys and the number of double keys as 32 bit
+    * unsigned integers. Every key name follows as a 32 bit length and its characters,
+    * the integer keys first. After the header come the records, each of which holds one
+    * 64 bit integer per integer key followed by one double per double key, all in the
+    * native byte order.
+    */
     class StatsCollector {
-
     public:
-
-        StatsCollector() = delete;
-
         using Enabled = ghoul::Boolean;
+        using Key = size_t;
 
-        StatsCollector(const std::string& filename, int dumpEveryXRecord, Enabled enabled = Enabled::Yes, const std::string& delimiter = ",")
-            : _filename(filename)
-            , _dumpEveryXRecord(dumpEveryXRecord)
-            , _recordsSinceLastDump(0)
-            , _enabled(enabled)
-            , _delimiter(delimiter)
-            , _hasWrittenHeader(false)
-            , i(TemplatedStatsCollector<long long>(_enabled, delimiter))
-            , d(TemplatedStatsCollector<double>(_enabled, delimiter))
-        {
-
-        };
-
-        ~StatsCollector() {
-            dumpToDisk();
-        }
-        
-        void startNewRecord() {
-            if (_enabled) {
-                if (_dumpEveryXRecord && ++_recordsSinceLastDump >= _dumpEveryXRecord) {
-                    dumpToDisk();
-                    _recordsSinceLastDump = 0;
-                }
-
-                i.startNewRecord();
-                d.startNewRecord();
-            }
-        }
-
-        void disable() {
-            _enabled = false;
-        }
-
-        void enable() {
-            _enabled = true;
-        }
+        StatsCollector() = delete;
 
-        int hasHeaders() {
-            return i.hasHeaders() || d.hasHeaders();
-        }
-
-        void dumpToDisk() {
-            if (_enabled && hasHeaders()) {
-                if (!_hasWrittenHeader) {
-                    writeHeader();
-                }
-                writeData();
-            }
-        }
+        /**
+        * \param filename The file the records are written to. It is overwritten when
+        * the first record is stored
+        * \param dumpEveryXRecord The number of records after which the writer thread
+        * is woken up. If zero, records are only written by dumpToDisk and on
+        * destruction
+        * \param enabled Whether records are stored
+        * \param capacity The number of records the ring buffer holds
+        */
+        StatsCollector(const std::string& filename, int dumpEveryXRecord,
+            Enabled enabled = Enabled::Yes, size_t capacity = 4096);
+
+        ~StatsCollector();
+
+        /**
+        * Stores the current record, if enabled, and starts a new one with all values
+        * set to zero. The keys are fixed when the first record is stored.
+        */
+        void startNewRecord();
+
+        void disable();
+        void enable();
+        bool isEnabled() const;
+
+        /**
+        * Writes all stored records to disk and returns when they are written.
+        */
+        void dumpToDisk();
+
+        /**
+        * Returns the number of records that were dropped because the ring buffer was
+        * full.
+        */
+        size_t numDroppedRecords() const;
 
         TemplatedStatsCollector<long long> i;
         TemplatedStatsCollector<double> d;
 
     private:
-        void writeHeader() {
-            std::ofstream ofs(_filename);
-            if (i.hasHeaders()) {
-                i.writeHeader(ofs);
-                if (d.hasHeaders()) {
-                    ofs << _delimiter;
-                    d.writeHeader(ofs);
-                }
-            }
-            else {
-                d.writeHeader(ofs);
-            }
-            _hasWrittenHeader = true;
-            ofs << std::endl;
-            ofs.close();
-        }
-
-        void writeData() {
-            std::ofstream ofs(_filename, std::ofstream::out | std::ofstream::app);
-            ofs << std::setprecision(32);
-            while (i.hasRecordsToWrite() || d.hasRecordsToWrite()) {
-                if (i.hasHeaders() && d.hasHeaders()) {
-                    i.writeNextRecord(ofs); ofs << _delimiter; d.writeNextRecord(ofs);
-                }
-                else {
-                    i.writeNextRecord(ofs); d.writeNextRecord(ofs);
-                }
-                ofs << std::endl;
-            }
-            i.reset(); d.reset();
-            ofs.close();
-        }
+        void storeCurrentRecord();
+        void writeHeader();
+        void writeRecords();
 
         std::string _filename;
-        std::string _delimiter;
-
-        int _dumpEveryXRecord;
-        int _recordsSinceLastDump;
-
+        std::ofstream _file;
+        size_t _dumpEveryXRecord;
+        size_t _capacity;
         bool _enabled;
-        bool _hasWrittenHeader;
-
-    };
 
-    /*
+        bool _hasCurrentRecord;
+        bool _hasAllocated;
+        size_t _numDroppedRecords;
 
-    template <typename T>
-    struct StatsCsvWriter {
-        StatsCsvWriter(const std::string& delimiter)
-            : _delimiter(delimiter) { };
-
-        virtual void write(const StatsCollection<T>& stats, const std::string& filename) {
-            std::ofstream ofs(filename);
-            
-            // output headers
-            auto keyIt = stats.keys.begin();
-            ofs << *keyIt;
-            while (keyIt++ != stats.keys.end()) {
-                ofs << _delimiter << *keyIt;
-            }
-            ofs << std::endl;
+        // Number of records stored by the caller and written by the writer thread
+        std::atomic<size_t> _numStored;
+        std::atomic<size_t> _numWritten;
 
-            // output line by line
-            for (const StatsRecord<T>& record : stats) {
-                // Access every key. Records with no entry will get a default value
-                auto keyIt = stats.keys.begin();
-                ofs << record[*keyIt];
-                while (keyIt++ != stats.keys.end()) {
-                    ofs << _delimiter << record[*keyIt];
-                }
-                ofs << std::endl;
-            }
-            ofs.close();
-        }
-
-    private:
-        std::string _delimiter;
+        std::thread _writer;
+        std::mutex _mutex;
+        std::condition_variable _storedCondition;
+        std::condition_variable _writtenCondition;
+        bool _dumpRequested;
+        bool _stop;
     };
-    */
-
 
 } // namespace openspace
 
-
-
-
-
-#endif  // __STATS_TRACKER_H__
\ No newline at end of file
+#endif  // __STATS_TRACKER_H__
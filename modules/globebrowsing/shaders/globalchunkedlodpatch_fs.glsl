@@ -22,6 +22,10 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
+// Index of the chunk within the multi-draw call, see chunkdrawdata.hglsl
+flat in int fs_drawIndex;
+#define CHUNK_DRAW_INDEX fs_drawIndex
+
 #include <${MODULE_GLOBEBROWSING}/shaders/tilefragcolor.hglsl>
 #include "fragment.glsl"
 
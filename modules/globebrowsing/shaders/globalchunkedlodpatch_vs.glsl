@@ -24,6 +24,10 @@
 
 #version __CONTEXT__
 
+// Index of the chunk within the multi-draw call, see chunkdrawdata.hglsl
+layout(location = 3) in int in_drawIndex;
+#define CHUNK_DRAW_INDEX in_drawIndex
+
 #include "PowerScaling/powerScaling_vs.hglsl"
 #include <${MODULE_GLOBEBROWSING}/shaders/ellipsoid.hglsl>
 #include <${MODULE_GLOBEBROWSING}/shaders/tile.hglsl>
@@ -34,8 +38,6 @@ uniform mat4 modelViewProjectionTransform;
 uniform mat4 modelViewTransform;
 uniform vec3 radiiSquared;
 
-uniform vec2 minLatLon;
-uniform vec2 lonLatScalingFactor;
 uniform vec3 cameraPosition;
 
 layout(location = 1) in vec2 in_uv;
@@ -45,8 +47,11 @@ out vec4 fs_position;
 out vec3 ellipsoidNormalCameraSpace;
 out LevelWeights levelWeights;
 out vec3 positionCameraSpace;
+flat out int fs_drawIndex;
 
 PositionNormalPair globalInterpolation() {
+    vec2 minLatLon = getChunkDrawData().corners[0].xy;
+    vec2 lonLatScalingFactor = getChunkDrawData().corners[0].zw;
     vec2 lonLatInput;
     lonLatInput.y = minLatLon.y + lonLatScalingFactor.y * in_uv.y; // Lat
     lonLatInput.x = minLatLon.x + lonLatScalingFactor.x * in_uv.x; // Lon
@@ -58,7 +63,7 @@ void main() {
     PositionNormalPair pair = globalInterpolation();
     float distToVertexOnEllipsoid = length(pair.position - cameraPosition);
 
-    float levelInterpolationParameter = getLevelInterpolationParameter(chunkLevel, distanceScaleFactor, distToVertexOnEllipsoid);
+    float levelInterpolationParameter = getLevelInterpolationParameter(getChunkDrawData().chunkLevel, distanceScaleFactor, distToVertexOnEllipsoid);
 
     // use level weight for height sampling, and output to fragment shader
     levelWeights = getLevelWeights(levelInterpolationParameter);
@@ -79,4 +84,5 @@ void main() {
     gl_Position = fs_position;
     ellipsoidNormalCameraSpace = mat3(modelViewTransform) * pair.normal;
     positionCameraSpace = vec3(modelViewTransform * vec4(pair.position, 1));
+    fs_drawIndex = in_drawIndex;
 }
\ No newline at end of file
@@ -24,6 +24,10 @@
 
 #version __CONTEXT__
 
+// Index of the chunk within the multi-draw call, see chunkdrawdata.hglsl
+layout(location = 3) in int in_drawIndex;
+#define CHUNK_DRAW_INDEX in_drawIndex
+
 #include "PowerScaling/powerScaling_vs.hglsl"
 #include <${MODULE_GLOBEBROWSING}/shaders/ellipsoid.hglsl>
 #include <${MODULE_GLOBEBROWSING}/shaders/tile.hglsl>
@@ -33,13 +37,6 @@
 
 uniform mat4 projectionTransform;
 
-// Input points in camera space
-uniform vec3 p00;
-uniform vec3 p10;
-uniform vec3 p01;
-uniform vec3 p11;
-uniform vec3 patchNormalCameraSpace;
-
 layout(location = 1) in vec2 in_uv;
 
 out vec2 fs_uv;
@@ -47,8 +44,15 @@ out vec4 fs_position;
 out vec3 ellipsoidNormalCameraSpace;
 out LevelWeights levelWeights;
 out vec3 positionCameraSpace;
+flat out int fs_drawIndex;
 
 vec3 bilinearInterpolation(vec2 uv) {
+    // Input points in camera space
+    vec3 p00 = getChunkDrawData().corners[0].xyz;
+    vec3 p10 = getChunkDrawData().corners[1].xyz;
+    vec3 p01 = getChunkDrawData().corners[2].xyz;
+    vec3 p11 = getChunkDrawData().corners[3].xyz;
+
     vec3 p0 = (1 - uv.x) * p00 + uv.x * p10;
     vec3 p1 = (1 - uv.x) * p01 + uv.x * p11;
     vec3 p = (1 - uv.y) * p0 + uv.y * p1;
@@ -56,6 +60,7 @@ vec3 bilinearInterpolation(vec2 uv) {
 }
 
 void main() {
+    vec3 patchNormalCameraSpace = getChunkDrawData().patchNormalCameraSpace;
 
     // Position in cameraspace
     vec3 p = bilinearInterpolation(in_uv);
@@ -63,7 +68,7 @@ void main() {
     // Calculate desired level based on distance to the vertex on the ellipsoid
     // Before any heightmapping is done
     float distToVertexOnEllipsoid = length(p);
-    float levelInterpolationParameter = getLevelInterpolationParameter(chunkLevel, distanceScaleFactor, distToVertexOnEllipsoid);
+    float levelInterpolationParameter = getLevelInterpolationParameter(getChunkDrawData().chunkLevel, distanceScaleFactor, distToVertexOnEllipsoid);
 
     // use level weight for height sampling, and output to fragment shader
     levelWeights = getLevelWeights(levelInterpolationParameter);
@@ -85,4 +90,5 @@ void main() {
     gl_Position = fs_position;
     ellipsoidNormalCameraSpace = patchNormalCameraSpace;
     positionCameraSpace = p;
+    fs_drawIndex = in_drawIndex;
 }
\ No newline at end of file
@@ -34,6 +34,8 @@
 
 #include <modules/globebrowsing/geometry/angle.h>
 
+#include <chrono>
+
 namespace {
     const std::string _loggerCat = "AsyncTextureDataProvider";
 }
@@ -43,7 +45,17 @@ namespace {
 namespace openspace {
 
     void TileLoadJob::execute() {
+        auto t0 = std::chrono::high_resolution_clock::now();
         _tileIOResult = _tileDataset->readTileData(_chunkIndex);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        if (_stageTimes) {
+            _stageTimes->add(TileStageTimes::Stage::Read,
+                std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0));
+        }
+
+        if (_tileProcessor) {
+            _tileProcessor->process(*_tileIOResult, _stageTimes.get());
+        }
     }
 
 
@@ -117,8 +129,12 @@ namespace openspace {
 
     AsyncTileDataProvider::AsyncTileDataProvider(
         std::shared_ptr<TileDataset> tileDataset,
-        std::shared_ptr<ThreadPool> pool)
+        std::shared_ptr<ThreadPool> pool,
+        const TileProcessor::Configuration& processorConfig)
         : _tileDataset(tileDataset)
+        , _tileProcessor(std::make_shared<TileProcessor>(
+            tileDataset->getDataLayout(), processorConfig))
+        , _stageTimes(std::make_shared<TileStageTimes>())
         , _concurrentJobManager(pool)
     {
 
@@ -133,9 +149,18 @@ namespace openspace {
         return _tileDataset;
     }
 
+    const TileProcessor& AsyncTileDataProvider::getTileProcessor() const {
+        return *_tileProcessor;
+    }
+
+    TileStageTimes& AsyncTileDataProvider::getStageTimes() {
+        return *_stageTimes;
+    }
+
     bool AsyncTileDataProvider::enqueueTileIO(const ChunkIndex& chunkIndex) {
         if (satisfiesEnqueueCriteria(chunkIndex)) {
-            auto job = std::make_shared<TileLoadJob>(_tileDataset, chunkIndex);
+            auto job = std::make_shared<TileLoadJob>(
+                _tileDataset, chunkIndex, _tileProcessor, _stageTimes);
             //auto job = std::make_shared<DiskCachedTileLoadJob>(_tileDataset, chunkIndex, tileDiskCache, "ReadAndWrite");
             _concurrentJobManager.enqueueJob(job);
             _enqueuedTileRequests[chunkIndex.hashKey()] = chunkIndex;
@@ -148,10 +173,18 @@ namespace openspace {
     std::vector<std::shared_ptr<TileIOResult>> AsyncTileDataProvider::getTileIOResults() {
         std::vector<std::shared_ptr<TileIOResult>> readyResults;
         while (_concurrentJobManager.numFinishedJobs() > 0) {
-            readyResults.push_back(_concurrentJobManager.popFinishedJob()->product());
+            std::shared_ptr<TileIOResult> result =
+                _concurrentJobManager.popFinishedJob()->product();
+            // The tile may be requested again once it has been evicted from the cache
+            _enqueuedTileRequests.erase(result->chunkIndex.hashKey());
+            readyResults.push_back(result);
         }
         return readyResults;
     }
+
+    size_t AsyncTileDataProvider::numEnqueuedRequests() const {
+        return _enqueuedTileRequests.size();
+    }
    
 
     bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const ChunkIndex& chunkIndex) const {
@@ -37,6 +37,7 @@
 //#include <ghoul/misc/threadpool.h>
 
 #include <modules/globebrowsing/tile/tiledataset.h>
+#include <modules/globebrowsing/tile/tileprocessor.h>
 
 
 #include <memory>
@@ -58,9 +59,13 @@ namespace openspace {
 
         
         TileLoadJob(std::shared_ptr<TileDataset> textureDataProvider, 
-            const ChunkIndex& chunkIndex)
+            const ChunkIndex& chunkIndex,
+            std::shared_ptr<const TileProcessor> tileProcessor = nullptr,
+            std::shared_ptr<TileStageTimes> stageTimes = nullptr)
             : _tileDataset(textureDataProvider)
             , _chunkIndex(chunkIndex) 
+            , _tileProcessor(tileProcessor)
+            , _stageTimes(stageTimes)
         {
 
         }
@@ -79,6 +84,8 @@ namespace openspace {
         ChunkIndex _chunkIndex;
         std::shared_ptr<TileDataset> _tileDataset;
         std::shared_ptr<TileIOResult> _tileIOResult;
+        std::shared_ptr<const TileProcessor> _tileProcessor;
+        std::shared_ptr<TileStageTimes> _stageTimes;
     };
 
 
@@ -119,19 +126,39 @@ namespace openspace {
     public:
 
         AsyncTileDataProvider(std::shared_ptr<TileDataset> textureDataProvider, 
-            std::shared_ptr<ThreadPool> pool);
+            std::shared_ptr<ThreadPool> pool,
+            const TileProcessor::Configuration& processorConfig =
+                TileProcessor::Configuration());
 
         ~AsyncTileDataProvider();
 
 
         bool enqueueTileIO(const ChunkIndex& chunkIndex);        
         std::vector<std::shared_ptr<TileIOResult>> getTileIOResults();
+
+        /**
+        * Returns the number of tiles that have been enqueued but whose results have not
+        * been returned by <code>getTileIOResults</code> yet.
+        */
+        size_t numEnqueuedRequests() const;
         
         void reset();
         void clearRequestQueue();
 
         std::shared_ptr<TileDataset> getTextureDataProvider() const;
 
+        /**
+        * The processor that converts the read tiles on the I/O workers. Its output
+        * layout is the layout of the image data in the returned results.
+        */
+        const TileProcessor& getTileProcessor() const;
+
+        /**
+        * Time spent reading and processing the tiles of this provider. The tile
+        * provider that uploads the results adds its upload time as well.
+        */
+        TileStageTimes& getStageTimes();
+
     protected:
 
         virtual bool satisfiesEnqueueCriteria(const ChunkIndex&) const;
@@ -141,6 +168,8 @@ namespace openspace {
 
 
         std::shared_ptr<TileDataset> _tileDataset;
+        std::shared_ptr<const TileProcessor> _tileProcessor;
+        std::shared_ptr<TileStageTimes> _stageTimes;
         ConcurrentJobManager<TileIOResult> _concurrentJobManager;
         std::unordered_map<ChunkHashKey, ChunkIndex> _enqueuedTileRequests;
 
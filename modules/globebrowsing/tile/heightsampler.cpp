@@ -0,0 +1,151 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/heightsampler.h>
+
+#include <modules/globebrowsing/tile/tileprovidermanager.h>
+#include <modules/globebrowsing/tile/tileselector.h>
+
+#include <ghoul/misc/assert.h>
+
+#include <algorithm>
+
+namespace {
+    openspace::ChunkIndex chunkIndexAt(const openspace::Geodetic2& position, int level) {
+        openspace::ChunkIndex chunkIndex(position, level);
+        // Positions on the +180 meridian or the south pole end up just outside
+        chunkIndex.x = std::min(chunkIndex.x, (1 << level) - 1);
+        chunkIndex.y = std::min(chunkIndex.y, (1 << (level - 1)) - 1);
+        return chunkIndex;
+    }
+}
+
+namespace openspace {
+
+    HeightSampler::HeightSampler(
+        std::shared_ptr<TileProviderManager> tileProviderManager, size_t cacheSize)
+        : _tileProviderManager(tileProviderManager)
+        , _heightTiles(cacheSize)
+    {}
+
+    void HeightSampler::getHeights(const std::vector<Geodetic2>& positions,
+        const std::vector<int>& levels, std::vector<float>& heights)
+    {
+        ghoul_assert(positions.size() == levels.size(), "Each position needs a level");
+        heights.assign(positions.size(), 0.f);
+
+        auto heightMapProviders = _tileProviderManager->getTileProviderGroup(
+            LayeredTextures::HeightMaps).getActiveTileProviders();
+        if (heightMapProviders.empty() || positions.empty()) {
+            return;
+        }
+        TileProvider* tileProvider = heightMapProviders[0].get();
+        TileDepthTransform depthTransform = tileProvider->depthTransform();
+        int maximumLevel = std::max(tileProvider->maxLevel(), 1);
+
+        // Group the positions by the chunk they are sampled in
+        _positionsByTile.resize(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            int level = glm::clamp(levels[i], 1, maximumLevel);
+            _positionsByTile[i] = { chunkIndexAt(positions[i], level).hashKey(), i };
+        }
+        std::sort(_positionsByTile.begin(), _positionsByTile.end());
+
+        size_t begin = 0;
+        while (begin < _positionsByTile.size()) {
+            size_t end = begin + 1;
+            while (end < _positionsByTile.size() &&
+                _positionsByTile[end].first == _positionsByTile[begin].first)
+            {
+                ++end;
+            }
+
+            size_t first = _positionsByTile[begin].second;
+            int level = glm::clamp(levels[first], 1, maximumLevel);
+            ChunkIndex chunkIndex = chunkIndexAt(positions[first], level);
+
+            TileAndTransform tileAndTransform =
+                TileSelector::getHighestResolutionTile(tileProvider, chunkIndex);
+            std::shared_ptr<HeightTile> heightTile;
+            if (tileAndTransform.tile.status == Tile::Status::OK &&
+                tileAndTransform.tile.textureSlot != nullptr)
+            {
+                heightTile = getHeightTile(tileAndTransform.tile, depthTransform);
+            }
+
+            if (heightTile) {
+                // Map the positions to texture coordinates of the selected tile
+                GeodeticPatch patch(chunkIndex);
+                double minLat = patch.minLat();
+                double minLon = patch.minLon();
+                double latSize = patch.maxLat() - minLat;
+                double lonSize = patch.maxLon() - minLon;
+                const TileUvTransform& uvTransform = tileAndTransform.uvTransform;
+
+                size_t count = end - begin;
+                _u.resize(count);
+                _v.resize(count);
+                _sampledHeights.resize(count);
+                for (size_t j = 0; j < count; ++j) {
+                    const Geodetic2& p = positions[_positionsByTile[begin + j].second];
+                    float patchU = static_cast<float>((p.lon - minLon) / lonSize);
+                    float patchV = static_cast<float>((p.lat - minLat) / latSize);
+                    _u[j] = uvTransform.uvOffset.x + uvTransform.uvScale.x * patchU;
+                    _v[j] = uvTransform.uvOffset.y + uvTransform.uvScale.y * patchV;
+                }
+
+                heightTile->sample(_u.data(), _v.data(), count, _sampledHeights.data());
+                for (size_t j = 0; j < count; ++j) {
+                    heights[_positionsByTile[begin + j].second] = _sampledHeights[j];
+                }
+            }
+            begin = end;
+        }
+    }
+
+    void HeightSampler::clear() {
+        _heightTiles.clear();
+    }
+
+    std::shared_ptr<HeightTile> HeightSampler::getHeightTile(const Tile& tile,
+        const TileDepthTransform& depthTransform)
+    {
+        const TileTextureSlot* key = tile.textureSlot.get();
+        if (_heightTiles.exist(key)) {
+            CachedHeightTile cached = _heightTiles.get(key);
+            // The address may have been reused by a slot of a newer tile
+            if (cached.textureSlot.lock() == tile.textureSlot) {
+                return cached.heightTile;
+            }
+        }
+
+        CachedHeightTile cached = {
+            tile.textureSlot,
+            HeightTile::createFromSlot(*tile.textureSlot, depthTransform)
+        };
+        _heightTiles.put(key, cached);
+        return cached.heightTile;
+    }
+
+} // namespace openspace
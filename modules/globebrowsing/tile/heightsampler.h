@@ -0,0 +1,99 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __HEIGHT_SAMPLER_H__
+#define __HEIGHT_SAMPLER_H__
+
+#include <modules/globebrowsing/chunk/chunkindex.h>
+#include <modules/globebrowsing/geometry/geodetic2.h>
+#include <modules/globebrowsing/other/lrucache.h>
+#include <modules/globebrowsing/tile/heighttile.h>
+#include <modules/globebrowsing/tile/tile.h>
+
+#include <memory>
+#include <vector>
+
+namespace openspace {
+
+    class TileProviderManager;
+
+    /**
+    * Answers batches of terrain height queries from the first active height map of a
+    * <code>TileProviderManager</code>. Tiles are converted to <code>HeightTile</code>s
+    * the first time they are sampled and kept in an LRU cache next to the GPU textures
+    * of the TileProvider, until their texture is released.
+    */
+    class HeightSampler {
+    public:
+        /**
+        * \param tileProviderManager the manager providing the height maps
+        * \param cacheSize the maximum number of converted tiles to keep in memory
+        */
+        HeightSampler(std::shared_ptr<TileProviderManager> tileProviderManager,
+            size_t cacheSize = 64);
+
+        /**
+        * Samples the heights in meters at the provided geodetic positions. Each
+        * position is looked up in the tile of the chunk at the corresponding level. As
+        * in <code>TileSelector</code>, lower levels are used where that tile is not
+        * loaded yet, in which case the tile is requested. Positions are grouped by tile
+        * so that each tile is selected only once per call. Positions for which no tile
+        * is available get a height of 0.
+        *
+        * This method must be called from the thread that updates the TileProviders.
+        *
+        * \param positions the geodetic positions to sample
+        * \param levels the chunk level to sample each position at
+        * \param heights is resized to the number of positions and receives the heights
+        */
+        void getHeights(const std::vector<Geodetic2>& positions,
+            const std::vector<int>& levels, std::vector<float>& heights);
+
+        /**
+        * Removes all converted tiles from the cache
+        */
+        void clear();
+
+    private:
+        struct CachedHeightTile {
+            std::weak_ptr<TileTextureSlot> textureSlot;
+            std::shared_ptr<HeightTile> heightTile;
+        };
+
+        std::shared_ptr<HeightTile> getHeightTile(const Tile& tile,
+            const TileDepthTransform& depthTransform);
+
+        std::shared_ptr<TileProviderManager> _tileProviderManager;
+        LRUCache<const TileTextureSlot*, CachedHeightTile> _heightTiles;
+
+        // Scratch space reused between calls
+        std::vector<std::pair<ChunkHashKey, size_t>> _positionsByTile;
+        std::vector<float> _u;
+        std::vector<float> _v;
+        std::vector<float> _sampledHeights;
+    };
+
+} // namespace openspace
+
+#endif // __HEIGHT_SAMPLER_H__
@@ -0,0 +1,155 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/heighttile.h>
+
+#include <ghoul/misc/assert.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENSPACE_HEIGHTTILE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace openspace {
+
+    HeightTile::HeightTile(const glm::uvec2& dimensions, std::vector<float> heights)
+        : _dimensions(dimensions)
+        , _heights(std::move(heights))
+    {
+        ghoul_assert(_dimensions.x > 0 && _dimensions.y > 0, "Tile must not be empty");
+        ghoul_assert(
+            _heights.size() == static_cast<size_t>(_dimensions.x) * _dimensions.y,
+            "Number of heights must match the dimensions"
+        );
+    }
+
+    std::shared_ptr<HeightTile> HeightTile::createFromSlot(const TileTextureSlot& slot,
+        const TileDepthTransform& depthTransform)
+    {
+        glm::uvec2 dimensions = slot.dimensions();
+        std::vector<float> heights(static_cast<size_t>(dimensions.x) * dimensions.y);
+
+        size_t i = 0;
+        for (unsigned int y = 0; y < dimensions.y; ++y) {
+            for (unsigned int x = 0; x < dimensions.x; ++x) {
+                float value = slot.texelAsFloat(x, y);
+                heights[i++] =
+                    depthTransform.depthOffset + depthTransform.depthScale * value;
+            }
+        }
+        return std::make_shared<HeightTile>(dimensions, std::move(heights));
+    }
+
+    void HeightTile::sample(const float* u, const float* v, size_t n,
+                            float* heights) const
+    {
+        const unsigned int w = _dimensions.x;
+        const unsigned int h = _dimensions.y;
+        const float* data = _heights.data();
+
+        size_t i = 0;
+#ifdef OPENSPACE_HEIGHTTILE_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 width = _mm_set1_ps(static_cast<float>(w));
+        const __m128 height = _mm_set1_ps(static_cast<float>(h));
+        const __m128 maxX = _mm_set1_ps(static_cast<float>(w - 1));
+        const __m128 maxY = _mm_set1_ps(static_cast<float>(h - 1));
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 x = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(u + i), width), zero);
+            __m128 y = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(v + i), height), zero);
+
+            // Truncation equals floor as the coordinates are not negative
+            __m128i x0 = _mm_cvttps_epi32(_mm_min_ps(x, maxX));
+            __m128i y0 = _mm_cvttps_epi32(_mm_min_ps(y, maxY));
+            __m128 fx = _mm_sub_ps(x, _mm_cvtepi32_ps(x0));
+            __m128 fy = _mm_sub_ps(y, _mm_cvtepi32_ps(y0));
+
+            // SSE2 has no gather instruction, so the texels are fetched one by one
+            alignas(16) int xs[4];
+            alignas(16) int ys[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(xs), x0);
+            _mm_store_si128(reinterpret_cast<__m128i*>(ys), y0);
+
+            alignas(16) float h00[4], h10[4], h01[4], h11[4];
+            for (int k = 0; k < 4; ++k) {
+                size_t index = static_cast<size_t>(ys[k]) * w + xs[k];
+                size_t dx = static_cast<unsigned int>(xs[k]) + 1 < w ? 1 : 0;
+                size_t dy = static_cast<unsigned int>(ys[k]) + 1 < h ? w : 0;
+                h00[k] = data[index];
+                h10[k] = data[index + dx];
+                h01[k] = data[index + dy];
+                h11[k] = data[index + dx + dy];
+            }
+
+            __m128 s00 = _mm_load_ps(h00);
+            __m128 s01 = _mm_load_ps(h01);
+            __m128 s10 = _mm_load_ps(h10);
+            __m128 s11 = _mm_load_ps(h11);
+            __m128 s0 = _mm_add_ps(s00, _mm_mul_ps(fx, _mm_sub_ps(s10, s00)));
+            __m128 s1 = _mm_add_ps(s01, _mm_mul_ps(fx, _mm_sub_ps(s11, s01)));
+            __m128 s = _mm_add_ps(s0, _mm_mul_ps(fy, _mm_sub_ps(s1, s0)));
+            _mm_storeu_ps(heights + i, s);
+        }
+#endif // OPENSPACE_HEIGHTTILE_SSE2
+
+        for (; i < n; ++i) {
+            float x = std::max(u[i] * w, 0.f);
+            float y = std::max(v[i] * h, 0.f);
+            unsigned int x0 = static_cast<unsigned int>(std::min(x, float(w - 1)));
+            unsigned int y0 = static_cast<unsigned int>(std::min(y, float(h - 1)));
+            float fx = x - x0;
+            float fy = y - y0;
+
+            size_t index = static_cast<size_t>(y0) * w + x0;
+            size_t dx = x0 + 1 < w ? 1 : 0;
+            size_t dy = y0 + 1 < h ? w : 0;
+
+            float s00 = data[index];
+            float s10 = data[index + dx];
+            float s01 = data[index + dy];
+            float s11 = data[index + dx + dy];
+            float s0 = s00 + fx * (s10 - s00);
+            float s1 = s01 + fx * (s11 - s01);
+            heights[i] = s0 + fy * (s1 - s0);
+        }
+    }
+
+    float HeightTile::sample(const glm::vec2& uv) const {
+        float height;
+        sample(&uv.x, &uv.y, 1, &height);
+        return height;
+    }
+
+    const glm::uvec2& HeightTile::dimensions() const {
+        return _dimensions;
+    }
+
+    size_t HeightTile::sizeInBytes() const {
+        return _heights.size() * sizeof(float);
+    }
+
+} // namespace openspace
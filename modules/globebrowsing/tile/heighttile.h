@@ -0,0 +1,75 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __HEIGHT_TILE_H__
+#define __HEIGHT_TILE_H__
+
+#include <modules/globebrowsing/tile/tiledepthtransform.h>
+#include <modules/globebrowsing/tile/tiletexturepool.h>
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace openspace {
+
+    /**
+    * A compact CPU-side copy of the first channel of a height map tile. The heights
+    * are stored as floats in meters, i.e. with the <code>TileDepthTransform</code>
+    * already applied, so that sampling needs no per-texel format dispatch.
+    */
+    class HeightTile {
+    public:
+        HeightTile(const glm::uvec2& dimensions, std::vector<float> heights);
+
+        /**
+        * Converts the first channel of a texture slot with CPU-side pixel data. The 
+        * conversion uses <code>TileTextureSlot::texelAsFloat</code> once per texel,
+        * which makes sampled heights identical to sampling the texture directly.
+        */
+        static std::shared_ptr<HeightTile> createFromSlot(const TileTextureSlot& slot,
+            const TileDepthTransform& depthTransform);
+
+        /**
+        * Bilinearly samples the heights at <code>n</code> texture coordinates. A 
+        * coordinate of 0 refers to the first texel, a coordinate of 1 to the end of the
+        * last texel. Samples are clamped to the edges of the tile. Four samples are
+        * processed at a time when SSE2 is available.
+        */
+        void sample(const float* u, const float* v, size_t n, float* heights) const;
+
+        float sample(const glm::vec2& uv) const;
+
+        const glm::uvec2& dimensions() const;
+        size_t sizeInBytes() const;
+
+    private:
+        glm::uvec2 _dimensions;
+        std::vector<float> _heights;
+    };
+
+} // namespace openspace
+
+#endif // __HEIGHT_TILE_H__
@@ -28,11 +28,149 @@
 #include <openspace/engine/openspaceengine.h>
 
 #include "ghoul/misc/dictionary.h"
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
 #include <string>
 
+#ifndef GL_COMPLETION_STATUS_ARB
+#define GL_COMPLETION_STATUS_ARB 0x91B1
+#endif
+
 namespace {
     const std::string _loggerCat = "LayeredTextureShaderProvider";
+
+    bool hasParallelShaderCompile() {
+        static const bool isSupported =
+            OpenGLCap.isExtensionSupported("GL_ARB_parallel_shader_compile") ||
+            OpenGLCap.isExtensionSupported("GL_KHR_parallel_shader_compile");
+        return isSupported;
+    }
+
+    std::vector<GLuint> attachedShaders(GLuint program) {
+        GLint nShaders = 0;
+        glGetProgramiv(program, GL_ATTACHED_SHADERS, &nShaders);
+        std::vector<GLuint> shaders(nShaders);
+        if (nShaders > 0) {
+            glGetAttachedShaders(program, nShaders, nullptr, shaders.data());
+        }
+        return shaders;
+    }
+
+    std::string shaderInfoLog(GLuint shader) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<GLchar> log(length + 1, '\0');
+        glGetShaderInfoLog(shader, length, nullptr, log.data());
+        return log.data();
+    }
+
+    std::string programInfoLog(GLuint program) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::vector<GLchar> log(length + 1, '\0');
+        glGetProgramInfoLog(program, length, nullptr, log.data());
+        return log.data();
+    }
+
+    /**
+    * 64 bit FNV-1a hash. Unlike <code>std::hash</code> it gives the same value in every
+    * run and build, which the program binary cache depends on.
+    */
+    uint64_t fnv1a(const std::string& data, uint64_t hash = 14695981039346656037ULL) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /**
+    * Returns the key of a program binary in the cache. A binary can only be loaded by
+    * the driver that created it, so the driver is part of the key along with the
+    * preprocessed sources of <code>shaders</code>.
+    */
+    std::string programBinaryKey(const std::vector<GLuint>& shaders) {
+        uint64_t hash = fnv1a("");
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* value = glGetString(name);
+            if (value) {
+                hash = fnv1a(reinterpret_cast<const char*>(value), hash);
+            }
+        }
+        for (GLuint shader : shaders) {
+            GLint length = 0;
+            glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &length);
+            std::vector<GLchar> source(length + 1, '\0');
+            glGetShaderSource(shader, length, nullptr, source.data());
+            hash = fnv1a(source.data(), hash);
+        }
+        std::stringstream key;
+        key << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return key.str();
+    }
+
+    /**
+    * Replaces the executable of <code>program</code> with the binary stored in
+    * <code>filename</code>.
+    * \returns false if there is no stored binary or the driver rejected it
+    */
+    bool loadProgramBinary(GLuint program, const std::string& filename) {
+        std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::streamoff size = file.tellg();
+        if (size <= static_cast<std::streamoff>(sizeof(GLenum))) {
+            return false;
+        }
+        file.seekg(0);
+        GLenum format;
+        file.read(reinterpret_cast<char*>(&format), sizeof(GLenum));
+        std::vector<char> binary(static_cast<size_t>(size) - sizeof(GLenum));
+        file.read(binary.data(), binary.size());
+        if (!file) {
+            return false;
+        }
+
+        glProgramBinary(program, format, binary.data(),
+            static_cast<GLsizei>(binary.size()));
+        GLint isLinked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+        if (isLinked == GL_FALSE) {
+            // For example after a driver update
+            LINFO("Discarding outdated program binary " << filename);
+            return false;
+        }
+        return true;
+    }
+
+    void saveProgramBinary(GLuint program, const std::string& filename) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length == 0) {
+            return;
+        }
+        std::vector<char> binary(length);
+        GLenum format;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+        std::ofstream file(filename, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            LWARNING("Failed to open " << filename);
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&format), sizeof(GLenum));
+        file.write(binary.data(), binary.size());
+    }
 }
 
 namespace openspace {
@@ -72,6 +210,22 @@ namespace openspace {
         }
     }
 
+    size_t LayeredTexturePreprocessingData::hash() const {
+        size_t hash = 0;
+        auto combine = [&hash](size_t value) {
+            hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        };
+        for (const LayeredTextureInfo& info : layeredTextureInfo) {
+            combine(std::hash<int>()(info.lastLayerIdx));
+            combine(std::hash<bool>()(info.layerBlendingEnabled));
+        }
+        for (const auto& keyValuePair : keyValuePairs) {
+            combine(std::hash<std::string>()(keyValuePair.first));
+            combine(std::hash<std::string>()(keyValuePair.second));
+        }
+        return hash;
+    }
+
     LayeredTextureShaderProvider::LayeredTextureShaderProvider(
         const std::string& shaderName,
         const std::string& vsPath,
@@ -79,6 +233,7 @@ namespace openspace {
         : _shaderName(shaderName)
         , _vsPath(vsPath)
         , _fsPath(fsPath)
+        , _programObject(nullptr)
         , _updatedOnLastCall(false)
     {
     
@@ -86,34 +241,163 @@ namespace openspace {
     
     LayeredTextureShaderProvider::~LayeredTextureShaderProvider()
     {
-        if (_programObject) {
-            RenderEngine& renderEngine = OsEng.renderEngine();
-            renderEngine.removeRenderProgram(_programObject);
-            _programObject = nullptr;
+        RenderEngine& renderEngine = OsEng.renderEngine();
+        for (CachedProgram& cachedProgram : _cachedPrograms) {
+            renderEngine.removeRenderProgram(cachedProgram.programObject);
         }
+        for (CachedProgram& pendingProgram : _pendingPrograms) {
+            renderEngine.removeRenderProgram(pendingProgram.programObject);
+        }
+        _cachedPrograms.clear();
+        _pendingPrograms.clear();
+        _programObject = nullptr;
     }
 
     ProgramObject* LayeredTextureShaderProvider::getUpdatedShaderProgram(
         LayeredTexturePreprocessingData preprocessingData)
     {
         _updatedOnLastCall = false;
-        if (!(preprocessingData == _preprocessingData) || _programObject == nullptr) {
-            recompileShaderProgram(preprocessingData);
-            _updatedOnLastCall = true;
+        if (preprocessingData == _preprocessingData && _programObject != nullptr) {
+            return _programObject;
+        }
+
+        size_t hash = preprocessingData.hash();
+        auto it = findProgram(_cachedPrograms, preprocessingData, hash);
+        if (it != _cachedPrograms.end()) {
+            // Move the program to the front to mark it as the most recently used one
+            _cachedPrograms.splice(_cachedPrograms.begin(), _cachedPrograms, it);
+        }
+        else {
+            it = findProgram(_pendingPrograms, preprocessingData, hash);
+            if (it != _pendingPrograms.end()) {
+                _cachedPrograms.splice(_cachedPrograms.begin(), _pendingPrograms, it);
+            }
+            else {
+                _cachedPrograms.push_front(startCompilation(preprocessingData, hash));
+            }
+            finishCompilation(_cachedPrograms.front(), true);
+            ghoul_assert(
+                _cachedPrograms.front().programObject != nullptr,
+                "Failed to initialize programObject!");
+            evictCachedPrograms();
         }
-        return _programObject.get();
+
+        _preprocessingData = preprocessingData;
+        _programObject = _cachedPrograms.front().programObject.get();
+        _updatedOnLastCall = true;
+        return _programObject;
     }
 
-    void LayeredTextureShaderProvider::recompileShaderProgram(
+    void LayeredTextureShaderProvider::queuePrecompilation(
         LayeredTexturePreprocessingData preprocessingData)
     {
-        _preprocessingData = preprocessingData;
+        size_t hash = preprocessingData.hash();
+        if (findProgram(_cachedPrograms, preprocessingData, hash) !=
+                _cachedPrograms.end() ||
+            findProgram(_pendingPrograms, preprocessingData, hash) !=
+                _pendingPrograms.end())
+        {
+            return;
+        }
+        for (const LayeredTexturePreprocessingData& queued : _precompilationQueue) {
+            if (queued == preprocessingData) {
+                return;
+            }
+        }
+        _precompilationQueue.push_back(std::move(preprocessingData));
+    }
+
+    void LayeredTextureShaderProvider::clearPrecompilationQueue() {
+        _precompilationQueue.clear();
+    }
+
+    void LayeredTextureShaderProvider::updatePrecompilation() {
+        // Without parallel compilation the driver compiles on the render thread, so
+        // only one program is compiled per call to spread the cost over several frames
+        bool isParallel = hasParallelShaderCompile();
+        size_t maxNumPending = isParallel ? MAX_NUM_PENDING_PROGRAMS : 1;
+
+        for (auto it = _pendingPrograms.begin(); it != _pendingPrograms.end();) {
+            auto next = std::next(it);
+            if (finishCompilation(*it, !isParallel)) {
+                if (it->programObject != nullptr) {
+                    // Insert behind the most recently used program so that the current
+                    // program stays at the front
+                    auto position = _cachedPrograms.empty() ?
+                        _cachedPrograms.end() : std::next(_cachedPrograms.begin());
+                    _cachedPrograms.splice(position, _pendingPrograms, it);
+                    evictCachedPrograms();
+                }
+                else {
+                    _pendingPrograms.erase(it);
+                }
+            }
+            it = next;
+        }
+
+        while (!_precompilationQueue.empty() &&
+            _pendingPrograms.size() < maxNumPending)
+        {
+            LayeredTexturePreprocessingData preprocessingData =
+                std::move(_precompilationQueue.front());
+            _precompilationQueue.pop_front();
+
+            size_t hash = preprocessingData.hash();
+            if (findProgram(_cachedPrograms, preprocessingData, hash) !=
+                _cachedPrograms.end())
+            {
+                // Compiled on demand since it was queued
+                continue;
+            }
+
+            CachedProgram program = startCompilation(preprocessingData, hash);
+            if (program.isPending) {
+                _pendingPrograms.push_back(std::move(program));
+                if (!isParallel) {
+                    break;
+                }
+            }
+            else {
+                // Loaded from the program binary cache
+                auto position = _cachedPrograms.empty() ?
+                    _cachedPrograms.end() : std::next(_cachedPrograms.begin());
+                _cachedPrograms.insert(position, std::move(program));
+                evictCachedPrograms();
+            }
+        }
+    }
+
+    std::list<LayeredTextureShaderProvider::CachedProgram>::iterator
+        LayeredTextureShaderProvider::findProgram(
+            std::list<CachedProgram>& programs,
+            const LayeredTexturePreprocessingData& preprocessingData, size_t hash)
+    {
+        return std::find_if(
+            programs.begin(),
+            programs.end(),
+            [&preprocessingData, hash](const CachedProgram& cachedProgram) {
+                return cachedProgram.hash == hash &&
+                    cachedProgram.preprocessingData == preprocessingData;
+            });
+    }
+
+    void LayeredTextureShaderProvider::evictCachedPrograms() {
+        while (_cachedPrograms.size() > MAX_NUM_CACHED_PROGRAMS) {
+            OsEng.renderEngine().removeRenderProgram(
+                _cachedPrograms.back().programObject);
+            _cachedPrograms.pop_back();
+        }
+    }
+
+    LayeredTextureShaderProvider::CachedProgram
+        LayeredTextureShaderProvider::startCompilation(
+            const LayeredTexturePreprocessingData& preprocessingData, size_t hash)
+    {
         ghoul::Dictionary shaderDictionary;
-        
 
         // Different texture types can be height maps or color texture for example.
         // These are used differently within the shaders.
-        auto textureTypes = _preprocessingData.layeredTextureInfo;
+        auto textureTypes = preprocessingData.layeredTextureInfo;
         for (size_t i = 0; i < textureTypes.size(); i++) {
             // lastLayerIndex must be at least 0 for the shader to compile,
             // the layer type is inactivated by setting use to false
@@ -135,23 +419,93 @@ namespace openspace {
         }
 
         // Other settings such as "useAtmosphere"
-        auto keyValuePairs = _preprocessingData.keyValuePairs;
+        auto keyValuePairs = preprocessingData.keyValuePairs;
         for (size_t i = 0; i < keyValuePairs.size(); i++) {
             shaderDictionary.setValue(keyValuePairs[i].first, keyValuePairs[i].second);
         }
 
-        // Remove old program
-        OsEng.renderEngine().removeRenderProgram(_programObject);
+        auto compileStart = std::chrono::high_resolution_clock::now();
+        CachedProgram program = {
+            hash,
+            preprocessingData,
+            OsEng.renderEngine().createRenderProgram(
+                _shaderName,
+                _vsPath,
+                _fsPath,
+                shaderDictionary),
+            false,
+            "",
+            compileStart
+        };
+        using IgnoreError = ProgramObject::IgnoreError;
+        program.programObject->setIgnoreSubroutineUniformLocationError(IgnoreError::Yes);
+
+        GLuint programId = static_cast<GLuint>(*program.programObject);
+        std::vector<GLuint> shaders = attachedShaders(programId);
 
-        _programObject = OsEng.renderEngine().buildRenderProgram(
-            _shaderName,
-            _vsPath,
-            _fsPath,
-            shaderDictionary);
+        if (FileSys.cacheManager()) {
+            program.binaryFile = FileSys.cacheManager()->cachedFilename(
+                _shaderName,
+                programBinaryKey(shaders),
+                ghoul::filesystem::CacheManager::Persistent::Yes);
+            if (loadProgramBinary(programId, program.binaryFile)) {
+                LDEBUG("Loaded '" << _shaderName << "' from " << program.binaryFile);
+                return program;
+            }
+        }
 
-        ghoul_assert(_programObject != nullptr, "Failed to initialize programObject!");
-        using IgnoreError = ProgramObject::IgnoreError;
-        _programObject->setIgnoreSubroutineUniformLocationError(IgnoreError::Yes);
+        // The compile and link status are not queried here, as that would wait for
+        // the driver to finish
+        for (GLuint shader : shaders) {
+            glCompileShader(shader);
+        }
+        glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(programId);
+        program.isPending = true;
+        return program;
+    }
+
+    bool LayeredTextureShaderProvider::finishCompilation(CachedProgram& program,
+        bool wait)
+    {
+        if (!program.isPending) {
+            return true;
+        }
+        GLuint programId = static_cast<GLuint>(*program.programObject);
+        if (!wait && hasParallelShaderCompile()) {
+            GLint isCompleted = GL_FALSE;
+            glGetProgramiv(programId, GL_COMPLETION_STATUS_ARB, &isCompleted);
+            if (isCompleted == GL_FALSE) {
+                return false;
+            }
+        }
+        program.isPending = false;
+
+        GLint isLinked = GL_FALSE;
+        glGetProgramiv(programId, GL_LINK_STATUS, &isLinked);
+        if (isLinked == GL_FALSE) {
+            for (GLuint shader : attachedShaders(programId)) {
+                std::string log = shaderInfoLog(shader);
+                if (!log.empty()) {
+                    LERROR("Compiling '" << _shaderName << "' failed: " << log);
+                }
+            }
+            LERROR("Linking '" << _shaderName << "' failed: " <<
+                programInfoLog(programId));
+            OsEng.renderEngine().removeRenderProgram(program.programObject);
+            program.programObject = nullptr;
+            return true;
+        }
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - program.compileStart).count();
+        LINFO("Compiled and linked '" << _shaderName << "' in " << ms << " ms (" <<
+            _cachedPrograms.size() << " cached permutations)");
+
+        if (!program.binaryFile.empty()) {
+            saveProgramBinary(programId, program.binaryFile);
+        }
+        return true;
     }
 
     bool LayeredTextureShaderProvider::updatedOnLastCall() {
@@ -165,8 +519,10 @@ namespace openspace {
         "textureSampler",
         "depthTransform.depthScale",
         "depthTransform.depthOffset",
-        "uvTransform.uvOffset",
-        "uvTransform.uvScale"
+        "drawDataIndex",
+        "drawData.uvOffset",
+        "drawData.uvScale",
+        "drawData.textureLayer"
     };
 
     const std::string LayeredTextureShaderUniformIdHandler::blendLayerSuffixes[
@@ -31,6 +31,9 @@
 
 #include <vector>
 #include <array>
+#include <chrono>
+#include <deque>
+#include <list>
 #include <string>
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -78,10 +81,29 @@ namespace openspace {
             layeredTextureInfo;
         std::vector<std::pair<std::string, std::string> > keyValuePairs;
         bool operator==(const LayeredTexturePreprocessingData& other) const;
+
+        /**
+        * Returns a hash of all the preprocessing settings. Data that compares equal
+        * has the same hash.
+        */
+        size_t hash() const;
     };
 
     /**
     * This class has ownership of an updated shader program for rendering tiles.
+    *
+    * Compiled shader programs are kept in a cache keyed by the hash of their
+    * <code>LayeredTexturePreprocessingData</code>, so switching back to a permutation
+    * that has been used before, for example when toggling a layer on and off, does not
+    * recompile it. Permutations that are likely to be needed can be compiled ahead of
+    * time using <code>queuePrecompilation</code>. If the driver supports
+    * <code>GL_ARB_parallel_shader_compile</code>, they are compiled on the driver's own
+    * threads without blocking the render thread.
+    *
+    * The binaries of linked programs are also stored in the persistent cache, keyed by
+    * a hash of the preprocessed shader sources and the OpenGL driver. A program with a
+    * stored binary is loaded with <code>glProgramBinary</code> instead of being
+    * compiled, also in later runs.
     */
     class LayeredTextureShaderProvider
     {
@@ -97,17 +119,87 @@ namespace openspace {
         * \param <code>preprocessingData</code> determines wherer or not the shader
         * program needs to be re-compiled. If <code>preprocessingData</code> is different
         * from the last time this function was called the shader program will be
-        * recompiled before returned.
+        * recompiled before returned. If the program is being precompiled, this function
+        * waits for that compilation to finish.
         */
         ProgramObject* getUpdatedShaderProgram(
             LayeredTexturePreprocessingData preprocessingData);
 
+        /**
+        * Returns true if the last call to <code>getUpdatedShaderProgram</code> returned
+        * a different shader program than the call before it.
+        */
         bool updatedOnLastCall();
+
+        /**
+        * Queues the shader program for <code>preprocessingData</code> to be compiled by
+        * <code>updatePrecompilation</code>. Programs that are already cached, being
+        * compiled or queued are ignored.
+        */
+        void queuePrecompilation(LayeredTexturePreprocessingData preprocessingData);
+
+        /**
+        * Removes all shader programs from the precompilation queue. Programs that are
+        * already being compiled are finished.
+        */
+        void clearPrecompilationQueue();
+
+        /**
+        * Starts compiling queued shader programs and caches the ones that have finished
+        * linking. With <code>GL_ARB_parallel_shader_compile</code> up to
+        * <code>MAX_NUM_PENDING_PROGRAMS</code> programs are compiled at the same time and
+        * this function never waits for the driver. Without it, one program is compiled
+        * per call. The program returned by <code>getUpdatedShaderProgram</code> is not
+        * changed.
+        */
+        void updatePrecompilation();
+
     private:
         friend class LayeredTextureShaderUniformIdHandler;
-        void recompileShaderProgram(LayeredTexturePreprocessingData preprocessingData);
 
-        std::unique_ptr<ProgramObject> _programObject;
+        struct CachedProgram {
+            size_t hash;
+            LayeredTexturePreprocessingData preprocessingData;
+            std::unique_ptr<ProgramObject> programObject;
+
+            /// True while the program is compiled and linked by the driver
+            bool isPending;
+            /// The file to store the program binary in once it is linked, or empty
+            std::string binaryFile;
+            std::chrono::high_resolution_clock::time_point compileStart;
+        };
+
+        static const size_t MAX_NUM_CACHED_PROGRAMS = 16;
+        static const size_t MAX_NUM_PENDING_PROGRAMS = 4;
+
+        /**
+        * Creates the program for <code>preprocessingData</code> and loads its binary
+        * from the cache if there is one. Otherwise compilation and linking is started
+        * and the returned program is pending.
+        */
+        CachedProgram startCompilation(
+            const LayeredTexturePreprocessingData& preprocessingData, size_t hash);
+
+        /**
+        * Checks whether the pending <code>program</code> has finished linking, or waits
+        * for it if <code>wait</code> is true. A linked program is stored in the program
+        * binary cache. If linking failed, the program object is removed.
+        * \returns false if the program is still pending
+        */
+        bool finishCompilation(CachedProgram& program, bool wait);
+
+        std::list<CachedProgram>::iterator findProgram(
+            std::list<CachedProgram>& programs,
+            const LayeredTexturePreprocessingData& preprocessingData, size_t hash);
+        void evictCachedPrograms();
+
+        /// Most recently used first. The current program is always the first element
+        std::list<CachedProgram> _cachedPrograms;
+        /// Programs that the driver is compiling and linking, oldest first
+        std::list<CachedProgram> _pendingPrograms;
+        std::deque<LayeredTexturePreprocessingData> _precompilationQueue;
+
+        ProgramObject* _programObject;
         LayeredTexturePreprocessingData _preprocessingData;
 
         const std::string _shaderName;
@@ -123,25 +215,30 @@ namespace openspace {
     class LayeredTextureShaderUniformIdHandler
     {
     public:
-        static const size_t NUM_TILE_DATA_VARIABLES = 5;
+        static const size_t NUM_TILE_DATA_VARIABLES = 7;
         static const size_t NUM_BLEND_TEXTURES = 3;
 
         /**
         * Each texture can have these uniform variables associated with it in the shader
         * code.
         *
-        * <code>textureSampler</code> is the actual texture that can be sampled in the
-        * shader program. The associated GLSL type is <code>sampler2D</code>.
+        * <code>textureSampler</code> is the array texture that stores the tile, the
+        * layer of the tile is read from its draw data. The associated GLSL type is
+        * <code>sampler2DArray</code>, or <code>sampler2D</code> if
+        * <code>TileTexturePool</code> does not use array textures.
         * <code>depthTransform_depthScale</code> specifies the scale part of the depth
         * transform. Useful for height maps. The associated GLSL type is
         * <code>float</code>.
         * <code>depthTransform_depthOffset</code> specifies the offset part of the depth
         * transform. Useful for height maps. The associated GLSL type is
         * <code>float</code>.
-        * <code>uvTransform_uvOffset</code> specifies an offset that can be used when
-        * sampling from the texture. The associated GLSL type is <code>vec2</code>.
-        * <code>uvTransform_uvScale</code> specifies a scale that can be used when
-        * sampling from the texture. The associated GLSL type is <code>vec2</code>.
+        * <code>drawDataIndex</code> specifies the index of the texture's draw data
+        * among the per-chunk draw data in the tile draw data shader storage buffer. The
+        * associated GLSL type is <code>int</code>.
+        * <code>drawData_uvOffset</code>, <code>drawData_uvScale</code> and
+        * <code>drawData_textureLayer</code> are the same draw data, set for every chunk
+        * when there are no shader storage buffers. The associated GLSL types are
+        * <code>vec2</code>, <code>vec2</code> and <code>float</code>.
         *
         * The corresponding struct in GLSL code for storing these data is a
         * <code>Tile</code>. The names of the uniforms are the ones specified in 
@@ -151,8 +248,10 @@ namespace openspace {
             textureSampler,
             depthTransform_depthScale,
             depthTransform_depthOffset,
-            uvTransform_uvOffset,
-            uvTransform_uvScale,
+            drawDataIndex,
+            drawData_uvOffset,
+            drawData_uvScale,
+            drawData_textureLayer,
         };
 
         /**
@@ -0,0 +1,58 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/simulatedtransfertiledataset.h>
+
+#include <chrono>
+#include <thread>
+
+namespace openspace {
+
+    SimulatedTransferTileDataset::SimulatedTransferTileDataset(
+        const std::string& gdalDatasetDesc, const Configuration& config, double latency,
+        double bandwidth)
+        : TileDataset(gdalDatasetDesc, config)
+        , _latency(latency)
+        , _bandwidth(bandwidth)
+    { }
+
+    char* SimulatedTransferTileDataset::readImageData(IODescription& io,
+        CPLErr& worstError) const
+    {
+        char* imageData = TileDataset::readImageData(io, worstError);
+
+        double seconds = _latency;
+        if (_bandwidth > 0.0) {
+            // The dataset, and with it the data layout, is only initialized by the
+            // first read, so the pixel size is taken from the write description
+            size_t bytesPerPixel = io.write.bytesPerLine / io.write.region.numPixels.x;
+            seconds += io.read.region.area() * bytesPerPixel / _bandwidth;
+        }
+        if (seconds > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        }
+        return imageData;
+    }
+
+} // namespace openspace
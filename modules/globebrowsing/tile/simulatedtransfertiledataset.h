@@ -0,0 +1,58 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __SIMULATED_TRANSFER_TILE_DATASET_H__
+#define __SIMULATED_TRANSFER_TILE_DATASET_H__
+
+#include <modules/globebrowsing/tile/tiledataset.h>
+
+namespace openspace {
+
+    /**
+    * A <code>TileDataset</code> that delays every read of the dataset as if the data
+    * was transferred over a network with the given latency and bandwidth. Together
+    * with a local dataset, such as a <code>SyntheticPyramid</code>, this makes it
+    * possible to measure the tile pipeline without a remote server.
+    */
+    class SimulatedTransferTileDataset : public TileDataset {
+    public:
+        /**
+        * \param latency   - Time in seconds that every read is delayed by
+        * \param bandwidth - Number of bytes per second that reads are limited to, zero
+        *                    disables the limit
+        */
+        SimulatedTransferTileDataset(const std::string& gdalDatasetDesc,
+            const Configuration& config, double latency, double bandwidth);
+
+    protected:
+        char* readImageData(IODescription& io, CPLErr& worstError) const override;
+
+    private:
+        const double _latency;
+        const double _bandwidth;
+    };
+
+} // namespace openspace
+
+#endif // __SIMULATED_TRANSFER_TILE_DATASET_H__
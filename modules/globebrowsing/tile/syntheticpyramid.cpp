@@ -0,0 +1,105 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/syntheticpyramid.h>
+
+#include <ghoul/logging/logmanager.h>
+
+#include <gdal_priv.h>
+#include <ogr_spatialref.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const std::string _loggerCat = "SyntheticPyramid";
+}
+
+namespace openspace {
+
+    void SyntheticPyramid::create(const std::string& path,
+        const Description& description)
+    {
+        GDALAllRegister();
+        GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+        if (driver == nullptr) {
+            throw std::runtime_error("GDAL driver 'GTiff' is not available");
+        }
+
+        const int width = description.size.x;
+        const int height = description.size.y;
+        char** options = CSLSetNameValue(nullptr, "TILED", "YES");
+        GDALDataset* dataset = driver->Create(
+            path.c_str(), width, height, description.numBands, GDT_Byte, options);
+        CSLDestroy(options);
+        if (dataset == nullptr) {
+            throw std::runtime_error("Could not create '" + path + "'");
+        }
+
+        double geoTransform[6] = {
+            -180.0, 360.0 / width, 0.0, 90.0, 0.0, -180.0 / height
+        };
+        dataset->SetGeoTransform(geoTransform);
+        OGRSpatialReference spatialReference;
+        spatialReference.SetWellKnownGeogCS("WGS84");
+        char* wkt = nullptr;
+        spatialReference.exportToWkt(&wkt);
+        dataset->SetProjection(wkt);
+        CPLFree(wkt);
+
+        CPLErr worstError = CE_None;
+        std::vector<GByte> line(width);
+        for (int band = 1; band <= description.numBands; ++band) {
+            GDALRasterBand* rasterBand = dataset->GetRasterBand(band);
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    line[x] = static_cast<GByte>((x * band + y * 7) % 251);
+                }
+                CPLErr err = rasterBand->RasterIO(GF_Write, 0, y, width, 1,
+                    line.data(), width, 1, GDT_Byte, 0, 0);
+                worstError = std::max(worstError, err);
+            }
+        }
+
+        std::vector<int> overviews(description.numOverviews);
+        for (int i = 0; i < description.numOverviews; ++i) {
+            overviews[i] = 2 << i;
+        }
+        if (!overviews.empty()) {
+            CPLErr err = dataset->BuildOverviews("NEAREST",
+                static_cast<int>(overviews.size()), overviews.data(), 0, nullptr,
+                nullptr, nullptr);
+            worstError = std::max(worstError, err);
+        }
+        GDALClose(dataset);
+
+        if (worstError >= CE_Failure) {
+            throw std::runtime_error("Could not write '" + path + "'");
+        }
+        LDEBUG("Created synthetic pyramid '" << path << "' with " << width << "x" <<
+            height << " pixels and " << description.numOverviews << " overviews");
+    }
+
+} // namespace openspace
@@ -0,0 +1,63 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __SYNTHETIC_PYRAMID_H__
+#define __SYNTHETIC_PYRAMID_H__
+
+#include <glm/glm.hpp>
+
+#include <string>
+
+namespace openspace {
+
+    /**
+    * Writes a global image pyramid to disk that can be read by a
+    * <code>TileDataset</code> instead of a remote dataset. Read through a
+    * <code>SimulatedTransferTileDataset</code> this makes it possible to measure the
+    * tile pipeline without a network.
+    */
+    class SyntheticPyramid {
+    public:
+        struct Description {
+            /// Number of pixels of the full resolution image
+            glm::ivec2 size = glm::ivec2(4096, 2048);
+            int numBands = 3;
+
+            /// Number of overviews, each half the resolution of the previous one
+            int numOverviews = 4;
+        };
+
+        /**
+        * Creates a tiled GeoTIFF with the given description at <code>path</code>
+        * covering the whole globe in geographic coordinates. The pixel values are a
+        * deterministic pattern, so reads of the same tile always return the same
+        * data. Throws a <code>std::runtime_error</code> if the file can not be
+        * written.
+        */
+        static void create(const std::string& path, const Description& description);
+    };
+
+} // namespace openspace
+
+#endif // __SYNTHETIC_PYRAMID_H__
@@ -26,6 +26,8 @@
 
 #include <ghoul/logging/logmanager.h>
 
+#include <cstring>
+
 namespace {
     const std::string _loggerCat = "Tile";
 }
@@ -37,12 +39,9 @@ namespace openspace {
     
 
     Tile Tile::createPlainTile(const glm::uvec2& size, const glm::uvec4& color) {
-        using namespace ghoul::opengl;
-        
         // Create pixel data
-        int numBytes = size.x * size.y * 4 * 1;
-        char* pixels = new char[numBytes];
         size_t numPixels = size.x * size.y;
+        std::unique_ptr<char[]> pixels(new char[numPixels * 4]);
         size_t i = 0;
         for (size_t p = 0; p < numPixels; p++){
             pixels[i++] = color.r;
@@ -51,18 +50,43 @@ namespace openspace {
             pixels[i++] = color.a;
         }
 
-        // Create ghoul texture
-        auto texture = std::make_shared<Texture>(glm::uvec3(size, 1));
-        texture->setDataOwnership(Texture::TakeOwnership::Yes);
-        texture->setPixelData(pixels);
-        texture->uploadTexture();
-        texture->setFilter(ghoul::opengl::Texture::FilterMode::Linear);
+        // Upload to a slot of the pool for plain RGBA tiles
+        TileTextureFormat format = { GL_UNSIGNED_BYTE, GL_RGBA8, GL_RGBA, size, false };
+        std::shared_ptr<TileTextureSlot> textureSlot =
+            TileTexturePool::forFormat(format).allocate();
+        textureSlot->uploadLevel(0, pixels.get());
+        textureSlot->setPixelData(std::move(pixels));
 
         // Create tile
         Tile tile;
         tile.status = Tile::Status::OK;
         tile.preprocessData = nullptr;
-        tile.texture = texture;
+        tile.textureSlot = textureSlot;
+
+        return tile;
+    }
+
+    Tile Tile::createFromTexture(const Texture& texture) {
+        size_t numBytes = texture.expectedPixelDataSize();
+        std::unique_ptr<char[]> pixels(new char[numBytes]);
+        memcpy(pixels.get(), texture.pixelData(), numBytes);
+
+        TileTextureFormat format = {
+            static_cast<GLenum>(texture.dataType()),
+            static_cast<GLenum>(texture.internalFormat()),
+            static_cast<GLenum>(texture.format()),
+            glm::uvec2(texture.dimensions()),
+            false
+        };
+        std::shared_ptr<TileTextureSlot> textureSlot =
+            TileTexturePool::forFormat(format).allocate();
+        textureSlot->uploadLevel(0, pixels.get());
+        textureSlot->setPixelData(std::move(pixels));
+
+        Tile tile;
+        tile.status = Tile::Status::OK;
+        tile.preprocessData = nullptr;
+        tile.textureSlot = textureSlot;
 
         return tile;
     }
@@ -28,6 +28,7 @@
 #include <ghoul/opengl/texture.h> // Texture
 
 #include <modules/globebrowsing/tile/asynctilereader.h> // TilePreprocessData
+#include <modules/globebrowsing/tile/tiletexturepool.h> // TileTextureSlot
 
 
 namespace openspace {
@@ -35,10 +36,10 @@ namespace openspace {
     using namespace ghoul::opengl;
 
     /**
-    * Defines a status and may have a Texture and PreprocessData
+    * Defines a status and may have a texture slot and PreprocessData
     */
     struct Tile {
-        std::shared_ptr<Texture> texture;
+        std::shared_ptr<TileTextureSlot> textureSlot;
         std::shared_ptr<TilePreprocessData> preprocessData;
 
 
@@ -49,7 +50,7 @@ namespace openspace {
         enum class Status { 
             /** 
             * E.g when texture data is not currently in memory. 
-            * texture and preprocessData are both null
+            * textureSlot and preprocessData are both null
             */
             Unavailable, 
 
@@ -57,19 +58,19 @@ namespace openspace {
             * Can be set by <code>TileProvider</code>s if the requested 
             * <code>ChunkIndex</code> is undefined for that particular 
             * provider. 
-            * texture and preprocessData are both null
+            * textureSlot and preprocessData are both null
             */
             OutOfRange, 
 
             /**
             * An IO Error happend
-            * texture and preprocessData are both null
+            * textureSlot and preprocessData are both null
             */
             IOError, 
 
             /**
-            * The Texture is uploaded to the GPU and good for usage.
-            * texture is defined. preprocessData may be defined.
+            * The texture is uploaded to the GPU and good for usage.
+            * textureSlot is defined. preprocessData may be defined.
             */
             OK 
         } status;
@@ -86,6 +87,17 @@ namespace openspace {
          */
         static Tile createPlainTile(const glm::uvec2& size, const glm::uvec4& color);
 
+        /**
+        * Instantiates a new tile with a copy of a texture's CPU-side pixel data,
+        * uploaded to a texture slot without mip maps.
+        *
+        * \param texture a texture with pixel data
+        *
+        * \returns a Tile with status OK and a texture slot with the size, format and
+        * pixels of the texture
+        */
+        static Tile createFromTexture(const Texture& texture);
+
         /**
         * A tile with status unavailable that any user can return to 
         * indicate that a tile was unavailable.
@@ -32,6 +32,7 @@
 #include <modules/globebrowsing/tile/tiledataset.h>
 #include <modules/globebrowsing/tile/tileprovider/tileprovider.h>
 #include <modules/globebrowsing/tile/tileioresult.h>
+#include <modules/globebrowsing/tile/tilereadplanner.h>
 
 #include <modules/globebrowsing/geometry/angle.h>
 
@@ -129,6 +130,11 @@ namespace openspace {
     TileDataset::TileDataset(const std::string& gdalDatasetDesc, const Configuration& config)
         : _config(config)
         , hasBeenInitialized(false)
+        , _prefetchedTiles(MAX_NUM_PREFETCHED_TILES)
+        , _numRasterIOCalls(0)
+        , _numBytesRead(0)
+        , _numPrefetchedTiles(0)
+        , _numPrefetchHits(0)
     {
         
         _initData = { "",  gdalDatasetDesc, config.minimumTilePixelSize, config.dataType };
@@ -137,6 +143,10 @@ namespace openspace {
     }
 
     void TileDataset::reset() {
+        {
+            std::lock_guard<std::mutex> lock(_prefetchMutex);
+            _prefetchedTiles.clear();
+        }
         _cached._maxLevel = -1;
         if (_dataset != nullptr) {
             GDALClose((GDALDatasetH)_dataset);
@@ -224,7 +234,9 @@ namespace openspace {
 
         // Build the Tile IO Result from the data we queride
         std::shared_ptr<TileIOResult> result = std::make_shared<TileIOResult>();
-        result->imageData = readImageData(io, worstError);
+        result->imageData = _config.prefetchSiblings ?
+            readImageDataWithSiblings(chunkIndex, io, worstError) :
+            readImageData(io, worstError);
         result->error = worstError;
         result->chunkIndex = chunkIndex;
         result->dimensions = glm::uvec3(io.write.region.numPixels, 1);
@@ -282,6 +294,15 @@ namespace openspace {
         return _dataLayout;
     }
 
+    TileDataset::ReadStatistics TileDataset::readStatistics() const {
+        return {
+            _numRasterIOCalls,
+            _numBytesRead,
+            _numPrefetchedTiles,
+            _numPrefetchHits
+        };
+    }
+
 
 
 
@@ -488,25 +509,126 @@ namespace openspace {
         // allocate memory for the image
         char* imageData = new char[io.write.totalNumBytes];
 
-        // Read the data (each rasterband is a separate channel)
-        for (size_t i = 0; i < _dataLayout.numRasters; i++) {
-            GDALRasterBand* rasterBand = gdalRasterBand(io.read.overview, i + 1);
+        // Read the data (each rasterband is a separate, interleaved channel)
+        CPLErr err = repeatedRasterIO(io, imageData);
 
-            // The final destination pointer is offsetted by one datum byte size
-            // for every raster (or data channel, i.e. R in RGB)
-            char* dataDestination = imageData + (i * _dataLayout.bytesPerDatum);
+        // CE_None = 0, CE_Debug = 1, CE_Warning = 2, CE_Failure = 3, CE_Fatal = 4
+        worstError = std::max(worstError, err);
 
-            CPLErr err = repeatedRasterIO(rasterBand, io, dataDestination);
+        return imageData;
+    }
 
-            // CE_None = 0, CE_Debug = 1, CE_Warning = 2, CE_Failure = 3, CE_Fatal = 4
-            worstError = std::max(worstError, err);
+    TileDataset::PrefetchedTile::~PrefetchedTile() {
+        delete[] imageData;
+    }
+
+    bool TileDataset::canBeReadTogether(const IODescription& io) const {
+        // Combined reads are sliced without resampling and without wrapping around
+        // the edges of the dataset
+        PixelRegion gdalRegion = gdalPixelRegion(gdalRasterBand(io.read.overview));
+        return io.read.region.numPixels == io.write.region.numPixels &&
+            io.read.region.isInside(gdalRegion);
+    }
+
+    char* TileDataset::readImageDataWithSiblings(const ChunkIndex& chunkIndex,
+        IODescription& io, CPLErr& worstError)
+    {
+        ChunkHashKey key = chunkIndex.hashKey();
+        {
+            std::lock_guard<std::mutex> lock(_prefetchMutex);
+            if (_prefetchedTiles.exist(key)) {
+                std::shared_ptr<PrefetchedTile> prefetchedTile =
+                    _prefetchedTiles.get(key);
+                _prefetchedTiles.remove(key);
+                _numPrefetchHits++;
+                worstError = std::max(worstError, prefetchedTile->error);
+                char* imageData = prefetchedTile->imageData;
+                prefetchedTile->imageData = nullptr;
+                return imageData;
+            }
+        }
+
+        if (chunkIndex.level < 1 || !canBeReadTogether(io)) {
+            return readImageData(io, worstError);
+        }
+
+        // The four children of a chunk are created at the same time and their tiles are
+        // requested together, so read the siblings that are not yet available as well
+        std::vector<ChunkIndex> chunkIndices = { chunkIndex };
+        std::vector<IODescription> ios = { io };
+        std::vector<TileReadPlanner::Request> requests = {
+            { io.read.overview, io.read.region }
+        };
+        ChunkIndex parent = chunkIndex.parent();
+        for (int q = 0; q < 4; ++q) {
+            ChunkIndex sibling = parent.child(Quad(q));
+            if (sibling == chunkIndex) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_prefetchMutex);
+                if (_prefetchedTiles.exist(sibling.hashKey())) {
+                    continue;
+                }
+            }
+            IODescription siblingIo = getIODescription(sibling);
+            if (canBeReadTogether(siblingIo)) {
+                chunkIndices.push_back(sibling);
+                ios.push_back(siblingIo);
+                requests.push_back({ siblingIo.read.overview, siblingIo.read.region });
+            }
+        }
+
+        PixelRegion gdalRegion = gdalPixelRegion(gdalRasterBand(io.read.overview));
+        // The first read always contains the first request
+        TileReadPlanner::Read read = TileReadPlanner::plan(requests, gdalRegion)[0];
+        if (read.requests.size() == 1) {
+            return readImageData(io, worstError);
         }
 
-        // GDAL reads pixel lines top to bottom, we want the opposit
+        IODescription combinedIo;
+        combinedIo.read.overview = read.overview;
+        combinedIo.read.region = read.region;
+        combinedIo.write.region =
+            PixelRegion(PixelCoordinate(0, 0), read.region.numPixels);
+        combinedIo.write.bytesPerLine =
+            _dataLayout.bytesPerPixel * combinedIo.write.region.numPixels.x;
+        combinedIo.write.totalNumBytes =
+            combinedIo.write.bytesPerLine * combinedIo.write.region.numPixels.y;
+
+        CPLErr combinedError = CPLErr::CE_None;
+        std::unique_ptr<char[]> combinedImageData(
+            readImageData(combinedIo, combinedError));
+
+        char* imageData = nullptr;
+        for (size_t request : read.requests) {
+            char* tileImageData = new char[ios[request].write.totalNumBytes];
+            TileReadPlanner::copySubregion(
+                combinedImageData.get(),
+                read.region,
+                tileImageData,
+                ios[request].read.region,
+                _dataLayout.bytesPerPixel);
+
+            if (request == 0) {
+                imageData = tileImageData;
+            }
+            else {
+                auto prefetchedTile = std::make_shared<PrefetchedTile>();
+                prefetchedTile->imageData = tileImageData;
+                prefetchedTile->error = combinedError;
+
+                std::lock_guard<std::mutex> lock(_prefetchMutex);
+                _prefetchedTiles.put(chunkIndices[request].hashKey(), prefetchedTile);
+                _numPrefetchedTiles++;
+            }
+        }
+
+        worstError = std::max(worstError, combinedError);
         return imageData;
     }
 
-    CPLErr TileDataset::repeatedRasterIO(GDALRasterBand* rasterBand, const IODescription& fullIO, char* dataDestination, int depth) const {
+    CPLErr TileDataset::repeatedRasterIO(const IODescription& fullIO, char* dataDestination, int depth) const {
         std::string spaces = "                      ";
         std::string indentation = spaces.substr(0, 2 * depth);
 
@@ -519,7 +641,7 @@ namespace openspace {
 
         // Make a copy of the full IO desription as we will have to modify it
         IODescription io = fullIO;
-        PixelRegion gdalRegion = gdalPixelRegion(rasterBand);
+        PixelRegion gdalRegion = gdalPixelRegion(gdalRasterBand(io.read.overview));
 
 
         // Example: 
@@ -604,7 +726,7 @@ namespace openspace {
                     // The cutoff region has been repeated along one of its sides, but 
                     // as we can see in this example, it still has a top part outside the
                     // defined gdal region. This is handled through recursion.
-                    CPLErr err = repeatedRasterIO(rasterBand, cutoff, dataDestination, depth + 1);
+                    CPLErr err = repeatedRasterIO(cutoff, dataDestination, depth + 1);
 
                     worstError = std::max(worstError, err);
                 }
@@ -620,7 +742,7 @@ namespace openspace {
             LDEBUG(indentation << "Error reading padding: " << worstError);
         }
         
-        CPLErr err = rasterIO(rasterBand, io, dataDestination);
+        CPLErr err = rasterIO(io, dataDestination);
         worstError = std::max(worstError, err);
 
         // The return error from a repeated rasterIO is ONLY based on the main region,
@@ -631,8 +753,23 @@ namespace openspace {
         return err;
     }
 
-    CPLErr TileDataset::rasterIO(GDALRasterBand* rasterBand, const IODescription& io, char* dataDestination) const {
-        PixelRegion gdalRegion = gdalPixelRegion(rasterBand);
+    GDALDataset* TileDataset::gdalInterleavedDataset(int overview) const {
+        // Overview bands of formats such as GeoTIFF belong to a dataset of their own
+        // that holds the overviews of all bands. Other formats do not provide one, and
+        // their bands have to be read one at a time
+        GDALRasterBand* firstBand = gdalRasterBand(overview);
+        GDALDataset* dataset = firstBand->GetDataset();
+        if (dataset == nullptr ||
+            dataset->GetRasterCount() < static_cast<int>(_dataLayout.numRasters) ||
+            dataset->GetRasterBand(1) != firstBand)
+        {
+            return nullptr;
+        }
+        return dataset;
+    }
+
+    CPLErr TileDataset::rasterIO(const IODescription& io, char* dataDestination) const {
+        PixelRegion gdalRegion = gdalPixelRegion(gdalRasterBand(io.read.overview));
 
         ghoul_assert(io.read.region.isInside(gdalRegion), "write region of bounds!");
 
@@ -643,6 +780,8 @@ namespace openspace {
         ghoul_assert(largestIndex <= io.write.totalNumBytes, "Invalid write region");
 
 
+        _numBytesRead += io.read.region.area() * _dataLayout.bytesPerPixel;
+
         char * dataDest = dataDestination;
 
         // OBS! GDAL reads pixels top to bottom, but we want our pixels bottom to top.
@@ -655,19 +794,50 @@ namespace openspace {
         dataDest -= io.write.region.start.y * io.write.bytesPerLine; // note -= since flipped y axis
         dataDest += io.write.region.start.x * _dataLayout.bytesPerPixel;
 
-        
-        return rasterBand->RasterIO(
-            GF_Read,
-            io.read.region.start.x,             // Begin read x
-            io.read.region.start.y,             // Begin read y
-            io.read.region.numPixels.x,         // width to read x
-            io.read.region.numPixels.y,         // width to read y
-            dataDest,                           // Where to put data
-            io.write.region.numPixels.x,        // width to write x in destination
-            io.write.region.numPixels.y,        // width to write y in destination
-            _dataLayout.gdalType,                // Type
-            _dataLayout.bytesPerPixel,            // Pixel spacing
-            -io.write.bytesPerLine);             // Line spacing
+        GDALDataset* dataset = gdalInterleavedDataset(io.read.overview);
+        if (dataset != nullptr) {
+            // Read all bands with one call, each band is written one datum after the
+            // previous one within a pixel (i.e. RGBRGB...)
+            _numRasterIOCalls++;
+            return dataset->RasterIO(
+                GF_Read,
+                io.read.region.start.x,             // Begin read x
+                io.read.region.start.y,             // Begin read y
+                io.read.region.numPixels.x,         // width to read x
+                io.read.region.numPixels.y,         // width to read y
+                dataDest,                           // Where to put data
+                io.write.region.numPixels.x,        // width to write x in destination
+                io.write.region.numPixels.y,        // width to write y in destination
+                _dataLayout.gdalType,               // Type
+                _dataLayout.numRasters,             // Number of bands to read
+                nullptr,                            // Read the first bands in order
+                _dataLayout.bytesPerPixel,          // Pixel spacing
+                -io.write.bytesPerLine,             // Line spacing
+                _dataLayout.bytesPerDatum);         // Band spacing
+        }
+
+        CPLErr worstError = CPLErr::CE_None;
+        for (size_t i = 0; i < _dataLayout.numRasters; i++) {
+            GDALRasterBand* rasterBand = gdalRasterBand(io.read.overview, i + 1);
+
+            // The destination pointer is offsetted by one datum byte size for every
+            // raster (or data channel, i.e. R in RGB)
+            _numRasterIOCalls++;
+            CPLErr err = rasterBand->RasterIO(
+                GF_Read,
+                io.read.region.start.x,             // Begin read x
+                io.read.region.start.y,             // Begin read y
+                io.read.region.numPixels.x,         // width to read x
+                io.read.region.numPixels.y,         // width to read y
+                dataDest + i * _dataLayout.bytesPerDatum, // Where to put data
+                io.write.region.numPixels.x,        // width to write x in destination
+                io.write.region.numPixels.y,        // width to write y in destination
+                _dataLayout.gdalType,               // Type
+                _dataLayout.bytesPerPixel,          // Pixel spacing
+                -io.write.bytesPerLine);            // Line spacing
+            worstError = std::max(worstError, err);
+        }
+        return worstError;
     }
 
 
@@ -25,7 +25,9 @@
 #ifndef __TILE_DATASET_H__
 #define __TILE_DATASET_H__
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <queue>
 #include <iostream>
@@ -39,6 +41,7 @@
 #include <modules/globebrowsing/tile/tiledatatype.h>
 #include <modules/globebrowsing/tile/pixelregion.h>
 #include <modules/globebrowsing/geometry/geodetic2.h>
+#include <modules/globebrowsing/other/lrucache.h>
 
 
 namespace openspace {
@@ -87,6 +90,19 @@ namespace openspace {
             bool doPreProcessing;
             int minimumTilePixelSize;
             GLuint dataType = 0; // default = no datatype reinterpretation
+
+            /**
+            * Read the tiles of all four children of a chunk with one read when one of
+            * them is requested, and keep the siblings until they are requested
+            */
+            bool prefetchSiblings = false;
+        };
+
+        struct ReadStatistics {
+            size_t numRasterIOCalls;
+            size_t numBytesRead;
+            size_t numPrefetchedTiles;
+            size_t numPrefetchHits;
         };
 
         
@@ -100,7 +116,7 @@ namespace openspace {
         */
         TileDataset(const std::string& gdalDatasetDesc, const Configuration& config);
 
-        ~TileDataset();
+        virtual ~TileDataset();
 
 
         //////////////////////////////////////////////////////////////////////////////////
@@ -113,12 +129,27 @@ namespace openspace {
         const TileDataLayout& getDataLayout();
         void reset();
 
+        /**
+        * Returns the number of GDAL reads and bytes read since the dataset was created.
+        */
+        ReadStatistics readStatistics() const;
+
 
         const static glm::ivec2 tilePixelStartOffset;
         const static glm::ivec2 tilePixelSizeDifference;
         const static PixelRegion padding; // same as the two above
 
 
+    protected:
+
+        /**
+        * Reads the pixels described by <code>io</code> from the dataset into a newly
+        * allocated buffer that the caller takes ownership of. Every read of the
+        * dataset, including the reads of several tiles at once, goes through this
+        * method.
+        */
+        virtual char* readImageData(IODescription& io, CPLErr& worstError) const;
+
     private:
 
         //////////////////////////////////////////////////////////////////////////////////
@@ -153,9 +184,12 @@ namespace openspace {
         PixelCoordinate geodeticToPixel(const Geodetic2& geo) const;
         Geodetic2 pixelToGeodetic(const PixelCoordinate& p) const;
         IODescription getIODescription(const ChunkIndex& chunkIndex) const;
-        char* readImageData(IODescription& io, CPLErr& worstError) const;
-        CPLErr rasterIO(GDALRasterBand* rasterBand, const IODescription& io, char* dst) const;
-        CPLErr repeatedRasterIO(GDALRasterBand* rasterBand, const IODescription& io, char* dst, int depth = 0) const;
+        char* readImageDataWithSiblings(const ChunkIndex& chunkIndex, IODescription& io,
+            CPLErr& worstError);
+        bool canBeReadTogether(const IODescription& io) const;
+        GDALDataset* gdalInterleavedDataset(int overview) const;
+        CPLErr rasterIO(const IODescription& io, char* dst) const;
+        CPLErr repeatedRasterIO(const IODescription& io, char* dst, int depth = 0) const;
         std::shared_ptr<TilePreprocessData> preprocess(std::shared_ptr<TileIOResult> result, const PixelRegion& region) const;
         CPLErr postProcessErrorCheck(std::shared_ptr<const TileIOResult> ioResult, const IODescription& io) const;
 
@@ -185,6 +219,24 @@ namespace openspace {
         TileDepthTransform _depthTransform;
         TileDataLayout _dataLayout;
 
+        /**
+        * Image data that was read together with a sibling tile but has not been
+        * requested yet
+        */
+        struct PrefetchedTile {
+            ~PrefetchedTile();
+            char* imageData;
+            CPLErr error;
+        };
+        static const size_t MAX_NUM_PREFETCHED_TILES = 32;
+        LRUCache<ChunkHashKey, std::shared_ptr<PrefetchedTile>> _prefetchedTiles;
+        std::mutex _prefetchMutex;
+
+        mutable std::atomic<size_t> _numRasterIOCalls;
+        mutable std::atomic<size_t> _numBytesRead;
+        std::atomic<size_t> _numPrefetchedTiles;
+        std::atomic<size_t> _numPrefetchHits;
+
         static bool GdalHasBeenInitialized;
         bool hasBeenInitialized;
     };
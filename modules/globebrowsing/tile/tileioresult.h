@@ -38,6 +38,7 @@
 
 #include <memory>
 #include <iostream>
+#include <vector>
 
 
 
@@ -69,6 +70,9 @@ namespace openspace {
         CPLErr error;
         size_t nBytesImageData;
 
+        /// Mip map levels after the first one, if they were generated on the CPU
+        std::vector<std::vector<char>> mipMapLevels;
+
         void serializeMetaData(std::ostream& s);
         static TileIOResult deserializeMetaData(std::istream& s);
    
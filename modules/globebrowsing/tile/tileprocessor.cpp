@@ -0,0 +1,337 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/tileprocessor.h>
+#include <modules/globebrowsing/tile/tileioresult.h>
+#include <modules/globebrowsing/tile/tiledatatype.h>
+
+#include <ghoul/misc/assert.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENSPACE_TILEPROCESSOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const std::string _loggerCat = "TileProcessor";
+
+    // Rounds like two nested _mm_avg_epu8, so all paths filter bytes the same way
+    inline uint8_t average(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        int ac = (a + c + 1) >> 1;
+        int bd = (b + d + 1) >> 1;
+        return static_cast<uint8_t>((ac + bd + 1) >> 1);
+    }
+
+    template <typename T>
+    inline T average(T a, T b, T c, T d) {
+        return static_cast<T>((int64_t(a) + b + c + d + 2) >> 2);
+    }
+
+    inline float average(float a, float b, float c, float d) {
+        return (a + b + c + d) * 0.25f;
+    }
+
+    inline double average(double a, double b, double c, double d) {
+        return (a + b + c + d) * 0.25;
+    }
+
+    template <typename T>
+    void downsampleDatums(const char* src, const glm::uvec2& size, char* dst,
+        const glm::uvec2& dstSize, size_t numRasters, unsigned int startX)
+    {
+        const T* source = reinterpret_cast<const T*>(src);
+        T* destination = reinterpret_cast<T*>(dst);
+        for (unsigned int y = 0; y < dstSize.y; ++y) {
+            const T* row0 = source + size_t(2 * y) * size.x * numRasters;
+            const T* row1 = source +
+                size_t(std::min(2 * y + 1, size.y - 1)) * size.x * numRasters;
+            T* dstRow = destination + size_t(y) * dstSize.x * numRasters;
+            for (unsigned int x = startX; x < dstSize.x; ++x) {
+                size_t x0 = size_t(2 * x) * numRasters;
+                size_t x1 = size_t(std::min(2 * x + 1, size.x - 1)) * numRasters;
+                for (size_t c = 0; c < numRasters; ++c) {
+                    dstRow[x * numRasters + c] = average(
+                        row0[x0 + c], row0[x1 + c], row1[x0 + c], row1[x1 + c]);
+                }
+            }
+        }
+    }
+}
+
+namespace openspace {
+
+    TileProcessor::TileProcessor(const TileDataLayout& inputLayout,
+        const Configuration& config)
+        : _inputLayout(inputLayout)
+        , _outputLayout(inputLayout)
+        , _config(config)
+    {
+        GDALDataType gdalType = inputLayout.gdalType;
+        if (config.convertDoubleToFloat && gdalType == GDT_Float64) {
+            gdalType = GDT_Float32;
+        }
+        size_t numRasters = inputLayout.numRasters;
+        if (config.expandToFourChannels && numRasters == 3 &&
+            (gdalType == GDT_Byte || gdalType == GDT_Float32))
+        {
+            numRasters = 4;
+        }
+
+        if (gdalType != inputLayout.gdalType || numRasters != inputLayout.numRasters) {
+            _outputLayout.gdalType = gdalType;
+            _outputLayout.glType = TileDataType::getOpenGLDataType(gdalType);
+            _outputLayout.numRasters = numRasters;
+            _outputLayout.bytesPerDatum = TileDataType::numberOfBytes(gdalType);
+            _outputLayout.bytesPerPixel = _outputLayout.bytesPerDatum * numRasters;
+            _outputLayout.textureFormat =
+                TileDataType::getTextureFormat(static_cast<int>(numRasters), gdalType);
+        }
+    }
+
+    void TileProcessor::process(TileIOResult& result, TileStageTimes* stageTimes) const {
+        if (result.error != CE_None || result.imageData == nullptr) {
+            return;
+        }
+
+        using Clock = std::chrono::high_resolution_clock;
+        auto t0 = Clock::now();
+
+        glm::uvec2 size(result.dimensions.x, result.dimensions.y);
+        size_t numPixels = size_t(size.x) * size.y;
+        char* imageData = result.imageData;
+
+        if (_outputLayout.gdalType != _inputLayout.gdalType) {
+            char* converted = new char[numPixels * _inputLayout.numRasters *
+                _outputLayout.bytesPerDatum];
+            convertDoubleToFloat(
+                reinterpret_cast<const double*>(imageData),
+                reinterpret_cast<float*>(converted),
+                numPixels * _inputLayout.numRasters);
+            delete[] imageData;
+            imageData = converted;
+        }
+
+        if (_outputLayout.numRasters != _inputLayout.numRasters) {
+            char* expanded = new char[numPixels * _outputLayout.bytesPerPixel];
+            const float floatAlpha = 1.f;
+            const char byteAlpha = static_cast<char>(255);
+            const char* alpha = _outputLayout.gdalType == GDT_Byte ?
+                &byteAlpha : reinterpret_cast<const char*>(&floatAlpha);
+            expandToFourChannels(imageData, expanded, numPixels,
+                _outputLayout.bytesPerDatum, alpha);
+            delete[] imageData;
+            imageData = expanded;
+        }
+
+        result.imageData = imageData;
+        result.nBytesImageData = numPixels * _outputLayout.bytesPerPixel;
+
+        auto t1 = Clock::now();
+        if (stageTimes) {
+            stageTimes->add(TileStageTimes::Stage::Convert,
+                std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0));
+        }
+
+        if (_config.generateMipMaps) {
+            int numLevels = numMipMapLevels(size);
+            result.mipMapLevels.clear();
+            result.mipMapLevels.reserve(numLevels - 1);
+
+            const char* previousLevel = imageData;
+            glm::uvec2 previousSize = size;
+            for (int level = 1; level < numLevels; ++level) {
+                glm::uvec2 levelSize = mipMapSize(size, level);
+                result.mipMapLevels.emplace_back(
+                    size_t(levelSize.x) * levelSize.y * _outputLayout.bytesPerPixel);
+                downsample(previousLevel, previousSize,
+                    result.mipMapLevels.back().data(), _outputLayout);
+                previousLevel = result.mipMapLevels.back().data();
+                previousSize = levelSize;
+            }
+
+            auto t2 = Clock::now();
+            if (stageTimes) {
+                stageTimes->add(TileStageTimes::Stage::MipMap,
+                    std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1));
+            }
+        }
+    }
+
+    const TileDataLayout& TileProcessor::inputLayout() const {
+        return _inputLayout;
+    }
+
+    const TileDataLayout& TileProcessor::outputLayout() const {
+        return _outputLayout;
+    }
+
+    const TileProcessor::Configuration& TileProcessor::configuration() const {
+        return _config;
+    }
+
+    void TileProcessor::convertDoubleToFloat(const double* src, float* dst,
+        size_t numValues)
+    {
+        size_t i = 0;
+#ifdef OPENSPACE_TILEPROCESSOR_SSE2
+        for (; i + 4 <= numValues; i += 4) {
+            __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+            __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+            _mm_storeu_ps(dst + i, _mm_movelh_ps(low, high));
+        }
+#endif
+        for (; i < numValues; ++i) {
+            dst[i] = static_cast<float>(src[i]);
+        }
+    }
+
+    void TileProcessor::expandToFourChannels(const char* src, char* dst,
+        size_t numPixels, size_t bytesPerDatum, const char* alpha)
+    {
+        if (numPixels == 0) {
+            return;
+        }
+        const size_t srcBytesPerPixel = 3 * bytesPerDatum;
+        const size_t dstBytesPerPixel = 4 * bytesPerDatum;
+
+        // Copying four datums at a time reads the first datum of the next pixel into
+        // the alpha channel, which is then overwritten. The last pixel has no next one
+        for (size_t i = 0; i + 1 < numPixels; ++i) {
+            char* pixel = dst + i * dstBytesPerPixel;
+            std::memcpy(pixel, src + i * srcBytesPerPixel, dstBytesPerPixel);
+            std::memcpy(pixel + srcBytesPerPixel, alpha, bytesPerDatum);
+        }
+        char* last = dst + (numPixels - 1) * dstBytesPerPixel;
+        std::memcpy(last, src + (numPixels - 1) * srcBytesPerPixel, srcBytesPerPixel);
+        std::memcpy(last + srcBytesPerPixel, alpha, bytesPerDatum);
+    }
+
+    void TileProcessor::downsample(const char* src, const glm::uvec2& size, char* dst,
+        const TileDataLayout& layout)
+    {
+        ghoul_assert(size.x > 0 && size.y > 0, "Image has to have pixels");
+        glm::uvec2 dstSize = mipMapSize(size, 1);
+        unsigned int startX = 0;
+
+        if (layout.gdalType == GDT_Byte && layout.numRasters == 4 && size.x >= 2 &&
+            size.y >= 2)
+        {
+            // Four byte pixels can be filtered as 32 bit lanes
+            unsigned int numVectorized = 0;
+#ifdef OPENSPACE_TILEPROCESSOR_SSE2
+            numVectorized = dstSize.x - dstSize.x % 4;
+            for (unsigned int y = 0; y < dstSize.y; ++y) {
+                const char* row0 = src + size_t(2 * y) * size.x * 4;
+                const char* row1 = row0 + size_t(size.x) * 4;
+                char* dstRow = dst + size_t(y) * dstSize.x * 4;
+                for (unsigned int x = 0; x < numVectorized; x += 4) {
+                    const char* p0 = row0 + size_t(2 * x) * 4;
+                    const char* p1 = row1 + size_t(2 * x) * 4;
+                    __m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p0));
+                    __m128i top1 =
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p0 + 16));
+                    __m128i bottom0 =
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1));
+                    __m128i bottom1 =
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1 + 16));
+
+                    // Average the rows, then the even and odd pixels
+                    __m128 vertical0 = _mm_castsi128_ps(_mm_avg_epu8(top0, bottom0));
+                    __m128 vertical1 = _mm_castsi128_ps(_mm_avg_epu8(top1, bottom1));
+                    __m128i even = _mm_castps_si128(
+                        _mm_shuffle_ps(vertical0, vertical1, _MM_SHUFFLE(2, 0, 2, 0)));
+                    __m128i odd = _mm_castps_si128(
+                        _mm_shuffle_ps(vertical0, vertical1, _MM_SHUFFLE(3, 1, 3, 1)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + x * 4),
+                        _mm_avg_epu8(even, odd));
+                }
+            }
+#endif
+            startX = numVectorized;
+        }
+
+        switch (layout.gdalType) {
+        case GDT_Byte:
+            downsampleDatums<uint8_t>(src, size, dst, dstSize, layout.numRasters, startX);
+            break;
+        case GDT_UInt16:
+            downsampleDatums<uint16_t>(src, size, dst, dstSize, layout.numRasters, 0);
+            break;
+        case GDT_Int16:
+            downsampleDatums<int16_t>(src, size, dst, dstSize, layout.numRasters, 0);
+            break;
+        case GDT_UInt32:
+            downsampleDatums<uint32_t>(src, size, dst, dstSize, layout.numRasters, 0);
+            break;
+        case GDT_Int32:
+            downsampleDatums<int32_t>(src, size, dst, dstSize, layout.numRasters, 0);
+            break;
+        case GDT_Float32:
+            downsampleDatums<float>(src, size, dst, dstSize, layout.numRasters, 0);
+            break;
+        case GDT_Float64:
+            downsampleDatums<double>(src, size, dst, dstSize, layout.numRasters, 0);
+            break;
+        default:
+            ghoul_assert(false, "Unknown data type");
+        }
+    }
+
+    glm::uvec2 TileProcessor::mipMapSize(const glm::uvec2& size, int level) {
+        return glm::uvec2(std::max(1u, size.x >> level), std::max(1u, size.y >> level));
+    }
+
+    int TileProcessor::numMipMapLevels(const glm::uvec2& size) {
+        int numLevels = 1;
+        for (unsigned int s = std::max(size.x, size.y); s > 1; s >>= 1) {
+            numLevels++;
+        }
+        return numLevels;
+    }
+
+    TileStageTimes::TileStageTimes() {
+        for (std::atomic<long long>& microseconds : _microseconds) {
+            microseconds = 0;
+        }
+    }
+
+    void TileStageTimes::add(Stage stage, std::chrono::microseconds duration) {
+        _microseconds[static_cast<int>(stage)] += duration.count();
+    }
+
+    long long TileStageTimes::take(Stage stage) {
+        return _microseconds[static_cast<int>(stage)].exchange(0);
+    }
+
+    void TileStageTimes::takeInto(TileStageTimes& destination) {
+        for (size_t i = 0; i < _microseconds.size(); ++i) {
+            destination._microseconds[i] += _microseconds[i].exchange(0);
+        }
+    }
+
+} // namespace openspace
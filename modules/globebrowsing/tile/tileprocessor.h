@@ -0,0 +1,144 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TILE_PROCESSOR_H__
+#define __TILE_PROCESSOR_H__
+
+#include <modules/globebrowsing/tile/tiledataset.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace openspace {
+
+    struct TileIOResult;
+    class TileStageTimes;
+
+    /**
+    * Converts the pixel data read by a <code>TileDataset</code> into the format that
+    * is uploaded to the GPU. It runs on the I/O workers, so that the render thread
+    * only has to upload the buffers it receives. The tile padding is kept, as the tile
+    * shaders compensate for it when sampling.
+    */
+    class TileProcessor {
+    public:
+        struct Configuration {
+            /**
+            * Expand three channel byte and float tiles to four channels with an opaque
+            * alpha, which avoids a conversion in the driver when uploading
+            */
+            bool expandToFourChannels = true;
+
+            /// Convert 64 bit float tiles to 32 bit floats, which textures can store
+            bool convertDoubleToFloat = true;
+
+            /**
+            * Generate the mip map levels with a box filter on the I/O workers instead
+            * of on the GPU when the texture is uploaded
+            */
+            bool generateMipMaps = false;
+        };
+
+        TileProcessor(const TileDataLayout& inputLayout, const Configuration& config);
+
+        /**
+        * Converts the image data of the result to the output layout in place and
+        * generates its mip map levels if configured to. Results with errors are left
+        * untouched. The time spent is added to <code>stageTimes</code> if it is given.
+        */
+        void process(TileIOResult& result, TileStageTimes* stageTimes = nullptr) const;
+
+        const TileDataLayout& inputLayout() const;
+        const TileDataLayout& outputLayout() const;
+        const Configuration& configuration() const;
+
+        /**
+        * Writes <code>numValues</code> 32 bit floats converted from the doubles in
+        * <code>src</code>. Two values are converted at a time when SSE2 is available.
+        */
+        static void convertDoubleToFloat(const double* src, float* dst, size_t numValues);
+
+        /**
+        * Copies <code>numPixels</code> pixels with three channels of
+        * <code>bytesPerDatum</code> bytes each to <code>dst</code>, adding a fourth
+        * channel with the value <code>alpha</code> points to.
+        */
+        static void expandToFourChannels(const char* src, char* dst, size_t numPixels,
+            size_t bytesPerDatum, const char* alpha);
+
+        /**
+        * Writes the next mip map level of an image to <code>dst</code>, which has to
+        * hold <code>max(1, size / 2)</code> pixels. Every pixel is the average of a 2x2
+        * block in the source, like the levels generated by OpenGL. Four byte pixels
+        * are filtered four at a time when SSE2 is available.
+        */
+        static void downsample(const char* src, const glm::uvec2& size, char* dst,
+            const TileDataLayout& layout);
+
+        static glm::uvec2 mipMapSize(const glm::uvec2& size, int level);
+        static int numMipMapLevels(const glm::uvec2& size);
+
+    private:
+        TileDataLayout _inputLayout;
+        TileDataLayout _outputLayout;
+        Configuration _config;
+    };
+
+    /**
+    * Time spent in each stage of the tile pipeline since the times were last taken.
+    * Every <code>AsyncTileDataProvider</code> keeps its own times. Reading and
+    * processing happen on the I/O workers, uploading on the render thread.
+    */
+    class TileStageTimes {
+    public:
+        enum class Stage {
+            Read = 0,
+            Convert,
+            MipMap,
+            Upload
+        };
+
+        TileStageTimes();
+
+        void add(Stage stage, std::chrono::microseconds duration);
+
+        /**
+        * Returns the time in microseconds spent in the stage and starts over from zero.
+        */
+        long long take(Stage stage);
+
+        /**
+        * Adds the times of all stages to <code>destination</code> and starts over from
+        * zero.
+        */
+        void takeInto(TileStageTimes& destination);
+
+    private:
+        std::array<std::atomic<long long>, 4> _microseconds;
+    };
+
+} // namespace openspace
+
+#endif // __TILE_PROCESSOR_H__
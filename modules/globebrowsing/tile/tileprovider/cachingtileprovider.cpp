@@ -25,6 +25,11 @@
 #include <modules/globebrowsing/geometry/geodetic2.h>
 #include <modules/globebrowsing/tile/tileprovider/cachingtileprovider.h>
 #include <modules/globebrowsing/chunk/chunkindex.h>
+#include <modules/globebrowsing/tile/tiletexturepool.h>
+#include <modules/globebrowsing/tile/tiletextureresidency.h>
+#include <modules/globebrowsing/tile/simulatedtransfertiledataset.h>
+#include <modules/globebrowsing/tile/syntheticpyramid.h>
+#include <modules/globebrowsing/tile/tileprocessor.h>
 
 #include <ghoul/io/texture/texturereader.h>
 #include <ghoul/filesystem/filesystem.h>
@@ -32,6 +37,8 @@
 
 #include <openspace/engine/openspaceengine.h>
 
+#include <chrono>
+
 namespace {
     const std::string _loggerCat = "CachingTileProvider";
 
@@ -40,6 +47,11 @@ namespace {
     const std::string KeyFilePath = "FilePath";
     const std::string KeyCacheSize = "CacheSize";
     const std::string KeyFlushInterval = "FlushInterval";
+    const std::string KeyPrefetchSiblings = "PrefetchSiblings";
+    const std::string KeySimulatedLatency = "SimulatedLatency";
+    const std::string KeySimulatedBandwidth = "SimulatedBandwidth";
+    const std::string KeySynthetic = "Synthetic";
+    const std::string KeyGenerateMipMaps = "GenerateMipMaps";
 }
 
 namespace openspace {
@@ -83,8 +95,45 @@ namespace openspace {
                 framesUntilRequestFlush);
         }
 
+        if (dictionary.getValue<bool>(KeyPrefetchSiblings, config.prefetchSiblings)) {
+            LDEBUG("Default prefetchSiblings overridden: " << config.prefetchSiblings);
+        }
+
+        double simulatedLatency = 0.0;
+        double simulatedBandwidth = 0.0;
+        if (dictionary.getValue<double>(KeySimulatedLatency, simulatedLatency)) {
+            LDEBUG("Default simulatedLatency overridden: " << simulatedLatency);
+        }
+        if (dictionary.getValue<double>(KeySimulatedBandwidth, simulatedBandwidth)) {
+            LDEBUG("Default simulatedBandwidth overridden: " << simulatedBandwidth);
+        }
+
+        // A synthetic pyramid stands in for a remote dataset when measuring the tile
+        // pipeline, it is only written the first time it is used
+        bool synthetic = false;
+        dictionary.getValue<bool>(KeySynthetic, synthetic);
+        if (synthetic && !FileSys.fileExists(filePath)) {
+            LINFO("Creating synthetic pyramid '" << filePath << "'");
+            SyntheticPyramid::create(filePath, SyntheticPyramid::Description());
+        }
+
+        TileProcessor::Configuration processorConfig;
+        if (dictionary.getValue<bool>(KeyGenerateMipMaps,
+            processorConfig.generateMipMaps))
+        {
+            LDEBUG("Default generateMipMaps overridden: " <<
+                processorConfig.generateMipMaps);
+        }
+
         // Initialize instance variables
-        auto tileDataset = std::make_shared<TileDataset>(filePath, config);
+        std::shared_ptr<TileDataset> tileDataset;
+        if (simulatedLatency > 0.0 || simulatedBandwidth > 0.0) {
+            tileDataset = std::make_shared<SimulatedTransferTileDataset>(filePath, config,
+                simulatedLatency, simulatedBandwidth);
+        }
+        else {
+            tileDataset = std::make_shared<TileDataset>(filePath, config);
+        }
 
         // only one thread per provider supported atm
         // (GDAL does not handle multiple threads for a single dataset very well
@@ -92,7 +141,7 @@ namespace openspace {
         auto threadPool = std::make_shared<ThreadPool>(1);
 
         _asyncTextureDataProvider = std::make_shared<AsyncTileDataProvider>(
-            tileDataset, threadPool);
+            tileDataset, threadPool, processorConfig);
         _tileCache = std::make_shared<TileCache>(cacheSize);
         _framesUntilRequestFlush = framesUntilRequestFlush;
     }
@@ -123,6 +172,9 @@ namespace openspace {
     void CachingTileProvider::reset() {
         _tileCache->clear();
         _asyncTextureDataProvider->reset();
+        if (_tileArrivalCallback) {
+            _tileArrivalCallback(ChunkIndex(0, 0, 0));
+        }
     }
 
     int CachingTileProvider::maxLevel() {
@@ -140,7 +192,9 @@ namespace openspace {
         ChunkHashKey key = chunkIndex.hashKey();
 
         if (_tileCache->exist(key)) {
-            return _tileCache->get(key);
+            Tile tile = _tileCache->get(key);
+            TileTextureResidency::ref().touch(tile.textureSlot.get());
+            return tile;
         }
         else {
             _asyncTextureDataProvider->enqueueTileIO(chunkIndex);
@@ -150,8 +204,11 @@ namespace openspace {
     }
 
     Tile CachingTileProvider::getDefaultTile() {
-        if (_defaultTile.texture == nullptr) {
-            _defaultTile = createTile(_asyncTextureDataProvider->getTextureDataProvider()->defaultTileData());
+        if (_defaultTile.textureSlot == nullptr) {
+            std::shared_ptr<TileIOResult> defaultTileData =
+                _asyncTextureDataProvider->getTextureDataProvider()->defaultTileData();
+            _asyncTextureDataProvider->getTileProcessor().process(*defaultTileData);
+            _defaultTile = createTile(defaultTileData, false);
         }
         return _defaultTile;
     }
@@ -162,9 +219,20 @@ namespace openspace {
             ChunkHashKey key = tileIOResult->chunkIndex.hashKey();
             Tile tile = createTile(tileIOResult);
             _tileCache->put(key, tile);
+            if (_tileArrivalCallback && tile.status == Tile::Status::OK) {
+                _tileArrivalCallback(tileIOResult->chunkIndex);
+            }
         }
     }
 
+    void CachingTileProvider::setTileArrivalCallback(TileArrivalCallback callback) {
+        _tileArrivalCallback = callback;
+    }
+
+    void CachingTileProvider::takeStageTimes(TileStageTimes& stageTimes) {
+        _asyncTextureDataProvider->getStageTimes().takeInto(stageTimes);
+    }
+
     void CachingTileProvider::clearRequestQueue() {
         _asyncTextureDataProvider->clearRequestQueue();
         _framesSinceLastRequestFlush = 0;
@@ -189,32 +257,70 @@ namespace openspace {
         return _asyncTextureDataProvider->getTextureDataProvider()->getDepthTransform();
     }
 
-    Tile CachingTileProvider::createTile(std::shared_ptr<TileIOResult> tileIOResult) {
+    Tile CachingTileProvider::createTile(std::shared_ptr<TileIOResult> tileIOResult,
+        bool evictable)
+    {
         if (tileIOResult->error != CE_None) {
             return{ nullptr, nullptr, Tile::Status::IOError };
         }
 
         ChunkHashKey key = tileIOResult->chunkIndex.hashKey();
-        TileDataLayout dataLayout =
-            _asyncTextureDataProvider->getTextureDataProvider()->getDataLayout();
+        // The I/O workers have converted the image data to the processor's layout
+        const TileDataLayout& dataLayout =
+            _asyncTextureDataProvider->getTileProcessor().outputLayout();
+        auto t0 = std::chrono::high_resolution_clock::now();
         
-        // The texture should take ownership of the data
-        std::shared_ptr<Texture> texture = std::make_shared<Texture>(
-            tileIOResult->imageData,
-            tileIOResult->dimensions,
-            dataLayout.textureFormat.ghoulFormat,
-            dataLayout.textureFormat.glFormat,
+        // Tiles with the same format share the layers of the pool's array textures.
+        // The slot takes ownership of the data and stops being resident in GPU memory
+        // when the last tile referring to it is destroyed
+        TileTextureFormat format = {
             dataLayout.glType,
-            Texture::FilterMode::Linear,
-            Texture::WrappingMode::ClampToEdge);
-        
-        texture->uploadTexture();
-
-        // AnisotropicMipMap must be set after texture is uploaded. Why?!
-        texture->setFilter(ghoul::opengl::Texture::FilterMode::AnisotropicMipMap);
+            dataLayout.textureFormat.glFormat,
+            static_cast<GLenum>(dataLayout.textureFormat.ghoulFormat),
+            glm::uvec2(tileIOResult->dimensions),
+            true
+        };
+        std::shared_ptr<TileTextureSlot> textureSlot =
+            TileTexturePool::forFormat(format).allocate();
+        textureSlot->uploadLevel(0, tileIOResult->imageData);
+        textureSlot->setPixelData(std::unique_ptr<char[]>(tileIOResult->imageData));
+        tileIOResult->imageData = nullptr;
+
+        const std::vector<std::vector<char>>& mipMapLevels = tileIOResult->mipMapLevels;
+        if (mipMapLevels.empty()) {
+            textureSlot->generateMipMaps();
+        }
+        else {
+            // The I/O workers generated the mip map levels, so upload them instead of
+            // letting the GPU generate them
+            for (size_t i = 0; i < mipMapLevels.size(); ++i) {
+                textureSlot->uploadLevel(static_cast<int>(i) + 1, mipMapLevels[i].data());
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        _asyncTextureDataProvider->getStageTimes().add(TileStageTimes::Stage::Upload,
+            std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0));
+
+        TileTextureResidency::EvictionCallback onEviction;
+        if (evictable) {
+            // The cache may have been reset and refilled since the slot was allocated,
+            // so only remove the tile if it still refers to this slot
+            std::weak_ptr<TileCache> weakTileCache = _tileCache;
+            const TileTextureSlot* evictedSlot = textureSlot.get();
+            onEviction = [weakTileCache, key, evictedSlot]() {
+                std::shared_ptr<TileCache> tileCache = weakTileCache.lock();
+                if (tileCache && tileCache->exist(key) &&
+                    tileCache->get(key).textureSlot.get() == evictedSlot)
+                {
+                    tileCache->remove(key);
+                }
+            };
+        }
+        TileTextureResidency::ref().makeResident(textureSlot.get(), format,
+            format.numBytes(), onEviction, textureSlot->arrayTexture());
 
         Tile tile = {
-            texture,
+            textureSlot,
             tileIOResult->preprocessData,
             Tile::Status::OK
         };
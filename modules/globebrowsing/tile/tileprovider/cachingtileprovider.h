@@ -69,6 +69,8 @@ namespace openspace {
         virtual void update();
         virtual void reset();
         virtual int maxLevel();
+        virtual void setTileArrivalCallback(TileArrivalCallback callback);
+        virtual void takeStageTimes(TileStageTimes& stageTimes);
 
     private:
 
@@ -80,15 +82,18 @@ namespace openspace {
         * Collects all asynchronously downloaded <code>TileIOResult</code>
         * and uses <code>createTile</code> to create <code>Tile</code>s, 
         * which are put in the LRU cache - potentially pushing out outdated
-        * Tiles.
+        * Tiles. The tile arrival callback is invoked for every new valid Tile.
         */
         void initTexturesFromLoadedData();
 
         /**
+        * Creates the tile and registers its texture slot with the
+        * <code>TileTextureResidency</code>. Evictable tiles are removed from the
+        * cache when the residency needs to free memory.
         * \returns A tile with <code>Tile::Status::OK</code> if no errors
         * occured, a tile with <code>Tile::Status::IOError</code> otherwise
         */
-        Tile createTile(std::shared_ptr<TileIOResult> res);
+        Tile createTile(std::shared_ptr<TileIOResult> res, bool evictable = true);
 
         /**
         * Deletes all enqueued, but not yet started async downloads of textures.
@@ -107,6 +112,8 @@ namespace openspace {
         int _framesUntilRequestFlush;
 
         Tile _defaultTile;
+
+        TileArrivalCallback _tileArrivalCallback;
     };
 
 }  // namespace openspace
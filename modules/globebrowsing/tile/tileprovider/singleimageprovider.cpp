@@ -80,12 +80,15 @@ namespace openspace {
 
     void SingleImageProvider::reset() {
         _tile = Tile();
-        _tile.texture = std::shared_ptr<Texture>(ghoul::io::TextureReader::ref().loadTexture(_imagePath).release());
-        _tile.status = _tile.texture != nullptr ? Tile::Status::OK : Tile::Status::IOError;
-        _tile.preprocessData = nullptr;
-
-        _tile.texture->uploadTexture();
-        _tile.texture->setFilter(ghoul::opengl::Texture::FilterMode::Linear);
+        std::unique_ptr<Texture> texture =
+            ghoul::io::TextureReader::ref().loadTexture(_imagePath);
+        if (texture != nullptr) {
+            _tile = Tile::createFromTexture(*texture);
+        }
+        else {
+            _tile.status = Tile::Status::IOError;
+            _tile.preprocessData = nullptr;
+        }
     }
 
     int SingleImageProvider::maxLevel() {
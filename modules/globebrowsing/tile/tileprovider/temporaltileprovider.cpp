@@ -162,8 +162,16 @@ namespace openspace {
     }
 
     void TemporalTileProvider::update() {
+        auto previousTileProvider = _currentTileProvider;
         _currentTileProvider = getTileProvider();
         _currentTileProvider->update();
+
+        // Switching to another point in time replaces all tiles at once
+        bool switchedProvider = previousTileProvider != nullptr &&
+            previousTileProvider != _currentTileProvider;
+        if (switchedProvider && _tileArrivalCallback) {
+            _tileArrivalCallback(ChunkIndex(0, 0, 0));
+        }
     }
 
     void TemporalTileProvider::reset() {
@@ -173,6 +181,19 @@ namespace openspace {
         }
     }
 
+    void TemporalTileProvider::setTileArrivalCallback(TileArrivalCallback callback) {
+        _tileArrivalCallback = callback;
+        for (auto& it : _tileProviderMap) {
+            it.second->setTileArrivalCallback(callback);
+        }
+    }
+
+    void TemporalTileProvider::takeStageTimes(TileStageTimes& stageTimes) {
+        for (auto& it : _tileProviderMap) {
+            it.second->takeStageTimes(stageTimes);
+        }
+    }
+
     std::shared_ptr<TileProvider> TemporalTileProvider::getTileProvider(Time t) {
         Time tCopy(t);
         if (_timeQuantizer.quantize(tCopy, true)) {
@@ -206,7 +227,9 @@ namespace openspace {
     std::shared_ptr<TileProvider> TemporalTileProvider::initTileProvider(TimeKey timekey) {
         std::string gdalDatasetXml = getGdalDatasetXML(timekey);
         _initDict.setValue<std::string>(KeyFilePath, gdalDatasetXml);
-        return std::make_shared<CachingTileProvider>(_initDict);
+        auto tileProvider = std::make_shared<CachingTileProvider>(_initDict);
+        tileProvider->setTileArrivalCallback(_tileArrivalCallback);
+        return tileProvider;
     }
     
     std::string TemporalTileProvider::getGdalDatasetXML(Time t) {
@@ -189,6 +189,8 @@ namespace openspace {
         virtual void update();
         virtual void reset();
         virtual int maxLevel();
+        virtual void setTileArrivalCallback(TileArrivalCallback callback);
+        virtual void takeStageTimes(TileStageTimes& stageTimes);
 
 
         typedef std::string TimeKey;
@@ -312,6 +314,7 @@ namespace openspace {
 
         std::shared_ptr<TileProvider> _currentTileProvider;
 
+        TileArrivalCallback _tileArrivalCallback;
         
         TimeFormat * _timeFormat;
         TimeQuantizer _timeQuantizer;
@@ -108,23 +108,17 @@ namespace openspace {
         glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFBO);
         glGetIntegerv(GL_VIEWPORT, viewport);
 
-        // Render to texture
+        // Render to the tile's texture slot
         glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
-        glFramebufferTexture2D(
-            GL_FRAMEBUFFER,
-            GL_COLOR_ATTACHMENT0,
-            GL_TEXTURE_2D,
-            *(tile.texture),
-            0
-            );
+        tile.textureSlot->attachToFramebuffer(GL_COLOR_ATTACHMENT0);
 
         GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
         //LDEBUG(status);
 
         glViewport(
             0, 0,
-            static_cast<GLsizei>(tile.texture->width()),
-            static_cast<GLsizei>(tile.texture->height())
+            static_cast<GLsizei>(tile.textureSlot->dimensions().x),
+            static_cast<GLsizei>(tile.textureSlot->dimensions().y)
             );
         
         ghoul_assert(_fontRenderer != nullptr, "_fontRenderer must not be null");
@@ -188,15 +182,11 @@ namespace openspace {
         }
         _ellipsoid = Ellipsoid(radii);
 
-        _backgroundTile.status = Tile::Status::Unavailable;
         std::string backgroundImagePath;
         if (dictionary.getValue(KeyBackgroundImagePath, backgroundImagePath)) {
             using namespace ghoul::io;
             std::string imgAbsPath = absPath(backgroundImagePath);
-            _backgroundTile.texture = TextureReader::ref().loadTexture(imgAbsPath);
-            _backgroundTile.texture->uploadTexture();
-            _backgroundTile.texture->setFilter(ghoul::opengl::Texture::FilterMode::Linear);
-            _backgroundTile.status = Tile::Status::OK;
+            _backgroundTexture = TextureReader::ref().loadTexture(imgAbsPath);
         }
 
     }
@@ -250,17 +240,8 @@ namespace openspace {
     }
 
     Tile SizeReferenceTileProvider::backgroundTile(const ChunkIndex& chunkIndex) const {
-        if (_backgroundTile.status == Tile::Status::OK) {
-            Tile tile;
-            auto t = _backgroundTile.texture;
-            void* pixelData = new char[t->expectedPixelDataSize()];
-            memcpy(pixelData, t->pixelData(), t->expectedPixelDataSize());
-            tile.texture = std::make_shared<Texture>(
-                pixelData, t->dimensions(), t->format(), t->internalFormat(), t->dataType(), t->filter(), t->wrapping());
-            tile.texture->uploadTexture();
-            tile.texture->setDataOwnership(Texture::TakeOwnership::Yes);
-            tile.status = Tile::Status::OK;
-            return tile;
+        if (_backgroundTexture) {
+            return Tile::createFromTexture(*_backgroundTexture);
         }
         else {
             // use default background
@@ -141,7 +141,9 @@ namespace openspace {
         int roundedLongitudalLength(const ChunkIndex& chunkIndex) const;
 
         Ellipsoid _ellipsoid;
-        Tile _backgroundTile;
+
+        /// Only kept on the CPU, its pixels are copied into every tile
+        std::unique_ptr<Texture> _backgroundTexture;
     };
 
 }  // namespace openspace
@@ -33,6 +33,8 @@
 #include <modules/globebrowsing/tile/tile.h>
 #include <modules/globebrowsing/other/lrucache.h>
 
+#include <functional>
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //                                    TILE PROVIDER                                     //
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -40,6 +42,8 @@
 namespace openspace {
     
     using namespace ghoul::opengl;
+
+    class TileStageTimes;
     
     /**
     * Interface for providing <code>Tile</code>s given a 
@@ -48,6 +52,12 @@ namespace openspace {
     class TileProvider {
     public:
 
+        /**
+        * Invoked with the <code>ChunkIndex</code> of a tile that has become available
+        * in a TileProvider. A level 0 index signals that any tile may have changed.
+        */
+        typedef std::function<void(const ChunkIndex&)> TileArrivalCallback;
+
         /**
         * Factory method for instantiating different implementations of 
         * <code>TileProviders</code>. The provided dictionary must 
@@ -136,6 +146,23 @@ namespace openspace {
         * that this TileProvider is able provide.
         */
         virtual int maxLevel() = 0;
+
+        /**
+        * Registers a callback to be invoked whenever a new tile is made available by
+        * this TileProvider, which may happen in <code>update</code> and 
+        * <code>reset</code>. This allows clients to keep data derived from tiles
+        * cached until a better tile arrives. Only one callback is kept; passing an
+        * empty callback unregisters it. TileProviders whose tiles never change need
+        * not implement this.
+        */
+        virtual void setTileArrivalCallback(TileArrivalCallback callback) { }
+
+        /**
+        * Adds the time this TileProvider spent in each stage of the tile pipeline
+        * since the previous call and starts over from zero. TileProviders that do not
+        * read tiles asynchronously need not implement this.
+        */
+        virtual void takeStageTimes(TileStageTimes& stageTimes) { }
     };
 
     typedef LRUCache<ChunkHashKey, Tile> TileCache;
@@ -0,0 +1,103 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/tilereadplanner.h>
+
+#include <ghoul/misc/assert.h>
+
+#include <cstring>
+
+namespace openspace {
+
+    std::vector<TileReadPlanner::Read> TileReadPlanner::plan(
+        const std::vector<Request>& requests, const PixelRegion& bounds,
+        double maxOverhead)
+    {
+        std::vector<Read> reads;
+        std::vector<bool> planned(requests.size(), false);
+
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (planned[i]) {
+                continue;
+            }
+            planned[i] = true;
+
+            Read read = { requests[i].overview, requests[i].region, { i } };
+            if (!requests[i].region.isInside(bounds)) {
+                reads.push_back(read);
+                continue;
+            }
+
+            double numRequestedPixels = requests[i].region.area();
+            for (size_t j = i + 1; j < requests.size(); ++j) {
+                if (planned[j] || requests[j].overview != read.overview ||
+                    !requests[j].region.isInside(bounds))
+                {
+                    continue;
+                }
+                PixelRegion region = boundingRegion(read.region, requests[j].region);
+                double numPixels = numRequestedPixels + requests[j].region.area();
+                if (region.area() <= maxOverhead * numPixels) {
+                    read.region = region;
+                    read.requests.push_back(j);
+                    numRequestedPixels = numPixels;
+                    planned[j] = true;
+                }
+            }
+            reads.push_back(read);
+        }
+        return reads;
+    }
+
+    void TileReadPlanner::copySubregion(const char* src, const PixelRegion& srcRegion,
+        char* dst, const PixelRegion& dstRegion, size_t bytesPerPixel)
+    {
+        ghoul_assert(dstRegion.isInside(srcRegion), "Region must be inside source");
+
+        size_t srcBytesPerLine = srcRegion.numPixels.x * bytesPerPixel;
+        size_t dstBytesPerLine = dstRegion.numPixels.x * bytesPerPixel;
+        PixelCoordinate offset = dstRegion.start - srcRegion.start;
+
+        // Lines are stored bottom to top, so the first destination line is the last
+        // line of the region
+        size_t firstSrcLine = srcRegion.numPixels.y - dstRegion.numPixels.y - offset.y;
+        const char* srcStart = src + firstSrcLine * srcBytesPerLine +
+            offset.x * bytesPerPixel;
+        for (int y = 0; y < dstRegion.numPixels.y; ++y) {
+            std::memcpy(
+                dst + y * dstBytesPerLine,
+                srcStart + y * srcBytesPerLine,
+                dstBytesPerLine);
+        }
+    }
+
+    PixelRegion TileReadPlanner::boundingRegion(const PixelRegion& a,
+        const PixelRegion& b)
+    {
+        PixelCoordinate start = glm::min(a.start, b.start);
+        PixelCoordinate end = glm::max(a.end(), b.end());
+        return PixelRegion(start, end - start);
+    }
+
+} // namespace openspace
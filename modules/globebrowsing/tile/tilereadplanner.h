@@ -0,0 +1,83 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TILE_READ_PLANNER_H__
+#define __TILE_READ_PLANNER_H__
+
+#include <modules/globebrowsing/tile/pixelregion.h>
+
+#include <vector>
+
+namespace openspace {
+
+    /**
+    * Combines reads of nearby pixel regions into fewer, larger reads. Tiles that are
+    * requested together, such as the four children of a chunk, read regions that are
+    * adjacent and overlap by the tile padding. Reading their bounding region once and
+    * slicing it is cheaper than reading every region on its own.
+    */
+    class TileReadPlanner {
+    public:
+        struct Request {
+            int overview;
+            PixelRegion region;
+        };
+
+        struct Read {
+            int overview;
+
+            /// The bounding region of all requests in the read
+            PixelRegion region;
+
+            /// Indices of the requests covered by this read
+            std::vector<size_t> requests;
+        };
+
+        /**
+        * Groups the requests into reads. Requests are only combined if they read from
+        * the same overview, their bounding region is inside <code>bounds</code>, and
+        * the bounding region has at most <code>maxOverhead</code> times as many pixels
+        * as the requests together. The default overhead lets three of four siblings be
+        * combined before the fourth one completes the square. Requests are added to
+        * the read of the first request in the order they are given. Requests that are
+        * not inside <code>bounds</code> get a read of their own.
+        */
+        static std::vector<Read> plan(const std::vector<Request>& requests,
+            const PixelRegion& bounds, double maxOverhead = 1.25);
+
+        /**
+        * Copies the pixels of <code>dstRegion</code> from <code>src</code>, which holds
+        * the pixels of <code>srcRegion</code>, to <code>dst</code>. Both buffers store
+        * their lines bottom to top like tile textures do, and <code>dstRegion</code>
+        * has to be inside <code>srcRegion</code>.
+        */
+        static void copySubregion(const char* src, const PixelRegion& srcRegion,
+            char* dst, const PixelRegion& dstRegion, size_t bytesPerPixel);
+
+        static PixelRegion boundingRegion(const PixelRegion& a, const PixelRegion& b);
+    };
+
+} // namespace openspace
+
+#endif // __TILE_READ_PLANNER_H__
@@ -0,0 +1,596 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/tiletexturepool.h>
+
+#include <modules/globebrowsing/tile/tiletextureresidency.h>
+
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
+
+#include <algorithm>
+#include <tuple>
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+namespace {
+    const std::string _loggerCat = "TileTexturePool";
+
+    size_t numChannels(GLenum pixelFormat) {
+        switch (pixelFormat) {
+            case GL_RED:
+            case GL_RED_INTEGER:
+                return 1;
+            case GL_RG:
+            case GL_RG_INTEGER:
+                return 2;
+            case GL_RGB:
+            case GL_BGR:
+            case GL_RGB_INTEGER:
+                return 3;
+            case GL_RGBA:
+            case GL_BGRA:
+            case GL_RGBA_INTEGER:
+                return 4;
+            default:
+                ghoul_assert(false, "Unknown pixel format");
+                return 4;
+        }
+    }
+
+    size_t numBytesPerChannel(GLenum glType) {
+        switch (glType) {
+            case GL_UNSIGNED_BYTE:
+            case GL_BYTE:
+                return 1;
+            case GL_UNSIGNED_SHORT:
+            case GL_SHORT:
+            case GL_HALF_FLOAT:
+                return 2;
+            case GL_UNSIGNED_INT:
+            case GL_INT:
+            case GL_FLOAT:
+                return 4;
+            case GL_DOUBLE:
+                return 8;
+            default:
+                ghoul_assert(false, "Unknown data type");
+                return 1;
+        }
+    }
+
+    GLenum sizedFormat(size_t numChannels, GLenum glType) {
+        const GLenum unsignedByte[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+        const GLenum signedByte[] = { GL_R8_SNORM, GL_RG8_SNORM, GL_RGB8_SNORM,
+            GL_RGBA8_SNORM };
+        const GLenum unsignedShort[] = { GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 };
+        const GLenum signedShort[] = { GL_R16_SNORM, GL_RG16_SNORM, GL_RGB16_SNORM,
+            GL_RGBA16_SNORM };
+        const GLenum halfFloat[] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+        const GLenum fullFloat[] = { GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F };
+
+        size_t i = numChannels - 1;
+        switch (glType) {
+            case GL_UNSIGNED_BYTE:
+                return unsignedByte[i];
+            case GL_BYTE:
+                return signedByte[i];
+            case GL_UNSIGNED_SHORT:
+                return unsignedShort[i];
+            case GL_SHORT:
+                return signedShort[i];
+            case GL_HALF_FLOAT:
+                return halfFloat[i];
+            default:
+                return fullFloat[i];
+        }
+    }
+
+    template <typename T>
+    float readAsFloat(const char* data) {
+        return static_cast<float>(*reinterpret_cast<const T*>(data));
+    }
+}
+
+namespace openspace {
+
+    size_t TileTextureFormat::bytesPerPixel() const {
+        return numChannels(pixelFormat) * numBytesPerChannel(glType);
+    }
+
+    GLenum TileTextureFormat::sizedInternalFormat() const {
+        switch (internalFormat) {
+            case GL_RED:
+            case GL_RG:
+            case GL_RGB:
+            case GL_RGBA:
+                return sizedFormat(numChannels(pixelFormat), glType);
+            default:
+                return internalFormat;
+        }
+    }
+
+    int TileTextureFormat::numMipMapLevels() const {
+        int numLevels = 1;
+        if (mipMapped) {
+            for (unsigned int s = std::max(dimensions.x, dimensions.y); s > 1; s >>= 1) {
+                numLevels++;
+            }
+        }
+        return numLevels;
+    }
+
+    size_t TileTextureFormat::numBytes() const {
+        size_t numBytes = 0;
+        for (int level = 0; level < numMipMapLevels(); ++level) {
+            size_t width = std::max(1u, dimensions.x >> level);
+            size_t height = std::max(1u, dimensions.y >> level);
+            numBytes += width * height * bytesPerPixel();
+        }
+        return numBytes;
+    }
+
+    bool TileTextureFormat::operator<(const TileTextureFormat& other) const {
+        return std::tie(glType, internalFormat, pixelFormat, dimensions.x, dimensions.y,
+            mipMapped) < std::tie(other.glType, other.internalFormat, other.pixelFormat,
+            other.dimensions.x, other.dimensions.y, other.mipMapped);
+    }
+
+    bool TileTextureFormat::operator==(const TileTextureFormat& other) const {
+        return !(*this < other) && !(other < *this);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //                                 Tile Texture Slot                                //
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    TileTextureSlot::TileTextureSlot(const TileTextureFormat& format,
+        GLuint arrayTexture, int layer)
+        : _format(format)
+        , _arrayTexture(arrayTexture)
+        , _layer(layer)
+    { }
+
+    TileTextureSlot::TileTextureSlot(const TileTextureFormat& format,
+        std::unique_ptr<ghoul::opengl::Texture> texture)
+        : _format(format)
+        , _arrayTexture(*texture)
+        , _layer(0)
+        , _texture(std::move(texture))
+    { }
+
+    const TileTextureFormat& TileTextureSlot::format() const {
+        return _format;
+    }
+
+    const glm::uvec2& TileTextureSlot::dimensions() const {
+        return _format.dimensions;
+    }
+
+    GLuint TileTextureSlot::arrayTexture() const {
+        return _arrayTexture;
+    }
+
+    int TileTextureSlot::layer() const {
+        return _layer;
+    }
+
+    void TileTextureSlot::bind() const {
+        if (_texture) {
+            _texture->bind();
+        }
+        else {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, _arrayTexture);
+        }
+    }
+
+    void TileTextureSlot::attachToFramebuffer(GLenum attachment) const {
+        if (_texture) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D,
+                _arrayTexture, 0);
+        }
+        else {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, attachment, _arrayTexture, 0,
+                _layer);
+        }
+    }
+
+    void TileTextureSlot::uploadLevel(int level, const void* pixels) const {
+        ghoul_assert(level < _format.numMipMapLevels(), "Level must exist in the slot");
+        bind();
+        // The rows of small levels and three channel formats are not padded to four
+        // bytes
+        GLint unpackAlignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLsizei width = std::max(1u, _format.dimensions.x >> level);
+        GLsizei height = std::max(1u, _format.dimensions.y >> level);
+        if (_texture) {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height,
+                _format.pixelFormat, _format.glType, pixels);
+        }
+        else {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, _layer, width, height, 1,
+                _format.pixelFormat, _format.glType, pixels);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+    }
+
+    void TileTextureSlot::generateMipMaps() const {
+        if (_format.numMipMapLevels() == 1) {
+            return;
+        }
+        if (_texture) {
+            _texture->bind();
+            glGenerateMipmap(GL_TEXTURE_2D);
+            return;
+        }
+        // glGenerateMipmap works on all layers of an array texture, so the mip maps are
+        // generated through a view of the slot's layer only
+        GLint previousTexture;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+        GLuint view;
+        glGenTextures(1, &view);
+        glTextureView(view, GL_TEXTURE_2D, _arrayTexture,
+            _format.sizedInternalFormat(), 0, _format.numMipMapLevels(), _layer, 1);
+        glBindTexture(GL_TEXTURE_2D, view);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, previousTexture);
+        glDeleteTextures(1, &view);
+    }
+
+    void TileTextureSlot::setPixelData(std::unique_ptr<char[]> pixelData) {
+        _pixelData = std::move(pixelData);
+    }
+
+    const char* TileTextureSlot::pixelData() const {
+        return _pixelData.get();
+    }
+
+    float TileTextureSlot::texelAsFloat(unsigned int x, unsigned int y) const {
+        ghoul_assert(_pixelData, "Slot must have pixel data");
+        ghoul_assert(x < _format.dimensions.x && y < _format.dimensions.y,
+            "Texel must be inside the slot");
+        const char* texel = _pixelData.get() +
+            (size_t(y) * _format.dimensions.x + x) * _format.bytesPerPixel();
+        switch (_format.glType) {
+            case GL_UNSIGNED_BYTE:
+                return readAsFloat<GLubyte>(texel);
+            case GL_BYTE:
+                return readAsFloat<GLbyte>(texel);
+            case GL_UNSIGNED_SHORT:
+                return readAsFloat<GLushort>(texel);
+            case GL_SHORT:
+                return readAsFloat<GLshort>(texel);
+            case GL_UNSIGNED_INT:
+                return readAsFloat<GLuint>(texel);
+            case GL_INT:
+                return readAsFloat<GLint>(texel);
+            case GL_FLOAT:
+                return readAsFloat<GLfloat>(texel);
+            case GL_DOUBLE:
+                return readAsFloat<GLdouble>(texel);
+            default:
+                ghoul_assert(false, "Unsupported data type");
+                return 0.f;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //                            Tile Texture Layer Allocator                          //
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    TileTextureLayerAllocator::TileTextureLayerAllocator(int layersPerPage)
+        : _layersPerPage(layersPerPage)
+    {
+        ghoul_assert(layersPerPage > 0, "Pages must have at least one layer");
+    }
+
+    TileTextureLayerAllocator::Location TileTextureLayerAllocator::allocate(
+        bool& isNewPage)
+    {
+        // Filling up the fullest page first lets the emptier pages drain
+        size_t page = _pages.size();
+        for (size_t i = 0; i < _pages.size(); ++i) {
+            const Page& candidate = _pages[i];
+            bool hasFreeLayer = !candidate.usedLayers.empty() &&
+                candidate.numUsedLayers < _layersPerPage;
+            if (hasFreeLayer && (page == _pages.size() ||
+                candidate.numUsedLayers > _pages[page].numUsedLayers))
+            {
+                page = i;
+            }
+        }
+
+        isNewPage = page == _pages.size();
+        if (isNewPage) {
+            for (size_t i = 0; i < _pages.size(); ++i) {
+                if (_pages[i].usedLayers.empty()) {
+                    page = i;
+                    break;
+                }
+            }
+            if (page == _pages.size()) {
+                _pages.push_back({ std::vector<bool>(), 0 });
+            }
+            _pages[page].usedLayers.assign(_layersPerPage, false);
+        }
+
+        Page& target = _pages[page];
+        auto layer = std::find(target.usedLayers.begin(), target.usedLayers.end(), false);
+        *layer = true;
+        target.numUsedLayers++;
+        return { page, static_cast<int>(layer - target.usedLayers.begin()) };
+    }
+
+    bool TileTextureLayerAllocator::free(const Location& location) {
+        ghoul_assert(location.page < _pages.size(), "Page must exist");
+        Page& page = _pages[location.page];
+        ghoul_assert(page.usedLayers[location.layer], "Layer must be in use");
+        page.usedLayers[location.layer] = false;
+        page.numUsedLayers--;
+        if (page.numUsedLayers > 0) {
+            return false;
+        }
+
+        page.usedLayers.clear();
+        while (!_pages.empty() && _pages.back().usedLayers.empty()) {
+            _pages.pop_back();
+        }
+        return true;
+    }
+
+    int TileTextureLayerAllocator::layersPerPage() const {
+        return _layersPerPage;
+    }
+
+    TileTextureLayerAllocator::Statistics TileTextureLayerAllocator::statistics() const
+    {
+        Statistics statistics = { 0, 0, 0 };
+        for (const Page& page : _pages) {
+            if (!page.usedLayers.empty()) {
+                statistics.numPages++;
+                statistics.numLayers += _layersPerPage;
+                statistics.numUsedLayers += page.numUsedLayers;
+            }
+        }
+        return statistics;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //                                 Tile Texture Pool                                //
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    const size_t TileTexturePool::MAX_PAGE_SIZE_IN_BYTES;
+    const int TileTexturePool::MAX_LAYERS_PER_PAGE;
+
+    std::map<TileTextureFormat, std::shared_ptr<TileTexturePool>>*
+        TileTexturePool::_pools = nullptr;
+
+    namespace {
+        int layersPerPage(const TileTextureFormat& format) {
+            // Every slot owns its texture, which the allocator sees as one page each
+            if (!TileTexturePool::usesArrayTextures()) {
+                return 1;
+            }
+            GLint maxLayers;
+            glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+            size_t layers = TileTexturePool::MAX_PAGE_SIZE_IN_BYTES / format.numBytes();
+            layers = std::min(layers, static_cast<size_t>(
+                std::min(maxLayers, TileTexturePool::MAX_LAYERS_PER_PAGE)));
+            return std::max(static_cast<int>(layers), 1);
+        }
+
+        void setTextureParameters(GLenum target, const TileTextureFormat& format) {
+            glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            if (format.mipMapped) {
+                glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                GLfloat maxAnisotropy;
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+                glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAnisotropy);
+            }
+            else {
+                glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            }
+        }
+    }
+
+    bool TileTexturePool::usesArrayTextures() {
+        using Version = ghoul::systemcapabilities::OpenGLCapabilitiesComponent::Version;
+        static const bool isSupported = !(OpenGLCap.openGLVersion() < Version{ 4, 3, 0 });
+        return isSupported;
+    }
+
+    void TileTexturePool::initialize() {
+        ghoul_assert(_pools == nullptr, "Pools must not have been initialized");
+        _pools = new std::map<TileTextureFormat, std::shared_ptr<TileTexturePool>>();
+    }
+
+    void TileTexturePool::deinitialize() {
+        ghoul_assert(_pools, "Pools must have been initialized");
+        delete _pools;
+        _pools = nullptr;
+    }
+
+    bool TileTexturePool::isInitialized() {
+        return _pools != nullptr;
+    }
+
+    TileTexturePool& TileTexturePool::forFormat(const TileTextureFormat& format) {
+        ghoul_assert(_pools, "Pools must have been initialized");
+        std::shared_ptr<TileTexturePool>& pool = (*_pools)[format];
+        if (!pool) {
+            pool = std::make_shared<TileTexturePool>(format);
+        }
+        return *pool;
+    }
+
+    std::map<TileTextureFormat, TileTexturePool::Statistics>
+        TileTexturePool::allStatistics()
+    {
+        std::map<TileTextureFormat, Statistics> statistics;
+        if (_pools) {
+            for (const auto& pool : *_pools) {
+                statistics[pool.first] = pool.second->statistics();
+            }
+        }
+        return statistics;
+    }
+
+    TileTexturePool::TileTexturePool(const TileTextureFormat& format)
+        : _format(format)
+        , _allocator(layersPerPage(format))
+    {
+        LDEBUG("Created pool for " << format.dimensions.x << "x" <<
+            format.dimensions.y << " tiles with " << _allocator.layersPerPage() <<
+            " layers per page");
+    }
+
+    TileTexturePool::~TileTexturePool() {
+        for (GLuint page : _pages) {
+            if (page != 0) {
+                if (TileTextureResidency::isInitialized()) {
+                    TileTextureResidency::ref().removePage(page);
+                }
+                glDeleteTextures(1, &page);
+            }
+        }
+    }
+
+    std::shared_ptr<TileTextureSlot> TileTexturePool::allocate() {
+        bool isNewPage;
+        TileTextureLayerAllocator::Location location = _allocator.allocate(isNewPage);
+        TileTextureSlot* slot;
+        if (usesArrayTextures()) {
+            if (isNewPage) {
+                if (location.page >= _pages.size()) {
+                    _pages.resize(location.page + 1, 0);
+                }
+                _pages[location.page] = createPage();
+
+                // The whole page occupies GPU memory, however few layers are used
+                if (TileTextureResidency::isInitialized()) {
+                    TileTextureResidency::ref().addPage(_pages[location.page],
+                        _allocator.layersPerPage() * _format.numBytes());
+                }
+            }
+            slot = new TileTextureSlot(_format, _pages[location.page], location.layer);
+        }
+        else {
+            // The slot's texture is deleted with the slot, the allocator only counts it
+            slot = new TileTextureSlot(_format, createTexture());
+        }
+
+        // The slot may outlive the pool and the residency, which are destroyed when the
+        // module is deinitialized
+        std::weak_ptr<TileTexturePool> weakPool = shared_from_this();
+        return std::shared_ptr<TileTextureSlot>(slot,
+            [weakPool, location](TileTextureSlot* slot) {
+                if (TileTextureResidency::isInitialized()) {
+                    TileTextureResidency::ref().release(slot);
+                }
+                delete slot;
+                std::shared_ptr<TileTexturePool> pool = weakPool.lock();
+                if (pool) {
+                    pool->free(location);
+                }
+            });
+    }
+
+    const TileTextureFormat& TileTexturePool::format() const {
+        return _format;
+    }
+
+    TileTexturePool::Statistics TileTexturePool::statistics() const {
+        TileTextureLayerAllocator::Statistics layers = _allocator.statistics();
+        Statistics statistics = {
+            layers.numPages,
+            layers.numLayers,
+            layers.numUsedLayers,
+            layers.numLayers * _format.numBytes(),
+            0.f
+        };
+        if (layers.numLayers > 0) {
+            statistics.fragmentation =
+                static_cast<float>(layers.numLayers - layers.numUsedLayers) /
+                layers.numLayers;
+        }
+        return statistics;
+    }
+
+    GLuint TileTexturePool::createPage() const {
+        GLuint page;
+        glGenTextures(1, &page);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, page);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, _format.numMipMapLevels(),
+            _format.sizedInternalFormat(), _format.dimensions.x, _format.dimensions.y,
+            _allocator.layersPerPage());
+
+        setTextureParameters(GL_TEXTURE_2D_ARRAY, _format);
+        return page;
+    }
+
+    std::unique_ptr<ghoul::opengl::Texture> TileTexturePool::createTexture() const {
+        using Texture = ghoul::opengl::Texture;
+        // Without pixel data the texture does not allocate a CPU-side copy
+        std::unique_ptr<Texture> texture = std::make_unique<Texture>(
+            nullptr,
+            glm::uvec3(_format.dimensions, 1),
+            static_cast<Texture::Format>(_format.pixelFormat),
+            _format.sizedInternalFormat(),
+            _format.glType,
+            Texture::FilterMode::Linear,
+            Texture::WrappingMode::ClampToEdge);
+
+        // All levels are allocated up front, like the levels of the pages
+        texture->bind();
+        for (int level = 0; level < _format.numMipMapLevels(); ++level) {
+            glTexImage2D(GL_TEXTURE_2D, level, _format.sizedInternalFormat(),
+                std::max(1u, _format.dimensions.x >> level),
+                std::max(1u, _format.dimensions.y >> level),
+                0, _format.pixelFormat, _format.glType, nullptr);
+        }
+        setTextureParameters(GL_TEXTURE_2D, _format);
+        return texture;
+    }
+
+    void TileTexturePool::free(const TileTextureLayerAllocator::Location& location) {
+        if (_allocator.free(location) && usesArrayTextures()) {
+            if (TileTextureResidency::isInitialized()) {
+                TileTextureResidency::ref().removePage(_pages[location.page]);
+            }
+            glDeleteTextures(1, &_pages[location.page]);
+            _pages[location.page] = 0;
+        }
+    }
+
+} // namespace openspace
@@ -0,0 +1,308 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TILE_TEXTURE_POOL_H__
+#define __TILE_TEXTURE_POOL_H__
+
+#include <ghoul/opengl/ghoul_gl.h>
+#include <ghoul/opengl/texture.h>
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace openspace {
+
+    /**
+    * The format of a tile texture. Tiles with the same format are interchangeable in
+    * GPU memory and are stored in the same <code>TileTexturePool</code>.
+    */
+    struct TileTextureFormat {
+        /// The data type of the pixels, e.g. <code>GL_UNSIGNED_BYTE</code>
+        GLenum glType;
+        /// The sized internal format of the texture, e.g. <code>GL_RGBA8</code>
+        GLenum internalFormat;
+        /// The format of the uploaded pixels, e.g. <code>GL_RGBA</code>
+        GLenum pixelFormat;
+        glm::uvec2 dimensions;
+        bool mipMapped;
+
+        size_t bytesPerPixel() const;
+
+        /**
+        * Returns the internal format, or the sized format that matches the pixel format
+        * and data type if the internal format is unsized. Array textures can only be
+        * allocated with sized formats.
+        */
+        GLenum sizedInternalFormat() const;
+
+        /**
+        * Returns the number of levels of the texture, which is 1 if it is not mip
+        * mapped.
+        */
+        int numMipMapLevels() const;
+
+        /**
+        * Returns the number of bytes one texture needs, including its mip map levels.
+        */
+        size_t numBytes() const;
+
+        bool operator<(const TileTextureFormat& other) const;
+        bool operator==(const TileTextureFormat& other) const;
+    };
+
+    /**
+    * A handle to the layer of a 2D array texture that stores the texture of one tile.
+    * Slots are allocated from a <code>TileTexturePool</code> and give their layer back
+    * to the pool when the last reference to them is destroyed. Like the
+    * <code>ghoul::opengl::Texture</code>s they replace, slots keep a CPU-side copy of
+    * the first level so that tiles can be sampled on the CPU.
+    *
+    * Without array texture support, see <code>TileTexturePool::usesArrayTextures</code>,
+    * every slot owns a <code>ghoul::opengl::Texture</code> of its own instead.
+    */
+    class TileTextureSlot {
+    public:
+        /**
+        * Creates a handle to a layer of an existing array texture. Does not touch any
+        * OpenGL state.
+        */
+        TileTextureSlot(const TileTextureFormat& format, GLuint arrayTexture,
+            int layer);
+
+        /**
+        * Creates a slot that owns a 2D texture with the slot's format and stores the
+        * tile in it.
+        */
+        TileTextureSlot(const TileTextureFormat& format,
+            std::unique_ptr<ghoul::opengl::Texture> texture);
+
+        const TileTextureFormat& format() const;
+        const glm::uvec2& dimensions() const;
+
+        /**
+        * Returns the array texture holding the slot, or the slot's own texture if
+        * array textures are not used.
+        */
+        GLuint arrayTexture() const;
+
+        /// Returns the layer of the slot, which is 0 if it owns its texture
+        int layer() const;
+
+        /**
+        * Binds the array texture to the <code>GL_TEXTURE_2D_ARRAY</code> target of the
+        * active texture unit, or the slot's own texture to <code>GL_TEXTURE_2D</code>.
+        * Shaders sample the slot with its layer.
+        */
+        void bind() const;
+
+        /**
+        * Attaches the first level of the slot to the bound framebuffer.
+        */
+        void attachToFramebuffer(GLenum attachment) const;
+
+        /**
+        * Uploads a level of the slot. <code>pixels</code> contains tightly packed rows
+        * in the pixel format and data type of the slot's format.
+        */
+        void uploadLevel(int level, const void* pixels) const;
+
+        /**
+        * Generates the mip map levels of the slot from its first level without
+        * touching the other layers of the array texture.
+        */
+        void generateMipMaps() const;
+
+        /**
+        * Takes ownership of a copy of the first level in the slot's format.
+        */
+        void setPixelData(std::unique_ptr<char[]> pixelData);
+        const char* pixelData() const;
+
+        /**
+        * Returns the first channel of the texel in the CPU-side copy of the first
+        * level, converted to float without normalization in the same way as
+        * <code>ghoul::opengl::Texture::texelAsFloat</code>. The slot must have pixel
+        * data.
+        */
+        float texelAsFloat(unsigned int x, unsigned int y) const;
+
+    private:
+        TileTextureFormat _format;
+        GLuint _arrayTexture;
+        int _layer;
+        std::unique_ptr<ghoul::opengl::Texture> _texture;
+        std::unique_ptr<char[]> _pixelData;
+    };
+
+    /**
+    * Hands out the layers of a growing number of equally sized pages. Layers are taken
+    * from the fullest page that has one left, so that the emptier pages drain and can
+    * be released. The allocator only does the bookkeeping for
+    * <code>TileTexturePool</code> and never touches any OpenGL state.
+    */
+    class TileTextureLayerAllocator {
+    public:
+        struct Location {
+            size_t page;
+            int layer;
+        };
+
+        struct Statistics {
+            size_t numPages;
+            size_t numLayers;
+            size_t numUsedLayers;
+        };
+
+        explicit TileTextureLayerAllocator(int layersPerPage);
+
+        /**
+        * Returns the lowest free layer of the fullest page with a free layer. If all
+        * pages are full, a page is added and <code>isNewPage</code> is set. Indices of
+        * removed pages are reused before new ones.
+        */
+        Location allocate(bool& isNewPage);
+
+        /**
+        * Frees the layer and returns true if that left its page empty, in which case
+        * the page is removed.
+        */
+        bool free(const Location& location);
+
+        int layersPerPage() const;
+        Statistics statistics() const;
+
+    private:
+        struct Page {
+            /// Empty if there is no page at this index
+            std::vector<bool> usedLayers;
+            int numUsedLayers;
+        };
+
+        int _layersPerPage;
+        std::vector<Page> _pages;
+    };
+
+    /**
+    * Stores tile textures of one format in the layers of 2D array textures, called
+    * pages. Compared to one texture object per tile this avoids the allocation of a
+    * texture object for every uploaded tile, and tiles that share a page can be drawn
+    * without binding another texture. Pages are created when all layers are in use and
+    * deleted when their last layer is freed.
+    *
+    * The pools of all formats are owned by <code>GlobeBrowsingModule</code> between
+    * the calls to <code>initialize</code> and <code>deinitialize</code>.
+    */
+    class TileTexturePool : public std::enable_shared_from_this<TileTexturePool> {
+    public:
+        struct Statistics {
+            size_t numPages;
+            size_t numLayers;
+            size_t numUsedLayers;
+
+            /// GPU memory allocated for all pages, including the free layers
+            size_t numBytes;
+
+            /// The fraction of the allocated layers that is free
+            float fragmentation;
+        };
+
+        /// The pages are kept below this size, unless a single layer is larger
+        static const size_t MAX_PAGE_SIZE_IN_BYTES = size_t(64) * 1024 * 1024;
+        static const int MAX_LAYERS_PER_PAGE = 256;
+
+        /**
+        * Returns whether tiles are stored in array textures, which needs
+        * <code>glTexStorage3D</code> from OpenGL 4.2 and <code>glTextureView</code>
+        * from OpenGL 4.3. Below that every slot gets a texture of its own, and the
+        * shaders sample <code>sampler2D</code>s instead of
+        * <code>sampler2DArray</code>s.
+        */
+        static bool usesArrayTextures();
+
+        /**
+        * Creates the empty set of pools.
+        * \pre The pools must not have been initialized
+        */
+        static void initialize();
+
+        /**
+        * Destroys all pools and deletes their array textures, so it must be called while
+        * the OpenGL context is current. Slots in array textures that are still alive
+        * afterwards keep their pixel data, but no longer refer to a texture.
+        * \pre The pools must have been initialized
+        */
+        static void deinitialize();
+
+        static bool isInitialized();
+
+        /**
+        * Returns the pool for the format, which is created the first time it is used.
+        * Must be called from the thread with the OpenGL context.
+        * \pre The pools must have been initialized
+        */
+        static TileTexturePool& forFormat(const TileTextureFormat& format);
+
+        /**
+        * Collects the statistics of all pools.
+        */
+        static std::map<TileTextureFormat, Statistics> allStatistics();
+
+        explicit TileTexturePool(const TileTextureFormat& format);
+
+        /// Deletes the pages that still have layers in use
+        ~TileTexturePool();
+
+        /**
+        * Returns a slot in a free layer. The slot stops being resident in
+        * <code>TileTextureResidency</code> and frees its layer when the last reference
+        * to it is destroyed.
+        * \pre The pool must be owned by a <code>std::shared_ptr</code>
+        */
+        std::shared_ptr<TileTextureSlot> allocate();
+
+        const TileTextureFormat& format() const;
+        Statistics statistics() const;
+
+    private:
+        GLuint createPage() const;
+
+        /// Creates the texture of a slot when array textures are not used
+        std::unique_ptr<ghoul::opengl::Texture> createTexture() const;
+        void free(const TileTextureLayerAllocator::Location& location);
+
+        TileTextureFormat _format;
+        TileTextureLayerAllocator _allocator;
+
+        /// The array textures indexed by allocator page, 0 for removed pages
+        std::vector<GLuint> _pages;
+
+        static std::map<TileTextureFormat, std::shared_ptr<TileTexturePool>>* _pools;
+    };
+
+} // namespace openspace
+
+#endif // __TILE_TEXTURE_POOL_H__
@@ -0,0 +1,246 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tile/tiletextureresidency.h>
+
+#include <ghoul/misc/assert.h>
+
+#include <iterator>
+#include <vector>
+
+namespace openspace {
+
+    TileTextureResidency* TileTextureResidency::_instance = nullptr;
+
+    void TileTextureResidency::initialize() {
+        ghoul_assert(_instance == nullptr, "Residency must not have been initialized");
+        _instance = new TileTextureResidency();
+    }
+
+    void TileTextureResidency::deinitialize() {
+        ghoul_assert(_instance, "Residency must have been initialized");
+        delete _instance;
+        _instance = nullptr;
+    }
+
+    bool TileTextureResidency::isInitialized() {
+        return _instance != nullptr;
+    }
+
+    TileTextureResidency& TileTextureResidency::ref() {
+        ghoul_assert(_instance, "Residency must have been initialized");
+        return *_instance;
+    }
+
+    TileTextureResidency::TileTextureResidency(size_t budgetInBytes)
+        : _budgetBytes(budgetInBytes)
+        , _residentBytes(0)
+        , _allocatedBytes(0)
+        , _unpagedBytes(0)
+        , _numEvictions(0)
+    { }
+
+    void TileTextureResidency::makeResident(const TileTextureSlot* slot,
+        const TileTextureFormat& format, size_t numBytes, EvictionCallback onEviction,
+        GLuint page)
+    {
+        release(slot);
+        auto pageIt = _pages.find(page);
+        if (pageIt == _pages.end()) {
+            page = 0;
+            _unpagedBytes += numBytes;
+        }
+        else if (!onEviction) {
+            pageIt->second.numPinnedSlots++;
+        }
+        _entries.push_front({ slot, format, numBytes, onEviction, page });
+        _entryMap[slot] = _entries.begin();
+        _residentBytes += numBytes;
+        enforceBudget();
+    }
+
+    void TileTextureResidency::addPage(GLuint page, size_t numBytes) {
+        _pages[page] = { numBytes, 0 };
+        _allocatedBytes += numBytes;
+    }
+
+    void TileTextureResidency::removePage(GLuint page) {
+        auto it = _pages.find(page);
+        if (it != _pages.end()) {
+            _allocatedBytes -= it->second.numBytes;
+            _pages.erase(it);
+        }
+    }
+
+    void TileTextureResidency::touch(const TileTextureSlot* slot) {
+        auto it = _entryMap.find(slot);
+        if (it != _entryMap.end()) {
+            _entries.splice(_entries.begin(), _entries, it->second);
+        }
+    }
+
+    void TileTextureResidency::release(const TileTextureSlot* slot) {
+        auto it = _entryMap.find(slot);
+        if (it != _entryMap.end()) {
+            erase(it->second);
+        }
+    }
+
+    bool TileTextureResidency::isResident(const TileTextureSlot* slot) const {
+        return _entryMap.count(slot) > 0;
+    }
+
+    void TileTextureResidency::setBudget(size_t budgetInBytes) {
+        _budgetBytes = budgetInBytes;
+        enforceBudget();
+    }
+
+    size_t TileTextureResidency::residentBytes() const {
+        return _residentBytes;
+    }
+
+    size_t TileTextureResidency::allocatedBytes() const {
+        return _allocatedBytes;
+    }
+
+    size_t TileTextureResidency::numEvictions() const {
+        return _numEvictions;
+    }
+
+    TileTextureResidency::Statistics TileTextureResidency::statistics() const {
+        Statistics statistics = { _budgetBytes, _residentBytes, _allocatedBytes,
+            _entries.size(), 0, _numEvictions };
+        for (const Entry& entry : _entries) {
+            FormatStatistics& formatStatistics = statistics.formats[entry.format];
+            formatStatistics.numResidentTiles++;
+            formatStatistics.residentBytes += entry.numBytes;
+            if (!entry.onEviction) {
+                statistics.numPinnedTiles++;
+            }
+        }
+        return statistics;
+    }
+
+    size_t TileTextureResidency::chargedBytes() const {
+        return _allocatedBytes + _unpagedBytes;
+    }
+
+    std::list<TileTextureResidency::Entry>::iterator
+        TileTextureResidency::findEvictionCandidate()
+    {
+        if (_entries.empty()) {
+            return _entries.end();
+        }
+
+        // The most recently used slot is at the front and is never evicted, so neither
+        // are the other slots in its page
+        GLuint newestPage = _entries.front().page;
+        auto it = std::prev(_entries.end());
+        for (; it != _entries.begin(); --it) {
+            if (!it->onEviction) {
+                continue;
+            }
+            if (it->page == 0) {
+                return it;
+            }
+            auto pageIt = _pages.find(it->page);
+            bool isPinned = pageIt != _pages.end() && pageIt->second.numPinnedSlots > 0;
+            if (it->page != newestPage && !isPinned) {
+                return it;
+            }
+        }
+        return _entries.end();
+    }
+
+    void TileTextureResidency::enforceBudget() {
+        // Pages whose slots have all been evicted, but whose owners have not dropped
+        // the slots yet. They are deleted later and are not charged meanwhile, so that
+        // the slots in other pages are not evicted in their place
+        std::vector<std::pair<GLuint, size_t>> pendingPages;
+        size_t pendingBytes = 0;
+
+        while (chargedBytes() > _budgetBytes + pendingBytes) {
+            auto it = findEvictionCandidate();
+            if (it == _entries.end()) {
+                break;
+            }
+
+            // Remove the entries before invoking the callbacks, since the callbacks are
+            // likely to destroy the slots and thereby release them
+            std::vector<EvictionCallback> callbacks;
+            GLuint page = it->page;
+            if (page == 0) {
+                callbacks.push_back(it->onEviction);
+                erase(it);
+            }
+            else {
+                for (auto entry = _entries.begin(); entry != _entries.end();) {
+                    auto next = std::next(entry);
+                    if (entry->page == page) {
+                        callbacks.push_back(entry->onEviction);
+                        erase(entry);
+                    }
+                    entry = next;
+                }
+                auto pageIt = _pages.find(page);
+                if (pageIt != _pages.end()) {
+                    pendingPages.push_back({ page, pageIt->second.numBytes });
+                    pendingBytes += pageIt->second.numBytes;
+                }
+            }
+
+            _numEvictions += callbacks.size();
+            for (const EvictionCallback& onEviction : callbacks) {
+                onEviction();
+            }
+
+            // Pages deleted by the callbacks are no longer charged
+            for (auto pending = pendingPages.begin(); pending != pendingPages.end();) {
+                if (_pages.count(pending->first) == 0) {
+                    pendingBytes -= pending->second;
+                    pending = pendingPages.erase(pending);
+                }
+                else {
+                    ++pending;
+                }
+            }
+        }
+    }
+
+    void TileTextureResidency::erase(std::list<Entry>::iterator it) {
+        _residentBytes -= it->numBytes;
+        if (it->page == 0) {
+            _unpagedBytes -= it->numBytes;
+        }
+        else if (!it->onEviction) {
+            auto pageIt = _pages.find(it->page);
+            if (pageIt != _pages.end()) {
+                pageIt->second.numPinnedSlots--;
+            }
+        }
+        _entryMap.erase(it->slot);
+        _entries.erase(it);
+    }
+
+} // namespace openspace
@@ -0,0 +1,194 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TILE_TEXTURE_RESIDENCY_H__
+#define __TILE_TEXTURE_RESIDENCY_H__
+
+#include <modules/globebrowsing/tile/tiletexturepool.h>
+
+#include <functional>
+#include <list>
+#include <map>
+#include <unordered_map>
+
+namespace openspace {
+
+    /**
+    * Keeps track of the GPU memory used by tile textures and enforces a common budget
+    * for all tile providers. The texture slots of the tiles are registered when they
+    * are uploaded and released when they are destroyed. If the registered slots exceed
+    * the budget, the least recently used ones are evicted by invoking the eviction
+    * callback they were registered with, which should make their owner drop them.
+    *
+    * <code>TileTexturePool</code> allocates whole pages, so the pages it adds are
+    * charged against the budget instead of the slots in them. Freeing a single layer
+    * does not return any memory, so over the budget all slots in the page of the least
+    * recently used slot are evicted together, which lets the pool delete the page.
+    *
+    * The class only does the bookkeeping and never touches any OpenGL state.
+    */
+    class TileTextureResidency {
+    public:
+        struct FormatStatistics {
+            size_t numResidentTiles;
+            size_t residentBytes;
+        };
+
+        struct Statistics {
+            size_t budgetBytes;
+            size_t residentBytes;
+
+            /// Bytes of the pages added by the pools, including their free layers
+            size_t allocatedBytes;
+            size_t numResidentTiles;
+            size_t numPinnedTiles;
+
+            /// Number of tiles evicted to stay within the budget since creation
+            size_t numEvictions;
+            std::map<TileTextureFormat, FormatStatistics> formats;
+        };
+
+        typedef std::function<void()> EvictionCallback;
+
+        static const size_t DEFAULT_BUDGET_IN_BYTES = size_t(1024) * 1024 * 1024;
+
+        /**
+        * Creates the residency shared by all tile providers.
+        * \pre The residency must not have been initialized
+        */
+        static void initialize();
+
+        /**
+        * Destroys the shared residency without invoking any eviction callbacks.
+        * \pre The residency must have been initialized
+        */
+        static void deinitialize();
+
+        static bool isInitialized();
+
+        /**
+        * Returns the residency shared by all tile providers.
+        * \pre The residency must have been initialized
+        */
+        static TileTextureResidency& ref();
+
+        TileTextureResidency(size_t budgetInBytes = DEFAULT_BUDGET_IN_BYTES);
+
+        /**
+        * Registers a slot and evicts least recently used slots until the charged
+        * bytes are within the budget again. The new slot is never evicted by this
+        * call. Slots registered without an eviction callback are pinned and only stop
+        * being resident when they are released.
+        * \param page The array texture holding the slot. Slots in pages that were not
+        * added are charged with <code>numBytes</code>
+        */
+        void makeResident(const TileTextureSlot* slot, const TileTextureFormat& format,
+            size_t numBytes, EvictionCallback onEviction = EvictionCallback(),
+            GLuint page = 0);
+
+        /**
+        * Charges a page allocated by a pool against the budget. Slots registered in it
+        * afterwards are not charged separately. Does not evict anything, as the page
+        * is added before the slot that caused it is registered.
+        */
+        void addPage(GLuint page, size_t numBytes);
+
+        /**
+        * Stops charging a page, which is called when the pool deletes it.
+        */
+        void removePage(GLuint page);
+
+        /**
+        * Marks the slot as the most recently used one. Unknown slots are ignored.
+        */
+        void touch(const TileTextureSlot* slot);
+
+        /**
+        * Stops tracking the slot without invoking its eviction callback. Should be
+        * called when the slot is destroyed. Unknown slots are ignored.
+        */
+        void release(const TileTextureSlot* slot);
+
+        bool isResident(const TileTextureSlot* slot) const;
+
+        void setBudget(size_t budgetInBytes);
+        size_t residentBytes() const;
+        size_t allocatedBytes() const;
+        size_t numEvictions() const;
+
+        /**
+        * Collects statistics for all resident slots. Iterates over all slots, use
+        * <code>residentBytes</code> and <code>numEvictions</code> for per frame
+        * measurements.
+        */
+        Statistics statistics() const;
+
+    private:
+        struct Entry {
+            const TileTextureSlot* slot;
+            TileTextureFormat format;
+            size_t numBytes;
+            EvictionCallback onEviction;
+
+            /// 0 if the slot is not in an added page
+            GLuint page;
+        };
+
+        struct Page {
+            size_t numBytes;
+
+            /// Pages with pinned slots are never deleted and not worth evicting from
+            size_t numPinnedSlots;
+        };
+
+        /// The allocated bytes plus the bytes of the slots that are not in a page
+        size_t chargedBytes() const;
+
+        /**
+        * Returns the least recently used slot that can be evicted on its own or
+        * together with the other slots in its page, or the end of the list.
+        */
+        std::list<Entry>::iterator findEvictionCandidate();
+
+        void enforceBudget();
+        void erase(std::list<Entry>::iterator it);
+
+        /// Most recently used first
+        std::list<Entry> _entries;
+        std::unordered_map<const TileTextureSlot*, std::list<Entry>::iterator> _entryMap;
+
+        std::unordered_map<GLuint, Page> _pages;
+
+        size_t _budgetBytes;
+        size_t _residentBytes;
+        size_t _allocatedBytes;
+        size_t _unpagedBytes;
+        size_t _numEvictions;
+
+        static TileTextureResidency* _instance;
+    };
+
+} // namespace openspace
+
+#endif // __TILE_TEXTURE_RESIDENCY_H__
@@ -221,10 +221,11 @@ void DataProcessor::add(std::vector<std::vector<float>>& optionValues, std::vect
             _histograms[i] = newHist;
         }
 
+        std::vector<float> normalizedValues(numValues);
         for(int j=0; j<numValues; j++){
-            value = values[j];
-            _histograms[i]->add(normalizeWithStandardScore(value, mean, _standardDeviation[i], _histNormValues), 1);
+            normalizedValues[j] = normalizeWithStandardScore(values[j], mean, _standardDeviation[i], _histNormValues);
         }
+        _histograms[i]->add(normalizedValues, 0);
 
         _histograms[i]->generateEqualizer();
         
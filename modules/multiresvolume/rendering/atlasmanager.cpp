@@ -28,6 +28,7 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/opengl/texture.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <cassert>
@@ -35,11 +36,23 @@
 
 namespace {
     const std::string _loggerCat = "AtlasManager";
+
+    const unsigned int DefaultUploadBudget = 512;
+    const size_t DefaultCacheBudget = 512 * 1024 * 1024;
+    const unsigned int DefaultReadAheadTimesteps = 2;
+    const unsigned int NumberIoThreads = 2;
 }
 
 namespace openspace {
 
-AtlasManager::AtlasManager(TSP* tsp) : _tsp(tsp) {}
+AtlasManager::AtlasManager(TSP* tsp)
+    : _tsp(tsp)
+    , _uploadBudget(DefaultUploadBudget)
+    , _nReadAheadTimesteps(DefaultReadAheadTimesteps)
+    , _nUsedBricks(0)
+    , _nStreamedBricks(0)
+    , _nDiskReads(0)
+{}
 
 AtlasManager::~AtlasManager() {}
 
@@ -50,12 +63,12 @@ bool AtlasManager::initialize() {
     _nOtLeaves = _nBricksPerDim * _nBricksPerDim * _nBricksPerDim;
     _nOtNodes = _tsp->numOTNodes();
     _nOtLevels = log(_nOtLeaves)/log(8) + 1;
+    _nTimesteps = header.numTimesteps_;
     _paddedBrickDim = _tsp->paddedBrickDim();
     _nBricksInMap = _nBricksPerDim * _nBricksPerDim * _nBricksPerDim;
     _atlasDim = _nBricksPerDim * _paddedBrickDim;
     _nBrickVals = _paddedBrickDim*_paddedBrickDim*_paddedBrickDim;
     _brickSize = _nBrickVals * sizeof(float);
-    _volumeSize = _brickSize * _nOtLeaves;
     _atlasMap = std::vector<unsigned int>(_nOtLeaves, NOT_USED);
     _nBricksInAtlas = _nBricksInMap;
 
@@ -72,8 +85,18 @@ bool AtlasManager::initialize() {
         GL_FLOAT);
     _textureAtlas->uploadTexture();
 
+    // The pixel buffers only stage the bricks that are uploaded in a frame; their
+    // storage is allocated when they are filled
     glGenBuffers(2, _pboHandle);
 
+    _brickStreamer = std::make_unique<BrickStreamer>(
+        _tsp->filename(),
+        TSP::dataPosition(),
+        _nBrickVals,
+        DefaultCacheBudget,
+        NumberIoThreads
+    );
+
     glGenBuffers(1, &_atlasMapBuffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, _atlasMapBuffer);
     glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLint)*_nBricksInMap, NULL, GL_DYNAMIC_READ);
@@ -90,16 +113,82 @@ unsigned int AtlasManager::atlasMapBuffer() {
     return _atlasMapBuffer;
 }
 
-void AtlasManager::updateAtlas(BUFFER_INDEX bufferIndex, std::vector<int>& brickIndices) {
+void AtlasManager::updateAtlas(BUFFER_INDEX bufferIndex, std::vector<int>& brickIndices,
+                               int timestep)
+{
     int nBrickIndices = brickIndices.size();
 
-    _requiredBricks.clear();
-    for (int i = 0; i < nBrickIndices; i++) {
-        _requiredBricks.insert(brickIndices[i]);
+    _requiredBricks.assign(brickIndices.begin(), brickIndices.end());
+    std::sort(_requiredBricks.begin(), _requiredBricks.end());
+    _requiredBricks.erase(
+        std::unique(_requiredBricks.begin(), _requiredBricks.end()),
+        _requiredBricks.end()
+    );
+
+    std::vector<unsigned int> missingBricks;
+    for (unsigned int brick : _requiredBricks) {
+        if (!_brickMap.count(brick)) {
+            missingBricks.push_back(brick);
+        }
+    }
+    _brickStreamer->request(missingBricks);
+
+    if (timestep >= 0 && _nReadAheadTimesteps > 0) {
+        std::vector<unsigned int> upcomingBricks;
+        for (unsigned int t = 1; t <= _nReadAheadTimesteps; ++t) {
+            unsigned int upcomingTimestep = (timestep + t) % _nTimesteps;
+            for (unsigned int brick : _requiredBricks) {
+                unsigned int upcoming = brickForTimestep(brick, upcomingTimestep);
+                if (!_brickMap.count(upcoming)) {
+                    upcomingBricks.push_back(upcoming);
+                }
+            }
+        }
+        std::sort(upcomingBricks.begin(), upcomingBricks.end());
+        upcomingBricks.erase(
+            std::unique(upcomingBricks.begin(), upcomingBricks.end()),
+            upcomingBricks.end()
+        );
+        _brickStreamer->prefetch(upcomingBricks);
+    }
+
+    // Without any bricks in the atlas there is nothing to stand in for missing bricks
+    // and we have to wait for the disk once, but not for the prefetched bricks
+    bool isEmpty = _brickMap.empty();
+    if (isEmpty && !missingBricks.empty()) {
+        _brickStreamer->waitFor(missingBricks);
+    }
+
+    // Collect the bricks that have been loaded, within the budget for this frame
+    std::map<unsigned int, BrickStreamer::Brick> readyBricks;
+    for (unsigned int brick : missingBricks) {
+        if (!isEmpty && readyBricks.size() >= _uploadBudget) {
+            break;
+        }
+        BrickStreamer::Brick data = _brickStreamer->brick(brick);
+        if (data) {
+            readyBricks[brick] = std::move(data);
+        }
+    }
+
+    // Previously used bricks stay in the atlas where the required brick is not ready
+    std::vector<unsigned int> standInBricks;
+    if (_prevBrickIndices.size() == brickIndices.size()) {
+        for (int i = 0; i < nBrickIndices; i++) {
+            unsigned int brick = brickIndices[i];
+            if (!_brickMap.count(brick) && !readyBricks.count(brick) &&
+                _prevBrickIndices[i] >= 0)
+            {
+                standInBricks.push_back(_prevBrickIndices[i]);
+            }
+        }
     }
+    std::sort(standInBricks.begin(), standInBricks.end());
 
     for (unsigned int it : _prevRequiredBricks) {
-        if (!_requiredBricks.count(it)) {
+        if (!std::binary_search(_requiredBricks.begin(), _requiredBricks.end(), it) &&
+            !std::binary_search(standInBricks.begin(), standInBricks.end(), it))
+        {
             removeFromAtlas(it);
         }
     }
@@ -107,42 +196,75 @@ void AtlasManager::updateAtlas(BUFFER_INDEX bufferIndex, std::vector<int>& brick
     // Stats
     _nUsedBricks = _requiredBricks.size();
     _nStreamedBricks = 0;
-    _nDiskReads = 0;
-
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[bufferIndex]);
-    glBufferData(GL_PIXEL_UNPACK_BUFFER, _volumeSize, 0, GL_STREAM_DRAW);
-    float* mappedBuffer = reinterpret_cast<float*>(glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
-
-    if (!mappedBuffer) {
-        LERROR("Failed to map PBO");
-        std::cout << glGetError() << std::endl;
-        return;
-    }
-
-    for (auto itStart = _requiredBricks.begin(); itStart != _requiredBricks.end();) {
-        int firstBrick = *itStart;
-        int lastBrick = firstBrick;
+    _nDiskReads = _brickStreamer->popNumDiskReads();
+
+    if (!readyBricks.empty()) {
+        // Allocating new storage orphans the storage that the upload of the previous use
+        // of this buffer might still read from, so mapping it does not have to wait
+        const size_t stagingSize = readyBricks.size() * _brickSize;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[bufferIndex]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, stagingSize, NULL, GL_STREAM_DRAW);
+        float* mappedBuffer = reinterpret_cast<float*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER,
+            0,
+            stagingSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+        ));
+
+        if (!mappedBuffer) {
+            LERROR("Failed to map PBO");
+            std::cout << glGetError() << std::endl;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return;
+        }
 
-        auto itEnd = itStart;
-        for (itEnd++; itEnd != _requiredBricks.end() && *itEnd == lastBrick + 1; itEnd++) {
-            lastBrick = *itEnd;
+        // The bricks are staged back to back and copied to their atlas positions
+        std::vector<unsigned int> atlasCoords;
+        atlasCoords.reserve(readyBricks.size());
+        for (const std::pair<const unsigned int, BrickStreamer::Brick>& p : readyBricks) {
+            unsigned int coords;
+            if (addToAtlas(p.first, coords)) {
+                std::memcpy(
+                    mappedBuffer + atlasCoords.size() * _nBrickVals,
+                    p.second->data(),
+                    _brickSize
+                );
+                atlasCoords.push_back(coords);
+            }
         }
 
-        addToAtlas(firstBrick, lastBrick, mappedBuffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-        itStart = itEnd;
+        pboToAtlas(bufferIndex, atlasCoords);
     }
 
-    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-
+    // Remember which brick is shown at each position to use it as a stand-in. New
+    // positions have not shown any brick yet
+    _prevBrickIndices.resize(nBrickIndices, -1);
+    _prevRequiredBricks.clear();
     for (int i = 0; i < nBrickIndices; i++) {
-        _atlasMap[i] = _brickMap[brickIndices[i]];
+        unsigned int brick = brickIndices[i];
+        if (!_brickMap.count(brick) && _prevBrickIndices[i] >= 0 &&
+            _brickMap.count(_prevBrickIndices[i]))
+        {
+            brick = _prevBrickIndices[i];
+        }
+        auto it = _brickMap.find(brick);
+        if (it != _brickMap.end()) {
+            _atlasMap[i] = it->second;
+            _prevRequiredBricks.push_back(brick);
+        }
+        else {
+            _atlasMap[i] = NOT_USED;
+        }
+        _prevBrickIndices[i] = brick;
     }
-
-    std::swap(_prevRequiredBricks, _requiredBricks);
-
-    pboToAtlas(bufferIndex);
+    std::sort(_prevRequiredBricks.begin(), _prevRequiredBricks.end());
+    _prevRequiredBricks.erase(
+        std::unique(_prevRequiredBricks.begin(), _prevRequiredBricks.end()),
+        _prevRequiredBricks.end()
+    );
 
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, _atlasMapBuffer);
     GLint *to = (GLint*)glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_WRITE_ONLY);
@@ -152,88 +274,101 @@ void AtlasManager::updateAtlas(BUFFER_INDEX bufferIndex, std::vector<int>& brick
 
 }
 
-void AtlasManager::addToAtlas(int firstBrickIndex, int lastBrickIndex, float* mappedBuffer) {
-    while (_brickMap.count(firstBrickIndex) && firstBrickIndex <= lastBrickIndex) firstBrickIndex++;
-    while (_brickMap.count(lastBrickIndex) && lastBrickIndex >= firstBrickIndex) lastBrickIndex--;
-    if (lastBrickIndex < firstBrickIndex) return;
-    
-    int sequenceLength = lastBrickIndex - firstBrickIndex + 1;
-    float* sequenceBuffer = new float[sequenceLength*_nBrickVals];
-    size_t bufferSize = sequenceLength * _brickSize;
-
-    long long offset = TSP::dataPosition() + static_cast<long long>(firstBrickIndex) * static_cast<long long>(_brickSize);
-    _tsp->file().seekg(offset);
-    _tsp->file().read(reinterpret_cast<char*>(sequenceBuffer), bufferSize);
-    _nDiskReads++;
-
-    for (int brickIndex = firstBrickIndex; brickIndex <= lastBrickIndex; brickIndex++) {
-        if (!_brickMap.count(brickIndex)) {
-            unsigned int atlasCoords = _freeAtlasCoords.back();
-            _freeAtlasCoords.pop_back();
-            int level = _nOtLevels - floor(log((7.0 * (float(brickIndex % _nOtNodes)) + 1.0))/log(8)) - 1;
-            assert(atlasCoords <= 0x0FFFFFFF);
-            unsigned int atlasData = (level << 28) + atlasCoords;
-            _brickMap.insert(std::pair<unsigned int, unsigned int>(brickIndex, atlasData));
-            _nStreamedBricks++;
-            fillVolume(&sequenceBuffer[_nBrickVals*(brickIndex - firstBrickIndex)], mappedBuffer, atlasCoords);
-        }
+bool AtlasManager::addToAtlas(unsigned int brickIndex, unsigned int& atlasCoords) {
+    if (_brickMap.count(brickIndex)) {
+        return false;
     }
-
-    delete[] sequenceBuffer;
-}
-
-void AtlasManager::removeFromAtlas(int brickIndex) {
-    unsigned int atlasData = _brickMap[brickIndex];
-    unsigned int atlasCoords = atlasData & 0x0FFFFFFF;
-    _brickMap.erase(brickIndex);
-    _freeAtlasCoords.push_back(atlasCoords);
+    if (_freeAtlasCoords.empty()) {
+        LWARNING("No space left in the atlas for brick " << brickIndex);
+        return false;
+    }
+    atlasCoords = _freeAtlasCoords.back();
+    _freeAtlasCoords.pop_back();
+    int level = _nOtLevels - floor(log((7.0 * (float(brickIndex % _nOtNodes)) + 1.0))/log(8)) - 1;
+    assert(atlasCoords <= 0x0FFFFFFF);
+    unsigned int atlasData = (level << 28) + atlasCoords;
+    _brickMap.insert(std::pair<unsigned int, unsigned int>(brickIndex, atlasData));
+    _nStreamedBricks++;
+    return true;
 }
 
-void AtlasManager::fillVolume(float* in, float* out, unsigned int linearAtlasCoords) {
-    int x = linearAtlasCoords % _nBricksPerDim;
-    int y = (linearAtlasCoords / _nBricksPerDim) % _nBricksPerDim;
-    int z = linearAtlasCoords / _nBricksPerDim / _nBricksPerDim;
+unsigned int AtlasManager::brickForTimestep(unsigned int brickIndex,
+                                            unsigned int timestep) const
+{
+    // The BST nodes are stored level by level with the children of node n at 2n + 1 and
+    // 2n + 2. Every node splits its time span at the center like the brick selections,
+    // which also works for timestep counts that are not powers of two
+    unsigned int bstNode = brickIndex / _nOtNodes;
+    unsigned int otNode = brickIndex % _nOtNodes;
+
+    unsigned int level = 0;
+    while ((2u << level) - 1 <= bstNode) {
+        ++level;
+    }
 
+    unsigned int node = 0;
+    unsigned int lowT = 0;
+    unsigned int highT = _nTimesteps;
+    for (unsigned int l = 0; l < level; ++l) {
+        unsigned int centerT = lowT + (highT - lowT) / 2;
+        if (timestep >= centerT) {
+            node = 2 * node + 2;
+            lowT = centerT;
+        }
+        else {
+            node = 2 * node + 1;
+            highT = centerT;
+        }
+    }
+    return node * _nOtNodes + otNode;
+}
 
-    unsigned int xMin = x*_paddedBrickDim;
-    unsigned int yMin = y*_paddedBrickDim;
-    unsigned int zMin = z*_paddedBrickDim;
-    unsigned int xMax = xMin + _paddedBrickDim;
-    unsigned int yMax = yMin + _paddedBrickDim;
-    unsigned int zMax = zMin + _paddedBrickDim;
+void AtlasManager::setUploadBudget(unsigned int nBricks) {
+    _uploadBudget = nBricks;
+}
 
-    unsigned int from = 0;
-    for (unsigned int zValCoord = zMin; zValCoord<zMax; ++zValCoord) {
-        for (unsigned int yValCoord = yMin; yValCoord<yMax; ++yValCoord) {
-            for (unsigned int xValCoord = xMin; xValCoord<xMax; ++xValCoord) {
+void AtlasManager::setCacheBudget(size_t bytes) {
+    if (_brickStreamer) {
+        _brickStreamer->setCacheBudget(bytes);
+    }
+}
 
-                unsigned int idx =
-                    xValCoord +
-                    yValCoord*_atlasDim +
-                    zValCoord*_atlasDim*_atlasDim;
+void AtlasManager::setReadAheadTimesteps(unsigned int nTimesteps) {
+    _nReadAheadTimesteps = nTimesteps;
+}
 
-                out[idx] = in[from];
-                from++;
-            }
-        }
+void AtlasManager::removeFromAtlas(int brickIndex) {
+    auto it = _brickMap.find(brickIndex);
+    if (it == _brickMap.end()) {
+        return;
     }
+    unsigned int atlasCoords = it->second & 0x0FFFFFFF;
+    _brickMap.erase(it);
+    _freeAtlasCoords.push_back(atlasCoords);
 }
 
-void AtlasManager::pboToAtlas(BUFFER_INDEX bufferIndex) {
+void AtlasManager::pboToAtlas(BUFFER_INDEX bufferIndex,
+                              const std::vector<unsigned int>& atlasCoords)
+{
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[bufferIndex]);
-    glm::size3_t dim = _textureAtlas->dimensions();
     glBindTexture(GL_TEXTURE_3D, *_textureAtlas);
-    glTexSubImage3D(GL_TEXTURE_3D,  // target
-        0,                          // level
-        0,                          // xoffset
-        0,                          // yoffset
-        0,                          // zoffset
-        dim[0],                     // width
-        dim[1],                     // height
-        dim[2],                     // depth
-        GL_RED,                     // format
-        GL_FLOAT,                   // type
-        NULL);                      // *pixels
+    for (size_t i = 0; i < atlasCoords.size(); ++i) {
+        unsigned int x = atlasCoords[i] % _nBricksPerDim;
+        unsigned int y = (atlasCoords[i] / _nBricksPerDim) % _nBricksPerDim;
+        unsigned int z = atlasCoords[i] / _nBricksPerDim / _nBricksPerDim;
+        size_t offset = i * _brickSize;
+        glTexSubImage3D(GL_TEXTURE_3D,                       // target
+            0,                                               // level
+            x * _paddedBrickDim,                             // xoffset
+            y * _paddedBrickDim,                             // yoffset
+            z * _paddedBrickDim,                             // zoffset
+            _paddedBrickDim,                                 // width
+            _paddedBrickDim,                                 // height
+            _paddedBrickDim,                                 // depth
+            GL_RED,                                          // format
+            GL_FLOAT,                                        // type
+            reinterpret_cast<const GLvoid*>(offset));        // offset into the PBO
+    }
     glBindTexture(GL_TEXTURE_3D, 0);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
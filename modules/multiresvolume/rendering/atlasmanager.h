@@ -26,6 +26,7 @@
 #define __ATLASMANAGER_H__
 
 #include <modules/multiresvolume/rendering/tsp.h>
+#include <modules/multiresvolume/rendering/brickstreamer.h>
 #include <ghoul/glm.h>
 #include <glm/gtx/std_based_type.hpp>
 
@@ -33,7 +34,7 @@
 #include <vector>
 #include <climits>
 #include <map>
-#include <set>
+#include <memory>
 
 namespace ghoul {
     namespace opengl {
@@ -50,14 +51,34 @@ public:
     AtlasManager(TSP* tsp);
     ~AtlasManager();
 
-    void updateAtlas(BUFFER_INDEX bufferIndex, std::vector<int>& brickIndices);
-    void addToAtlas(int firstBrickIndex, int lastBrickIndex, float* mappedBuffer);
+    /**
+     * Updates the atlas with the bricks in \p brickIndices. Bricks that are not in the
+     * atlas yet are requested from the BrickStreamer; at most uploadBudget of the bricks
+     * that are loaded are copied into the atlas per call. Until a brick is available,
+     * the brick that was used previously for the same position stays in use. If
+     * \p timestep is not negative, the bricks that are likely to be needed for the
+     * following timesteps are prefetched.
+     */
+    void updateAtlas(BUFFER_INDEX bufferIndex, std::vector<int>& brickIndices,
+        int timestep = -1);
+    /**
+     * Reserves a position in the atlas for \p brickIndex and returns it in
+     * \p atlasCoords. Returns false if the brick is in the atlas already or the atlas
+     * is full.
+     */
+    bool addToAtlas(unsigned int brickIndex, unsigned int& atlasCoords);
     void removeFromAtlas(int brickIndex);
+
+    void setUploadBudget(unsigned int nBricks);
+    void setCacheBudget(size_t bytes);
+    void setReadAheadTimesteps(unsigned int nTimesteps);
     bool initialize();
     std::vector<unsigned int> atlasMap();
     unsigned int atlasMapBuffer();
 
-    void pboToAtlas(BUFFER_INDEX bufferIndex);
+    /// Copies the bricks staged in the pixel buffer to the \p atlasCoords, in order
+    void pboToAtlas(BUFFER_INDEX bufferIndex,
+        const std::vector<unsigned int>& atlasCoords);
     ghoul::opengl::Texture& textureAtlas();
     glm::size3_t textureSize();
 
@@ -73,8 +94,14 @@ private:
     std::vector<unsigned int> _atlasMap;
     std::map<unsigned int, unsigned int> _brickMap;
     std::vector<unsigned int> _freeAtlasCoords;
-    std::set<unsigned int> _requiredBricks;
-    std::set<unsigned int> _prevRequiredBricks;
+    // Sorted lists of the bricks in use by the current and previous frame
+    std::vector<unsigned int> _requiredBricks;
+    std::vector<unsigned int> _prevRequiredBricks;
+    std::vector<int> _prevBrickIndices;
+
+    std::unique_ptr<BrickStreamer> _brickStreamer;
+    unsigned int _uploadBudget;
+    unsigned int _nReadAheadTimesteps;
 
     ghoul::opengl::Texture* _textureAtlas;
 
@@ -87,15 +114,16 @@ private:
                  _nOtLeaves,
                  _nOtNodes,
                  _nOtLevels,
+                 _nTimesteps,
                  _brickSize,
                  _nBrickVals,
-                 _volumeSize,
                  _paddedBrickDim,
                  _nBricksInAtlas,
                  _nBricksInMap,
                  _atlasDim;
 
-    void fillVolume(float* in, float* out, unsigned int linearAtlasCoords);
+    /// Returns the brick that covers the same region as \p brickIndex at \p timestep
+    unsigned int brickForTimestep(unsigned int brickIndex, unsigned int timestep) const;
 };
 
 } // namespace openspace
@@ -0,0 +1,296 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/multiresvolume/rendering/brickcodec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const int HashBits = 14;
+    const size_t MinMatch = 4;
+    const size_t MaxOffset = 65535;
+
+    uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    void writeLength(size_t length, std::vector<uint8_t>& out) {
+        while (length >= 255) {
+            out.push_back(255);
+            length -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+        uint8_t b;
+        do {
+            if (ip == end) {
+                return false;
+            }
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+        return true;
+    }
+
+    void writeSequence(const uint8_t* literals, size_t nLiterals, size_t offset,
+                       size_t matchLength, std::vector<uint8_t>& out)
+    {
+        // Token: literal length in the high nibble, match length - MinMatch in the low
+        size_t matchCode = matchLength ? matchLength - MinMatch : 0;
+        uint8_t token = static_cast<uint8_t>(
+            (std::min<size_t>(nLiterals, 15) << 4) | std::min<size_t>(matchCode, 15)
+        );
+        out.push_back(token);
+        if (nLiterals >= 15) {
+            writeLength(nLiterals - 15, out);
+        }
+        out.insert(out.end(), literals, literals + nLiterals);
+        if (matchLength) {
+            out.push_back(static_cast<uint8_t>(offset & 0xFF));
+            out.push_back(static_cast<uint8_t>(offset >> 8));
+            if (matchCode >= 15) {
+                writeLength(matchCode - 15, out);
+            }
+        }
+    }
+
+    // Splits the bytes of 'n' elements of 'stride' bytes into 'stride' planes
+    void shuffle(const uint8_t* in, size_t n, size_t stride, uint8_t* out) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t b = 0; b < stride; ++b) {
+                out[b * n + i] = in[i * stride + b];
+            }
+        }
+    }
+
+    void unshuffle(const uint8_t* in, size_t n, size_t stride, uint8_t* out) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t b = 0; b < stride; ++b) {
+                out[i * stride + b] = in[b * n + i];
+            }
+        }
+    }
+} // namespace
+
+namespace openspace {
+namespace brickcodec {
+
+void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    std::vector<int64_t> table(size_t(1) << HashBits, -1);
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MinMatch <= size) {
+        uint32_t sequence = read32(data + i);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - HashBits);
+        int64_t reference = table[hash];
+        table[hash] = static_cast<int64_t>(i);
+
+        if (reference >= 0 && i - reference <= MaxOffset &&
+            read32(data + reference) == sequence)
+        {
+            size_t length = MinMatch;
+            while (i + length < size && data[reference + length] == data[i + length]) {
+                ++length;
+            }
+            writeSequence(data + anchor, i - anchor, i - reference, length, out);
+            i += length;
+            anchor = i;
+        }
+        else {
+            ++i;
+        }
+    }
+    // The last sequence only consists of literals
+    writeSequence(data + anchor, size - anchor, 0, 0, out);
+}
+
+bool decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize) {
+    const uint8_t* ip = data;
+    const uint8_t* end = data + size;
+    size_t op = 0;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t nLiterals = token >> 4;
+        if (nLiterals == 15 && !readLength(ip, end, nLiterals)) {
+            return false;
+        }
+        if (nLiterals > static_cast<size_t>(end - ip) || nLiterals > outSize - op) {
+            return false;
+        }
+        std::memcpy(out + op, ip, nLiterals);
+        ip += nLiterals;
+        op += nLiterals;
+
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t length = token & 0x0F;
+        if (length == 15 && !readLength(ip, end, length)) {
+            return false;
+        }
+        length += MinMatch;
+        if (offset == 0 || offset > op || length > outSize - op) {
+            return false;
+        }
+        // The regions may overlap, which repeats the last 'offset' bytes
+        for (size_t k = 0; k < length; ++k) {
+            out[op + k] = out[op - offset + k];
+        }
+        op += length;
+    }
+    return op == outSize;
+}
+
+void encode(const float* values, size_t nValues, Codec codec, std::vector<uint8_t>& out) {
+    out.push_back(static_cast<uint8_t>(codec));
+
+    std::vector<uint8_t> planes;
+    if (codec == Codec::Quantized16) {
+        float minValue = nValues ? *std::min_element(values, values + nValues) : 0.f;
+        float maxValue = nValues ? *std::max_element(values, values + nValues) : 0.f;
+        const uint8_t* minBytes = reinterpret_cast<const uint8_t*>(&minValue);
+        const uint8_t* maxBytes = reinterpret_cast<const uint8_t*>(&maxValue);
+        out.insert(out.end(), minBytes, minBytes + sizeof(float));
+        out.insert(out.end(), maxBytes, maxBytes + sizeof(float));
+
+        // Single precision would add rounding errors of the order of the bound itself
+        const double range = static_cast<double>(maxValue) - minValue;
+        const double scale = range > 0.0 ? 65535.0 / range : 0.0;
+        std::vector<uint16_t> deltas(nValues);
+        uint16_t previous = 0;
+        for (size_t i = 0; i < nValues; ++i) {
+            uint16_t q = static_cast<uint16_t>(
+                std::lround(std::min((values[i] - static_cast<double>(minValue)) * scale,
+                    65535.0))
+            );
+            deltas[i] = static_cast<uint16_t>(q - previous);
+            previous = q;
+        }
+        planes.resize(nValues * sizeof(uint16_t));
+        shuffle(
+            reinterpret_cast<const uint8_t*>(deltas.data()),
+            nValues,
+            sizeof(uint16_t),
+            planes.data()
+        );
+    }
+    else {
+        std::vector<uint32_t> deltas(nValues);
+        uint32_t previous = 0;
+        for (size_t i = 0; i < nValues; ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, values + i, sizeof(bits));
+            deltas[i] = bits ^ previous;
+            previous = bits;
+        }
+        planes.resize(nValues * sizeof(uint32_t));
+        shuffle(
+            reinterpret_cast<const uint8_t*>(deltas.data()),
+            nValues,
+            sizeof(uint32_t),
+            planes.data()
+        );
+    }
+    compress(planes.data(), planes.size(), out);
+}
+
+bool decode(const uint8_t* data, size_t size, float* values, size_t nValues) {
+    if (size < 1) {
+        return false;
+    }
+    Codec codec = static_cast<Codec>(data[0]);
+    ++data;
+    --size;
+
+    if (codec == Codec::Quantized16) {
+        if (size < 2 * sizeof(float)) {
+            return false;
+        }
+        float minValue;
+        float maxValue;
+        std::memcpy(&minValue, data, sizeof(float));
+        std::memcpy(&maxValue, data + sizeof(float), sizeof(float));
+        data += 2 * sizeof(float);
+        size -= 2 * sizeof(float);
+
+        std::vector<uint8_t> planes(nValues * sizeof(uint16_t));
+        if (!decompress(data, size, planes.data(), planes.size())) {
+            return false;
+        }
+        std::vector<uint16_t> deltas(nValues);
+        unshuffle(
+            planes.data(),
+            nValues,
+            sizeof(uint16_t),
+            reinterpret_cast<uint8_t*>(deltas.data())
+        );
+
+        const double step = (static_cast<double>(maxValue) - minValue) / 65535.0;
+        uint16_t q = 0;
+        for (size_t i = 0; i < nValues; ++i) {
+            q = static_cast<uint16_t>(q + deltas[i]);
+            values[i] = static_cast<float>(minValue + q * step);
+        }
+        return true;
+    }
+    else if (codec == Codec::Lossless) {
+        std::vector<uint8_t> planes(nValues * sizeof(uint32_t));
+        if (!decompress(data, size, planes.data(), planes.size())) {
+            return false;
+        }
+        std::vector<uint32_t> deltas(nValues);
+        unshuffle(
+            planes.data(),
+            nValues,
+            sizeof(uint32_t),
+            reinterpret_cast<uint8_t*>(deltas.data())
+        );
+
+        uint32_t bits = 0;
+        for (size_t i = 0; i < nValues; ++i) {
+            bits ^= deltas[i];
+            std::memcpy(values + i, &bits, sizeof(bits));
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace brickcodec
+} // namespace openspace
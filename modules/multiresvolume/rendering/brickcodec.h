@@ -0,0 +1,73 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __BRICKCODEC_H__
+#define __BRICKCODEC_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Encodes and decodes the bricks of compressed TSP files. Both codecs first turn the
+ * values of a brick into differences between neighboring voxels, split the result into
+ * byte planes, and compress these with a small LZ77 coder. The encoded data starts with
+ * the codec, so that decode does not need to know how a brick was encoded.
+ */
+namespace brickcodec {
+
+enum class Codec : uint8_t {
+    /// Exact reconstruction; the bit patterns of neighboring floats are xor-ed
+    Lossless = 0,
+    /// Values are quantized to 16 bits between the minimum and maximum of the brick. The
+    /// quantization is computed in double precision, so the error is bounded by
+    /// (max - min) / 131070 plus the rounding of the decoded value to a float, which is
+    /// half a unit in the last place of the largest magnitude in the brick
+    Quantized16 = 1
+};
+
+/// Appends the encoded \p nValues \p values to \p out
+void encode(const float* values, size_t nValues, Codec codec, std::vector<uint8_t>& out);
+
+/**
+ * Decodes the brick of \p size bytes at \p data into \p nValues \p values.
+ * \returns false if the data is corrupt or does not contain \p nValues values
+ */
+bool decode(const uint8_t* data, size_t size, float* values, size_t nValues);
+
+/// Appends the LZ77 compressed \p size bytes at \p data to \p out
+void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+/**
+ * Decompresses \p size bytes at \p data into exactly \p outSize bytes at \p out.
+ * \returns false if the data is corrupt
+ */
+bool decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
+
+} // namespace brickcodec
+} // namespace openspace
+
+#endif // __BRICKCODEC_H__
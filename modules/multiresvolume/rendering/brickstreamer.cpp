@@ -0,0 +1,346 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/multiresvolume/rendering/brickstreamer.h>
+
+#include <modules/multiresvolume/rendering/compressedtsp.h>
+
+#include <ghoul/logging/logmanager.h>
+
+#include <algorithm>
+
+namespace {
+    const std::string _loggerCat = "BrickStreamer";
+
+    // Longest run of bricks that is read in one go, to keep the granularity of the work
+    // fine enough for the other threads and for the requests of the next frame
+    const unsigned int MaxRunLength = 64;
+}
+
+namespace openspace {
+
+BrickStreamer::BrickStreamer(std::string filename, long long dataPosition,
+                             unsigned int nBrickValues, size_t cacheBudget,
+                             unsigned int nThreads)
+    : _filename(std::move(filename))
+    , _dataPosition(dataPosition)
+    , _nBrickValues(nBrickValues)
+    , _stop(false)
+    , _hasFailed(false)
+    , _nActiveRuns(0)
+    , _cacheSize(0)
+    , _cacheBudget(cacheBudget)
+    , _nDiskReads(0)
+    , _nLoadedBricks(0)
+{
+    std::ifstream file(_filename, std::ios::in | std::ios::binary);
+    compressedtsp::Header header;
+    if (compressedtsp::readIndex(file, header, _offsets)) {
+        if (header.nBrickValues != _nBrickValues) {
+            LERROR(
+                "'" << _filename << "' has " << header.nBrickValues <<
+                " values per brick instead of " << _nBrickValues
+            );
+        }
+    }
+    else {
+        _offsets.clear();
+    }
+
+    for (unsigned int i = 0; i < std::max(nThreads, 1u); ++i) {
+        _threads.emplace_back(&BrickStreamer::work, this);
+    }
+}
+
+BrickStreamer::~BrickStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    for (std::thread& t : _threads) {
+        t.join();
+    }
+}
+
+void BrickStreamer::enqueue(const std::vector<unsigned int>& bricks,
+                            std::deque<Run>& queue)
+{
+    if (_hasFailed) {
+        return;
+    }
+    bool hasRun = false;
+    Run run = { 0, 0 };
+    for (unsigned int b : bricks) {
+        if (_cache.count(b) || _pending.count(b) || _failed.count(b)) {
+            continue;
+        }
+        _pending.insert(b);
+
+        if (hasRun && b == run.last + 1 && run.last - run.first + 1 < MaxRunLength) {
+            run.last = b;
+        }
+        else {
+            if (hasRun) {
+                queue.push_back(run);
+            }
+            run = { b, b };
+            hasRun = true;
+        }
+    }
+    if (hasRun) {
+        queue.push_back(run);
+    }
+}
+
+void BrickStreamer::request(const std::vector<unsigned int>& bricks) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        enqueue(bricks, _requests);
+    }
+    _condition.notify_all();
+}
+
+void BrickStreamer::prefetch(const std::vector<unsigned int>& bricks) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const Run& run : _prefetches) {
+            for (unsigned int b = run.first; b <= run.last; ++b) {
+                _pending.erase(b);
+            }
+        }
+        _prefetches.clear();
+        enqueue(bricks, _prefetches);
+    }
+    _condition.notify_all();
+}
+
+BrickStreamer::Brick BrickStreamer::brick(unsigned int brickIndex) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _cache.find(brickIndex);
+    if (it == _cache.end()) {
+        return nullptr;
+    }
+    _lru.splice(_lru.begin(), _lru, it->second.lruPosition);
+    return it->second.data;
+}
+
+void BrickStreamer::setCacheBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cacheBudget = bytes;
+    evict();
+}
+
+size_t BrickStreamer::cacheBudget() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cacheBudget;
+}
+
+size_t BrickStreamer::cacheSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cacheSize;
+}
+
+bool BrickStreamer::isIdle() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending.empty() && _nActiveRuns == 0;
+}
+
+void BrickStreamer::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idleCondition.wait(lock, [this]() {
+        return _pending.empty() && _nActiveRuns == 0;
+    });
+}
+
+void BrickStreamer::waitFor(const std::vector<unsigned int>& bricks) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idleCondition.wait(lock, [this, &bricks]() {
+        return std::none_of(bricks.begin(), bricks.end(), [this](unsigned int b) {
+            return _pending.count(b) > 0;
+        });
+    });
+}
+
+bool BrickStreamer::isCompressed() const {
+    return !_offsets.empty();
+}
+
+bool BrickStreamer::hasFailed() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hasFailed;
+}
+
+bool BrickStreamer::hasFailed(unsigned int brickIndex) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _failed.count(brickIndex) > 0;
+}
+
+unsigned int BrickStreamer::popNumDiskReads() {
+    return _nDiskReads.exchange(0);
+}
+
+unsigned int BrickStreamer::popNumLoadedBricks() {
+    return _nLoadedBricks.exchange(0);
+}
+
+void BrickStreamer::evict() {
+    const size_t brickSize = _nBrickValues * sizeof(float);
+    // The most recently used brick is kept, even if it alone exceeds the budget
+    while (_cacheSize > _cacheBudget && _lru.size() > 1) {
+        _cache.erase(_lru.back());
+        _lru.pop_back();
+        _cacheSize -= brickSize;
+    }
+}
+
+void BrickStreamer::work() {
+    std::ifstream file(_filename, std::ios::in | std::ios::binary);
+    if (!file.good()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_hasFailed) {
+                LERROR("Could not open '" << _filename << "' for streaming");
+                _hasFailed = true;
+            }
+            // Nothing will ever be loaded, so release everyone who is waiting for it
+            _requests.clear();
+            _prefetches.clear();
+            _pending.clear();
+        }
+        _idleCondition.notify_all();
+        return;
+    }
+    const size_t brickSize = _nBrickValues * sizeof(float);
+
+    while (true) {
+        Run run;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() {
+                return _stop || !_requests.empty() || !_prefetches.empty();
+            });
+            if (_stop) {
+                return;
+            }
+            std::deque<Run>& queue = _requests.empty() ? _prefetches : _requests;
+            run = queue.front();
+            queue.pop_front();
+            ++_nActiveRuns;
+        }
+
+        std::vector<Brick> bricks;
+        bricks.reserve(run.last - run.first + 1);
+        if (isCompressed()) {
+            readCompressedRun(file, run, bricks);
+        }
+        else {
+            readRun(file, run, bricks);
+        }
+        ++_nDiskReads;
+        _nLoadedBricks += static_cast<unsigned int>(bricks.size());
+        const unsigned int firstFailed =
+            run.first + static_cast<unsigned int>(bricks.size());
+        if (firstFailed <= run.last) {
+            LERROR(
+                "Could not read bricks " << firstFailed << " to " << run.last <<
+                " from '" << _filename << "'"
+            );
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (unsigned int b = run.first; b <= run.last; ++b) {
+                _pending.erase(b);
+            }
+            // Failed bricks are remembered, so that they are not read again every frame
+            for (unsigned int b = firstFailed; b <= run.last; ++b) {
+                _failed.insert(b);
+            }
+            for (size_t i = 0; i < bricks.size(); ++i) {
+                unsigned int b = run.first + static_cast<unsigned int>(i);
+                _lru.push_front(b);
+                _cache[b] = { std::move(bricks[i]), _lru.begin() };
+                _cacheSize += brickSize;
+            }
+            evict();
+            --_nActiveRuns;
+        }
+        _idleCondition.notify_all();
+    }
+}
+
+void BrickStreamer::readRun(std::ifstream& file, const Run& run,
+                            std::vector<Brick>& bricks)
+{
+    const size_t brickSize = _nBrickValues * sizeof(float);
+    file.clear();
+    file.seekg(_dataPosition + static_cast<long long>(run.first) * brickSize);
+
+    // The bricks of a run are consecutive, so they are read one after the other straight
+    // into their own buffers. A run at the end of a truncated file still yields its
+    // complete bricks
+    for (unsigned int b = run.first; b <= run.last; ++b) {
+        auto data = std::make_shared<std::vector<float>>(_nBrickValues);
+        file.read(reinterpret_cast<char*>(data->data()), brickSize);
+        if (static_cast<size_t>(file.gcount()) != brickSize) {
+            return;
+        }
+        bricks.push_back(std::move(data));
+    }
+}
+
+void BrickStreamer::readCompressedRun(std::ifstream& file, const Run& run,
+                                      std::vector<Brick>& bricks)
+{
+    if (run.last + 1 >= _offsets.size()) {
+        return;
+    }
+    // The encoded bricks of a run are contiguous as well, so they are read at once
+    const uint64_t begin = _offsets[run.first];
+    std::vector<uint8_t> encoded(static_cast<size_t>(_offsets[run.last + 1] - begin));
+    file.clear();
+    file.seekg(begin);
+    file.read(reinterpret_cast<char*>(encoded.data()), encoded.size());
+    if (!file.good()) {
+        return;
+    }
+
+    for (unsigned int b = run.first; b <= run.last; ++b) {
+        auto data = std::make_shared<std::vector<float>>(_nBrickValues);
+        bool success = brickcodec::decode(
+            encoded.data() + (_offsets[b] - begin),
+            static_cast<size_t>(_offsets[b + 1] - _offsets[b]),
+            data->data(),
+            _nBrickValues
+        );
+        if (!success) {
+            LERROR("Could not decode brick " << b << " of '" << _filename << "'");
+            return;
+        }
+        bricks.push_back(std::move(data));
+    }
+}
+
+} // namespace openspace
@@ -0,0 +1,174 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __BRICKSTREAMER_H__
+#define __BRICKSTREAMER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Loads bricks of a TSP file on a pool of I/O threads so that the render thread never
+ * waits for the disk. Requested bricks are grouped into runs of consecutive indices,
+ * which are read with a single seek each, and the loaded bricks are kept in a cache
+ * that is bounded in bytes and evicts the least recently used bricks first. Bricks that
+ * are needed for the current frame are always loaded before bricks that are prefetched
+ * for upcoming timesteps. Compressed TSP files are detected automatically; their bricks
+ * are decoded on the I/O threads, so the cache always holds decoded bricks.
+ */
+class BrickStreamer {
+public:
+    using Brick = std::shared_ptr<const std::vector<float>>;
+
+    /**
+     * \param filename The TSP file to read from; each thread opens its own handle
+     * \param dataPosition The byte offset of the first brick in the file; ignored for
+     * compressed TSP files, which store the offsets of all bricks
+     * \param nBrickValues The number of floats per (padded) brick
+     * \param cacheBudget The maximum number of bytes of bricks kept in the cache
+     * \param nThreads The number of I/O threads
+     */
+    BrickStreamer(std::string filename, long long dataPosition, unsigned int nBrickValues,
+        size_t cacheBudget, unsigned int nThreads = 2);
+    ~BrickStreamer();
+
+    /**
+     * Requests the \p bricks, which must be sorted in ascending order, for the current
+     * frame. Bricks that are cached or already being loaded are ignored.
+     */
+    void request(const std::vector<unsigned int>& bricks);
+
+    /**
+     * Replaces all prefetch requests that have not been started yet with the sorted
+     * \p bricks. Prefetched bricks are only loaded if no requests are pending.
+     */
+    void prefetch(const std::vector<unsigned int>& bricks);
+
+    /// Returns the cached data of \p brickIndex, or nullptr if it is not loaded yet
+    Brick brick(unsigned int brickIndex);
+
+    void setCacheBudget(size_t bytes);
+    size_t cacheBudget() const;
+    /// Returns the number of bytes that are currently used by cached bricks
+    size_t cacheSize() const;
+
+    /// Returns true if no bricks are waiting to be loaded or being loaded
+    bool isIdle() const;
+
+    /// Blocks until all requested and prefetched bricks have been loaded
+    void waitUntilIdle();
+
+    /**
+     * Blocks until none of the \p bricks is waiting to be loaded or being loaded.
+     * Unlike waitUntilIdle, this does not wait for unrelated prefetches.
+     */
+    void waitFor(const std::vector<unsigned int>& bricks);
+
+    /// Returns true if the bricks are read from a compressed TSP file
+    bool isCompressed() const;
+
+    /**
+     * Returns true if the file could not be opened for streaming. A failed streamer
+     * ignores all requests and prefetches.
+     */
+    bool hasFailed() const;
+
+    /**
+     * Returns true if \p brickIndex could not be read or decoded. Failed bricks are
+     * not requested again.
+     */
+    bool hasFailed(unsigned int brickIndex) const;
+
+    /// Returns the number of read operations since the last call
+    unsigned int popNumDiskReads();
+    /// Returns the number of bricks that have been read since the last call
+    unsigned int popNumLoadedBricks();
+
+private:
+    struct Run {
+        unsigned int first;
+        unsigned int last;
+    };
+
+    struct CacheEntry {
+        Brick data;
+        std::list<unsigned int>::iterator lruPosition;
+    };
+
+    /// Adds runs for all bricks that are neither cached, pending nor failed. Requires the
+    /// lock
+    void enqueue(const std::vector<unsigned int>& bricks, std::deque<Run>& queue);
+    /// Evicts least recently used bricks until the cache fits its budget. Requires lock
+    void evict();
+    void work();
+    /// Reads the bricks of \p run from the uncompressed \p file with a single seek
+    void readRun(std::ifstream& file, const Run& run, std::vector<Brick>& bricks);
+    /// Reads and decodes the bricks of \p run from the compressed \p file
+    void readCompressedRun(std::ifstream& file, const Run& run,
+        std::vector<Brick>& bricks);
+
+    const std::string _filename;
+    const long long _dataPosition;
+    const unsigned int _nBrickValues;
+    /// The byte offsets of the bricks in a compressed file, or empty if uncompressed
+    std::vector<uint64_t> _offsets;
+
+    std::vector<std::thread> _threads;
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    std::condition_variable _idleCondition;
+    bool _stop;
+    bool _hasFailed;
+
+    std::deque<Run> _requests;
+    std::deque<Run> _prefetches;
+    std::unordered_set<unsigned int> _pending;
+    std::unordered_set<unsigned int> _failed;
+    unsigned int _nActiveRuns;
+
+    std::unordered_map<unsigned int, CacheEntry> _cache;
+    std::list<unsigned int> _lru;
+    size_t _cacheSize;
+    size_t _cacheBudget;
+
+    std::atomic<unsigned int> _nDiskReads;
+    std::atomic<unsigned int> _nLoadedBricks;
+};
+
+} // namespace openspace
+
+#endif // __BRICKSTREAMER_H__
@@ -0,0 +1,232 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/multiresvolume/rendering/budgetbrickselection.h>
+
+#include <modules/multiresvolume/rendering/tsp.h>
+
+#include <algorithm>
+
+namespace openspace {
+
+BudgetBrickSelection::BudgetBrickSelection(TSP* tsp, int memoryBudget,
+                                           int streamingBudget)
+    : _tsp(tsp)
+    , _memoryBudget(memoryBudget)
+    , _streamingBudget(streamingBudget)
+    , _isValid(false)
+    , _validLowT(0)
+    , _validHighT(0)
+    , _nBricksInMemory(0)
+    , _nStreamedBricks(0)
+{}
+
+void BudgetBrickSelection::setSplitPoints(std::vector<float> spatialPoints,
+                                          std::vector<float> temporalPoints)
+{
+    _spatialPoints = std::move(spatialPoints);
+    _temporalPoints = std::move(temporalPoints);
+    _isValid = false;
+}
+
+void BudgetBrickSelection::setMemoryBudget(int memoryBudget) {
+    if (memoryBudget != _memoryBudget) {
+        _memoryBudget = memoryBudget;
+        _isValid = false;
+    }
+}
+
+void BudgetBrickSelection::setStreamingBudget(int streamingBudget) {
+    if (streamingBudget != _streamingBudget) {
+        _streamingBudget = streamingBudget;
+        _isValid = false;
+    }
+}
+
+int BudgetBrickSelection::nBricksInMemory() const {
+    return _nBricksInMemory;
+}
+
+int BudgetBrickSelection::nStreamedBricks() const {
+    return _nStreamedBricks;
+}
+
+bool BudgetBrickSelection::selectBricks(int timestep, std::vector<int>& bricks) {
+    bool recompute = !_isValid || timestep < _validLowT || timestep >= _validHighT;
+    if (recompute) {
+        select(timestep);
+        _isValid = true;
+    }
+    bricks = _bricks;
+    return recompute;
+}
+
+float BudgetBrickSelection::splitPoints(unsigned int brickIndex,
+                                        BrickSelection::SplitType& splitType) const
+{
+    if (brickIndex >= _spatialPoints.size() || brickIndex >= _temporalPoints.size()) {
+        splitType = BrickSelection::SplitType::None;
+        return -1;
+    }
+
+    const float spatialPoints = _spatialPoints[brickIndex];
+    const float temporalPoints = _temporalPoints[brickIndex];
+    if (spatialPoints > 0 && spatialPoints > temporalPoints) {
+        splitType = BrickSelection::SplitType::Spatial;
+        return spatialPoints;
+    }
+    else if (temporalPoints > 0) {
+        splitType = BrickSelection::SplitType::Temporal;
+        return temporalPoints;
+    }
+    else {
+        splitType = BrickSelection::SplitType::None;
+        return -1;
+    }
+}
+
+void BudgetBrickSelection::select(int timestep) {
+    const int nTimesteps = _tsp->header().numTimesteps_;
+    const int nBricksPerAxis = _tsp->header().xNumBricks_;
+    const unsigned int nOtNodes = _tsp->numOTNodes();
+    const int totalStreamingBudget = _streamingBudget * nTimesteps;
+
+    _bricks.assign(nBricksPerAxis * nBricksPerAxis * nBricksPerAxis, 0);
+    _validLowT = 0;
+    _validHighT = nTimesteps;
+
+    std::vector<BrickSelection> priorityQueue;
+    auto enqueue = [&](const BrickSelection& bs) {
+        if (bs.splitType == BrickSelection::SplitType::None) {
+            writeSelection(bs);
+        }
+        else {
+            priorityQueue.push_back(bs);
+            std::push_heap(
+                priorityQueue.begin(),
+                priorityQueue.end(),
+                BrickSelection::compareSplitPoints
+            );
+        }
+    };
+
+    BrickSelection::SplitType rootSplitType;
+    float rootSplitPoints = splitPoints(0, rootSplitType);
+    enqueue(BrickSelection(nBricksPerAxis, nTimesteps, rootSplitType, rootSplitPoints));
+
+    int nBricksInMemory = 1;
+    int nStreamedBricks = 1;
+
+    while (!priorityQueue.empty()) {
+        std::pop_heap(
+            priorityQueue.begin(),
+            priorityQueue.end(),
+            BrickSelection::compareSplitPoints
+        );
+        BrickSelection bs = priorityQueue.back();
+        priorityQueue.pop_back();
+
+        const unsigned int bstNode = bs.brickIndex / nOtNodes;
+        const unsigned int otNode = bs.brickIndex % nOtNodes;
+        // Over the whole time period, this brick is streamed once per temporal split
+        const int nStreams = 1 << bs.nTemporalSplits;
+
+        if (bs.splitType == BrickSelection::SplitType::Spatial) {
+            // Splitting removes one brick and adds eight
+            const int newStreams = 7 * nStreams;
+            if (nBricksInMemory + 7 <= _memoryBudget &&
+                nStreamedBricks + newStreams <= totalStreamingBudget)
+            {
+                nBricksInMemory += 7;
+                nStreamedBricks += newStreams;
+
+                const unsigned int firstChild = bstNode * nOtNodes + 8 * otNode + 1;
+                for (unsigned int i = 0; i < 8; ++i) {
+                    BrickSelection::SplitType childSplitType;
+                    float childSplitPoints = splitPoints(firstChild + i, childSplitType);
+                    enqueue(bs.splitSpatially(
+                        i % 2, (i / 2) % 2, i / 4,
+                        firstChild + i,
+                        childSplitType,
+                        childSplitPoints
+                    ));
+                }
+            }
+            else {
+                // A temporal split of the same brick might still be affordable
+                bs.splitPoints = _temporalPoints[bs.brickIndex];
+                bs.splitType = bs.splitPoints > 0 ?
+                    BrickSelection::SplitType::Temporal :
+                    BrickSelection::SplitType::None;
+                enqueue(bs);
+            }
+        }
+        else {
+            // Splitting temporally doubles the streams of this brick
+            if (nStreamedBricks + nStreams <= totalStreamingBudget) {
+                nStreamedBricks += nStreams;
+
+                bool pickRightTimeChild = bs.timestepInRightChild(timestep);
+                unsigned int child =
+                    (2 * bstNode + (pickRightTimeChild ? 2 : 1)) * nOtNodes + otNode;
+                BrickSelection::SplitType childSplitType;
+                float childSplitPoints = splitPoints(child, childSplitType);
+                enqueue(bs.splitTemporally(
+                    pickRightTimeChild,
+                    child,
+                    childSplitType,
+                    childSplitPoints
+                ));
+            }
+            else {
+                bs.splitType = BrickSelection::SplitType::None;
+                enqueue(bs);
+            }
+        }
+    }
+
+    _nBricksInMemory = nBricksInMemory;
+    _nStreamedBricks = nStreamedBricks;
+}
+
+void BudgetBrickSelection::writeSelection(const BrickSelection& selection) {
+    const TSP::Header& header = _tsp->header();
+    const BrickCover& cover = selection.cover;
+    for (int z = cover.lowZ; z < cover.highZ; z++) {
+        for (int y = cover.lowY; y < cover.highY; y++) {
+            for (int x = cover.lowX; x < cover.highX; x++) {
+                int index = x + (header.xNumBricks_ * y) +
+                    (header.xNumBricks_ * header.yNumBricks_ * z);
+                _bricks[index] = selection.brickIndex;
+            }
+        }
+    }
+
+    // Any other timestep in the time span of all selected bricks leads to the same
+    // temporal splits and therefore the same selection
+    _validLowT = std::max(_validLowT, selection.lowT);
+    _validHighT = std::min(_validHighT, selection.highT);
+}
+
+} // namespace openspace
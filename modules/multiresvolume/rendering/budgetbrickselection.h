@@ -0,0 +1,95 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __BUDGETBRICKSELECTION_H__
+#define __BUDGETBRICKSELECTION_H__
+
+#include <modules/multiresvolume/rendering/brickselection.h>
+
+#include <vector>
+
+namespace openspace {
+
+class TSP;
+
+/**
+ * Selects the bricks of a TSP tree by greedily performing the splits that gain the most
+ * points, while honoring both the memory budget (the number of bricks in the selection)
+ * and the streaming budget (the number of bricks that have to be streamed over all
+ * timesteps). If a spatial split is not affordable, a temporal split of the same brick is
+ * tried instead, and the selection continues with the next best split, so a single pass
+ * fills both budgets as far as possible.
+ *
+ * The split points are set whenever the brick errors change. The selection depends on
+ * the timestep only through the temporal splits, so it is reused as long as the timestep
+ * stays within the time span of all selected bricks and neither the split points nor the
+ * budgets change.
+ */
+class BudgetBrickSelection {
+public:
+    BudgetBrickSelection(TSP* tsp, int memoryBudget, int streamingBudget);
+
+    /**
+     * Sets the points gained by splitting each brick spatially and temporally; negative
+     * points mark bricks that can not be split in that way.
+     */
+    void setSplitPoints(std::vector<float> spatialPoints,
+        std::vector<float> temporalPoints);
+
+    void setMemoryBudget(int memoryBudget);
+    void setStreamingBudget(int streamingBudget);
+
+    /**
+     * Writes the brick index for each position of the finest grid into \p bricks.
+     * \returns true if the selection had to be recomputed for \p timestep
+     */
+    bool selectBricks(int timestep, std::vector<int>& bricks);
+
+    /// Returns the number of bricks in the last selection
+    int nBricksInMemory() const;
+    /// Returns the number of streamed bricks over all timesteps for the last selection
+    int nStreamedBricks() const;
+
+private:
+    void select(int timestep);
+    float splitPoints(unsigned int brickIndex, BrickSelection::SplitType& splitType) const;
+    void writeSelection(const BrickSelection& selection);
+
+    TSP* _tsp;
+    int _memoryBudget;
+    int _streamingBudget;
+    std::vector<float> _spatialPoints;
+    std::vector<float> _temporalPoints;
+
+    bool _isValid;
+    int _validLowT;
+    int _validHighT;
+    std::vector<int> _bricks;
+    int _nBricksInMemory;
+    int _nStreamedBricks;
+};
+
+} // namespace openspace
+
+#endif // __BUDGETBRICKSELECTION_H__
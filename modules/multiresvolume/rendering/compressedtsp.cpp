@@ -0,0 +1,204 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/multiresvolume/rendering/compressedtsp.h>
+
+#include <modules/multiresvolume/rendering/tsp.h>
+#include <openspace/util/mappedfile.h>
+#include <openspace/util/taskgraph.h>
+
+#include <ghoul/logging/logmanager.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace {
+    const std::string _loggerCat = "CompressedTSP";
+
+    // Number of bricks that are written to disk at once. Only NumBatchBuffers batches
+    // are encoded at any time, which bounds the memory that is needed for the encoded
+    // data
+    const unsigned int BatchSize = 1024;
+    const unsigned int NumBatchBuffers = 2;
+
+    // Number of bricks that are encoded by one task
+    const unsigned int TaskSize = 64;
+}
+
+namespace openspace {
+namespace compressedtsp {
+
+bool isCompressed(const std::string& filename) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    uint32_t magic = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    return file.good() && magic == Magic;
+}
+
+bool readIndex(std::istream& file, Header& header, std::vector<uint64_t>& offsets) {
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+    if (!file.good() || header.magic != Magic) {
+        return false;
+    }
+    if (header.version != Version) {
+        LERROR("Unsupported compressed TSP version " << header.version);
+        return false;
+    }
+
+    file.seekg(tspHeaderPosition() + sizeof(TSP::Header));
+    offsets.resize(static_cast<size_t>(header.nBricks) + 1);
+    file.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    return file.good();
+}
+
+long long tspHeaderPosition() {
+    return sizeof(Header);
+}
+
+bool compress(const std::string& tspFilename, const std::string& filename,
+              brickcodec::Codec codec, const std::function<void(float)>& onProgress)
+{
+    TSP tsp(tspFilename);
+    if (!tsp.readHeader()) {
+        LERROR("Could not read the header of '" << tspFilename << "'");
+        return false;
+    }
+    if (tsp.isCompressed()) {
+        LERROR("'" << tspFilename << "' is already compressed");
+        return false;
+    }
+
+    const unsigned int nBricks = tsp.numTotalNodes();
+    const unsigned int paddedDim = tsp.paddedBrickDim();
+    const unsigned int nBrickValues = paddedDim * paddedDim * paddedDim;
+
+    MappedFile input(tspFilename);
+    size_t requiredSize = static_cast<size_t>(TSP::dataPosition()) +
+        static_cast<size_t>(nBricks) * nBrickValues * sizeof(float);
+    if (!input.isValid() || input.size() < requiredSize) {
+        LERROR("Could not map the brick data of '" << tspFilename << "'");
+        return false;
+    }
+    const float* bricks = reinterpret_cast<const float*>(
+        input.data() + TSP::dataPosition()
+    );
+
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.good()) {
+        LERROR("Could not open '" << filename << "' for writing");
+        return false;
+    }
+
+    Header header = {
+        Magic,
+        Version,
+        static_cast<uint32_t>(codec),
+        nBrickValues,
+        nBricks
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(&tsp.header()), sizeof(TSP::Header));
+
+    // The offsets are written once all bricks are encoded
+    const long long offsetsPosition = file.tellp();
+    std::vector<uint64_t> offsets(static_cast<size_t>(nBricks) + 1);
+    file.write(
+        reinterpret_cast<const char*>(offsets.data()),
+        offsets.size() * sizeof(uint64_t)
+    );
+    uint64_t position = static_cast<uint64_t>(file.tellp());
+
+    // All bricks are encoded by a single task graph. The bricks of a batch are written
+    // in order by a task that depends on the encoding of the batch and on the write of
+    // the previous batch. A batch reuses the buffers of an earlier batch, so it is only
+    // encoded once that batch has been written
+    const unsigned int nBatches = (nBricks + BatchSize - 1) / BatchSize;
+    std::vector<std::vector<std::vector<uint8_t>>> encoded(
+        NumBatchBuffers,
+        std::vector<std::vector<uint8_t>>(BatchSize)
+    );
+    TaskGraph tasks;
+    std::vector<TaskGraph::TaskId> writes;
+    for (unsigned int batch = 0; batch < nBatches; ++batch) {
+        const unsigned int first = batch * BatchSize;
+        const unsigned int n = std::min(BatchSize, nBricks - first);
+        std::vector<std::vector<uint8_t>>* buffer = &encoded[batch % NumBatchBuffers];
+
+        std::vector<TaskGraph::TaskId> bufferWritten;
+        if (batch >= NumBatchBuffers) {
+            bufferWritten.push_back(writes[batch - NumBatchBuffers]);
+        }
+
+        std::vector<TaskGraph::TaskId> batchEncoded;
+        for (unsigned int begin = 0; begin < n; begin += TaskSize) {
+            const unsigned int end = std::min(begin + TaskSize, n);
+            batchEncoded.push_back(tasks.addTask([&, buffer, first, begin, end]() {
+                for (unsigned int i = begin; i < end; ++i) {
+                    (*buffer)[i].clear();
+                    brickcodec::encode(
+                        bricks + static_cast<size_t>(first + i) * nBrickValues,
+                        nBrickValues,
+                        codec,
+                        (*buffer)[i]
+                    );
+                }
+            }, bufferWritten));
+        }
+        if (!writes.empty()) {
+            batchEncoded.push_back(writes.back());
+        }
+
+        writes.push_back(tasks.addTask([&, buffer, first, n]() {
+            for (unsigned int i = 0; i < n; ++i) {
+                offsets[first + i] = position;
+                file.write(
+                    reinterpret_cast<const char*>((*buffer)[i].data()),
+                    (*buffer)[i].size()
+                );
+                position += (*buffer)[i].size();
+            }
+            if (onProgress) {
+                onProgress(static_cast<float>(first + n) / nBricks);
+            }
+        }, batchEncoded));
+    }
+    tasks.run();
+
+    offsets[nBricks] = position;
+
+    file.seekp(offsetsPosition);
+    file.write(
+        reinterpret_cast<const char*>(offsets.data()),
+        offsets.size() * sizeof(uint64_t)
+    );
+    if (!file.good()) {
+        LERROR("Could not write '" << filename << "'");
+        return false;
+    }
+    return true;
+}
+
+} // namespace compressedtsp
+} // namespace openspace
@@ -0,0 +1,83 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __COMPRESSEDTSP_H__
+#define __COMPRESSEDTSP_H__
+
+#include <modules/multiresvolume/rendering/brickcodec.h>
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * A compressed TSP file starts with a compressedtsp::Header, followed by the header of
+ * the original TSP file and the nBricks + 1 byte offsets of the encoded bricks, measured
+ * from the start of the file. The bricks are stored in the same order as in the
+ * original file, so brick i occupies the bytes [offsets[i], offsets[i + 1]). A TSP
+ * instance reads the tree structure from either kind of file.
+ */
+namespace compressedtsp {
+
+const uint32_t Magic = 0x50535443; // "CTSP"
+const uint32_t Version = 1;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t codec;
+    uint32_t nBrickValues;
+    uint64_t nBricks;
+};
+
+/// Returns true if \p filename starts with the header of a compressed TSP file
+bool isCompressed(const std::string& filename);
+
+/**
+ * Reads the compressedtsp::Header of \p file into \p header and the brick offsets into
+ * \p offsets. Afterwards the \p file is positioned at the first encoded brick.
+ * \returns false if \p file is not a compressed TSP file of a supported version
+ */
+bool readIndex(std::istream& file, Header& header, std::vector<uint64_t>& offsets);
+
+/// Returns the position of the original TSP header within a compressed TSP file
+long long tspHeaderPosition();
+
+/**
+ * Encodes all bricks of the TSP file \p tspFilename with \p codec on all available cores
+ * and writes the compressed file to \p filename. \p onProgress is called with the
+ * fraction of bricks that have been written, one call at a time but not necessarily on
+ * the calling thread.
+ */
+bool compress(const std::string& tspFilename, const std::string& filename,
+    brickcodec::Codec codec, const std::function<void(float)>& onProgress = nullptr);
+
+} // namespace compressedtsp
+} // namespace openspace
+
+#endif // __COMPRESSEDTSP_H__
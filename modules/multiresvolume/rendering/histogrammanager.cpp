@@ -71,11 +71,7 @@ bool HistogramManager::buildHistogram(TSP* tsp, unsigned int brickIndex) {
     if (isBstLeaf && isOctreeLeaf) {
         // TSP leaf, read from file and build histogram
         std::vector<float> voxelValues = readValues(tsp, brickIndex);
-        unsigned int numVoxels = voxelValues.size();
-
-        for (unsigned int v = 0; v < numVoxels; ++v) {
-            histogram.add(voxelValues[v], 1.0);
-        }
+        histogram.add(voxelValues);
     } else {
         // Has children
         auto children = std::vector<unsigned int>();
@@ -99,6 +99,9 @@ RenderableMultiresVolume::RenderableMultiresVolume (const ghoul::Dictionary& dic
     , _currentTime("currentTime", "Current Time", 0, 0, 0)
     , _memoryBudget("memoryBudget", "Memory Budget", 0, 0, 0)
     , _streamingBudget("streamingBudget", "Streaming Budget", 0, 0, 0)
+    , _uploadBudget("uploadBudget", "Bricks Uploaded per Frame", 512, 1, 16384)
+    , _brickCacheSize("brickCacheSize", "Brick Cache Size (MB)", 512, 16, 16384)
+    , _readAheadTimesteps("readAheadTimesteps", "Read-ahead Timesteps", 2, 0, 16)
     , _useGlobalTime("useGlobalTime", "Global Time", false)
     , _loop("loop", "Loop", false)
     , _selectorName("selector", "Brick Selector")
@@ -338,6 +341,19 @@ bool RenderableMultiresVolume::initialize() {
     addProperty(_memoryBudget);
     addProperty(_streamingBudget);
 
+    _uploadBudget.onChange([this]() {
+        _atlasManager->setUploadBudget(_uploadBudget);
+    });
+    _brickCacheSize.onChange([this]() {
+        _atlasManager->setCacheBudget(static_cast<size_t>(_brickCacheSize) * 1024 * 1024);
+    });
+    _readAheadTimesteps.onChange([this]() {
+        _atlasManager->setReadAheadTimesteps(_readAheadTimesteps);
+    });
+    addProperty(_uploadBudget);
+    addProperty(_brickCacheSize);
+    addProperty(_readAheadTimesteps);
+
     if (success) {
         _brickIndices.resize(maxNumBricks, 0);
         success &= setSelectorType(_selector);
@@ -383,6 +399,10 @@ bool RenderableMultiresVolume::initializeSelector() {
     int nHistograms = 50;
     bool success = true;
 
+    // Histograms are built from uncompressed bricks, so for compressed files they have
+    // to be provided through the cache or the scene data
+    const bool canBuildHistograms = !_tsp->isCompressed();
+
     switch (_selector) {
         case Selector::TF:
             if (_errorHistogramManager) {
@@ -403,6 +423,9 @@ bool RenderableMultiresVolume::initializeSelector() {
                     // Read histograms from scene data.
                     LINFO("Loading histograms from scene data: " << _errorHistogramsPath);
                     success &= _errorHistogramManager->loadFromFile(_errorHistogramsPath);
+                } else if (!canBuildHistograms) {
+                    LERROR("Cannot build histograms from compressed " << _filename);
+                    success = false;
                 } else {
                     // Build histograms from tsp file.
                     LWARNING("Failed to open " << cacheFilename);
@@ -429,6 +452,9 @@ bool RenderableMultiresVolume::initializeSelector() {
                     cacheFile.close();
                     LINFO("Loading histograms from " << cacheFilename);
                     success &= _histogramManager->loadFromFile(cacheFilename);
+                } else if (!canBuildHistograms) {
+                    LERROR("Cannot build histograms from compressed " << _filename);
+                    success = false;
                 } else {
                     // Build histograms from tsp file.
                     LWARNING("Failed to open " << cacheFilename);
@@ -455,6 +481,9 @@ bool RenderableMultiresVolume::initializeSelector() {
                     cacheFile.close();
                     LINFO("Loading histograms from " << cacheFilename);
                     success &= _localErrorHistogramManager->loadFromFile(cacheFilename);
+                } else if (!canBuildHistograms) {
+                    LERROR("Cannot build histograms from compressed " << _filename);
+                    success = false;
                 } else {
                     // Build histograms from tsp file.
                     LWARNING("Failed to open " << cacheFilename);
@@ -616,7 +645,12 @@ void RenderableMultiresVolume::update(const UpdateData& data) {
             uploadStart = selectionEnd;
         }
 
-        _atlasManager->updateAtlas(AtlasManager::EVEN, _brickIndices);
+        // Only prefetch upcoming timesteps while the timesteps are advancing
+        _atlasManager->updateAtlas(
+            AtlasManager::EVEN,
+            _brickIndices,
+            (_loop || _useGlobalTime) ? currentTimestep : -1
+        );
 
         if (_gatheringStats) {
             std::chrono::system_clock::time_point uploadEnd = std::chrono::system_clock::now();
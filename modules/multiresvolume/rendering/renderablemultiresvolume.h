@@ -100,6 +100,9 @@ private:
     properties::IntProperty _currentTime; // used to vary time, if not using global time nor looping
     properties::IntProperty _memoryBudget;
     properties::IntProperty _streamingBudget;
+    properties::IntProperty _uploadBudget;
+    properties::IntProperty _brickCacheSize; // in MB
+    properties::IntProperty _readAheadTimesteps;
     properties::FloatProperty _stepSizeCoefficient;
     properties::StringProperty _selectorName;
     properties::BoolProperty _statsToFile;
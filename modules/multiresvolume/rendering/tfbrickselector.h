@@ -26,9 +26,9 @@
 #define __TFBRICKSELECTOR_H__
 
 #include <vector>
-#include <modules/multiresvolume/rendering/brickselection.h>
 #include <modules/multiresvolume/rendering/brickselector.h>
-#include <modules/multiresvolume/rendering/brickcover.h>
+#include <modules/multiresvolume/rendering/budgetbrickselection.h>
+#include <modules/multiresvolume/rendering/tfgradientcache.h>
 
 
 namespace openspace {
@@ -48,6 +48,11 @@ public:
     void selectBricks(int timestep, std::vector<int>& bricks);
     void setMemoryBudget(int memoryBudget);
     void setStreamingBudget(int streamingBudget);
+
+    /**
+     * Updates the brick errors after a change of the transfer function. If only a part
+     * of the transfer function changed, only the contribution of that part is updated.
+     */
     bool calculateBrickErrors();
  private:
 
@@ -55,15 +60,14 @@ public:
     ErrorHistogramManager* _histogramManager;
     TransferFunction* _transferFunction;
     std::vector<float> _brickErrors;
-    float spatialSplitPoints(unsigned int brickIndex);
-    float temporalSplitPoints(unsigned int brickIndex);
-    float splitPoints(unsigned int brickIndex, BrickSelection::SplitType& splitType);
 
-    int linearCoords(int x, int y, int z);
-    void writeSelection(BrickSelection coveredBricks, std::vector<int>& bricks);
+    TfGradientCache _gradients;
+    BudgetBrickSelection _selection;
 
-    int _memoryBudget;
-    int _streamingBudget;
+    float spatialSplitPoints(unsigned int brickIndex);
+    float temporalSplitPoints(unsigned int brickIndex);
+    /// Passes the split points of all bricks on to the selection
+    void updateSplitPoints();
     
 };
 
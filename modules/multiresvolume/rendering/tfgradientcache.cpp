@@ -0,0 +1,137 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/multiresvolume/rendering/tfgradientcache.h>
+
+#include <openspace/rendering/transferfunction.h>
+#include <openspace/util/histogram.h>
+
+#include <cassert>
+
+namespace {
+    // Partial updates accumulate rounding errors, so the errors are recalculated
+    // after this many of them
+    const unsigned int MaxPartialUpdates = 16;
+}
+
+namespace openspace {
+
+TfGradientCache::TfGradientCache()
+    : _firstChangedBin(0)
+    , _endChangedBin(0)
+    , _nPartialUpdates(0)
+{}
+
+TfGradientCache::Update TfGradientCache::update(TransferFunction& transferFunction) {
+    std::vector<glm::vec4> samples(transferFunction.width());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = transferFunction.sample(i);
+    }
+    return update(samples);
+}
+
+TfGradientCache::Update TfGradientCache::update(const std::vector<glm::vec4>& samples) {
+    std::vector<float> gradients(samples.empty() ? 0 : samples.size() - 1);
+    for (size_t i = 0; i < gradients.size(); ++i) {
+        const glm::vec4& prevRgba = samples[i];
+        const glm::vec4& nextRgba = samples[i + 1];
+
+        float colorDifference = glm::distance(prevRgba, nextRgba);
+        float alpha = (prevRgba.w + nextRgba.w) * 0.5f;
+        gradients[i] = colorDifference * alpha;
+    }
+
+    Update result = Update::Full;
+    if (gradients.size() == _gradients.size()) {
+        size_t first = 0;
+        while (first < gradients.size() && gradients[first] == _gradients[first]) {
+            ++first;
+        }
+        size_t end = gradients.size();
+        while (end > first && gradients[end - 1] == _gradients[end - 1]) {
+            --end;
+        }
+
+        if (first == end) {
+            result = Update::None;
+        }
+        else if (2 * (end - first) <= gradients.size() &&
+                 _nPartialUpdates < MaxPartialUpdates)
+        {
+            result = Update::Partial;
+            _gradientChanges.assign(gradients.size(), 0.f);
+            for (size_t i = first; i < end; ++i) {
+                _gradientChanges[i] = gradients[i] - _gradients[i];
+            }
+        }
+        _firstChangedBin = first;
+        _endChangedBin = end;
+    }
+    else {
+        _firstChangedBin = 0;
+        _endChangedBin = gradients.size();
+    }
+
+    // Only a full update removes the drift accumulated by the partial ones
+    if (result == Update::Partial) {
+        ++_nPartialUpdates;
+    }
+    else if (result == Update::Full) {
+        _nPartialUpdates = 0;
+        _firstChangedBin = 0;
+        _endChangedBin = gradients.size();
+    }
+    _gradients = std::move(gradients);
+    return result;
+}
+
+float TfGradientCache::error(const Histogram& histogram) const {
+    // The bins of the transfer function are one more than the gradients
+    const float tfWidth = static_cast<float>(_gradients.size() + 1);
+    float error = 0;
+    for (size_t i = 0; i < _gradients.size(); ++i) {
+        float x = (i + 0.5f) / tfWidth;
+        float sample = histogram.interpolate(x);
+        assert(sample >= 0);
+        assert(_gradients[i] >= 0);
+        error += sample * _gradients[i];
+    }
+    return error;
+}
+
+float TfGradientCache::errorChange(const Histogram& histogram) const {
+    const float tfWidth = static_cast<float>(_gradients.size() + 1);
+    float change = 0;
+    for (size_t i = _firstChangedBin; i < _endChangedBin; ++i) {
+        float x = (i + 0.5f) / tfWidth;
+        change += histogram.interpolate(x) * _gradientChanges[i];
+    }
+    return change;
+}
+
+size_t TfGradientCache::nChangedBins() const {
+    return _endChangedBin - _firstChangedBin;
+}
+
+} // namespace openspace
@@ -0,0 +1,76 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __TFGRADIENTCACHE_H__
+#define __TFGRADIENTCACHE_H__
+
+#include <ghoul/glm.h>
+
+#include <vector>
+
+namespace openspace {
+
+class Histogram;
+class TransferFunction;
+
+/**
+ * Keeps the weighted color gradients of a transfer function between its updates. The
+ * transfer function dependent brick errors are sums of histogram samples weighted by
+ * these gradients, so after a local edit of the transfer function, the errors only have
+ * to be corrected for the bins whose gradients changed.
+ */
+class TfGradientCache {
+public:
+    enum class Update {
+        None,    ///< No gradient changed, the errors remain valid
+        Partial, ///< The errors can be corrected with errorChange
+        Full     ///< The errors have to be recalculated with error
+    };
+
+    TfGradientCache();
+
+    /// Samples the \p transferFunction and returns how the errors have to be updated
+    Update update(TransferFunction& transferFunction);
+    /// Updates the gradients from the \p samples of a transfer function
+    Update update(const std::vector<glm::vec4>& samples);
+
+    /// Returns the sum of the samples of \p histogram weighted by the gradients
+    float error(const Histogram& histogram) const;
+    /// Returns the change of error for \p histogram caused by the last Partial update
+    float errorChange(const Histogram& histogram) const;
+
+    /// Returns the number of bins that changed in the last update
+    size_t nChangedBins() const;
+
+private:
+    std::vector<float> _gradients;
+    std::vector<float> _gradientChanges;
+    size_t _firstChangedBin;
+    size_t _endChangedBin;
+    unsigned int _nPartialUpdates;
+};
+
+} // namespace openspace
+
+#endif // __TFGRADIENTCACHE_H__
@@ -25,16 +25,24 @@
 //#include <sgct.h>
 #include <modules/multiresvolume/rendering/tsp.h>
 
+#include <modules/multiresvolume/rendering/compressedtsp.h>
+
 // ghoul
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/glm.h>
 
+#include <openspace/util/mappedfile.h>
+#include <openspace/util/taskgraph.h>
+
 // std
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <math.h>
 #include <queue>
+#include <thread>
 
 namespace {
     const std::string _loggerCat = "TSP";
@@ -44,6 +52,7 @@ namespace openspace {
 
 TSP::TSP(const std::string& filename)
     : _filename(filename)
+    , _isCompressed(false)
     , _dataSSBO(0)
     , paddedBrickDim_(0)
     , numTotalNodes_(0)
@@ -82,19 +91,13 @@ bool TSP::load() {
             return false;
         }
 
-        if (false) {
-            if (!calculateSpatialError()) {
-                LERROR("Could not calculate spatial error");
-                return false;
-            }
-            if (!calculateTemporalError()) {
-                LERROR("Could not calculate temporal error");
-                return false;
-            }
-            if (!writeCache()) {
-                LERROR("Could not write cache");
-                return false;
-            }
+        if (!calculateErrors()) {
+            LERROR("Could not calculate errors");
+            return false;
+        }
+        if (!writeCache()) {
+            LERROR("Could not write cache");
+            return false;
         }
     }
     initalizeSSO();
@@ -109,6 +112,13 @@ bool TSP::readHeader() {
 
     _file.seekg(_file.beg);
 
+    // Compressed files embed the header of the original file after their own header
+    uint32_t magic = 0;
+    _file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    _isCompressed = _file.good() && magic == compressedtsp::Magic;
+    _file.clear();
+    _file.seekg(_isCompressed ? compressedtsp::tspHeaderPosition() : 0);
+
     _file.read(reinterpret_cast<char*>(&_header), sizeof(Header));
     /*
     file.read(reinterpret_cast<char*>(&gridType_),            sizeof(unsigned int));
@@ -237,6 +247,14 @@ long long TSP::dataPosition() {
     return sizeof(Header);
 }
 
+bool TSP::isCompressed() const {
+    return _isCompressed;
+}
+
+const std::string& TSP::filename() const {
+    return _filename;
+}
+
 std::ifstream& TSP::file() {
     return _file;
 }
@@ -281,270 +299,292 @@ GLuint TSP::ssbo() const {
     return _dataSSBO;
 }
 
-bool TSP::calculateSpatialError() {
-    unsigned int numBrickVals = paddedBrickDim_*paddedBrickDim_*paddedBrickDim_;
-
-    if (!_file.is_open())
-        return false;
+bool TSP::calculateErrors() {
+    return computeErrors(true, true);
+}
 
-    std::vector<float> buffer(numBrickVals);
-    std::vector<float> averages(numTotalNodes_);
-    std::vector<float> stdDevs(numTotalNodes_);
+bool TSP::calculateSpatialError() {
+    return computeErrors(true, false);
+}
 
-    // First pass: Calculate average color for each brick
-    LDEBUG("Calculating spatial error, first pass");
-    for (unsigned int brick = 0; brick<numTotalNodes_; ++brick) {
+bool TSP::calculateTemporalError() {
+    return computeErrors(false, true);
+}
 
-        // Offset in file
-        std::streampos offset = dataPosition() + static_cast<long long>(brick*numBrickVals*sizeof(float));
-        _file.seekg(offset);
+bool TSP::computeErrors(bool spatial, bool temporal) {
+    const unsigned int numBrickVals = paddedBrickDim_*paddedBrickDim_*paddedBrickDim_;
 
-        _file.read(reinterpret_cast<char*>(&buffer[0]),
-            static_cast<size_t>(numBrickVals)*sizeof(float));
+    MappedFile file(_filename);
+    if (!file.isValid()) {
+        LERROR("Could not map the brick data of '" << _filename << "'");
+        return false;
+    }
 
-        double average = 0.0;
-        for (auto it = buffer.begin(); it != buffer.end(); ++it) {
-            average += *it;
+    BrickReader readBrick;
+    std::vector<uint64_t> offsets;
+    if (_isCompressed) {
+        compressedtsp::Header header;
+        if (!compressedtsp::readIndex(_file, header, offsets) ||
+            header.nBricks != numTotalNodes_ || header.nBrickValues != numBrickVals ||
+            file.size() < offsets.back())
+        {
+            LERROR("Could not read the brick offsets of '" << _filename << "'");
+            _file.clear();
+            return false;
         }
-
-        averages[brick] = average / static_cast<double>(numBrickVals);
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(file.data());
+        readBrick = [&, data, numBrickVals](unsigned int brick,
+                                            std::vector<float>& scratch)
+        {
+            scratch.resize(numBrickVals);
+            const uint64_t begin = offsets[brick];
+            const uint64_t size = offsets[brick + 1] - begin;
+            if (!brickcodec::decode(data + begin, size, scratch.data(), numBrickVals)) {
+                LWARNING("Could not decode brick " << brick);
+                std::fill(scratch.begin(), scratch.end(), 0.f);
+            }
+            return scratch.data();
+        };
     }
-
-    // Spatial SNR stats
-    float minError = 1e20f;
-    float maxError = 0.f;
-    std::vector<float> medianArray(numTotalNodes_);
-
-    // Second pass: For each brick, compare the covered leaf voxels with
-    // the brick average
-    LDEBUG("Calculating spatial error, second pass");
-    for (unsigned int brick = 0; brick<numTotalNodes_; ++brick) {
-
-        // Fetch mean intensity 
-        float brickAvg = averages[brick];
-
-        // Sum  for std dev computation
-        float stdDev = 0.f;
-
-        // Get a list of leaf bricks that the current brick covers
-        std::list<unsigned int> coveredLeafBricks =
-            CoveredLeafBricks(brick);
-
-        // If the brick is already a leaf, assign a negative error.
-        // Ad hoc "hack" to distinguish leafs from other nodes that happens
-        // to get a zero error due to rounding errors or other reasons.
-        if (coveredLeafBricks.size() == 1) {
-            stdDev = -0.1f;
+    else {
+        size_t requiredSize = static_cast<size_t>(dataPosition()) +
+            static_cast<size_t>(numTotalNodes_) * numBrickVals * sizeof(float);
+        if (file.size() < requiredSize) {
+            LERROR("Could not map the brick data of '" << _filename << "'");
+            return false;
         }
-        else {
-
-            // Calculate "standard deviation" corresponding to leaves
-            for (auto lb = coveredLeafBricks.begin();
-                lb != coveredLeafBricks.end(); ++lb) {
-
-                // Read brick
-                std::streampos offset = dataPosition() + static_cast<long long>((*lb)*numBrickVals*sizeof(float));
-                _file.seekg(offset);
-
-                _file.read(reinterpret_cast<char*>(&buffer[0]),
-                    static_cast<size_t>(numBrickVals)*sizeof(float));
-
-                // Add to sum
-                for (auto v = buffer.begin(); v != buffer.end(); ++v) {
-                    stdDev += pow(*v - brickAvg, 2.f);
-                }
+        const float* bricks = reinterpret_cast<const float*>(
+            file.data() + dataPosition()
+        );
+        readBrick = [bricks, numBrickVals](unsigned int brick, std::vector<float>&) {
+            return bricks + static_cast<size_t>(brick) * numBrickVals;
+        };
+    }
 
+    std::vector<float> stdDevs;
+    if (spatial) {
+        LDEBUG("Calculating spatial error");
+        stdDevs = spatialErrors(readBrick);
+    }
+    std::vector<float> errors;
+    if (temporal) {
+        LDEBUG("Calculating temporal error");
+        errors = temporalErrors(readBrick);
+    }
 
+    if (spatial) {
+        // "Normalize" errors
+        float minNorm = 1e20f;
+        float maxNorm = 0.f;
+        for (unsigned int i = 0; i<numTotalNodes_; ++i) {
+            if (stdDevs[i] > 0.f) {
+                stdDevs[i] = pow(stdDevs[i], 0.5f);
             }
-
-            // Finish calculation
-            if (sizeof(float) != sizeof(int)) {
-                LERROR("Float and int sizes don't match, can't reintepret");
-                return false;
+            data_[i*NUM_DATA + SPATIAL_ERR] = glm::floatBitsToInt(stdDevs[i]);
+            if (stdDevs[i] < minNorm) {
+                minNorm = stdDevs[i];
+            }
+            else if (stdDevs[i] > maxNorm) {
+                maxNorm = stdDevs[i];
             }
-
-            stdDev /= static_cast<float>(coveredLeafBricks.size()*numBrickVals);
-            stdDev = sqrt(stdDev);
-
-        } // if not leaf
-
-        if (stdDev < minError) {
-            minError = stdDev;
-        }
-        else if (stdDev > maxError) {
-            maxError = stdDev;
         }
 
-        stdDevs[brick] = stdDev;
-        medianArray[brick] = stdDev;
-
-    }
+        std::sort(stdDevs.begin(), stdDevs.end());
+        float medNorm = stdDevs[stdDevs.size() / 2];
 
-    std::sort(medianArray.begin(), medianArray.end());
-    //float medError = medianArray[medianArray.size()/2];
+        minSpatialError_ = minNorm;
+        maxSpatialError_ = maxNorm;
+        medianSpatialError_ = medNorm;
 
-    /*
-    LDEBUG("\nMin spatial std dev: " << minError);
-    LDEBUG("Max spatial std dev: " << maxError);
-    LDEBUG("Median spatial std dev: " << medError);
-    LDEBUG("");
-    */
+        LDEBUG("Min normalized spatial std dev: " << minNorm);
+        LDEBUG("Max normalized spatial std dev: " << maxNorm);
+        LDEBUG("Median normalized spatial std dev: " << medNorm);
+    }
 
-    // "Normalize" errors
-    float minNorm = 1e20f;
-    float maxNorm = 0.f;
-    for (unsigned int i = 0; i<numTotalNodes_; ++i) {
-        //float normalized = (stdDevs[i]-minError)/(maxError-minError);
-        if (stdDevs[i] > 0.f) {
-            stdDevs[i] = pow(stdDevs[i], 0.5f);
-        }
-        //data_[i*NUM_DATA + SPATIAL_ERR] = *reinterpret_cast<int*>(&stdDevs[i]);
-        data_[i*NUM_DATA + SPATIAL_ERR] = glm::floatBitsToInt(stdDevs[i]);
-        if (stdDevs[i] < minNorm) {
-            minNorm = stdDevs[i];
-        }
-        else if (stdDevs[i] > maxNorm) {
-            maxNorm = stdDevs[i];
+    if (temporal) {
+        // Adjust errors using user-provided exponents
+        float minNorm = 1e20f;
+        float maxNorm = 0.f;
+        for (unsigned int i = 0; i<numTotalNodes_; ++i) {
+            if (errors[i] > 0.f) {
+                errors[i] = pow(errors[i], 0.25f);
+            }
+            data_[i*NUM_DATA + TEMPORAL_ERR] = glm::floatBitsToInt(errors[i]);
+            if (errors[i] < minNorm) {
+                minNorm = errors[i];
+            }
+            else if (errors[i] > maxNorm) {
+                maxNorm = errors[i];
+            }
         }
-    }
 
-    std::sort(stdDevs.begin(), stdDevs.end());
-    float medNorm = stdDevs[stdDevs.size() / 2];
+        std::sort(errors.begin(), errors.end());
+        float medNorm = errors[errors.size() / 2];
 
-    minSpatialError_ = minNorm;
-    maxSpatialError_ = maxNorm;
-    medianSpatialError_ = medNorm;
+        minTemporalError_ = minNorm;
+        maxTemporalError_ = maxNorm;
+        medianTemporalError_ = medNorm;
 
-    LDEBUG("Min normalized spatial std dev: " << minNorm);
-    LDEBUG("Max normalized spatial std dev: " << maxNorm);
-    LDEBUG("Median normalized spatial std dev: " << medNorm);
+        LDEBUG("Min normalized temporal std dev: " << minNorm);
+        LDEBUG("Max normalized temporal std dev: " << maxNorm);
+        LDEBUG("Median normalized temporal std dev: " << medNorm);
+    }
 
     return true;
 }
 
-bool TSP::calculateTemporalError() {
+std::vector<float> TSP::spatialErrors(const BrickReader& readBrick) const {
+    const unsigned int numBrickVals = paddedBrickDim_*paddedBrickDim_*paddedBrickDim_;
+
+    // The spatial error of a brick is the deviation of all voxels in the octree leaves it
+    // covers from the brick's average. With the sum and the sum of squares of the
+    // covered voxels, (v - a)^2 summed over all voxels v is S2 - 2aS1 + na^2, so each
+    // brick only has to be read once and the sums can be accumulated bottom-up
+    std::vector<double> averages(numTotalNodes_);
+    std::vector<double> sums(numTotalNodes_);
+    std::vector<double> squaredSums(numTotalNodes_);
+
+    parallelFor(numTotalNodes_, [&](unsigned int brick) {
+        thread_local std::vector<float> scratch;
+        const float* values = readBrick(brick, scratch);
+        double sum = 0.0;
+        double squaredSum = 0.0;
+        for (unsigned int v = 0; v < numBrickVals; ++v) {
+            sum += values[v];
+            squaredSum += static_cast<double>(values[v]) * values[v];
+        }
+        averages[brick] = sum / static_cast<double>(numBrickVals);
+        sums[brick] = sum;
+        squaredSums[brick] = squaredSum;
+    });
 
-    if (!_file.is_open())
-        return false;
+    std::vector<float> stdDevs(numTotalNodes_);
+    std::vector<unsigned int> nLeaves(numOTNodes_);
+    for (unsigned int bstNode = 0; bstNode < numBSTNodes_; ++bstNode) {
+        const unsigned int offset = bstNode * numOTNodes_;
+
+        // The octree is stored level by level, so all children of a node are processed
+        // before the node itself when iterating backwards
+        for (unsigned int otNode = numOTNodes_; otNode-- > 0;) {
+            const unsigned int brick = offset + otNode;
+            const unsigned int firstChild = 8 * otNode + 1;
+
+            // Assign a negative error to leaves to distinguish them from other nodes
+            // that happen to get a zero error due to rounding errors or other reasons
+            if (firstChild >= numOTNodes_) {
+                nLeaves[otNode] = 1;
+                stdDevs[brick] = -0.1f;
+                continue;
+            }
 
-    LDEBUG("Calculating temporal error");
+            double sum = 0.0;
+            double squaredSum = 0.0;
+            unsigned int n = 0;
+            for (unsigned int c = firstChild; c < firstChild + 8; ++c) {
+                sum += sums[offset + c];
+                squaredSum += squaredSums[offset + c];
+                n += nLeaves[c];
+            }
+            sums[brick] = sum;
+            squaredSums[brick] = squaredSum;
+            nLeaves[otNode] = n;
+
+            const double a = averages[brick];
+            const double nValues = static_cast<double>(n) * numBrickVals;
+            double variance = (squaredSum - 2.0 * a * sum + nValues * a * a) / nValues;
+            stdDevs[brick] = static_cast<float>(std::sqrt(std::max(variance, 0.0)));
+        }
+    }
+    return stdDevs;
+}
 
-    // Statistics
-    //float minErr = 1e20f;
-    //float maxErr = 0.f;
-    std::vector<float> meanArray(numTotalNodes_);
+std::vector<float> TSP::temporalErrors(const BrickReader& readBrick) const {
+    const unsigned int numBrickVals = paddedBrickDim_*paddedBrickDim_*paddedBrickDim_;
+    const unsigned int firstBstLeaf = numBSTNodes_ / 2;
 
-    // Save errors
     std::vector<float> errors(numTotalNodes_);
 
-    // Calculate temporal error for one brick at a time
-    for (unsigned int brick = 0; brick<numTotalNodes_; ++brick) {
-
-        unsigned int numBrickVals =
-            paddedBrickDim_*paddedBrickDim_*paddedBrickDim_;
-
-        // Save the individual voxel's average over timesteps. Because the
-        // BSTs are built by averaging leaf nodes, we only need to sample
-        // the brick at the correct coordinate.
-        std::vector<float> voxelAverages(numBrickVals);
-        std::vector<float> voxelStdDevs(numBrickVals);
-
-        // Read the whole brick to fill the averages
-        std::streampos offset = dataPosition() + static_cast<long long>(brick*numBrickVals*sizeof(float));
-        _file.seekg(offset);
-
-        _file.read(reinterpret_cast<char*>(&voxelAverages[0]),
-            static_cast<size_t>(numBrickVals)*sizeof(float));
-
-        // Build a list of the BST leaf bricks (within the same octree level) that
-        // this brick covers
-        std::list<unsigned int> coveredBricks = CoveredBSTLeafBricks(brick);
-
-        // If the brick is at the lowest BST level, automatically set the error 
-        // to -0.1 (enables using -1 as a marker for "no error accepted");
-        // Somewhat ad hoc to get around the fact that the error could be
-        // 0.0 higher up in the tree
-        if (coveredBricks.size() == 1) {
-            errors[brick] = -0.1f;
-        } else {
-            // Calculate standard deviation per voxel, average over brick
-            float avgStdDev = 0.f;
-            for (unsigned int voxel = 0; voxel<numBrickVals; ++voxel) {
-
-                float stdDev = 0.f;
-                for (auto leaf = coveredBricks.begin();
-                    leaf != coveredBricks.end(); ++leaf) {
-
-                    // Sample the leaves at the corresponding voxel position
-
-                    std::streampos offset = dataPosition() + static_cast<long long>((*leaf*numBrickVals + voxel)*sizeof(float));
-                    _file.seekg(offset);
-
-                    float sample;
-                    _file.read(reinterpret_cast<char*>(&sample), sizeof(float));
-
-                    stdDev += pow(sample - voxelAverages[voxel], 2.f);
-                }
-                stdDev /= static_cast<float>(coveredBricks.size());
-                stdDev = sqrt(stdDev);
-
-                avgStdDev += stdDev;
-            } // for voxel
-
-            avgStdDev /= static_cast<float>(numBrickVals);
-            meanArray[brick] = avgStdDev;
-            errors[brick] = avgStdDev;
-
+    // Each octree node is handled independently. Its BST is traversed depth first, and
+    // every BST node receives the per-voxel sums and sums of squares of the BST leaves it
+    // covers from its children, so that each brick is read exactly once
+    parallelFor(numOTNodes_, [&](unsigned int otNode) {
+        struct Sums {
+            std::vector<double> sum;
+            std::vector<double> squaredSum;
+            std::vector<float> scratch;
+        };
+        // One set of sums per BST level
+        std::vector<Sums> levels(numBSTLevels_ + 1);
+        for (Sums& l : levels) {
+            l.sum.resize(numBrickVals);
+            l.squaredSum.resize(numBrickVals);
         }
 
-        /*
-        if (avgStdDev < minErr) {
-        minErr = avgStdDev;
-        } else if (avgStdDev > maxErr) {
-        maxErr = avgStdDev;
-        }
-        */
+        std::function<unsigned int(unsigned int, unsigned int)> accumulate =
+            [&](unsigned int bstNode, unsigned int depth) -> unsigned int
+        {
+            const unsigned int brick = bstNode * numOTNodes_ + otNode;
+            Sums& sums = levels[depth];
+            const float* values = readBrick(brick, sums.scratch);
+
+            // If the brick is at the lowest BST level, set the error to -0.1 (enables
+            // using -1 as a marker for "no error accepted")
+            if (bstNode >= firstBstLeaf) {
+                for (unsigned int v = 0; v < numBrickVals; ++v) {
+                    sums.sum[v] = values[v];
+                    sums.squaredSum[v] = static_cast<double>(values[v]) * values[v];
+                }
+                errors[brick] = -0.1f;
+                return 1;
+            }
 
-    } // for all bricks
+            const Sums& childSums = levels[depth + 1];
+            unsigned int n = accumulate(2 * bstNode + 1, depth + 1);
+            sums.sum = childSums.sum;
+            sums.squaredSum = childSums.squaredSum;
+            n += accumulate(2 * bstNode + 2, depth + 1);
+            for (unsigned int v = 0; v < numBrickVals; ++v) {
+                sums.sum[v] += childSums.sum[v];
+                sums.squaredSum[v] += childSums.squaredSum[v];
+            }
 
-    std::sort(meanArray.begin(), meanArray.end());
-    //float medErr = meanArray[meanArray.size()/2];
+            // Calculate standard deviation per voxel, average over brick
+            double avgStdDev = 0.0;
+            for (unsigned int v = 0; v < numBrickVals; ++v) {
+                const double y = values[v];
+                double variance =
+                    (sums.squaredSum[v] - 2.0 * y * sums.sum[v] + n * y * y) / n;
+                avgStdDev += std::sqrt(std::max(variance, 0.0));
+            }
+            errors[brick] = static_cast<float>(avgStdDev / numBrickVals);
+            return n;
+        };
+        accumulate(0, 0);
+    });
 
-    /*
-    LDEBUG("\nMin temporal error: " << minErr);
-    LDEBUG("Max temporal error: " << maxErr);
-    LDEBUG("Median temporal error: " << medErr);
-    */
+    return errors;
+}
 
-    // Adjust errors using user-provided exponents
-    float minNorm = 1e20f;
-    float maxNorm = 0.f;
-    for (unsigned int i = 0; i<numTotalNodes_; ++i) {
-        if (errors[i] > 0.f) {
-            errors[i] = pow(errors[i], 0.25f);
-        }
-        //data_[i*NUM_DATA + TEMPORAL_ERR] = *reinterpret_cast<int*>(&errors[i]);
-        data_[i*NUM_DATA + TEMPORAL_ERR] = glm::floatBitsToInt(errors[i]);
-        if (errors[i] < minNorm) {
-            minNorm = errors[i];
-        }
-        else if (errors[i] > maxNorm) {
-            maxNorm = errors[i];
-        }
+void TSP::parallelFor(unsigned int n,
+                      const std::function<void(unsigned int)>& function) const
+{
+    // A few contiguous blocks per core even out the differing costs of the indices
+    // while keeping the bricks that a task reads close to each other in the file
+    const unsigned int nTasks = std::min(
+        n,
+        4 * std::max(std::thread::hardware_concurrency(), 1u)
+    );
+    TaskGraph tasks;
+    for (unsigned int t = 0; t < nTasks; ++t) {
+        const unsigned int begin = static_cast<unsigned int>(uint64_t(n) * t / nTasks);
+        const unsigned int end = static_cast<unsigned int>(uint64_t(n) * (t + 1) / nTasks);
+        tasks.addTask([&function, begin, end]() {
+            for (unsigned int i = begin; i < end; ++i) {
+                function(i);
+            }
+        });
     }
-
-    std::sort(errors.begin(), errors.end());
-    float medNorm = errors[errors.size() / 2];
-
-    minTemporalError_ = minNorm;
-    maxTemporalError_ = maxNorm;
-    medianTemporalError_ = medNorm;
-
-    LDEBUG("Min normalized temporal std dev: " << minNorm);
-    LDEBUG("Max normalized temporal std dev: " << maxNorm);
-    LDEBUG("Median normalized temporal std dev: " << medNorm);
-
-    return true;
+    tasks.run();
 }
 
 
@@ -594,6 +634,10 @@ bool TSP::writeCache() {
     std::string cacheFilename = FileSys.cacheManager()->cachedFilename(
         f.baseName(), "", ghoul::filesystem::CacheManager::Persistent::Yes);
 
+    return writeCache(cacheFilename);
+}
+
+bool TSP::writeCache(const std::string& cacheFilename) {
     std::ofstream file(cacheFilename, std::ios::out | std::ios::binary);
     if (!file.is_open()) {
         LWARNING("Failed to open " << cacheFilename);
@@ -29,6 +29,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <functional>
 #include <iostream>
 #include <fstream>
 
@@ -70,11 +71,17 @@ public:
     bool readHeader();
     bool readCache();
     bool writeCache();
+    /// Writes the cache to \p cacheFilename instead of the cache directory
+    bool writeCache(const std::string& cacheFilename);
     bool construct();
     bool initalizeSSO();
 
     const Header& header() const;
+    /// Returns the byte offset of the first brick in an uncompressed TSP file
     static long long dataPosition();
+    /// Returns true if the bricks are stored in the compressedtsp format
+    bool isCompressed() const;
+    const std::string& filename() const;
     std::ifstream& file();
     unsigned int numTotalNodes() const;
     unsigned int numValuesPerNode() const;
@@ -87,6 +94,11 @@ public:
     unsigned int numBricksPerAxis() const;
     GLuint ssbo() const;
 
+    /**
+     * Calculates the spatial and the temporal errors of all bricks in a single pass over
+     * the memory-mapped brick data, using all available cores.
+     */
+    bool calculateErrors();
     bool calculateSpatialError();
     bool calculateTemporalError();
 
@@ -101,6 +113,17 @@ public:
     bool isOctreeLeaf(unsigned int _brickIndex);
 
 private:
+    /// Returns the values of a brick, decoding them into the scratch vector if necessary
+    using BrickReader =
+        std::function<const float*(unsigned int brick, std::vector<float>& scratch)>;
+
+    bool computeErrors(bool spatial, bool temporal);
+    std::vector<float> spatialErrors(const BrickReader& readBrick) const;
+    std::vector<float> temporalErrors(const BrickReader& readBrick) const;
+    /// Calls \p function for all indices in [0, n) distributed over all cores
+    void parallelFor(unsigned int n,
+        const std::function<void(unsigned int)>& function) const;
+
     // Returns a list of the octree leaf nodes that a given input 
     // brick covers. If the input is already a leaf, the list will
     // only contain that one index.
@@ -116,6 +139,7 @@ private:
     std::string _filename;
     std::ifstream _file;
     std::streampos _dataOffset;
+    bool _isCompressed;
 
     // Holds the actual structure
     std::vector<int> data_;
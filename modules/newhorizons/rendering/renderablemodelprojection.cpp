@@ -117,6 +117,10 @@ bool RenderableModelProjection::isReady() const {
     return ready;
 }
 
+bool RenderableModelProjection::loadResources() {
+    return _geometry && _geometry->loadResources();
+}
+
 bool RenderableModelProjection::initialize() {
     bool completeSuccess = true;
         
@@ -176,13 +180,12 @@ void RenderableModelProjection::render(const RenderData& data) {
 
     _up = data.camera.lookUpVectorCameraSpace();
 
-    if (_capture && _projectionComponent.doesPerformProjection())
+    if (_projectionComponent.doesPerformProjection())
         project();
 
     _programObject->activate();
 
     attitudeParameters(_time);
-    _imageTimes.clear();
 
     // Calculate variables to be used as uniform variables in shader
     glm::dvec3 bodyPosition = data.modelTransform.translation;
@@ -238,11 +241,18 @@ void RenderableModelProjection::update(const UpdateData& data) {
     if (openspace::ImageSequencer::ref().isReady()) {
         openspace::ImageSequencer::ref().updateSequencer(_time);
         if (_projectionComponent.doesPerformProjection()) {
-            _capture = openspace::ImageSequencer::ref().getImagePaths(
-                _imageTimes,
+            CaptureIndex::Range captures;
+            bool hasCaptures = openspace::ImageSequencer::ref().getCaptures(
+                captures,
                 _projectionComponent.projecteeId(),
                 _projectionComponent.instrumentId()
             );
+            if (hasCaptures) {
+                _projectionComponent.queueProjections(
+                    captures,
+                    openspace::ImageSequencer::ref().captureIndex()
+                );
+            }
         }
     }
         
@@ -376,12 +386,11 @@ void RenderableModelProjection::attitudeParameters(double time) {
 
 
 void RenderableModelProjection::project() {
-    for (auto img : _imageTimes) {
-        attitudeParameters(img.timeRange.start);
-        auto projTexture = _projectionComponent.loadProjectionTexture(img.path, img.isPlaceholder);
-        imageProjectGPU(projTexture);
+    using Projection = ProjectionComponent::Projection;
+    for (const Projection& p : _projectionComponent.readyProjections()) {
+        attitudeParameters(p.time);
+        imageProjectGPU(p.texture);
     }
-    _capture = false;
 }
 
 bool RenderableModelProjection::loadTextures() {
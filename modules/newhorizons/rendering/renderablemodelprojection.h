@@ -49,6 +49,7 @@ class RenderableModelProjection : public Renderable {
 public:
     RenderableModelProjection(const ghoul::Dictionary& dictionary);
 
+    bool loadResources() override;
     bool initialize() override;
     bool deinitialize() override;
 
@@ -95,10 +96,7 @@ private:
     glm::mat4  _projectorMatrix;
     glm::vec3  _boresight;
 
-    std::vector<Image> _imageTimes;
     double _time;
-
-    bool _capture;
         
     psc _sunPosition;
     properties::BoolProperty _performShading;
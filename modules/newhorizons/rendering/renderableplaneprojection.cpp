@@ -24,6 +24,8 @@
 
 #include <modules/newhorizons/rendering/renderableplaneprojection.h>
 
+#include <modules/newhorizons/util/projectionimageloader.h>
+
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/engine/configurationmanager.h>
 #include <openspace/scene/scenegraphnode.h>
@@ -188,7 +190,12 @@ void RenderablePlaneProjection::update(const UpdateData& data) {
 
 void RenderablePlaneProjection::loadTexture() {
     if (_texturePath != "") {
-        std::unique_ptr<ghoul::opengl::Texture> texture = ghoul::io::TextureReader::ref().loadTexture(absPath(_texturePath));
+        std::unique_ptr<ghoul::opengl::Texture> texture;
+        {
+            // Projection images are decoded on worker threads at the same time
+            std::lock_guard<std::mutex> lock(imageReaderMutex());
+            texture = ghoul::io::TextureReader::ref().loadTexture(absPath(_texturePath));
+        }
         if (texture) {
             if (texture->format() == ghoul::opengl::Texture::Format::Red)
                 texture->setSwizzleMask({ GL_RED, GL_RED, GL_RED, GL_ONE });
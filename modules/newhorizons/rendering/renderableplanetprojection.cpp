@@ -66,7 +66,6 @@ RenderablePlanetProjection::RenderablePlanetProjection(const ghoul::Dictionary&
     , _fboProgramObject(nullptr)
     , _baseTexture(nullptr)
     , _heightMapTexture(nullptr)
-    , _capture(false)
 {
     std::string name;
     bool success = dictionary.getValue(SceneGraphNode::KeyName, name);
@@ -316,15 +315,14 @@ void RenderablePlanetProjection::render(const RenderData& data) {
     _camScaling = data.camera.scaling();
     _up = data.camera.lookUpVectorCameraSpace();
 
-    if (_capture && _projectionComponent.doesPerformProjection()) {
-        for (const Image& img : _imageTimes) {
-            RenderablePlanetProjection::attitudeParameters(img.timeRange.start);
-            imageProjectGPU(_projectionComponent.loadProjectionTexture(img.path));
+    if (_projectionComponent.doesPerformProjection()) {
+        using Projection = ProjectionComponent::Projection;
+        for (const Projection& p : _projectionComponent.readyProjections()) {
+            RenderablePlanetProjection::attitudeParameters(p.time);
+            imageProjectGPU(p.texture);
         }
-        _capture = false;
     }
     attitudeParameters(_time);
-    _imageTimes.clear();
 
     double  lt;
     glm::dvec3 p =
@@ -398,16 +396,21 @@ void RenderablePlanetProjection::update(const UpdateData& data) {
     _projectionComponent.update();
 
     _time = Time::ref().j2000Seconds();
-    _capture = false;
-
     if (openspace::ImageSequencer::ref().isReady()){
         openspace::ImageSequencer::ref().updateSequencer(_time);
         if (_projectionComponent.doesPerformProjection()) {
-            _capture = openspace::ImageSequencer::ref().getImagePaths(
-                _imageTimes,
+            CaptureIndex::Range captures;
+            bool hasCaptures = openspace::ImageSequencer::ref().getCaptures(
+                captures,
                 _projectionComponent.projecteeId(),
                 _projectionComponent.instrumentId()
             );
+            if (hasCaptures) {
+                _projectionComponent.queueProjections(
+                    captures,
+                    openspace::ImageSequencer::ref().captureIndex()
+                );
+            }
         }
     }
 
@@ -93,13 +93,9 @@ private:
 
     double _time;
 
-    std::vector<Image> _imageTimes;
-
     std::string _body;
     std::string _frame;
 
-    bool _capture;
-
     GLuint _quad;
     GLuint _vertexPositionBuffer;
 
@@ -0,0 +1,334 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/newhorizons/util/captureindex.h>
+
+#include <ghoul/logging/logmanager.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace {
+    const std::string _loggerCat = "CaptureIndex";
+
+    const uint32_t Magic = 0x58444943; // 'CIDX'
+    const uint32_t CurrentVersion = 1;
+
+    // Placeholders closer than this to another capture of the same stream are dropped
+    const double PlaceholderSeparation = 1.0;
+} // namespace
+
+namespace openspace {
+
+CaptureIndex::Range::Range()
+    : _begin(nullptr)
+    , _end(nullptr)
+{}
+
+CaptureIndex::Range::Range(const Capture* begin, const Capture* end)
+    : _begin(begin)
+    , _end(end)
+{}
+
+const CaptureIndex::Capture* CaptureIndex::Range::begin() const {
+    return _begin;
+}
+
+const CaptureIndex::Capture* CaptureIndex::Range::end() const {
+    return _end;
+}
+
+size_t CaptureIndex::Range::size() const {
+    return _end - _begin;
+}
+
+bool CaptureIndex::Range::empty() const {
+    return _begin == _end;
+}
+
+std::vector<char> CaptureIndex::compile(const std::map<std::string, ImageSubset>& subsets)
+{
+    std::map<std::pair<std::string, std::string>, std::vector<const Image*>> streamImages;
+    for (const auto& subset : subsets) {
+        for (const Image& image : subset.second._subset) {
+            if (!image.activeInstruments.empty()) {
+                streamImages[{ subset.first, image.activeInstruments.front() }].push_back(
+                    &image
+                );
+            }
+        }
+    }
+
+    std::string strings;
+    std::map<std::string, uint32_t> stringOffsets;
+    auto addString = [&](const std::string& s) {
+        auto it = stringOffsets.find(s);
+        if (it != stringOffsets.end()) {
+            return it->second;
+        }
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(s);
+        strings.push_back('\0');
+        stringOffsets[s] = offset;
+        return offset;
+    };
+
+    std::vector<Stream> streams;
+    std::vector<Capture> captures;
+    for (auto& s : streamImages) {
+        std::vector<const Image*>& images = s.second;
+        std::stable_sort(
+            images.begin(),
+            images.end(),
+            [](const Image* lhs, const Image* rhs) {
+                return lhs->timeRange.start < rhs->timeRange.start;
+            }
+        );
+
+        Stream stream;
+        stream.target = addString(s.first.first);
+        stream.instrument = addString(s.first.second);
+        stream.firstCapture = static_cast<uint32_t>(captures.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            const Image& image = *images[i];
+            if (image.isPlaceholder) {
+                bool closeToPrevious = (i > 0) && (std::abs(
+                    images[i - 1]->timeRange.start - image.timeRange.start
+                ) < PlaceholderSeparation);
+                bool closeToNext = (i + 1 < images.size()) && (std::abs(
+                    images[i + 1]->timeRange.start - image.timeRange.start
+                ) < PlaceholderSeparation);
+                if (closeToPrevious || closeToNext) {
+                    continue;
+                }
+            }
+            captures.push_back({
+                image.timeRange.start,
+                image.timeRange.end,
+                addString(image.path),
+                image.isPlaceholder ? 1u : 0u
+            });
+        }
+        stream.nCaptures = static_cast<uint32_t>(captures.size()) - stream.firstCapture;
+        streams.push_back(stream);
+    }
+
+    if (captures.size() > std::numeric_limits<uint32_t>::max() ||
+        strings.size() > std::numeric_limits<uint32_t>::max())
+    {
+        LERROR("Too many captures to be indexed");
+        return {};
+    }
+
+    Header header;
+    header.magic = Magic;
+    header.version = CurrentVersion;
+    header.nStreams = static_cast<uint32_t>(streams.size());
+    header.nCaptures = static_cast<uint32_t>(captures.size());
+    header.stringTableSize = strings.size();
+
+    std::vector<char> data(
+        sizeof(Header) + streams.size() * sizeof(Stream) +
+        captures.size() * sizeof(Capture) + strings.size()
+    );
+    char* p = data.data();
+    std::memcpy(p, &header, sizeof(Header));
+    p += sizeof(Header);
+    std::memcpy(p, streams.data(), streams.size() * sizeof(Stream));
+    p += streams.size() * sizeof(Stream);
+    std::memcpy(p, captures.data(), captures.size() * sizeof(Capture));
+    p += captures.size() * sizeof(Capture);
+    std::memcpy(p, strings.data(), strings.size());
+    return data;
+}
+
+CaptureIndex::CaptureIndex()
+    : _data(nullptr)
+    , _size(0)
+    , _streams(nullptr)
+    , _nStreams(0)
+    , _captures(nullptr)
+    , _nCaptures(0)
+    , _strings(nullptr)
+{}
+
+bool CaptureIndex::set(std::vector<char> data) {
+    std::vector<char> previous = std::move(_ownedData);
+    _ownedData = std::move(data);
+    if (!use(_ownedData.data(), _ownedData.size())) {
+        _ownedData = std::move(previous);
+        return false;
+    }
+    _mapping = nullptr;
+    return true;
+}
+
+bool CaptureIndex::load(const std::string& file) {
+    std::unique_ptr<MappedFile> mapping = std::make_unique<MappedFile>(file);
+    if (!mapping->isValid() || !use(mapping->data(), mapping->size())) {
+        return false;
+    }
+    _mapping = std::move(mapping);
+    _ownedData.clear();
+    return true;
+}
+
+bool CaptureIndex::save(const std::string& file) const {
+    std::ofstream stream(file, std::ofstream::binary);
+    if (!stream.good()) {
+        LERROR("Error opening file '" << file << "' for saving the capture index");
+        return false;
+    }
+    stream.write(_data, _size);
+    return stream.good();
+}
+
+bool CaptureIndex::use(const char* data, size_t size) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (header.magic != Magic || header.version != CurrentVersion) {
+        return false;
+    }
+
+    size_t expectedSize = sizeof(Header) + header.nStreams * sizeof(Stream) +
+        header.nCaptures * sizeof(Capture) + header.stringTableSize;
+    if (size != expectedSize) {
+        return false;
+    }
+
+    const Stream* streams = reinterpret_cast<const Stream*>(data + sizeof(Header));
+    const Capture* captures = reinterpret_cast<const Capture*>(
+        streams + header.nStreams
+    );
+    const char* strings = reinterpret_cast<const char*>(captures + header.nCaptures);
+
+    // All offsets are validated once, so that queries can trust the buffer
+    uint64_t tableSize = header.stringTableSize;
+    if (tableSize > 0 && strings[tableSize - 1] != '\0') {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.nStreams; ++i) {
+        const Stream& s = streams[i];
+        if (s.target >= tableSize || s.instrument >= tableSize ||
+            uint64_t(s.firstCapture) + s.nCaptures > header.nCaptures)
+        {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.nCaptures; ++i) {
+        if (captures[i].path >= tableSize) {
+            return false;
+        }
+    }
+
+    _data = data;
+    _size = size;
+    _streams = streams;
+    _nStreams = header.nStreams;
+    _captures = captures;
+    _nCaptures = header.nCaptures;
+    _strings = strings;
+    return true;
+}
+
+bool CaptureIndex::isEmpty() const {
+    return _nCaptures == 0;
+}
+
+size_t CaptureIndex::nStreams() const {
+    return _nStreams;
+}
+
+size_t CaptureIndex::nCaptures() const {
+    return _nCaptures;
+}
+
+const CaptureIndex::Stream* CaptureIndex::findStream(const std::string& target,
+                                                     const std::string& instrument) const
+{
+    auto compare = [this](const Stream& s, const std::pair<const char*, const char*>& key) {
+        int c = std::strcmp(_strings + s.target, key.first);
+        return c < 0 || (c == 0 && std::strcmp(_strings + s.instrument, key.second) < 0);
+    };
+    std::pair<const char*, const char*> key = { target.c_str(), instrument.c_str() };
+
+    const Stream* end = _streams + _nStreams;
+    const Stream* it = std::lower_bound(_streams, end, key, compare);
+    if (it == end || target != (_strings + it->target) ||
+        instrument != (_strings + it->instrument))
+    {
+        return nullptr;
+    }
+    return it;
+}
+
+CaptureIndex::Range CaptureIndex::captures(const std::string& target,
+                                           const std::string& instrument) const
+{
+    const Stream* stream = findStream(target, instrument);
+    if (!stream) {
+        return Range();
+    }
+    const Capture* first = _captures + stream->firstCapture;
+    return Range(first, first + stream->nCaptures);
+}
+
+CaptureIndex::Range CaptureIndex::captures(const std::string& target,
+                                           const std::string& instrument,
+                                           double from, double to) const
+{
+    Range all = captures(target, instrument);
+    if (all.empty() || !(from < to)) {
+        return Range();
+    }
+
+    auto startsBefore = [](const Capture& c, double time) { return c.start < time; };
+    const Capture* begin = std::lower_bound(all.begin(), all.end(), from, startsBefore);
+    const Capture* end = std::lower_bound(begin, all.end(), to, startsBefore);
+    return Range(begin, end);
+}
+
+const char* CaptureIndex::path(const Capture& capture) const {
+    return _strings + capture.path;
+}
+
+Image CaptureIndex::image(const Capture& capture, const std::string& target,
+                          const std::string& instrument) const
+{
+    Image image;
+    image.timeRange = TimeRange(capture.start, capture.end);
+    image.path = path(capture);
+    image.activeInstruments = { instrument };
+    image.target = target;
+    image.isPlaceholder = capture.isPlaceholder != 0;
+    return image;
+}
+
+} // namespace openspace
@@ -0,0 +1,151 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __CAPTUREINDEX_H__
+#define __CAPTUREINDEX_H__
+
+#include <modules/newhorizons/util/sequenceparser.h>
+
+#include <openspace/util/mappedfile.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * A compiled, read-only index of all image captures, grouped into one stream per target
+ * and instrument in which the captures are sorted by their start time. All data lives in
+ * a single contiguous buffer that can be written to disk and memory-mapped again, so
+ * that queries neither allocate nor chase pointers. A time range query costs
+ * O(log n + k) for k returned captures.
+ *
+ * The buffer consists of a header, the streams sorted by target and instrument name,
+ * the captures of all streams, and a table of null-terminated strings that the streams
+ * and captures refer to by offset.
+ */
+class CaptureIndex {
+public:
+    struct Capture {
+        double start;
+        double end;
+        /// Offset of the image path in the string table; use CaptureIndex::path
+        uint32_t path;
+        uint32_t isPlaceholder;
+    };
+
+    /// A contiguous range of captures of one stream, sorted by start time
+    class Range {
+    public:
+        Range();
+        Range(const Capture* begin, const Capture* end);
+
+        const Capture* begin() const;
+        const Capture* end() const;
+        size_t size() const;
+        bool empty() const;
+
+    private:
+        const Capture* _begin;
+        const Capture* _end;
+    };
+
+    /**
+     * Compiles the images in \p subsets into the buffer format of a CaptureIndex. Only
+     * the first active instrument of an image is used as its instrument, and
+     * placeholders that lie within a second of another capture of the same stream are
+     * dropped, as the actual image is projected instead.
+     */
+    static std::vector<char> compile(const std::map<std::string, ImageSubset>& subsets);
+
+    /// Creates an empty index
+    CaptureIndex();
+
+    /// Uses the compiled \p data, which has to be in the format created by compile
+    bool set(std::vector<char> data);
+
+    /// Memory-maps a previously saved index from \p file
+    bool load(const std::string& file);
+
+    /// Writes the index to \p file so that it can be loaded later
+    bool save(const std::string& file) const;
+
+    bool isEmpty() const;
+    size_t nStreams() const;
+    size_t nCaptures() const;
+
+    /// Returns all captures of \p instrument on \p target
+    Range captures(const std::string& target, const std::string& instrument) const;
+
+    /**
+     * Returns the captures of \p instrument on \p target that start in the half-open
+     * interval [\p from, \p to).
+     */
+    Range captures(const std::string& target, const std::string& instrument,
+        double from, double to) const;
+
+    const char* path(const Capture& capture) const;
+
+    /// Converts \p capture back into an Image for \p target and \p instrument
+    Image image(const Capture& capture, const std::string& target,
+        const std::string& instrument) const;
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t nStreams;
+        uint32_t nCaptures;
+        uint64_t stringTableSize;
+    };
+
+    struct Stream {
+        uint32_t target;
+        uint32_t instrument;
+        uint32_t firstCapture;
+        uint32_t nCaptures;
+    };
+
+    bool use(const char* data, size_t size);
+    const Stream* findStream(const std::string& target,
+        const std::string& instrument) const;
+
+    std::unique_ptr<MappedFile> _mapping;
+    std::vector<char> _ownedData;
+    const char* _data;
+    size_t _size;
+
+    const Stream* _streams;
+    uint32_t _nStreams;
+    const Capture* _captures;
+    uint32_t _nCaptures;
+    const char* _strings;
+};
+
+} // namespace openspace
+
+#endif // __CAPTUREINDEX_H__
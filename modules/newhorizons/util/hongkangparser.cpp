@@ -26,25 +26,27 @@
 
 #include <modules/newhorizons/util/imagesequencer.h>
 #include <modules/newhorizons/util/instrumentdecoder.h>
+#include <modules/newhorizons/util/linetokenizer.h>
 
+#include <openspace/util/mappedfile.h>
 #include <openspace/util/time.h>
 #include <openspace/util/spicemanager.h>
 
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/filesystem/directory.h>
 
-#include <fstream>
-#include <iterator>
-#include <iomanip>
-#include <limits>
-
 
 namespace {
     const std::string _loggerCat = "HongKangParser";
     const std::string keyTranslation = "DataInputTranslation";
 
     const std::string PlaybookIdentifierName = "HongKang";
+
+    // The mission elapsed time of an event is stored in these columns
+    const size_t MetPosition = 25;
+    const size_t MetLength = 9;
 }
 
 namespace openspace {
@@ -122,13 +124,42 @@ bool HongKangParser::create() {
 
             if (extension == "txt") {// Hong Kang. pre-parsed playbook
                 LINFO("Using Preparsed Playbook V9H");
-                std::ifstream file(_fileName , std::ios::binary);
-                if (!file.good()){
+
+                std::vector<SourceFile> sources = sourceFiles({ _fileName });
+                std::string settings = translationSettings(_fileTranslation);
+                for (const auto& t : _fileTranslation) {
+                    if (t.second->getDecoderType() == "SCANNER") {
+                        InstrumentDecoder* scanner =
+                            static_cast<InstrumentDecoder*>(t.second.get());
+                        settings += scanner->getStopCommand() + ";";
+                    }
+                }
+                settings += _spacecraft + ";" + _defaultCaptureImage + ";";
+                for (const std::string& target : _potentialTargets) {
+                    settings += target + ";";
+                }
+
+                std::string cacheFile = FileSys.cacheManager()->cachedFilename(
+                    _fileName,
+                    PlaybookIdentifierName,
+                    ghoul::filesystem::CacheManager::Persistent::Yes
+                );
+                if (loadCache(cacheFile, settings, sources)) {
+                    LINFO(
+                        "Loaded " << _captureProgression.size() << " events from cache"
+                    );
+                    sendPlaybookInformation(PlaybookIdentifierName);
+                    return true;
+                }
+
+                MappedFile file(_fileName);
+                if (!file.isValid()){
                     LERROR("Failed to open event file '" << _fileName << "'");
                     return false;
                 }
+                _referenceET =
+                    SpiceManager::ref().ephemerisTimeFromDate("2015-07-14T11:50:00.00");
 
-                std::string line = "";
                 double shutter = 0.01;
 
                 std::string previousTarget;
@@ -149,15 +180,20 @@ bool HongKangParser::create() {
                 std::string cameraTarget  = "VOID";
                 std::string scannerTarget = "VOID";
 
-                while (!file.eof()){
-                    std::getline(file, line);
-                    
-                    std::string event = line.substr(0, line.find_first_of(" ")); 
+                LineTokenizer lines(file.data(), file.size());
+                LineTokenizer::Token line;
+                while (lines.next(line)){
+                    // Lines without a mission elapsed time do not contain events
+                    if (line.size() <= MetPosition) {
+                        continue;
+                    }
+
+                    std::string event = line.substr(0, line.find(' ')).str();
 
                     auto it = _fileTranslation.find(event);
                     bool foundEvent = (it != _fileTranslation.end());
 
-                    std::string met = line.substr(25, 9);
+                    std::string met = line.substr(MetPosition, MetLength).str();
                     double time = getETfromMet(met);
 
                     if (foundEvent){
@@ -173,7 +209,7 @@ bool HongKangParser::create() {
                             //always store individual image for camera
                             cameraSpiceID = it->second->getTranslation();
                             //rely on playboook mdl column to determine target
-                            findPlaybookSpecifiedTarget(line, cameraTarget);
+                            findPlaybookSpecifiedTarget(line.str(), cameraTarget);
 
                             //fill image
 
@@ -184,7 +220,6 @@ bool HongKangParser::create() {
                             image.target = cameraTarget;
                             image.isPlaceholder = true;
                             image.projected = false;
-                            //createImage(image, time, time + shutter, cameraSpiceID, cameraTarget, _defaultCaptureImage);
 
                             //IFF spaccraft has decided to switch target, store in target map (used for: 'next observation focus')
                             if (previousTarget != image.target){
@@ -205,18 +240,17 @@ bool HongKangParser::create() {
                             std::string endNominal = scanner->getStopCommand();
 
                             // store current position in file
-                            std::streampos len = file.tellg();
-                            std::string linePeek;
+                            size_t position = lines.position();
+                            LineTokenizer::Token linePeek;
                             bool foundstop = false;
-                            while (!file.eof() && !foundstop){
+                            while (!foundstop && lines.next(linePeek)){
                                 //continue grabbing next line until we find what we need
-                                getline(file, linePeek);
                                 if (linePeek.find(endNominal) != std::string::npos){
                                     foundstop = true;
 
-                                    met = linePeek.substr(25, 9);
+                                    met = linePeek.substr(MetPosition, MetLength).str();
                                     scan_stop = getETfromMet(met);
-                                    findPlaybookSpecifiedTarget(line, scannerTarget);
+                                    findPlaybookSpecifiedTarget(line.str(), scannerTarget);
                                     scannerSpiceID = it->second->getTranslation();
 
                                     scanRange = { scan_start, scan_stop };
@@ -237,7 +271,7 @@ bool HongKangParser::create() {
                                 }
                             }
                             //go back to stored position in file
-                            file.seekg(len, std::ios_base::beg);
+                            lines.setPosition(position);
                         }
                     }
                     else{ // we have reached the end of a scan or consecutive capture sequence!
@@ -252,6 +286,8 @@ bool HongKangParser::create() {
                         }
                     }
                 }
+
+                saveCache(cacheFile, settings, sources);
             }
         }
     }
@@ -320,8 +356,7 @@ double HongKangParser::getETfromMet(std::string line){
 
 double HongKangParser::getETfromMet(double met){
     double diff;
-    double referenceET =
-        SpiceManager::ref().ephemerisTimeFromDate("2015-07-14T11:50:00.00");
+    double referenceET = _referenceET;
     double et = referenceET;
 
     //_metRef += 3; // MET reference time is off by 3 sec? 
@@ -65,6 +65,7 @@ private:
 
     std::string _defaultCaptureImage;
     double _metRef = 299180517;
+    double _referenceET = 0.0;
 
     std::string _name;
     std::string _fileName;
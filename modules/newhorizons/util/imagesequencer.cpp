@@ -31,6 +31,7 @@
 #include <modules/newhorizons/util/decoder.h>
 
 #include <openspace/util/spicemanager.h>
+#include <algorithm>
 #include <fstream>
 #include <iterator>
 #include <iomanip>
@@ -230,84 +231,57 @@ float ImageSequencer::instrumentActiveTime(const std::string& instrumentID) cons
     return -1.f;
 }
 
-bool ImageSequencer::getImagePaths(std::vector<Image>& captures, 
-                                    std::string projectee,
-                                    std::string instrumentRequest){
-
+bool ImageSequencer::getCaptures(CaptureIndex::Range& captures,
+                                 const std::string& projectee,
+                                 const std::string& instrumentRequest)
+{
     // check if this instance is either in range or 
     // a valid candidate to recieve data 
     if (!instrumentActive(instrumentRequest) && !Time::ref().timeJumped()) return false;
 
+    auto subset = _subsetMap.find(projectee);
+    if (subset == _subsetMap.end() ||
+        !(subset->second._range.includes(_currentTime) ||
+          subset->second._range.includes(_previousTime)))
+    {
+        return false;
+    }
 
-    //if (!Time::ref().timeJumped() && projectee == getCurrentTarget().second)
-    if (_subsetMap[projectee]._range.includes(_currentTime) ||
-        _subsetMap[projectee]._range.includes(_previousTime)){
-        auto compareTime = [](const Image &a,
-                              const Image &b)->bool{
-            return a.timeRange.start < b.timeRange.start;
-        };        
-        // for readability we store the iterators
-        auto begin = _subsetMap[projectee]._subset.begin(); 
-        auto end   = _subsetMap[projectee]._subset.end();
-        
-        // create temporary storage
-        std::vector<Image> captureTimes;
-        // what to look for 
-        Image findPrevious, findCurrent;
-        findPrevious.timeRange.start = _previousTime;
-        findCurrent.timeRange.start = _currentTime;
-
-        // find the two iterators that correspond to the latest time jump
-        auto curr = std::lower_bound(begin, end, findCurrent , compareTime);
-        auto prev = std::lower_bound(begin, end, findPrevious, compareTime);
-    
-        if (curr != begin && curr != end  && prev != begin && prev != end && prev < curr){
-            if (curr->timeRange.start >= prev->timeRange.start){
-                std::copy_if(prev, curr, back_inserter(captureTimes), 
-                    [instrumentRequest](const Image& i) {
-                    bool correctInstrument = i.activeInstruments[0] == instrumentRequest;
-                    return correctInstrument;
-                });
-
-                //std::reverse(captureTimes.begin(), captureTimes.end());
-                captures = captureTimes;
-                if (!captures.empty())
-                    _latestImages[captures.back().activeInstruments.front()] = captures.back();
-
-                std::vector<int> toDelete;
-                for (auto it = captures.begin(); it != captures.end(); ++it) {
-                    if (it->isPlaceholder) {
-                        double beforeDist = std::numeric_limits<double>::max();
-                        if (it != captures.begin()) {
-                            auto before = std::prev(it);
-                            beforeDist = abs(before->timeRange.start - it->timeRange.start);
-                        }
-                        
-                        double nextDist = std::numeric_limits<double>::max();
-                        if (it != captures.end() - 1) {
-                            auto next = std::next(it);
-                            nextDist = abs(next->timeRange.start - it->timeRange.start);
-                        }
-                        
-                        if (beforeDist < 1.0 || nextDist < 1.0) {
-                            toDelete.push_back(std::distance(captures.begin(), it));
-                        }
-                    }
-                }
-
-                for (size_t i = 0; i < toDelete.size(); ++i) {
-                    // We have to subtract i here as we already have deleted i value
-                    // before this and we need to adjust the location
-                    int v = toDelete[i] - i;
-                    captures.erase(captures.begin() + v);
-                }
+    // Captures are only projected if time moved forward within the captured sequence of
+    // the target. As before, this is decided on the images of all instruments
+    const std::vector<Image>& images = subset->second._subset;
+    auto startsBefore = [](const Image& image, double time) {
+        return image.timeRange.start < time;
+    };
+    auto begin = images.begin();
+    auto end = images.end();
+    auto prev = std::lower_bound(begin, end, _previousTime, startsBefore);
+    auto curr = std::lower_bound(begin, end, _currentTime, startsBefore);
+    if (prev == begin || curr == end || !(prev < curr)) {
+        return false;
+    }
 
-                return true;
-            }
-        }
+    // The range may be empty if only other instruments captured the target
+    captures = _captureIndex.captures(
+        projectee,
+        instrumentRequest,
+        _previousTime,
+        _currentTime
+    );
+    if (!captures.empty()) {
+        _latestImages[instrumentRequest] = _captureIndex.image(
+            *(captures.end() - 1),
+            projectee,
+            instrumentRequest
+        );
     }
-    return false;
+    return true;
 }
+
+const CaptureIndex& ImageSequencer::captureIndex() const {
+    return _captureIndex;
+}
+
 void ImageSequencer::sortData() {
     auto targetComparer = [](const std::pair<double, std::string> &a,
                              const std::pair<double, std::string> &b)->bool{
@@ -386,14 +360,25 @@ void ImageSequencer::runSequenceParser(SequenceParser* parser){
                 
                 // IFF images have same time as mission planned capture, erase that event from 
                 // 'predicted event file' (mission-playbook)
-                for (int i = 0; i < source.size(); i++){
-                    for (int j = 0; j < destination.size(); j++){
-                        double diff = abs(source[i].timeRange.start - destination[j].timeRange.start);
-                        if (diff < epsilon){
-                            source.erase(source.begin() + i);
-                        }
-                    }
+                std::vector<double> imageTimes;
+                imageTimes.reserve(destination.size());
+                for (const Image& image : destination) {
+                    imageTimes.push_back(image.timeRange.start);
                 }
+                std::sort(imageTimes.begin(), imageTimes.end());
+                auto hasImage = [&](const Image& prediction) {
+                    double t = prediction.timeRange.start;
+                    auto it = std::upper_bound(
+                        imageTimes.begin(),
+                        imageTimes.end(),
+                        t - epsilon
+                    );
+                    return it != imageTimes.end() && *it < t + epsilon;
+                };
+                source.erase(
+                    std::remove_if(source.begin(), source.end(), hasImage),
+                    source.end()
+                );
                 // pad image data with predictions (ie - where no actual images, add placeholder) 
                 _subsetMap[key]._subset.insert(_subsetMap[key]._subset.end(), source.begin(), source.end());
             }
@@ -405,6 +390,7 @@ void ImageSequencer::runSequenceParser(SequenceParser* parser){
 
         // sorting of data _not_ optional
         sortData();
+        _captureIndex.set(CaptureIndex::compile(_subsetMap));
 
         // extract payload from _fileTranslation 
         for (auto& t : _fileTranslation){
@@ -35,6 +35,7 @@
 #include <vector>
 
 
+#include <modules/newhorizons/util/captureindex.h>
 #include <modules/newhorizons/util/sequenceparser.h>
 
 
@@ -121,13 +122,31 @@ public:
     std::map<std::string, bool> getActiveInstruments();
 
     /*
-     * Retrieves the relevant data from a specific subset based on the what instance
-     * makes the request. If an instance is not registered in the class then the singleton
-     * returns false and no projections will occur. 
+     * Retrieves the captures of <code>instrumentRequest</code> on <code>projectee</code>
+     * that were taken between the previous and the current time. The returned range
+     * points into the capture index and stays valid until the next call to
+     * runSequenceParser. If an instance is not registered in the class then the
+     * singleton returns false and no projections will occur. It also returns false
+     * unless the target has captures of any instrument before the previous time, between
+     * the two times, and at or after the current time. The range can then still be empty
+     * if only other instruments captured the target.
      */
-    bool getImagePaths(std::vector<Image>& captures,
-                                        std::string projectee,
-                                        std::string instrumentRequest);
+    bool getCaptures(CaptureIndex::Range& captures, const std::string& projectee,
+        const std::string& instrumentRequest);
+
+    /*
+     * Returns the captures of <code>instrument</code> on <code>projectee</code> that
+     * start within <code>duration</code> seconds after the current time, which can be
+     * loaded ahead of time.
+     */
+    CaptureIndex::Range getUpcomingCaptures(const std::string& projectee,
+        const std::string& instrument, double duration) const;
+
+    /*
+     * Returns the index of all captures, which resolves the image paths of the captures
+     * returned by getCaptures.
+     */
+    const CaptureIndex& captureIndex() const;
 
     /*
      * returns true if instrumentID is within a capture range. 
@@ -161,6 +180,12 @@ private:
      */
     std::map<std::string, ImageSubset> _subsetMap;
 
+    /*
+     * The captures of _subsetMap compiled into time-sorted streams per target and
+     * instrument, which is rebuilt whenever a parser adds data.
+     */
+    CaptureIndex _captureIndex;
+
     /*
      * In order for the simulation to know when to turn on/off any instrument within
      * all instruments in the spacecraft payload, the key is the data-file given
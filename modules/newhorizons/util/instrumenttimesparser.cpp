@@ -23,17 +23,18 @@
  ****************************************************************************************/
 
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/filesystem/directory.h>
+#include <openspace/util/mappedfile.h>
+#include <openspace/util/taskgraph.h>
 #include <openspace/util/time.h>
 #include <openspace/util/spicemanager.h>
 #include <modules/newhorizons/util/decoder.h>
-#include <fstream>
+#include <modules/newhorizons/util/linetokenizer.h>
+#include <algorithm>
+#include <cmath>
 #include <string>
-#include <iterator>
-#include <iomanip>
-#include <limits>
-#include <sstream>
 #include <modules/newhorizons/util/instrumenttimesparser.h>
 
 namespace {
@@ -54,7 +55,6 @@ InstrumentTimesParser::InstrumentTimesParser(
     ghoul::Dictionary& inputDict)
     : _name(name)
     , _fileName(sequenceSource) 
-    , _pattern("\"(.{23})\" \"(.{23})\"")
     , _target("")
     , _detectorType("CAMERA")
 {
@@ -76,9 +76,6 @@ InstrumentTimesParser::InstrumentTimesParser(
 
 
 bool InstrumentTimesParser::create() {
-    auto imageComparer = [](const Image &a, const Image &b)->bool{
-        return a.timeRange.start < b.timeRange.start;
-    };
     auto targetComparer = [](const std::pair<double, std::string> &a,
         const std::pair<double, std::string> &b)->bool{
         return a.first < b.first;
@@ -92,8 +89,14 @@ bool InstrumentTimesParser::create() {
         return false;
     }
 
+    struct InstrumentFile {
+        std::string instrumentID;
+        std::string path;
+        std::vector<std::string> dates;
+    };
+    std::vector<InstrumentFile> instrumentFiles;
+    std::vector<std::string> paths;
     for (auto it = _instrumentFiles.begin(); it != _instrumentFiles.end(); it++) {
-        std::string instrumentID = it->first;
         for (std::string filename: it->second) {
             std::string filepath = FileSys.pathByAppendingComponent(sequenceDir.path(), filename);
             
@@ -101,66 +104,93 @@ bool InstrumentTimesParser::create() {
                 LERROR("Unable to read file " << filepath << ". Skipping file.");
                 continue;
             }
+            instrumentFiles.push_back({ it->first, filepath, {} });
+            paths.push_back(filepath);
+        }
+    }
 
-            // Read file into string 
-            std::ifstream inFile(filepath);
-            std::string line;
-            std::smatch matches;
-            TimeRange instrumentActiveTimeRange;
-            bool successfulRead = true;
-            while (std::getline(inFile, line)) {
-                if (std::regex_match(line, matches, _pattern)) {
-                    if (matches.size() != 3) {
-                        LERROR("Bad event data formatting. Must \
-                                have regex 3 matches (source string, start time, stop time).");
-                        successfulRead = false;
-                        break;
-                    }
-                    
-                    TimeRange captureTimeRange;
-                    try { // parse date strings
-                        std::string start = matches[1].str();
-                        std::string stop = matches[2].str();
-                        captureTimeRange.start = SpiceManager::ref().ephemerisTimeFromDate(start);
-                        captureTimeRange.end = SpiceManager::ref().ephemerisTimeFromDate(stop);
-                    }
-                    catch (const SpiceManager::SpiceException& e){
-                        LERROR(e.what());
-                        successfulRead = false;
-                        break;
-                    }
-
-                    instrumentActiveTimeRange.include(captureTimeRange);
-
-                    //_instrumentTimes.push_back({ instrumentID, timeRange });
-                    _targetTimes.push_back({ captureTimeRange.start, _target });
-                    _captureProgression.push_back(captureTimeRange.start);
-
-                    Image image;
-                    image.timeRange = captureTimeRange;
-                    image.path = "";
-                    image.isPlaceholder = true;
-                    image.activeInstruments.push_back(instrumentID);
-                    image.target = _target;
-                    image.projected = false;
-
-                    _subsetMap[_target]._subset.push_back(image);
+    std::vector<SourceFile> sources = sourceFiles(paths);
+    std::string settings = translationSettings(_fileTranslation) + _target;
+    std::string cacheFile = FileSys.cacheManager()->cachedFilename(
+        _fileName,
+        PlaybookIdentifierName,
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
+    if (loadCache(cacheFile, settings, sources)) {
+        LINFO("Loaded " << _captureProgression.size() << " captures from cache");
+        sendPlaybookInformation(PlaybookIdentifierName);
+        return true;
+    }
+
+    // Each line contains the start and stop time of a capture, in the format
+    // "YYYY-MM-DDTHH:MM:SS.sss" "YYYY-MM-DDTHH:MM:SS.sss"; all other lines are ignored
+    TaskGraph tasks;
+    for (InstrumentFile& file : instrumentFiles) {
+        tasks.addTask([&file]() {
+            MappedFile mapping(file.path);
+            LineTokenizer lines(mapping.data(), mapping.size());
+            LineTokenizer::Token line;
+            while (lines.next(line)) {
+                const char* l = line.begin;
+                bool isCapture = line.size() == 51 && l[0] == '"' && l[24] == '"' &&
+                                 l[25] == ' ' && l[26] == '"' && l[50] == '"';
+                if (isCapture) {
+                    file.dates.push_back(line.substr(1, 23).str());
+                    file.dates.push_back(line.substr(27, 23).str());
                 }
             }
-            if (successfulRead){
-                _subsetMap[_target]._range.include(instrumentActiveTimeRange);
-                _instrumentTimes.push_back({ instrumentID, instrumentActiveTimeRange });
+        });
+    }
+    tasks.run();
+
+    std::vector<std::string> dates;
+    for (const InstrumentFile& file : instrumentFiles) {
+        dates.insert(dates.end(), file.dates.begin(), file.dates.end());
+    }
+    std::vector<double> times = ephemerisTimesFromDates(dates);
+
+    size_t iTime = 0;
+    for (const InstrumentFile& file : instrumentFiles) {
+        TimeRange instrumentActiveTimeRange;
+        bool successfulRead = true;
+        for (size_t i = 0; i < file.dates.size(); i += 2) {
+            TimeRange captureTimeRange;
+            captureTimeRange.start = times[iTime + i];
+            captureTimeRange.end = times[iTime + i + 1];
+            if (std::isnan(captureTimeRange.start) || std::isnan(captureTimeRange.end)) {
+                successfulRead = false;
+                break;
             }
+
+            instrumentActiveTimeRange.include(captureTimeRange);
+
+            _targetTimes.push_back({ captureTimeRange.start, _target });
+            _captureProgression.push_back(captureTimeRange.start);
+
+            Image image;
+            image.timeRange = captureTimeRange;
+            image.path = "";
+            image.isPlaceholder = true;
+            image.activeInstruments.push_back(file.instrumentID);
+            image.target = _target;
+            image.projected = false;
+
+            _subsetMap[_target]._subset.push_back(image);
+        }
+        iTime += file.dates.size();
+
+        if (successfulRead){
+            _subsetMap[_target]._range.include(instrumentActiveTimeRange);
+            _instrumentTimes.push_back({ file.instrumentID, instrumentActiveTimeRange });
         }
     }
     
     std::stable_sort(_captureProgression.begin(), _captureProgression.end());
-    //std::stable_sort(_instrumentTimes.begin(), _instrumentTimes.end());
     std::stable_sort(_targetTimes.begin(), _targetTimes.end(), targetComparer);
 
+    saveCache(cacheFile, settings, sources);
     sendPlaybookInformation(PlaybookIdentifierName);
     return true;
 }
 
-
 }
\ No newline at end of file
@@ -33,7 +33,6 @@
 #include <map>
 #include <string>
 #include <vector>
-#include <regex>
 
 namespace openspace {
 class InstrumentTimesParser : public SequenceParser{
@@ -46,8 +45,6 @@ public:
     bool create() override;
 
 private:
-    std::regex _pattern;
-
     std::map<std::string, std::vector<std::string>> _instrumentFiles;
 
     std::string _name;
@@ -25,20 +25,20 @@
 #include <modules/newhorizons/util/labelparser.h>
 
 #include <modules/newhorizons/util/decoder.h>
+#include <modules/newhorizons/util/labelreader.h>
 
 #include <openspace/util/spicemanager.h>
 #include <openspace/util/time.h>
 
+#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/directory.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/io/texture/texturereader.h>
 #include <ghoul/logging/logmanager.h>
 
-#include <fstream>
-#include <iterator>
-#include <iomanip>
-#include <limits>
-
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
 
 namespace {
     const std::string _loggerCat = "LabelParser";
@@ -105,31 +105,26 @@ LabelParser::LabelParser(std::string name, std::string fileName,
     }
 }
 
-std::string LabelParser::decode(std::string line){
-    for (auto& key : _fileTranslation){
-        std::size_t value = line.find(key.first);
-        if (value != std::string::npos){
-            std::string toTranslate = line.substr(value);
-            
-            //if (_fileTranslation.find(toTranslate) == _fileTranslation.end()) {
-            //    // not found
-            //    _badDecoding = true;
-            //    LERROR("Could not fins '" << toTranslate << "' in translation map." <<
-            //           "\nPlease check label files");
-            //    return "";
-            //}
-            return _fileTranslation[toTranslate]->getTranslation()[0]; //lbls always 1:1 -> single value return
-
+std::string LabelParser::decode(const std::string& value) {
+    for (const auto& key : _fileTranslation) {
+        std::size_t position = value.find(key.first);
+        if (position != std::string::npos) {
+            auto it = _fileTranslation.find(value.substr(position));
+            if (it == _fileTranslation.end()) {
+                return "";
+            }
+            //lbls always 1:1 -> single value return
+            return it->second->getTranslation()[0];
         }
     }
     return "";
 }
 
-std::string LabelParser::encode(std::string line) {
-    for (auto& key : _fileTranslation) {
-        std::size_t value = line.find(key.first);
-        if (value != std::string::npos) {
-            return line.substr(value);
+std::string LabelParser::encode(const std::string& value) {
+    for (const auto& key : _fileTranslation) {
+        std::size_t position = value.find(key.first);
+        if (position != std::string::npos) {
+            return value.substr(position);
         }
     }
     return "";
@@ -139,10 +134,6 @@ bool LabelParser::create() {
     auto imageComparer = [](const Image &a, const Image &b)->bool{
         return a.timeRange.start < b.timeRange.start;
     };
-    auto targetComparer = [](const std::pair<double, std::string> &a,
-        const std::pair<double, std::string> &b)->bool{
-        return a.first < b.first;
-    };
     std::string previousTarget;
     std::string lblName = "";
 
@@ -154,163 +145,104 @@ bool LabelParser::create() {
     }
     using Recursive = ghoul::filesystem::Directory::Recursive;
     using Sort = ghoul::filesystem::Directory::Sort;
-    std::vector<std::string> sequencePaths = sequenceDir.read(Recursive::Yes, Sort::No);
-    for (auto path : sequencePaths){
-        if (size_t position = path.find_last_of(".") + 1){
-            if (position != std::string::npos){
-                ghoul::filesystem::File currentFile(path);
-                std::string extension = currentFile.fileExtension();
-                if (extension == "lbl" || extension == "LBL"){ // discovered header file         
-                    std::ifstream file(currentFile.path());
-
-                    if (!file.good()){
-                        LERROR("Failed to open label file '" << currentFile.path() << "'");
-                        return false;
-                    }
-                    
-                    int count = 0;
-
-                    // open up label files
-                    std::string line = "";
-                    TimeRange instrumentRange;
-
-                    double startTime = 0.0;
-                    double stopTime = 0.0;
-                    do {
-                        std::getline(file, line);
-
-                        std::string read = line.substr(0, line.find_first_of(" "));
-
-                        line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-                        line.erase(std::remove(line.begin(), line.end(), ' '), line.end());
-                        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-
-                        _detectorType = "CAMERA"; //default value
-
-                        /* Add more  */
-                        if (read == "TARGET_NAME"){
-                            _target = decode(line);
-                            count++;
-                        }
-                        if (read == "INSTRUMENT_HOST_NAME"){
-                            _instrumentHostID = decode(line);
-                            count++;
-                        }
-                        if (read == "INSTRUMENT_ID"){
-                            _instrumentID = decode(line);
-                            lblName = encode(line);
-                            count++;
-                        }
-                        if (read == "DETECTOR_TYPE"){
-                            _detectorType = decode(line);
-                            count++; 
-                        }
-                    //    if (_badDecoding){
-                    //        LERROR("Please examine file: '" << currentFile.path() << "'");
-                    //        return false;
-                    //    }
-
-                        
-                        if (read == "START_TIME"){
-                            std::string start = line.substr(line.find("=") + 2);
-                            start.erase(std::remove(start.begin(), start.end(), ' '), start.end());
-                            startTime = SpiceManager::ref().ephemerisTimeFromDate(start);
-                            count++;
-
-                            getline(file, line);
-                            read = line.substr(0, line.find_first_of(" "));
-                            if (read == "STOP_TIME"){
-                                std::string stop = line.substr(line.find("=") + 2);
-                                stop.erase(
-                                    std::remove_if(
-                                        stop.begin(),
-                                        stop.end(),
-                                        [](char c) { return c == ' ' || c == '\r'; }
-                                    ),
-                                    stop.end()
-                                );
-                                stopTime = SpiceManager::ref().ephemerisTimeFromDate(stop);
-                                count++;
-                            }
-                            else{
-                                LERROR("Label file " + currentFile.path() + " deviates from generic standard!");
-                                LINFO("Please make sure input data adheres to format https://pds.jpl.nasa.gov/documents/qs/labels.html");
-                            }
-                        }
-                        if (count == _specsOfInterest.size()) {
-                            using ghoul::io::TextureReader;
-                            auto extensions = TextureReader::ref().supportedExtensions();
-
-                            count = 0;
-
-                            using namespace std::literals;
-                            std::string p = path.substr(0, path.size() - ("lbl"s).size());
-                            for (const std::string& ext : extensions) {
-                                path = p + ext;
-                                if (FileSys.fileExists(path)) {
-                                    Image image;
-                                    std::vector<std::string> spiceInstrument;
-                                    spiceInstrument.push_back(_instrumentID);
-                                    createImage(image, startTime, stopTime, spiceInstrument, _target, path);
-
-                                    _subsetMap[image.target]._subset.push_back(image);
-                                    _subsetMap[image.target]._range.include(startTime);
-
-                                    _captureProgression.push_back(startTime);
-                                    std::stable_sort(_captureProgression.begin(), _captureProgression.end());
-
-                                    break;
-                                }
-                            }
-                        }
-                    } while (!file.eof());
-                }
+    std::vector<std::string> sequencePaths = sequenceDir.read(Recursive::Yes, Sort::Yes);
+
+    // The images belonging to the labels are part of the sources, as adding or removing
+    // an image changes the results as well
+    std::vector<SourceFile> sources = sourceFiles(sequencePaths);
+    std::string settings = translationSettings(_fileTranslation);
+    for (const std::string& spec : _specsOfInterest) {
+        settings += spec + ";";
+    }
+    using ghoul::io::TextureReader;
+    std::vector<std::string> extensions = TextureReader::ref().supportedExtensions();
+    for (const std::string& ext : extensions) {
+        settings += ext + ";";
+    }
+
+    std::string cacheFile = FileSys.cacheManager()->cachedFilename(
+        _fileName,
+        PlaybookIdentifierName,
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
+    if (loadCache(cacheFile, settings, sources)) {
+        LINFO("Loaded " << _captureProgression.size() << " captures from cache");
+        sendPlaybookInformation(PlaybookIdentifierName);
+        return true;
+    }
+
+    std::vector<std::string> labelPaths;
+    for (const std::string& path : sequencePaths) {
+        std::string extension = ghoul::filesystem::File(path).fileExtension();
+        if (extension == "lbl" || extension == "LBL") { // discovered header file
+            labelPaths.push_back(path);
+        }
+    }
+
+    std::vector<LabelReader::Label> labels =
+        LabelReader(_specsOfInterest.size()).read(labelPaths);
+
+    std::vector<std::string> dates;
+    dates.reserve(2 * labels.size());
+    for (const LabelReader::Label& label : labels) {
+        dates.push_back(label.startTime);
+        dates.push_back(label.stopTime);
+    }
+    std::vector<double> times = ephemerisTimesFromDates(dates);
+
+    std::unordered_set<std::string> files(sequencePaths.begin(), sequencePaths.end());
+    for (size_t i = 0; i < labels.size(); ++i) {
+        const LabelReader::Label& label = labels[i];
+        lblName = encode(label.instrumentId);
+
+        double startTime = times[2 * i];
+        double stopTime = times[2 * i + 1];
+        if (std::isnan(startTime) || std::isnan(stopTime)) {
+            LERROR("Label file '" << label.path << "' has invalid capture times");
+            continue;
+        }
+
+        using namespace std::literals;
+        std::string p = label.path.substr(0, label.path.size() - ("lbl"s).size());
+        for (const std::string& ext : extensions) {
+            std::string path = p + ext;
+            if (files.find(path) != files.end()) {
+                Image image;
+                std::vector<std::string> spiceInstrument;
+                spiceInstrument.push_back(decode(label.instrumentId));
+                std::string target = decode(label.targetName);
+                createImage(image, startTime, stopTime, spiceInstrument, target, path);
+
+                _subsetMap[image.target]._subset.push_back(image);
+                _subsetMap[image.target]._range.include(startTime);
+
+                _captureProgression.push_back(startTime);
+                break;
             }
         }
     }
-    
+    std::stable_sort(_captureProgression.begin(), _captureProgression.end());
+
     std::vector<Image> tmp;
     for (auto key : _subsetMap){
         for (auto image : key.second._subset){
             tmp.push_back(image);
         }
     }
-    std::sort(tmp.begin(), tmp.end(), imageComparer);
+    std::stable_sort(tmp.begin(), tmp.end(), imageComparer);
 
     for (auto image : tmp){
         if (previousTarget != image.target){
             previousTarget = image.target;
-            std::pair<double, std::string> v_target = std::make_pair(image.timeRange.start, image.target);
-            _targetTimes.push_back(v_target);
-            std::sort(_targetTimes.begin(), _targetTimes.end(), targetComparer);
+            _targetTimes.push_back(std::make_pair(image.timeRange.start, image.target));
         }
     }
 
     for (auto target : _subsetMap){
-        _instrumentTimes.push_back(std::make_pair(lblName, _subsetMap[target.first]._range));
-
-    //    std::string min, max;
-    //    SpiceManager::ref().getDateFromET(target.second._range._min, min);
-    //    SpiceManager::ref().getDateFromET(target.second._range._max, max);
-
-    //    myfile << std::endl;
-    //    for (auto image : target.second._subset){
-    //        std::string time_beg;
-    //        std::string time_end;
-    //        SpiceManager::ref().getDateFromET(image.startTime, time_beg);
-    //        SpiceManager::ref().getDateFromET(image.stopTime, time_end);
-
-    //        myfile << std::fixed
-    //            << " "   << time_beg
-    //            << "-->" << time_end
-    //            << " [ " << image.startTime
-    //            << " ] "   << image.target << std::setw(10);
-    //        for (auto instrument : image.activeInstruments){
-    //            myfile << " " << instrument;
-    //        }
-    //        myfile << std::endl;
-    //    }
+        _instrumentTimes.push_back(std::make_pair(lblName, target.second._range));
     }
+
+    saveCache(cacheFile, settings, sources);
     sendPlaybookInformation(PlaybookIdentifierName);
     return true;
 }
@@ -53,8 +53,8 @@ private:
                         std::string targ,
                         std::string path);
 
-    std::string decode(std::string line);
-    std::string encode(std::string line);
+    std::string decode(const std::string& value);
+    std::string encode(const std::string& value);
 
     bool augmentWithSpice(Image& image, 
                             std::string spacecraft, 
@@ -66,10 +66,6 @@ private:
     std::string _spacecraft;
     std::vector<std::string> _specsOfInterest;
 
-    std::string _target;
-    std::string _instrumentID;
-    std::string _instrumentHostID;
-    std::string _detectorType;
     std::string _sequenceID;
     bool _badDecoding;
 };
@@ -0,0 +1,160 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/newhorizons/util/labelreader.h>
+
+#include <modules/newhorizons/util/linetokenizer.h>
+
+#include <openspace/util/taskgraph.h>
+
+#include <ghoul/logging/logmanager.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const std::string _loggerCat = "LabelReader";
+
+    // Number of files that are read by one task
+    const size_t FilesPerTask = 64;
+
+    using Token = openspace::LineTokenizer::Token;
+
+    // The keyword is everything up to the first space
+    Token keyword(const Token& line) {
+        return line.substr(0, line.find(' '));
+    }
+
+    // The value is everything after the first '=', with quotes and spaces removed
+    std::string value(const Token& line) {
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            return "";
+        }
+        std::string result;
+        result.reserve(line.size() - equals);
+        std::copy_if(
+            line.begin + equals + 1,
+            line.end,
+            std::back_inserter(result),
+            [](char c) { return c != '"' && c != ' ' && c != '\r'; }
+        );
+        return result;
+    }
+} // namespace
+
+namespace openspace {
+
+LabelReader::LabelReader(size_t nKeywords)
+    : _nKeywords(nKeywords)
+{}
+
+std::vector<LabelReader::Label> LabelReader::read(const std::vector<std::string>& paths,
+                                                  unsigned int nThreads) const
+{
+    size_t nTasks = (paths.size() + FilesPerTask - 1) / FilesPerTask;
+    std::vector<std::vector<Label>> results(nTasks);
+
+    TaskGraph tasks;
+    for (size_t i = 0; i < results.size(); ++i) {
+        tasks.addTask([this, &paths, &results, i]() {
+            // Label files are only a few kilobytes large, so they are read into a reused
+            // buffer, which is cheaper than mapping and unmapping each of them
+            std::vector<char> buffer;
+            size_t end = std::min(paths.size(), (i + 1) * FilesPerTask);
+            for (size_t j = i * FilesPerTask; j < end; ++j) {
+                std::ifstream file(paths[j], std::ifstream::binary | std::ifstream::ate);
+                if (!file.good()) {
+                    LWARNING("Could not read label file '" << paths[j] << "'");
+                    continue;
+                }
+                buffer.resize(static_cast<size_t>(file.tellg()));
+                file.seekg(0);
+                file.read(buffer.data(), buffer.size());
+                readLabel(paths[j], buffer.data(), buffer.size(), results[i]);
+            }
+        });
+    }
+    tasks.run(nThreads);
+
+    std::vector<Label> labels;
+    for (std::vector<Label>& r : results) {
+        std::move(r.begin(), r.end(), std::back_inserter(labels));
+    }
+    return labels;
+}
+
+void LabelReader::readLabel(const std::string& path, const char* data, size_t size,
+                            std::vector<Label>& labels) const
+{
+    LineTokenizer lines(data, size);
+    Label label;
+    label.path = path;
+    size_t count = 0;
+
+    Token line;
+    while (lines.next(line)) {
+        Token key = keyword(line);
+
+        if (key == "TARGET_NAME") {
+            label.targetName = value(line);
+            ++count;
+        }
+        else if (key == "INSTRUMENT_HOST_NAME") {
+            label.instrumentHostName = value(line);
+            ++count;
+        }
+        else if (key == "INSTRUMENT_ID") {
+            label.instrumentId = value(line);
+            ++count;
+        }
+        else if (key == "DETECTOR_TYPE") {
+            label.detectorType = value(line);
+            ++count;
+        }
+        else if (key == "START_TIME") {
+            label.startTime = value(line);
+            ++count;
+
+            // The stop time has to follow directly after the start time
+            if (lines.next(line) && keyword(line) == "STOP_TIME") {
+                label.stopTime = value(line);
+                ++count;
+            }
+            else {
+                LERROR("Label file " << path << " deviates from generic standard!");
+                LINFO("Please make sure input data adheres to format " <<
+                      "https://pds.jpl.nasa.gov/documents/qs/labels.html");
+            }
+        }
+
+        if (count == _nKeywords) {
+            labels.push_back(label);
+            count = 0;
+        }
+    }
+}
+
+} // namespace openspace
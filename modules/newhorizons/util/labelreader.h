@@ -0,0 +1,78 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __LABELREADER_H__
+#define __LABELREADER_H__
+
+#include <string>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Reads the keywords that describe a captured image from PDS label files. Each file is
+ * read at once and tokenized in place, and several files are read in parallel. The
+ * values are returned as they appear in the files, with quotes and spaces removed; they
+ * are neither translated nor converted to times, as that is the responsibility of the
+ * LabelParser.
+ */
+class LabelReader {
+public:
+    struct Label {
+        std::string path;
+        std::string targetName;
+        std::string instrumentHostName;
+        std::string instrumentId;
+        std::string detectorType;
+        std::string startTime;
+        std::string stopTime;
+    };
+
+    /**
+     * Creates a reader that emits a Label whenever \p nKeywords of the keywords
+     * <code>TARGET_NAME</code>, <code>INSTRUMENT_HOST_NAME</code>,
+     * <code>INSTRUMENT_ID</code>, <code>DETECTOR_TYPE</code>, <code>START_TIME</code>,
+     * and <code>STOP_TIME</code> have been read from a file.
+     */
+    LabelReader(size_t nKeywords);
+
+    /**
+     * Reads all label files in \p paths on \p nThreads threads, or one per core if
+     * \p nThreads is 0.
+     * \returns The labels in the order of \p paths
+     */
+    std::vector<Label> read(const std::vector<std::string>& paths,
+        unsigned int nThreads = 0) const;
+
+    /// Reads the labels contained in the \p size bytes at \p data
+    void readLabel(const std::string& path, const char* data, size_t size,
+        std::vector<Label>& labels) const;
+
+private:
+    size_t _nKeywords;
+};
+
+} // namespace openspace
+
+#endif // __LABELREADER_H__
@@ -0,0 +1,102 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/newhorizons/util/linetokenizer.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace openspace {
+
+size_t LineTokenizer::Token::size() const {
+    return static_cast<size_t>(end - begin);
+}
+
+bool LineTokenizer::Token::empty() const {
+    return begin == end;
+}
+
+std::string LineTokenizer::Token::str() const {
+    return std::string(begin, end);
+}
+
+size_t LineTokenizer::Token::find(char c) const {
+    const char* p = std::find(begin, end, c);
+    return p == end ? std::string::npos : static_cast<size_t>(p - begin);
+}
+
+size_t LineTokenizer::Token::find(const std::string& s) const {
+    const char* p = std::search(begin, end, s.begin(), s.end());
+    return p == end && !s.empty() ? std::string::npos : static_cast<size_t>(p - begin);
+}
+
+LineTokenizer::Token LineTokenizer::Token::substr(size_t pos, size_t length) const {
+    pos = std::min(pos, size());
+    length = std::min(length, size() - pos);
+    return { begin + pos, begin + pos + length };
+}
+
+bool LineTokenizer::Token::operator==(const char* s) const {
+    size_t length = std::strlen(s);
+    return length == size() && std::equal(begin, end, s);
+}
+
+LineTokenizer::LineTokenizer(const char* data, size_t size)
+    : _data(data)
+    , _size(size)
+    , _position(0)
+{}
+
+bool LineTokenizer::next(Token& line) {
+    if (_position >= _size) {
+        return false;
+    }
+
+    const char* begin = _data + _position;
+    const char* last = _data + _size;
+    const char* end = static_cast<const char*>(std::memchr(begin, '\n', last - begin));
+    if (end) {
+        _position = static_cast<size_t>(end - _data) + 1;
+    }
+    else {
+        end = last;
+        _position = _size;
+    }
+
+    if (end != begin && *(end - 1) == '\r') {
+        --end;
+    }
+    line = { begin, end };
+    return true;
+}
+
+size_t LineTokenizer::position() const {
+    return _position;
+}
+
+void LineTokenizer::setPosition(size_t position) {
+    _position = std::min(position, _size);
+}
+
+} // namespace openspace
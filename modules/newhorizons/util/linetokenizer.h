@@ -0,0 +1,80 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __LINETOKENIZER_H__
+#define __LINETOKENIZER_H__
+
+#include <cstddef>
+#include <string>
+
+namespace openspace {
+
+/**
+ * Splits text that is held in memory, for example a MappedFile, into lines without
+ * copying it. Lines may be terminated by <code>\\n</code> or <code>\\r\\n</code>; the
+ * terminators are not part of the returned lines.
+ */
+class LineTokenizer {
+public:
+    /// A range of characters that points into the tokenized text
+    struct Token {
+        const char* begin;
+        const char* end;
+
+        size_t size() const;
+        bool empty() const;
+        std::string str() const;
+
+        /// Returns the position of the first occurrence of \p c or std::string::npos
+        size_t find(char c) const;
+        /// Returns the position of the first occurrence of \p s or std::string::npos
+        size_t find(const std::string& s) const;
+
+        /// Returns the characters in [\p pos, \p pos + \p length), clamped to the token
+        Token substr(size_t pos, size_t length = std::string::npos) const;
+
+        bool operator==(const char* s) const;
+    };
+
+    LineTokenizer(const char* data, size_t size);
+
+    /**
+     * Stores the next line in \p line.
+     * \returns <code>false</code> if the end of the text has been reached
+     */
+    bool next(Token& line);
+
+    /// Returns the offset of the line that will be returned by the next call to next
+    size_t position() const;
+    void setPosition(size_t position);
+
+private:
+    const char* _data;
+    size_t _size;
+    size_t _position;
+};
+
+} // namespace openspace
+
+#endif // __LINETOKENIZER_H__
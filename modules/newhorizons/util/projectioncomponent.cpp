@@ -30,6 +30,7 @@
 #include <modules/newhorizons/util/labelparser.h>
 
 #include <openspace/scene/scenegraphnode.h>
+#include <openspace/util/time.h>
 
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/io/texture/texturereader.h>
@@ -37,6 +38,10 @@
 #include <ghoul/opengl/textureconversion.h>
 #include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
 
+#ifdef GHOUL_USE_DEVIL
+#include <IL/il.h>
+#endif // GHOUL_USE_DEVIL
+
 namespace {
     const std::string keyPotentialTargets = "PotentialTargets";
 
@@ -65,6 +70,94 @@ namespace {
         "${OPENSPACE_DATA}/scene/common/textures/placeholder.png";
 
     const std::string _loggerCat = "ProjectionComponent";
+
+    // The number of decoded projection images that are kept in memory
+    const size_t ImageCacheSize = 64;
+    // The images of captures within this many seconds of wall-clock time are decoded
+    // ahead of time
+    const double PrefetchDuration = 2.0;
+
+    using openspace::ProjectionComponent;
+
+    // Called with the imageReaderMutex held. TextureReader creates an OpenGL texture,
+    // which needs the context of the main thread, so the worker threads read images
+    // with DevIL directly and the texture is only created in uploadProjectionImage
+    std::unique_ptr<ProjectionComponent::DecodedImage> decodeProjectionImage(
+                                                                  const std::string& path)
+    {
+        std::unique_ptr<ProjectionComponent::DecodedImage> image =
+            std::make_unique<ProjectionComponent::DecodedImage>();
+        image->path = absPath(path);
+        image->size = glm::uvec2(0);
+        image->nChannels = 0;
+#ifdef GHOUL_USE_DEVIL
+        ilInit();
+        ILuint id = ilGenImage();
+        ilBindImage(id);
+        if (ilLoadImage(image->path.c_str()) == IL_FALSE) {
+            ilDeleteImage(id);
+            return nullptr;
+        }
+
+        // Red images are projected as gray, so everything is converted to RGB(A)
+        ILint format = ilGetInteger(IL_IMAGE_FORMAT);
+        bool hasAlpha = format == IL_RGBA || format == IL_BGRA ||
+                        format == IL_LUMINANCE_ALPHA;
+        image->size = glm::uvec2(
+            ilGetInteger(IL_IMAGE_WIDTH),
+            ilGetInteger(IL_IMAGE_HEIGHT)
+        );
+        image->nChannels = hasAlpha ? 4 : 3;
+        image->data = std::make_unique<unsigned char[]>(
+            image->size.x * image->size.y * image->nChannels
+        );
+        ilCopyPixels(
+            0, 0, 0,
+            image->size.x, image->size.y, 1,
+            hasAlpha ? IL_RGBA : IL_RGB,
+            IL_UNSIGNED_BYTE,
+            image->data.get()
+        );
+        ilDeleteImage(id);
+#endif // GHOUL_USE_DEVIL
+        return image;
+    }
+
+    // Called on the main thread
+    std::unique_ptr<ghoul::opengl::Texture> uploadProjectionImage(
+                                                 ProjectionComponent::DecodedImage& image)
+    {
+        using ghoul::opengl::Texture;
+        std::unique_ptr<Texture> texture;
+        if (image.data) {
+            bool hasAlpha = image.nChannels == 4;
+            texture = std::make_unique<Texture>(
+                image.data.release(),
+                glm::uvec3(image.size, 1),
+                hasAlpha ? Texture::Format::RGBA : Texture::Format::RGB,
+                hasAlpha ? GL_RGBA : GL_RGB,
+                GL_UNSIGNED_BYTE
+            );
+        }
+        else {
+            // Without a reader that decodes into memory, the image is read here
+            std::lock_guard<std::mutex> lock(openspace::imageReaderMutex());
+            texture = ghoul::io::TextureReader::ref().loadTexture(image.path);
+            if (texture && texture->format() == Texture::Format::Red) {
+                ghoul::opengl::convertTextureFormat(Texture::Format::RGB, *texture);
+            }
+        }
+        if (!texture) {
+            return nullptr;
+        }
+
+        texture->uploadTexture();
+        // TODO: AnisotropicMipMap crashes on ATI cards ---abock
+        //_textureProj->setFilter(ghoul::opengl::Texture::FilterMode::AnisotropicMipMap);
+        texture->setFilter(Texture::FilterMode::Linear);
+        texture->setWrapping(Texture::WrappingMode::ClampToBorder);
+        return texture;
+    }
 }
 
 namespace openspace {
@@ -77,6 +170,7 @@ ProjectionComponent::ProjectionComponent()
     , _performProjection("performProjection", "Perform Projections", true)
     , _clearAllProjections("clearAllProjections", "Clear Projections", false)
     , _projectionFading("projectionFading", "Projection Fading", 1.f, 0.f, 1.f)
+    , _maxUploadsPerFrame("maxUploadsPerFrame", "Image Uploads per Frame", 4, 1, 64)
     , _textureSize("textureSize", "Texture Size", ivec2(16), ivec2(16), ivec2(32768))
     , _applyTextureSize("applyTextureSize", "Apply Texture Size")
     , _textureSizeDirty(false)
@@ -90,6 +184,7 @@ ProjectionComponent::ProjectionComponent()
     addProperty(_performProjection);
     addProperty(_clearAllProjections);
     addProperty(_projectionFading);
+    addProperty(_maxUploadsPerFrame);
 
     addProperty(_textureSize);
     addProperty(_applyTextureSize);
@@ -124,7 +219,11 @@ bool ProjectionComponent::initialize() {
     using ghoul::opengl::Texture;
     using ghoul::io::TextureReader;
 
-    unique_ptr<Texture> texture = TextureReader::ref().loadTexture(absPath(placeholderFile));
+    unique_ptr<Texture> texture;
+    {
+        std::lock_guard<std::mutex> lock(imageReaderMutex());
+        texture = TextureReader::ref().loadTexture(absPath(placeholderFile));
+    }
     if (texture) {
         texture->uploadTexture();
         // TODO: AnisotropicMipMap crashes on ATI cards ---abock
@@ -133,6 +232,12 @@ bool ProjectionComponent::initialize() {
         texture->setWrapping(Texture::WrappingMode::ClampToBorder);
     }
     _placeholderTexture = std::move(texture);
+
+    _imageLoader = std::make_unique<ImageLoader>(
+        decodeProjectionImage,
+        uploadProjectionImage,
+        ImageCacheSize
+    );
     
     if (_dilation.isEnabled) {
         _dilation.program = ghoul::opengl::ProgramObject::Build(
@@ -175,6 +280,9 @@ bool ProjectionComponent::initialize() {
 bool ProjectionComponent::deinitialize() {
     _projectionTexture = nullptr;
 
+    _queuedProjections.clear();
+    _imageLoader = nullptr;
+
     glDeleteFramebuffers(1, &_fboID);
 
     if (_dilation.isEnabled) {
@@ -586,6 +694,91 @@ void ProjectionComponent::update() {
     if (_dilation.isEnabled && _dilation.program->isDirty()) {
         _dilation.program->rebuildFromFile();
     }
+
+    prefetchUpcomingImages();
+}
+
+void ProjectionComponent::prefetchUpcomingImages() {
+    if (!_imageLoader || !_performProjection || !ImageSequencer::ref().isReady()) {
+        return;
+    }
+
+    // Projections only happen while time moves forward
+    double deltaTime = Time::ref().deltaTime();
+    if (deltaTime <= 0.0) {
+        return;
+    }
+
+    // Images that are already queued for projection are needed first
+    size_t nRequests = 0;
+    for (const QueuedProjection& p : _queuedProjections) {
+        if (nRequests++ == ImageCacheSize / 2) {
+            return;
+        }
+        if (!p.isPlaceholder) {
+            _imageLoader->prefetch(p.path);
+        }
+    }
+
+    const ImageSequencer& sequencer = ImageSequencer::ref();
+    CaptureIndex::Range upcoming = sequencer.getUpcomingCaptures(
+        _projecteeID,
+        _instrumentID,
+        deltaTime * PrefetchDuration
+    );
+    for (const CaptureIndex::Capture& capture : upcoming) {
+        if (nRequests++ == ImageCacheSize / 2) {
+            return;
+        }
+        if (!capture.isPlaceholder) {
+            _imageLoader->prefetch(sequencer.captureIndex().path(capture));
+        }
+    }
+}
+
+void ProjectionComponent::queueProjections(const CaptureIndex::Range& captures,
+                                           const CaptureIndex& index)
+{
+    for (const CaptureIndex::Capture& capture : captures) {
+        _queuedProjections.push_back({
+            capture.start,
+            index.path(capture),
+            capture.isPlaceholder != 0
+        });
+    }
+}
+
+std::vector<ProjectionComponent::Projection> ProjectionComponent::readyProjections() {
+    std::vector<Projection> result;
+    if (!_imageLoader) {
+        return result;
+    }
+
+    unsigned int uploadBudget = static_cast<unsigned int>(_maxUploadsPerFrame.value());
+    while (!_queuedProjections.empty()) {
+        const QueuedProjection& p = _queuedProjections.front();
+        if (p.isPlaceholder) {
+            result.push_back({ p.time, _placeholderTexture });
+            _queuedProjections.pop_front();
+            continue;
+        }
+
+        std::shared_ptr<ghoul::opengl::Texture> texture;
+        using Status = ImageLoader::Status;
+        Status status = _imageLoader->texture(p.path, uploadBudget, texture);
+        if (status == Status::Pending) {
+            // Later images must not be projected before this one, so they wait
+            break;
+        }
+        if (status == Status::Ready) {
+            result.push_back({ p.time, std::move(texture) });
+        }
+        else {
+            LWARNING("Could not load projection image '" << p.path << "'");
+        }
+        _queuedProjections.pop_front();
+    }
+    return result;
 }
 
 bool ProjectionComponent::depthRendertarget() {
@@ -774,6 +967,11 @@ void ProjectionComponent::clearAllProjections() {
                m_viewport[2], m_viewport[3]);
 
     _clearAllProjections = false;
+
+    _queuedProjections.clear();
+    if (_imageLoader) {
+        _imageLoader->cancelRequests();
+    }
 }
 
 std::shared_ptr<ghoul::opengl::Texture> ProjectionComponent::loadProjectionTexture(
@@ -782,7 +980,6 @@ std::shared_ptr<ghoul::opengl::Texture> ProjectionComponent::loadProjectionTextu
 {
     using std::unique_ptr;
     using ghoul::opengl::Texture;
-    using ghoul::io::TextureReader;
 
 
     if (isPlaceholder) {
@@ -790,17 +987,15 @@ std::shared_ptr<ghoul::opengl::Texture> ProjectionComponent::loadProjectionTextu
     }
 
 
-    unique_ptr<Texture> texture = TextureReader::ref().loadTexture(absPath(texturePath));
-    if (texture) {
-        if (texture->format() == Texture::Format::Red)
-            ghoul::opengl::convertTextureFormat(ghoul::opengl::Texture::Format::RGB, *texture);
-        texture->uploadTexture();
-        // TODO: AnisotropicMipMap crashes on ATI cards ---abock
-        //_textureProj->setFilter(ghoul::opengl::Texture::FilterMode::AnisotropicMipMap);
-        texture->setFilter(Texture::FilterMode::Linear);
-        texture->setWrapping(Texture::WrappingMode::ClampToBorder);
+    unique_ptr<DecodedImage> image;
+    {
+        std::lock_guard<std::mutex> lock(imageReaderMutex());
+        image = decodeProjectionImage(texturePath);
+    }
+    if (!image) {
+        return nullptr;
     }
-    return std::move(texture);
+    return uploadProjectionImage(*image);
 }
 
 bool ProjectionComponent::generateProjectionLayerTexture(const ivec2& size) {
@@ -25,6 +25,9 @@
 #ifndef __PROJECTIONCOMPONENT_H__
 #define __PROJECTIONCOMPONENT_H__
 
+#include <modules/newhorizons/util/captureindex.h>
+#include <modules/newhorizons/util/projectionimageloader.h>
+
 #include <openspace/properties/propertyowner.h>
 #include <openspace/properties/scalarproperty.h>
 #include <openspace/properties/triggerproperty.h>
@@ -34,6 +37,8 @@
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/opengl/texture.h>
 
+#include <deque>
+
 namespace ghoul {
 namespace opengl {
 
@@ -46,6 +51,20 @@ namespace openspace {
 
 class ProjectionComponent : public properties::PropertyOwner {
 public:
+    struct Projection {
+        double time;
+        std::shared_ptr<ghoul::opengl::Texture> texture;
+    };
+
+    /// The pixels of a projection image, which is decoded without OpenGL context
+    struct DecodedImage {
+        std::string path;
+        /// 8-bit RGB or RGBA pixels, or nullptr if the image has to be read on upload
+        std::unique_ptr<unsigned char[]> data;
+        glm::uvec2 size;
+        unsigned int nChannels;
+    };
+
     ProjectionComponent();
 
     bool initialize();
@@ -72,6 +91,21 @@ public:
         const std::string& texturePath,
         bool isPlaceholder = false
     );
+
+    /**
+     * Queues the projection of the \p captures, whose image paths are resolved through
+     * \p index. The images are decoded in the background and the projections become
+     * available through readyProjections in the order they were queued.
+     */
+    void queueProjections(const CaptureIndex::Range& captures, const CaptureIndex& index);
+
+    /**
+     * Removes and returns the queued projections whose images have been loaded, up to
+     * the first one that is still loading. At most as many images as set in the
+     * maxUploadsPerFrame property are uploaded per call, so a large number of captures
+     * is spread out over several frames.
+     */
+    std::vector<Projection> readyProjections();
     
     glm::mat4 computeProjectorMatrix(
         const glm::vec3 loc, glm::dvec3 aim, const glm::vec3 up,
@@ -104,11 +138,13 @@ public:
 private:
     bool generateProjectionLayerTexture(const glm::ivec2& size);
     bool generateDepthTexture(const glm::ivec2& size);
+    void prefetchUpcomingImages();
 
 protected:
     properties::BoolProperty _performProjection;
     properties::BoolProperty _clearAllProjections;
     properties::FloatProperty _projectionFading;
+    properties::IntProperty _maxUploadsPerFrame;
 
     properties::IVec2Property _textureSize;
     properties::TriggerProperty _applyTextureSize;
@@ -117,6 +153,15 @@ protected:
     std::unique_ptr<ghoul::opengl::Texture> _projectionTexture;
     std::shared_ptr<ghoul::opengl::Texture> _placeholderTexture;
 
+    struct QueuedProjection {
+        double time;
+        std::string path;
+        bool isPlaceholder;
+    };
+    std::deque<QueuedProjection> _queuedProjections;
+    using ImageLoader = ProjectionImageLoader<DecodedImage, ghoul::opengl::Texture>;
+    std::unique_ptr<ImageLoader> _imageLoader;
+
     float _projectionTextureAspectRatio;
 
     std::string _instrumentID;
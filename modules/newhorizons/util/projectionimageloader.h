@@ -0,0 +1,151 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __PROJECTIONIMAGELOADER_H__
+#define __PROJECTIONIMAGELOADER_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * The image readers keep global state, so images are decoded one at a time. Code that
+ * reads images while a ProjectionImageLoader might be decoding has to hold this mutex.
+ */
+std::mutex& imageReaderMutex();
+
+/**
+ * Decodes projection images on worker threads ahead of the time they are projected and
+ * keeps a bounded, least-recently-used cache of the results. The workers only produce
+ * images in memory; textures are created and uploaded when they are requested through
+ * #texture, which happens on the main thread and under a budget that limits the number
+ * of uploads per frame. The \p ImageType holds the decoded pixels and the \p TextureType
+ * is ghoul::opengl::Texture everywhere except in tests that run without OpenGL context.
+ */
+template <typename ImageType, typename TextureType>
+class ProjectionImageLoader {
+public:
+    using Image = ImageType;
+    using Texture = TextureType;
+    /// Reads and decodes an image without touching OpenGL; called on a worker thread
+    using Decoder = std::function<std::unique_ptr<Image>(const std::string& path)>;
+    /// Creates and uploads the texture for a decoded image; called on the main thread
+    using Uploader = std::function<std::unique_ptr<Texture>(Image& image)>;
+
+    enum class Status {
+        Ready,   ///< The texture has been uploaded and can be used
+        Pending, ///< The image is still being decoded or the upload budget is exhausted
+        Failed   ///< The image could not be decoded
+    };
+
+    /**
+     * Creates a loader that caches at most \p capacity images, which are decoded with
+     * \p decoder on \p nThreads threads and uploaded with \p uploader.
+     */
+    ProjectionImageLoader(Decoder decoder, Uploader uploader, size_t capacity,
+        unsigned int nThreads = 1);
+    ~ProjectionImageLoader();
+
+    /**
+     * Requests that the image at \p path is decoded in the background, unless it is
+     * already cached or requested. Requests are dropped when as many images as the
+     * cache can hold are waiting to be decoded.
+     */
+    void prefetch(const std::string& path);
+
+    /**
+     * Returns the texture for the image at \p path. An image that has been decoded but
+     * not uploaded yet is turned into a texture if \p uploadBudget is larger than 0,
+     * which is then decremented. Images that have not been requested yet are requested
+     * ahead of all prefetched images. Must be called on the main thread.
+     */
+    Status texture(const std::string& path, unsigned int& uploadBudget,
+        std::shared_ptr<Texture>& texture);
+
+    /**
+     * Blocks until the image at \p path is no longer waiting for or in the middle of
+     * decoding, or until \p timeout has passed. Returns \c false if the timeout expired.
+     * Images that have not been requested are not waited for.
+     */
+    bool waitFor(const std::string& path, std::chrono::milliseconds timeout);
+
+    /// Drops all requests that have not started decoding yet
+    void cancelRequests();
+
+    /// Returns the number of cached images, including the ones that are being decoded
+    size_t size() const;
+
+private:
+    enum class State {
+        Requested,
+        Decoding,
+        Decoded,
+        Uploaded,
+        Failed
+    };
+
+    struct Entry {
+        State state;
+        /// The decoded image, which is released once the texture is uploaded
+        std::unique_ptr<Image> image;
+        std::shared_ptr<Texture> texture;
+        uint64_t lastUse;
+    };
+
+    void worker();
+
+    /// Removes the least recently used images until the cache fits its capacity
+    void evict();
+
+    Decoder _decoder;
+    Uploader _uploader;
+    size_t _capacity;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    /// Notified whenever an image finished decoding or a request was dropped
+    std::condition_variable _decodedCondition;
+    std::unordered_map<std::string, Entry> _entries;
+    std::deque<std::string> _requests;
+    uint64_t _useCounter;
+    bool _isRunning;
+
+    std::vector<std::thread> _threads;
+};
+
+} // namespace openspace
+
+#include <modules/newhorizons/util/projectionimageloader.inl>
+
+#endif // __PROJECTIONIMAGELOADER_H__
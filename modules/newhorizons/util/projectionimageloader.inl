@@ -0,0 +1,227 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/logging/logmanager.h>
+
+#include <algorithm>
+
+namespace openspace {
+
+template <typename ImageType, typename TextureType>
+ProjectionImageLoader<ImageType, TextureType>::ProjectionImageLoader(
+                                                                    Decoder decoder,
+                                                                    Uploader uploader,
+                                                                    size_t capacity,
+                                                                    unsigned int nThreads)
+    : _decoder(std::move(decoder))
+    , _uploader(std::move(uploader))
+    , _capacity(std::max<size_t>(capacity, 1))
+    , _useCounter(0)
+    , _isRunning(true)
+{
+    for (unsigned int i = 0; i < std::max(nThreads, 1u); ++i) {
+        _threads.emplace_back([this]() { worker(); });
+    }
+}
+
+template <typename ImageType, typename TextureType>
+ProjectionImageLoader<ImageType, TextureType>::~ProjectionImageLoader() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isRunning = false;
+    }
+    _condition.notify_all();
+    for (std::thread& t : _threads) {
+        t.join();
+    }
+}
+
+template <typename ImageType, typename TextureType>
+void ProjectionImageLoader<ImageType, TextureType>::prefetch(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_entries.find(path) != _entries.end() || _requests.size() >= _capacity) {
+            return;
+        }
+        _entries[path] = { State::Requested, nullptr, nullptr, ++_useCounter };
+        _requests.push_back(path);
+        evict();
+    }
+    _condition.notify_one();
+}
+
+template <typename ImageType, typename TextureType>
+typename ProjectionImageLoader<ImageType, TextureType>::Status
+ProjectionImageLoader<ImageType, TextureType>::texture(const std::string& path,
+                                                       unsigned int& uploadBudget,
+                                                       std::shared_ptr<Texture>& texture)
+{
+    std::unique_ptr<Image> decoded;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(path);
+        if (it == _entries.end()) {
+            _entries[path] = { State::Requested, nullptr, nullptr, ++_useCounter };
+            _requests.push_front(path);
+            evict();
+            _condition.notify_one();
+            return Status::Pending;
+        }
+
+        Entry& entry = it->second;
+        entry.lastUse = ++_useCounter;
+        switch (entry.state) {
+            case State::Uploaded:
+                texture = entry.texture;
+                return Status::Ready;
+            case State::Failed:
+                return Status::Failed;
+            case State::Decoded:
+                if (uploadBudget == 0) {
+                    return Status::Pending;
+                }
+                decoded = std::move(entry.image);
+                break;
+            case State::Requested:
+                // An image that is needed now moves ahead of the prefetched ones
+                _requests.erase(std::find(_requests.begin(), _requests.end(), path));
+                _requests.push_front(path);
+                return Status::Pending;
+            default:
+                return Status::Pending;
+        }
+    }
+
+    // Entries are only removed on the main thread, so the upload can happen without
+    // blocking the workers
+    std::shared_ptr<Texture> uploaded = _uploader(*decoded);
+    --uploadBudget;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _entries[path];
+    if (!uploaded) {
+        entry.state = State::Failed;
+        return Status::Failed;
+    }
+    entry.state = State::Uploaded;
+    entry.texture = uploaded;
+    texture = std::move(uploaded);
+    return Status::Ready;
+}
+
+template <typename ImageType, typename TextureType>
+bool ProjectionImageLoader<ImageType, TextureType>::waitFor(
+                                                        const std::string& path,
+                                                        std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _decodedCondition.wait_for(lock, timeout, [this, &path]() {
+        auto it = _entries.find(path);
+        if (it == _entries.end()) {
+            return true;
+        }
+        State s = it->second.state;
+        return s != State::Requested && s != State::Decoding;
+    });
+}
+
+template <typename ImageType, typename TextureType>
+void ProjectionImageLoader<ImageType, TextureType>::cancelRequests() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const std::string& path : _requests) {
+            _entries.erase(path);
+        }
+        _requests.clear();
+    }
+    _decodedCondition.notify_all();
+}
+
+template <typename ImageType, typename TextureType>
+size_t ProjectionImageLoader<ImageType, TextureType>::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+template <typename ImageType, typename TextureType>
+void ProjectionImageLoader<ImageType, TextureType>::worker() {
+    while (true) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return !_isRunning || !_requests.empty(); });
+            if (!_isRunning) {
+                return;
+            }
+            path = std::move(_requests.front());
+            _requests.pop_front();
+            _entries[path].state = State::Decoding;
+        }
+
+        std::unique_ptr<Image> image;
+        try {
+            std::lock_guard<std::mutex> decodeLock(imageReaderMutex());
+            image = _decoder(path);
+        }
+        catch (const std::exception& e) {
+            LERRORC(
+                "ProjectionImageLoader",
+                "Failed to decode '" << path << "': " << e.what()
+            );
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Entry& entry = _entries[path];
+            entry.state = image ? State::Decoded : State::Failed;
+            entry.image = std::move(image);
+            entry.lastUse = ++_useCounter;
+        }
+        _decodedCondition.notify_all();
+    }
+}
+
+template <typename ImageType, typename TextureType>
+void ProjectionImageLoader<ImageType, TextureType>::evict() {
+    // Images that are waiting for or in the middle of decoding are never evicted, and
+    // uploaded textures are only released here, on the main thread
+    while (_entries.size() > _capacity) {
+        auto victim = _entries.end();
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            State s = it->second.state;
+            if (s == State::Requested || s == State::Decoding) {
+                continue;
+            }
+            if (victim == _entries.end() || it->second.lastUse < victim->second.lastUse) {
+                victim = it;
+            }
+        }
+        if (victim == _entries.end()) {
+            return;
+        }
+        _entries.erase(victim);
+    }
+}
+
+} // namespace openspace
@@ -30,12 +30,66 @@
 
 #include <ghoul/logging/logmanager.h>
 
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
 namespace {
     const std::string _loggerCat = "SequenceParser";
     const std::string keyTranslation = "DataInputTranslation";
 
     const std::string PlaybookIdentifierName = "Playbook";
-}
+
+    const uint32_t CacheMagic = 0x43505153; // "SQPC"
+    const uint32_t CacheVersion = 1;
+
+    template <typename T>
+    void writeCacheValue(std::vector<char>& buffer, T value) {
+        const char* data = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), data, data + sizeof(T));
+    }
+
+    void writeCacheValue(std::vector<char>& buffer, const std::string& value) {
+        writeCacheValue(buffer, static_cast<uint64_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    // Reads values from a cache file and remembers whether it ran past the end
+    struct CacheReader {
+        const std::vector<char>& buffer;
+        size_t position;
+        bool isValid;
+
+        template <typename T>
+        T read() {
+            T value = T();
+            if (isValid && position + sizeof(T) <= buffer.size()) {
+                std::memcpy(&value, buffer.data() + position, sizeof(T));
+                position += sizeof(T);
+            }
+            else {
+                isValid = false;
+            }
+            return value;
+        }
+
+        std::string readString() {
+            uint64_t size = read<uint64_t>();
+            if (!isValid || size > buffer.size() - position) {
+                isValid = false;
+                return "";
+            }
+            std::string value(buffer.data() + position, static_cast<size_t>(size));
+            position += static_cast<size_t>(size);
+            return value;
+        }
+    };
+} // namespace
 
 namespace openspace {
 
@@ -56,6 +110,236 @@ std::map<std::string, std::unique_ptr<Decoder>>& SequenceParser::getTranslation(
     return _fileTranslation;
 }
 
+bool SequenceParser::SourceFile::operator==(const SourceFile& rhs) const {
+    return path == rhs.path && size == rhs.size &&
+           modificationTime == rhs.modificationTime;
+}
+
+std::vector<SequenceParser::SourceFile> SequenceParser::sourceFiles(
+                                                    const std::vector<std::string>& paths)
+{
+    std::vector<SourceFile> files;
+    files.reserve(paths.size());
+    for (const std::string& path : paths) {
+        SourceFile file = { path, -1, 0 };
+#ifdef WIN32
+        struct _stat64 status;
+        if (_stat64(path.c_str(), &status) == 0) {
+#else
+        struct stat status;
+        if (stat(path.c_str(), &status) == 0) {
+#endif
+            file.size = static_cast<int64_t>(status.st_size);
+            file.modificationTime = static_cast<int64_t>(status.st_mtime);
+        }
+        files.push_back(std::move(file));
+    }
+    return files;
+}
+
+std::vector<double> SequenceParser::ephemerisTimesFromDates(
+                                                    const std::vector<std::string>& dates)
+{
+    // Many captures share their start or end times, so each date is converted only once
+    std::unordered_map<std::string, double> convertedDates;
+    convertedDates.reserve(dates.size());
+
+    std::vector<double> times;
+    times.reserve(dates.size());
+    for (const std::string& date : dates) {
+        auto it = convertedDates.find(date);
+        if (it == convertedDates.end()) {
+            double time = std::numeric_limits<double>::quiet_NaN();
+            if (!date.empty()) {
+                try {
+                    time = SpiceManager::ref().ephemerisTimeFromDate(date);
+                }
+                catch (const SpiceManager::SpiceException& e) {
+                    LERROR("Could not convert date '" << date << "': " << e.what());
+                }
+            }
+            it = convertedDates.emplace(date, time).first;
+        }
+        times.push_back(it->second);
+    }
+    return times;
+}
+
+std::string SequenceParser::translationSettings(
+                       const std::map<std::string, std::unique_ptr<Decoder>>& translation)
+{
+    std::string settings;
+    for (const std::pair<const std::string, std::unique_ptr<Decoder>>& t : translation) {
+        settings += t.first + "=" + t.second->getDecoderType() + ":";
+        for (const std::string& s : t.second->getTranslation()) {
+            settings += s + ",";
+        }
+        settings += ";";
+    }
+    return settings;
+}
+
+bool SequenceParser::loadCache(const std::string& cacheFile, const std::string& settings,
+                               const std::vector<SourceFile>& sources)
+{
+    std::ifstream file(cacheFile, std::ifstream::binary | std::ifstream::ate);
+    if (!file.good()) {
+        return false;
+    }
+    std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), buffer.size());
+
+    CacheReader reader = { buffer, 0, true };
+    if (reader.read<uint32_t>() != CacheMagic) {
+        return false;
+    }
+    if (reader.read<uint32_t>() != CacheVersion) {
+        return false;
+    }
+    if (reader.readString() != settings) {
+        LDEBUG("Cache '" << cacheFile << "' was created with different settings");
+        return false;
+    }
+
+    uint64_t nSources = reader.read<uint64_t>();
+    if (nSources != sources.size()) {
+        LDEBUG("Cache '" << cacheFile << "' was created from different files");
+        return false;
+    }
+    for (const SourceFile& source : sources) {
+        SourceFile cached;
+        cached.path = reader.readString();
+        cached.size = reader.read<int64_t>();
+        cached.modificationTime = reader.read<int64_t>();
+        if (!(cached == source)) {
+            LDEBUG("Cache '" << cacheFile << "' is outdated: '" << source.path <<
+                   "' has changed");
+            return false;
+        }
+    }
+
+    std::map<std::string, ImageSubset> subsetMap;
+    uint64_t nSubsets = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < nSubsets && reader.isValid; ++i) {
+        ImageSubset& subset = subsetMap[reader.readString()];
+        subset._range.start = reader.read<double>();
+        subset._range.end = reader.read<double>();
+
+        uint64_t nImages = reader.read<uint64_t>();
+        for (uint64_t j = 0; j < nImages && reader.isValid; ++j) {
+            Image image;
+            image.timeRange.start = reader.read<double>();
+            image.timeRange.end = reader.read<double>();
+            image.path = reader.readString();
+            image.target = reader.readString();
+            image.isPlaceholder = reader.read<uint8_t>() != 0;
+            uint64_t nInstruments = reader.read<uint64_t>();
+            for (uint64_t k = 0; k < nInstruments && reader.isValid; ++k) {
+                image.activeInstruments.push_back(reader.readString());
+            }
+            subset._subset.push_back(std::move(image));
+        }
+    }
+
+    std::vector<std::pair<std::string, TimeRange>> instrumentTimes;
+    uint64_t nInstrumentTimes = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < nInstrumentTimes && reader.isValid; ++i) {
+        std::string instrument = reader.readString();
+        TimeRange range;
+        range.start = reader.read<double>();
+        range.end = reader.read<double>();
+        instrumentTimes.emplace_back(std::move(instrument), range);
+    }
+
+    std::vector<std::pair<double, std::string>> targetTimes;
+    uint64_t nTargetTimes = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < nTargetTimes && reader.isValid; ++i) {
+        double time = reader.read<double>();
+        targetTimes.emplace_back(time, reader.readString());
+    }
+
+    std::vector<double> captureProgression;
+    uint64_t nCaptures = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < nCaptures && reader.isValid; ++i) {
+        captureProgression.push_back(reader.read<double>());
+    }
+
+    if (!reader.isValid || reader.position != buffer.size()) {
+        LWARNING("Cache '" << cacheFile << "' is corrupt");
+        return false;
+    }
+
+    _subsetMap = std::move(subsetMap);
+    _instrumentTimes = std::move(instrumentTimes);
+    _targetTimes = std::move(targetTimes);
+    _captureProgression = std::move(captureProgression);
+    return true;
+}
+
+bool SequenceParser::saveCache(const std::string& cacheFile, const std::string& settings,
+                               const std::vector<SourceFile>& sources) const
+{
+    std::vector<char> buffer;
+    writeCacheValue(buffer, CacheMagic);
+    writeCacheValue(buffer, CacheVersion);
+    writeCacheValue(buffer, settings);
+
+    writeCacheValue(buffer, static_cast<uint64_t>(sources.size()));
+    for (const SourceFile& source : sources) {
+        writeCacheValue(buffer, source.path);
+        writeCacheValue(buffer, source.size);
+        writeCacheValue(buffer, source.modificationTime);
+    }
+
+    writeCacheValue(buffer, static_cast<uint64_t>(_subsetMap.size()));
+    for (const std::pair<const std::string, ImageSubset>& subset : _subsetMap) {
+        writeCacheValue(buffer, subset.first);
+        writeCacheValue(buffer, subset.second._range.start);
+        writeCacheValue(buffer, subset.second._range.end);
+
+        writeCacheValue(buffer, static_cast<uint64_t>(subset.second._subset.size()));
+        for (const Image& image : subset.second._subset) {
+            writeCacheValue(buffer, image.timeRange.start);
+            writeCacheValue(buffer, image.timeRange.end);
+            writeCacheValue(buffer, image.path);
+            writeCacheValue(buffer, image.target);
+            writeCacheValue(buffer, static_cast<uint8_t>(image.isPlaceholder));
+            const std::vector<std::string>& instruments = image.activeInstruments;
+            writeCacheValue(buffer, static_cast<uint64_t>(instruments.size()));
+            for (const std::string& instrument : instruments) {
+                writeCacheValue(buffer, instrument);
+            }
+        }
+    }
+
+    writeCacheValue(buffer, static_cast<uint64_t>(_instrumentTimes.size()));
+    for (const std::pair<std::string, TimeRange>& t : _instrumentTimes) {
+        writeCacheValue(buffer, t.first);
+        writeCacheValue(buffer, t.second.start);
+        writeCacheValue(buffer, t.second.end);
+    }
+
+    writeCacheValue(buffer, static_cast<uint64_t>(_targetTimes.size()));
+    for (const std::pair<double, std::string>& t : _targetTimes) {
+        writeCacheValue(buffer, t.first);
+        writeCacheValue(buffer, t.second);
+    }
+
+    writeCacheValue(buffer, static_cast<uint64_t>(_captureProgression.size()));
+    for (double t : _captureProgression) {
+        writeCacheValue(buffer, t);
+    }
+
+    std::ofstream file(cacheFile, std::ofstream::binary | std::ofstream::trunc);
+    if (!file.good()) {
+        LWARNING("Could not write cache file '" << cacheFile << "'");
+        return false;
+    }
+    file.write(buffer.data(), buffer.size());
+    return file.good();
+}
+
 template <typename T>
 void writeToBuffer(std::vector<char>& buffer, size_t& currentWriteLocation, T value) {
     if ((currentWriteLocation + sizeof(T)) > buffer.size())
@@ -30,6 +30,7 @@
 
 #include <modules/newhorizons/util/decoder.h>
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -61,8 +62,45 @@ public:
     virtual std::vector<double> getCaptureProgression() final;
 
 protected:
+    /// Identifies the version of a file that a parser has read
+    struct SourceFile {
+        std::string path;
+        int64_t size;
+        int64_t modificationTime;
+
+        bool operator==(const SourceFile& rhs) const;
+    };
+
     void sendPlaybookInformation(const std::string& name);
 
+    /// Returns the SourceFile for each of the \p paths; missing files have a size of -1
+    static std::vector<SourceFile> sourceFiles(const std::vector<std::string>& paths);
+
+    /**
+     * Converts all \p dates into ephemeris times in a single pass, converting each
+     * distinct date only once. Dates that cannot be converted are logged and result in
+     * NaN.
+     */
+    static std::vector<double> ephemerisTimesFromDates(
+        const std::vector<std::string>& dates);
+
+    /// Describes the \p translation, so that caches can be invalidated when it changes
+    static std::string translationSettings(
+        const std::map<std::string, std::unique_ptr<Decoder>>& translation);
+
+    /**
+     * Restores the results of a previous call to create from the \p cacheFile. The
+     * cache is only used if it was created from the same \p sources and with the same
+     * \p settings, which should contain all parameters that influence the results.
+     * \returns <code>true</code> if the cache was valid and has been loaded
+     */
+    bool loadCache(const std::string& cacheFile, const std::string& settings,
+        const std::vector<SourceFile>& sources);
+
+    /// Stores the results of create in the \p cacheFile, see loadCache
+    bool saveCache(const std::string& cacheFile, const std::string& settings,
+        const std::vector<SourceFile>& sources) const;
+
     std::map<std::string, ImageSubset> _subsetMap;
     std::vector<std::pair<std::string, TimeRange>> _instrumentTimes;
     std::vector<std::pair<double, std::string>> _targetTimes;
@@ -844,12 +844,12 @@ void OpenSpaceEngine::preSynchronization() {
 
         Time::ref().advanceTime(dt);
 
-        auto scheduledScripts = _scriptScheduler->progressTo(Time::ref().j2000Seconds());
-        while(scheduledScripts.size()){
-            auto scheduledScript = scheduledScripts.front();
-            LINFO(scheduledScript);
-            _scriptEngine->queueScript(scheduledScript);
-            scheduledScripts.pop();
+        std::string scheduledScripts = _scriptScheduler->progressToBatched(
+            Time::ref().j2000Seconds()
+        );
+        if (!scheduledScripts.empty()) {
+            LDEBUG(scheduledScripts);
+            _scriptEngine->queueScript(scheduledScripts);
         }
 
         _interactionHandler->updateInputStates(dt);
@@ -633,6 +633,7 @@ InteractionHandler::InteractionHandler()
     , _verticalFriction("verticalFriction", "Vertical Friction", true)
     , _sensitivity("sensitivity", "Sensitivity", 0.002, 0.0001, 0.02)
     , _rapidness("rapidness", "Rapidness", 1, 0.1, 60)
+    , _keyframePlayoutDelay("keyframePlayoutDelay", "Keyframe Playout Delay", 0.2, 0.0, 2.0)
 {
     setName("Interaction");
 
@@ -665,6 +666,10 @@ InteractionHandler::InteractionHandler()
             std::make_shared<GlobeBrowsingInteractionMode>(_mouseStates)
             ));
 
+    _keyframeInteractionMode = std::make_unique<KeyframeInteractionMode>(
+        _inputState->keyframeBuffer()
+    );
+
     // Set the interactionMode
     _currentInteractionMode = _interactionModes["Orbital"];
 
@@ -684,6 +689,9 @@ InteractionHandler::InteractionHandler()
     _rapidness.onChange([&]() {
         _mouseStates->setVelocityScaleFactor(_rapidness);
     });
+    _keyframePlayoutDelay.onChange([&]() {
+        _inputState->keyframeBuffer().setPlayoutDelay(_keyframePlayoutDelay);
+    });
 
     // Add the properties
     addProperty(_origin);
@@ -694,6 +702,7 @@ InteractionHandler::InteractionHandler()
     addProperty(_verticalFriction);
     addProperty(_sensitivity);
     addProperty(_rapidness);
+    addProperty(_keyframePlayoutDelay);
 }
 
 InteractionHandler::~InteractionHandler() {
@@ -780,12 +789,20 @@ void InteractionHandler::updateCamera() {
     ghoul_assert(_inputState != nullptr, "InputState cannot be null!");
     ghoul_assert(_camera != nullptr, "Camera cannot be null!");
 
+    KeyframeBuffer& keyframes = _inputState->keyframeBuffer();
+    keyframes.update();
+
     if (_cameraUpdatedFromScript) {
         _cameraUpdatedFromScript = false;
     }
     else {
         if (_camera && focusNode()) {
-            _currentInteractionMode->updateCameraStateFromMouseStates(*_camera);
+            if (keyframes.hasKeyframes()) {
+                _keyframeInteractionMode->updateCameraStateFromMouseStates(*_camera);
+            }
+            else {
+                _currentInteractionMode->updateCameraStateFromMouseStates(*_camera);
+            }
             _camera->setFocusPositionVec3(focusNode()->worldPosition());
         }
     }
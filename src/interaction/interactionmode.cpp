@@ -58,21 +58,23 @@ namespace interaction {
     }
 
     void InputState::addKeyframe(const network::datamessagestructures::PositionKeyframe &kf) {
-        _keyframeMutex.lock();
-
-        //save a maximum of 10 samples (1 seconds of buffer)
-        if (_keyframes.size() >= 10) {
-            _keyframes.erase(_keyframes.begin());
+        // The host sends the inverse of the camera rotation as the view rotation
+        KeyframeBuffer::Keyframe keyframe;
+        keyframe.position = kf._position.dvec3();
+        keyframe.rotation = glm::inverse(glm::dquat(kf._viewRotationQuat));
+        keyframe.timestamp = kf._timeStamp;
+
+        if (!_keyframeBuffer.push(keyframe, OsEng.runTime())) {
+            LWARNING("Keyframe buffer is full, dropping keyframe");
         }
-        _keyframes.push_back(kf);
-
-        _keyframeMutex.unlock();
     }
 
     void InputState::clearKeyframes() {
-        _keyframeMutex.lock();
-        _keyframes.clear();
-        _keyframeMutex.unlock();
+        _keyframeBuffer.clear();
+    }
+
+    KeyframeBuffer& InputState::keyframeBuffer() {
+        return _keyframeBuffer;
     }
 
     void InputState::keyboardCallback(Key key, KeyModifier modifier, KeyAction action) {
@@ -166,7 +168,9 @@ SceneGraphNode* InteractionMode::focusNode() {
 }
 
 // KeyframeInteractionMode
-KeyframeInteractionMode::KeyframeInteractionMode(){
+KeyframeInteractionMode::KeyframeInteractionMode(KeyframeBuffer& keyframeBuffer)
+    : _keyframeBuffer(keyframeBuffer)
+{
 
 }
 
@@ -175,11 +179,15 @@ KeyframeInteractionMode::~KeyframeInteractionMode() {
 }
 
 void KeyframeInteractionMode::updateMouseStatesFromInput(const InputState& inputState, double deltaTime) {
-
+    // Local input is ignored while following the host
 }
 
 void KeyframeInteractionMode::updateCameraStateFromMouseStates(Camera& camera) {
-
+    KeyframeBuffer::Keyframe keyframe;
+    if (_keyframeBuffer.sample(OsEng.runTime(), keyframe)) {
+        camera.setPositionVec3(keyframe.position);
+        camera.setRotation(keyframe.rotation);
+    }
 }
 
 // OrbitalInteractionMode
@@ -0,0 +1,231 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/interaction/keyframebuffer.h>
+
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // Upper bound for the number of sorted keyframes in case the playout stalls
+    const size_t MaximumKeyframes = 256;
+
+    const double DefaultPlayoutDelay = 0.2;
+
+    // Cubic Hermite spline through p1 and p2 with the tangents m1 and m2
+    glm::dvec3 hermite(const glm::dvec3& p1, const glm::dvec3& p2, const glm::dvec3& m1,
+                       const glm::dvec3& m2, double s)
+    {
+        const double s2 = s * s;
+        const double s3 = s2 * s;
+        return (2.0 * s3 - 3.0 * s2 + 1.0) * p1 + (s3 - 2.0 * s2 + s) * m1 +
+               (-2.0 * s3 + 3.0 * s2) * p2 + (s3 - s2) * m2;
+    }
+
+    // Returns q or -q, whichever is closer to the reference rotation
+    glm::dquat alignTo(const glm::dquat& reference, const glm::dquat& q) {
+        return glm::dot(reference, q) < 0.0 ? -q : q;
+    }
+} // namespace
+
+namespace openspace {
+namespace interaction {
+
+const size_t KeyframeBuffer::RingCapacity;
+const size_t KeyframeBuffer::OffsetWindow;
+
+KeyframeBuffer::KeyframeBuffer()
+    : _head(0)
+    , _tail(0)
+    , _clearRequested(false)
+    , _nDropped(0)
+    , _nOffsetSamples(0)
+    , _clockOffset(0.0)
+    , _playoutDelay(DefaultPlayoutDelay)
+    , _lastPlayedTime(-std::numeric_limits<double>::max())
+{}
+
+bool KeyframeBuffer::push(const Keyframe& keyframe, double receiveTime) {
+    const size_t head = _head.load(std::memory_order_relaxed);
+    const size_t tail = _tail.load(std::memory_order_acquire);
+    if (head - tail >= RingCapacity) {
+        ++_nDropped;
+        return false;
+    }
+
+    _ring[head % RingCapacity] = { keyframe, receiveTime };
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void KeyframeBuffer::clear() {
+    _clearRequested = true;
+}
+
+void KeyframeBuffer::update() {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    const size_t head = _head.load(std::memory_order_acquire);
+
+    if (_clearRequested.exchange(false)) {
+        _tail.store(head, std::memory_order_release);
+        _keyframes.clear();
+        _nOffsetSamples = 0;
+        _clockOffset = 0.0;
+        _lastPlayedTime = -std::numeric_limits<double>::max();
+        return;
+    }
+
+    while (tail != head) {
+        const Entry& entry = _ring[tail % RingCapacity];
+        addOffsetSample(entry.receiveTime - entry.keyframe.timestamp);
+        insertSorted(entry.keyframe);
+        ++tail;
+    }
+    _tail.store(tail, std::memory_order_release);
+}
+
+void KeyframeBuffer::insertSorted(const Keyframe& keyframe) {
+    // Keyframes that are older than what is already played would only cause a jump
+    if (keyframe.timestamp < _lastPlayedTime && !_keyframes.empty() &&
+        keyframe.timestamp < _keyframes.front().timestamp)
+    {
+        return;
+    }
+
+    auto it = std::lower_bound(
+        _keyframes.begin(),
+        _keyframes.end(),
+        keyframe.timestamp,
+        [](const Keyframe& k, double t) { return k.timestamp < t; }
+    );
+    if (it != _keyframes.end() && it->timestamp == keyframe.timestamp) {
+        *it = keyframe;
+    }
+    else {
+        _keyframes.insert(it, keyframe);
+    }
+
+    if (_keyframes.size() > MaximumKeyframes) {
+        _keyframes.erase(_keyframes.begin());
+    }
+}
+
+void KeyframeBuffer::addOffsetSample(double offset) {
+    _offsetSamples[_nOffsetSamples % OffsetWindow] = offset;
+    ++_nOffsetSamples;
+
+    // The sample with the smallest delay is the best estimate of the clock offset
+    const size_t n = std::min(_nOffsetSamples, OffsetWindow);
+    _clockOffset = *std::min_element(_offsetSamples.begin(), _offsetSamples.begin() + n);
+}
+
+bool KeyframeBuffer::hasKeyframes() const {
+    return !_keyframes.empty();
+}
+
+bool KeyframeBuffer::sample(double localTime, Keyframe& result) {
+    update();
+    if (_keyframes.empty()) {
+        return false;
+    }
+
+    // The host time that should be shown now; never play backwards, which could
+    // otherwise happen when the clock offset estimate increases
+    const double t = std::max(localTime - _clockOffset - _playoutDelay, _lastPlayedTime);
+    _lastPlayedTime = t;
+
+    if (t <= _keyframes.front().timestamp) {
+        result = _keyframes.front();
+        return true;
+    }
+    if (t >= _keyframes.back().timestamp) {
+        // We ran out of keyframes, so we hold the last one rather than extrapolating
+        result = _keyframes.back();
+        return true;
+    }
+
+    // Find the segment [k1, k2) that contains t
+    auto next = std::upper_bound(
+        _keyframes.begin(),
+        _keyframes.end(),
+        t,
+        [](double time, const Keyframe& k) { return time < k.timestamp; }
+    );
+    const size_t i2 = std::distance(_keyframes.begin(), next);
+    const size_t i1 = i2 - 1;
+    const size_t i0 = (i1 > 0) ? i1 - 1 : i1;
+    const size_t i3 = (i2 + 1 < _keyframes.size()) ? i2 + 1 : i2;
+
+    const Keyframe& k0 = _keyframes[i0];
+    const Keyframe& k1 = _keyframes[i1];
+    const Keyframe& k2 = _keyframes[i2];
+    const Keyframe& k3 = _keyframes[i3];
+
+    const double dt = k2.timestamp - k1.timestamp;
+    const double s = (t - k1.timestamp) / dt;
+
+    // Non-uniform Catmull-Rom tangents, scaled to the parameter range of the segment
+    const glm::dvec3 m1 = (k2.position - k0.position) *
+        (dt / (k2.timestamp - k0.timestamp));
+    const glm::dvec3 m2 = (k3.position - k1.position) *
+        (dt / (k3.timestamp - k1.timestamp));
+    result.position = hermite(k1.position, k2.position, m1, m2, s);
+
+    // Squad through consistently signed quaternions
+    const glm::dquat q1 = k1.rotation;
+    const glm::dquat q0 = alignTo(q1, k0.rotation);
+    const glm::dquat q2 = alignTo(q1, k2.rotation);
+    const glm::dquat q3 = alignTo(q2, k3.rotation);
+    const glm::dquat a1 = glm::intermediate(q0, q1, q2);
+    const glm::dquat a2 = glm::intermediate(q1, q2, q3);
+    result.rotation = glm::normalize(glm::squad(q1, q2, a1, a2, s));
+    result.timestamp = t;
+
+    // Everything before k0 will never be needed again
+    if (i0 > 0) {
+        _keyframes.erase(_keyframes.begin(), _keyframes.begin() + i0);
+    }
+    return true;
+}
+
+void KeyframeBuffer::setPlayoutDelay(double delay) {
+    _playoutDelay = std::max(delay, 0.0);
+}
+
+double KeyframeBuffer::playoutDelay() const {
+    return _playoutDelay;
+}
+
+double KeyframeBuffer::clockOffset() const {
+    return _clockOffset;
+}
+
+unsigned long long KeyframeBuffer::nDroppedKeyframes() const {
+    return _nDropped;
+}
+
+} // namespace interaction
+} // namespace openspace
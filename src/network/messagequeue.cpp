@@ -0,0 +1,220 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/network/messagequeue.h>
+
+#ifndef WIN32
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifndef SOCKET_ERROR
+#define SOCKET_ERROR (-1)
+#endif
+
+#include <algorithm>
+
+namespace {
+    // Lower bound of IOV_MAX on all platforms that we support
+    const size_t MaxIoVectors = 1024;
+
+    // Bounds of the buffer pool, so that a burst of messages or a single very large
+    // message does not keep its memory alive for the rest of the connection
+    const size_t MaxPooledBuffers = 64;
+    const size_t MaxPooledBufferCapacity = 1024 * 1024;
+}
+
+namespace openspace {
+
+namespace network {
+
+MessageQueue::MessageQueue()
+    : _wakeUp(false)
+    , _nSentMessages(0)
+    , _nWrites(0)
+{}
+
+MessageQueue::Buffer MessageQueue::acquireBuffer() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_pool.empty()) {
+        return Buffer();
+    }
+    Buffer buffer = std::move(_pool.back());
+    _pool.pop_back();
+    buffer.clear();
+    return buffer;
+}
+
+void MessageQueue::push(Buffer message) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::move(message));
+    }
+    _condition.notify_all();
+}
+
+void MessageQueue::wakeUp() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _wakeUp = true;
+    }
+    _condition.notify_all();
+}
+
+void MessageQueue::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    recycle(_queue);
+}
+
+int MessageQueue::flush(_SOCKET socket, std::chrono::milliseconds timeout) {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait_for(lock, timeout, [this]() {
+            return !_queue.empty() || _wakeUp;
+        });
+        _wakeUp = false;
+
+        // Take all queued messages at once; swapping keeps the capacity of both lists
+        _sending.swap(_queue);
+    }
+
+    if (_sending.empty()) {
+        return 0;
+    }
+
+    int result = writeAll(socket, _sending);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        recycle(_sending);
+    }
+    return result;
+}
+
+int MessageQueue::writeAll(_SOCKET socket, std::vector<Buffer>& messages) {
+    _ioVectors.clear();
+    for (Buffer& message : messages) {
+        if (message.empty()) {
+            continue;
+        }
+#ifdef WIN32
+        WSABUF b;
+        b.buf = message.data();
+        b.len = static_cast<ULONG>(message.size());
+#else
+        iovec b;
+        b.iov_base = message.data();
+        b.iov_len = message.size();
+#endif
+        _ioVectors.push_back(b);
+    }
+
+    int total = 0;
+    size_t first = 0;
+    while (first < _ioVectors.size()) {
+        const size_t count = std::min(_ioVectors.size() - first, MaxIoVectors);
+
+#ifdef WIN32
+        DWORD sent = 0;
+        int result = WSASend(
+            socket,
+            &_ioVectors[first],
+            static_cast<DWORD>(count),
+            &sent,
+            0,
+            nullptr,
+            nullptr
+        );
+        if (result == SOCKET_ERROR) {
+            return SOCKET_ERROR;
+        }
+        size_t written = static_cast<size_t>(sent);
+#else
+        ssize_t result = writev(socket, &_ioVectors[first], static_cast<int>(count));
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return SOCKET_ERROR;
+        }
+        size_t written = static_cast<size_t>(result);
+#endif
+        ++_nWrites;
+        total += static_cast<int>(written);
+
+        // Skip the vectors that were written completely and advance into a partially
+        // written one, so that the next call picks up exactly where this one stopped
+        while (written > 0 && first < _ioVectors.size()) {
+#ifdef WIN32
+            size_t length = _ioVectors[first].len;
+#else
+            size_t length = _ioVectors[first].iov_len;
+#endif
+            if (written >= length) {
+                written -= length;
+                ++first;
+            }
+            else {
+#ifdef WIN32
+                _ioVectors[first].buf += written;
+                _ioVectors[first].len -= static_cast<ULONG>(written);
+#else
+                _ioVectors[first].iov_base =
+                    static_cast<char*>(_ioVectors[first].iov_base) + written;
+                _ioVectors[first].iov_len -= written;
+#endif
+                written = 0;
+            }
+        }
+    }
+
+    _nSentMessages += messages.size();
+    return total;
+}
+
+void MessageQueue::recycle(std::vector<Buffer>& messages) {
+    for (Buffer& message : messages) {
+        if (_pool.size() >= MaxPooledBuffers) {
+            break;
+        }
+        if (message.capacity() <= MaxPooledBufferCapacity) {
+            _pool.push_back(std::move(message));
+        }
+    }
+    messages.clear();
+}
+
+unsigned long long MessageQueue::nSentMessages() const {
+    return _nSentMessages;
+}
+
+unsigned long long MessageQueue::nWrites() const {
+    return _nWrites;
+}
+
+} // namespace network
+
+} // namespace openspace
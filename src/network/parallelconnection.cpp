@@ -58,13 +58,24 @@
 #include <openspace/interaction/interactionhandler.h>
 #include <openspace/util/time.h>
 #include <openspace/openspace.h>
+#include <openspace/scene/scenegraphnode.h>
 #include <ghoul/logging/logmanager.h>
 
+#include <algorithm>
+#include <cmath>
+
 //lua functions
 #include "parallelconnection_lua.inl"
 
 namespace {
     const std::string _loggerCat = "ParallelConnection";
+
+    // Default keyframe rate: between 30 and 2 keyframes per second depending on motion
+    const double DefaultMinimumKeyframeInterval = 1.0 / 30.0;
+    const double DefaultMaximumKeyframeInterval = 0.5;
+    const double DefaultKeyframeTolerance = 1e-3;
+    // The broadcast thread sleeps for the minimum interval, so it must not be zero
+    const double SmallestKeyframeInterval = 1e-3;
 }
 
 namespace openspace {
@@ -89,6 +100,9 @@ ParallelConnection::ParallelConnection()
     , _performDisconnect(false)
     , _latestTimeKeyframeValid(false)
     , _initializationTimejumpRequired(false)
+    , _minimumKeyframeInterval(DefaultMinimumKeyframeInterval)
+    , _maximumKeyframeInterval(DefaultMaximumKeyframeInterval)
+    , _keyframeTolerance(DefaultKeyframeTolerance)
 {
     //create handler thread
     _handlerThread = new (std::nothrow) std::thread(&ParallelConnection::threadManagement, this);
@@ -177,7 +191,7 @@ void ParallelConnection::disconnect(){
         _isHost.store(false);
                 
         //signal send thread to stop waiting and finish current run
-        _sendCondition.notify_all();
+        _messageQueue.wakeUp();
                 
         //join connection thread and delete it
         if(_connectionThread != nullptr){
@@ -207,6 +221,9 @@ void ParallelConnection::disconnect(){
             _broadcastThread = nullptr;
         }
                 
+        //stop following the host
+        OsEng.interactionHandler().clearKeyframes();
+
         // disconnect and cleanup completed
         _performDisconnect.store(false);
     }
@@ -361,7 +378,7 @@ void ParallelConnection::sendAuthentication(){
     int size = headerSize() + sizeof(uint32_t) + sizeof(namelen) + static_cast<int>(namelen);
 
     //create and reserve buffer
-    std::vector<char> buffer;
+    std::vector<char> buffer = _messageQueue.acquireBuffer();
     buffer.reserve(size);
 
     //write header to buffer
@@ -488,8 +505,8 @@ void ParallelConnection::dataMessageReceived(){
     uint16_t msglen;
     uint16_t type;
 
-    //create a buffer to hold the size of streamdata message
-    std::vector<char> buffer;
+    //reuse the receive buffer; it is only ever touched by the listen thread
+    std::vector<char>& buffer = _receiveBuffer;
     buffer.resize(sizeof(type));
             
     //read type of data message
@@ -596,39 +613,51 @@ void ParallelConnection::dataMessageReceived(){
 }
 
 void ParallelConnection::queueMessage(std::vector<char> message){
-    {
-        std::unique_lock<std::mutex> unqlock(_sendBufferMutex);
-        _sendBuffer.push_back(message);
-        _sendCondition.notify_all();
-    }
+    _messageQueue.push(std::move(message));
+}
+
+template <typename T>
+void ParallelConnection::queueDataMessage(datamessagestructures::type type, T& message){
+    //frame the message directly into a pooled buffer to avoid intermediate copies
+    std::vector<char> buffer = _messageQueue.acquireBuffer();
+
+    //write header
+    writeHeader(buffer, MessageTypes::Data);
+
+    //type of message
+    uint16_t messageType = static_cast<uint16_t>(type);
+    buffer.insert(buffer.end(), reinterpret_cast<char*>(&messageType), reinterpret_cast<char*>(&messageType) + sizeof(messageType));
+
+    //reserve space for the size of the message, it is known after serialization
+    const size_t sizeOffset = buffer.size();
+    uint16_t msglen = 0;
+    buffer.insert(buffer.end(), reinterpret_cast<char*>(&msglen), reinterpret_cast<char*>(&msglen) + sizeof(msglen));
+
+    //actual message
+    message.serialize(buffer);
+
+    //patch in the size of the message
+    msglen = static_cast<uint16_t>(buffer.size() - sizeOffset - sizeof(msglen));
+    memcpy(buffer.data() + sizeOffset, &msglen, sizeof(msglen));
+
+    //send message
+    queueMessage(std::move(buffer));
 }
         
 void ParallelConnection::sendFunc(){
-    int result;
     //while we're connected
     while(_isConnected.load()){
-        {
-            //wait for signal then lock mutex and send first queued message
-            std::unique_lock<std::mutex> unqlock(_sendBufferMutex);
-            _sendCondition.wait_for(unqlock, std::chrono::milliseconds(500));
-                    
-            if(!_sendBuffer.empty()){
-                while(!_sendBuffer.empty()){
-                    result = send(_clientSocket, _sendBuffer.front().data(), _sendBuffer.front().size(), 0);
-                    _sendBuffer.erase(_sendBuffer.begin());
-                            
-                    //make sure everything went well
-                    if (result == SOCKET_ERROR){
-                        //failed to send message
-                        LERROR("Failed to send message.\nError: " << _ERRNO << " detected in connection, disconnecting.");
-                                
-                        //signal that a disconnect should be performed
-                        signalDisconnect();
-                    }
-                }
-            }
+        //wait for messages and send everything that is queued in one gathered write
+        int result = _messageQueue.flush(_clientSocket, std::chrono::milliseconds(500));
+
+        //make sure everything went well
+        if (result == SOCKET_ERROR){
+            //failed to send message
+            LERROR("Failed to send message.\nError: " << _ERRNO << " detected in connection, disconnecting.");
+
+            //signal that a disconnect should be performed
+            signalDisconnect();
         }
-                
     }
 }
         
@@ -656,6 +685,9 @@ void ParallelConnection::hostInfoMessageReceived(){
                 //we're the host
                 _isHost.store(true);
 
+                //stop following the previous host
+                OsEng.interactionHandler().clearKeyframes();
+
                 //start broadcasting
                 _broadcastThread = new (std::nothrow) std::thread(&ParallelConnection::broadcast, this);
             }
@@ -684,7 +716,7 @@ void ParallelConnection::hostInfoMessageReceived(){
                     
             //request init package from the host
             int size = headerSize();
-            std::vector<char> buffer;
+            std::vector<char> buffer = _messageQueue.acquireBuffer();
             buffer.reserve(size);
                     
             //write header
@@ -858,7 +890,7 @@ bool ParallelConnection::isHost(){
 }
         
 void ParallelConnection::requestHostship(const std::string &password){
-    std::vector<char> buffer;
+    std::vector<char> buffer = _messageQueue.acquireBuffer();
     buffer.reserve(headerSize());
           
     uint32_t passcode = hash(password);
@@ -914,34 +946,8 @@ void ParallelConnection::preSynchronization(){
         tf._requiresTimeJump = Time::ref().timeJumped();
         tf._time = Time::ref().j2000Seconds();
                 
-        //create a buffer and serialize message
-        std::vector<char> tbuffer;
-        tf.serialize(tbuffer);
-                
-        //get the size of the keyframebuffer
-        uint16_t msglen = static_cast<uint16_t>(tbuffer.size());
-                
-        //the type of data message
-        uint16_t type = static_cast<uint16_t>(network::datamessagestructures::TimeData);
-                
-        //create the full buffer
-        std::vector<char> buffer;
-        buffer.reserve(headerSize() + sizeof(type) + sizeof(msglen) + msglen);
-                
-        //write header
-        writeHeader(buffer, MessageTypes::Data);
-                
-        //type of message
-        buffer.insert(buffer.end(), reinterpret_cast<char*>(&type), reinterpret_cast<char*>(&type) + sizeof(type));
-                
-        //size of message
-        buffer.insert(buffer.end(), reinterpret_cast<char*>(&msglen), reinterpret_cast<char*>(&msglen) + sizeof(msglen));
-                
-        //actual message
-        buffer.insert(buffer.end(), tbuffer.begin(), tbuffer.end());
-                
-        //send message
-        queueMessage(buffer);
+        //serialize and send message
+        queueDataMessage(network::datamessagestructures::TimeData, tf);
     }
     else{
         //if we're not the host and we have a valid keyframe (one that hasnt been used before)
@@ -988,36 +994,8 @@ void ParallelConnection::scriptMessage(const std::string propIdentifier, const s
         sm._script = script;
         sm._scriptlen = static_cast<uint16_t>(script.length());
                 
-        //create a buffer for the script
-        std::vector<char> sbuffer;
-                
-        //fill the script buffer
-        sm.serialize(sbuffer);
-                
-        //get the size of the keyframebuffer
-        uint16_t msglen = static_cast<uint16_t>(sbuffer.size());
-                
-        //the type of message
-        uint16_t type = static_cast<uint16_t>(network::datamessagestructures::ScriptData);
-                
-        //create the full buffer
-        std::vector<char> buffer;
-        buffer.reserve(headerSize() + sizeof(type) + sizeof(msglen) + msglen);
-                
-        //write header
-        writeHeader(buffer, MessageTypes::Data);
-                
-        //type of message
-        buffer.insert(buffer.end(), reinterpret_cast<char*>(&type), reinterpret_cast<char*>(&type) + sizeof(type));
-                
-        //size of message
-        buffer.insert(buffer.end(), reinterpret_cast<char*>(&msglen), reinterpret_cast<char*>(&msglen) + sizeof(msglen));
-                
-        //actual message
-        buffer.insert(buffer.end(), sbuffer.begin(), sbuffer.end());
-                
-        //send message
-        queueMessage(buffer);
+        //serialize and send message
+        queueDataMessage(network::datamessagestructures::ScriptData, sm);
     }
 
 }
@@ -1028,52 +1006,74 @@ std::string ParallelConnection::scriptFromPropertyAndValue(const std::string pro
     return script;
 }
         
+void ParallelConnection::setKeyframeInterval(double minimum, double maximum){
+    minimum = std::max(minimum, SmallestKeyframeInterval);
+    _minimumKeyframeInterval.store(minimum);
+    _maximumKeyframeInterval.store(std::max(maximum, minimum));
+}
+
+void ParallelConnection::setKeyframeTolerance(double tolerance){
+    _keyframeTolerance.store(std::max(tolerance, 0.0));
+}
+        
 void ParallelConnection::broadcast(){
-            
+    using Clock = std::chrono::steady_clock;
+
+    //state of the last keyframe that was sent, used to estimate the camera motion
+    glm::dvec3 lastPosition;
+    glm::dquat lastRotation;
+    Clock::time_point lastSent;
+    bool hasSent = false;
+
     //while we're still connected and we're the host
     while (_isConnected.load() && _isHost.load()){
+        const Camera* camera = OsEng.interactionHandler().camera();
+        const glm::dvec3 position = camera->positionVec3();
+        const glm::dquat rotation = camera->rotationQuaternion();
 
-        //create a keyframe with current position and orientation of camera
-        network::datamessagestructures::PositionKeyframe kf;
-        kf._position = OsEng.interactionHandler().camera()->position();
-        kf._viewRotationQuat = glm::quat_cast(glm::mat4(OsEng.interactionHandler().camera()->viewRotationMatrix()));
-                
-        //timestamp as current runtime of OpenSpace instance
-        kf._timeStamp = OsEng.runTime();
-                
-        //create a buffer for the keyframe
-        std::vector<char> kfBuffer;
-                
-        //fill the keyframe buffer
-        kf.serialize(kfBuffer);
-                
-        //get the size of the keyframebuffer
-        uint16_t msglen = static_cast<uint16_t>(kfBuffer.size());
-                
-        //the type of message
-        uint16_t type = static_cast<uint16_t>(network::datamessagestructures::PositionData);
-                
-        //create the full buffer
-        std::vector<char> buffer;
-        buffer.reserve(headerSize() + sizeof(type) + sizeof(msglen) + msglen);
-                
-        //write header
-        writeHeader(buffer, MessageTypes::Data);
-                
-        //type of message
-        buffer.insert(buffer.end(), reinterpret_cast<char*>(&type), reinterpret_cast<char*>(&type) + sizeof(type));
+        const Clock::time_point now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - lastSent).count();
+
+        bool send = !hasSent || elapsed >= _maximumKeyframeInterval.load();
+        if (!send){
+            //translation relative to the distance to the focus node, so that the same
+            //tolerance works close to a planet's surface and in interplanetary space
+            double distance = 1.0;
+            const SceneGraphNode* focus = OsEng.interactionHandler().focusNode();
+            if (focus){
+                distance = std::max(glm::length(position - focus->worldPosition()), 1.0);
+            }
+            const double translation = glm::length(position - lastPosition) / distance;
+
+            //angle between the last and the current orientation
+            const double dot = std::min(std::abs(glm::dot(rotation, lastRotation)), 1.0);
+            const double angle = 2.0 * std::acos(dot);
+
+            send = (translation + angle) > _keyframeTolerance.load();
+        }
 
-        //size of message
-        buffer.insert(buffer.end(), reinterpret_cast<char*>(&msglen), reinterpret_cast<char*>(&msglen) + sizeof(msglen));
+        if (send){
+            //create a keyframe with current position and orientation of camera
+            network::datamessagestructures::PositionKeyframe kf;
+            kf._position = camera->position();
+            kf._viewRotationQuat = glm::quat_cast(glm::mat4(camera->viewRotationMatrix()));
 
-        //actual message
-        buffer.insert(buffer.end(), kfBuffer.begin(), kfBuffer.end());
+            //timestamp as current runtime of OpenSpace instance
+            kf._timeStamp = OsEng.runTime();
 
-        //send message
-        queueMessage(buffer);
+            //serialize and send message
+            queueDataMessage(network::datamessagestructures::PositionData, kf);
 
-        //100 ms sleep - send keyframes 10 times per second
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            lastPosition = position;
+            lastRotation = rotation;
+            lastSent = now;
+            hasSent = true;
+        }
+
+        //the shortest interval is the rate at which we sample the camera motion
+        std::this_thread::sleep_for(
+            std::chrono::duration<double>(_minimumKeyframeInterval.load())
+        );
     }
 }
         
@@ -1146,6 +1146,21 @@ scripting::LuaLibrary ParallelConnection::luaLibrary() {
                 "string",
                 "Request to be the host for this session"
             },
+            {
+                "setKeyframeInterval",
+                &luascriptfunctions::setKeyframeInterval,
+                "number, number",
+                "Sets the minimum and maximum time in seconds between two camera "
+                "keyframes that are sent while being the host. Keyframes are sent more "
+                "often the faster the camera moves"
+            },
+            {
+                "setKeyframeTolerance",
+                &luascriptfunctions::setKeyframeTolerance,
+                "number",
+                "Sets the camera motion (rotation in radians plus translation relative "
+                "to the focus distance) that triggers a new keyframe"
+            },
         }
     };
 }
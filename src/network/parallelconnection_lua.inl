@@ -184,6 +184,38 @@ int requestHostship(lua_State* L) {
     return 0;
 }
 
+int setKeyframeInterval(lua_State* L) {
+    
+    int nArguments = lua_gettop(L);
+    if (nArguments != 2)
+        return luaL_error(L, "Expected %i arguments, got %i", 2, nArguments);
+
+    double minimum = luaL_checknumber(L, -2);
+    double maximum = luaL_checknumber(L, -1);
+    if (minimum <= 0.0 || maximum < minimum) {
+        return luaL_error(L, "Expected 0 < minimum <= maximum, got %f and %f",
+            minimum, maximum);
+    }
+
+    if(OsEng.isMaster()){
+        OsEng.parallelConnection().setKeyframeInterval(minimum, maximum);
+    }
+    return 0;
+}
+
+int setKeyframeTolerance(lua_State* L) {
+    
+    int nArguments = lua_gettop(L);
+    if (nArguments != 1)
+        return luaL_error(L, "Expected %i arguments, got %i", 1, nArguments);
+
+    double tolerance = luaL_checknumber(L, -1);
+    if(OsEng.isMaster()){
+        OsEng.parallelConnection().setKeyframeTolerance(tolerance);
+    }
+    return 0;
+}
+
 } // namespace luascriptfunctions
 
 } // namespace openspace
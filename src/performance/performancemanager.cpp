@@ -31,6 +31,10 @@
 #include <ghoul/misc/sharedmemory.h>
 #include <ghoul/misc/onscopeexit.h>
 
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
 namespace {
     const std::string _loggerCat = "PerformanceManager";
     
@@ -50,6 +54,28 @@ namespace {
     };
     
     const std::string LocalSharedMemoryNameBase = "PerformanceMeasurement_";
+    const std::string TelemetrySharedMemoryNameBase = "PerformanceTelemetry_";
+
+    // The process-wide table of interned scope names
+    struct ScopeRegistry {
+        std::mutex mutex;
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<std::string> names;
+    };
+
+    ScopeRegistry& scopeRegistry() {
+        static ScopeRegistry registry;
+        return registry;
+    }
+
+    std::atomic<uint64_t> nextManagerId(1);
+
+    // The ring that the current thread has claimed in the manager with the id 'manager'
+    struct ThreadRingCache {
+        uint64_t manager = 0;
+        openspace::performance::TelemetryLayout::ThreadRing* ring = nullptr;
+    };
+    thread_local ThreadRingCache threadRingCache;
 }
 
 namespace openspace {
@@ -120,6 +146,11 @@ void PerformanceManager::destroyGlobalSharedMemory() {
                 LINFO("Removing shared memory: " << localName);
                 SharedMemory::remove(localName);
             }
+            std::string telemetryName = TelemetrySharedMemoryNameBase + std::to_string(i);
+            if (SharedMemory::exists(telemetryName)) {
+                LINFO("Removing shared memory: " << telemetryName);
+                SharedMemory::remove(telemetryName);
+            }
         }
         
         SharedMemory::remove(GlobalSharedMemoryName);
@@ -127,8 +158,31 @@ void PerformanceManager::destroyGlobalSharedMemory() {
     sharedMemory.releaseLock();
 }
     
+uint32_t PerformanceManager::internScope(const std::string& name) {
+    ScopeRegistry& registry = scopeRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto it = registry.ids.find(name);
+    if (it != registry.ids.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(registry.names.size());
+    registry.ids[name] = id;
+    registry.names.push_back(name);
+    return id;
+}
+
+uint64_t PerformanceManager::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+    
 PerformanceManager::PerformanceManager()
     : _performanceMemory(nullptr)
+    , _telemetryMemory(nullptr)
+    , _id(nextManagerId++)
+    , _nPublishedScopes(0)
 {
     using ghoul::SharedMemory;
     PerformanceManager::createGlobalSharedMemory();
@@ -161,6 +215,21 @@ PerformanceManager::PerformanceManager()
     _performanceMemory = std::make_unique<ghoul::SharedMemory>(localName);
     // Using the placement-new to create a PerformanceLayout in the shared memory
     new (_performanceMemory->memory()) PerformanceLayout;
+
+    std::string telemetryName =
+        TelemetrySharedMemoryNameBase + std::to_string(blockIndex);
+    LINFO(
+        "Create shared memory '" + telemetryName + "' of " << sizeof(TelemetryLayout) <<
+        " bytes"
+    );
+    if (SharedMemory::exists(telemetryName)) {
+        // A left-over from a crashed instance, as the name is bound to the block index
+        SharedMemory::remove(telemetryName);
+    }
+    ghoul::SharedMemory::create(telemetryName, sizeof(TelemetryLayout));
+    _telemetryMemory = std::make_unique<ghoul::SharedMemory>(telemetryName);
+    new (_telemetryMemory->memory()) TelemetryLayout;
+    publishScopes();
 }
 
 PerformanceManager::~PerformanceManager() {
@@ -177,6 +246,12 @@ PerformanceManager::~PerformanceManager() {
         _performanceMemory = nullptr;
 
     }
+    if (_telemetryMemory) {
+        LINFO("Remove shared memory '" << _telemetryMemory->name() << "'");
+        ghoul::SharedMemory::remove(_telemetryMemory->name());
+
+        _telemetryMemory = nullptr;
+    }
     
     PerformanceManager::destroyGlobalSharedMemory();
 }
@@ -188,7 +263,7 @@ void PerformanceManager::resetPerformanceMeasurements() {
     new (ptr) PerformanceLayout;
     _performanceMemory->releaseLock();
     
-    individualPerformanceLocations.clear();
+    _functionEntryLocations.clear();
 }
     
 bool PerformanceManager::isMeasuringPerformance() const {
@@ -200,27 +275,111 @@ PerformanceLayout* PerformanceManager::performanceData() {
     return reinterpret_cast<PerformanceLayout*>(ptr);
 }
 
+TelemetryLayout* PerformanceManager::telemetryData() {
+    void* ptr = _telemetryMemory->memory();
+    return reinterpret_cast<TelemetryLayout*>(ptr);
+}
+
+std::string PerformanceManager::telemetryMemoryName() const {
+    return _telemetryMemory->name();
+}
+
+void PerformanceManager::publishScopes() {
+    std::lock_guard<std::mutex> publishLock(_publishMutex);
+    ScopeRegistry& registry = scopeRegistry();
+    std::lock_guard<std::mutex> registryLock(registry.mutex);
+
+    TelemetryLayout* layout = telemetryData();
+    uint32_t nScopes = std::min<uint32_t>(
+        static_cast<uint32_t>(registry.names.size()),
+        TelemetryLayout::NumberScopes
+    );
+    for (uint32_t i = _nPublishedScopes; i < nScopes; ++i) {
+        char* name = layout->scopes[i].name;
+        strncpy(name, registry.names[i].c_str(), TelemetryLayout::LengthName - 1);
+        name[TelemetryLayout::LengthName - 1] = '\0';
+    }
+    // Readers only look at names below nScopes, so it is published after the names
+    layout->nScopes.store(nScopes, std::memory_order_release);
+    _nPublishedScopes = nScopes;
+}
+
+TelemetryLayout::ThreadRing* PerformanceManager::threadRing() {
+    if (threadRingCache.manager != _id) {
+        TelemetryLayout* layout = telemetryData();
+        uint32_t index = layout->nThreads.fetch_add(1);
+        threadRingCache.manager = _id;
+        if (index < TelemetryLayout::NumberThreads) {
+            threadRingCache.ring = &(layout->threads[index]);
+        }
+        else {
+            layout->nThreads.store(TelemetryLayout::NumberThreads);
+            threadRingCache.ring = nullptr;
+            LWARNING("No telemetry ring buffer left for thread");
+        }
+    }
+    return threadRingCache.ring;
+}
+
+void PerformanceManager::nextFrame() {
+    telemetryData()->frame.fetch_add(1, std::memory_order_relaxed);
+}
+
 void PerformanceManager::storeIndividualPerformanceMeasurement
                                          (std::string identifier, long long microseconds)
 {
+    uint64_t end = now();
+    storeScopeMeasurement(internScope(identifier), end - microseconds * 1000, end);
+}
+
+void PerformanceManager::storeScopeMeasurement(uint32_t scope, uint64_t begin,
+                                               uint64_t end)
+{
+    // Lock-free path for the telemetry
+    if (scope >= _nPublishedScopes && _nPublishedScopes < TelemetryLayout::NumberScopes) {
+        publishScopes();
+    }
+    TelemetryLayout* telemetry = telemetryData();
+    TelemetryLayout::ThreadRing* ring = threadRing();
+    if (ring) {
+        ring->push({
+            scope,
+            telemetry->frame.load(std::memory_order_relaxed),
+            begin,
+            end
+        });
+    }
+    else {
+        telemetry->nDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Averaged values for the in-process performance overview
     PerformanceLayout* layout = performanceData();
     _performanceMemory->acquireLock();
 
-    auto it = individualPerformanceLocations.find(identifier);
-    PerformanceLayout::FunctionPerformanceLayout* p = nullptr;
-    if (it == individualPerformanceLocations.end()) {
-        p = &(layout->functionEntries[layout->nFunctionEntries]);
-        individualPerformanceLocations[identifier] = layout->nFunctionEntries;
-        ++(layout->nFunctionEntries);
+    if (scope >= _functionEntryLocations.size()) {
+        _functionEntryLocations.resize(scope + 1, -1);
     }
-    else {
-        p = &(layout->functionEntries[it->second]);
+    int16_t& location = _functionEntryLocations[scope];
+    if (location == -1) {
+        if (layout->nFunctionEntries >= PerformanceLayout::MaxValues) {
+            _performanceMemory->releaseLock();
+            return;
+        }
+        location = layout->nFunctionEntries;
+        ++(layout->nFunctionEntries);
+
+        PerformanceLayout::FunctionPerformanceLayout& entry =
+            layout->functionEntries[location];
+        std::lock_guard<std::mutex> lock(scopeRegistry().mutex);
+        strncpy(
+            entry.name,
+            scopeRegistry().names[scope].c_str(),
+            PerformanceLayout::LengthName - 1
+        );
+        entry.name[PerformanceLayout::LengthName - 1] = '\0';
     }
-#ifdef _MSC_VER
-    strcpy_s(p->name, identifier.length() + 1, identifier.c_str());
-#else
-    strcpy(p->name, identifier.c_str());
-#endif
+    PerformanceLayout::FunctionPerformanceLayout* p = &(layout->functionEntries[location]);
     
     std::rotate(
         std::begin(p->time),
@@ -228,7 +387,7 @@ void PerformanceManager::storeIndividualPerformanceMeasurement
         std::end(p->time)
     );
     p->time[PerformanceLayout::NumberValues - 1] =
-        static_cast<float>(microseconds);
+        static_cast<float>((end - begin) / 1000.0);
 
     _performanceMemory->releaseLock();
 }
@@ -35,24 +35,27 @@ namespace performance {
 
 PerformanceMeasurement::PerformanceMeasurement(std::string identifier,
                                      performance::PerformanceManager* manager)
-    : _identifier(std::move(identifier))
+    : PerformanceMeasurement(PerformanceManager::internScope(identifier), manager)
+{}
+
+PerformanceMeasurement::PerformanceMeasurement(uint32_t scope,
+                                               performance::PerformanceManager* manager)
+    : _scope(scope)
     , _manager(manager)
+    , _startTime(0)
 {
     if (_manager) {
         glFinish();
 
-        _startTime = std::chrono::high_resolution_clock::now();
+        _startTime = PerformanceManager::now();
     }
 }
 
 PerformanceMeasurement::~PerformanceMeasurement() {
-    glFinish();
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-        endTime - _startTime).count();
-
     if (_manager) {
-        _manager->storeIndividualPerformanceMeasurement(std::move(_identifier), duration);
+        glFinish();
+        uint64_t endTime = PerformanceManager::now();
+        _manager->storeScopeMeasurement(_scope, _startTime, endTime);
     }
 }
 
@@ -0,0 +1,72 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/performance/telemetrylayout.h>
+
+#include <cstring>
+
+namespace openspace {
+namespace performance {
+
+static_assert(
+    (TelemetryLayout::NumberEvents & (TelemetryLayout::NumberEvents - 1)) == 0,
+    "The number of events per ring has to be a power of two"
+);
+
+static_assert(
+    ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "The telemetry layout requires lock-free atomics to be placed in shared memory"
+);
+
+const uint32_t TelemetryLayout::Magic;
+const uint32_t TelemetryLayout::Version;
+const int TelemetryLayout::LengthName;
+const int TelemetryLayout::NumberScopes;
+const int TelemetryLayout::NumberThreads;
+const int TelemetryLayout::NumberEvents;
+
+void TelemetryLayout::ThreadRing::push(const Event& event) {
+    // We are the only writer, so the head can be read without synchronization
+    uint64_t h = head.load(std::memory_order_relaxed);
+    events[h & (NumberEvents - 1)] = event;
+    head.store(h + 1, std::memory_order_release);
+}
+
+TelemetryLayout::TelemetryLayout()
+    : magic(Magic)
+    , version(Version)
+    , nScopes(0)
+    , nThreads(0)
+    , frame(0)
+    , nDroppedEvents(0)
+{
+    std::memset(scopes, 0, sizeof(scopes));
+    for (ThreadRing& ring : threads) {
+        ring.head.store(0, std::memory_order_relaxed);
+        std::memset(ring.events, 0, sizeof(ring.events));
+    }
+}
+
+} // namespace performance
+} // namespace openspace
@@ -0,0 +1,125 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/performance/telemetryreader.h>
+
+#include <ghoul/misc/exception.h>
+#include <ghoul/misc/sharedmemory.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace openspace {
+namespace performance {
+
+TelemetryReader::TelemetryReader(const std::string& sharedMemoryName)
+    : _layout(nullptr)
+    , _nMissedEvents(0)
+{
+    if (!ghoul::SharedMemory::exists(sharedMemoryName)) {
+        throw ghoul::RuntimeError(
+            "Shared memory '" + sharedMemoryName + "' does not exist",
+            "TelemetryReader"
+        );
+    }
+    _memory = std::make_unique<ghoul::SharedMemory>(sharedMemoryName);
+    _layout = reinterpret_cast<const TelemetryLayout*>(_memory->memory());
+
+    if (_layout->magic != TelemetryLayout::Magic ||
+        _layout->version != TelemetryLayout::Version)
+    {
+        throw ghoul::RuntimeError(
+            "Shared memory '" + sharedMemoryName + "' contains incompatible telemetry",
+            "TelemetryReader"
+        );
+    }
+    _cursors.fill(0);
+}
+
+TelemetryReader::TelemetryReader(const TelemetryLayout* layout)
+    : _layout(layout)
+    , _nMissedEvents(0)
+{
+    _cursors.fill(0);
+}
+
+TelemetryReader::~TelemetryReader() {}
+
+size_t TelemetryReader::read(std::vector<Event>& events) {
+    const uint64_t N = TelemetryLayout::NumberEvents;
+    const size_t nEventsBefore = events.size();
+
+    uint32_t nThreads = std::min<uint32_t>(
+        _layout->nThreads.load(std::memory_order_acquire),
+        TelemetryLayout::NumberThreads
+    );
+    for (uint32_t t = 0; t < nThreads; ++t) {
+        const TelemetryLayout::ThreadRing& ring = _layout->threads[t];
+        uint64_t& cursor = _cursors[t];
+
+        // The oldest slot is the one the writer overwrites next, so at most N - 1
+        // events can be read safely
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        uint64_t first = std::max(cursor, head >= N ? head - N + 1 : 0);
+        _nMissedEvents += first - cursor;
+
+        const size_t nEventsBeforeRing = events.size();
+        for (uint64_t i = first; i < head; ++i) {
+            const TelemetryLayout::Event& e = ring.events[i & (N - 1)];
+            events.push_back({ t, e.scope, e.frame, e.begin, e.end });
+        }
+
+        // The writer might have lapped us while we were copying. Everything up to and
+        // including index (head - N) of the new head can be overwritten or in the process
+        // of being overwritten, so these events are discarded
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newHead = ring.head.load(std::memory_order_relaxed);
+        if (newHead >= N && newHead - N >= first) {
+            uint64_t nInvalid = std::min(newHead - N + 1, head) - first;
+            events.erase(
+                events.begin() + nEventsBeforeRing,
+                events.begin() + nEventsBeforeRing + nInvalid
+            );
+            _nMissedEvents += nInvalid;
+        }
+        cursor = head;
+    }
+    return events.size() - nEventsBefore;
+}
+
+std::string TelemetryReader::scopeName(uint32_t scope) const {
+    uint32_t nScopes = _layout->nScopes.load(std::memory_order_acquire);
+    if (scope >= nScopes || scope >= TelemetryLayout::NumberScopes) {
+        return "";
+    }
+    const char* name = _layout->scopes[scope].name;
+    return std::string(name, strnlen(name, TelemetryLayout::LengthName));
+}
+
+uint64_t TelemetryReader::nMissedEvents() const {
+    return _nMissedEvents;
+}
+
+} // namespace performance
+} // namespace openspace
@@ -0,0 +1,323 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/properties/propertyindex.h>
+
+#include <openspace/properties/property.h>
+#include <openspace/properties/propertyowner.h>
+
+#include <cctype>
+#include <cstring>
+#include <regex>
+
+namespace openspace {
+namespace properties {
+
+namespace {
+    // Characters that terminate the literal prefix of an ECMAScript regular expression
+    const char* RegexMetaCharacters = ".[]{}()*+?|^$";
+
+    // Returns true if the regular expression contains an alternative on the top level,
+    // in which case no common prefix of all matches can be determined
+    bool hasTopLevelAlternative(const std::string& regex) {
+        int depth = 0;
+        bool inBrackets = false;
+        for (size_t i = 0; i < regex.size(); ++i) {
+            const char c = regex[i];
+            if (c == '\\') {
+                ++i;
+            }
+            else if (inBrackets) {
+                inBrackets = (c != ']');
+            }
+            else if (c == '[') {
+                inBrackets = true;
+            }
+            else if (c == '(') {
+                ++depth;
+            }
+            else if (c == ')') {
+                --depth;
+            }
+            else if (c == '|' && depth == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace
+
+std::atomic<unsigned long long> PropertyIndex::_globalGeneration(1);
+
+PropertyIndex::PropertyIndex()
+    : _size(0)
+    , _generation(0)
+{}
+
+void PropertyIndex::markDirty() {
+    ++_globalGeneration;
+}
+
+unsigned long long PropertyIndex::generation() {
+    return _globalGeneration;
+}
+
+bool PropertyIndex::isUpToDate() const {
+    return _generation == generation();
+}
+
+void PropertyIndex::rebuild(const std::vector<const PropertyOwner*>& roots) {
+    // Take the generation before walking the owners so that changes that happen during
+    // the rebuild will trigger another one
+    const unsigned long long currentGeneration = generation();
+    clear();
+    for (const PropertyOwner* owner : roots) {
+        if (owner) {
+            insert(*owner, "");
+        }
+    }
+    _generation = currentGeneration;
+}
+
+void PropertyIndex::clear() {
+    _root.property = nullptr;
+    _root.children.clear();
+    _size = 0;
+    _generation = 0;
+}
+
+size_t PropertyIndex::size() const {
+    return _size;
+}
+
+void PropertyIndex::insert(const PropertyOwner& owner, const std::string& prefix) {
+    // Mirrors Property::fullyQualifiedIdentifier, which skips unnamed owners
+    std::string ownerPrefix = prefix;
+    if (!owner.name().empty()) {
+        if (!ownerPrefix.empty()) {
+            ownerPrefix += PropertyOwner::URISeparator;
+        }
+        ownerPrefix += owner.name();
+    }
+
+    for (Property* prop : owner.properties()) {
+        if (ownerPrefix.empty()) {
+            insert(prop->identifier(), prop);
+        }
+        else {
+            insert(ownerPrefix + PropertyOwner::URISeparator + prop->identifier(), prop);
+        }
+    }
+
+    for (const PropertyOwner* subOwner : owner.propertySubOwners()) {
+        insert(*subOwner, ownerPrefix);
+    }
+}
+
+void PropertyIndex::insert(const std::string& uri, Property* prop) {
+    Node* node = &_root;
+    size_t begin = 0;
+    while (begin <= uri.size()) {
+        size_t end = uri.find(PropertyOwner::URISeparator, begin);
+        if (end == std::string::npos) {
+            end = uri.size();
+        }
+
+        std::unique_ptr<Node>& child = node->children[uri.substr(begin, end - begin)];
+        if (!child) {
+            child = std::make_unique<Node>();
+        }
+        node = child.get();
+        begin = end + 1;
+    }
+
+    // The first Property that was registered for an URI wins, which is the same
+    // precedence that the sequential lookup in openspace::property uses
+    if (!node->property) {
+        node->property = prop;
+        ++_size;
+    }
+}
+
+Property* PropertyIndex::property(const std::string& uri) const {
+    const Node* node = &_root;
+    size_t begin = 0;
+    while (begin <= uri.size()) {
+        size_t end = uri.find(PropertyOwner::URISeparator, begin);
+        if (end == std::string::npos) {
+            end = uri.size();
+        }
+
+        auto it = node->children.find(uri.substr(begin, end - begin));
+        if (it == node->children.end()) {
+            return nullptr;
+        }
+        node = it->second.get();
+        begin = end + 1;
+    }
+    return node->property;
+}
+
+void PropertyIndex::visit(const Node& node, std::string& uri, const Visitor& visitor) {
+    if (node.property) {
+        visitor(uri, node.property);
+    }
+
+    const size_t length = uri.size();
+    for (const auto& child : node.children) {
+        uri += PropertyOwner::URISeparator;
+        uri += child.first;
+        visit(*child.second, uri, visitor);
+        uri.resize(length);
+    }
+}
+
+void PropertyIndex::visitPrefix(const std::string& prefix, const Visitor& visitor) const
+{
+    // Descend through all complete segments of the prefix
+    const Node* node = &_root;
+    std::string uri;
+    size_t begin = 0;
+    size_t end = prefix.find(PropertyOwner::URISeparator);
+    while (end != std::string::npos) {
+        const std::string segment = prefix.substr(begin, end - begin);
+        auto it = node->children.find(segment);
+        if (it == node->children.end()) {
+            return;
+        }
+        node = it->second.get();
+        uri += segment;
+        uri += PropertyOwner::URISeparator;
+
+        begin = end + 1;
+        end = prefix.find(PropertyOwner::URISeparator, begin);
+    }
+
+    // The remaining partial segment selects a contiguous range of the sorted children
+    const std::string partial = prefix.substr(begin);
+    for (auto it = node->children.lower_bound(partial);
+         it != node->children.end() && it->first.compare(0, partial.size(), partial) == 0;
+         ++it)
+    {
+        std::string childUri = uri + it->first;
+        visit(*it->second, childUri, visitor);
+    }
+}
+
+std::vector<Property*> PropertyIndex::propertiesMatchingWildcard(
+                                                       const std::string& pattern) const
+{
+    std::vector<Property*> result;
+    visitPrefix(
+        pattern.substr(0, pattern.find('*')),
+        [&pattern, &result](const std::string& uri, Property* prop) {
+            if (matchesWildcard(uri, pattern)) {
+                result.push_back(prop);
+            }
+        }
+    );
+    return result;
+}
+
+std::vector<Property*> PropertyIndex::propertiesMatchingRegex(
+                                                         const std::string& regex) const
+{
+    const std::regex expression(regex, std::regex_constants::optimize);
+
+    std::vector<Property*> result;
+    visitPrefix(
+        literalPrefix(regex),
+        [&expression, &result](const std::string& uri, Property* prop) {
+            if (std::regex_match(uri, expression)) {
+                result.push_back(prop);
+            }
+        }
+    );
+    return result;
+}
+
+std::string PropertyIndex::literalPrefix(const std::string& regex) {
+    if (hasTopLevelAlternative(regex)) {
+        return "";
+    }
+
+    std::string prefix;
+    size_t i = (!regex.empty() && regex[0] == '^') ? 1 : 0;
+    for (; i < regex.size(); ++i) {
+        const char c = regex[i];
+        if (c == '\\') {
+            // Escaped punctuation is a literal, everything else is a character class
+            const bool hasNext = i + 1 < regex.size();
+            if (hasNext && std::ispunct(static_cast<unsigned char>(regex[i + 1]))) {
+                prefix += regex[i + 1];
+                ++i;
+                continue;
+            }
+            break;
+        }
+        if (std::strchr(RegexMetaCharacters, c)) {
+            // These quantifiers make the previous character optional
+            if ((c == '*' || c == '?' || c == '{') && !prefix.empty()) {
+                prefix.pop_back();
+            }
+            break;
+        }
+        prefix += c;
+    }
+    return prefix;
+}
+
+bool PropertyIndex::matchesWildcard(const std::string& uri, const std::string& pattern) {
+    size_t u = 0;
+    size_t p = 0;
+    size_t starPattern = std::string::npos;
+    size_t starUri = 0;
+
+    while (u < uri.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starUri = u;
+        }
+        else if (p < pattern.size() && pattern[p] == uri[u]) {
+            ++p;
+            ++u;
+        }
+        else if (starPattern != std::string::npos) {
+            // Let the last wildcard swallow one more character and try again
+            p = starPattern + 1;
+            u = ++starUri;
+        }
+        else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+} // namespace properties
+} // namespace openspace
@@ -24,6 +24,8 @@
 
 #include <openspace/properties/propertyowner.h>
 
+#include <openspace/properties/propertyindex.h>
+
 #include <ghoul/logging/logmanager.h>
 
 #include <algorithm>
@@ -55,6 +57,8 @@ PropertyOwner::PropertyOwner()
 PropertyOwner::~PropertyOwner() {
     _properties.clear();
     _subOwners.clear();
+    // The property index might still point to the Propertys of this owner
+    PropertyIndex::markDirty();
 }
 
 std::vector<Property*> PropertyOwner::properties() const {
@@ -186,6 +190,7 @@ void PropertyOwner::addProperty(Property* prop)
             // now have found the correct position to add it in
             _properties.insert(it, prop);
             prop->setPropertyOwner(this);
+            PropertyIndex::markDirty();
         }
     }
 }
@@ -228,6 +233,7 @@ void PropertyOwner::addPropertySubOwner(openspace::properties::PropertyOwner* ow
             // Otherwise we have found the correct position to add it in
             _subOwners.insert(it, owner);
             owner->setPropertyOwner(this);
+            PropertyIndex::markDirty();
         }
     }
     
@@ -251,6 +257,7 @@ void PropertyOwner::removeProperty(Property* prop) {
     if (it != _properties.end() && (*it)->identifier() == prop->identifier()) {
         (*it)->setPropertyOwner(nullptr);
         _properties.erase(it);
+        PropertyIndex::markDirty();
     } else
         LERROR("Property with identifier '" << prop->identifier()
                                             << "' not found for removal.");
@@ -273,6 +280,7 @@ void PropertyOwner::removePropertySubOwner(openspace::properties::PropertyOwner*
     // If we found the propertyowner, we can delete it
     if (it != _subOwners.end() && (*it)->name() == owner->name()) {
         _subOwners.erase(it);
+        PropertyIndex::markDirty();
     } else
         LERROR("PropertyOwner with name '" << owner->name()
                << "' not found for removal.");
@@ -284,6 +292,7 @@ void PropertyOwner::removePropertySubOwner(openspace::properties::PropertyOwner&
 
 void PropertyOwner::setName(std::string name) {
     _name = std::move(name);
+    PropertyIndex::markDirty();
 }
 
 const std::string& PropertyOwner::name() const {
@@ -26,6 +26,7 @@
 
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/interaction/interactionhandler.h>
+#include <openspace/properties/propertyindex.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/rendering/renderable.h>
 #include <openspace/scene/scene.h>
@@ -57,9 +58,11 @@ Renderable* renderable(const std::string& name) {
 }
 
 properties::Property* property(const std::string& uri) {
-    properties::Property* globalProp = OsEng.globalPropertyOwner().property(uri);
-    if (globalProp) {
-        return globalProp;
+    // Global properties and scene graph nodes are covered by the index, so only
+    // ScreenSpaceRenderables and IswaGroups need the slower search below
+    properties::Property* indexedProp = propertyIndex().property(uri);
+    if (indexedProp) {
+        return indexedProp;
     }
     else {
         // The URI consists of the following form at this stage:
@@ -122,5 +125,25 @@ std::vector<properties::Property*> allProperties() {
     return properties;
 }
 
+const properties::PropertyIndex& propertyIndex() {
+    static properties::PropertyIndex index;
+
+    if (!index.isUpToDate()) {
+        std::vector<const properties::PropertyOwner*> roots;
+        roots.push_back(&OsEng.globalPropertyOwner());
+
+        const Scene* graph = sceneGraph();
+        if (graph) {
+            std::vector<SceneGraphNode*> nodes = graph->allSceneGraphNodes();
+            roots.insert(roots.end(), nodes.begin(), nodes.end());
+        }
+
+        index.rebuild(roots);
+        LDEBUG("Rebuilt property index with " << index.size() << " properties");
+    }
+
+    return index;
+}
+
 
 }  // namespace
@@ -118,6 +118,10 @@ Renderable::Renderable(const ghoul::Dictionary& dictionary)
 
 Renderable::~Renderable() {}
 
+bool Renderable::loadResources() {
+    return true;
+}
+
 void Renderable::setBoundingSphere(PowerScaledScalar boundingSphere) {
     boundingSphere_ = std::move(boundingSphere);
 }
@@ -485,6 +485,7 @@ void RenderEngine::postDraw() {
 
     if (_performanceManager) {
         _performanceManager->storeScenePerformanceMeasurements(scene()->allSceneGraphNodes());
+        _performanceManager->nextFrame();
     }
 }
 
@@ -626,6 +627,38 @@ std::unique_ptr<ghoul::opengl::ProgramObject> RenderEngine::buildRenderProgram(
     return program;
 }
 
+/**
+ * Create a program object for rendering with the used renderer without building it
+ */
+std::unique_ptr<ghoul::opengl::ProgramObject> RenderEngine::createRenderProgram(
+    std::string name,
+    std::string vsPath,
+    std::string fsPath,
+    const ghoul::Dictionary& data) {
+
+    ghoul::Dictionary dict = data;
+    dict.setValue("rendererData", _rendererData);
+    dict.setValue("fragmentPath", fsPath);
+
+    using ghoul::opengl::ShaderObject;
+    std::unique_ptr<ghoul::opengl::ProgramObject> program =
+        std::make_unique<ghoul::opengl::ProgramObject>(name);
+    program->setDictionary(dict);
+    program->attachObject(std::make_shared<ShaderObject>(
+        ShaderObject::ShaderTypeVertex,
+        absPath(vsPath),
+        name + " Vertex",
+        dict));
+    program->attachObject(std::make_shared<ShaderObject>(
+        ShaderObject::ShaderTypeFragment,
+        absPath(RenderFsPath),
+        name + " Fragment",
+        dict));
+
+    _programs.push_back(program.get());
+    return program;
+}
+
 void RenderEngine::removeRenderProgram(const std::unique_ptr<ghoul::opengl::ProgramObject>& program) {
     if (!program)
         return;
@@ -28,11 +28,13 @@
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/engine/wrapper/windowwrapper.h>
 #include <openspace/interaction/interactionhandler.h>
+#include <openspace/properties/propertyindex.h>
 #include <openspace/query/query.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scripting/scriptengine.h>
 #include <openspace/scripting/script_helper.h>
+#include <openspace/util/taskgraph.h>
 #include <openspace/util/time.h>
 
 #include <ghoul/filesystem/filesystem.h>
@@ -46,11 +48,14 @@
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/opengl/texture.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <chrono>
+#include <unordered_map>
 
 #ifdef OPENSPACE_MODULE_ONSCREENGUI_ENABLED
 #include <modules/onscreengui/include/gui.h>
@@ -212,19 +217,7 @@ bool Scene::loadSceneInternal(const std::string& sceneDescriptionFilePath) {
 
     _graph.loadFromFile(sceneDescriptionFilePath);
 
-    // Initialize all nodes
-    for (SceneGraphNode* node : _graph.nodes()) {
-        try {
-            bool success = node->initialize();
-            if (success)
-                LDEBUG(node->name() << " initialized successfully!");
-            else
-                LWARNING(node->name() << " not initialized.");
-        }
-        catch (const ghoul::RuntimeError& e) {
-            LERRORC(_loggerCat + "(" + e.component + ")", e.what());
-        }
-    }
+    initializeNodes();
 
     // update the position of all nodes
     // TODO need to check this; unnecessary? (ab)
@@ -279,6 +272,105 @@ bool Scene::loadSceneInternal(const std::string& sceneDescriptionFilePath) {
     return true;
 }
 
+void Scene::initializeNodes() {
+    using Clock = std::chrono::high_resolution_clock;
+    auto seconds = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    };
+
+    const std::vector<SceneGraphNode*>& nodes = _graph.nodes();
+    _loadTimings.assign(nodes.size(), { "", 0.0, 0.0 });
+
+    // The nodes are sorted topologically, so the tasks of all dependencies of a node
+    // have been added before the task of the node itself
+    TaskGraph loadTasks;
+    std::unordered_map<SceneGraphNode*, TaskGraph::TaskId> taskIds;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        SceneGraphNode* node = nodes[i];
+        _loadTimings[i].name = node->name();
+
+        std::vector<TaskGraph::TaskId> dependencies;
+        for (SceneGraphNode* dependency : _graph.dependencies(node)) {
+            auto it = taskIds.find(dependency);
+            if (it != taskIds.end()) {
+                dependencies.push_back(it->second);
+            }
+        }
+
+        NodeLoadTiming& timing = _loadTimings[i];
+        taskIds[node] = loadTasks.addTask([node, &timing, &seconds]() {
+            Clock::time_point start = Clock::now();
+            try {
+                if (!node->loadResources()) {
+                    LWARNING(node->name() << " could not load its resources.");
+                }
+            }
+            catch (const ghoul::RuntimeError& e) {
+                LERRORC(_loggerCat + "(" + e.component + ")", e.what());
+            }
+            timing.loadTime = seconds(start, Clock::now());
+        }, dependencies);
+    }
+
+    Clock::time_point start = Clock::now();
+    loadTasks.run();
+    Clock::time_point loaded = Clock::now();
+
+    // Initialize all nodes
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        SceneGraphNode* node = nodes[i];
+        Clock::time_point nodeStart = Clock::now();
+        try {
+            bool success = node->initialize();
+            if (success)
+                LDEBUG(node->name() << " initialized successfully!");
+            else
+                LWARNING(node->name() << " not initialized.");
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(_loggerCat + "(" + e.component + ")", e.what());
+        }
+        _loadTimings[i].initializeTime = seconds(nodeStart, Clock::now());
+    }
+
+    LINFO(
+        "Loaded the resources of " << nodes.size() << " nodes in " <<
+        seconds(start, loaded) << " s and initialized them in " <<
+        seconds(loaded, Clock::now()) << " s"
+    );
+    logLoadTimings();
+}
+
+void Scene::logLoadTimings() const {
+    const size_t MaxReportedNodes = 10;
+
+    std::vector<NodeLoadTiming> timings = _loadTimings;
+    std::sort(
+        timings.begin(),
+        timings.end(),
+        [](const NodeLoadTiming& lhs, const NodeLoadTiming& rhs) {
+            return lhs.loadTime + lhs.initializeTime > rhs.loadTime + rhs.initializeTime;
+        }
+    );
+
+    for (size_t i = 0; i < timings.size(); ++i) {
+        const NodeLoadTiming& t = timings[i];
+        std::stringstream s;
+        s << t.name << ": " << t.loadTime << " s loading, " << t.initializeTime <<
+            " s initializing";
+        if (i < MaxReportedNodes) {
+            LINFO(s.str());
+        }
+        else {
+            LDEBUG(s.str());
+        }
+    }
+}
+
+const std::vector<Scene::NodeLoadTiming>& Scene::loadTimings() const {
+    return _loadTimings;
+}
+
 //void Scene::loadModules(
 //    const std::string& directory, 
 //    const ghoul::Dictionary& dictionary) 
@@ -28,36 +28,32 @@ namespace openspace {
 
 namespace {
 
-void applyRegularExpression(lua_State* L, std::regex regex, std::vector<properties::Property*> properties, int type) {
+void applyValue(lua_State* L, const std::vector<properties::Property*>& properties,
+                int type)
+{
     using ghoul::lua::errorLocation;
     using ghoul::lua::luaTypeToString;
 
     for (properties::Property* prop : properties) {
-        // Check the regular expression for all properties
-        std::string id = prop->fullyQualifiedIdentifier();
-        if (std::regex_match(id, regex)) {
-            // If the fully qualified id matches the regular expression, we queue the
-            // value change if the types agree
-
-            if (type != prop->typeLua()) {
-                LERRORC("property_setValue",
-                        errorLocation(L) << "Property '" <<
-                        prop->fullyQualifiedIdentifier() <<
-                        "' does not accept input of type '" << luaTypeToString(type) <<
-                        "'. Requested type: '" << luaTypeToString(prop->typeLua()) << "'"
-                );
-            }
-            else {
-                prop->setLuaValue(L);
-                //ensure properties are synced over parallel connection
-                std::string value;
-                prop->getStringValue(value);
-                OsEng.parallelConnection().scriptMessage(
-                    prop->fullyQualifiedIdentifier(),
-                    value
-                );
-            }
-
+        // The properties have already been matched against the URI, so we queue the
+        // value change if the types agree
+        if (type != prop->typeLua()) {
+            LERRORC("property_setValue",
+                    errorLocation(L) << "Property '" <<
+                    prop->fullyQualifiedIdentifier() <<
+                    "' does not accept input of type '" << luaTypeToString(type) <<
+                    "'. Requested type: '" << luaTypeToString(prop->typeLua()) << "'"
+            );
+        }
+        else {
+            prop->setLuaValue(L);
+            //ensure properties are synced over parallel connection
+            std::string value;
+            prop->getStringValue(value);
+            OsEng.parallelConnection().scriptMessage(
+                prop->fullyQualifiedIdentifier(),
+                value
+            );
         }
     }
 }
@@ -123,10 +119,9 @@ int property_setValueRegex(lua_State* L) {
 
     std::string regex = luaL_checkstring(L, -2);
     try {
-        applyRegularExpression(
+        applyValue(
             L,
-            std::regex(regex, std::regex_constants::optimize),
-            allProperties(),
+            propertyIndex().propertiesMatchingRegex(regex),
             lua_type(L, -1)
         );
     }
@@ -152,22 +147,12 @@ int property_setValue(lua_State* L) {
     int nArguments = lua_gettop(L);
     SCRIPT_CHECK_ARGUMENTS("property_setValue", L, 2, nArguments);
 
-    std::string regex = luaL_checkstring(L, -2);
-
-    // Replace all wildcards *  with the correct regex (.*)
-    size_t startPos = regex.find("*");
-    while (startPos != std::string::npos) {
-        regex.replace(startPos, 1, "(.*)");
-        startPos += 4;
-
-        startPos = regex.find("*", startPos);
-    }
-
+    std::string uri = luaL_checkstring(L, -2);
 
-    applyRegularExpression(
+    // Wildcards (*) match any sequence of characters, including the separators
+    applyValue(
         L,
-        std::regex(regex/*, std::regex_constants::optimize*/),
-        allProperties(),
+        propertyIndex().propertiesMatchingWildcard(uri),
         lua_type(L, -1)
     );
 
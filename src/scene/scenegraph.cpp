@@ -26,6 +26,7 @@
 
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/scene/scenegraphnode.h>
+#include <openspace/properties/propertyindex.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/interaction/interactionhandler.h>
 
@@ -75,7 +76,9 @@ void SceneGraph::clear() {
         delete n;
 
     _nodes.clear();
+    _nodesByName.clear();
     _rootNode = nullptr;
+    properties::PropertyIndex::markDirty();
 }
 
 bool SceneGraph::loadFromFile(const std::string& sceneDescription) {
@@ -194,6 +197,7 @@ bool SceneGraph::loadFromFile(const std::string& sceneDescription) {
     SceneGraphNodeInternal* internalRoot = new SceneGraphNodeInternal;
     internalRoot->node = _rootNode;
     _nodes.push_back(internalRoot);
+    addToIndex(internalRoot);
 
     std::sort(keys.begin(), keys.end());
     ghoul::filesystem::Directory oldDirectory = FileSys.currentDirectory();
@@ -341,6 +345,7 @@ bool SceneGraph::loadFromFile(const std::string& sceneDescription) {
                 SceneGraphNodeInternal* internalNode = new SceneGraphNodeInternal;
                 internalNode->node = node;
                 _nodes.push_back(internalNode);
+                addToIndex(internalNode);
             }
         };
 
@@ -400,6 +405,7 @@ bool SceneGraph::loadFromFile(const std::string& sceneDescription) {
     }
 
     for (SceneGraphNodeInternal* node : nodesToDelete) {
+        removeFromIndex(node);
         _nodes.erase(std::find(_nodes.begin(), _nodes.end(), node));
         delete node;
     }
@@ -469,25 +475,35 @@ bool SceneGraph::addSceneGraphNode(SceneGraphNode* node) {
     SceneGraphNodeInternal* internalNode = new SceneGraphNodeInternal;
     internalNode->node = node;
 
-    auto it = std::find_if(
-        _nodes.begin(),
-        _nodes.end(),
-        [node](SceneGraphNodeInternal* i) {
-            return i->node == node->parent();
+    SceneGraphNodeInternal* parent = nullptr;
+    if (node->parent()) {
+        parent = nodeByName(node->parent()->name());
+        if (parent && parent->node != node->parent()) {
+            // The parent's name is shadowed by another node, so we have to search
+            auto it = std::find_if(
+                _nodes.begin(),
+                _nodes.end(),
+                [node](SceneGraphNodeInternal* i) {
+                    return i->node == node->parent();
+                }
+            );
+            parent = (it != _nodes.end()) ? *it : nullptr;
         }
-    );
+    }
 
-    if (it == _nodes.end()) {
+    if (!parent) {
         LERROR("Parent node was not found");
         delete internalNode;
         return false;
     }
 
-    (*it)->incomingEdges.push_back(internalNode);
-    internalNode->outgoingEdges.push_back(*it);
+    parent->incomingEdges.push_back(internalNode);
+    internalNode->outgoingEdges.push_back(parent);
 
     _nodes.push_back(internalNode);
+    addToIndex(internalNode);
     sortTopologically();
+    properties::PropertyIndex::markDirty();
 
     return true;
 }
@@ -511,7 +527,9 @@ bool SceneGraph::removeSceneGraphNode(SceneGraphNode* node) {
 
     // Remove internal node from the list of nodes
     //SceneGraphNodeInternal* internalNode = *it;
+    removeFromIndex(*it);
     _nodes.erase(it);
+    properties::PropertyIndex::markDirty();
 
     if (OsEng.interactionHandler().focusNode() == node)
         OsEng.interactionHandler().setFocusNode(node->parent());
@@ -538,39 +556,66 @@ bool SceneGraph::removeSceneGraphNode(SceneGraphNode* node) {
     return true;
 }
 
-SceneGraph::SceneGraphNodeInternal* SceneGraph::nodeByName(const std::string& name) {
-    auto it = std::find_if(
-        _nodes.begin(),
-        _nodes.end(),
-        [name](SceneGraphNodeInternal* node) {
-            return node->node->name() == name;
+SceneGraph::SceneGraphNodeInternal* SceneGraph::nodeByName(const std::string& name) const
+{
+    auto it = _nodesByName.find(name);
+    if (it != _nodesByName.end()) {
+        if (it->second->node->name() == name)
+            return it->second;
+        // The node was renamed after it was indexed
+        _nodesByName.erase(it);
+    }
+
+    // Nodes can be renamed without the scene graph knowing, so a miss falls back to a
+    // search that also indexes the node under its current name
+    for (SceneGraphNodeInternal* n : _nodes) {
+        if (n->node->name() == name) {
+            _nodesByName.emplace(name, n);
+            return n;
         }
-    );
+    }
+    return nullptr;
+}
 
-    if (it == _nodes.end())
-        return nullptr;
-    else
-        return *it;
+void SceneGraph::addToIndex(SceneGraphNodeInternal* node) {
+    // emplace does not overwrite, so the first node with a given name stays reachable
+    _nodesByName.emplace(node->node->name(), node);
+}
+
+void SceneGraph::removeFromIndex(SceneGraphNodeInternal* node) {
+    // The node might have been renamed since it was indexed, so search by value
+    for (auto it = _nodesByName.begin(); it != _nodesByName.end(); ) {
+        if (it->second == node)
+            it = _nodesByName.erase(it);
+        else
+            ++it;
+    }
+    // Nodes shadowed by the removed one are indexed again by nodeByName when needed
 }
 
 const std::vector<SceneGraphNode*>& SceneGraph::nodes() const {
     return _topologicalSortedNodes;
 }
 
+std::vector<SceneGraphNode*> SceneGraph::dependencies(SceneGraphNode* node) const {
+    std::vector<SceneGraphNode*> result;
+    SceneGraphNodeInternal* internalNode = nodeByName(node->name());
+    if (internalNode && internalNode->node == node) {
+        for (SceneGraphNodeInternal* dependency : internalNode->outgoingEdges) {
+            result.push_back(dependency->node);
+        }
+    }
+    return result;
+}
+
 SceneGraphNode* SceneGraph::rootNode() const {
     return _rootNode;
 }
 
 SceneGraphNode* SceneGraph::sceneGraphNode(const std::string& name) const {
-    auto it = std::find_if(
-        _nodes.begin(),
-        _nodes.end(),
-        [name](SceneGraphNodeInternal* node) {
-            return node->node->name() == name;
-        }
-    );
-    if (it != _nodes.end())
-        return (*it)->node;
+    SceneGraphNodeInternal* node = nodeByName(name);
+    if (node)
+        return node->node;
     else
         return nullptr;
 }
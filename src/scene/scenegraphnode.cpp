@@ -181,6 +181,12 @@ SceneGraphNode::~SceneGraphNode() {
     deinitialize();
 }
 
+bool SceneGraphNode::loadResources() {
+    if (_renderable)
+        return _renderable->loadResources();
+    return true;
+}
+
 bool SceneGraphNode::initialize() {
     if (_renderable)
         _renderable->initialize();
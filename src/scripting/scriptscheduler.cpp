@@ -31,6 +31,8 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/filesystem/filesystem>
 
+#include <algorithm>
+#include <iterator>
 
 namespace openspace {
 namespace scripting {
@@ -82,19 +84,44 @@ void ScriptScheduler::loadScripts(const std::string& filepath, lua_State* L) {
 }
 
 void ScriptScheduler::loadScripts(const ghoul::Dictionary& dict) {
+    std::vector<ScheduledScript> scripts;
+    scripts.reserve(dict.size());
     for (size_t i = 0; i < dict.size(); ++i) {
         std::string id = std::to_string(i + 1);
         const ghoul::Dictionary& timedScriptDict = dict.value<ghoul::Dictionary>(id);
-        _scheduledScripts.push_back(ScheduledScript(timedScriptDict));
+        scripts.push_back(ScheduledScript(timedScriptDict));
     }
+    addScripts(std::move(scripts));
+}
 
-    // Sort scripts by time
-    std::stable_sort(_scheduledScripts.begin(), _scheduledScripts.end(), &ScheduledScript::CompareByTime);
-
-    // Ensure _currentIndex and _currentTime is accurate after new scripts was added
-    double lastTime = _currentTime;
-    rewind();
-    progressTo(lastTime);
+void ScriptScheduler::addScripts(std::vector<ScheduledScript> scripts) {
+    // Sort the new scripts by time and merge them behind existing scripts with the same
+    // time stamp, which keeps the order of loading for simultaneous scripts
+    std::stable_sort(scripts.begin(), scripts.end(), &ScheduledScript::CompareByTime);
+
+    size_t nExisting = _scheduledScripts.size();
+    _scheduledScripts.insert(
+        _scheduledScripts.end(),
+        std::make_move_iterator(scripts.begin()),
+        std::make_move_iterator(scripts.end())
+    );
+    std::inplace_merge(
+        _scheduledScripts.begin(),
+        _scheduledScripts.begin() + nExisting,
+        _scheduledScripts.end(),
+        &ScheduledScript::CompareByTime
+    );
+
+    _timeIndex.resize(_scheduledScripts.size());
+    std::transform(
+        _scheduledScripts.begin(),
+        _scheduledScripts.end(),
+        _timeIndex.begin(),
+        [](const ScheduledScript& s) { return s.time; }
+    );
+
+    // Ensure _currentIndex is accurate after new scripts was added
+    _currentIndex = indexForTime(_currentTime);
 }
 
 void ScriptScheduler::rewind() {
@@ -106,27 +133,63 @@ void ScriptScheduler::rewind() {
 void ScriptScheduler::clearSchedule() {
     rewind();
     _scheduledScripts.clear();
+    _timeIndex.clear();
 }
 
-std::queue<std::string> ScriptScheduler::progressTo(double newTime) {
-    std::queue<std::string> triggeredScripts;
-    if (newTime > _currentTime) {
-        while(_currentIndex < _scheduledScripts.size() && _scheduledScripts[_currentIndex].time <= newTime){
-            triggeredScripts.push(_scheduledScripts[_currentIndex].script.forwardScript);
-            _currentIndex++;
-        }
+size_t ScriptScheduler::indexForTime(double time) const {
+    return std::upper_bound(_timeIndex.begin(), _timeIndex.end(), time) -
+        _timeIndex.begin();
+}
+
+template <typename Func>
+void ScriptScheduler::progress(double newTime, Func callback) {
+    size_t newIndex = indexForTime(newTime);
+
+    for (size_t i = _currentIndex; i < newIndex; ++i) {
+        callback(_scheduledScripts[i].script.forwardScript);
     }
-    else {
-        while (0 < _currentIndex && _scheduledScripts[_currentIndex - 1].time > newTime) {
-            triggeredScripts.push(_scheduledScripts[_currentIndex - 1].script.backwardScript);
-            _currentIndex--;
-        }
+    for (size_t i = _currentIndex; i > newIndex; --i) {
+        callback(_scheduledScripts[i - 1].script.backwardScript);
     }
 
+    _currentIndex = newIndex;
     _currentTime = newTime;
+}
+
+std::queue<std::string> ScriptScheduler::progressTo(double newTime) {
+    std::queue<std::string> triggeredScripts;
+    progress(newTime, [&triggeredScripts](const std::string& script) {
+        triggeredScripts.push(script);
+    });
     return triggeredScripts;
 }
 
+std::string ScriptScheduler::progressToBatched(double newTime) {
+    std::string batch;
+    progress(newTime, [&batch](const std::string& script) {
+        if (script.empty()) {
+            return;
+        }
+        batch += isolatedChunk(script);
+    });
+    return batch;
+}
+
+std::string ScriptScheduler::isolatedChunk(const std::string& script) {
+    // Find a long bracket level whose closing bracket first occurs after the script
+    std::string level;
+    while ((script + "]" + level + "]").find("]" + level + "]") != script.size()) {
+        level += '=';
+    }
+
+    // load compiles the script as its own chunk, so a syntax error, a top-level return,
+    // or a local variable only affects this script; pcall contains runtime errors
+    return "do local f, e = (loadstring or load)([" + level + "[" + script + "]" +
+        level + "], '=scheduled script') " +
+        "if f then local ok, r = pcall(f) if not ok then e = r end end " +
+        "if e then openspace.printError(e) end end\n";
+}
+
 std::queue<std::string> ScriptScheduler::progressTo(const std::string& timeStr) {
     return std::move(progressTo(SpiceManager::ref().ephemerisTimeFromDate(timeStr)));
 }
@@ -24,12 +24,104 @@
 
 #include <openspace/util/histogram.h>
 
+#include <openspace/util/taskgraph.h>
+
 #include <ghoul/logging/logmanager.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cassert>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENSPACE_HISTOGRAM_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace {
     const std::string _loggerCat = "Histogram";
+
+    // The bins are computed for this many values at a time and stored on the stack
+    // before they are counted
+    const size_t BlockSize = 1024;
+
+    // Number of values counted by one task, which also keeps the 32 bit counts of a task
+    // from overflowing
+    const size_t ValuesPerTask = 1 << 20;
+
+    // Number of interleaved copies of the counts; incrementing them in turn avoids
+    // waiting for the previous increment when consecutive values fall into the same bin
+    const int NumCounters = 4;
+
+    // Computes the bins of the n values, in the same way as Histogram::add(float).
+    // Values that are out of range, including NaNs, are put into bin numBins. As the
+    // normalized value is positive, the conversion to int is equal to floor
+    void computeBins(const float* values, size_t n, float minValue, float maxValue,
+                     int numBins, int32_t* bins)
+    {
+        const float range = maxValue - minValue;
+        const float maxBin = numBins - 1.0f;
+        const float outOfRange = static_cast<float>(numBins);
+
+        size_t i = 0;
+#ifdef OPENSPACE_HISTOGRAM_SSE2
+        const __m128 vMinValue = _mm_set1_ps(minValue);
+        const __m128 vMaxValue = _mm_set1_ps(maxValue);
+        const __m128 vRange = _mm_set1_ps(range);
+        const __m128 vNumBins = _mm_set1_ps(static_cast<float>(numBins));
+        const __m128 vMaxBin = _mm_set1_ps(maxBin);
+        const __m128 vOutOfRange = _mm_set1_ps(outOfRange);
+        for (; i + 4 <= n; i += 4) {
+            __m128 value = _mm_loadu_ps(values + i);
+            __m128 normalizedValue = _mm_div_ps(_mm_sub_ps(value, vMinValue), vRange);
+            __m128 bin = _mm_min_ps(_mm_mul_ps(normalizedValue, vNumBins), vMaxBin);
+            __m128 isInRange = _mm_and_ps(
+                _mm_cmpge_ps(value, vMinValue),
+                _mm_cmple_ps(value, vMaxValue)
+            );
+            bin = _mm_or_ps(
+                _mm_and_ps(isInRange, bin),
+                _mm_andnot_ps(isInRange, vOutOfRange)
+            );
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(bins + i),
+                _mm_cvttps_epi32(bin)
+            );
+        }
+#endif // OPENSPACE_HISTOGRAM_SSE2
+        for (; i < n; ++i) {
+            float normalizedValue = (values[i] - minValue) / range;
+            float bin = std::min(normalizedValue * numBins, maxBin);
+            bool isInRange = values[i] >= minValue && values[i] <= maxValue;
+            bins[i] = static_cast<int32_t>(isInRange ? bin : outOfRange);
+        }
+    }
+
+    // Counts the values into counts, which holds NumCounters copies of numBins + 1 bins.
+    // The last bin of each copy collects the values that are out of range
+    void countValues(const float* values, size_t nValues, float minValue, float maxValue,
+                     int numBins, std::vector<uint32_t>& counts)
+    {
+        const size_t stride = numBins + 1;
+        uint32_t* c = counts.data();
+
+        int32_t bins[BlockSize];
+        for (size_t b = 0; b < nValues; b += BlockSize) {
+            const size_t n = std::min(BlockSize, nValues - b);
+            computeBins(values + b, n, minValue, maxValue, numBins, bins);
+
+            size_t i = 0;
+            for (; i + NumCounters <= n; i += NumCounters) {
+                ++c[bins[i]];
+                ++c[stride + bins[i + 1]];
+                ++c[2 * stride + bins[i + 2]];
+                ++c[3 * stride + bins[i + 3]];
+            }
+            for (; i < n; ++i) {
+                ++c[bins[i]];
+            }
+        }
+    }
 }
 
 namespace openspace {
@@ -39,14 +131,18 @@ Histogram::Histogram()
     , _maxValue(0)
     , _numBins(-1)
     , _numValues(0)
-    , _data(nullptr) {}
+    , _data(nullptr)
+    , _hasEntropy(false)
+    , _entropy(0.f) {}
 
 Histogram::Histogram(float minValue, float maxValue, int numBins)
     : _minValue(minValue)
     , _maxValue(maxValue)
     , _numBins(numBins)
     , _numValues(0)
-    , _data(nullptr) {
+    , _data(nullptr)
+    , _hasEntropy(false)
+    , _entropy(0.f) {
 
     _data = new float[numBins];
     for (int i = 0; i < numBins; ++i) {
@@ -59,7 +155,9 @@ Histogram::Histogram(float minValue, float maxValue, int numBins, float *data)
     , _maxValue(maxValue)
     , _numBins(numBins)
     , _numValues(0)
-    , _data(data) {}
+    , _data(data)
+    , _hasEntropy(false)
+    , _entropy(0.f) {}
 
 Histogram::Histogram(Histogram&& other) {
     _minValue = other._minValue;
@@ -67,16 +165,30 @@ Histogram::Histogram(Histogram&& other) {
     _numBins = other._numBins;
     _numValues = other._numValues;
     _data = other._data;
+    _equalizer = std::move(other._equalizer);
+    _prefixSums = std::move(other._prefixSums);
+    _hasEntropy = other._hasEntropy;
+    _entropy = other._entropy;
     other._data = nullptr;
+    other.invalidateCaches();
 }
 
 Histogram& Histogram::operator=(Histogram&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    delete[] _data;
     _minValue = other._minValue;
     _maxValue = other._maxValue;
     _numBins = other._numBins;
     _numValues = other._numValues;
     _data = other._data;
+    _equalizer = std::move(other._equalizer);
+    _prefixSums = std::move(other._prefixSums);
+    _hasEntropy = other._hasEntropy;
+    _entropy = other._entropy;
     other._data = nullptr;
+    other.invalidateCaches();
     return *this;
 }
 
@@ -116,10 +228,55 @@ bool Histogram::add(float value, float repeat) {
 
     _data[binIndex] += repeat;
     _numValues += repeat;
+    invalidateCaches();
 
     return true;
 }
 
+size_t Histogram::add(const float* values, size_t nValues, unsigned int nThreads) {
+    // With an empty range, the normalized values and thus the bins would be undefined
+    if (!isValid() || !(_maxValue > _minValue)) {
+        return 0;
+    }
+
+    const size_t stride = _numBins + 1;
+    const size_t nTasks = (nValues + ValuesPerTask - 1) / ValuesPerTask;
+    std::vector<std::vector<uint32_t>> counts(nTasks);
+
+    TaskGraph tasks;
+    for (size_t t = 0; t < nTasks; ++t) {
+        tasks.addTask([&, t]() {
+            counts[t].resize(NumCounters * stride, 0);
+            size_t begin = t * ValuesPerTask;
+            size_t n = std::min(ValuesPerTask, nValues - begin);
+            countValues(values + begin, n, _minValue, _maxValue, _numBins, counts[t]);
+        });
+    }
+    tasks.run(nThreads);
+
+    // Merge the histograms of all tasks and interleaved copies
+    std::vector<uint64_t> total(stride, 0);
+    for (const std::vector<uint32_t>& c : counts) {
+        for (size_t i = 0; i < c.size(); ++i) {
+            total[i % stride] += c[i];
+        }
+    }
+
+    size_t nAdded = 0;
+    for (int i = 0; i < _numBins; ++i) {
+        _data[i] += static_cast<float>(total[i]);
+        nAdded += total[i];
+    }
+    _numValues += static_cast<int64_t>(nAdded);
+    invalidateCaches();
+
+    return nAdded;
+}
+
+size_t Histogram::add(const std::vector<float>& values, unsigned int nThreads) {
+    return add(values.data(), values.size(), nThreads);
+}
+
 void Histogram::changeRange(float minValue, float maxValue){\
     if(minValue > _minValue && maxValue < _maxValue) return;
 
@@ -141,7 +298,7 @@ void Histogram::changeRange(float minValue, float maxValue){\
 
     _minValue = minValue;
     _maxValue = maxValue;
-
+    invalidateCaches();
 }
 
 bool Histogram::add(const Histogram& histogram) {
@@ -154,6 +311,7 @@ bool Histogram::add(const Histogram& histogram) {
 
         }
         _numValues += histogram._numValues;
+        invalidateCaches();
         return true;
     } else {
         LERROR("Dimension mismatch");
@@ -192,6 +350,7 @@ bool Histogram::addRectangle(float lowBin, float highBin, float value) {
         float diff = -highBinIndex + fillHigh;
         _data[fillHigh - 1] -= diff * value;
     }
+    invalidateCaches();
 
     return true;
 }
@@ -236,6 +395,7 @@ void Histogram::normalize() {
     for (int i = 0; i < _numBins; i++) {
         _data[i] /= sum;
     }
+    invalidateCaches();
 }
 
 /*
@@ -244,15 +404,15 @@ void Histogram::normalize() {
  * value will be the value at the index.
  */
 void Histogram::generateEqualizer(){
-    float previousCdf = 0.0f;
+    const std::vector<double>& sums = prefixSums();
+    const double total = sums.empty() ? 0.0 : sums.back();
     _equalizer = std::vector<float>(_numBins, 0.0f);
+    if (total <= 0.0) {
+        return;
+    }
     for(int i = 0; i < _numBins; i++){
-        
-        float probability = _data[i] / (float)_numValues; 
-        float cdf  = previousCdf + probability;
-        cdf = std::min(1.0f, cdf);
+        float cdf = std::min(1.0f, static_cast<float>(sums[i] / total));
         _equalizer[i] = cdf * (_numBins-1);
-        previousCdf = cdf;
     }
 }
 
@@ -287,12 +447,22 @@ float Histogram::equalize(float value){
 }
 
 float Histogram::entropy(){
-    float entropy;
+    if (_hasEntropy) {
+        return _entropy;
+    }
+
+    const std::vector<double>& sums = prefixSums();
+    const double total = sums.empty() ? 0.0 : sums.back();
+    double entropy = 0.0;
     for(int i = 0; i < _numBins; i++){
-        if(_data[i] != 0)
-            entropy -= ((float)_data[i]/_numValues) * log2((float)_data[i]/_numValues);
+        if (_data[i] > 0 && total > 0.0) {
+            double probability = _data[i] / total;
+            entropy -= probability * std::log2(probability);
+        }
     }
-    return entropy;
+    _entropy = static_cast<float>(entropy);
+    _hasEntropy = true;
+    return _entropy;
 }
 
 void Histogram::print() const {
@@ -351,4 +521,21 @@ float Histogram::binWidth(){
     return (_maxValue-_minValue)/_numBins;
 }
 
+const std::vector<double>& Histogram::prefixSums() {
+    if (_prefixSums.empty() && _numBins > 0) {
+        _prefixSums.resize(_numBins);
+        double sum = 0.0;
+        for (int i = 0; i < _numBins; ++i) {
+            sum += _data[i];
+            _prefixSums[i] = sum;
+        }
+    }
+    return _prefixSums;
+}
+
+void Histogram::invalidateCaches() {
+    _prefixSums.clear();
+    _hasEntropy = false;
+}
+
 }
@@ -0,0 +1,147 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/mappedfile.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace openspace {
+
+#ifdef WIN32
+
+MappedFile::MappedFile(const std::string& filename)
+    : _data(nullptr)
+    , _size(0)
+    , _fileHandle(INVALID_HANDLE_VALUE)
+    , _mappingHandle(nullptr)
+{
+    _fileHandle = CreateFileA(
+        filename.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (_fileHandle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_fileHandle, &size) || size.QuadPart == 0) {
+        return;
+    }
+    _mappingHandle = CreateFileMappingA(
+        _fileHandle,
+        nullptr,
+        PAGE_READONLY,
+        0,
+        0,
+        nullptr
+    );
+    if (!_mappingHandle) {
+        return;
+    }
+    _data = reinterpret_cast<const char*>(
+        MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0)
+    );
+    if (_data) {
+        _size = static_cast<size_t>(size.QuadPart);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (_data) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mappingHandle) {
+        CloseHandle(_mappingHandle);
+    }
+    if (_fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(_fileHandle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename)
+    : _data(nullptr)
+    , _size(0)
+    , _fileDescriptor(-1)
+{
+    _fileDescriptor = open(filename.c_str(), O_RDONLY);
+    if (_fileDescriptor == -1) {
+        return;
+    }
+
+    struct stat status;
+    if (fstat(_fileDescriptor, &status) != 0 || status.st_size == 0) {
+        return;
+    }
+    void* data = mmap(
+        nullptr,
+        static_cast<size_t>(status.st_size),
+        PROT_READ,
+        MAP_PRIVATE,
+        _fileDescriptor,
+        0
+    );
+    if (data != MAP_FAILED) {
+        _data = reinterpret_cast<const char*>(data);
+        _size = static_cast<size_t>(status.st_size);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (_data) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+    if (_fileDescriptor != -1) {
+        close(_fileDescriptor);
+    }
+}
+
+#endif // WIN32
+
+bool MappedFile::isValid() const {
+    return _data != nullptr;
+}
+
+const char* MappedFile::data() const {
+    return _data;
+}
+
+size_t MappedFile::size() const {
+    return _size;
+}
+
+} // namespace openspace
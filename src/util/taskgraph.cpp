@@ -0,0 +1,136 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/taskgraph.h>
+
+#include <ghoul/misc/assert.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace openspace {
+
+TaskGraph::TaskId TaskGraph::addTask(std::function<void()> task,
+                                     std::vector<TaskId> dependencies)
+{
+    const TaskId id = _tasks.size();
+
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(
+        std::unique(dependencies.begin(), dependencies.end()),
+        dependencies.end()
+    );
+    for (TaskId dependency : dependencies) {
+        ghoul_assert(dependency < id, "Tasks can only depend on earlier tasks");
+        _tasks[dependency].dependents.push_back(id);
+    }
+
+    _tasks.push_back({ std::move(task), dependencies.size(), {} });
+    return id;
+}
+
+void TaskGraph::run(unsigned int nThreads) {
+    if (nThreads == 0) {
+        nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<TaskId> ready;
+    std::vector<size_t> nRemaining(_tasks.size());
+    size_t nFinished = 0;
+    std::exception_ptr exception;
+
+    for (TaskId id = 0; id < _tasks.size(); ++id) {
+        nRemaining[id] = _tasks[id].nDependencies;
+        if (nRemaining[id] == 0) {
+            ready.push_back(id);
+        }
+    }
+
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [&]() {
+                return !ready.empty() || nFinished == _tasks.size();
+            });
+            if (ready.empty()) {
+                return;
+            }
+            TaskId id = ready.front();
+            ready.pop_front();
+
+            lock.unlock();
+            try {
+                _tasks[id].function();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> exceptionLock(mutex);
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+            }
+            lock.lock();
+
+            ++nFinished;
+            size_t nReady = 0;
+            for (TaskId dependent : _tasks[id].dependents) {
+                if (--nRemaining[dependent] == 0) {
+                    ready.push_back(dependent);
+                    ++nReady;
+                }
+            }
+            if (nFinished == _tasks.size() || nReady > 1) {
+                condition.notify_all();
+            }
+            else if (nReady == 1) {
+                condition.notify_one();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const size_t nWorkers = std::min<size_t>(nThreads, std::max<size_t>(_tasks.size(), 1));
+    for (size_t i = 1; i < nWorkers; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+size_t TaskGraph::size() const {
+    return _tasks.size();
+}
+
+} // namespace openspace
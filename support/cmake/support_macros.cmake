@@ -321,6 +321,28 @@ function (handle_option_tests)
         set_property(TARGET OpenSpaceTest PROPERTY FOLDER "Unit Tests")
         set_property(TARGET OpenSpaceTest PROPERTY CXX_STANDARD 14)
         set_property(TARGET OpenSpaceTest PROPERTY CXX_STANDARD_REQUIRED On)
+
+        if (OPENSPACE_HAVE_BENCHMARKS)
+            # The benchmarks live next to the unit tests but are only compiled into
+            # this executable, which runs nothing else
+            add_executable(OpenSpaceBenchmark ${OPENSPACE_BASE_DIR}/tests/main.cpp ${OPENSPACE_TEST_FILES})
+            target_include_directories(OpenSpaceBenchmark PUBLIC
+                "${OPENSPACE_BASE_DIR}/include"
+                "${OPENSPACE_BASE_DIR}/tests"
+                "${OPENSPACE_EXT_DIR}/ghoul/ext/googletest/googletest/include"
+            )
+            target_compile_definitions(OpenSpaceBenchmark PRIVATE "OPENSPACE_BENCHMARKS")
+            target_link_libraries(OpenSpaceBenchmark gtest libOpenSpace)
+
+            if (MSVC)
+                set_target_properties(OpenSpaceBenchmark PROPERTIES LINK_FLAGS
+                    "/NODEFAULTLIB:LIBCMTD.lib /NODEFAULTLIB:LIBCMT.lib"
+                )
+            endif ()
+            set_property(TARGET OpenSpaceBenchmark PROPERTY FOLDER "Unit Tests")
+            set_property(TARGET OpenSpaceBenchmark PROPERTY CXX_STANDARD 14)
+            set_property(TARGET OpenSpaceBenchmark PROPERTY CXX_STANDARD_REQUIRED On)
+        endif ()
     endif (OPENSPACE_HAVE_TESTS)
     if (TARGET GhoulTest)
         if (NOT TARGET gtest)
@@ -42,16 +42,52 @@
 #include <test_convexhull.inl>
 
 #include <test_angle.inl>
+#include <test_ellipsoid.inl>
 //#include <test_latlonpatch.inl>
 #include <test_gdalwms.inl>
 //#include <test_patchcoverageprovider.inl>
 
 #include <test_concurrentqueue.inl>
 #include <test_concurrentjobmanager.inl>
+#include <test_heighttile.inl>
+#include <test_chunkdrawcommandlist.inl>
+#include <test_tiletextureresidency.inl>
+#include <test_tiletexturepool.inl>
+#include <test_tilereadplanner.inl>
+#include <test_tiledataset.inl>
+#ifdef OPENSPACE_BENCHMARKS
+#include <test_tilepipeline.inl>
+#endif
+#include <test_tileprocessor.inl>
+#include <test_statscollector.inl>
 #endif
 
 #include <test_luaconversions.inl>
 #include <test_powerscalecoordinates.inl>
+#include <test_propertyindex.inl>
+#include <test_messagequeue.inl>
+#include <test_keyframebuffer.inl>
+#include <test_scriptscheduler.inl>
+#include <test_telemetry.inl>
+#include <test_taskgraph.inl>
+#include <test_histogram.inl>
+
+#ifdef OPENSPACE_MODULE_BASE_ENABLED
+#include <test_geometryregistry.inl>
+#endif
+
+#ifdef OPENSPACE_MODULE_MULTIRESVOLUME_ENABLED
+#include <test_brickcodec.inl>
+#include <test_brickselection.inl>
+#include <test_brickstreamer.inl>
+#include <test_tsperrors.inl>
+#endif
+
+#ifdef OPENSPACE_MODULE_NEWHORIZONS_ENABLED
+#include <test_captureindex.inl>
+#include <test_projectionimageloader.inl>
+#include <test_sequenceparser.inl>
+#endif
 
 #ifdef OPENSPACE_MODULE_ISWA_ENABLED
 #include <test_screenspaceimage.inl>
@@ -82,6 +118,12 @@ int main(int argc, char** argv) {
     std::vector<std::string> args;
     openspace::OpenSpaceEngine::create(argc, argv, std::make_unique<openspace::WindowWrapper>(), args);
 
+#ifdef OPENSPACE_BENCHMARKS
+    // Tests whose name ends in Benchmark are only compiled into the benchmark executable,
+    // which runs just those unless a filter is passed on the command line
+    testing::GTEST_FLAG(filter) = "*Benchmark";
+#endif
+
     testing::InitGoogleTest(&argc, argv);
 
 #ifdef PRINT_OUTPUT
@@ -0,0 +1,359 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/multiresvolume/rendering/brickcodec.h>
+#include <modules/multiresvolume/rendering/brickstreamer.h>
+#include <modules/multiresvolume/rendering/compressedtsp.h>
+#include <modules/multiresvolume/rendering/tsp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+
+using namespace openspace;
+
+class BrickCodecTest : public testing::Test {
+protected:
+    // Quantization step error plus half an ulp of the largest magnitude in the brick
+    double quantizationBound(float minValue, float maxValue) {
+        float largest = std::max(std::abs(minValue), std::abs(maxValue));
+        double ulp = std::nextafter(largest, std::numeric_limits<float>::max()) - largest;
+        return (double(maxValue) - minValue) / 131070.0 * (1.0 + 1e-9) + 0.5 * ulp;
+    }
+
+    // A smooth field with some noise, which resembles simulation output more closely
+    // than random values
+    std::vector<float> smoothBrick(unsigned int dim, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<float> noise(0.f, 1e-3f);
+        std::vector<float> values;
+        values.reserve(dim * dim * dim);
+        for (unsigned int z = 0; z < dim; ++z) {
+            for (unsigned int y = 0; y < dim; ++y) {
+                for (unsigned int x = 0; x < dim; ++x) {
+                    float v = std::sin(0.2f * x + seed) * std::cos(0.15f * y) +
+                        0.05f * z + noise(gen);
+                    values.push_back(v);
+                }
+            }
+        }
+        return values;
+    }
+
+    // Writes a TSP file with smooth brick values and returns the number of bricks
+    size_t createTsp(const std::string& filename, unsigned int nTimesteps,
+                     unsigned int nBricksPerAxis, unsigned int brickDim)
+    {
+        TSP::Header header = {
+            0, nTimesteps, nTimesteps,
+            brickDim, brickDim, brickDim,
+            nBricksPerAxis, nBricksPerAxis, nBricksPerAxis
+        };
+
+        unsigned int nOtNodes = 1;
+        for (unsigned int n = 1; n < nBricksPerAxis * nBricksPerAxis * nBricksPerAxis;) {
+            n *= 8;
+            nOtNodes += n;
+        }
+        size_t nBricks = static_cast<size_t>(nOtNodes) * (2 * nTimesteps - 1);
+
+        std::ofstream file(filename, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (size_t b = 0; b < nBricks; ++b) {
+            std::vector<float> values = smoothBrick(brickDim + 2, static_cast<int>(b));
+            file.write(
+                reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(float)
+            );
+        }
+        return nBricks;
+    }
+};
+
+TEST_F(BrickCodecTest, CompressRoundTrip) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    std::vector<std::vector<uint8_t>> inputs;
+    inputs.push_back({});
+    inputs.push_back({ 7 });
+    inputs.push_back(std::vector<uint8_t>(100000, 0));
+    std::vector<uint8_t> random(70000);
+    for (uint8_t& b : random) {
+        b = static_cast<uint8_t>(byte(gen));
+    }
+    inputs.push_back(random);
+    // Repetitions further apart than the maximum offset
+    std::vector<uint8_t> repeated;
+    for (int i = 0; i < 5; ++i) {
+        repeated.insert(repeated.end(), random.begin(), random.end());
+    }
+    inputs.push_back(repeated);
+
+    for (const std::vector<uint8_t>& input : inputs) {
+        std::vector<uint8_t> compressed;
+        brickcodec::compress(input.data(), input.size(), compressed);
+        std::vector<uint8_t> output(input.size());
+        ASSERT_TRUE(brickcodec::decompress(
+            compressed.data(), compressed.size(), output.data(), output.size()
+        )) << "Input size " << input.size();
+        EXPECT_EQ(input, output);
+    }
+}
+
+TEST_F(BrickCodecTest, RejectsCorruptData) {
+    std::vector<float> values = smoothBrick(8, 1);
+    std::vector<uint8_t> encoded;
+    brickcodec::encode(values.data(), values.size(), brickcodec::Codec::Lossless, encoded);
+
+    std::vector<float> decoded(values.size());
+    for (size_t size = 0; size < encoded.size(); size += 7) {
+        EXPECT_FALSE(
+            brickcodec::decode(encoded.data(), size, decoded.data(), decoded.size())
+        ) << "Truncated to " << size << " bytes";
+    }
+    EXPECT_FALSE(brickcodec::decode(
+        encoded.data(), encoded.size(), decoded.data(), decoded.size() + 1
+    ));
+
+    encoded[0] = 0xFF;
+    EXPECT_FALSE(brickcodec::decode(
+        encoded.data(), encoded.size(), decoded.data(), decoded.size()
+    ));
+}
+
+TEST_F(BrickCodecTest, LosslessIsExact) {
+    std::vector<float> values = smoothBrick(16, 2);
+    values[0] = std::numeric_limits<float>::infinity();
+    values[1] = -0.f;
+    values[2] = std::numeric_limits<float>::denorm_min();
+    values[3] = std::numeric_limits<float>::max();
+
+    std::vector<uint8_t> encoded;
+    brickcodec::encode(values.data(), values.size(), brickcodec::Codec::Lossless, encoded);
+    std::vector<float> decoded(values.size());
+    ASSERT_TRUE(brickcodec::decode(
+        encoded.data(), encoded.size(), decoded.data(), decoded.size()
+    ));
+    EXPECT_EQ(0, std::memcmp(values.data(), decoded.data(), values.size() * 4));
+}
+
+TEST_F(BrickCodecTest, QuantizedErrorIsBounded) {
+    for (unsigned int seed = 0; seed < 10; ++seed) {
+        std::vector<float> values = smoothBrick(16, seed);
+        // A constant brick must be reconstructed exactly
+        if (seed == 0) {
+            std::fill(values.begin(), values.end(), 3.5f);
+        }
+
+        std::vector<uint8_t> encoded;
+        brickcodec::encode(
+            values.data(), values.size(), brickcodec::Codec::Quantized16, encoded
+        );
+        std::vector<float> decoded(values.size());
+        ASSERT_TRUE(brickcodec::decode(
+            encoded.data(), encoded.size(), decoded.data(), decoded.size()
+        ));
+
+        float minValue = *std::min_element(values.begin(), values.end());
+        float maxValue = *std::max_element(values.begin(), values.end());
+        double bound = quantizationBound(minValue, maxValue);
+        for (size_t i = 0; i < values.size(); ++i) {
+            ASSERT_LE(std::abs(double(values[i]) - decoded[i]), bound) << "Value " << i;
+        }
+    }
+}
+
+TEST_F(BrickCodecTest, QuantizedErrorIsBoundedForRandomRanges) {
+    std::mt19937 generator(4711);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    for (int brick = 0; brick < 200; ++brick) {
+        // Ranges that are small compared to the offset are the hardest for the rounding
+        float offset = (unit(generator) - 0.5f) * std::pow(10.f, unit(generator) * 12 - 4);
+        float range = std::pow(10.f, unit(generator) * 12 - 6);
+        std::vector<float> values(512);
+        for (float& v : values) {
+            v = offset + unit(generator) * range;
+        }
+
+        std::vector<uint8_t> encoded;
+        brickcodec::encode(
+            values.data(), values.size(), brickcodec::Codec::Quantized16, encoded
+        );
+        std::vector<float> decoded(values.size());
+        ASSERT_TRUE(brickcodec::decode(
+            encoded.data(), encoded.size(), decoded.data(), decoded.size()
+        ));
+
+        float minValue = *std::min_element(values.begin(), values.end());
+        float maxValue = *std::max_element(values.begin(), values.end());
+        double bound = quantizationBound(minValue, maxValue);
+        for (size_t i = 0; i < values.size(); ++i) {
+            ASSERT_LE(std::abs(double(values[i]) - decoded[i]), bound) <<
+                "Brick " << brick << ", value " << i;
+        }
+    }
+}
+
+TEST_F(BrickCodecTest, CompressedTspMatchesOriginal) {
+    const std::string tspFilename = "brickcodectest.tsp";
+    const std::string filename = "brickcodectest.ctsp";
+    const size_t nBricks = createTsp(tspFilename, 4, 4, 6);
+
+    ASSERT_TRUE(
+        compressedtsp::compress(tspFilename, filename, brickcodec::Codec::Lossless)
+    );
+    EXPECT_TRUE(compressedtsp::isCompressed(filename));
+    EXPECT_FALSE(compressedtsp::isCompressed(tspFilename));
+
+    TSP original(tspFilename);
+    ASSERT_TRUE(original.readHeader());
+    ASSERT_TRUE(original.construct());
+    ASSERT_TRUE(original.calculateErrors());
+
+    TSP compressed(filename);
+    ASSERT_TRUE(compressed.readHeader());
+    EXPECT_TRUE(compressed.isCompressed());
+    ASSERT_EQ(original.numTotalNodes(), compressed.numTotalNodes());
+    ASSERT_EQ(nBricks, compressed.numTotalNodes());
+    ASSERT_TRUE(compressed.construct());
+    ASSERT_TRUE(compressed.calculateErrors());
+    for (unsigned int b = 0; b < original.numTotalNodes(); ++b) {
+        EXPECT_EQ(original.getSpatialError(b), compressed.getSpatialError(b));
+        EXPECT_EQ(original.getTemporalError(b), compressed.getTemporalError(b));
+    }
+
+    const unsigned int nValues = 8 * 8 * 8;
+    BrickStreamer rawStreamer(tspFilename, TSP::dataPosition(), nValues, 1 << 30);
+    BrickStreamer streamer(filename, 0, nValues, 1 << 30);
+    EXPECT_FALSE(rawStreamer.isCompressed());
+    EXPECT_TRUE(streamer.isCompressed());
+
+    std::vector<unsigned int> all(nBricks);
+    for (unsigned int b = 0; b < nBricks; ++b) {
+        all[b] = b;
+    }
+    rawStreamer.request(all);
+    streamer.request(all);
+    rawStreamer.waitUntilIdle();
+    streamer.waitUntilIdle();
+    for (unsigned int b = 0; b < nBricks; ++b) {
+        BrickStreamer::Brick expected = rawStreamer.brick(b);
+        BrickStreamer::Brick actual = streamer.brick(b);
+        ASSERT_TRUE(expected && actual) << "Brick " << b;
+        EXPECT_EQ(*expected, *actual) << "Brick " << b;
+    }
+
+    std::remove(tspFilename.c_str());
+    std::remove(filename.c_str());
+}
+
+TEST_F(BrickCodecTest, CompressedTspSpansSeveralBatches) {
+    const std::string tspFilename = "brickcodectest_batches.tsp";
+    const std::string filename = "brickcodectest_batches.ctsp";
+    // More bricks than fit into the batches that are encoded at the same time, so that
+    // the encoding buffers are reused
+    const size_t nBricks = createTsp(tspFilename, 16, 4, 2);
+    ASSERT_GT(nBricks, 2048u);
+
+    std::vector<float> progress;
+    ASSERT_TRUE(compressedtsp::compress(
+        tspFilename,
+        filename,
+        brickcodec::Codec::Lossless,
+        [&progress](float p) { progress.push_back(p); }
+    ));
+    ASSERT_FALSE(progress.empty());
+    EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+    EXPECT_EQ(1.f, progress.back());
+
+    const unsigned int nValues = 4 * 4 * 4;
+    BrickStreamer rawStreamer(tspFilename, TSP::dataPosition(), nValues, 1 << 30);
+    BrickStreamer streamer(filename, 0, nValues, 1 << 30);
+    std::vector<unsigned int> all(nBricks);
+    for (unsigned int b = 0; b < nBricks; ++b) {
+        all[b] = b;
+    }
+    rawStreamer.request(all);
+    streamer.request(all);
+    rawStreamer.waitUntilIdle();
+    streamer.waitUntilIdle();
+    for (unsigned int b = 0; b < nBricks; ++b) {
+        BrickStreamer::Brick expected = rawStreamer.brick(b);
+        BrickStreamer::Brick actual = streamer.brick(b);
+        ASSERT_TRUE(expected && actual) << "Brick " << b;
+        EXPECT_EQ(*expected, *actual) << "Brick " << b;
+    }
+
+    std::remove(tspFilename.c_str());
+    std::remove(filename.c_str());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(BrickCodecTest, Benchmark) {
+    const unsigned int dim = 34;
+    const unsigned int nBricks = 256;
+    std::vector<std::vector<float>> bricks;
+    for (unsigned int b = 0; b < nBricks; ++b) {
+        bricks.push_back(smoothBrick(dim, b));
+    }
+    const double rawSize = static_cast<double>(nBricks) * dim * dim * dim * sizeof(float);
+
+    for (brickcodec::Codec codec :
+        { brickcodec::Codec::Lossless, brickcodec::Codec::Quantized16 })
+    {
+        std::vector<std::vector<uint8_t>> encoded(nBricks);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (unsigned int b = 0; b < nBricks; ++b) {
+            brickcodec::encode(bricks[b].data(), bricks[b].size(), codec, encoded[b]);
+        }
+        auto encodeEnd = std::chrono::high_resolution_clock::now();
+
+        std::vector<float> decoded(dim * dim * dim);
+        size_t encodedSize = 0;
+        for (unsigned int b = 0; b < nBricks; ++b) {
+            ASSERT_TRUE(brickcodec::decode(
+                encoded[b].data(), encoded[b].size(), decoded.data(), decoded.size()
+            ));
+            encodedSize += encoded[b].size();
+        }
+        auto decodeEnd = std::chrono::high_resolution_clock::now();
+
+        double encodeTime = std::chrono::duration<double>(encodeEnd - start).count();
+        double decodeTime = std::chrono::duration<double>(decodeEnd - encodeEnd).count();
+        std::cout << (codec == brickcodec::Codec::Lossless ? "Lossless" : "Quantized16") <<
+            ": ratio " << rawSize / encodedSize << ", encoding " <<
+            nBricks / encodeTime << " bricks/s, decoding " << nBricks / decodeTime <<
+            " bricks/s (" << dim << "^3 voxels)" << std::endl;
+    }
+}
+#endif // OPENSPACE_BENCHMARKS
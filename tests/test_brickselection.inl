@@ -0,0 +1,273 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/multiresvolume/rendering/budgetbrickselection.h>
+#include <modules/multiresvolume/rendering/tfgradientcache.h>
+#include <modules/multiresvolume/rendering/tsp.h>
+#include <openspace/util/histogram.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+
+using namespace openspace;
+
+class BrickSelectionTest : public testing::Test {
+protected:
+    BrickSelectionTest()
+        : _filename("brickselectiontest.tsp")
+    {
+        // The selection only needs the structure of the tree, so no bricks are written
+        TSP::Header header = {
+            0, NumberTimesteps, NumberTimesteps,
+            16, 16, 16,
+            NumberBricksPerAxis, NumberBricksPerAxis, NumberBricksPerAxis
+        };
+        std::ofstream file(_filename, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.close();
+
+        _tsp = std::make_unique<TSP>(_filename);
+        _tsp->readHeader();
+    }
+
+    ~BrickSelectionTest() {
+        _tsp = nullptr;
+        std::remove(_filename.c_str());
+    }
+
+    // Random split points that decrease towards the leaves, like real errors do
+    void createSplitPoints(unsigned int seed, std::vector<float>& spatial,
+                           std::vector<float>& temporal)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+        const unsigned int nOtNodes = _tsp->numOTNodes();
+        const unsigned int nBricks = _tsp->numTotalNodes();
+        spatial.resize(nBricks);
+        temporal.resize(nBricks);
+        for (unsigned int b = 0; b < nBricks; ++b) {
+            const unsigned int otNode = b % nOtNodes;
+            const unsigned int bstNode = b / nOtNodes;
+            spatial[b] = (8 * otNode + 1 >= nOtNodes) ?
+                -1.f :
+                dist(gen) / (1.f + otNode);
+            temporal[b] = (bstNode >= _tsp->numBSTNodes() / 2) ?
+                -1.f :
+                dist(gen) / (1.f + bstNode);
+        }
+    }
+
+    static const unsigned int NumberTimesteps = 32;
+    static const unsigned int NumberBricksPerAxis = 8;
+
+    std::string _filename;
+    std::unique_ptr<TSP> _tsp;
+};
+
+TEST_F(BrickSelectionTest, HonorsBothBudgets) {
+    std::vector<float> spatial;
+    std::vector<float> temporal;
+    createSplitPoints(1, spatial, temporal);
+
+    const int nCells = NumberBricksPerAxis * NumberBricksPerAxis * NumberBricksPerAxis;
+    for (int memoryBudget : { 1, 8, 64, 200, nCells }) {
+        for (int streamingBudget : { 1, 16, 100, nCells, 4 * nCells }) {
+            BudgetBrickSelection selection(_tsp.get(), memoryBudget, streamingBudget);
+            selection.setSplitPoints(spatial, temporal);
+
+            std::vector<int> bricks;
+            selection.selectBricks(NumberTimesteps / 3, bricks);
+            ASSERT_EQ(nCells, bricks.size());
+
+            std::set<int> selected(bricks.begin(), bricks.end());
+            EXPECT_EQ(selection.nBricksInMemory(), static_cast<int>(selected.size()));
+            EXPECT_LE(selection.nBricksInMemory(), std::max(memoryBudget, 1));
+            EXPECT_LE(
+                selection.nStreamedBricks(),
+                std::max(streamingBudget * static_cast<int>(NumberTimesteps), 1)
+            );
+        }
+    }
+}
+
+TEST_F(BrickSelectionTest, ReusedSelectionMatchesFreshSelection) {
+    std::vector<float> spatial;
+    std::vector<float> temporal;
+    createSplitPoints(2, spatial, temporal);
+
+    BudgetBrickSelection cached(_tsp.get(), 256, 64);
+    cached.setSplitPoints(spatial, temporal);
+
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> timestep(0, NumberTimesteps - 1);
+    int nRecomputed = 0;
+    for (int i = 0; i < 200; ++i) {
+        int t = (i < 100) ? i % NumberTimesteps : timestep(gen);
+
+        std::vector<int> cachedBricks;
+        nRecomputed += cached.selectBricks(t, cachedBricks);
+
+        BudgetBrickSelection fresh(_tsp.get(), 256, 64);
+        fresh.setSplitPoints(spatial, temporal);
+        std::vector<int> freshBricks;
+        fresh.selectBricks(t, freshBricks);
+        ASSERT_EQ(freshBricks, cachedBricks) << "Timestep " << t;
+    }
+    EXPECT_LT(nRecomputed, 200);
+
+    std::vector<int> bricks;
+    EXPECT_FALSE(cached.selectBricks(0, bricks) && cached.selectBricks(0, bricks));
+    cached.setMemoryBudget(128);
+    EXPECT_TRUE(cached.selectBricks(0, bricks));
+    cached.setMemoryBudget(128);
+    EXPECT_FALSE(cached.selectBricks(0, bricks));
+    cached.setSplitPoints(spatial, temporal);
+    EXPECT_TRUE(cached.selectBricks(0, bricks));
+}
+
+TEST_F(BrickSelectionTest, PartialGradientUpdateMatchesFullUpdate) {
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+    std::vector<Histogram> histograms;
+    for (int i = 0; i < 20; ++i) {
+        Histogram histogram(0.f, 1.f, 64);
+        for (int v = 0; v < 1000; ++v) {
+            histogram.add(dist(gen));
+        }
+        histograms.push_back(std::move(histogram));
+    }
+
+    std::vector<glm::vec4> samples(256);
+    for (glm::vec4& s : samples) {
+        s = glm::vec4(dist(gen), dist(gen), dist(gen), dist(gen));
+    }
+
+    TfGradientCache cache;
+    EXPECT_EQ(TfGradientCache::Update::Full, cache.update(samples));
+    std::vector<float> errors;
+    for (const Histogram& h : histograms) {
+        errors.push_back(cache.error(h));
+    }
+    EXPECT_EQ(TfGradientCache::Update::None, cache.update(samples));
+
+    for (int edit = 0; edit < 10; ++edit) {
+        // Local edit of the transfer function
+        size_t first = (edit * 23) % 200;
+        for (size_t i = first; i < first + 10; ++i) {
+            samples[i] = glm::vec4(dist(gen), dist(gen), dist(gen), dist(gen));
+        }
+        ASSERT_EQ(TfGradientCache::Update::Partial, cache.update(samples));
+        EXPECT_LE(cache.nChangedBins(), 11);
+
+        TfGradientCache reference;
+        reference.update(samples);
+        for (size_t h = 0; h < histograms.size(); ++h) {
+            errors[h] += cache.errorChange(histograms[h]);
+            EXPECT_NEAR(reference.error(histograms[h]), errors[h], 1e-2f);
+        }
+    }
+
+    // A change of most of the transfer function requires a full update
+    for (glm::vec4& s : samples) {
+        s = glm::vec4(dist(gen), dist(gen), dist(gen), dist(gen));
+    }
+    EXPECT_EQ(TfGradientCache::Update::Full, cache.update(samples));
+}
+
+TEST_F(BrickSelectionTest, UnchangedUpdatesDoNotPostponeFullUpdate) {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+    std::vector<glm::vec4> samples(256);
+    for (glm::vec4& s : samples) {
+        s = glm::vec4(dist(gen), dist(gen), dist(gen), dist(gen));
+    }
+
+    TfGradientCache cache;
+    EXPECT_EQ(TfGradientCache::Update::Full, cache.update(samples));
+
+    // Frames without changes between the local edits must not reset the count of
+    // partial updates, or the accumulated drift would never be cleared
+    int nPartial = 0;
+    TfGradientCache::Update result = TfGradientCache::Update::Partial;
+    while (result == TfGradientCache::Update::Partial && nPartial < 100) {
+        samples[nPartial % 200] = glm::vec4(dist(gen), dist(gen), dist(gen), dist(gen));
+        result = cache.update(samples);
+        if (result == TfGradientCache::Update::Partial) {
+            ++nPartial;
+        }
+        EXPECT_EQ(TfGradientCache::Update::None, cache.update(samples));
+    }
+    EXPECT_EQ(TfGradientCache::Update::Full, result);
+    EXPECT_LT(nPartial, 100);
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(BrickSelectionTest, Benchmark) {
+    std::vector<float> spatial;
+    std::vector<float> temporal;
+    createSplitPoints(5, spatial, temporal);
+
+    BudgetBrickSelection selection(_tsp.get(), 400, 64);
+    selection.setSplitPoints(spatial, temporal);
+    std::vector<int> bricks;
+
+    const int nFrames = 20 * NumberTimesteps;
+    using Clock = std::chrono::high_resolution_clock;
+
+    // Rebuilding the selection every frame, as before; alternating the budget forces it
+    Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < nFrames; ++frame) {
+        selection.setMemoryBudget((frame % 2) ? 400 : 401);
+        selection.selectBricks(frame % NumberTimesteps, bricks);
+    }
+    double rebuildTime = std::chrono::duration<double, std::milli>(
+        Clock::now() - start
+    ).count();
+
+    // Several frames per timestep while playing back
+    selection.setMemoryBudget(400);
+    start = Clock::now();
+    int nRecomputed = 0;
+    for (int frame = 0; frame < nFrames; ++frame) {
+        nRecomputed += selection.selectBricks((frame / 4) % NumberTimesteps, bricks);
+    }
+    double incrementalTime = std::chrono::duration<double, std::milli>(
+        Clock::now() - start
+    ).count();
+
+    std::cout << "Brick selection over " << _tsp->numTotalNodes() << " bricks: " <<
+        rebuildTime / nFrames << " ms per rebuilt selection, " <<
+        incrementalTime / nFrames << " ms per frame with reuse (" << nRecomputed <<
+        " of " << nFrames << " frames recomputed)" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
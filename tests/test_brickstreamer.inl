@@ -0,0 +1,231 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/multiresvolume/rendering/brickstreamer.h>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+class BrickStreamerTest : public testing::Test {
+protected:
+    // Writes a file with a header followed by bricks whose values encode their index
+    BrickStreamerTest()
+        : filename("brickstreamertest.tsp")
+    {
+        std::ofstream file(filename, std::ios::binary);
+        std::vector<char> header(HeaderSize, 0);
+        file.write(header.data(), header.size());
+        for (unsigned int b = 0; b < NumberBricks; ++b) {
+            std::vector<float> values(BrickValues);
+            for (unsigned int v = 0; v < BrickValues; ++v) {
+                values[v] = static_cast<float>(b * BrickValues + v);
+            }
+            file.write(
+                reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(float)
+            );
+        }
+    }
+
+    ~BrickStreamerTest() {
+        std::remove(filename.c_str());
+    }
+
+    bool hasCorrectValues(const openspace::BrickStreamer::Brick& brick, unsigned int b) {
+        if (!brick || brick->size() != BrickValues) {
+            return false;
+        }
+        for (unsigned int v = 0; v < BrickValues; ++v) {
+            if ((*brick)[v] != static_cast<float>(b * BrickValues + v)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static const unsigned int HeaderSize = 36;
+    static const unsigned int NumberBricks = 256;
+    static const unsigned int BrickValues = 1000;
+    std::string filename;
+};
+
+TEST_F(BrickStreamerTest, CoalescedRequests) {
+    openspace::BrickStreamer streamer(
+        filename,
+        HeaderSize,
+        BrickValues,
+        NumberBricks * BrickValues * sizeof(float)
+    );
+
+    std::vector<unsigned int> bricks = { 3, 4, 5, 6, 10, 11, 200 };
+    streamer.request(bricks);
+    streamer.waitUntilIdle();
+
+    for (unsigned int b : bricks) {
+        EXPECT_TRUE(hasCorrectValues(streamer.brick(b), b)) << "Brick " << b;
+    }
+    EXPECT_EQ(nullptr, streamer.brick(7));
+    // Three runs of consecutive bricks
+    EXPECT_EQ(3, streamer.popNumDiskReads());
+    EXPECT_EQ(bricks.size(), streamer.popNumLoadedBricks());
+
+    // Cached bricks are not read again
+    streamer.request(bricks);
+    streamer.waitUntilIdle();
+    EXPECT_EQ(0, streamer.popNumDiskReads());
+}
+
+TEST_F(BrickStreamerTest, CacheBudget) {
+    const size_t brickSize = BrickValues * sizeof(float);
+    openspace::BrickStreamer streamer(filename, HeaderSize, BrickValues, 4 * brickSize);
+
+    streamer.request({ 0, 1, 2, 3 });
+    streamer.waitUntilIdle();
+    EXPECT_EQ(4 * brickSize, streamer.cacheSize());
+
+    // Using brick 0 makes brick 1 the least recently used one
+    EXPECT_TRUE(hasCorrectValues(streamer.brick(0), 0));
+    streamer.request({ 100 });
+    streamer.waitUntilIdle();
+    EXPECT_EQ(4 * brickSize, streamer.cacheSize());
+    EXPECT_EQ(nullptr, streamer.brick(1));
+    EXPECT_TRUE(hasCorrectValues(streamer.brick(0), 0));
+    EXPECT_TRUE(hasCorrectValues(streamer.brick(100), 100));
+
+    streamer.setCacheBudget(brickSize);
+    EXPECT_EQ(brickSize, streamer.cacheSize());
+}
+
+TEST_F(BrickStreamerTest, WaitForRequestedBricks) {
+    openspace::BrickStreamer streamer(
+        filename,
+        HeaderSize,
+        BrickValues,
+        NumberBricks * BrickValues * sizeof(float),
+        1
+    );
+
+    std::vector<unsigned int> prefetched;
+    for (unsigned int b = 100; b < NumberBricks; b += 2) {
+        prefetched.push_back(b);
+    }
+    streamer.prefetch(prefetched);
+    std::vector<unsigned int> requested = { 7, 8, 9 };
+    streamer.request(requested);
+    streamer.waitFor(requested);
+
+    for (unsigned int b : requested) {
+        EXPECT_TRUE(hasCorrectValues(streamer.brick(b), b)) << "Brick " << b;
+    }
+    streamer.waitUntilIdle();
+}
+
+TEST_F(BrickStreamerTest, PrefetchIsReplaced) {
+    openspace::BrickStreamer streamer(
+        filename,
+        HeaderSize,
+        BrickValues,
+        NumberBricks * BrickValues * sizeof(float),
+        1
+    );
+
+    // Prefetches are dropped if they are replaced before they could be started, but the
+    // bricks of the last prefetch are loaded eventually
+    for (unsigned int i = 0; i < 10; ++i) {
+        streamer.prefetch({ i * 20, i * 20 + 1 });
+    }
+    streamer.waitUntilIdle();
+    EXPECT_TRUE(hasCorrectValues(streamer.brick(180), 180));
+    EXPECT_TRUE(hasCorrectValues(streamer.brick(181), 181));
+}
+
+TEST_F(BrickStreamerTest, RequestAllBricks) {
+    openspace::BrickStreamer streamer(
+        filename,
+        HeaderSize,
+        BrickValues,
+        NumberBricks * BrickValues * sizeof(float)
+    );
+
+    std::vector<unsigned int> all(NumberBricks);
+    for (unsigned int b = 0; b < NumberBricks; ++b) {
+        all[b] = b;
+    }
+
+    streamer.request(all);
+    streamer.waitUntilIdle();
+    for (unsigned int b = 0; b < NumberBricks; ++b) {
+        ASSERT_TRUE(hasCorrectValues(streamer.brick(b), b));
+    }
+    // Consecutive bricks are coalesced into runs
+    EXPECT_LT(streamer.popNumDiskReads(), all.size());
+}
+
+TEST_F(BrickStreamerTest, FailedBricksAreNotReadAgain) {
+    openspace::BrickStreamer streamer(
+        filename,
+        HeaderSize,
+        BrickValues,
+        NumberBricks * BrickValues * sizeof(float),
+        1
+    );
+
+    // The run reaches past the end of the file, only its first brick can be read
+    std::vector<unsigned int> bricks = {
+        NumberBricks - 1, NumberBricks, NumberBricks + 1
+    };
+    streamer.request(bricks);
+    streamer.waitUntilIdle();
+    EXPECT_EQ(1, streamer.popNumDiskReads());
+    EXPECT_TRUE(hasCorrectValues(streamer.brick(NumberBricks - 1), NumberBricks - 1));
+    EXPECT_FALSE(streamer.hasFailed(NumberBricks - 1));
+    EXPECT_TRUE(streamer.hasFailed(NumberBricks));
+    EXPECT_TRUE(streamer.hasFailed(NumberBricks + 1));
+    EXPECT_FALSE(streamer.hasFailed());
+
+    streamer.request(bricks);
+    streamer.waitUntilIdle();
+    EXPECT_EQ(0, streamer.popNumDiskReads());
+}
+
+TEST_F(BrickStreamerTest, MissingFileFails) {
+    openspace::BrickStreamer streamer(
+        "brickstreamertest_missing.tsp",
+        HeaderSize,
+        BrickValues,
+        NumberBricks * BrickValues * sizeof(float)
+    );
+
+    streamer.request({ 0, 1, 2 });
+    streamer.waitUntilIdle();
+    EXPECT_TRUE(streamer.hasFailed());
+    EXPECT_EQ(nullptr, streamer.brick(0));
+
+    // Requests after the failure are ignored instead of waiting forever
+    streamer.request({ 3 });
+    EXPECT_TRUE(streamer.isIdle());
+}
@@ -0,0 +1,192 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/newhorizons/util/captureindex.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+class CaptureIndexTest : public testing::Test {
+protected:
+    static openspace::Image image(double start, const std::string& instrument,
+                                  bool isPlaceholder = false)
+    {
+        openspace::Image i;
+        i.timeRange = openspace::TimeRange(start, start + 0.5);
+        i.path = instrument + "_" + std::to_string(static_cast<int>(start)) + ".png";
+        i.activeInstruments = { instrument };
+        i.isPlaceholder = isPlaceholder;
+        return i;
+    }
+
+    static std::vector<double> startTimes(openspace::CaptureIndex::Range range) {
+        std::vector<double> result;
+        for (const openspace::CaptureIndex::Capture& c : range) {
+            result.push_back(c.start);
+        }
+        return result;
+    }
+};
+
+TEST_F(CaptureIndexTest, RangeQueries) {
+    using openspace::CaptureIndex;
+
+    std::map<std::string, openspace::ImageSubset> subsets;
+    subsets["PLUTO"]._subset = {
+        image(30.0, "LORRI"), image(10.0, "LORRI"), image(20.0, "RALPH"),
+        image(40.0, "LORRI"), image(20.0, "LORRI")
+    };
+    subsets["CHARON"]._subset = { image(15.0, "LORRI") };
+
+    CaptureIndex index;
+    ASSERT_TRUE(index.set(CaptureIndex::compile(subsets)));
+    EXPECT_EQ(3, index.nStreams());
+    EXPECT_EQ(6, index.nCaptures());
+
+    EXPECT_EQ(
+        std::vector<double>({ 10.0, 20.0, 30.0, 40.0 }),
+        startTimes(index.captures("PLUTO", "LORRI"))
+    );
+    EXPECT_EQ(
+        std::vector<double>({ 20.0, 30.0 }),
+        startTimes(index.captures("PLUTO", "LORRI", 15.0, 40.0))
+    );
+    EXPECT_TRUE(index.captures("PLUTO", "LORRI", 40.0, 15.0).empty());
+    EXPECT_EQ(1, index.captures("CHARON", "LORRI", 0.0, 100.0).size());
+    EXPECT_TRUE(index.captures("CHARON", "RALPH").empty());
+    EXPECT_TRUE(index.captures("NIX", "LORRI").empty());
+
+    const CaptureIndex::Capture& c = *index.captures("PLUTO", "RALPH").begin();
+    EXPECT_STREQ("RALPH_20.png", index.path(c));
+    openspace::Image i = index.image(c, "PLUTO", "RALPH");
+    EXPECT_EQ(20.5, i.timeRange.end);
+    EXPECT_EQ("PLUTO", i.target);
+}
+
+TEST_F(CaptureIndexTest, PlaceholdersNextToImagesAreDropped) {
+    using openspace::CaptureIndex;
+
+    std::map<std::string, openspace::ImageSubset> subsets;
+    subsets["PLUTO"]._subset = {
+        image(10.0, "LORRI"), image(10.5, "LORRI", true), image(20.0, "LORRI", true)
+    };
+
+    CaptureIndex index;
+    ASSERT_TRUE(index.set(CaptureIndex::compile(subsets)));
+    CaptureIndex::Range range = index.captures("PLUTO", "LORRI");
+    ASSERT_EQ(2, range.size());
+    EXPECT_EQ(0, range.begin()->isPlaceholder);
+    EXPECT_EQ(1, (range.begin() + 1)->isPlaceholder);
+    EXPECT_EQ(20.0, (range.begin() + 1)->start);
+}
+
+TEST_F(CaptureIndexTest, SaveAndMap) {
+    using openspace::CaptureIndex;
+    const std::string file = "captureindextest.idx";
+
+    std::map<std::string, openspace::ImageSubset> subsets;
+    for (int i = 0; i < 100; ++i) {
+        subsets["PLUTO"]._subset.push_back(image(i, i % 2 ? "LORRI" : "RALPH"));
+    }
+    CaptureIndex index;
+    ASSERT_TRUE(index.set(CaptureIndex::compile(subsets)));
+    ASSERT_TRUE(index.save(file));
+
+    CaptureIndex mapped;
+    ASSERT_TRUE(mapped.load(file));
+    EXPECT_EQ(100, mapped.nCaptures());
+    CaptureIndex::Range range = mapped.captures("PLUTO", "LORRI", 10.0, 20.0);
+    EXPECT_EQ(std::vector<double>({ 11.0, 13.0, 15.0, 17.0, 19.0 }), startTimes(range));
+    EXPECT_STREQ("LORRI_11.png", mapped.path(*range.begin()));
+
+    // A truncated file is rejected
+    {
+        std::ofstream f(file, std::ofstream::binary | std::ofstream::trunc);
+        f.write("CIDX", 4);
+    }
+    CaptureIndex broken;
+    EXPECT_FALSE(broken.load(file));
+    EXPECT_TRUE(broken.isEmpty());
+
+    std::remove(file.c_str());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(CaptureIndexTest, QueryBenchmark) {
+    using openspace::CaptureIndex;
+    using Clock = std::chrono::high_resolution_clock;
+
+    // A mission with 50000 images of four instruments, queried for every frame while
+    // time advances quickly, by 5000 seconds per frame
+    const int nImages = 50000;
+    const int nFrames = 400;
+    const double Step = 5000.0;
+    const std::string instruments[] = { "LORRI", "RALPH", "ALICE", "REX" };
+    std::map<std::string, openspace::ImageSubset> subsets;
+    std::vector<openspace::Image>& images = subsets["PLUTO"]._subset;
+    for (int i = 0; i < nImages; ++i) {
+        images.push_back(image(i * 40.0, instruments[i % 4]));
+    }
+
+    CaptureIndex index;
+    ASSERT_TRUE(index.set(CaptureIndex::compile(subsets)));
+
+    // The previous approach: search all images of the target and copy the matching ones
+    Clock::time_point start = Clock::now();
+    size_t nFound = 0;
+    for (int f = 1; f < nFrames; ++f) {
+        openspace::Image previous, current;
+        previous.timeRange.start = (f - 1) * Step;
+        current.timeRange.start = f * Step;
+        auto compare = [](const openspace::Image& a, const openspace::Image& b) {
+            return a.timeRange.start < b.timeRange.start;
+        };
+        auto prev = std::lower_bound(images.begin(), images.end(), previous, compare);
+        auto curr = std::lower_bound(images.begin(), images.end(), current, compare);
+        std::vector<openspace::Image> captures;
+        std::copy_if(prev, curr, std::back_inserter(captures),
+            [](const openspace::Image& i) { return i.activeInstruments[0] == "LORRI"; });
+        nFound += captures.size();
+    }
+    double copied = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    start = Clock::now();
+    size_t nIndexed = 0;
+    for (int f = 1; f < nFrames; ++f) {
+        nIndexed += index.captures("PLUTO", "LORRI", (f - 1) * Step, f * Step).size();
+    }
+    double indexed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    EXPECT_EQ(nFound, nIndexed);
+    std::cout << "[          ] Capture query: " << copied / nFrames <<
+        " us per frame copying images, " << indexed / nFrames <<
+        " us per frame with the index" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
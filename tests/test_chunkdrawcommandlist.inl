@@ -0,0 +1,167 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/chunk/chunkdrawcommandlist.h>
+
+class ChunkDrawCommandListTest : public testing::Test {
+protected:
+    using Command = openspace::ChunkDrawCommandList::Command;
+
+    // The command list only compares array texture names and chunk addresses, so
+    // slots of array textures that do not exist are enough to test it without an
+    // OpenGL context
+    static std::shared_ptr<openspace::TileTextureSlot> textureSlot(size_t arrayTexture,
+                                                                   size_t layer)
+    {
+        openspace::TileTextureFormat format = {
+            GL_UNSIGNED_BYTE, GL_RGBA8, GL_RGBA, glm::uvec2(8, 8), false
+        };
+        return std::make_shared<openspace::TileTextureSlot>(
+            format, static_cast<GLuint>(arrayTexture), static_cast<int>(layer));
+    }
+
+    static const openspace::Chunk* chunk(size_t i) {
+        static char storage[16];
+        return reinterpret_cast<const openspace::Chunk*>(&storage[i]);
+    }
+
+    // Every chunk samples its own layer of the array textures
+    static Command command(size_t chunkId, int permutation,
+                           std::vector<size_t> textureIds)
+    {
+        Command command;
+        command.chunk = chunk(chunkId);
+        command.permutation = permutation;
+        for (size_t textureId : textureIds) {
+            openspace::TileAndTransform tileAndTransform;
+            tileAndTransform.tile.textureSlot = textureSlot(textureId, chunkId);
+            command.tiles.push_back(tileAndTransform);
+        }
+        return command;
+    }
+};
+
+TEST_F(ChunkDrawCommandListTest, GroupsCommandsByPermutation) {
+    openspace::ChunkDrawCommandList list;
+    list.add(command(0, 1, { 0 }));
+    list.add(command(1, 0, { 0 }));
+    list.add(command(2, 1, { 0 }));
+    list.add(command(3, 0, { 0 }));
+    list.sort();
+
+    ASSERT_EQ(2, list.batches().size());
+    EXPECT_EQ(0, list.batches()[0].permutation);
+    EXPECT_EQ(0, list.batches()[0].begin);
+    EXPECT_EQ(2, list.batches()[0].end);
+    EXPECT_EQ(1, list.batches()[1].permutation);
+    EXPECT_EQ(2, list.batches()[1].begin);
+    EXPECT_EQ(4, list.batches()[1].end);
+
+    // Commands with equal permutation and textures keep the order they were added in
+    const std::vector<Command>& commands = list.commands();
+    EXPECT_EQ(chunk(1), commands[0].chunk);
+    EXPECT_EQ(chunk(3), commands[1].chunk);
+    EXPECT_EQ(chunk(0), commands[2].chunk);
+    EXPECT_EQ(chunk(2), commands[3].chunk);
+}
+
+TEST_F(ChunkDrawCommandListTest, SortingReducesTextureBinds) {
+    openspace::ChunkDrawCommandList list;
+    // Two sets of textures that only differ in the first slot
+    for (size_t i = 0; i < 8; ++i) {
+        list.add(command(i, 0, { i % 2 == 0 ? size_t(0) : size_t(2), 1 }));
+    }
+    EXPECT_EQ(2 + 7, list.numTextureBinds());
+
+    list.sort();
+    EXPECT_EQ(1, list.batches().size());
+    EXPECT_EQ(2 + 1, list.numTextureBinds());
+    EXPECT_EQ(2, list.numDrawCalls());
+}
+
+TEST_F(ChunkDrawCommandListTest, CommandsSamplingSameTexturesShareMultiDraw) {
+    openspace::ChunkDrawCommandList list;
+    list.add(command(0, 0, { 0, 1 }));
+    list.add(command(1, 0, { 2, 1 }));
+    list.add(command(2, 0, { 0, 1 }));
+    list.add(command(3, 1, { 0, 1 }));
+    list.add(command(4, 0, { 0, 1 }));
+    list.sort();
+
+    ASSERT_EQ(2, list.batches().size());
+    const openspace::ChunkDrawCommandList::Batch& batch = list.batches()[0];
+    ASSERT_EQ(2, batch.multiDraws.size());
+    EXPECT_EQ(0, batch.multiDraws[0].begin);
+    EXPECT_EQ(3, batch.multiDraws[0].end);
+    EXPECT_EQ(3, batch.multiDraws[1].begin);
+    EXPECT_EQ(4, batch.multiDraws[1].end);
+
+    // The other permutation is a batch of its own, even with the same textures
+    ASSERT_EQ(1, list.batches()[1].multiDraws.size());
+    EXPECT_EQ(4, list.batches()[1].multiDraws[0].begin);
+    EXPECT_EQ(5, list.batches()[1].multiDraws[0].end);
+    EXPECT_EQ(3, list.numDrawCalls());
+}
+
+TEST_F(ChunkDrawCommandListTest, LayersOfSameArrayTextureShareMultiDraw) {
+    openspace::ChunkDrawCommandList list;
+    for (size_t i = 0; i < 4; ++i) {
+        Command c = command(i, 0, { 0 });
+        c.tiles[0].tile.textureSlot = textureSlot(0, 3 - i);
+        list.add(c);
+    }
+    list.sort();
+
+    ASSERT_EQ(1, list.batches().size());
+    EXPECT_EQ(1, list.numDrawCalls());
+    EXPECT_EQ(1, list.numTextureBinds());
+}
+
+TEST_F(ChunkDrawCommandListTest, TexturesAreReboundForEveryBatch) {
+    openspace::ChunkDrawCommandList list;
+    list.add(command(0, 0, { 0, 1 }));
+    list.add(command(1, 1, { 0, 1 }));
+    list.add(command(2, 0, { 0, 1 }));
+    list.add(command(3, 1, { 0, 1 }));
+    list.sort();
+
+    EXPECT_EQ(2, list.batches().size());
+    EXPECT_EQ(2 * 2, list.numTextureBinds());
+}
+
+TEST_F(ChunkDrawCommandListTest, ClearRemovesCommandsAndBatches) {
+    openspace::ChunkDrawCommandList list;
+    list.add(command(0, 0, { 0 }));
+    list.sort();
+    ASSERT_FALSE(list.empty());
+
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(0, list.size());
+    EXPECT_TRUE(list.batches().empty());
+    EXPECT_EQ(0, list.numTextureBinds());
+    EXPECT_EQ(0, list.numDrawCalls());
+}
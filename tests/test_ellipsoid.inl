@@ -24,22 +24,252 @@
 
 #include "gtest/gtest.h"
 
-#include <modules/globebrowsing/geodetics/ellipsoid.h>
+#include <modules/globebrowsing/geometry/ellipsoid.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
 #include <thread>
+#include <vector>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <glm/glm.hpp>
 
-class EllipsoidTest : public testing::Test {};
-
 using namespace openspace;
 
+class EllipsoidTest : public testing::Test {
+protected:
+	struct Points {
+		std::vector<Scalar> x, y, z;
+		std::vector<Scalar> lat, lon;
+	};
+
+	// Points from below the surface to far above it, and their geodetic coordinates
+	static Points randomPoints(size_t n) {
+		std::mt19937 generator(1337);
+		std::uniform_real_distribution<Scalar> latitude(-M_PI / 2, M_PI / 2);
+		std::uniform_real_distribution<Scalar> longitude(-M_PI, M_PI);
+		std::uniform_real_distribution<Scalar> scale(0.5, 4.0);
+
+		Points points;
+		for (size_t i = 0; i < n; ++i) {
+			Geodetic2 geodetic(latitude(generator), longitude(generator));
+			Vec3 p = wgs84().cartesianSurfacePosition(geodetic) * scale(generator);
+			points.x.push_back(p.x);
+			points.y.push_back(p.y);
+			points.z.push_back(p.z);
+			points.lat.push_back(geodetic.lat);
+			points.lon.push_back(geodetic.lon);
+		}
+		return points;
+	}
+
+	static const Ellipsoid& wgs84() {
+		static const Ellipsoid ellipsoid(6378137.0, 6378137.0, 6356752.314245);
+		return ellipsoid;
+	}
+
+	template <typename Function>
+	static double pointsPerSecond(size_t n, Function function) {
+		const int numRepetitions = 10;
+		auto t0 = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < numRepetitions; ++i) {
+			function();
+		}
+		auto t1 = std::chrono::high_resolution_clock::now();
+		return n * numRepetitions / std::chrono::duration<double>(t1 - t0).count();
+	}
+};
+
+
 TEST_F(EllipsoidTest, GeodeticSurfaceNormal) {
 	Ellipsoid ellipsoid(Vec3(1, 1, 1));
 
-	Vec3 geodeticNormal = ellipsoid.geodeticSurfaceNormal(Vec3(0, 0, 1));
+	Vec3 geodeticNormal = ellipsoid.geodeticSurfaceNormalForGeocentricallyProjectedPoint(
+		Vec3(0, 0, 1));
 	Vec3 expectedNormal = Vec3(0, 0, 1);
 
 	ASSERT_EQ(geodeticNormal, expectedNormal);
 }
+
+// An odd number of points to cover the points that are not processed in pairs
+const size_t NumEllipsoidTestPoints = 1001;
+
+TEST_F(EllipsoidTest, BatchedGeodeticSurfaceProjection) {
+	Points points = randomPoints(NumEllipsoidTestPoints);
+	size_t n = points.x.size();
+	std::vector<Scalar> x(n), y(n), z(n);
+	wgs84().geodeticSurfaceProjection(points.x.data(), points.y.data(), points.z.data(),
+		n, x.data(), y.data(), z.data());
+
+	for (size_t i = 0; i < n; ++i) {
+		Vec3 expected = wgs84().geodeticSurfaceProjection(
+			Vec3(points.x[i], points.y[i], points.z[i]));
+		Scalar tolerance = 1e-12 * glm::length(expected);
+		EXPECT_NEAR(expected.x, x[i], tolerance) << "Point " << i;
+		EXPECT_NEAR(expected.y, y[i], tolerance) << "Point " << i;
+		EXPECT_NEAR(expected.z, z[i], tolerance) << "Point " << i;
+	}
+}
+
+TEST_F(EllipsoidTest, BatchedGeodeticSurfaceProjectionInPlace) {
+	Points points = randomPoints(NumEllipsoidTestPoints);
+	Points projected = points;
+	size_t n = points.x.size();
+	wgs84().geodeticSurfaceProjection(projected.x.data(), projected.y.data(),
+		projected.z.data(), n, projected.x.data(), projected.y.data(),
+		projected.z.data());
+
+	for (size_t i = 0; i < n; ++i) {
+		Vec3 expected = wgs84().geodeticSurfaceProjection(
+			Vec3(points.x[i], points.y[i], points.z[i]));
+		Scalar tolerance = 1e-12 * glm::length(expected);
+		EXPECT_NEAR(expected.x, projected.x[i], tolerance) << "Point " << i;
+		EXPECT_NEAR(expected.y, projected.y[i], tolerance) << "Point " << i;
+		EXPECT_NEAR(expected.z, projected.z[i], tolerance) << "Point " << i;
+	}
+}
+
+TEST_F(EllipsoidTest, BatchedCartesianToGeodetic2) {
+	Points points = randomPoints(NumEllipsoidTestPoints);
+	size_t n = points.x.size();
+	std::vector<Scalar> lat(n), lon(n);
+	wgs84().cartesianToGeodetic2(points.x.data(), points.y.data(), points.z.data(), n,
+		lat.data(), lon.data());
+
+	for (size_t i = 0; i < n; ++i) {
+		Geodetic2 expected = wgs84().cartesianToGeodetic2(
+			Vec3(points.x[i], points.y[i], points.z[i]));
+		EXPECT_NEAR(expected.lat, lat[i], 1e-12) << "Point " << i;
+		EXPECT_NEAR(expected.lon, lon[i], 1e-12) << "Point " << i;
+	}
+}
+
+TEST_F(EllipsoidTest, BatchedCartesianSurfacePosition) {
+	Points points = randomPoints(NumEllipsoidTestPoints);
+	size_t n = points.x.size();
+	std::vector<Scalar> x(n), y(n), z(n);
+	wgs84().cartesianSurfacePosition(points.lat.data(), points.lon.data(), n,
+		x.data(), y.data(), z.data());
+
+	for (size_t i = 0; i < n; ++i) {
+		Vec3 expected = wgs84().cartesianSurfacePosition(
+			Geodetic2(points.lat[i], points.lon[i]));
+		Scalar tolerance = 1e-12 * glm::length(expected);
+		EXPECT_NEAR(expected.x, x[i], tolerance) << "Point " << i;
+		EXPECT_NEAR(expected.y, y[i], tolerance) << "Point " << i;
+		EXPECT_NEAR(expected.z, z[i], tolerance) << "Point " << i;
+	}
+}
+
+TEST_F(EllipsoidTest, BatchedClosestPointAndCorner) {
+	Points points = randomPoints(NumEllipsoidTestPoints);
+	size_t n = points.x.size();
+
+	// Patches at different latitudes, one of them across the date line
+	std::vector<GeodeticPatch> patches = {
+		GeodeticPatch(0, 0, M_PI / 4, M_PI / 4),
+		GeodeticPatch(M_PI / 3, M_PI - 0.1, M_PI / 16, M_PI / 8),
+		GeodeticPatch(-M_PI / 8, -M_PI / 2, M_PI / 64, M_PI / 64)
+	};
+	for (const GeodeticPatch& patch : patches) {
+		std::vector<Scalar> pointLat(n), pointLon(n), cornerLat(n), cornerLon(n);
+		patch.closestPoint(points.lat.data(), points.lon.data(), n,
+			pointLat.data(), pointLon.data());
+		patch.closestCorner(points.lat.data(), points.lon.data(), n,
+			cornerLat.data(), cornerLon.data());
+
+		for (size_t i = 0; i < n; ++i) {
+			Geodetic2 p(points.lat[i], points.lon[i]);
+			Geodetic2 expectedPoint = patch.closestPoint(p);
+			EXPECT_NEAR(expectedPoint.lat, pointLat[i], 1e-12) << "Point " << i;
+			EXPECT_NEAR(expectedPoint.lon, pointLon[i], 1e-12) << "Point " << i;
+
+			Geodetic2 expectedCorner = patch.closestCorner(p);
+			EXPECT_NEAR(expectedCorner.lat, cornerLat[i], 1e-12) << "Point " << i;
+			EXPECT_NEAR(expectedCorner.lon, cornerLon[i], 1e-12) << "Point " << i;
+		}
+	}
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(EllipsoidTest, Benchmark) {
+	const size_t n = 1 << 16;
+	Points points = randomPoints(n);
+	std::vector<Scalar> x(n), y(n), z(n), lat(n), lon(n);
+	const Ellipsoid& ellipsoid = wgs84();
+	GeodeticPatch patch(M_PI / 3, M_PI - 0.1, M_PI / 16, M_PI / 8);
+
+	auto report = [](const std::string& name, double scalar, double batched) {
+		std::cout << "[          ] " << name << ": " << scalar / 1e6 <<
+			" M points/s single, " << batched / 1e6 << " M points/s batched" <<
+			std::endl;
+	};
+
+	report("geodeticSurfaceProjection",
+		pointsPerSecond(n, [&]() {
+			for (size_t i = 0; i < n; ++i) {
+				Vec3 p = ellipsoid.geodeticSurfaceProjection(
+					Vec3(points.x[i], points.y[i], points.z[i]));
+				x[i] = p.x; y[i] = p.y; z[i] = p.z;
+			}
+		}),
+		pointsPerSecond(n, [&]() {
+			ellipsoid.geodeticSurfaceProjection(points.x.data(), points.y.data(),
+				points.z.data(), n, x.data(), y.data(), z.data());
+		}));
+
+	report("cartesianToGeodetic2",
+		pointsPerSecond(n, [&]() {
+			for (size_t i = 0; i < n; ++i) {
+				Geodetic2 g = ellipsoid.cartesianToGeodetic2(
+					Vec3(points.x[i], points.y[i], points.z[i]));
+				lat[i] = g.lat; lon[i] = g.lon;
+			}
+		}),
+		pointsPerSecond(n, [&]() {
+			ellipsoid.cartesianToGeodetic2(points.x.data(), points.y.data(),
+				points.z.data(), n, lat.data(), lon.data());
+		}));
+
+	report("cartesianSurfacePosition",
+		pointsPerSecond(n, [&]() {
+			for (size_t i = 0; i < n; ++i) {
+				Vec3 p = ellipsoid.cartesianSurfacePosition(
+					Geodetic2(points.lat[i], points.lon[i]));
+				x[i] = p.x; y[i] = p.y; z[i] = p.z;
+			}
+		}),
+		pointsPerSecond(n, [&]() {
+			ellipsoid.cartesianSurfacePosition(points.lat.data(), points.lon.data(),
+				n, x.data(), y.data(), z.data());
+		}));
+
+	report("closestPoint",
+		pointsPerSecond(n, [&]() {
+			for (size_t i = 0; i < n; ++i) {
+				Geodetic2 p(points.lat[i], points.lon[i]);
+				Geodetic2 g = patch.closestPoint(p);
+				lat[i] = g.lat; lon[i] = g.lon;
+			}
+		}),
+		pointsPerSecond(n, [&]() {
+			patch.closestPoint(points.lat.data(), points.lon.data(), n,
+				lat.data(), lon.data());
+		}));
+
+	report("closestCorner",
+		pointsPerSecond(n, [&]() {
+			for (size_t i = 0; i < n; ++i) {
+				Geodetic2 p(points.lat[i], points.lon[i]);
+				Geodetic2 g = patch.closestCorner(p);
+				lat[i] = g.lat; lon[i] = g.lon;
+			}
+		}),
+		pointsPerSecond(n, [&]() {
+			patch.closestCorner(points.lat.data(), points.lon.data(), n,
+				lat.data(), lon.data());
+		}));
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,206 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/base/rendering/geometryregistry.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+class GeometryRegistryTest : public testing::Test {
+protected:
+    using Vertex = openspace::modelgeometry::ModelGeometry::Vertex;
+    using GeometryRegistry = openspace::modelgeometry::GeometryRegistry;
+
+    GeometryRegistryTest()
+        : cacheFile("geometryregistrytest.cache")
+        , nLoads(0)
+    {
+        std::remove(cacheFile.c_str());
+    }
+
+    ~GeometryRegistryTest() {
+        std::remove(cacheFile.c_str());
+    }
+
+    // Returns a loader for a grid with n*n vertices that counts how often it is called
+    GeometryRegistry::Loader gridLoader(int n) {
+        return [this, n](std::vector<Vertex>& vertices, std::vector<int>& indices) {
+            ++nLoads;
+            for (int y = 0; y < n; ++y) {
+                for (int x = 0; x < n; ++x) {
+                    vertices.push_back({
+                        { float(x), float(y), 0.f, 0.f },
+                        { float(x) / n, float(y) / n },
+                        { 0.f, 0.f, 1.f }
+                    });
+                }
+            }
+            for (int y = 0; y < n - 1; ++y) {
+                for (int x = 0; x < n - 1; ++x) {
+                    int i = y * n + x;
+                    indices.insert(
+                        indices.end(),
+                        { i, i + 1, i + n, i + 1, i + n + 1, i + n }
+                    );
+                }
+            }
+            return true;
+        };
+    }
+
+    std::string cacheFile;
+    std::atomic<int> nLoads;
+};
+
+TEST_F(GeometryRegistryTest, SharedBetweenUsers) {
+    GeometryRegistry registry;
+    auto first = registry.acquire(cacheFile, gridLoader(4));
+    auto second = registry.acquire(cacheFile, gridLoader(4));
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(1, nLoads);
+    EXPECT_EQ(1, registry.size());
+    ASSERT_TRUE(first->isValid());
+    EXPECT_EQ(16, first->nVertices());
+    EXPECT_EQ(54, first->nIndices());
+    EXPECT_NEAR(std::sqrt(18.0), first->boundingRadius(), 1e-6);
+
+    first = nullptr;
+    second = nullptr;
+    EXPECT_EQ(0, registry.size());
+}
+
+TEST_F(GeometryRegistryTest, MappedFromCache) {
+    GeometryRegistry registry;
+    {
+        auto geometry = registry.acquire(cacheFile, gridLoader(8));
+        // The freshly parsed model is written to the cache and mapped back
+        EXPECT_TRUE(geometry->isMapped());
+    }
+
+    auto geometry = registry.acquire(cacheFile, gridLoader(8));
+    EXPECT_EQ(1, nLoads);
+    ASSERT_TRUE(geometry->isMapped());
+    ASSERT_EQ(64, geometry->nVertices());
+    EXPECT_EQ(7.f, geometry->vertices()[63].location[0]);
+    EXPECT_EQ(7.f, geometry->vertices()[63].location[1]);
+    EXPECT_EQ(63, geometry->indices()[geometry->nIndices() - 2]);
+}
+
+TEST_F(GeometryRegistryTest, OutdatedCacheIsRegenerated) {
+    {
+        // A cache file written in the previous, unpadded format
+        std::ofstream file(cacheFile, std::ofstream::binary);
+        int8_t version = 3;
+        int64_t sizes[2] = { 1, 1 };
+        file.write(reinterpret_cast<const char*>(&version), sizeof(int8_t));
+        file.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    }
+
+    GeometryRegistry registry;
+    auto geometry = registry.acquire(cacheFile, gridLoader(4));
+    EXPECT_EQ(1, nLoads);
+    EXPECT_EQ(16, geometry->nVertices());
+}
+
+TEST_F(GeometryRegistryTest, ConcurrentAcquire) {
+    GeometryRegistry registry;
+    std::vector<std::shared_ptr<openspace::modelgeometry::SharedGeometry>> results(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            results[i] = registry.acquire(cacheFile, gridLoader(64));
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(1, nLoads);
+    for (const auto& r : results) {
+        EXPECT_EQ(results[0], r);
+    }
+    EXPECT_EQ(64 * 64, results[0]->nVertices());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(GeometryRegistryTest, StartupBenchmark) {
+    using Clock = std::chrono::high_resolution_clock;
+    auto milliseconds = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    // A model the size of the larger spacecraft models, used by eight renderables
+    const int GridSize = 512;
+    const int Instances = 8;
+    {
+        std::vector<Vertex> vertices;
+        std::vector<int> indices;
+        gridLoader(GridSize)(vertices, indices);
+        GeometryRegistry::saveCacheFile(cacheFile, vertices, indices);
+        nLoads = 0;
+    }
+
+    // Every renderable reads its own copy with stream reads, as before
+    Clock::time_point start = Clock::now();
+    size_t streamedBytes = 0;
+    for (int i = 0; i < Instances; ++i) {
+        std::ifstream file(cacheFile, std::ifstream::binary);
+        char header[24];
+        file.read(header, sizeof(header));
+        int64_t vSize = *reinterpret_cast<int64_t*>(header + 8);
+        int64_t iSize = *reinterpret_cast<int64_t*>(header + 16);
+        std::vector<Vertex> vertices(vSize);
+        std::vector<int> indices(iSize);
+        file.read(reinterpret_cast<char*>(vertices.data()), sizeof(Vertex) * vSize);
+        file.read(reinterpret_cast<char*>(indices.data()), sizeof(int) * iSize);
+        streamedBytes += vertices.size() * sizeof(Vertex) + indices.size() * sizeof(int);
+    }
+    double streamed = milliseconds(start, Clock::now());
+
+    // All renderables share one mapping of the cache file
+    GeometryRegistry registry;
+    start = Clock::now();
+    std::vector<std::shared_ptr<openspace::modelgeometry::SharedGeometry>> shared;
+    for (int i = 0; i < Instances; ++i) {
+        shared.push_back(registry.acquire(cacheFile, gridLoader(GridSize)));
+    }
+    double mapped = milliseconds(start, Clock::now());
+
+    EXPECT_EQ(0, nLoads);
+    ASSERT_TRUE(shared[0]->isMapped());
+    std::cout << "[          ] " << Instances << " instances of a model with " <<
+        shared[0]->nVertices() << " vertices: " << streamed << " ms and " <<
+        streamedBytes / (1024 * 1024) << " MiB of heap with stream reads, " << mapped <<
+        " ms and " << shared[0]->memoryFootprint() / (1024 * 1024) <<
+        " MiB of mapped pages when shared" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
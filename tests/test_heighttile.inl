@@ -0,0 +1,164 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/tile/heighttile.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+class HeightTileTest : public testing::Test {
+protected:
+    // A smooth height field in meters with a distinct value for every texel
+    static openspace::HeightTile createTile(unsigned int width, unsigned int height) {
+        std::vector<float> heights(width * height);
+        for (unsigned int y = 0; y < height; ++y) {
+            for (unsigned int x = 0; x < width; ++x) {
+                heights[y * width + x] = 1000.f * std::sin(0.1f * x) + 10.f * y;
+            }
+        }
+        return openspace::HeightTile(glm::uvec2(width, height), std::move(heights));
+    }
+
+    static std::vector<float> randomCoordinates(size_t n, unsigned int seed) {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(0.f, 1.f);
+        std::vector<float> coordinates(n);
+        for (float& c : coordinates) {
+            c = distribution(generator);
+        }
+        return coordinates;
+    }
+
+    // Bilinear interpolation as previously done by RenderableGlobe::getHeight
+    static float reference(const openspace::HeightTile& tile,
+                           const std::vector<float>& heights, float u, float v)
+    {
+        glm::uvec2 dimensions = tile.dimensions();
+        glm::vec2 samplePos = glm::vec2(u, v) * glm::vec2(dimensions);
+        glm::uvec2 p00 = glm::min(glm::uvec2(samplePos), dimensions - glm::uvec2(1));
+        glm::vec2 fraction = samplePos - glm::vec2(p00);
+        glm::uvec2 p11 = glm::min(p00 + glm::uvec2(1), dimensions - glm::uvec2(1));
+
+        auto at = [&](unsigned int x, unsigned int y) {
+            return heights[y * dimensions.x + x];
+        };
+        float sample0 =
+            at(p00.x, p00.y) * (1.f - fraction.x) + at(p11.x, p00.y) * fraction.x;
+        float sample1 =
+            at(p00.x, p11.y) * (1.f - fraction.x) + at(p11.x, p11.y) * fraction.x;
+        return sample0 * (1.f - fraction.y) + sample1 * fraction.y;
+    }
+};
+
+TEST_F(HeightTileTest, TexelCenters) {
+    openspace::HeightTile tile = createTile(16, 8);
+
+    // Coordinates at the start of a texel return exactly the value of that texel
+    for (unsigned int y = 0; y < 8; ++y) {
+        for (unsigned int x = 0; x < 16; ++x) {
+            float expected = 1000.f * std::sin(0.1f * x) + 10.f * y;
+            EXPECT_EQ(expected, tile.sample(glm::vec2(x / 16.f, y / 8.f)));
+        }
+    }
+}
+
+TEST_F(HeightTileTest, MatchesReference) {
+    const unsigned int width = 65;
+    const unsigned int height = 33;
+    openspace::HeightTile tile = createTile(width, height);
+    std::vector<float> heights(width * height);
+    for (unsigned int i = 0; i < width * height; ++i) {
+        heights[i] = 1000.f * std::sin(0.1f * (i % width)) + 10.f * (i / width);
+    }
+
+    // An odd number of samples to exercise both the vectorized and the scalar path
+    const size_t n = 10001;
+    std::vector<float> u = randomCoordinates(n, 1);
+    std::vector<float> v = randomCoordinates(n, 2);
+    // Edges of the tile
+    u[0] = 0.f; v[0] = 0.f;
+    u[1] = 1.f; v[1] = 1.f;
+    u[2] = 1.f; v[2] = 0.f;
+    u[3] = 0.f; v[3] = 1.f;
+
+    std::vector<float> result(n);
+    tile.sample(u.data(), v.data(), n, result.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        float expected = reference(tile, heights, u[i], v[i]);
+        EXPECT_NEAR(expected, result[i], 1e-3f) << "u: " << u[i] << " v: " << v[i];
+        EXPECT_EQ(result[i], tile.sample(glm::vec2(u[i], v[i])));
+    }
+}
+
+TEST_F(HeightTileTest, ClampsOutsideCoordinates) {
+    openspace::HeightTile tile = createTile(16, 8);
+
+    std::vector<float> u = { -0.5f, 1.5f, -0.5f, 1.5f, 0.5f };
+    std::vector<float> v = { -0.5f, -0.5f, 1.5f, 1.5f, 2.f };
+    std::vector<float> result(u.size());
+    tile.sample(u.data(), v.data(), u.size(), result.data());
+
+    EXPECT_EQ(tile.sample(glm::vec2(0.f, 0.f)), result[0]);
+    EXPECT_EQ(tile.sample(glm::vec2(1.f, 0.f)), result[1]);
+    EXPECT_EQ(tile.sample(glm::vec2(0.f, 1.f)), result[2]);
+    EXPECT_EQ(tile.sample(glm::vec2(1.f, 1.f)), result[3]);
+    EXPECT_EQ(tile.sample(glm::vec2(0.5f, 1.f)), result[4]);
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(HeightTileTest, Benchmark) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    openspace::HeightTile tile = createTile(512, 512);
+    const size_t n = 1000000;
+    std::vector<float> u = randomCoordinates(n, 3);
+    std::vector<float> v = randomCoordinates(n, 4);
+    std::vector<float> single(n);
+    std::vector<float> batch(n);
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        single[i] = tile.sample(glm::vec2(u[i], v[i]));
+    }
+    double singleTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    tile.sample(u.data(), v.data(), n, batch.data());
+    double batchTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (size_t i = 0; i < n; i += 997) {
+        EXPECT_EQ(single[i], batch[i]);
+    }
+
+    std::cout << "[          ] One at a time: " << n / singleTime / 1e6
+              << " million queries/s" << std::endl;
+    std::cout << "[          ] Batched:       " << n / batchTime / 1e6
+              << " million queries/s" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,176 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/util/histogram.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+class HistogramTest : public testing::Test {
+protected:
+    // Uniformly distributed values, of which some are outside of [0, 1]
+    static std::vector<float> randomValues(size_t n) {
+        std::mt19937 generator(1337);
+        std::uniform_real_distribution<float> distribution(-0.1f, 1.1f);
+        std::vector<float> values(n);
+        for (float& v : values) {
+            v = distribution(generator);
+        }
+        return values;
+    }
+};
+
+TEST_F(HistogramTest, BatchMatchesSingleValues) {
+    using openspace::Histogram;
+
+    std::vector<float> values = randomValues(100000);
+    // The boundaries of the range and of the bins
+    values.push_back(0.f);
+    values.push_back(1.f);
+    values.push_back(0.5f);
+    values.push_back(std::numeric_limits<float>::quiet_NaN());
+
+    Histogram single(0.f, 1.f, 100);
+    size_t nInRange = 0;
+    for (float v : values) {
+        if (!std::isnan(v) && single.add(v)) {
+            ++nInRange;
+        }
+    }
+
+    Histogram batch(0.f, 1.f, 100);
+    EXPECT_EQ(nInRange, batch.add(values));
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(single.sample(i), batch.sample(i)) << "Bin " << i;
+    }
+}
+
+TEST_F(HistogramTest, EmptyRange) {
+    using openspace::Histogram;
+
+    Histogram histogram(0.5f, 0.5f, 16);
+    std::vector<float> values = { 0.f, 0.5f, 0.5f, 1.f };
+    EXPECT_EQ(0, histogram.add(values));
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_EQ(0.f, histogram.sample(i)) << "Bin " << i;
+    }
+}
+
+TEST_F(HistogramTest, ParallelAndMerged) {
+    using openspace::Histogram;
+
+    std::vector<float> values = randomValues(3000000);
+
+    Histogram serial(0.f, 1.f, 64);
+    serial.add(values, 1);
+    Histogram parallel(0.f, 1.f, 64);
+    parallel.add(values, 4);
+
+    // Two halves built separately and merged
+    Histogram merged(0.f, 1.f, 64);
+    Histogram secondHalf(0.f, 1.f, 64);
+    size_t half = values.size() / 2;
+    merged.add(values.data(), half);
+    secondHalf.add(values.data() + half, values.size() - half);
+    EXPECT_TRUE(merged.add(secondHalf));
+
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(serial.sample(i), parallel.sample(i));
+        EXPECT_EQ(serial.sample(i), merged.sample(i));
+    }
+
+    EXPECT_FALSE(merged.add(Histogram(0.f, 2.f, 64)));
+}
+
+TEST_F(HistogramTest, EqualizerAndEntropy) {
+    using openspace::Histogram;
+
+    // Every bin is filled equally
+    Histogram histogram(0.f, 4.f, 4);
+    histogram.add(std::vector<float>({ 0.5f, 1.5f, 2.5f, 3.5f }));
+    EXPECT_FLOAT_EQ(2.f, histogram.entropy());
+
+    histogram.generateEqualizer();
+    EXPECT_FLOAT_EQ(0.75f, histogram.equalize(0.5f));
+    EXPECT_FLOAT_EQ(3.f, histogram.equalize(3.5f));
+
+    // Adding values invalidates the cached entropy
+    histogram.add(std::vector<float>(4, 0.5f));
+    EXPECT_LT(histogram.entropy(), 2.f);
+    histogram.generateEqualizer();
+    EXPECT_FLOAT_EQ(1.875f, histogram.equalize(0.5f));
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(HistogramTest, Benchmark) {
+    using openspace::Histogram;
+    using Clock = std::chrono::high_resolution_clock;
+
+    // 10^8 values, added in blocks to limit the memory that is used
+    const size_t nValues = 100000000;
+    const size_t nBlock = 1000000;
+    std::vector<float> values = randomValues(nBlock);
+
+    Histogram single(0.f, 1.f, 512);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < nValues; i += nBlock) {
+        for (float v : values) {
+            single.add(v);
+        }
+    }
+    double singleTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Histogram batch(0.f, 1.f, 512);
+    start = Clock::now();
+    for (size_t i = 0; i < nValues; i += nBlock) {
+        batch.add(values);
+    }
+    double batchTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Per-thread histograms need enough values per call to pay off
+    std::vector<float> large(nValues / 10);
+    for (size_t i = 0; i < large.size(); i += nBlock) {
+        std::copy(values.begin(), values.end(), large.begin() + i);
+    }
+    Histogram parallel(0.f, 1.f, 512);
+    start = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        parallel.add(large, 0);
+    }
+    double parallelTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (int i = 0; i < 512; ++i) {
+        EXPECT_EQ(batch.sample(i), parallel.sample(i));
+    }
+
+    std::cout << "[          ] 10^8 values: " << singleTime << " s one at a time, " <<
+        batchTime << " s batched, " << parallelTime << " s batched in parallel" <<
+        std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,180 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/interaction/keyframebuffer.h>
+
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <random>
+
+namespace {
+    using Keyframe = openspace::interaction::KeyframeBuffer::Keyframe;
+
+    // The camera path of the host: a helix while turning around the z axis
+    const double PathRadius = 1e7;
+
+    Keyframe hostCamera(double t) {
+        Keyframe k;
+        k.position = glm::dvec3(
+            PathRadius * cos(t),
+            PathRadius * sin(t),
+            PathRadius * 0.1 * t
+        );
+        k.rotation = glm::angleAxis(t, glm::dvec3(0.0, 0.0, 1.0));
+        k.timestamp = t;
+        return k;
+    }
+
+    struct Delivery {
+        Keyframe keyframe;
+        double arrival;
+    };
+
+    // Keyframes sent every interval seconds for duration seconds of host time, arriving
+    // with a constant clock offset and a jittered transmission delay
+    std::vector<Delivery> jitteredDeliveries(double interval, double duration,
+                                             double clockOffset, double minDelay,
+                                             double jitter, unsigned int seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<double> distribution(0.0, jitter);
+
+        std::vector<Delivery> deliveries;
+        for (double t = 0.0; t <= duration; t += interval) {
+            deliveries.push_back({
+                hostCamera(t),
+                t + clockOffset + minDelay + distribution(random)
+            });
+        }
+
+        // Network delivery order, which is not necessarily the sending order
+        std::sort(
+            deliveries.begin(),
+            deliveries.end(),
+            [](const Delivery& a, const Delivery& b) { return a.arrival < b.arrival; }
+        );
+        return deliveries;
+    }
+} // namespace
+
+class KeyframeBufferTest : public testing::Test {};
+
+TEST_F(KeyframeBufferTest, Empty) {
+    openspace::interaction::KeyframeBuffer buffer;
+    Keyframe k;
+    EXPECT_FALSE(buffer.sample(0.0, k));
+    EXPECT_FALSE(buffer.hasKeyframes());
+}
+
+TEST_F(KeyframeBufferTest, OutOfOrderAndClear) {
+    openspace::interaction::KeyframeBuffer buffer;
+    buffer.setPlayoutDelay(0.0);
+    buffer.push(hostCamera(0.2), 10.25);
+    buffer.push(hostCamera(0.1), 10.30);
+    buffer.push(hostCamera(0.0), 10.05);
+    buffer.update();
+
+    ASSERT_TRUE(buffer.hasKeyframes());
+    EXPECT_DOUBLE_EQ(10.05, buffer.clockOffset());
+
+    Keyframe k;
+    ASSERT_TRUE(buffer.sample(10.2, k));
+    EXPECT_NEAR(0.15, k.timestamp, 1e-9);
+
+    buffer.clear();
+    buffer.update();
+    EXPECT_FALSE(buffer.hasKeyframes());
+}
+
+TEST_F(KeyframeBufferTest, JitteredReplay) {
+    const double interval = 0.1;
+    const double clockOffset = 1000.0;
+    const double minDelay = 0.05;
+    const double jitter = 0.08;
+    const double frameTime = 1.0 / 60.0;
+
+    std::vector<Delivery> deliveries = jitteredDeliveries(
+        interval, 20.0, clockOffset, minDelay, jitter, 1337
+    );
+
+    openspace::interaction::KeyframeBuffer buffer;
+    // The spline through a segment needs the keyframe after the next one as well
+    buffer.setPlayoutDelay(jitter + 2.0 * interval);
+
+    size_t nextDelivery = 0;
+    double previousHostTime = -1.0;
+    double maxPositionError = 0.0;
+    double maxAngleError = 0.0;
+    double maxStepError = 0.0;
+    int nFrames = 0;
+
+    for (double now = clockOffset; now < clockOffset + 19.0; now += frameTime) {
+        while (nextDelivery < deliveries.size() &&
+               deliveries[nextDelivery].arrival <= now)
+        {
+            ASSERT_TRUE(buffer.push(
+                deliveries[nextDelivery].keyframe,
+                deliveries[nextDelivery].arrival
+            ));
+            ++nextDelivery;
+        }
+
+        Keyframe k;
+        if (!buffer.sample(now, k)) {
+            continue;
+        }
+
+        // Skip the warm-up until the clock offset estimate has settled
+        if (now < clockOffset + 4.0) {
+            previousHostTime = k.timestamp;
+            continue;
+        }
+
+        const Keyframe truth = hostCamera(k.timestamp);
+        maxPositionError = std::max(
+            maxPositionError,
+            glm::length(k.position - truth.position) / PathRadius
+        );
+        const double d = std::min(std::abs(glm::dot(k.rotation, truth.rotation)), 1.0);
+        maxAngleError = std::max(maxAngleError, 2.0 * std::acos(d));
+
+        // The shown host time has to advance as steadily as the local frames
+        EXPECT_GE(k.timestamp, previousHostTime);
+        maxStepError = std::max(
+            maxStepError,
+            std::abs((k.timestamp - previousHostTime) - frameTime)
+        );
+        previousHostTime = k.timestamp;
+        ++nFrames;
+    }
+
+    EXPECT_GT(nFrames, 800);
+    EXPECT_LT(maxPositionError, 1e-4);
+    EXPECT_LT(maxAngleError, 1e-4);
+    EXPECT_LT(maxStepError, 0.01);
+    EXPECT_NEAR(clockOffset + minDelay, buffer.clockOffset(), jitter / 4.0);
+}
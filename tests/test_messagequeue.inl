@@ -0,0 +1,266 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/network/messagequeue.h>
+
+#ifndef WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Frames a message with the same layout as ParallelConnection data messages:
+    // 'O' 'S' major minor | uint32 message type | uint16 data type | uint16 size | data
+    // The payload carries the time at which the message was queued
+    void frameMessage(std::vector<char>& buffer, uint16_t payloadSize) {
+        const char header[4] = { 'O', 'S', 0, 0 };
+        buffer.insert(buffer.end(), header, header + 4);
+        uint32_t messageType = 2;
+        buffer.insert(buffer.end(), reinterpret_cast<char*>(&messageType), reinterpret_cast<char*>(&messageType) + sizeof(messageType));
+        uint16_t dataType = 0;
+        buffer.insert(buffer.end(), reinterpret_cast<char*>(&dataType), reinterpret_cast<char*>(&dataType) + sizeof(dataType));
+        buffer.insert(buffer.end(), reinterpret_cast<char*>(&payloadSize), reinterpret_cast<char*>(&payloadSize) + sizeof(payloadSize));
+
+        long long now = Clock::now().time_since_epoch().count();
+        const size_t offset = buffer.size();
+        buffer.resize(offset + payloadSize);
+        memcpy(buffer.data() + offset, &now, sizeof(now));
+    }
+
+    bool readExactly(int socket, char* data, size_t length) {
+        size_t received = 0;
+        while (received < length) {
+            ssize_t r = recv(socket, data + received, length - received, 0);
+            if (r <= 0) {
+                return false;
+            }
+            received += static_cast<size_t>(r);
+        }
+        return true;
+    }
+
+    // A loopback stand-in for the parallel server that parses the framing of incoming
+    // messages and records the queue-to-receive latency of each of them
+    struct LoopbackServer {
+        LoopbackServer() {
+            listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            sockaddr_in address;
+            memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            listen(listenSocket, 1);
+
+            socklen_t length = sizeof(address);
+            getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &length);
+            port = ntohs(address.sin_port);
+        }
+
+        ~LoopbackServer() {
+            close(listenSocket);
+        }
+
+        void receive(size_t nMessages) {
+            int connection = accept(listenSocket, nullptr, nullptr);
+            std::vector<char> header(12);
+            std::vector<char> payload;
+            while (latencies.size() < nMessages) {
+                if (!readExactly(connection, header.data(), header.size())) {
+                    break;
+                }
+                if (header[0] != 'O' || header[1] != 'S') {
+                    ++malformed;
+                    break;
+                }
+                uint16_t size;
+                memcpy(&size, header.data() + 10, sizeof(size));
+                payload.resize(size);
+                if (!readExactly(connection, payload.data(), size)) {
+                    break;
+                }
+
+                long long sent;
+                memcpy(&sent, payload.data(), sizeof(sent));
+                long long now = Clock::now().time_since_epoch().count();
+                latencies.push_back(std::chrono::duration<double, std::micro>(
+                    Clock::duration(now - sent)).count()
+                );
+            }
+            close(connection);
+        }
+
+        int listenSocket;
+        unsigned short port;
+        std::vector<double> latencies;
+        int malformed = 0;
+    };
+
+    int connectTo(unsigned short port) {
+        int s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        int flag = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&flag), sizeof(int));
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        return s;
+    }
+} // namespace
+
+class MessageQueueTest : public testing::Test {};
+
+TEST_F(MessageQueueTest, BufferReuse) {
+    openspace::network::MessageQueue queue;
+    std::vector<char> buffer = queue.acquireBuffer();
+    frameMessage(buffer, 64);
+    const size_t capacity = buffer.capacity();
+    queue.push(std::move(buffer));
+    queue.clear();
+
+    std::vector<char> reused = queue.acquireBuffer();
+    EXPECT_TRUE(reused.empty());
+    EXPECT_EQ(capacity, reused.capacity());
+}
+
+TEST_F(MessageQueueTest, LargeBuffersAreNotPooled) {
+    openspace::network::MessageQueue queue;
+    std::vector<char> buffer = queue.acquireBuffer();
+    buffer.resize(2 * 1024 * 1024);
+    queue.push(std::move(buffer));
+    queue.clear();
+
+    std::vector<char> reused = queue.acquireBuffer();
+    EXPECT_EQ(0u, reused.capacity());
+}
+
+namespace {
+    struct LoopbackResult {
+        double seconds;
+        size_t nWrites;
+        std::vector<double> latencies;
+    };
+
+    // Sends nMessages through a MessageQueue to a LoopbackServer, waiting interval
+    // between two messages, and checks that all of them arrive intact
+    LoopbackResult runLoopback(size_t nMessages, std::chrono::microseconds interval) {
+        const uint16_t payloadSize = 60; // the size of a PositionKeyframe
+
+        LoopbackServer server;
+        std::thread serverThread([&server, nMessages]() { server.receive(nMessages); });
+        int client = connectTo(server.port);
+
+        openspace::network::MessageQueue queue;
+        std::atomic<bool> producing(true);
+        std::thread sender([&queue, &producing, client, nMessages]() {
+            while (producing.load() || queue.nSentMessages() < nMessages) {
+                if (queue.flush(client, std::chrono::milliseconds(10)) < 0) {
+                    break;
+                }
+            }
+        });
+
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < nMessages; ++i) {
+            std::vector<char> buffer = queue.acquireBuffer();
+            frameMessage(buffer, payloadSize);
+            queue.push(std::move(buffer));
+            if (interval.count() > 0) {
+                std::this_thread::sleep_for(interval);
+            }
+        }
+        producing = false;
+        queue.wakeUp();
+
+        sender.join();
+        serverThread.join();
+        Clock::time_point end = Clock::now();
+        close(client);
+
+        EXPECT_EQ(0, server.malformed);
+        EXPECT_EQ(nMessages, server.latencies.size());
+        EXPECT_EQ(nMessages, queue.nSentMessages());
+
+        LoopbackResult result;
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        result.nWrites = queue.nWrites();
+        result.latencies = std::move(server.latencies);
+        std::sort(result.latencies.begin(), result.latencies.end());
+        return result;
+    }
+} // namespace
+
+TEST_F(MessageQueueTest, Loopback) {
+    LoopbackResult result = runLoopback(20000, std::chrono::microseconds(0));
+    // A saturated queue lets the sender coalesce messages into fewer writes
+    EXPECT_LE(result.nWrites, 20000u);
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+namespace {
+    void printLoopback(const std::string& name, size_t nMessages,
+                       const LoopbackResult& r)
+    {
+        if (r.latencies.empty()) {
+            return;
+        }
+        const std::vector<double>& l = r.latencies;
+        std::cout << name << " (" << nMessages << " messages)" << std::endl
+            << "  Throughput:     " << nMessages / r.seconds << " messages/s" << std::endl
+            << "  Writes:         " << r.nWrites << std::endl
+            << "  Latency median: " << l[l.size() / 2] << " us" << std::endl
+            << "  Latency p99:    " << l[l.size() * 99 / 100] << " us" << std::endl;
+    }
+} // namespace
+
+TEST_F(MessageQueueTest, LoopbackThroughputBenchmark) {
+    // Saturating the queue lets the sender coalesce many messages into one write
+    const size_t nMessages = 200000;
+    LoopbackResult result = runLoopback(nMessages, std::chrono::microseconds(0));
+    printLoopback("MessageQueue loopback throughput", nMessages, result);
+}
+
+TEST_F(MessageQueueTest, LoopbackLatencyBenchmark) {
+    // Paced messages measure the end-to-end latency of an idle connection
+    const size_t nMessages = 2000;
+    LoopbackResult result = runLoopback(nMessages, std::chrono::microseconds(200));
+    printLoopback("MessageQueue loopback latency", nMessages, result);
+}
+#endif // OPENSPACE_BENCHMARKS
+
+#endif // WIN32
@@ -0,0 +1,221 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/newhorizons/util/projectionimageloader.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+class ProjectionImageLoaderTest : public testing::Test {
+protected:
+    // Stand in for the decoded pixels and the texture, as the tests run without OpenGL
+    // context
+    struct Image {
+        std::string path;
+        std::thread::id decodeThread;
+    };
+    struct Texture {
+        std::string path;
+        std::thread::id decodeThread;
+        std::thread::id uploadThread;
+    };
+    using Loader = openspace::ProjectionImageLoader<Image, Texture>;
+    using Status = Loader::Status;
+
+    ProjectionImageLoaderTest()
+        : nDecoded(0)
+        , decodeTime(0)
+        , timeout(10)
+    {}
+
+    std::unique_ptr<Loader> createLoader(size_t capacity) {
+        return std::make_unique<Loader>(
+            [this](const std::string& path) -> std::unique_ptr<Image> {
+                std::this_thread::sleep_for(std::chrono::milliseconds(decodeTime));
+                ++nDecoded;
+                if (path.find("broken") != std::string::npos) {
+                    return nullptr;
+                }
+                std::unique_ptr<Image> image = std::make_unique<Image>();
+                image->path = path;
+                image->decodeThread = std::this_thread::get_id();
+                return image;
+            },
+            [](Image& image) -> std::unique_ptr<Texture> {
+                if (image.path.find("unsupported") != std::string::npos) {
+                    return nullptr;
+                }
+                std::unique_ptr<Texture> texture = std::make_unique<Texture>();
+                texture->path = image.path;
+                texture->decodeThread = image.decodeThread;
+                texture->uploadThread = std::this_thread::get_id();
+                return texture;
+            },
+            capacity
+        );
+    }
+
+    // Requests the image, waits until it has been decoded and requests it again
+    Status waitFor(Loader& loader, const std::string& path, unsigned int& budget,
+                   std::shared_ptr<Texture>& image)
+    {
+        Status status = loader.texture(path, budget, image);
+        if (status == Status::Pending) {
+            EXPECT_TRUE(loader.waitFor(path, timeout));
+            status = loader.texture(path, budget, image);
+        }
+        return status;
+    }
+
+    std::atomic<int> nDecoded;
+    int decodeTime;
+    // Only reached if the loader never finishes decoding
+    std::chrono::milliseconds timeout;
+};
+
+TEST_F(ProjectionImageLoaderTest, LoadOnDemand) {
+    std::unique_ptr<Loader> loader = createLoader(8);
+
+    unsigned int budget = 1;
+    std::shared_ptr<Texture> image;
+    ASSERT_EQ(Status::Ready, waitFor(*loader, "a.png", budget, image));
+    EXPECT_EQ("a.png", image->path);
+    EXPECT_EQ(0, budget);
+
+    // Only the decoding happens on a worker, the texture is created by the caller
+    EXPECT_NE(std::this_thread::get_id(), image->decodeThread);
+    EXPECT_EQ(std::this_thread::get_id(), image->uploadThread);
+
+    // Uploaded images are returned without using the budget
+    std::shared_ptr<Texture> again;
+    EXPECT_EQ(Status::Ready, loader->texture("a.png", budget, again));
+    EXPECT_EQ(image, again);
+    EXPECT_EQ(1, nDecoded);
+
+    budget = 1;
+    EXPECT_EQ(Status::Failed, waitFor(*loader, "broken.png", budget, image));
+
+    // Images that are decoded but cannot be turned into a texture fail as well
+    budget = 1;
+    EXPECT_EQ(Status::Failed, waitFor(*loader, "unsupported.png", budget, image));
+    EXPECT_EQ(0, budget);
+    EXPECT_EQ(Status::Failed, loader->texture("unsupported.png", budget, image));
+}
+
+TEST_F(ProjectionImageLoaderTest, UploadBudget) {
+    std::unique_ptr<Loader> loader = createLoader(8);
+    loader->prefetch("a.png");
+    loader->prefetch("b.png");
+    ASSERT_TRUE(loader->waitFor("a.png", timeout));
+    ASSERT_TRUE(loader->waitFor("b.png", timeout));
+    EXPECT_EQ(2, nDecoded);
+
+    unsigned int budget = 1;
+    std::shared_ptr<Texture> image;
+    EXPECT_EQ(Status::Ready, loader->texture("a.png", budget, image));
+    EXPECT_EQ(Status::Pending, loader->texture("b.png", budget, image));
+
+    budget = 1;
+    EXPECT_EQ(Status::Ready, loader->texture("b.png", budget, image));
+    EXPECT_EQ(2, nDecoded);
+}
+
+TEST_F(ProjectionImageLoaderTest, CacheIsBounded) {
+    std::unique_ptr<Loader> loader = createLoader(4);
+    for (int i = 0; i < 16; ++i) {
+        unsigned int budget = 1;
+        std::shared_ptr<Texture> image;
+        ASSERT_EQ(
+            Status::Ready,
+            waitFor(*loader, std::to_string(i) + ".png", budget, image)
+        );
+        EXPECT_LE(loader->size(), 4);
+    }
+
+    // The most recently used image is still cached, the first one has been evicted
+    unsigned int budget = 0;
+    std::shared_ptr<Texture> image;
+    EXPECT_EQ(Status::Ready, loader->texture("15.png", budget, image));
+    EXPECT_EQ(Status::Pending, loader->texture("0.png", budget, image));
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(ProjectionImageLoaderTest, PrefetchBenchmark) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    // 60 frames in which two images with a decode time of 10 ms each are captured
+    const int nFrames = 60;
+    const int ImagesPerFrame = 2;
+    decodeTime = 10;
+    auto path = [](int frame, int i) {
+        return std::to_string(frame) + "_" + std::to_string(i) + ".png";
+    };
+
+    // Decoding on demand stalls the frame in which the images are needed
+    std::unique_ptr<Loader> loader = createLoader(64);
+    double totalOnDemand = 0.0;
+    for (int f = 0; f < nFrames; ++f) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < ImagesPerFrame; ++i) {
+            unsigned int budget = 1;
+            std::shared_ptr<Texture> image;
+            waitFor(*loader, path(f, i), budget, image);
+        }
+        double t =
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        totalOnDemand += t;
+    }
+
+    // With prefetching, the images of upcoming frames are decoded while the current
+    // frame renders, which is simulated by sleeping
+    loader = createLoader(64);
+    double totalPrefetched = 0.0;
+    const int Lookahead = 8;
+    for (int f = 0; f < nFrames; ++f) {
+        for (int p = f; p < std::min(f + Lookahead, nFrames); ++p) {
+            for (int i = 0; i < ImagesPerFrame; ++i) {
+                loader->prefetch(path(p, i));
+            }
+        }
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < ImagesPerFrame; ++i) {
+            unsigned int budget = 1;
+            std::shared_ptr<Texture> image;
+            waitFor(*loader, path(f, i), budget, image);
+        }
+        double t =
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        totalPrefetched += t;
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    }
+
+    std::cout << "[          ] Average frame stall: " << totalOnDemand / nFrames <<
+        " ms decoding on demand, " << totalPrefetched / nFrames <<
+        " ms with prefetching" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,192 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/properties/propertyindex.h>
+#include <openspace/properties/propertyowner.h>
+#include <openspace/properties/scalarproperty.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <regex>
+
+namespace {
+    // A synthetic scene of nodes that each own a renderable with a number of properties
+    struct SyntheticScene {
+        SyntheticScene(int nNodes, int nPropertiesPerOwner) {
+            for (int i = 0; i < nNodes; ++i) {
+                auto node = std::make_unique<openspace::properties::PropertyOwner>();
+                node->setName("Node" + std::to_string(i));
+                auto renderable = std::make_unique<openspace::properties::PropertyOwner>();
+                renderable->setName("Renderable");
+
+                for (int j = 0; j < nPropertiesPerOwner; ++j) {
+                    auto p = std::make_unique<openspace::properties::BoolProperty>(
+                        "Property" + std::to_string(j), "Property");
+                    node->addProperty(p.get());
+                    properties.push_back(std::move(p));
+
+                    auto q = std::make_unique<openspace::properties::BoolProperty>(
+                        "Property" + std::to_string(j), "Property");
+                    renderable->addProperty(q.get());
+                    properties.push_back(std::move(q));
+                }
+                node->addPropertySubOwner(renderable.get());
+
+                roots.push_back(node.get());
+                owners.push_back(std::move(node));
+                owners.push_back(std::move(renderable));
+            }
+        }
+
+        std::vector<const openspace::properties::PropertyOwner*> roots;
+        std::vector<std::unique_ptr<openspace::properties::PropertyOwner>> owners;
+        std::vector<std::unique_ptr<openspace::properties::Property>> properties;
+    };
+} // namespace
+
+class PropertyIndexTest : public testing::Test {};
+
+TEST_F(PropertyIndexTest, ExactLookup) {
+    SyntheticScene scene(10, 5);
+    openspace::properties::PropertyIndex index;
+    index.rebuild(scene.roots);
+
+    ASSERT_EQ(100, index.size());
+    EXPECT_TRUE(index.isUpToDate());
+
+    openspace::properties::Property* p = index.property("Node3.Renderable.Property2");
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ("Node3.Renderable.Property2", p->fullyQualifiedIdentifier());
+
+    EXPECT_EQ(nullptr, index.property("Node3.Renderable"));
+    EXPECT_EQ(nullptr, index.property("Node3.Property9"));
+    EXPECT_EQ(nullptr, index.property("Node42.Property1"));
+}
+
+TEST_F(PropertyIndexTest, Invalidation) {
+    SyntheticScene scene(2, 2);
+    openspace::properties::PropertyIndex index;
+    index.rebuild(scene.roots);
+    ASSERT_TRUE(index.isUpToDate());
+
+    openspace::properties::BoolProperty p("Extra", "Extra");
+    scene.owners[0]->addProperty(p);
+    EXPECT_FALSE(index.isUpToDate());
+
+    index.rebuild(scene.roots);
+    EXPECT_EQ(&p, index.property("Node0.Extra"));
+
+    scene.owners[0]->removeProperty(p);
+    EXPECT_FALSE(index.isUpToDate());
+}
+
+TEST_F(PropertyIndexTest, Wildcard) {
+    SyntheticScene scene(20, 3);
+    openspace::properties::PropertyIndex index;
+    index.rebuild(scene.roots);
+
+    using PI = openspace::properties::PropertyIndex;
+    EXPECT_TRUE(PI::matchesWildcard("Node1.Renderable.Property0", "Node1.*"));
+    EXPECT_TRUE(PI::matchesWildcard("Node1.Renderable.Property0", "*.Property0"));
+    EXPECT_TRUE(PI::matchesWildcard("Node1.Property0", "Node*Property*"));
+    EXPECT_FALSE(PI::matchesWildcard("Node1.Property0", "Node1.Renderable.*"));
+
+    EXPECT_EQ(6, index.propertiesMatchingWildcard("Node1.*").size());
+    EXPECT_EQ(3, index.propertiesMatchingWildcard("Node1.Renderable.*").size());
+    // Node1 and Node10..Node19, the wildcard can also span the renderable's name
+    EXPECT_EQ(22, index.propertiesMatchingWildcard("Node1*.Property0").size());
+    EXPECT_EQ(40, index.propertiesMatchingWildcard("*.Property0").size());
+    EXPECT_EQ(1, index.propertiesMatchingWildcard("Node5.Property2").size());
+}
+
+TEST_F(PropertyIndexTest, Regex) {
+    SyntheticScene scene(20, 3);
+    openspace::properties::PropertyIndex index;
+    index.rebuild(scene.roots);
+
+    using PI = openspace::properties::PropertyIndex;
+    EXPECT_EQ("Node1", PI::literalPrefix("Node1.*"));
+    EXPECT_EQ("Node1.Renderable.", PI::literalPrefix("Node1\\.Renderable\\..*"));
+    EXPECT_EQ("Node", PI::literalPrefix("^Node1?\\.Property0"));
+    EXPECT_EQ("", PI::literalPrefix("Node1.*|Node2.*"));
+    EXPECT_EQ("Node", PI::literalPrefix("Node(1|2)\\..*"));
+
+    EXPECT_EQ(6, index.propertiesMatchingRegex("Node1\\..*").size());
+    EXPECT_EQ(2, index.propertiesMatchingRegex("Node(1|2)\\.Property0").size());
+    EXPECT_EQ(40, index.propertiesMatchingRegex(".*Property0").size());
+    EXPECT_EQ(9, index.propertiesMatchingRegex("Node1\\..*|Node2\\.Property.").size());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(PropertyIndexTest, Benchmark) {
+    // 5000 nodes with 20 properties each, 10 directly and 10 in the renderable
+    SyntheticScene scene(5000, 10);
+    openspace::properties::PropertyIndex index;
+
+    using Clock = std::chrono::high_resolution_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    Clock::time_point t0 = Clock::now();
+    index.rebuild(scene.roots);
+    Clock::time_point t1 = Clock::now();
+    ASSERT_EQ(100000, index.size());
+
+    const int nLookups = 10000;
+    int found = 0;
+    for (int i = 0; i < nLookups; ++i) {
+        const std::string uri = "Node" + std::to_string((i * 7919) % 5000) +
+            ".Renderable.Property" + std::to_string(i % 10);
+        found += index.property(uri) ? 1 : 0;
+    }
+    Clock::time_point t2 = Clock::now();
+    ASSERT_EQ(nLookups, found);
+
+    const std::string regex = "Node42\\..*";
+    std::vector<openspace::properties::Property*> indexed =
+        index.propertiesMatchingRegex(regex);
+    Clock::time_point t3 = Clock::now();
+
+    // The previous approach: matching the regex against every fully qualified id
+    std::regex expression(regex, std::regex_constants::optimize);
+    std::vector<openspace::properties::Property*> linear;
+    for (const openspace::properties::PropertyOwner* owner : scene.roots) {
+        for (openspace::properties::Property* p : owner->propertiesRecursive()) {
+            if (std::regex_match(p->fullyQualifiedIdentifier(), expression)) {
+                linear.push_back(p);
+            }
+        }
+    }
+    Clock::time_point t4 = Clock::now();
+    EXPECT_EQ(linear.size(), indexed.size());
+
+    std::cout << "PropertyIndex (5000 nodes, 100000 properties)" << std::endl
+        << "  Rebuild:        " << Ms(t1 - t0).count() << " ms" << std::endl
+        << "  " << nLookups << " lookups: " << Ms(t2 - t1).count() << " ms" << std::endl
+        << "  Regex (index):  " << Ms(t3 - t2).count() << " ms" << std::endl
+        << "  Regex (linear): " << Ms(t4 - t3).count() << " ms" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,239 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/scripting/scriptscheduler.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+    openspace::scripting::ScheduledScript createScript(double time, int id) {
+        openspace::scripting::ScheduledScript script;
+        script.time = time;
+        script.script.forwardScript = "f" + std::to_string(id);
+        script.script.backwardScript = "b" + std::to_string(id);
+        return script;
+    }
+
+    // Reference implementation walking the schedule linearly, as the scheduler used to
+    std::vector<std::string> linearProgress(
+                              const std::vector<openspace::scripting::ScheduledScript>& s,
+                                            size_t& index, double& currentTime,
+                                            double newTime)
+    {
+        std::vector<std::string> result;
+        if (newTime > currentTime) {
+            while (index < s.size() && s[index].time <= newTime) {
+                result.push_back(s[index].script.forwardScript);
+                ++index;
+            }
+        }
+        else {
+            while (index > 0 && s[index - 1].time > newTime) {
+                result.push_back(s[index - 1].script.backwardScript);
+                --index;
+            }
+        }
+        currentTime = newTime;
+        return result;
+    }
+
+    std::vector<std::string> toVector(std::queue<std::string> queue) {
+        std::vector<std::string> result;
+        while (!queue.empty()) {
+            result.push_back(queue.front());
+            queue.pop();
+        }
+        return result;
+    }
+} // namespace
+
+class ScriptSchedulerTest : public testing::Test {};
+
+TEST_F(ScriptSchedulerTest, ForwardAndBackward) {
+    openspace::scripting::ScriptScheduler scheduler;
+    scheduler.addScripts({
+        createScript(3.0, 3), createScript(1.0, 1), createScript(2.0, 2)
+    });
+
+    EXPECT_EQ(
+        std::vector<std::string>({ "f1", "f2" }),
+        toVector(scheduler.progressTo(2.0))
+    );
+    EXPECT_TRUE(scheduler.progressTo(2.5).empty());
+    EXPECT_EQ(std::vector<std::string>({ "f3" }), toVector(scheduler.progressTo(10.0)));
+    EXPECT_EQ(
+        std::vector<std::string>({ "b3", "b2", "b1" }),
+        toVector(scheduler.progressTo(0.0))
+    );
+    EXPECT_EQ(0.0, scheduler.currentTime());
+}
+
+TEST_F(ScriptSchedulerTest, AddScriptsKeepsPosition) {
+    openspace::scripting::ScriptScheduler scheduler;
+    scheduler.addScripts({ createScript(1.0, 1), createScript(3.0, 3) });
+    scheduler.progressTo(2.0);
+
+    // Adding scripts must not trigger anything; scripts in the past are considered run
+    scheduler.addScripts({ createScript(1.5, 15), createScript(2.5, 25) });
+    EXPECT_EQ(
+        std::vector<std::string>({ "b15", "b1" }),
+        toVector(scheduler.progressTo(0.0))
+    );
+    EXPECT_EQ(
+        std::vector<std::string>({ "f1", "f15", "f25", "f3" }),
+        toVector(scheduler.progressTo(5.0))
+    );
+}
+
+TEST_F(ScriptSchedulerTest, SimultaneousScriptsKeepLoadingOrder) {
+    openspace::scripting::ScriptScheduler scheduler;
+    scheduler.addScripts({ createScript(1.0, 1), createScript(1.0, 2) });
+    scheduler.addScripts({ createScript(1.0, 3) });
+
+    EXPECT_EQ(
+        std::vector<std::string>({ "f1", "f2", "f3" }),
+        toVector(scheduler.progressTo(1.0))
+    );
+    EXPECT_EQ(
+        std::vector<std::string>({ "b3", "b2", "b1" }),
+        toVector(scheduler.progressTo(0.5))
+    );
+}
+
+TEST_F(ScriptSchedulerTest, Batched) {
+    openspace::scripting::ScriptScheduler scheduler;
+    scheduler.addScripts({ createScript(1.0, 1), createScript(2.0, 2) });
+
+    using openspace::scripting::ScriptScheduler;
+    EXPECT_EQ(
+        ScriptScheduler::isolatedChunk("f1") + ScriptScheduler::isolatedChunk("f2"),
+        scheduler.progressToBatched(2.0)
+    );
+    EXPECT_EQ("", scheduler.progressToBatched(2.0));
+    EXPECT_EQ(ScriptScheduler::isolatedChunk("b2"), scheduler.progressToBatched(1.5));
+}
+
+TEST_F(ScriptSchedulerTest, IsolatedChunkQuotesTheScript) {
+    using openspace::scripting::ScriptScheduler;
+    EXPECT_NE(std::string::npos, ScriptScheduler::isolatedChunk("f1").find("[[f1]]"));
+
+    // The long bracket level is raised until the script cannot close the string early
+    std::string chunk = ScriptScheduler::isolatedChunk("a = t[b[1]]");
+    EXPECT_NE(std::string::npos, chunk.find("[=[a = t[b[1]]]=]"));
+    chunk = ScriptScheduler::isolatedChunk("s = [[x]] .. [=[y]=]");
+    EXPECT_NE(std::string::npos, chunk.find("[==[s = [[x]] .. [=[y]=]]==]"));
+    chunk = ScriptScheduler::isolatedChunk("x = ']=='");
+    EXPECT_NE(std::string::npos, chunk.find("[[x = ']==']]"));
+    chunk = ScriptScheduler::isolatedChunk("t[a[1]");
+    EXPECT_NE(std::string::npos, chunk.find("[=[t[a[1]]=]"));
+}
+
+TEST_F(ScriptSchedulerTest, RandomScrubbing) {
+    const int nScripts = 100000;
+    const int nSeeks = 1000;
+    const double duration = 1e6;
+
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<double> timeDist(0.0, duration);
+
+    std::vector<openspace::scripting::ScheduledScript> scripts;
+    scripts.reserve(nScripts);
+    for (int i = 0; i < nScripts; ++i) {
+        scripts.push_back(createScript(timeDist(gen), i));
+    }
+
+    openspace::scripting::ScriptScheduler scheduler;
+    scheduler.addScripts(scripts);
+    const std::vector<openspace::scripting::ScheduledScript>& sorted =
+        scheduler.allScripts();
+    ASSERT_EQ(nScripts, sorted.size());
+
+    std::vector<double> seeks(nSeeks);
+    for (double& t : seeks) {
+        t = timeDist(gen);
+    }
+
+    // Verify against the linear reference
+    size_t refIndex = 0;
+    double refTime = -DBL_MAX;
+    for (double t : seeks) {
+        std::vector<std::string> expected = linearProgress(sorted, refIndex, refTime, t);
+        ASSERT_EQ(expected, toVector(scheduler.progressTo(t)));
+    }
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(ScriptSchedulerTest, ScrubbingBenchmark) {
+    const int nScripts = 100000;
+    const int nSeeks = 1000;
+    const double duration = 1e6;
+
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<double> timeDist(0.0, duration);
+
+    std::vector<openspace::scripting::ScheduledScript> scripts;
+    scripts.reserve(nScripts);
+    for (int i = 0; i < nScripts; ++i) {
+        scripts.push_back(createScript(timeDist(gen), i));
+    }
+    openspace::scripting::ScriptScheduler scheduler;
+    scheduler.addScripts(scripts);
+
+    std::vector<double> seeks(nSeeks);
+    for (double& t : seeks) {
+        t = timeDist(gen);
+    }
+
+    // As every seek crosses a quarter of the schedule on average, the time is
+    // dominated by the triggered scripts
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t nBatchBytes = 0;
+    for (double t : seeks) {
+        nBatchBytes += scheduler.progressToBatched(t).size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Short hops inside the schedule only pay for the binary search
+    std::uniform_real_distribution<double> hopDist(-1.0, 1.0);
+    auto hopStart = std::chrono::high_resolution_clock::now();
+    double t = duration / 2.0;
+    size_t nHopScripts = 0;
+    for (int i = 0; i < nSeeks * 100; ++i) {
+        t += hopDist(gen);
+        nHopScripts += scheduler.progressTo(t).size();
+    }
+    auto hopEnd = std::chrono::high_resolution_clock::now();
+
+    std::cout << "ScriptScheduler: " << nScripts << " scripts, " << nSeeks <<
+        " random seeks in " <<
+        std::chrono::duration<double, std::milli>(end - start).count() << " ms (" <<
+        nBatchBytes << " bytes of scripts), " << nSeeks * 100 << " short hops in " <<
+        std::chrono::duration<double, std::milli>(hopEnd - hopStart).count() << " ms (" <<
+        nHopScripts << " scripts)" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,205 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/newhorizons/util/labelreader.h>
+#include <modules/newhorizons/util/linetokenizer.h>
+#include <modules/newhorizons/util/sequenceparser.h>
+
+#include <ghoul/filesystem/filesystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    std::string labelText(int i) {
+        std::string n = std::to_string(i);
+        return
+            "PDS_VERSION_ID               = PDS3\r\n"
+            "TARGET_NAME                  = \"PLUTO\"\r\n"
+            "INSTRUMENT_HOST_NAME         = \"NEW HORIZONS\"\r\n"
+            "INSTRUMENT_ID                = \"LORRI\"\r\n"
+            "DETECTOR_TYPE                = \"CCD\"\r\n"
+            "START_TIME                   = 2015-07-14T10:" + n + "\r\n"
+            "STOP_TIME                    = 2015-07-14T11:" + n + "\r\n"
+            "END\r\n";
+    }
+
+    // Exposes the cache of a SequenceParser
+    class CachingParser : public openspace::SequenceParser {
+    public:
+        using SequenceParser::SourceFile;
+        using SequenceParser::sourceFiles;
+        using SequenceParser::loadCache;
+        using SequenceParser::saveCache;
+
+        bool create() override { return true; }
+
+        std::map<std::string, openspace::ImageSubset>& subsetMap() { return _subsetMap; }
+        std::vector<double>& captureProgression() { return _captureProgression; }
+    };
+} // namespace
+
+class SequenceParserTest : public testing::Test {};
+
+TEST_F(SequenceParserTest, LineTokenizer) {
+    using openspace::LineTokenizer;
+
+    std::string text = "first line\r\n\nthird\nlast";
+    LineTokenizer lines(text.data(), text.size());
+    std::vector<std::string> result;
+    LineTokenizer::Token line;
+    while (lines.next(line)) {
+        result.push_back(line.str());
+    }
+    EXPECT_EQ(std::vector<std::string>({ "first line", "", "third", "last" }), result);
+
+    lines.setPosition(0);
+    ASSERT_TRUE(lines.next(line));
+    EXPECT_TRUE(line == "first line");
+    EXPECT_EQ(5, line.find(' '));
+    EXPECT_EQ(6, line.find("line"));
+    EXPECT_EQ(std::string::npos, line.find("third"));
+    EXPECT_EQ("line", line.substr(6).str());
+    EXPECT_EQ("", line.substr(20, 5).str());
+}
+
+TEST_F(SequenceParserTest, ReadLabel) {
+    openspace::LabelReader reader(6);
+
+    std::vector<openspace::LabelReader::Label> labels;
+    std::string text = labelText(15);
+    reader.readLabel("a.lbl", text.data(), text.size(), labels);
+    ASSERT_EQ(1, labels.size());
+    EXPECT_EQ("a.lbl", labels[0].path);
+    EXPECT_EQ("PLUTO", labels[0].targetName);
+    EXPECT_EQ("NEWHORIZONS", labels[0].instrumentHostName);
+    EXPECT_EQ("LORRI", labels[0].instrumentId);
+    EXPECT_EQ("CCD", labels[0].detectorType);
+    EXPECT_EQ("2015-07-14T10:15", labels[0].startTime);
+    EXPECT_EQ("2015-07-14T11:15", labels[0].stopTime);
+
+    // Without a stop time, not all keywords are found
+    labels.clear();
+    std::string incomplete = text.substr(0, text.find("STOP_TIME"));
+    reader.readLabel("b.lbl", incomplete.data(), incomplete.size(), labels);
+    EXPECT_TRUE(labels.empty());
+}
+
+TEST_F(SequenceParserTest, Cache) {
+    const std::string cacheFile = "sequenceparsertest.cache";
+    const std::string sourceFile = "sequenceparsertest.txt";
+    std::ofstream(sourceFile) << "source";
+
+    CachingParser parser;
+    openspace::Image image;
+    image.timeRange = { 1.0, 2.0 };
+    image.path = "image.png";
+    image.target = "PLUTO";
+    image.activeInstruments = { "NH_LORRI" };
+    parser.subsetMap()["PLUTO"]._subset.push_back(image);
+    parser.subsetMap()["PLUTO"]._range = { 1.0, 2.0 };
+    parser.captureProgression() = { 1.0 };
+
+    std::vector<CachingParser::SourceFile> sources = parser.sourceFiles({ sourceFile });
+    ASSERT_TRUE(parser.saveCache(cacheFile, "settings", sources));
+
+    CachingParser cached;
+    ASSERT_TRUE(cached.loadCache(cacheFile, "settings", sources));
+    ASSERT_EQ(1, cached.subsetMap()["PLUTO"]._subset.size());
+    const openspace::Image& i = cached.subsetMap()["PLUTO"]._subset[0];
+    EXPECT_EQ(2.0, i.timeRange.end);
+    EXPECT_EQ("image.png", i.path);
+    EXPECT_EQ(std::vector<std::string>({ "NH_LORRI" }), i.activeInstruments);
+    EXPECT_EQ(std::vector<double>({ 1.0 }), cached.captureProgression());
+
+    // Different settings or changed sources invalidate the cache
+    EXPECT_FALSE(cached.loadCache(cacheFile, "other settings", sources));
+    std::ofstream(sourceFile) << "changed source";
+    EXPECT_FALSE(
+        cached.loadCache(cacheFile, "settings", parser.sourceFiles({ sourceFile }))
+    );
+
+    std::remove(cacheFile.c_str());
+    std::remove(sourceFile.c_str());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(SequenceParserTest, LabelBenchmark) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    const int nLabels = 50000;
+    const std::string directory = absPath("sequenceparsertest");
+    FileSys.createDirectory(directory, ghoul::filesystem::FileSystem::Recursive::Yes);
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < nLabels; ++i) {
+        paths.push_back(directory + "/label_" + std::to_string(i) + ".lbl");
+        std::ofstream(paths.back(), std::ofstream::binary) << labelText(i % 60);
+    }
+
+    // Line by line, as the LabelParser used to read the files
+    Clock::time_point start = Clock::now();
+    size_t nLinesRead = 0;
+    for (const std::string& path : paths) {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::string read = line.substr(0, line.find_first_of(" "));
+            line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
+            line.erase(std::remove(line.begin(), line.end(), ' '), line.end());
+            line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+            if (read == "TARGET_NAME" || read == "START_TIME") {
+                ++nLinesRead;
+            }
+        }
+    }
+    double streamTime = std::chrono::duration<double>(Clock::now() - start).count();
+    EXPECT_EQ(2 * nLabels, nLinesRead);
+
+    openspace::LabelReader reader(6);
+    start = Clock::now();
+    std::vector<openspace::LabelReader::Label> serial = reader.read(paths, 1);
+    double serialTime = std::chrono::duration<double>(Clock::now() - start).count();
+    EXPECT_EQ(nLabels, serial.size());
+
+    start = Clock::now();
+    std::vector<openspace::LabelReader::Label> parallel = reader.read(paths);
+    double parallelTime = std::chrono::duration<double>(Clock::now() - start).count();
+    ASSERT_EQ(nLabels, parallel.size());
+    EXPECT_EQ(paths.back(), parallel.back().path);
+
+    std::cout << "[          ] " << nLabels << " labels: " << streamTime <<
+        " s line by line, " << serialTime << " s with LabelReader on one thread, " <<
+        parallelTime << " s on all threads" << std::endl;
+
+    for (const std::string& path : paths) {
+        FileSys.deleteFile(path);
+    }
+    FileSys.deleteDirectory(directory);
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,222 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/other/statscollector.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class StatsCollectorTest : public testing::Test {
+protected:
+    struct Contents {
+        std::vector<std::string> intKeys;
+        std::vector<std::string> doubleKeys;
+        std::vector<std::vector<long long>> ints;
+        std::vector<std::vector<double>> doubles;
+    };
+
+    void SetUp() override {
+        std::remove(path.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    static uint32_t readUInt32(std::istream& is) {
+        uint32_t value = 0;
+        is.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+    // Parses the binary format described in statscollector.h
+    static Contents read() {
+        Contents contents;
+        std::ifstream ifs(path, std::ifstream::binary);
+        char magic[8] = {};
+        ifs.read(magic, sizeof(magic));
+        EXPECT_EQ(0, std::memcmp(magic, "OSSTATS1", sizeof(magic)));
+
+        contents.intKeys.resize(readUInt32(ifs));
+        contents.doubleKeys.resize(readUInt32(ifs));
+        for (auto* keys : { &contents.intKeys, &contents.doubleKeys }) {
+            for (std::string& key : *keys) {
+                key.resize(readUInt32(ifs));
+                ifs.read(&key[0], key.size());
+            }
+        }
+
+        std::vector<long long> ints(contents.intKeys.size());
+        std::vector<double> doubles(contents.doubleKeys.size());
+        while (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(ints.data()),
+                ints.size() * sizeof(long long));
+            ifs.read(reinterpret_cast<char*>(doubles.data()),
+                doubles.size() * sizeof(double));
+            EXPECT_TRUE(ifs.good());
+            contents.ints.push_back(ints);
+            contents.doubles.push_back(doubles);
+        }
+        return contents;
+    }
+
+    static const std::string path;
+};
+
+const std::string StatsCollectorTest::path = "statscollectortest.bin";
+
+TEST_F(StatsCollectorTest, WritesEveryRecord) {
+    using namespace openspace;
+    const int numRecords = 100;
+    {
+        StatsCollector stats(path, 16);
+        StatsCollector::Key frame = stats.i.addKey("frame");
+        StatsCollector::Key count = stats.i.addKey("count");
+        StatsCollector::Key seconds = stats.d.addKey("seconds");
+        EXPECT_EQ(frame, stats.i.addKey("frame"));
+
+        for (int record = 0; record < numRecords; ++record) {
+            stats.startNewRecord();
+            stats.i[frame] = record;
+            for (int j = 0; j < record % 5; ++j) {
+                stats.i[count]++;
+            }
+            stats.d[seconds] = record * 0.5;
+        }
+        EXPECT_EQ(0u, stats.numDroppedRecords());
+    }
+
+    Contents contents = read();
+    EXPECT_EQ(std::vector<std::string>({ "frame", "count" }), contents.intKeys);
+    EXPECT_EQ(std::vector<std::string>({ "seconds" }), contents.doubleKeys);
+    ASSERT_EQ(size_t(numRecords), contents.ints.size());
+    for (int record = 0; record < numRecords; ++record) {
+        EXPECT_EQ(record, contents.ints[record][0]);
+        EXPECT_EQ(record % 5, contents.ints[record][1]);
+        EXPECT_EQ(record * 0.5, contents.doubles[record][0]);
+    }
+}
+
+TEST_F(StatsCollectorTest, KeysAddedAfterTheFirstRecordAreNotWritten) {
+    using namespace openspace;
+    {
+        StatsCollector stats(path, 1);
+        StatsCollector::Key early = stats.i.addKey("early");
+        stats.startNewRecord();
+        stats.i[early] = 1;
+        stats.startNewRecord();
+        StatsCollector::Key late = stats.i.addKey("late");
+        stats.i[early] = 2;
+        stats.i[late] = 3;
+    }
+
+    Contents contents = read();
+    EXPECT_EQ(std::vector<std::string>({ "early" }), contents.intKeys);
+    ASSERT_EQ(2u, contents.ints.size());
+    EXPECT_EQ(std::vector<long long>({ 2 }), contents.ints[1]);
+}
+
+TEST_F(StatsCollectorTest, DropsRecordsWhenTheRingBufferIsFull) {
+    using namespace openspace;
+    const size_t capacity = 8;
+    {
+        // Records are only written when dumped, so the ring buffer fills up
+        StatsCollector stats(path, 0, StatsCollector::Enabled::Yes, capacity);
+        StatsCollector::Key frame = stats.i.addKey("frame");
+        for (int record = 0; record < 20; ++record) {
+            stats.startNewRecord();
+            stats.i[frame] = record;
+        }
+        EXPECT_EQ(19 - capacity, stats.numDroppedRecords());
+
+        stats.dumpToDisk();
+        stats.startNewRecord();
+        stats.i[frame] = 20;
+        EXPECT_EQ(19 - capacity, stats.numDroppedRecords());
+    }
+
+    Contents contents = read();
+    ASSERT_EQ(capacity + 2, contents.ints.size());
+    for (size_t record = 0; record < capacity; ++record) {
+        EXPECT_EQ(static_cast<long long>(record), contents.ints[record][0]);
+    }
+    EXPECT_EQ(19, contents.ints[capacity][0]);
+    EXPECT_EQ(20, contents.ints[capacity + 1][0]);
+}
+
+TEST_F(StatsCollectorTest, DisabledCollectorWritesNothing) {
+    using namespace openspace;
+    {
+        StatsCollector stats(path, 1, StatsCollector::Enabled::No);
+        EXPECT_FALSE(stats.isEnabled());
+        StatsCollector::Key frame = stats.i.addKey("frame");
+        for (int record = 0; record < 10; ++record) {
+            stats.startNewRecord();
+            stats.i[frame] = record;
+        }
+        stats.dumpToDisk();
+    }
+    EXPECT_FALSE(std::ifstream(path).good());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(StatsCollectorTest, Benchmark) {
+    using namespace openspace;
+    const int numRecords = 200000;
+    const int numKeys = 12;
+    std::chrono::high_resolution_clock::duration duration;
+    size_t numDropped;
+    {
+        StatsCollector stats(path, 1);
+        std::vector<StatsCollector::Key> keys;
+        for (int k = 0; k < numKeys; ++k) {
+            keys.push_back(stats.i.addKey("key " + std::to_string(k)));
+        }
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int record = 0; record < numRecords; ++record) {
+            stats.startNewRecord();
+            for (StatsCollector::Key key : keys) {
+                stats.i[key] += record;
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        duration = t1 - t0;
+        numDropped = stats.numDroppedRecords();
+    }
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(duration).count();
+    std::cout << "[          ] " << numKeys << " keys: " << nanoseconds / numRecords <<
+        " ns per record, " << numDropped << " of " << numRecords <<
+        " records dropped" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,155 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/util/taskgraph.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+class TaskGraphTest : public testing::Test {};
+
+TEST_F(TaskGraphTest, DependencyOrder) {
+    using openspace::TaskGraph;
+
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int value) {
+        return [&, value]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(value);
+        };
+    };
+
+    // Diamond: 0 -> {1, 2} -> 3, and an independent task 4
+    TaskGraph graph;
+    TaskGraph::TaskId a = graph.addTask(record(0));
+    TaskGraph::TaskId b = graph.addTask(record(1), { a });
+    TaskGraph::TaskId c = graph.addTask(record(2), { a });
+    graph.addTask(record(3), { b, c });
+    graph.addTask(record(4));
+    EXPECT_EQ(5, graph.size());
+
+    graph.run(4);
+
+    ASSERT_EQ(5, order.size());
+    auto position = [&](int value) {
+        return std::find(order.begin(), order.end(), value) - order.begin();
+    };
+    EXPECT_LT(position(0), position(1));
+    EXPECT_LT(position(0), position(2));
+    EXPECT_LT(position(1), position(3));
+    EXPECT_LT(position(2), position(3));
+    EXPECT_NE(order.size(), position(4));
+}
+
+TEST_F(TaskGraphTest, Empty) {
+    openspace::TaskGraph graph;
+    graph.run();
+    EXPECT_EQ(0, graph.size());
+}
+
+TEST_F(TaskGraphTest, IndependentTasksRunConcurrently) {
+    using openspace::TaskGraph;
+
+    // Each task waits until all of them have started; this only succeeds if the graph
+    // runs them on separate threads at the same time
+    const int nTasks = 4;
+    std::mutex mutex;
+    std::condition_variable condition;
+    int nArrived = 0;
+    std::atomic<int> nMet(0);
+    TaskGraph graph;
+    for (int i = 0; i < nTasks; ++i) {
+        graph.addTask([&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            ++nArrived;
+            condition.notify_all();
+            bool met = condition.wait_for(lock, std::chrono::seconds(10), [&]() {
+                return nArrived == nTasks;
+            });
+            if (met) {
+                ++nMet;
+            }
+        });
+    }
+    graph.run(nTasks);
+    EXPECT_EQ(nTasks, nArrived);
+    EXPECT_EQ(nTasks, nMet);
+}
+
+TEST_F(TaskGraphTest, ExceptionIsRethrown) {
+    using openspace::TaskGraph;
+
+    std::atomic<int> nExecuted(0);
+    TaskGraph graph;
+    TaskGraph::TaskId failing = graph.addTask([]() {
+        throw std::runtime_error("failure");
+    });
+    graph.addTask([&]() { ++nExecuted; }, { failing });
+    graph.addTask([&]() { ++nExecuted; });
+
+    EXPECT_THROW(graph.run(2), std::runtime_error);
+    // Remaining tasks are executed regardless of the failure
+    EXPECT_EQ(2, nExecuted);
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(TaskGraphTest, LoadBenchmark) {
+    using openspace::TaskGraph;
+    using Clock = std::chrono::high_resolution_clock;
+
+    // Simulates a scene of 64 nodes whose resources take 5 ms each to load, arranged
+    // in chains of four like a planet, its moons and their trails
+    const int nNodes = 64;
+    const int ChainLength = 4;
+    auto load = []() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); };
+
+    auto measure = [&](unsigned int nThreads) {
+        TaskGraph graph;
+        for (int i = 0; i < nNodes; ++i) {
+            if (i % ChainLength == 0)
+                graph.addTask(load);
+            else
+                graph.addTask(load, { static_cast<TaskGraph::TaskId>(i - 1) });
+        }
+        Clock::time_point start = Clock::now();
+        graph.run(nThreads);
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    double serial = measure(1);
+    double parallel = measure(8);
+    std::cout << "[          ] Loading " << nNodes << " nodes: " << serial <<
+        " ms serially, " << parallel << " ms on 8 threads" << std::endl;
+    EXPECT_LT(parallel, serial);
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,126 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/performance/telemetrylayout.h>
+#include <openspace/performance/telemetryreader.h>
+
+#include <cstring>
+#include <thread>
+
+class TelemetryTest : public testing::Test {
+protected:
+    TelemetryTest()
+        : layout(std::make_unique<openspace::performance::TelemetryLayout>())
+    {}
+
+    openspace::performance::TelemetryLayout::ThreadRing& claimRing() {
+        return layout->threads[layout->nThreads.fetch_add(1)];
+    }
+
+    std::unique_ptr<openspace::performance::TelemetryLayout> layout;
+};
+
+TEST_F(TelemetryTest, ReadInOrder) {
+    using namespace openspace::performance;
+    TelemetryLayout::ThreadRing& first = claimRing();
+    TelemetryLayout::ThreadRing& second = claimRing();
+
+    std::strcpy(layout->scopes[0].name, "Scope");
+    layout->nScopes = 1;
+
+    first.push({ 0, 1, 10, 20 });
+    first.push({ 0, 1, 30, 40 });
+    second.push({ 0, 2, 15, 25 });
+
+    TelemetryReader reader(layout.get());
+    std::vector<TelemetryReader::Event> events;
+    ASSERT_EQ(3, reader.read(events));
+    EXPECT_EQ(0, events[0].thread);
+    EXPECT_EQ(10, events[0].begin);
+    EXPECT_EQ(30, events[1].begin);
+    EXPECT_EQ(1, events[2].thread);
+    EXPECT_EQ(2, events[2].frame);
+    EXPECT_EQ("Scope", reader.scopeName(0));
+    EXPECT_EQ("", reader.scopeName(1));
+
+    // Only new events are returned by subsequent reads
+    events.clear();
+    EXPECT_EQ(0, reader.read(events));
+    first.push({ 0, 3, 50, 60 });
+    ASSERT_EQ(1, reader.read(events));
+    EXPECT_EQ(50, events[0].begin);
+    EXPECT_EQ(0, reader.nMissedEvents());
+}
+
+TEST_F(TelemetryTest, Overrun) {
+    using namespace openspace::performance;
+    TelemetryLayout::ThreadRing& ring = claimRing();
+
+    const uint64_t nEvents = TelemetryLayout::NumberEvents + 100;
+    for (uint64_t i = 0; i < nEvents; ++i) {
+        ring.push({ 0, 0, i, i + 1 });
+    }
+
+    TelemetryReader reader(layout.get());
+    std::vector<TelemetryReader::Event> events;
+    // The oldest event is not readable as it is the next one to be overwritten
+    ASSERT_EQ(TelemetryLayout::NumberEvents - 1, reader.read(events));
+    EXPECT_EQ(101, events.front().begin);
+    EXPECT_EQ(nEvents - 1, events.back().begin);
+    EXPECT_EQ(101, reader.nMissedEvents());
+}
+
+TEST_F(TelemetryTest, ConcurrentStreaming) {
+    using namespace openspace::performance;
+    const uint64_t nEvents = 2000000;
+
+    TelemetryLayout::ThreadRing& ring = claimRing();
+    std::thread writer([&ring, nEvents]() {
+        for (uint64_t i = 0; i < nEvents; ++i) {
+            // The end is derived from the begin to detect torn events in the reader
+            ring.push({ static_cast<uint32_t>(i % 7), 0, i, i * 3 + 1 });
+        }
+    });
+
+    TelemetryReader reader(layout.get());
+    std::vector<TelemetryReader::Event> events;
+    uint64_t nRead = 0;
+    uint64_t last = 0;
+    bool valid = true;
+    while (nRead + reader.nMissedEvents() < nEvents) {
+        events.clear();
+        nRead += reader.read(events);
+        for (const TelemetryReader::Event& e : events) {
+            valid &= (e.end == e.begin * 3 + 1) && (e.scope == e.begin % 7);
+            valid &= (last == 0 || e.begin > last);
+            last = e.begin;
+        }
+    }
+    writer.join();
+
+    EXPECT_TRUE(valid);
+    EXPECT_EQ(nEvents, nRead + reader.nMissedEvents());
+}
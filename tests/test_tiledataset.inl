@@ -0,0 +1,186 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/tile/tiledataset.h>
+#include <modules/globebrowsing/tile/tileioresult.h>
+#include <modules/globebrowsing/tile/syntheticpyramid.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+class TileDatasetTest : public testing::Test {
+protected:
+    // A small global RGB GeoTIFF pyramid with four overview levels
+    static void SetUpTestCase() {
+        openspace::SyntheticPyramid::create(path, {});
+    }
+
+    static void TearDownTestCase() {
+        std::remove(path.c_str());
+    }
+
+    static openspace::TileDataset::Configuration configuration(bool prefetchSiblings) {
+        openspace::TileDataset::Configuration config;
+        config.doPreProcessing = false;
+        config.minimumTilePixelSize = 512;
+        config.prefetchSiblings = prefetchSiblings;
+        return config;
+    }
+
+    struct LevelRead {
+        std::vector<std::vector<char>> tiles;
+        openspace::TileDataset::ReadStatistics statistics;
+        double seconds;
+        size_t numBytes;
+    };
+
+    // Reads all tiles of a level in the order the chunk tree would request them
+    static LevelRead readLevel(bool prefetchSiblings, int level) {
+        openspace::TileDataset dataset(path, configuration(prefetchSiblings));
+
+        LevelRead levelRead = {};
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int y = 0; y < (1 << (level - 1)); ++y) {
+            for (int x = 0; x < (1 << level); ++x) {
+                auto result = dataset.readTileData(openspace::ChunkIndex(x, y, level));
+                EXPECT_EQ(CE_None, result->error);
+                levelRead.tiles.emplace_back(
+                    result->imageData, result->imageData + result->nBytesImageData);
+                levelRead.numBytes += result->nBytesImageData;
+                delete[] result->imageData;
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        levelRead.seconds = std::chrono::duration<double>(t1 - t0).count();
+        levelRead.statistics = dataset.readStatistics();
+        return levelRead;
+    }
+
+    static const std::string path;
+};
+
+const std::string TileDatasetTest::path = "tiledatasettest.tif";
+
+TEST_F(TileDatasetTest, SiblingReadsMatchSeparateReads) {
+    for (int level = 1; level <= 3; ++level) {
+        LevelRead separate = readLevel(false, level);
+        LevelRead combined = readLevel(true, level);
+
+        ASSERT_EQ(separate.tiles.size(), combined.tiles.size());
+        for (size_t i = 0; i < separate.tiles.size(); ++i) {
+            EXPECT_EQ(separate.tiles[i], combined.tiles[i]) << "Tile " << i;
+        }
+        EXPECT_EQ(0, separate.statistics.numPrefetchedTiles);
+        EXPECT_EQ(combined.statistics.numPrefetchedTiles,
+            combined.statistics.numPrefetchHits);
+        // Tiles at the edges of the dataset wrap around and are always read
+        // separately, only the deepest level has siblings that are all inside
+        if (level < 3) {
+            EXPECT_LE(combined.statistics.numRasterIOCalls,
+                separate.statistics.numRasterIOCalls);
+        }
+        else {
+            EXPECT_LT(combined.statistics.numRasterIOCalls,
+                separate.statistics.numRasterIOCalls);
+        }
+    }
+}
+
+TEST_F(TileDatasetTest, InterleavedReadKeepsBandsApart) {
+    // Four bands, so that the pixels are not laid out like the RGB pyramid. Band b of
+    // the pixel (x, y) holds (x * b + y * 7) % 251
+    const std::string multiBandPath = "tiledatasettest_multiband.tif";
+    openspace::SyntheticPyramid::Description description;
+    description.numBands = 4;
+    openspace::SyntheticPyramid::create(multiBandPath, description);
+    {
+        openspace::TileDataset dataset(multiBandPath, configuration(false));
+        auto result = dataset.readTileData(openspace::ChunkIndex(3, 1, 3));
+        ASSERT_EQ(CE_None, result->error);
+
+        // A tile inside the dataset is read with a single call for all bands
+        EXPECT_EQ(1, dataset.readStatistics().numRasterIOCalls);
+
+        const glm::uvec3 size = result->dimensions;
+        ASSERT_EQ(size_t(size.x) * size.y * 4, result->nBytesImageData);
+        auto mod = [](int v) { return ((v % 251) + 251) % 251; };
+        auto value = [&](unsigned int x, unsigned int y, int band) {
+            size_t i = (size_t(y) * size.x + x) * 4 + band - 1;
+            return static_cast<int>(static_cast<unsigned char>(result->imageData[i]));
+        };
+        // The x term of the pattern, which is the same between all consecutive bands
+        auto xTerm = [&](unsigned int x, unsigned int y) {
+            return mod(value(x, y, 2) - value(x, y, 1));
+        };
+        // The y term of the pattern
+        auto yTerm = [&](unsigned int x, unsigned int y) {
+            return mod(2 * value(x, y, 1) - value(x, y, 2));
+        };
+
+        const int step = mod(xTerm(1, 0) - xTerm(0, 0));
+        EXPECT_NE(0, step);
+        for (unsigned int y = 0; y < size.y; ++y) {
+            for (unsigned int x = 0; x < size.x; ++x) {
+                ASSERT_EQ(xTerm(x, y), mod(value(x, y, 3) - value(x, y, 2))) <<
+                    "Pixel " << x << ", " << y;
+                ASSERT_EQ(xTerm(x, y), mod(value(x, y, 4) - value(x, y, 3))) <<
+                    "Pixel " << x << ", " << y;
+                if (x > 0) {
+                    ASSERT_EQ(step, mod(xTerm(x, y) - xTerm(x - 1, y))) <<
+                        "Pixel " << x << ", " << y;
+                }
+                // The lines are stored bottom to top
+                if (y > 0) {
+                    ASSERT_EQ(mod(-7 * step), mod(yTerm(x, y) - yTerm(x, y - 1))) <<
+                        "Pixel " << x << ", " << y;
+                }
+            }
+        }
+        delete[] result->imageData;
+    }
+    std::remove(multiBandPath.c_str());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(TileDatasetTest, Benchmark) {
+    for (int level = 1; level <= 3; ++level) {
+        LevelRead separate = readLevel(false, level);
+        LevelRead combined = readLevel(true, level);
+
+        auto megabytesPerSecond = [](const LevelRead& levelRead) {
+            return levelRead.numBytes / (1024.0 * 1024.0) / levelRead.seconds;
+        };
+        std::cout << "[          ] Level " << level << ", " << separate.tiles.size() <<
+            " tiles: " << separate.statistics.numRasterIOCalls << " RasterIO calls, " <<
+            megabytesPerSecond(separate) << " MB/s separately; " <<
+            combined.statistics.numRasterIOCalls << " RasterIO calls, " <<
+            megabytesPerSecond(combined) << " MB/s with sibling reads" << std::endl;
+    }
+}
+#endif // OPENSPACE_BENCHMARKS
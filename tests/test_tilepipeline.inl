@@ -0,0 +1,253 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/tile/asynctilereader.h>
+#include <modules/globebrowsing/tile/simulatedtransfertiledataset.h>
+#include <modules/globebrowsing/tile/syntheticpyramid.h>
+#include <modules/globebrowsing/tile/tiledataset.h>
+#include <modules/globebrowsing/tile/tileioresult.h>
+#include <modules/globebrowsing/other/lrucache.h>
+#include <modules/globebrowsing/other/threadpool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Replays a recorded camera path against the asynchronous tile pipeline. Every frame
+ * requests the tiles the chunk tree would use around the camera, the same way
+ * CachingTileProvider does, but keeps the results on the CPU so that no OpenGL context
+ * is needed. The tiles are read from a local synthetic pyramid with a simulated
+ * latency and bandwidth, so the results are reproducible without a network. As the
+ * replay sleeps between frames and reads, it is only part of the benchmarks.
+ */
+class TilePipelineTest : public testing::Test {
+protected:
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct CameraKeyframe {
+        int frame;
+        double latitude; // degrees
+        double longitude; // degrees
+        double level;
+    };
+
+    struct Report {
+        std::vector<double> latencies; // seconds
+        size_t maxQueueDepth;
+        double meanQueueDepth;
+        size_t numLookups;
+        size_t numCacheHits;
+        size_t numRemainingRequests;
+        openspace::TileDataset::ReadStatistics statistics;
+
+        double latencyPercentile(double p) const {
+            if (latencies.empty()) {
+                return 0.0;
+            }
+            std::vector<double> sorted = latencies;
+            std::sort(sorted.begin(), sorted.end());
+            size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+            return sorted[i];
+        }
+
+        double cacheHitRate() const {
+            return numLookups > 0 ? static_cast<double>(numCacheHits) / numLookups : 0.0;
+        }
+    };
+
+    static void SetUpTestCase() {
+        openspace::SyntheticPyramid::create(path, {});
+    }
+
+    static void TearDownTestCase() {
+        std::remove(path.c_str());
+    }
+
+    static openspace::TileDataset::Configuration configuration(bool prefetchSiblings) {
+        openspace::TileDataset::Configuration config;
+        config.doPreProcessing = false;
+        config.minimumTilePixelSize = 256;
+        config.prefetchSiblings = prefetchSiblings;
+        return config;
+    }
+
+    // Approaches a point from orbit, pans along the surface and zooms out again
+    static std::vector<CameraKeyframe> cameraPath() {
+        return {
+            {   0,  60.0, -120.0, 1.0 },
+            {  60,  45.0,  -60.0, 3.0 },
+            { 120,  30.0,   10.0, 4.0 },
+            { 180,  10.0,   80.0, 4.0 },
+            { 240, -20.0,  150.0, 2.0 },
+            { 300, -40.0, -170.0, 1.0 }
+        };
+    }
+
+    static CameraKeyframe interpolate(const std::vector<CameraKeyframe>& path,
+        int frame)
+    {
+        for (size_t i = 1; i < path.size(); ++i) {
+            if (frame <= path[i].frame) {
+                const CameraKeyframe& a = path[i - 1];
+                const CameraKeyframe& b = path[i];
+                double t = static_cast<double>(frame - a.frame) / (b.frame - a.frame);
+                return {
+                    frame,
+                    a.latitude + t * (b.latitude - a.latitude),
+                    a.longitude + t * (b.longitude - a.longitude),
+                    a.level + t * (b.level - a.level)
+                };
+            }
+        }
+        return path.back();
+    }
+
+    // The tiles around the camera at its level and the ancestors of the closest one,
+    // which are used while the higher resolution tiles are loading
+    static std::vector<openspace::ChunkIndex> desiredChunks(const CameraKeyframe& camera,
+        int maxLevel)
+    {
+        using namespace openspace;
+        int level = std::min(static_cast<int>(camera.level + 0.5), maxLevel);
+        Geodetic2 position(camera.latitude * M_PI / 180.0,
+            camera.longitude * M_PI / 180.0);
+        ChunkIndex center(position, level);
+
+        std::vector<ChunkIndex> chunks;
+        int numX = 1 << level;
+        int numY = std::max(1, numX / 2);
+        for (int dy = -1; dy <= 1; ++dy) {
+            int y = center.y + dy;
+            if (y < 0 || y >= numY) {
+                continue;
+            }
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = (center.x + dx + numX) % numX;
+                chunks.push_back(ChunkIndex(x, y, level));
+            }
+        }
+        for (ChunkIndex parent = center; parent.level > 1; ) {
+            parent = parent.parent();
+            chunks.push_back(parent);
+        }
+        return chunks;
+    }
+
+    static Report replay(bool prefetchSiblings, size_t cacheSize) {
+        using namespace openspace;
+        auto tileDataset = std::make_shared<SimulatedTransferTileDataset>(path,
+            configuration(prefetchSiblings), latency, bandwidth);
+        AsyncTileDataProvider provider(tileDataset, std::make_shared<ThreadPool>(1));
+        LRUCache<ChunkHashKey, size_t> tileCache(cacheSize);
+        std::unordered_map<ChunkHashKey, Clock::time_point> requestTimes;
+
+        Report report = {};
+        auto receiveTiles = [&]() {
+            auto now = Clock::now();
+            for (auto tileIOResult : provider.getTileIOResults()) {
+                ChunkHashKey key = tileIOResult->chunkIndex.hashKey();
+                report.latencies.push_back(
+                    std::chrono::duration<double>(now - requestTimes[key]).count());
+                requestTimes.erase(key);
+                tileCache.put(key, tileIOResult->nBytesImageData);
+                delete[] tileIOResult->imageData;
+            }
+        };
+
+        std::vector<CameraKeyframe> path = cameraPath();
+        int maxLevel = tileDataset->maxChunkLevel();
+        size_t sumQueueDepth = 0;
+        for (int frame = 0; frame <= path.back().frame; ++frame) {
+            receiveTiles();
+            for (const ChunkIndex& chunkIndex : desiredChunks(interpolate(path, frame),
+                maxLevel))
+            {
+                report.numLookups++;
+                if (tileCache.exist(chunkIndex.hashKey())) {
+                    report.numCacheHits++;
+                }
+                else if (provider.enqueueTileIO(chunkIndex)) {
+                    requestTimes[chunkIndex.hashKey()] = Clock::now();
+                }
+            }
+            size_t queueDepth = provider.numEnqueuedRequests();
+            report.maxQueueDepth = std::max(report.maxQueueDepth, queueDepth);
+            sumQueueDepth += queueDepth;
+            std::this_thread::sleep_for(std::chrono::milliseconds(4));
+        }
+        report.meanQueueDepth = static_cast<double>(sumQueueDepth) /
+            (path.back().frame + 1);
+
+        // Let the remaining requests finish so that every request has a latency
+        auto deadline = Clock::now() + std::chrono::seconds(30);
+        while (provider.numEnqueuedRequests() > 0 && Clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(4));
+            receiveTiles();
+        }
+        report.numRemainingRequests = provider.numEnqueuedRequests();
+        report.statistics = tileDataset->readStatistics();
+        return report;
+    }
+
+    static const std::string path;
+    static const double latency;
+    static const double bandwidth;
+};
+
+const std::string TilePipelineTest::path = "tilepipelinetest.tif";
+const double TilePipelineTest::latency = 0.002;
+const double TilePipelineTest::bandwidth = 64.0 * 1024.0 * 1024.0;
+
+TEST_F(TilePipelineTest, Benchmark) {
+    for (bool prefetchSiblings : { false, true }) {
+        Report report = replay(prefetchSiblings, 64);
+        EXPECT_EQ(0u, report.numRemainingRequests);
+        ASSERT_FALSE(report.latencies.empty());
+        if (!prefetchSiblings) {
+            // Prefetched siblings are returned without another read
+            EXPECT_GE(report.latencyPercentile(0.0), latency);
+        }
+        EXPECT_GT(report.statistics.numBytesRead, 0u);
+
+        std::cout << "[          ] " <<
+            (prefetchSiblings ? "With" : "Without") << " sibling reads: " <<
+            report.latencies.size() << " tiles, latency p50 " <<
+            report.latencyPercentile(0.5) * 1000.0 << " ms, p90 " <<
+            report.latencyPercentile(0.9) * 1000.0 << " ms, p99 " <<
+            report.latencyPercentile(0.99) * 1000.0 << " ms" << std::endl;
+        std::cout << "[          ] Queue depth mean " << report.meanQueueDepth <<
+            ", max " << report.maxQueueDepth << "; cache hit rate " <<
+            report.cacheHitRate() * 100.0 << " %; " <<
+            report.statistics.numRasterIOCalls << " RasterIO calls, " <<
+            report.statistics.numBytesRead / (1024.0 * 1024.0) << " MB read" <<
+            std::endl;
+    }
+}
@@ -0,0 +1,272 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/tile/tileprocessor.h>
+#include <modules/globebrowsing/tile/tileioresult.h>
+#include <modules/globebrowsing/tile/tiledataset.h>
+#include <modules/globebrowsing/tile/tiledatatype.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+class TileProcessorTest : public testing::Test {
+protected:
+    static openspace::TileDataLayout layout(GDALDataType gdalType, size_t numRasters) {
+        using namespace openspace;
+        TileDataLayout dataLayout;
+        dataLayout.gdalType = gdalType;
+        dataLayout.glType = TileDataType::getOpenGLDataType(gdalType);
+        dataLayout.numRasters = numRasters;
+        dataLayout.bytesPerDatum = TileDataType::numberOfBytes(gdalType);
+        dataLayout.bytesPerPixel = dataLayout.bytesPerDatum * numRasters;
+        dataLayout.textureFormat =
+            TileDataType::getTextureFormat(static_cast<int>(numRasters), gdalType);
+        return dataLayout;
+    }
+
+    static std::vector<char> randomBytes(size_t n) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> distribution(0, 255);
+        std::vector<char> bytes(n);
+        for (char& byte : bytes) {
+            byte = static_cast<char>(distribution(generator));
+        }
+        return bytes;
+    }
+
+    // The rounding of two nested averages, which the processor uses for bytes
+    static std::vector<unsigned char> referenceDownsample(const std::vector<char>& src,
+        const glm::uvec2& size, size_t numChannels)
+    {
+        glm::uvec2 dstSize = openspace::TileProcessor::mipMapSize(size, 1);
+        std::vector<unsigned char> dst(size_t(dstSize.x) * dstSize.y * numChannels);
+        auto at = [&](unsigned int x, unsigned int y, size_t c) {
+            x = std::min(x, size.x - 1);
+            y = std::min(y, size.y - 1);
+            size_t i = (size_t(y) * size.x + x) * numChannels + c;
+            return static_cast<unsigned char>(src[i]);
+        };
+        for (unsigned int y = 0; y < dstSize.y; ++y) {
+            for (unsigned int x = 0; x < dstSize.x; ++x) {
+                for (size_t c = 0; c < numChannels; ++c) {
+                    int ac = (at(2 * x, 2 * y, c) + at(2 * x, 2 * y + 1, c) + 1) >> 1;
+                    int bd =
+                        (at(2 * x + 1, 2 * y, c) + at(2 * x + 1, 2 * y + 1, c) + 1) >> 1;
+                    dst[(size_t(y) * dstSize.x + x) * numChannels + c] =
+                        static_cast<unsigned char>((ac + bd + 1) >> 1);
+                }
+            }
+        }
+        return dst;
+    }
+};
+
+TEST_F(TileProcessorTest, OutputLayout) {
+    using namespace openspace;
+    TileProcessor::Configuration config;
+
+    TileProcessor rgbBytes(layout(GDT_Byte, 3), config);
+    EXPECT_EQ(4u, rgbBytes.outputLayout().numRasters);
+    EXPECT_EQ(4u, rgbBytes.outputLayout().bytesPerPixel);
+    EXPECT_EQ(GLuint(GL_RGBA8), rgbBytes.outputLayout().textureFormat.glFormat);
+
+    TileProcessor doubles(layout(GDT_Float64, 1), config);
+    EXPECT_EQ(GDT_Float32, doubles.outputLayout().gdalType);
+    EXPECT_EQ(GLuint(GL_FLOAT), doubles.outputLayout().glType);
+    EXPECT_EQ(4u, doubles.outputLayout().bytesPerPixel);
+    EXPECT_EQ(GLuint(GL_R32F), doubles.outputLayout().textureFormat.glFormat);
+
+    // Integer textures are not expanded, as their alpha would not read as one
+    TileProcessor rgbShorts(layout(GDT_UInt16, 3), config);
+    EXPECT_EQ(3u, rgbShorts.outputLayout().numRasters);
+
+    config.expandToFourChannels = false;
+    TileProcessor unexpanded(layout(GDT_Byte, 3), config);
+    EXPECT_EQ(3u, unexpanded.outputLayout().numRasters);
+}
+
+TEST_F(TileProcessorTest, ConvertDoubleToFloat) {
+    std::vector<double> src = { 0.0, -1.5, 3.25, 1e10, -1e-10, 123.456, 7.0 };
+    std::vector<float> dst(src.size());
+    openspace::TileProcessor::convertDoubleToFloat(src.data(), dst.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i) {
+        EXPECT_EQ(static_cast<float>(src[i]), dst[i]);
+    }
+}
+
+TEST_F(TileProcessorTest, ExpandToFourChannels) {
+    const size_t numPixels = 5;
+    std::vector<char> src = randomBytes(numPixels * 3);
+    std::vector<char> dst(numPixels * 4);
+    const char alpha = static_cast<char>(255);
+    openspace::TileProcessor::expandToFourChannels(
+        src.data(), dst.data(), numPixels, 1, &alpha);
+    for (size_t i = 0; i < numPixels; ++i) {
+        EXPECT_EQ(src[i * 3 + 0], dst[i * 4 + 0]);
+        EXPECT_EQ(src[i * 3 + 1], dst[i * 4 + 1]);
+        EXPECT_EQ(src[i * 3 + 2], dst[i * 4 + 2]);
+        EXPECT_EQ(alpha, dst[i * 4 + 3]);
+    }
+
+    std::vector<float> floatSrc = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f };
+    std::vector<float> floatDst(8);
+    const float floatAlpha = 1.f;
+    openspace::TileProcessor::expandToFourChannels(
+        reinterpret_cast<const char*>(floatSrc.data()),
+        reinterpret_cast<char*>(floatDst.data()), 2, sizeof(float),
+        reinterpret_cast<const char*>(&floatAlpha));
+    std::vector<float> expected = { 0.1f, 0.2f, 0.3f, 1.f, 0.4f, 0.5f, 0.6f, 1.f };
+    EXPECT_EQ(expected, floatDst);
+}
+
+TEST_F(TileProcessorTest, DownsampleMatchesReference) {
+    using namespace openspace;
+    // Odd sizes and sizes of one cover the pixels outside of the vectorized loop
+    std::vector<glm::uvec2> sizes = {
+        glm::uvec2(516, 516), glm::uvec2(129, 67), glm::uvec2(1, 9), glm::uvec2(9, 1),
+        glm::uvec2(2, 2), glm::uvec2(1, 1)
+    };
+    for (size_t numChannels : { 1, 3, 4 }) {
+        TileDataLayout dataLayout = layout(GDT_Byte, numChannels);
+        for (const glm::uvec2& size : sizes) {
+            std::vector<char> src =
+                randomBytes(size_t(size.x) * size.y * numChannels);
+            glm::uvec2 dstSize = TileProcessor::mipMapSize(size, 1);
+            std::vector<char> dst(size_t(dstSize.x) * dstSize.y * numChannels);
+            TileProcessor::downsample(src.data(), size, dst.data(), dataLayout);
+
+            std::vector<unsigned char> expected =
+                referenceDownsample(src, size, numChannels);
+            ASSERT_EQ(expected.size(), dst.size());
+            for (size_t i = 0; i < dst.size(); ++i) {
+                ASSERT_EQ(expected[i], static_cast<unsigned char>(dst[i])) <<
+                    "Size " << size.x << "x" << size.y << ", " << numChannels <<
+                    " channels, byte " << i;
+            }
+        }
+    }
+}
+
+TEST_F(TileProcessorTest, ProcessExpandsAndGeneratesMipMaps) {
+    using namespace openspace;
+    TileProcessor::Configuration config;
+    config.generateMipMaps = true;
+    TileProcessor processor(layout(GDT_Byte, 3), config);
+
+    const glm::uvec2 size(20, 12);
+    std::vector<char> src = randomBytes(size_t(size.x) * size.y * 3);
+    TileIOResult result;
+    result.dimensions = glm::uvec3(size.x, size.y, 1);
+    result.nBytesImageData = src.size();
+    result.imageData = new char[src.size()];
+    std::memcpy(result.imageData, src.data(), src.size());
+
+    processor.process(result);
+
+    EXPECT_EQ(size_t(size.x) * size.y * 4, result.nBytesImageData);
+    EXPECT_EQ(src[3], result.imageData[4]);
+    EXPECT_EQ(static_cast<char>(255), result.imageData[7]);
+
+    ASSERT_EQ(size_t(TileProcessor::numMipMapLevels(size) - 1), result.mipMapLevels.size());
+    EXPECT_EQ(4u, result.mipMapLevels.size());
+    EXPECT_EQ(10u * 6 * 4, result.mipMapLevels[0].size());
+    EXPECT_EQ(1u * 1 * 4, result.mipMapLevels.back().size());
+    delete[] result.imageData;
+}
+
+TEST_F(TileProcessorTest, ProcessLeavesFailedReadsUntouched) {
+    using namespace openspace;
+    TileProcessor processor(layout(GDT_Byte, 3), TileProcessor::Configuration());
+
+    TileIOResult result;
+    result.dimensions = glm::uvec3(4, 4, 1);
+    result.nBytesImageData = 4 * 4 * 3;
+    result.imageData = new char[result.nBytesImageData];
+    result.error = CE_Failure;
+    char* imageData = result.imageData;
+
+    processor.process(result);
+
+    EXPECT_EQ(imageData, result.imageData);
+    EXPECT_EQ(4u * 4 * 3, result.nBytesImageData);
+    delete[] result.imageData;
+}
+
+TEST_F(TileProcessorTest, StageTimesAreTakenOnce) {
+    using namespace openspace;
+    using Stage = TileStageTimes::Stage;
+    TileStageTimes providerTimes;
+    providerTimes.add(Stage::Read, std::chrono::microseconds(5));
+    providerTimes.add(Stage::Read, std::chrono::microseconds(7));
+    providerTimes.add(Stage::Upload, std::chrono::microseconds(3));
+
+    TileStageTimes globeTimes;
+    globeTimes.add(Stage::Read, std::chrono::microseconds(1));
+    providerTimes.takeInto(globeTimes);
+
+    EXPECT_EQ(13, globeTimes.take(Stage::Read));
+    EXPECT_EQ(0, globeTimes.take(Stage::Convert));
+    EXPECT_EQ(3, globeTimes.take(Stage::Upload));
+    EXPECT_EQ(0, globeTimes.take(Stage::Read));
+    EXPECT_EQ(0, providerTimes.take(Stage::Read));
+    EXPECT_EQ(0, providerTimes.take(Stage::Upload));
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(TileProcessorTest, Benchmark) {
+    using namespace openspace;
+    const glm::uvec2 size(516, 516);
+    const size_t numPixels = size_t(size.x) * size.y;
+    const int numRepetitions = 20;
+    std::vector<char> rgb = randomBytes(numPixels * 3);
+    std::vector<char> rgba(numPixels * 4);
+    std::vector<char> mipMap(numPixels);
+    const char alpha = static_cast<char>(255);
+    TileDataLayout rgbaLayout = layout(GDT_Byte, 4);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < numRepetitions; ++i) {
+        TileProcessor::expandToFourChannels(
+            rgb.data(), rgba.data(), numPixels, 1, &alpha);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < numRepetitions; ++i) {
+        TileProcessor::downsample(rgba.data(), size, mipMap.data(), rgbaLayout);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    auto megapixelsPerSecond = [&](std::chrono::high_resolution_clock::duration d) {
+        double seconds = std::chrono::duration<double>(d).count();
+        return numPixels * numRepetitions / 1e6 / seconds;
+    };
+    std::cout << "[          ] RGB to RGBA: " << megapixelsPerSecond(t1 - t0) <<
+        " Mpixels/s, RGBA mip map: " << megapixelsPerSecond(t2 - t1) <<
+        " Mpixels/s" << std::endl;
+}
+#endif // OPENSPACE_BENCHMARKS
@@ -0,0 +1,113 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/tile/tilereadplanner.h>
+
+#include <vector>
+
+class TileReadPlannerTest : public testing::Test {
+protected:
+    using Planner = openspace::TileReadPlanner;
+    using PixelRegion = openspace::PixelRegion;
+    using PixelCoordinate = openspace::PixelCoordinate;
+    using PixelRange = openspace::PixelRange;
+
+    // The read regions of the four children of a chunk with 16 x 16 pixel tiles,
+    // padded by two pixels on every side like TileDataset::padding
+    static std::vector<Planner::Request> siblings(int overview) {
+        std::vector<Planner::Request> requests;
+        for (int q = 0; q < 4; ++q) {
+            PixelCoordinate start(32 + 16 * (q % 2) - 2, 32 + 16 * (q / 2) - 2);
+            requests.push_back({ overview, PixelRegion(start, PixelRange(20, 20)) });
+        }
+        return requests;
+    }
+
+    // A buffer with lines stored bottom to top where each pixel holds its coordinates
+    static std::vector<char> image(const PixelRegion& region) {
+        std::vector<char> pixels(region.area() * 2);
+        for (int y = 0; y < region.numPixels.y; ++y) {
+            int line = region.numPixels.y - 1 - y;
+            for (int x = 0; x < region.numPixels.x; ++x) {
+                pixels[2 * (line * region.numPixels.x + x)] = region.start.x + x;
+                pixels[2 * (line * region.numPixels.x + x) + 1] = region.start.y + y;
+            }
+        }
+        return pixels;
+    }
+
+    const PixelRegion bounds = PixelRegion(PixelCoordinate(0, 0), PixelRange(128, 128));
+};
+
+TEST_F(TileReadPlannerTest, CombinesSiblings) {
+    std::vector<Planner::Read> reads = Planner::plan(siblings(1), bounds);
+
+    ASSERT_EQ(1, reads.size());
+    EXPECT_EQ(1, reads[0].overview);
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 2, 3 }), reads[0].requests);
+    EXPECT_TRUE(reads[0].region.equals(
+        PixelRegion(PixelCoordinate(30, 30), PixelRange(36, 36))));
+}
+
+TEST_F(TileReadPlannerTest, KeepsOverviewsAndDistantRegionsApart) {
+    std::vector<Planner::Request> requests = siblings(1);
+    requests[1].overview = 2;
+    // Far away from the others, a combined read would mostly read unused pixels
+    requests[3].region.start = PixelCoordinate(100, 100);
+
+    std::vector<Planner::Read> reads = Planner::plan(requests, bounds);
+
+    ASSERT_EQ(3, reads.size());
+    EXPECT_EQ(std::vector<size_t>({ 0, 2 }), reads[0].requests);
+    EXPECT_EQ(std::vector<size_t>({ 1 }), reads[1].requests);
+    EXPECT_EQ(std::vector<size_t>({ 3 }), reads[2].requests);
+}
+
+TEST_F(TileReadPlannerTest, DoesNotCombineRegionsOutsideBounds) {
+    std::vector<Planner::Request> requests = siblings(0);
+    // Reads wrapping around the edge of the dataset are done separately
+    requests[2].region.start = PixelCoordinate(-2, 30);
+
+    std::vector<Planner::Read> reads = Planner::plan(requests, bounds);
+
+    ASSERT_EQ(2, reads.size());
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 3 }), reads[0].requests);
+    EXPECT_EQ(std::vector<size_t>({ 2 }), reads[1].requests);
+}
+
+TEST_F(TileReadPlannerTest, SlicesMatchSeparateReads) {
+    std::vector<Planner::Request> requests = siblings(0);
+    std::vector<Planner::Read> reads = Planner::plan(requests, bounds);
+    ASSERT_EQ(1, reads.size());
+
+    std::vector<char> combined = image(reads[0].region);
+    for (const Planner::Request& request : requests) {
+        std::vector<char> slice(request.region.area() * 2);
+        Planner::copySubregion(
+            combined.data(), reads[0].region, slice.data(), request.region, 2);
+        EXPECT_EQ(image(request.region), slice);
+    }
+}
@@ -0,0 +1,127 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/tile/tiletexturepool.h>
+
+class TileTexturePoolTest : public testing::Test {
+protected:
+    using Allocator = openspace::TileTextureLayerAllocator;
+
+    static openspace::TileTextureFormat format(glm::uvec2 size, bool mipMapped) {
+        return { GL_UNSIGNED_BYTE, GL_RGBA8, GL_RGBA, size, mipMapped };
+    }
+};
+
+TEST_F(TileTexturePoolTest, FormatSizeIncludesMipMaps) {
+    EXPECT_EQ(1, format(glm::uvec2(4, 4), false).numMipMapLevels());
+    EXPECT_EQ(4 * 4 * 4, format(glm::uvec2(4, 4), false).numBytes());
+    // 4x4, 2x2 and 1x1 levels
+    EXPECT_EQ(3, format(glm::uvec2(4, 4), true).numMipMapLevels());
+    EXPECT_EQ((16 + 4 + 1) * 4, format(glm::uvec2(4, 4), true).numBytes());
+    // 4x2, 2x1 and 1x1 levels
+    openspace::TileTextureFormat red = { GL_FLOAT, GL_R32F, GL_RED, glm::uvec2(4, 2),
+        true };
+    EXPECT_EQ(4, red.bytesPerPixel());
+    EXPECT_EQ((8 + 2 + 1) * 4, red.numBytes());
+}
+
+TEST_F(TileTexturePoolTest, UnsizedFormatsAreSized) {
+    openspace::TileTextureFormat unsized = { GL_UNSIGNED_BYTE, GL_RGB, GL_RGB,
+        glm::uvec2(4, 4), false };
+    EXPECT_EQ(GL_RGB8, unsized.sizedInternalFormat());
+    unsized = { GL_FLOAT, GL_RED, GL_RED, glm::uvec2(4, 4), false };
+    EXPECT_EQ(GL_R32F, unsized.sizedInternalFormat());
+    EXPECT_EQ(GL_RGBA8, format(glm::uvec2(4, 4), false).sizedInternalFormat());
+}
+
+TEST_F(TileTexturePoolTest, AllocatesLowestFreeLayer) {
+    Allocator allocator(4);
+    bool isNewPage;
+    Allocator::Location a = allocator.allocate(isNewPage);
+    EXPECT_TRUE(isNewPage);
+    Allocator::Location b = allocator.allocate(isNewPage);
+    EXPECT_FALSE(isNewPage);
+    EXPECT_EQ(0, a.page);
+    EXPECT_EQ(0, a.layer);
+    EXPECT_EQ(0, b.page);
+    EXPECT_EQ(1, b.layer);
+
+    EXPECT_FALSE(allocator.free(a));
+    Allocator::Location c = allocator.allocate(isNewPage);
+    EXPECT_FALSE(isNewPage);
+    EXPECT_EQ(0, c.page);
+    EXPECT_EQ(0, c.layer);
+}
+
+TEST_F(TileTexturePoolTest, AddsAndRemovesPages) {
+    Allocator allocator(2);
+    bool isNewPage;
+    std::vector<Allocator::Location> locations;
+    for (int i = 0; i < 5; ++i) {
+        locations.push_back(allocator.allocate(isNewPage));
+        EXPECT_EQ(i % 2 == 0, isNewPage);
+    }
+    EXPECT_EQ(2, locations[4].page);
+
+    Allocator::Statistics statistics = allocator.statistics();
+    EXPECT_EQ(3, statistics.numPages);
+    EXPECT_EQ(6, statistics.numLayers);
+    EXPECT_EQ(5, statistics.numUsedLayers);
+
+    // Emptying the first page removes it, and its index is reused before a new one
+    EXPECT_FALSE(allocator.free(locations[0]));
+    EXPECT_TRUE(allocator.free(locations[1]));
+    EXPECT_EQ(2, allocator.statistics().numPages);
+
+    allocator.allocate(isNewPage);
+    EXPECT_FALSE(isNewPage);
+    Allocator::Location location = allocator.allocate(isNewPage);
+    EXPECT_TRUE(isNewPage);
+    EXPECT_EQ(0, location.page);
+}
+
+TEST_F(TileTexturePoolTest, FillsFullestPageFirst) {
+    Allocator allocator(4);
+    bool isNewPage;
+    std::vector<Allocator::Location> locations;
+    for (int i = 0; i < 8; ++i) {
+        locations.push_back(allocator.allocate(isNewPage));
+    }
+    // Page 0 keeps one layer in use, page 1 three
+    allocator.free(locations[0]);
+    allocator.free(locations[1]);
+    allocator.free(locations[2]);
+    allocator.free(locations[4]);
+
+    Allocator::Location location = allocator.allocate(isNewPage);
+    EXPECT_FALSE(isNewPage);
+    EXPECT_EQ(1, location.page);
+    EXPECT_EQ(0, location.layer);
+
+    // Once the fuller page is full, the other one is used
+    location = allocator.allocate(isNewPage);
+    EXPECT_EQ(0, location.page);
+}
@@ -0,0 +1,195 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/tile/tiletextureresidency.h>
+
+#include <vector>
+
+class TileTextureResidencyTest : public testing::Test {
+protected:
+    using Residency = openspace::TileTextureResidency;
+
+    // The residency only uses the slot addresses as keys, so stand-ins that are never
+    // dereferenced are enough to test it without an OpenGL context
+    static const openspace::TileTextureSlot* texture(size_t i) {
+        static char storage[16];
+        return reinterpret_cast<const openspace::TileTextureSlot*>(&storage[i]);
+    }
+
+    static openspace::TileTextureFormat format(unsigned int size) {
+        return { 0, 0, 0, glm::uvec2(size, size), false };
+    }
+
+    // Returns a callback that records which slot was evicted
+    Residency::EvictionCallback recordEviction(size_t i) {
+        return [this, i]() { evicted.push_back(i); };
+    }
+
+    std::vector<size_t> evicted;
+};
+
+TEST_F(TileTextureResidencyTest, EvictsLeastRecentlyUsedOverBudget) {
+    Residency residency(300);
+    residency.makeResident(texture(0), format(8), 100, recordEviction(0));
+    residency.makeResident(texture(1), format(8), 100, recordEviction(1));
+    residency.makeResident(texture(2), format(8), 100, recordEviction(2));
+    EXPECT_TRUE(evicted.empty());
+    EXPECT_EQ(300, residency.residentBytes());
+
+    residency.touch(texture(0));
+    residency.makeResident(texture(3), format(8), 100, recordEviction(3));
+
+    ASSERT_EQ(1, evicted.size());
+    EXPECT_EQ(1, evicted[0]);
+    EXPECT_FALSE(residency.isResident(texture(1)));
+    EXPECT_TRUE(residency.isResident(texture(0)));
+    EXPECT_EQ(300, residency.residentBytes());
+    EXPECT_EQ(1, residency.numEvictions());
+}
+
+TEST_F(TileTextureResidencyTest, PinnedAndNewestTexturesAreNotEvicted) {
+    Residency residency(100);
+    residency.makeResident(texture(0), format(8), 100);
+    residency.makeResident(texture(1), format(8), 100, recordEviction(1));
+
+    // Neither the pinned nor the just registered texture can be evicted
+    EXPECT_TRUE(evicted.empty());
+    EXPECT_EQ(200, residency.residentBytes());
+
+    residency.makeResident(texture(2), format(8), 50, recordEviction(2));
+    ASSERT_EQ(1, evicted.size());
+    EXPECT_EQ(1, evicted[0]);
+    EXPECT_TRUE(residency.isResident(texture(0)));
+    EXPECT_EQ(150, residency.residentBytes());
+}
+
+TEST_F(TileTextureResidencyTest, ReleasingFromEvictionCallbackIsSafe) {
+    Residency residency(100);
+    residency.makeResident(texture(0), format(8), 100, [&]() {
+        // Owners typically destroy the texture, which releases it, when evicting
+        residency.release(texture(0));
+        evicted.push_back(0);
+    });
+    residency.makeResident(texture(1), format(8), 100, recordEviction(1));
+
+    ASSERT_EQ(1, evicted.size());
+    EXPECT_EQ(0, evicted[0]);
+    EXPECT_EQ(100, residency.residentBytes());
+
+    residency.release(texture(1));
+    EXPECT_EQ(1, evicted.size());
+    EXPECT_EQ(0, residency.residentBytes());
+}
+
+TEST_F(TileTextureResidencyTest, LoweringBudgetEvicts) {
+    Residency residency(1000);
+    for (size_t i = 0; i < 10; ++i) {
+        residency.makeResident(texture(i), format(8), 100, recordEviction(i));
+    }
+    residency.setBudget(250);
+
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 2, 3, 4, 5, 6, 7 }), evicted);
+    EXPECT_EQ(200, residency.residentBytes());
+}
+
+TEST_F(TileTextureResidencyTest, EvictsWholePagesOverBudget) {
+    Residency residency(1500);
+    residency.addPage(1, 1000);
+    int numSlotsInFirstPage = 2;
+    auto releaseFromFirstPage = [&](size_t i) {
+        return [&, i]() {
+            // Mimics the pool, which deletes the page when its last slot is destroyed
+            residency.release(texture(i));
+            evicted.push_back(i);
+            if (--numSlotsInFirstPage == 0) {
+                residency.removePage(1);
+            }
+        };
+    };
+    residency.makeResident(texture(0), format(8), 100, releaseFromFirstPage(0), 1);
+    residency.makeResident(texture(1), format(8), 100, releaseFromFirstPage(1), 1);
+    EXPECT_EQ(200, residency.residentBytes());
+    EXPECT_EQ(1000, residency.allocatedBytes());
+    EXPECT_TRUE(evicted.empty());
+
+    // A single slot in a new page exceeds the budget and empties the first page, even
+    // though the resident slots alone are within it
+    residency.addPage(2, 1000);
+    residency.makeResident(texture(2), format(8), 100, recordEviction(2), 2);
+    EXPECT_EQ(std::vector<size_t>({ 1, 0 }), evicted);
+    EXPECT_EQ(100, residency.residentBytes());
+    EXPECT_EQ(1000, residency.allocatedBytes());
+    EXPECT_EQ(2, residency.numEvictions());
+}
+
+TEST_F(TileTextureResidencyTest, PagesWithPinnedSlotsAreNotEvicted) {
+    Residency residency(2500);
+    residency.addPage(1, 1000);
+    residency.makeResident(texture(0), format(8), 100, Residency::EvictionCallback(), 1);
+    residency.makeResident(texture(1), format(8), 100, recordEviction(1), 1);
+    residency.addPage(2, 1000);
+    residency.makeResident(texture(2), format(8), 100, recordEviction(2), 2);
+    residency.addPage(3, 1000);
+    residency.makeResident(texture(3), format(8), 100, recordEviction(3), 3);
+
+    EXPECT_EQ(std::vector<size_t>({ 2 }), evicted);
+    EXPECT_TRUE(residency.isResident(texture(1)));
+}
+
+TEST_F(TileTextureResidencyTest, EvictedPagesThatAreNotDeletedYetAreNotCharged) {
+    Residency residency(5000);
+    for (size_t i = 0; i < 4; ++i) {
+        residency.addPage(GLuint(i + 1), 1000);
+        residency.makeResident(texture(i), format(8), 100, recordEviction(i),
+            GLuint(i + 1));
+    }
+
+    // The owners keep the evicted slots alive, so their pages stay allocated. They
+    // are deleted eventually, so evicting the first two pages is enough
+    residency.setBudget(2500);
+    EXPECT_EQ(std::vector<size_t>({ 0, 1 }), evicted);
+    EXPECT_TRUE(residency.isResident(texture(2)));
+    EXPECT_EQ(4000, residency.allocatedBytes());
+}
+
+TEST_F(TileTextureResidencyTest, CollectsStatisticsPerFormat) {
+    Residency residency(1000);
+    residency.makeResident(texture(0), format(8), 100, recordEviction(0));
+    residency.makeResident(texture(1), format(8), 100, recordEviction(1));
+    residency.makeResident(texture(2), format(16), 400);
+
+    Residency::Statistics statistics = residency.statistics();
+    EXPECT_EQ(1000, statistics.budgetBytes);
+    EXPECT_EQ(600, statistics.residentBytes);
+    EXPECT_EQ(0, statistics.allocatedBytes);
+    EXPECT_EQ(3, statistics.numResidentTiles);
+    EXPECT_EQ(1, statistics.numPinnedTiles);
+    ASSERT_EQ(2, statistics.formats.size());
+    EXPECT_EQ(2, statistics.formats[format(8)].numResidentTiles);
+    EXPECT_EQ(200, statistics.formats[format(8)].residentBytes);
+    EXPECT_EQ(1, statistics.formats[format(16)].numResidentTiles);
+    EXPECT_EQ(400, statistics.formats[format(16)].residentBytes);
+}
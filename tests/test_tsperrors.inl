@@ -0,0 +1,221 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2016                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/multiresvolume/rendering/tsp.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+class TspErrorTest : public testing::Test {
+protected:
+    // Writes a TSP file with random brick values
+    void createTsp(const std::string& filename, unsigned int nTimesteps,
+                   unsigned int nBricksPerAxis, unsigned int brickDim)
+    {
+        openspace::TSP::Header header = {
+            0, nTimesteps, nTimesteps,
+            brickDim, brickDim, brickDim,
+            nBricksPerAxis, nBricksPerAxis, nBricksPerAxis
+        };
+
+        unsigned int nOtNodes = 1;
+        for (unsigned int n = 1; n < nBricksPerAxis * nBricksPerAxis * nBricksPerAxis;) {
+            n *= 8;
+            nOtNodes += n;
+        }
+        size_t nBricks = static_cast<size_t>(nOtNodes) * (2 * nTimesteps - 1);
+        size_t nValues = (brickDim + 2) * (brickDim + 2) * (brickDim + 2);
+
+        std::mt19937 gen(1337);
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+        std::vector<float> values(nBricks * nValues);
+        for (float& v : values) {
+            v = dist(gen);
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(
+            reinterpret_cast<const char*>(values.data()),
+            values.size() * sizeof(float)
+        );
+    }
+
+    std::vector<float> readBrick(std::ifstream& file, unsigned int brick,
+                                 unsigned int nValues)
+    {
+        std::vector<float> values(nValues);
+        file.seekg(
+            openspace::TSP::dataPosition() +
+            static_cast<long long>(brick) * nValues * sizeof(float)
+        );
+        file.read(reinterpret_cast<char*>(values.data()), nValues * sizeof(float));
+        return values;
+    }
+
+    // Direct evaluation of the spatial error definition
+    float referenceSpatialError(openspace::TSP& tsp, std::ifstream& file,
+                                unsigned int brick)
+    {
+        const unsigned int nValues = static_cast<unsigned int>(
+            std::pow(tsp.paddedBrickDim(), 3)
+        );
+        const unsigned int nOtNodes = tsp.numOTNodes();
+        const unsigned int bstOffset = brick - brick % nOtNodes;
+
+        std::vector<unsigned int> leaves;
+        std::vector<unsigned int> queue = { brick % nOtNodes };
+        while (!queue.empty()) {
+            unsigned int node = queue.back();
+            queue.pop_back();
+            if (8 * node + 1 >= nOtNodes) {
+                leaves.push_back(bstOffset + node);
+            }
+            else {
+                for (unsigned int c = 0; c < 8; ++c) {
+                    queue.push_back(8 * node + 1 + c);
+                }
+            }
+        }
+        if (leaves.size() == 1) {
+            return -0.1f;
+        }
+
+        std::vector<float> values = readBrick(file, brick, nValues);
+        double average = 0.0;
+        for (float v : values) {
+            average += v;
+        }
+        average /= nValues;
+
+        double stdDev = 0.0;
+        for (unsigned int leaf : leaves) {
+            for (float v : readBrick(file, leaf, nValues)) {
+                stdDev += (v - average) * (v - average);
+            }
+        }
+        stdDev = std::sqrt(stdDev / (leaves.size() * nValues));
+        return static_cast<float>(std::pow(stdDev, 0.5));
+    }
+
+    // Direct evaluation of the temporal error definition
+    float referenceTemporalError(openspace::TSP& tsp, std::ifstream& file,
+                                 unsigned int brick)
+    {
+        const unsigned int nValues = static_cast<unsigned int>(
+            std::pow(tsp.paddedBrickDim(), 3)
+        );
+        const unsigned int nOtNodes = tsp.numOTNodes();
+        const unsigned int otNode = brick % nOtNodes;
+
+        std::vector<unsigned int> leaves;
+        std::vector<unsigned int> queue = { brick / nOtNodes };
+        while (!queue.empty()) {
+            unsigned int node = queue.back();
+            queue.pop_back();
+            if (node >= tsp.numBSTNodes() / 2) {
+                leaves.push_back(node * nOtNodes + otNode);
+            }
+            else {
+                queue.push_back(2 * node + 1);
+                queue.push_back(2 * node + 2);
+            }
+        }
+        if (leaves.size() == 1) {
+            return -0.1f;
+        }
+
+        std::vector<float> values = readBrick(file, brick, nValues);
+        std::vector<std::vector<float>> leafValues;
+        for (unsigned int leaf : leaves) {
+            leafValues.push_back(readBrick(file, leaf, nValues));
+        }
+
+        double avgStdDev = 0.0;
+        for (unsigned int v = 0; v < nValues; ++v) {
+            double stdDev = 0.0;
+            for (const std::vector<float>& l : leafValues) {
+                stdDev += (l[v] - values[v]) * (l[v] - values[v]);
+            }
+            avgStdDev += std::sqrt(stdDev / leaves.size());
+        }
+        avgStdDev /= nValues;
+        return static_cast<float>(std::pow(avgStdDev, 0.25));
+    }
+};
+
+TEST_F(TspErrorTest, MatchesDefinition) {
+    const std::string filename = "tsperrortest.tsp";
+    createTsp(filename, 4, 4, 2);
+
+    openspace::TSP tsp(filename);
+    ASSERT_TRUE(tsp.readHeader());
+    ASSERT_TRUE(tsp.construct());
+    ASSERT_TRUE(tsp.calculateErrors());
+
+    std::ifstream file(filename, std::ios::binary);
+    for (unsigned int brick = 0; brick < tsp.numTotalNodes(); ++brick) {
+        EXPECT_NEAR(
+            referenceSpatialError(tsp, file, brick),
+            tsp.getSpatialError(brick),
+            1e-4f
+        ) << "Spatial error of brick " << brick;
+        EXPECT_NEAR(
+            referenceTemporalError(tsp, file, brick),
+            tsp.getTemporalError(brick),
+            1e-4f
+        ) << "Temporal error of brick " << brick;
+    }
+    file.close();
+
+    std::remove(filename.c_str());
+}
+
+#ifdef OPENSPACE_BENCHMARKS
+TEST_F(TspErrorTest, TimingBenchmark) {
+    const std::string filename = "tsperrortiming.tsp";
+    createTsp(filename, 16, 4, 14);
+
+    openspace::TSP tsp(filename);
+    ASSERT_TRUE(tsp.readHeader());
+    ASSERT_TRUE(tsp.construct());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ASSERT_TRUE(tsp.calculateErrors());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "TSP errors: " << tsp.numTotalNodes() << " bricks of " <<
+        tsp.paddedBrickDim() << "^3 voxels in " <<
+        std::chrono::duration<double, std::milli>(end - start).count() << " ms" <<
+        std::endl;
+
+    std::remove(filename.c_str());
+}
+#endif // OPENSPACE_BENCHMARKS